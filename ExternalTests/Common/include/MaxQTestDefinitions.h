@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <string>
+
 extern const double pi;
 extern const double _pos0_as_radians;
 extern const double _pos1_as_radians;
@@ -34,3 +36,7 @@ extern const FSStateVector state_target_9993_center_9995_j2000_et0;
 bool IsNear(const FSStateVector&  state1, const FSStateVector& state2, double rtol = 0.00001, double vtol = 0.00000001);
 bool IsNear(const FSDimensionlessVector&  vector1, const FSDimensionlessVector& vector2, double tol = 0.00001);
 
+// Absolute path of a file in the tests' working directory.  Relative paths
+// given to MaxQ resolve against the project's Content directory, which needs
+// a running engine.
+std::string TestFilePath(const char* File);
@@ -8,6 +8,7 @@
 #include "pch.h"
 
 #include "MaxQTestDefinitions.h"
+#include <filesystem>
 
 // Pi value, for independence from OS, Platform, or SPICE while testing.
 #define PI_MACRO 3.1415926535897932384626433832795028841971693993751058209749445923078164
@@ -50,6 +51,11 @@ bool IsNear(const FSDimensionlessVector& vector1, const FSDimensionlessVector& v
     return delta.Magnitude() < tol;
 }
 
+std::string TestFilePath(const char* File)
+{
+    return std::filesystem::absolute(File).string();
+}
+
 #if 0
 const FString fileName = TEXT("celestialmath_unit_test_spk.bsp");
 const FString Ref = TEXT("ECLIPJ2000");
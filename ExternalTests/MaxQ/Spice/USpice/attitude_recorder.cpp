@@ -0,0 +1,205 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceAttitudeRecorder.h"
+#include <cstdio>
+
+using MaxQ::Recording::FAttitudeWriter;
+using MaxQ::Recording::FAttitudeWriterSettings;
+using MaxQ::Recording::FAttitudeWriterStats;
+
+namespace
+{
+    constexpr int Spacecraft = -999;
+    constexpr int Instrument = -999000;
+
+    // Spinning about (0.6, 0, 0.8)
+    constexpr double SpinRate = 0.01;
+    const double SpinAxis[3] = { 0.6, 0., 0.8 };
+
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+        // The unit test kernels have no SCLK:  a millisecond clock, zero at
+        // ET zero
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK_DATA_TYPE_999"), { 1. });
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK01_TIME_SYSTEM_999"), { 1. });
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK01_N_FIELDS_999"), { 2. });
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK01_MODULI_999"), { 1e9, 1000. });
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK01_OFFSETS_999"), { 0., 0. });
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK01_OUTPUT_DELIM_999"), { 1. });
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK_PARTITION_START_999"), { 0. });
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK_PARTITION_END_999"), { 1e12 });
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("SCLK01_COEFFICIENTS_999"), { 0., 0., 1. });
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    }
+
+    FSQuaternion Spin(double t)
+    {
+        const double Half = 0.5 * SpinRate * t;
+        return FSQuaternion::SPICE(cos(Half), sin(Half) * SpinAxis[0], sin(Half) * SpinAxis[1], sin(Half) * SpinAxis[2]);
+    }
+
+    FSAngularVelocity SpinVelocity()
+    {
+        const double av[3] = { SpinRate * SpinAxis[0], SpinRate * SpinAxis[1], SpinRate * SpinAxis[2] };
+        return FSAngularVelocity(av);
+    }
+
+    FAttitudeWriterSettings Settings(const char* File)
+    {
+        FAttitudeWriterSettings Settings;
+        Settings.File = TestFilePath(File).c_str();
+        Settings.Instrument = Instrument;
+        Settings.Spacecraft = Spacecraft;
+        Settings.MaxSegmentSamples = 100;
+        return Settings;
+    }
+
+    bool Pointing(double t, FSRotationMatrix& cmat, FSAngularVelocity& av)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        double sclkdp = 0., clkout = 0.;
+        bool bFound = false;
+
+        USpice::sce2c(ResultCode, ErrorMessage, Spacecraft, et0 + FSEphemerisPeriod(t), sclkdp);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        USpice::ckgpav(ResultCode, ErrorMessage, Instrument, sclkdp, 0., TEXT("J2000"), cmat, av, clkout, bFound);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        return bFound;
+    }
+}
+
+
+TEST(attitude_recorder_test, Segments_Reproduce_Pointing) {
+
+    LoadKernels();
+
+    const FAttitudeWriterSettings WriterSettings = Settings("attitude_recorder_spin.bc");
+    std::remove(TCHAR_TO_ANSI(*WriterSettings.File));
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TSharedPtr<FAttitudeWriter> Writer = FAttitudeWriter::Open(WriterSettings, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // Every other quaternion negated:  the same rotations, in the other hemisphere
+    constexpr int32 N = 1000;
+    for (int32 i = 0; i < N; ++i)
+    {
+        const double t = 2. * i;
+        FSQuaternion q = Spin(t);
+        if (i & 1)
+        {
+            q = FSQuaternion::SPICE(-q.w, -q.x, -q.y, -q.z);
+        }
+        EXPECT_TRUE(Writer->Push(et0 + FSEphemerisPeriod(t), q, SpinVelocity()));
+    }
+
+    Writer->Close(&ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    const FAttitudeWriterStats Stats = Writer->GetStats();
+    EXPECT_EQ(Stats.Samples, N);
+    EXPECT_EQ(Stats.Dropped, 0);
+    EXPECT_EQ(Stats.Skipped, 0);
+    EXPECT_GE(Stats.Segments, 10);
+
+    USpice::furnsh_absolute(TCHAR_TO_ANSI(*WriterSettings.File));
+
+    // Between samples, and across segment boundaries
+    for (double t = 0.5; t < 2. * (N - 1); t += 7.)
+    {
+        FSRotationMatrix cmat;
+        FSAngularVelocity av;
+        ASSERT_TRUE(Pointing(t, cmat, av)) << t;
+
+        const FSRotationMatrix Expected = Spin(t);
+        for (int32 Row = 0; Row < 3; ++Row)
+        {
+            EXPECT_NEAR(cmat.m[Row].x, Expected.m[Row].x, 1e-9);
+            EXPECT_NEAR(cmat.m[Row].y, Expected.m[Row].y, 1e-9);
+            EXPECT_NEAR(cmat.m[Row].z, Expected.m[Row].z, 1e-9);
+        }
+        EXPECT_NEAR(av.x.radiansPerSecond, SpinRate * SpinAxis[0], 1e-12);
+        EXPECT_NEAR(av.z.radiansPerSecond, SpinRate * SpinAxis[2], 1e-12);
+    }
+}
+
+
+TEST(attitude_recorder_test, Gaps_Are_Not_Interpolated) {
+
+    LoadKernels();
+
+    FAttitudeWriterSettings WriterSettings = Settings("attitude_recorder_gap.bc");
+    WriterSettings.MaxGapSeconds = 5.;
+    WriterSettings.MaxSegmentSamples = 10000;
+    std::remove(TCHAR_TO_ANSI(*WriterSettings.File));
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TSharedPtr<FAttitudeWriter> Writer = FAttitudeWriter::Open(WriterSettings, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // A paused clock (the same ET twice), and 100s with no samples
+    for (int32 i = 0; i < 100; ++i)
+    {
+        Writer->Push(et0 + FSEphemerisPeriod((double)i), Spin(i), SpinVelocity());
+        Writer->Push(et0 + FSEphemerisPeriod((double)i), Spin(i), SpinVelocity());
+    }
+    for (int32 i = 200; i < 300; ++i)
+    {
+        Writer->Push(et0 + FSEphemerisPeriod((double)i), Spin(i), SpinVelocity());
+    }
+
+    Writer->Close(&ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Writer->GetStats().Skipped, 100);
+
+    USpice::furnsh_absolute(TCHAR_TO_ANSI(*WriterSettings.File));
+
+    FSRotationMatrix cmat;
+    FSAngularVelocity av;
+    EXPECT_TRUE(Pointing(50.5, cmat, av));
+    EXPECT_TRUE(Pointing(250.5, cmat, av));
+    EXPECT_FALSE(Pointing(150., cmat, av));
+}
+
+
+TEST(attitude_recorder_test, Bad_Inputs) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    FAttitudeWriterSettings WriterSettings = Settings("attitude_recorder_bad.bc");
+    WriterSettings.Frame = FName(TEXT("NOT_A_FRAME"));
+    EXPECT_FALSE(FAttitudeWriter::Open(WriterSettings, &ResultCode, &ErrorMessage).IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // No SCLK kernel for the spacecraft:  the write fails, the writer survives
+    WriterSettings = Settings("attitude_recorder_bad.bc");
+    WriterSettings.Spacecraft = -998;
+    std::remove(TCHAR_TO_ANSI(*WriterSettings.File));
+    TSharedPtr<FAttitudeWriter> Writer = FAttitudeWriter::Open(WriterSettings, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    Writer->Push(et0, Spin(0.), SpinVelocity());
+    Writer->Push(et0 + FSEphemerisPeriod(1.), Spin(1.), SpinVelocity());
+    Writer->Close(&ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_EQ(Writer->GetStats().Segments, 0);
+}
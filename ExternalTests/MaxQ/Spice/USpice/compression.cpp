@@ -0,0 +1,224 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCompression.h"
+#include "SpiceEphemeris.h"
+#include <cstdio>
+#include <filesystem>
+
+using namespace MaxQ::Compression;
+
+namespace
+{
+    // An eccentric earth orbit, so record lengths have to adapt:  periapsis
+    // 6000km, ~7.8 hours
+    constexpr double GM = 398600.4418;
+    constexpr double SemiMajorAxis = 20000.;
+    constexpr double Eccentricity = 0.7;
+
+    const FName Frame(TEXT("J2000"));
+
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    }
+
+    double Period()
+    {
+        return 2. * PI * sqrt(SemiMajorAxis * SemiMajorAxis * SemiMajorAxis / GM);
+    }
+
+    // t seconds after periapsis
+    FSStateVector Kepler(double t)
+    {
+        const double n = 2. * PI / Period();
+        const double M = n * t;
+        double E = M;
+        for (int i = 0; i < 50; ++i)
+        {
+            E -= (E - Eccentricity * sin(E) - M) / (1. - Eccentricity * cos(E));
+        }
+
+        const double b = SemiMajorAxis * sqrt(1. - Eccentricity * Eccentricity);
+        const double Rate = n / (1. - Eccentricity * cos(E));
+        return FSStateVector(
+            FSDistanceVector(SemiMajorAxis * (cos(E) - Eccentricity), b * sin(E), 0.),
+            FSVelocityVector(-SemiMajorAxis * sin(E) * Rate, b * cos(E) * Rate, 0.)
+        );
+    }
+
+    void Samples(double Step, TArray<double>& Epochs, TArray<double>& States)
+    {
+        for (double t = 0.; t <= Period(); t += Step)
+        {
+            double State[6];
+            Kepler(t).CopyTo(State);
+            Epochs.Add(et0.seconds + t);
+            States.Append(State, 6);
+        }
+    }
+
+    double PositionError(const FSDistanceVector& r, const FSStateVector& Expected)
+    {
+        return FVector3d(r.x.km - Expected.r.x.km, r.y.km - Expected.r.y.km, r.z.km - Expected.r.z.km).Length();
+    }
+}
+
+
+TEST(compression_test, Fit_Samples_Within_Tolerance) {
+
+    LoadKernels();
+
+    TArray<double> Epochs, States;
+    Samples(5., Epochs, States);
+
+    for (bool bFitVelocity : { false, true })
+    {
+        FChebyshevFitSettings Settings;
+        Settings.PositionTolerance = 1e-3;
+        Settings.VelocityTolerance = 1e-5;
+        Settings.bFitVelocity = bFitVelocity;
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        TArray<FChebyshevSegment> Segments;
+        FCompressionStats Stats;
+        FitChebyshev(Epochs, States, Settings, Segments, Stats, &ResultCode, &ErrorMessage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        EXPECT_EQ(Stats.RecordsOverTolerance, 0);
+        EXPECT_LE(Stats.MaxPositionError, Settings.PositionTolerance);
+        EXPECT_LE(Stats.MaxVelocityError, Settings.VelocityTolerance);
+        EXPECT_LE(Stats.RmsPositionError, Stats.MaxPositionError);
+        EXPECT_GT(Stats.Ratio(), 10.) << Stats.InputBytes << " -> " << Stats.OutputBytes;
+        EXPECT_EQ(Segments.Num(), Stats.Segments);
+
+        // Shorter records near periapsis than apoapsis
+        double Shortest = DBL_MAX, Longest = 0.;
+        for (const FChebyshevSegment& Segment : Segments)
+        {
+            Shortest = FMath::Min(Shortest, Segment.IntervalLength);
+            Longest = FMath::Max(Longest, Segment.IntervalLength);
+        }
+        EXPECT_GE(Longest, 2. * Shortest);
+
+        // Contiguous coverage
+        EXPECT_DOUBLE_EQ(Segments[0].First, Epochs[0]);
+        EXPECT_DOUBLE_EQ(Segments.Last().Last, Epochs.Last());
+        for (int32 i = 1; i < Segments.Num(); ++i)
+        {
+            EXPECT_DOUBLE_EQ(Segments[i].First, Segments[i - 1].Last);
+        }
+
+        // Written & read back by SPICE
+        const std::string Spk = TestFilePath(bFitVelocity ? "compression_fit_type3.bsp" : "compression_fit_type2.bsp");
+        std::remove(Spk.c_str());
+
+        int Handle = 0;
+        USpice::spkopn(ResultCode, ErrorMessage, Spk.c_str(), TEXT("COMPRESSION TEST"), 0, Handle);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        EXPECT_TRUE(WriteChebyshev(Handle, -999201, 399, Frame, TEXT("FIT"), Segments, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        // Not a handle open for writing
+        EXPECT_FALSE(WriteChebyshev(Handle + 1000, -999201, 399, Frame, TEXT("FIT"), Segments, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+        USpice::spkcls(ResultCode, ErrorMessage, Handle);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        USpice::furnsh_absolute(Spk.c_str());
+        for (double t = 1.; t < Period(); t += 97.)
+        {
+            const FSDistanceVector r = MaxQ::Ephemeris::Spkpos(et0 + FSEphemerisPeriod(t), FName(TEXT("-999201")), FName(TEXT("399")), Frame, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+            EXPECT_LT(PositionError(r, Kepler(t)), 2e-3) << t;
+        }
+    }
+}
+
+
+TEST(compression_test, Compress_Spk) {
+
+    LoadKernels();
+
+    // Discrete states a minute apart, like Sample06's
+    const std::string Input = TestFilePath("compression_input.bsp");
+    const std::string Output = TestFilePath("compression_output.bsp");
+    std::remove(Input.c_str());
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    int Handle = 0;
+    USpice::spkopn(ResultCode, ErrorMessage, Input.c_str(), TEXT("COMPRESSION TEST"), 0, Handle);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    TArray<FSPKType5Observation> Observations;
+    for (double t = 0.; t <= Period(); t += 60.)
+    {
+        Observations.Add(FSPKType5Observation(et0 + FSEphemerisPeriod(t), Kepler(t)));
+    }
+    const FSEphemerisTime First = Observations[0].et, Last = Observations.Last().et;
+    USpice::spkw05(ResultCode, ErrorMessage, Handle, -999202, 399, Frame.ToString(), First, Last, TEXT("DISCRETE STATES"), FSMassConstant(GM), Observations);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    USpice::spkcls(ResultCode, ErrorMessage, Handle);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    FChebyshevFitSettings Settings;
+    FCompressionStats Stats;
+    CompressSpk(Input.c_str(), Output.c_str(), Settings, Stats, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    EXPECT_EQ(Stats.RecordsOverTolerance, 0);
+    EXPECT_LE(Stats.MaxPositionError, Settings.PositionTolerance);
+    EXPECT_EQ(Stats.InputBytes, (int64)std::filesystem::file_size(Input));
+    EXPECT_EQ(Stats.OutputBytes, (int64)std::filesystem::file_size(Output));
+    EXPECT_LT(Stats.OutputBytes, Stats.InputBytes);
+
+    // Only the compressed file
+    LoadKernels();
+    USpice::furnsh_absolute(Output.c_str());
+    for (double t = 1.; t < Period(); t += 97.)
+    {
+        const FSDistanceVector r = MaxQ::Ephemeris::Spkpos(et0 + FSEphemerisPeriod(t), FName(TEXT("-999202")), FName(TEXT("399")), Frame, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        EXPECT_LT(PositionError(r, Kepler(t)), 2e-3) << t;
+    }
+}
+
+
+TEST(compression_test, Bad_Inputs) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FChebyshevSegment> Segments;
+    FCompressionStats Stats;
+
+    TArray<double> States;
+    States.Init(0., 18);
+    FitChebyshev({ 0., 1., 1. }, States, FChebyshevFitSettings(), Segments, Stats, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    States.Init(0., 6);
+    FitChebyshev({ 0., 1. }, States, FChebyshevFitSettings(), Segments, Stats, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_EQ(Segments.Num(), 0);
+
+    // Not an SPK
+    const std::string Lsk = TestFilePath("maxq_unit_test_lsk.tls");
+    CompressSpk(Lsk.c_str(), TestFilePath("compression_bad.bsp").c_str(), FChebyshevFitSettings(), Stats, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    const std::string Spk = TestFilePath("maxq_unit_test_spk.bsp");
+    CompressSpk(Spk.c_str(), Spk.c_str(), FChebyshevFitSettings(), Stats, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
@@ -0,0 +1,166 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceConstantCache.h"
+#include "SpiceData.h"
+#include <atomic>
+#include <thread>
+
+namespace
+{
+    void LoadTestKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+        MaxQ::ConstantCache::ResetStats();
+    }
+}
+
+TEST(constant_cache_test, Hit_After_First_Lookup) {
+
+    LoadTestKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    const FName Body(TEXT("FAKEBODY9994")), Radii(TEXT("RADII"));
+
+    FSDistanceVector First = MaxQ::Data::Bodvrd<FSDistanceVector>(Body, Radii, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    FSDistanceVector Second = MaxQ::Data::Bodvrd<FSDistanceVector>(Body, Radii, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    EXPECT_DOUBLE_EQ(First.x.km, 123.45);
+    EXPECT_DOUBLE_EQ(First.z.km, 123.);
+    EXPECT_DOUBLE_EQ(Second.x.km, First.x.km);
+    EXPECT_DOUBLE_EQ(Second.z.km, First.z.km);
+
+    MaxQ::ConstantCache::FStats Stats = MaxQ::ConstantCache::GetStats();
+    EXPECT_EQ(Stats.Misses, 1);
+    EXPECT_EQ(Stats.Hits, 1);
+    EXPECT_GE(Stats.Entries, 1);
+
+    // Same variable by code and by name share an entry
+    FSDistanceVector ByCode;
+    MaxQ::Data::Bodvcd(ByCode, 9994, Radii, &ResultCode, &ErrorMessage);
+    MaxQ::Data::Gdpool(ByCode, FName(TEXT("BODY9994_RADII")), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(ByCode.y.km, 123.45);
+    EXPECT_EQ(MaxQ::ConstantCache::GetStats().Hits, 2);
+
+    // Size mismatches are still reported from cached values
+    FSMassConstant Wrong;
+    MaxQ::Data::Bodvrd(Wrong, Body, Radii, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+TEST(constant_cache_test, Pool_Update_Invalidates_Only_Affected_Entries) {
+
+    LoadTestKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    FSDistanceVector Radii9994, Radii9995;
+    MaxQ::Data::Bodvcd(Radii9994, 9994, FString(TEXT("RADII")), &ResultCode, &ErrorMessage);
+    MaxQ::Data::Bodvcd(Radii9995, 9995, FString(TEXT("RADII")), &ResultCode, &ErrorMessage);
+    EXPECT_DOUBLE_EQ(Radii9995.x.km, 1000.);
+
+    USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("BODY9994_RADII"), { 1., 2., 3. });
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(MaxQ::ConstantCache::GetStats().Invalidations, 1);
+
+    MaxQ::ConstantCache::ResetStats();
+    MaxQ::Data::Bodvcd(Radii9994, 9994, FString(TEXT("RADII")), &ResultCode, &ErrorMessage);
+    MaxQ::Data::Bodvcd(Radii9995, 9995, FString(TEXT("RADII")), &ResultCode, &ErrorMessage);
+
+    EXPECT_DOUBLE_EQ(Radii9994.x.km, 1.);
+    EXPECT_DOUBLE_EQ(Radii9994.z.km, 3.);
+    EXPECT_DOUBLE_EQ(Radii9995.x.km, 1000.);
+
+    MaxQ::ConstantCache::FStats Stats = MaxQ::ConstantCache::GetStats();
+    EXPECT_EQ(Stats.Misses, 1);
+    EXPECT_EQ(Stats.Hits, 1);
+
+    // USpice's gdpool_* read through the cache too
+    FSDistanceVector Vector;
+    bool bFound = false;
+    USpice::gdpool_vector(ResultCode, ErrorMessage, Vector, bFound, TEXT("BODY9994_RADII"));
+    EXPECT_TRUE(bFound);
+    EXPECT_DOUBLE_EQ(Vector.y.km, 2.);
+    EXPECT_EQ(MaxQ::ConstantCache::GetStats().Hits, 2);
+
+    USpice::gdpool_vector(ResultCode, ErrorMessage, Vector, bFound, TEXT("NO_SUCH_VARIABLE"));
+    EXPECT_FALSE(bFound);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+}
+
+TEST(constant_cache_test, Clear_All_Invalidates) {
+
+    LoadTestKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    double GM = MaxQ::Data::Bodvrd(FName(TEXT("FAKEBODY9995")), FName(TEXT("GM")), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(GM, 0.1);
+
+    USpice::clear_all();
+    EXPECT_EQ(MaxQ::ConstantCache::GetStats().Entries, 0);
+
+    MaxQ::Data::Bodvrd(FName(TEXT("FAKEBODY9995")), FName(TEXT("GM")), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+TEST(constant_cache_test, Concurrent_Readers_See_Consistent_Values) {
+
+    LoadTestKernels();
+
+    // Seeds the entry, then keeps rewriting the variable on this thread while
+    // readers hit the cache lock-free.
+    FSDistanceVector Radii;
+    MaxQ::Data::Bodvcd(Radii, 9994, FName(TEXT("RADII")));
+
+    std::atomic<bool> bDone { false };
+    std::atomic<int32> Torn { 0 };
+    TArray<std::thread> Readers;
+    for (int32 r = 0; r < 4; ++r)
+    {
+        Readers.Emplace([&]()
+        {
+            MaxQ::ConstantCache::FValues Values;
+            while (!bDone.load())
+            {
+                if (MaxQ::ConstantCache::Find("BODY9994_RADII", Values))
+                {
+                    Torn += Values.Num != 3 || Values.Values[0] != Values.Values[1] || Values.Values[1] != Values.Values[2];
+                }
+            }
+        });
+    }
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    for (int32 i = 0; i < 2000; ++i)
+    {
+        const double r = (double)i;
+        USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("BODY9994_RADII"), { r, r, r });
+        MaxQ::Data::Bodvcd(Radii, 9994, FName(TEXT("RADII")));
+        EXPECT_DOUBLE_EQ(Radii.x.km, r);
+    }
+
+    bDone = true;
+    for (std::thread& Reader : Readers)
+    {
+        Reader.join();
+    }
+
+    EXPECT_EQ(Torn.load(), 0);
+}
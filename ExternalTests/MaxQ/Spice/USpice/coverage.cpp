@@ -0,0 +1,85 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCoverage.h"
+
+using MaxQ::Coverage::EKernelKind;
+
+TEST(coverage_test, Index_Matches_Loaded_Kernels) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    TArray<int32> Ids = MaxQ::Coverage::GetIds(EKernelKind::SPK);
+    EXPECT_TRUE(Ids.Contains(9993));
+    EXPECT_TRUE(Ids.Contains(9994));
+    EXPECT_TRUE(Ids.Contains(9995));
+    EXPECT_GT(MaxQ::Coverage::GetIndexedFiles().Num(), 0);
+
+    TArray<FSWindowSegment> Windows;
+    ASSERT_TRUE(MaxQ::Coverage::GetCoverage(EKernelKind::SPK, 9994, Windows));
+
+    for (int32 i = 0; i < Windows.Num(); ++i)
+    {
+        EXPECT_LE(Windows[i].start, Windows[i].stop);
+        if (i > 0)
+        {
+            // Sorted & merged
+            EXPECT_LT(Windows[i - 1].stop, Windows[i].start);
+        }
+    }
+
+    EXPECT_TRUE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, et0));
+    EXPECT_TRUE(MaxQ::Coverage::IsCovered(FName(TEXT("FAKEBODY9994")), et0));
+    EXPECT_TRUE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, FSEphemerisTime(Windows[0].start)));
+    EXPECT_TRUE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, FSEphemerisTime(Windows.Last().stop)));
+    EXPECT_FALSE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, FSEphemerisTime(Windows.Last().stop + 1.)));
+    EXPECT_FALSE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, FSEphemerisTime(Windows[0].start - 1.)));
+    EXPECT_FALSE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 1234567, et0));
+
+    TArray<FSWindowSegment> ByName;
+    EXPECT_TRUE(MaxQ::Coverage::GetCoverage(FName(TEXT("FAKEBODY9994")), ByName));
+    EXPECT_EQ(ByName.Num(), Windows.Num());
+}
+
+TEST(coverage_test, Nearest_Covered) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    TArray<FSWindowSegment> Windows;
+    ASSERT_TRUE(MaxQ::Coverage::GetCoverage(EKernelKind::SPK, 9994, Windows));
+
+    FSEphemerisTime Nearest;
+    ASSERT_TRUE(MaxQ::Coverage::NearestCovered(EKernelKind::SPK, 9994, et0, Nearest));
+    EXPECT_EQ(Nearest.seconds, et0.seconds);
+
+    ASSERT_TRUE(MaxQ::Coverage::NearestCovered(EKernelKind::SPK, 9994, FSEphemerisTime(Windows[0].start - 1000.), Nearest));
+    EXPECT_EQ(Nearest.seconds, Windows[0].start);
+
+    ASSERT_TRUE(MaxQ::Coverage::NearestCovered(EKernelKind::SPK, 9994, FSEphemerisTime(Windows.Last().stop + 1000.), Nearest));
+    EXPECT_EQ(Nearest.seconds, Windows.Last().stop);
+
+    EXPECT_FALSE(MaxQ::Coverage::NearestCovered(EKernelKind::SPK, 1234567, et0, Nearest));
+}
+
+TEST(coverage_test, Follows_Unload_And_Clear) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    EXPECT_TRUE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, et0));
+
+    USpice::clear_all();
+    EXPECT_EQ(MaxQ::Coverage::GetIds(EKernelKind::SPK).Num(), 0);
+    EXPECT_EQ(MaxQ::Coverage::GetIndexedFiles().Num(), 0);
+    EXPECT_FALSE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, et0));
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    EXPECT_TRUE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, et0));
+}
@@ -0,0 +1,61 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+
+
+TEST(deferred_error_scope_test, Failures_Are_Aggregated) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    FSStateVector stateVector;
+    FSEphemerisPeriod lt;
+
+    MaxQ::Core::FDeferredErrorScope Errors(TEXT("deferred_error_scope_test"), 16, false);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        Errors.SetItemIndex(i);
+        USpice::spkezr(ResultCode, ErrorMessage, et0, stateVector, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"));
+
+        EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+        EXPECT_TRUE(ErrorMessage.StartsWith(TEXT("SPICE(")));
+    }
+
+    EXPECT_EQ(Errors.GetFailureCount(), 100);
+    EXPECT_TRUE(Errors.GetSummary().Contains(TEXT("x100")));
+
+    // Each failure is reset as it's recorded
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+}
+
+TEST(deferred_error_scope_test, Scope_Restores_Immediate_Reporting) {
+
+    USpice::init_all();
+
+    {
+        MaxQ::Core::FDeferredErrorScope Errors(TEXT("deferred_error_scope_test"), 16, false);
+        EXPECT_EQ(MaxQ::Core::FDeferredErrorScope::Current(), &Errors);
+    }
+
+    EXPECT_EQ(MaxQ::Core::FDeferredErrorScope::Current(), nullptr);
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    FSStateVector stateVector;
+    FSEphemerisPeriod lt;
+
+    USpice::spkezr(ResultCode, ErrorMessage, et0, stateVector, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"));
+
+    // Long message, not just the short code
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(ErrorMessage.StartsWith(TEXT("SPICE(")));
+}
@@ -0,0 +1,200 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceDsk.h"
+#include <random>
+
+namespace
+{
+    // Dimorphos (Hera), ~3k plates
+    const int32 DimorphosId = -658031;
+
+    MaxQ::Dsk::FPlateModelPtr LoadDimorphos()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("hera_v07.tf");
+        USpice::furnsh_absolute("g_01332mm_lgt_obj_didb_000n00000_v001.bds");
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        MaxQ::Dsk::FPlateModelPtr Model = MaxQ::Dsk::FPlateModel::Load(DimorphosId, {}, &ResultCode, &ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        return Model;
+    }
+
+    // Rays from outside the model, aimed near its center (some miss)
+    TArray<FSRay> RandomRays(const MaxQ::Dsk::FPlateModel& Model, int32 Count, uint32 Seed)
+    {
+        std::mt19937 Random(Seed);
+        std::uniform_real_distribution<double> Unit(-1., 1.);
+
+        const FVector3d Center = Model.GetBounds().GetCenter();
+        const double Radius = Model.GetBounds().GetExtent().Size();
+
+        TArray<FSRay> Rays;
+        Rays.SetNum(Count);
+        for (FSRay& Ray : Rays)
+        {
+            FVector3d From(Unit(Random), Unit(Random), Unit(Random));
+            From = Center + 3. * Radius * From.GetSafeNormal();
+            const FVector3d To = Center + 0.6 * Radius * FVector3d(Unit(Random), Unit(Random), Unit(Random));
+
+            const FVector3d Direction = To - From;
+            Ray.point = FSDistanceVector(From.X, From.Y, From.Z);
+            Ray.direction = FSDimensionlessVector(Direction.X, Direction.Y, Direction.Z);
+        }
+        return Rays;
+    }
+}
+
+
+TEST(dsk_test, Plate_Model_Hits_Nearest_Plate) {
+
+    // Unit cube, two plates per face
+    TArray<FVector3d> Vertices;
+    for (int32 i = 0; i < 8; ++i)
+    {
+        Vertices.Add(FVector3d(i & 1 ? 1. : -1., i & 2 ? 1. : -1., i & 4 ? 1. : -1.));
+    }
+    TArray<FIntVector3> Plates = {
+        { 0, 2, 3 }, { 0, 3, 1 },   // -z
+        { 4, 5, 7 }, { 4, 7, 6 },   // +z
+        { 0, 1, 5 }, { 0, 5, 4 },   // -y
+        { 2, 6, 7 }, { 2, 7, 3 },   // +y
+        { 0, 4, 6 }, { 0, 6, 2 },   // -x
+        { 1, 3, 7 }, { 1, 7, 5 },   // +x
+    };
+
+    MaxQ::Dsk::FPlateModel Model(MoveTemp(Vertices), MoveTemp(Plates));
+    EXPECT_EQ(Model.NumPlates(), 12);
+    EXPECT_EQ(Model.NumVertices(), 8);
+
+    FSRay Ray;
+    Ray.point = FSDistanceVector(0.25, 0.5, 10.);
+    Ray.direction = FSDimensionlessVector(0., 0., -1.);
+
+    FSDistanceVector Point;
+    int32 PlateId = 0;
+    ASSERT_TRUE(Model.Intersect(Ray, Point, &PlateId));
+    EXPECT_DOUBLE_EQ(Point.x.km, 0.25);
+    EXPECT_DOUBLE_EQ(Point.y.km, 0.5);
+    EXPECT_DOUBLE_EQ(Point.z.km, 1.);
+    EXPECT_TRUE(PlateId == 3 || PlateId == 4);
+
+    // From inside, hits the far side (plates are two sided)
+    Ray.point = FSDistanceVector(0.25, 0.5, 0.);
+    ASSERT_TRUE(Model.Intersect(Ray, Point, &PlateId));
+    EXPECT_DOUBLE_EQ(Point.z.km, -1.);
+    EXPECT_TRUE(PlateId == 1 || PlateId == 2);
+
+    // Through a shared edge
+    Ray.point = FSDistanceVector(0., 0., 10.);
+    EXPECT_TRUE(Model.Intersect(Ray, Point));
+
+    // Misses, pointing away, and degenerate
+    Ray.point = FSDistanceVector(1.5, 0., 10.);
+    EXPECT_FALSE(Model.Intersect(Ray, Point));
+    Ray.point = FSDistanceVector(0., 0., 10.);
+    Ray.direction = FSDimensionlessVector(0., 0., 1.);
+    EXPECT_FALSE(Model.Intersect(Ray, Point));
+    Ray.direction = FSDimensionlessVector(0., 0., 0.);
+    EXPECT_FALSE(Model.Intersect(Ray, Point));
+}
+
+
+TEST(dsk_test, Plate_Model_Matches_Dskxv) {
+
+    MaxQ::Dsk::FPlateModelPtr Model = LoadDimorphos();
+    ASSERT_TRUE(Model.IsValid());
+    EXPECT_GT(Model->NumPlates(), 0);
+    EXPECT_EQ(Model->GetFrameId(), DimorphosId);
+
+    // Not a multiple of the packet or chunk size
+    const TArray<FSRay> Rays = RandomRays(*Model, 10007, 1);
+
+    TArray<FSDistanceVector> Points;
+    TArray<bool> Found;
+    Model->Intersect(Rays, Points, Found);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FSDistanceVector> SpicePoints;
+    TArray<bool> SpiceFound;
+    USpice::dskxv(ResultCode, ErrorMessage, SpicePoints, SpiceFound, {}, FSEphemerisTime(), Rays, TEXT("DIMORPHOS"), TEXT("DIMORPHOS_FIXED"));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_EQ(SpiceFound.Num(), Rays.Num());
+
+    int32 Hits = 0, Mismatches = 0;
+    for (int32 i = 0; i < Rays.Num(); ++i)
+    {
+        Hits += SpiceFound[i];
+        if (Found[i] != SpiceFound[i])
+        {
+            ++Mismatches;
+        }
+        else if (Found[i])
+        {
+            const double Error = FMath::Max3(
+                FMath::Abs(Points[i].x.km - SpicePoints[i].x.km),
+                FMath::Abs(Points[i].y.km - SpicePoints[i].y.km),
+                FMath::Abs(Points[i].z.km - SpicePoints[i].z.km));
+            Mismatches += Error > 1e-8;
+        }
+    }
+
+    EXPECT_GT(Hits, 0);
+    EXPECT_LT(Hits, Rays.Num());
+    EXPECT_EQ(Mismatches, 0);
+}
+
+
+TEST(dsk_test, Dskxv_Large_Batch) {
+
+    MaxQ::Dsk::FPlateModelPtr Model = LoadDimorphos();
+    ASSERT_TRUE(Model.IsValid());
+
+    // Used to overflow the stack
+    const TArray<FSRay> Rays = RandomRays(*Model, 250000, 2);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FSDistanceVector> Points;
+    TArray<bool> Found;
+    USpice::dskxv(ResultCode, ErrorMessage, Points, Found, {}, FSEphemerisTime(), Rays, TEXT("DIMORPHOS"), TEXT("DIMORPHOS_FIXED"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Found.Num(), Rays.Num());
+    EXPECT_EQ(Points.Num(), Rays.Num());
+
+    // Spot check the last chunk
+    FSDistanceVector Point;
+    const bool bFound = Model->Intersect(Rays.Last(), Point);
+    EXPECT_EQ(bFound, Found.Last());
+}
+
+
+TEST(dsk_test, Load_Errors) {
+
+    USpice::init_all();
+    USpice::clear_all();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    MaxQ::Dsk::FPlateModelPtr Model = MaxQ::Dsk::FPlateModel::Load(DimorphosId, {}, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(Model.IsValid());
+
+    Model = LoadDimorphos();
+    ASSERT_TRUE(Model.IsValid());
+
+    // Surface filter
+    Model = MaxQ::Dsk::FPlateModel::Load(DimorphosId, { 12345 }, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(Model.IsValid());
+}
@@ -0,0 +1,243 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceDsk.h"
+#include "SpiceDskMesh.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include <random>
+
+namespace
+{
+    const int32 DimorphosId = -658031;
+
+    // Bumpy unit sphere, 2 * Rings * Segments plates (outward winding)
+    void MakeSphere(int32 Rings, int32 Segments, TArray<FVector3d>& Vertices, TArray<FIntVector3>& Plates)
+    {
+        std::mt19937 Random(1);
+        std::uniform_real_distribution<double> Bump(0.98, 1.02);
+
+        Vertices.Reset();
+        Plates.Reset();
+        for (int32 i = 0; i <= Rings; ++i)
+        {
+            for (int32 j = 0; j < Segments; ++j)
+            {
+                const double Theta = UE_DOUBLE_PI * i / Rings, Phi = UE_DOUBLE_TWO_PI * j / Segments;
+                const double R = i == 0 || i == Rings ? 1. : Bump(Random);
+                Vertices.Add(R * FVector3d(FMath::Sin(Theta) * FMath::Cos(Phi), FMath::Sin(Theta) * FMath::Sin(Phi), FMath::Cos(Theta)));
+            }
+        }
+        for (int32 i = 0; i < Rings; ++i)
+        {
+            for (int32 j = 0; j < Segments; ++j)
+            {
+                const int32 A = i * Segments + j, B = i * Segments + (j + 1) % Segments;
+                const int32 C = A + Segments, D = B + Segments;
+                Plates.Add(FIntVector3(A, C, D));
+                Plates.Add(FIntVector3(A, D, B));
+            }
+        }
+    }
+
+    int32 CountTriangles(const MaxQ::Dsk::FShapeMesh& Mesh, int32 Lod)
+    {
+        int32 Triangles = 0;
+        for (const MaxQ::Dsk::FMeshTile& Tile : Mesh.Tiles)
+        {
+            Triangles += Tile.Lods[FMath::Min(Lod, Tile.Lods.Num() - 1)].Indices.Num() / 3;
+        }
+        return Triangles;
+    }
+}
+
+
+TEST(dsk_mesh_test, Tiles_Lods_And_Normals) {
+
+    TArray<FVector3d> Vertices;
+    TArray<FIntVector3> Plates;
+    MakeSphere(64, 128, Vertices, Plates);
+    const int32 NumPlates = Plates.Num();
+
+    MaxQ::Dsk::FMeshSettings Settings;
+    Settings.TilesPerFace = 2;
+    Settings.NumLods = 4;
+
+    MaxQ::Dsk::FMeshStats Stats;
+    MaxQ::Dsk::FShapeMeshPtr Mesh = MaxQ::Dsk::FShapeMesh::Build(MoveTemp(Vertices), MoveTemp(Plates), Settings, &Stats);
+    ASSERT_TRUE(Mesh.IsValid());
+
+    EXPECT_EQ(Mesh->NumPlates, NumPlates);
+    EXPECT_EQ(Mesh->Tiles.Num(), 24);
+    EXPECT_EQ(Stats.Tiles, 24);
+    EXPECT_GT(Stats.PeakBytes, 0u);
+
+    // Every plate lands in exactly one tile at LOD 0, coarser LODs have fewer
+    EXPECT_EQ(CountTriangles(*Mesh, 0), NumPlates);
+    for (int32 Lod = 1; Lod < Settings.NumLods; ++Lod)
+    {
+        EXPECT_LT(CountTriangles(*Mesh, Lod), CountTriangles(*Mesh, Lod - 1));
+    }
+
+    int32 Inward = 0;
+    for (const MaxQ::Dsk::FMeshTile& Tile : Mesh->Tiles)
+    {
+        ASSERT_GE(Tile.Lods.Num(), 1);
+        EXPECT_FLOAT_EQ(Tile.Lods[0].GeometricError, 0.f);
+
+        for (int32 Lod = 0; Lod < Tile.Lods.Num(); ++Lod)
+        {
+            const MaxQ::Dsk::FMeshLod& Data = Tile.Lods[Lod];
+            ASSERT_EQ(Data.Positions.Num(), Data.Normals.Num());
+            ASSERT_EQ(Data.Indices.Num() % 3, 0);
+            if (Lod > 0)
+            {
+                EXPECT_GT(Data.GeometricError, Tile.Lods[Lod - 1].GeometricError);
+            }
+
+            for (uint32 Index : Data.Indices)
+            {
+                ASSERT_LT(Index, (uint32)Data.Positions.Num());
+            }
+
+            // Normals point away from the center
+            for (int32 v = 0; v < Data.Positions.Num(); ++v)
+            {
+                const FVector3d Position = Tile.Origin + FVector3d(Data.Positions[v]);
+                EXPECT_NEAR(Data.Normals[v].Size(), 1.f, 1e-4f);
+                Inward += (FVector3d(Data.Normals[v]) | Position) <= 0.;
+            }
+        }
+    }
+    EXPECT_EQ(Inward, 0);
+}
+
+
+TEST(dsk_mesh_test, Select_Lods_By_Distance) {
+
+    TArray<FVector3d> Vertices;
+    TArray<FIntVector3> Plates;
+    MakeSphere(32, 64, Vertices, Plates);
+
+    MaxQ::Dsk::FShapeMeshPtr Mesh = MaxQ::Dsk::FShapeMesh::Build(MoveTemp(Vertices), MoveTemp(Plates));
+    ASSERT_TRUE(Mesh.IsValid());
+
+    const double MaxAngularError = 0.001;
+    TArray<int32> Near, Far;
+    Mesh->SelectLods(FVector3d(0., 0., 1.001), MaxAngularError, Near);
+    Mesh->SelectLods(FVector3d(0., 0., 10000.), MaxAngularError, Far);
+    ASSERT_EQ(Near.Num(), Mesh->Tiles.Num());
+
+    int32 NearDetail = 0, FarDetail = 0;
+    for (int32 i = 0; i < Mesh->Tiles.Num(); ++i)
+    {
+        EXPECT_LE(Near[i], Far[i]);
+        EXPECT_EQ(Far[i], Mesh->Tiles[i].Lods.Num() - 1);
+        NearDetail += Near[i] == 0;
+        FarDetail += Far[i] == 0 && Mesh->Tiles[i].Lods.Num() > 1;
+    }
+    EXPECT_GT(NearDetail, 0);
+    EXPECT_EQ(FarDetail, 0);
+}
+
+
+TEST(dsk_mesh_test, Serialization_Round_Trip) {
+
+    TArray<FVector3d> Vertices;
+    TArray<FIntVector3> Plates;
+    MakeSphere(16, 32, Vertices, Plates);
+
+    MaxQ::Dsk::FShapeMeshPtr Mesh = MaxQ::Dsk::FShapeMesh::Build(MoveTemp(Vertices), MoveTemp(Plates));
+
+    TArray<uint8> Data;
+    FMemoryWriter Writer(Data);
+    Writer << const_cast<MaxQ::Dsk::FShapeMesh&>(*Mesh);
+
+    MaxQ::Dsk::FShapeMesh Loaded;
+    FMemoryReader Reader(Data);
+    Reader << Loaded;
+
+    ASSERT_FALSE(Reader.IsError());
+    EXPECT_EQ(Loaded.NumPlates, Mesh->NumPlates);
+    EXPECT_GT(Loaded.GetAllocatedSize(), 0u);
+    ASSERT_EQ(Loaded.Tiles.Num(), Mesh->Tiles.Num());
+    ASSERT_EQ(Loaded.Tiles[0].Lods.Num(), Mesh->Tiles[0].Lods.Num());
+    EXPECT_TRUE(Loaded.Tiles[0].Lods.Last().Indices == Mesh->Tiles[0].Lods.Last().Indices);
+    EXPECT_TRUE(Loaded.Tiles[0].Lods[0].Positions == Mesh->Tiles[0].Lods[0].Positions);
+}
+
+
+TEST(dsk_mesh_test, Builder_Reads_Loaded_Dsk_In_Chunks) {
+
+    USpice::init_all();
+    USpice::clear_all();
+    USpice::furnsh_absolute("hera_v07.tf");
+    USpice::furnsh_absolute("g_01332mm_lgt_obj_didb_000n00000_v001.bds");
+
+    MaxQ::Dsk::FMeshSettings Settings;
+    Settings.ChunkSize = 256;
+    Settings.bUseDerivedDataCache = false;
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TSharedPtr<MaxQ::Dsk::FShapeMeshBuilder> Builder = MaxQ::Dsk::FShapeMeshBuilder::Start(DimorphosId, {}, Settings, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_TRUE(Builder.IsValid());
+
+    // A zero budget reads one chunk per tick
+    int32 Ticks = 0;
+    const double Start = FPlatformTime::Seconds();
+    while (!Builder->Tick(0.) && FPlatformTime::Seconds() - Start < 60.)
+    {
+        ++Ticks;
+        FPlatformProcess::Sleep(0.f);
+    }
+    ASSERT_TRUE(Builder->IsDone());
+    EXPECT_TRUE(Builder->GetError().IsEmpty());
+    EXPECT_GT(Ticks, 2);
+    EXPECT_FLOAT_EQ(Builder->GetProgress(), 1.f);
+
+    MaxQ::Dsk::FShapeMeshPtr Mesh = Builder->GetResult();
+    ASSERT_TRUE(Mesh.IsValid());
+
+    MaxQ::Dsk::FPlateModelPtr Model = MaxQ::Dsk::FPlateModel::Load(DimorphosId, {});
+    ASSERT_TRUE(Model.IsValid());
+    EXPECT_EQ(Mesh->NumPlates, Model->NumPlates());
+    EXPECT_EQ(Mesh->NumVertices, Model->NumVertices());
+    EXPECT_EQ(Mesh->FrameId, DimorphosId);
+    EXPECT_EQ(CountTriangles(*Mesh, 0), Model->NumPlates());
+
+    // Nothing loaded for this body
+    Builder = MaxQ::Dsk::FShapeMeshBuilder::Start(399, {}, Settings, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(Builder.IsValid());
+}
+
+
+// Not a pass/fail test, reports conversion time and peak memory for a large
+// (1M plate) model
+TEST(dsk_mesh_test, Benchmark_Large_Model) {
+
+    TArray<FVector3d> Vertices;
+    TArray<FIntVector3> Plates;
+    MakeSphere(500, 1000, Vertices, Plates);
+    const int32 NumPlates = Plates.Num();
+    const SIZE_T InputBytes = Vertices.GetAllocatedSize() + Plates.GetAllocatedSize();
+
+    MaxQ::Dsk::FMeshSettings Settings;
+    Settings.TilesPerFace = 8;
+
+    MaxQ::Dsk::FMeshStats Stats;
+    MaxQ::Dsk::FShapeMeshPtr Mesh = MaxQ::Dsk::FShapeMesh::Build(MoveTemp(Vertices), MoveTemp(Plates), Settings, &Stats);
+    ASSERT_TRUE(Mesh.IsValid());
+
+    printf("[ BENCHMARK] %d plates: %.1f ms, %d tiles, %d triangles over %d LODs, input %.1f MB, peak %.1f MB, output %.1f MB\n",
+        NumPlates, 1e3 * Stats.BuildSeconds, Stats.Tiles, Stats.Triangles, Settings.NumLods,
+        InputBytes / 1048576., Stats.PeakBytes / 1048576., Mesh->GetAllocatedSize() / 1048576.);
+}
@@ -0,0 +1,261 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceEclipse.h"
+#include "SpiceData.h"
+#include "SpiceEphemeris.h"
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    // FAKEBODY9994 stands in for the sun, FAKEBODY9993 for the planet
+    const FName Source(TEXT("FAKEBODY9994"));
+    const FName Occulter(TEXT("FAKEBODY9993"));
+    const FName Frame(TEXT("J2000"));
+
+    const std::string ObserverSpk = TestFilePath("eclipse_test_observers.bsp");
+    const int32 FirstObserver = -999001;
+
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    }
+
+    FVector3d ToVector(const FSDistanceVector& v)
+    {
+        return FVector3d(v.x.km, v.y.km, v.z.km);
+    }
+
+    // Stationary observers at Positions (relative to the occulter), so
+    // occult_c can be asked about each of them
+    void WriteObservers(const TArray<FVector3d>& Positions)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        int Handle = 0;
+
+        std::remove(ObserverSpk.c_str());
+        USpice::spkopn(ResultCode, ErrorMessage, ObserverSpk.c_str(), TEXT("ECLIPSE TEST"), 0, Handle);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        const FSEphemerisTime First = et0 - FSEphemerisPeriod(3600.), Last = et0 + FSEphemerisPeriod(3600.);
+        for (int32 i = 0; i < Positions.Num(); ++i)
+        {
+            // prop2b rejects a zero velocity:  a circular orbit about a
+            // negligible mass stays put instead
+            constexpr double Tiny = 1e-30;
+            const FVector3d Along = (FVector3d::ZAxisVector ^ Positions[i]).GetSafeNormal() * sqrt(Tiny / Positions[i].Length());
+            const FSDistanceVector Position(Positions[i].X, Positions[i].Y, Positions[i].Z);
+            const TArray<FSPKType5Observation> States = {
+                FSPKType5Observation(et0, FSStateVector(Position, FSVelocityVector(Along.X, Along.Y, Along.Z)))
+            };
+            USpice::spkw05(ResultCode, ErrorMessage, Handle, FirstObserver - i, 9993, Frame.ToString(), First, Last, TEXT("OBSERVER"), FSMassConstant(Tiny), States);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        }
+
+        USpice::spkcls(ResultCode, ErrorMessage, Handle);
+        USpice::furnsh_absolute(ObserverSpk.c_str());
+    }
+}
+
+
+TEST(eclipse_test, Matches_Occult) {
+
+    LoadKernels();
+
+    FSDistanceVector SourceRadii, OcculterRadii;
+    MaxQ::Data::Bodvrd(SourceRadii, Source, FName(TEXT("RADII")));
+    MaxQ::Data::Bodvrd(OcculterRadii, Occulter, FName(TEXT("RADII")));
+    const double Rs = SourceRadii.x.km, Ro = OcculterRadii.x.km;
+
+    const FVector3d ToSource = ToVector(MaxQ::Ephemeris::Spkpos(et0, Source, Occulter, Frame));
+    const double D = ToSource.Size();
+    const FVector3d Axis = -ToSource / D;
+    FVector3d U, V;
+    Axis.FindBestAxisVectors(U, V);
+
+    // Along the shadow axis, inside and beyond the umbra's tip, and across
+    // the umbra, penumbra and out into full light
+    const double UmbraLength = D * Ro / (Rs - Ro);
+    TArray<FVector3d> Positions;
+    for (double Along : { 0.6, 0.85, 1.6, 2.7 })
+    {
+        const double x = Along * UmbraLength;
+        const double Penumbra = Ro + x * (Rs + Ro) / D;
+        for (double Across : { 0., 0.27, 0.63, 0.91, 1.13, 1.47 })
+        {
+            for (int32 Spoke = 0; Spoke < 4; ++Spoke)
+            {
+                const double Angle = UE_DOUBLE_HALF_PI * Spoke + 0.3;
+                Positions.Add(x * Axis + Across * Penumbra * (FMath::Cos(Angle) * U + FMath::Sin(Angle) * V));
+            }
+        }
+    }
+    // On the lit side
+    Positions.Add(-3. * Ro * Axis);
+
+    WriteObservers(Positions);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TSharedPtr<MaxQ::Eclipse::FEclipseEngine> Engine = MaxQ::Eclipse::FEclipseEngine::Create(Source, { Occulter }, Occulter, Frame, true, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_TRUE(Engine.IsValid());
+
+    Engine->Update(et0, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    MaxQ::Eclipse::FPositionBatch Batch;
+    for (int32 i = 0; i < Positions.Num(); ++i)
+    {
+        Batch.Add(ToVector(MaxQ::Ephemeris::Spkpos(et0, FName(*FString::FromInt(FirstObserver - i)), Occulter, Frame)));
+    }
+
+    TArray<float> Visible;
+    TArray<ES_OccultationType> Shadow;
+    Engine->Evaluate(Batch, Visible, Shadow);
+    ASSERT_EQ(Shadow.Num(), Positions.Num());
+
+    TMap<ES_OccultationType, int32> Seen;
+    int32 Mismatched = 0;
+    for (int32 i = 0; i < Positions.Num(); ++i)
+    {
+        ES_OccultationType ocltid;
+        FString front, back;
+        USpice::occult(ResultCode, ErrorMessage, ocltid, front, back, et0, {}, {},
+            Source.ToString(), ES_GeometricModel::ELLIPSOID, TEXT("IAU_FAKEBODY9994"),
+            Occulter.ToString(), ES_GeometricModel::ELLIPSOID, TEXT("IAU_FAKEBODY9993"),
+            ES_AberrationCorrectionForOccultation::None, FString::FromInt(FirstObserver - i));
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        // Transits (the occulter in back) aren't eclipses
+        const ES_OccultationType Expected = front == Occulter.ToString() ? ocltid : ES_OccultationType::NONE;
+        Mismatched += Shadow[i] != Expected;
+        Seen.FindOrAdd(Expected)++;
+
+        // Agrees with the single position version
+        float Single;
+        EXPECT_EQ(Engine->Evaluate(Batch.Get(i), &Single), Shadow[i]);
+        EXPECT_FLOAT_EQ(Single, Visible[i]);
+
+        switch (Shadow[i])
+        {
+        case ES_OccultationType::NONE: EXPECT_EQ(Visible[i], 1.f); break;
+        case ES_OccultationType::FULL: EXPECT_EQ(Visible[i], 0.f); break;
+        default: EXPECT_GT(Visible[i], 0.f); EXPECT_LT(Visible[i], 1.f); break;
+        }
+    }
+
+    // Every case was exercised, and the ellipsoid approximation only differs
+    // right at a boundary
+    EXPECT_GT(Seen.FindRef(ES_OccultationType::NONE), 0);
+    EXPECT_GT(Seen.FindRef(ES_OccultationType::PARTIAL), 0);
+    EXPECT_GT(Seen.FindRef(ES_OccultationType::ANNULAR), 0);
+    EXPECT_GT(Seen.FindRef(ES_OccultationType::FULL), 0);
+    EXPECT_LE(Mismatched, 2);
+
+    USpice::clear_all();
+    std::remove(ObserverSpk.c_str());
+}
+
+
+TEST(eclipse_test, Penumbra_Fraction_Is_Monotonic) {
+
+    LoadKernels();
+
+    TSharedPtr<MaxQ::Eclipse::FEclipseEngine> Engine = MaxQ::Eclipse::FEclipseEngine::Create(Source, { Occulter }, Occulter, Frame, false);
+    ASSERT_TRUE(Engine.IsValid());
+    Engine->Update(et0);
+
+    FSDistanceVector SourceRadii, OcculterRadii;
+    MaxQ::Data::Bodvrd(SourceRadii, Source, FName(TEXT("RADII")));
+    MaxQ::Data::Bodvrd(OcculterRadii, Occulter, FName(TEXT("RADII")));
+
+    const FVector3d ToSource = ToVector(MaxQ::Ephemeris::Spkpos(et0, Source, Occulter, Frame));
+    const FVector3d Axis = -ToSource.GetSafeNormal();
+    FVector3d U, V;
+    Axis.FindBestAxisVectors(U, V);
+
+    // Walking sideways out of the umbra, it only gets brighter
+    const double Ro = OcculterRadii.x.km;
+    const double Behind = 0.7 * ToSource.Size() * Ro / (SourceRadii.x.km - Ro);
+    MaxQ::Eclipse::FPositionBatch Batch;
+    for (int32 i = 0; i <= 200; ++i)
+    {
+        Batch.Add(Behind * Axis + 0.02 * Ro * i * U);
+    }
+
+    TArray<float> Visible;
+    TArray<ES_OccultationType> Shadow;
+    Engine->Evaluate(Batch, Visible, Shadow);
+
+    EXPECT_EQ(Shadow[0], ES_OccultationType::FULL);
+    EXPECT_EQ(Shadow.Last(), ES_OccultationType::NONE);
+    for (int32 i = 1; i < Visible.Num(); ++i)
+    {
+        EXPECT_GE(Visible[i], Visible[i - 1]);
+    }
+}
+
+
+// 100k positions per frame:  reports Update + Evaluate time, and checks it
+// fits in a 30 Hz frame
+TEST(eclipse_test, Benchmark_100k) {
+
+    LoadKernels();
+
+    TSharedPtr<MaxQ::Eclipse::FEclipseEngine> Engine = MaxQ::Eclipse::FEclipseEngine::Create(Source, { Occulter }, Occulter, Frame, true);
+    ASSERT_TRUE(Engine.IsValid());
+
+    std::mt19937 Random(1);
+    std::uniform_real_distribution<double> Coordinate(-500., 500.);
+    MaxQ::Eclipse::FPositionBatch Batch;
+    Batch.Reset(100000);
+    for (int32 i = 0; i < 100000; ++i)
+    {
+        Batch.Add(FVector3d(Coordinate(Random), Coordinate(Random), Coordinate(Random)));
+    }
+
+    TArray<float> Visible;
+    TArray<ES_OccultationType> Shadow;
+    const int32 Frames = 20;
+    const double Start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < Frames; ++i)
+    {
+        Engine->Update(et0 + FSEphemerisPeriod(i));
+        Engine->Evaluate(Batch, Visible, Shadow);
+    }
+    const double Seconds = (FPlatformTime::Seconds() - Start) / Frames;
+
+    printf("[ BENCHMARK] %d positions: %.2f ms per frame, %.1f M positions/s\n",
+        Batch.Num(), 1e3 * Seconds, Batch.Num() / Seconds / 1e6);
+    ASSERT_EQ(Shadow.Num(), Batch.Num());
+    EXPECT_LT(Seconds, 1. / 30.);
+}
+
+
+TEST(eclipse_test, Bad_Inputs) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TSharedPtr<MaxQ::Eclipse::FEclipseEngine> Engine = MaxQ::Eclipse::FEclipseEngine::Create(FName(TEXT("NOT_A_BODY")), { Occulter }, Occulter, Frame, true, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(Engine.IsValid());
+
+    Engine = MaxQ::Eclipse::FEclipseEngine::Create(Source, { Occulter }, Occulter, Frame, true, &ResultCode, &ErrorMessage);
+    ASSERT_TRUE(Engine.IsValid());
+    Engine->Update(FSEphemerisTime(-1e12), ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+}
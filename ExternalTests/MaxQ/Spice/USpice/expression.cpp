@@ -0,0 +1,213 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "SpiceK2.h"
+#include "SpiceExpression.h"
+
+using MaxQ::Math::EExpressionType;
+using MaxQ::Math::FExpression;
+
+
+namespace
+{
+    // unorm(m * r + dr), as the micro-op nodes would compute it
+    FSDimensionlessVector ByNodeChain(const FSRotationMatrix& m, const FSDistanceVector& r, const FSDistanceVector& dr)
+    {
+        FSDimensionlessVector mr = USpiceK2::mxv_vector_K2(m, USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(r));
+        FSDistanceVector sum = USpiceK2::Conv_SDimensionlessVectorToSDistanceVector_K2(
+            USpiceK2::vadd_vector_K2(mr, USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(dr))
+        );
+        FSDimensionlessVector vout;
+        double vmag;
+        USpiceK2::unorm_vector_K2(USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(sum), vout, vmag);
+        return vout;
+    }
+
+    const TArray<EExpressionType> MatrixAndDistances { EExpressionType::SRotationMatrix, EExpressionType::SDistanceVector, EExpressionType::SDistanceVector };
+}
+
+
+TEST(expression_test, Unorm_Mxv_Vadd_Matches_Node_Chain) {
+
+    FSRotationMatrix m;
+    USpice::rotate(FSAngle(0.75), ES_Axis::Y, m);
+    FSDistanceVector r(FSDistance(7000.), FSDistance(-1200.), FSDistance(300.));
+    FSDistanceVector dr(FSDistance(15.), FSDistance(42.), FSDistance(-8.));
+
+    FString ErrorMessage;
+    TSharedPtr<FExpression> Expression = FExpression::Compile(TEXT("unorm(m * r + dr)"), MatrixAndDistances, ErrorMessage);
+    ASSERT_TRUE(Expression.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Expression->GetResultType(), EExpressionType::SDimensionlessVector);
+
+    FSDimensionlessVector Result;
+    const void* Operands[] { &m, &r, &dr };
+    Expression->Evaluate(Operands, &Result);
+
+    FSDimensionlessVector Expected = ByNodeChain(m, r, dr);
+    EXPECT_NEAR(Result.x, Expected.x, 1e-14);
+    EXPECT_NEAR(Result.y, Expected.y, 1e-14);
+    EXPECT_NEAR(Result.z, Expected.z, 1e-14);
+}
+
+TEST(expression_test, Operand_Names_In_Order_Of_Appearance) {
+
+    TArray<FString> Names;
+    FString ErrorMessage;
+    ASSERT_TRUE(FExpression::GetOperandNames(TEXT("vdot(a, B) * 2 + vnorm(b) / c"), Names, ErrorMessage));
+    ASSERT_EQ(Names.Num(), 3);
+    EXPECT_EQ(Names[0], TEXT("a"));
+    EXPECT_EQ(Names[1], TEXT("B"));
+    EXPECT_EQ(Names[2], TEXT("c"));
+
+    EXPECT_FALSE(FExpression::GetOperandNames(TEXT("unorm(a"), Names, ErrorMessage));
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+}
+
+TEST(expression_test, Unit_Errors_Are_Reported) {
+
+    FString ErrorMessage;
+
+    TArray<EExpressionType> DistanceAndVelocity { EExpressionType::SDistanceVector, EExpressionType::SVelocityVector };
+    EXPECT_FALSE(FExpression::Compile(TEXT("r + v"), DistanceAndVelocity, ErrorMessage).IsValid());
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+
+    // km * km has no MaxQ type
+    EXPECT_FALSE(FExpression::Compile(TEXT("vdot(r, r)"), { EExpressionType::SDistanceVector }, ErrorMessage).IsValid());
+
+    // ...but km / km is dimensionless, and scaling by a double keeps units
+    TSharedPtr<FExpression> Ratio = FExpression::Compile(TEXT("r / vnorm(r) * 2"), { EExpressionType::SDistanceVector }, ErrorMessage);
+    ASSERT_TRUE(Ratio.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Ratio->GetResultType(), EExpressionType::SDimensionlessVector);
+
+    TSharedPtr<FExpression> Scaled = FExpression::Compile(TEXT("-0.5 * v"), { EExpressionType::SVelocityVector }, ErrorMessage);
+    ASSERT_TRUE(Scaled.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Scaled->GetResultType(), EExpressionType::SVelocityVector);
+
+    EXPECT_FALSE(FExpression::Compile(TEXT("unknown(r)"), { EExpressionType::SDistanceVector }, ErrorMessage).IsValid());
+}
+
+TEST(expression_test, Program_String_Round_Trips) {
+
+    FString ErrorMessage;
+    TSharedPtr<FExpression> Expression = FExpression::Compile(TEXT("unorm(m * r + dr)"), MatrixAndDistances, ErrorMessage);
+    ASSERT_TRUE(Expression.IsValid());
+
+    const FExpression* Program = FExpression::FindOrCompileProgram(FName(Expression->GetProgramString()));
+    ASSERT_NE(Program, nullptr);
+    ASSERT_TRUE(Program->IsValid());
+    EXPECT_EQ(Program->GetProgramString(), Expression->GetProgramString());
+    EXPECT_EQ(Program->NumOperands(), 3);
+
+    // Cached
+    EXPECT_EQ(FExpression::FindOrCompileProgram(FName(Expression->GetProgramString())), Program);
+
+    // Bad programs are never null, and keep their operand count
+    const FExpression* Bad = FExpression::FindOrCompileProgram(FName(TEXT("SDistanceVector,SVelocityVector|($0+$1)")));
+    ASSERT_NE(Bad, nullptr);
+    EXPECT_FALSE(Bad->IsValid());
+    EXPECT_EQ(Bad->NumOperands(), 2);
+}
+
+TEST(expression_test, Too_Many_Operands_Are_Rejected) {
+
+    // One more operand than execexpression_K2 can hold
+    const int32 Count = FExpression::MaxOperands + 1;
+    FString Source, Types, Body;
+    for (int32 i = 0; i < Count; ++i)
+    {
+        Source += FString::Printf(TEXT("%sa%d"), i ? TEXT(" + ") : TEXT(""), i);
+        Types += FString::Printf(TEXT("%sDouble"), i ? TEXT(",") : TEXT(""));
+        Body += FString::Printf(TEXT("%s$%d"), i ? TEXT("+") : TEXT(""), i % 10);
+    }
+
+    TArray<FString> OperandNames;
+    FString ErrorMessage;
+    EXPECT_FALSE(FExpression::GetOperandNames(Source, OperandNames, ErrorMessage));
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    // A program string with too many operand types doesn't compile either,
+    // but still counts them all
+    const FExpression* Program = FExpression::FindOrCompileProgram(FName(Types + TEXT("|") + Body));
+    ASSERT_NE(Program, nullptr);
+    EXPECT_FALSE(Program->IsValid());
+    EXPECT_EQ(Program->NumOperands(), Count);
+}
+
+TEST(expression_test, State_Transform_And_Vsep) {
+
+    // Built-in inertial frames, no kernels needed
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSStateTransform xform;
+    USpice::sxform(ResultCode, ErrorMessage, xform, FSEphemerisTime::J2000, TEXT("J2000"), TEXT("ECLIPJ2000"));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FSStateVector state(FSDistanceVector(FSDistance(1.), FSDistance(2.), FSDistance(3.)), FSVelocityVector(FSSpeed(4.), FSSpeed(5.), FSSpeed(6.)));
+
+    TSharedPtr<FExpression> Expression = FExpression::Compile(TEXT("x * s"), { EExpressionType::SStateTransform, EExpressionType::SStateVector }, ErrorMessage);
+    ASSERT_TRUE(Expression.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    FSStateVector Result;
+    const void* Operands[] { &xform, &state };
+    Expression->Evaluate(Operands, &Result);
+
+    FSStateVector Expected = USpiceK2::Conv_SDimensionlessStateVectorToSStateVector_K2(
+        USpiceK2::mxv_state_vector_K2(xform, USpiceK2::Conv_SStateVectorToSDimensionlessStateVector_K2(state))
+    );
+    EXPECT_NEAR(Result.r.y.km, Expected.r.y.km, 1e-12);
+    EXPECT_NEAR(Result.v.dz.kmps, Expected.v.dz.kmps, 1e-12);
+
+    TSharedPtr<FExpression> Separation = FExpression::Compile(TEXT("vsep(a, b)"), { EExpressionType::SDimensionlessVector, EExpressionType::SDimensionlessVector }, ErrorMessage);
+    ASSERT_TRUE(Separation.IsValid());
+    FSDimensionlessVector a(1., 0., 0.), b(0., 1., 0.);
+    FSAngle Angle;
+    const void* VectorOperands[] { &a, &b };
+    Separation->Evaluate(VectorOperands, &Angle);
+    double half_pi;
+    USpice::halfpi(half_pi);
+    EXPECT_NEAR(Angle.AsRadians(), half_pi, 1e-15);
+}
+
+// The Blueprint VM isn't available here, so the node chain is measured as the
+// native calls it compiles to.  In a Blueprint each of those is also a VM
+// dispatch plus a temporary, so the real ratio is larger.
+TEST(expression_test, Benchmark_Expression_vs_Node_Chain) {
+
+    constexpr int Iterations = 100000;
+
+    FSRotationMatrix m;
+    USpice::rotate(FSAngle(0.25), ES_Axis::X, m);
+    FSDistanceVector r(FSDistance(7000.), FSDistance(-1200.), FSDistance(300.));
+    FSDistanceVector dr(FSDistance(15.), FSDistance(42.), FSDistance(-8.));
+
+    FString ErrorMessage;
+    TSharedPtr<FExpression> Expression = FExpression::Compile(TEXT("unorm(m * r + dr)"), MatrixAndDistances, ErrorMessage);
+    ASSERT_TRUE(Expression.IsValid());
+
+    FSDimensionlessVector ByChain, ByExpression;
+    const void* Operands[] { &m, &r, &dr };
+
+    double Start = FPlatformTime::Seconds();
+    for (int i = 0; i < Iterations; ++i)
+    {
+        ByChain = ByNodeChain(m, r, dr);
+    }
+    const double ChainSeconds = FPlatformTime::Seconds() - Start;
+
+    Start = FPlatformTime::Seconds();
+    for (int i = 0; i < Iterations; ++i)
+    {
+        Expression->Evaluate(Operands, &ByExpression);
+    }
+    const double ExpressionSeconds = FPlatformTime::Seconds() - Start;
+
+    EXPECT_NEAR(ByChain.x, ByExpression.x, 1e-15);
+
+    printf("[ BENCHMARK] unorm(m * r + dr): node chain %.1f ns, expression %.1f ns\n",
+        1e9 * ChainSeconds / Iterations, 1e9 * ExpressionSeconds / Iterations);
+}
@@ -6,6 +6,7 @@
 // GitHub:         https://github.com/Gamergenic1/MaxQ/ 
 
 #include "pch.h"
+#include "MaxQTestDefinitions.h"
 
 
 TEST(furnsh_test, DefaultsTestCase) {
@@ -40,3 +41,27 @@ TEST(furnsh_test, DefaultsTestCase) {
     */
 }
 
+
+TEST(furnsh_test, Missing_File_Is_Error) {
+
+    USpice::init_all();
+    USpice::clear_all();
+
+    // The refresh after a load mustn't swallow the load's error
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    USpice::furnsh_absolute(TestFilePath("maxq_no_such_kernel.bsp").c_str());
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    int Count = -1;
+    USpice::ktotal(Count);
+    EXPECT_EQ(Count, 0);
+
+    USpice::furnsh_absolute(TestFilePath("maxq_unit_test_meta.tm").c_str());
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    USpice::clear_all();
+}
@@ -0,0 +1,246 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceIllumination.h"
+#include "SpiceData.h"
+#include "SpiceDsk.h"
+#include <cstdio>
+
+namespace
+{
+    const FName Target(TEXT("FAKEBODY9994"));
+    const FName Fixref(TEXT("IAU_FAKEBODY9994"));
+    const FName Observer(TEXT("FAKEBODY9993"));
+    const FName Source(TEXT("FAKEBODY9995"));
+
+    // FAKEBODY9994 turns 3600 degrees a day.  Seen from 1e5 km (a third of
+    // a light second), that's 2.4e-4 radians of rotation over the light time.
+    const FName DistantObserver(TEXT("-999101"));
+    const std::string DistantObserverSpk = TestFilePath("illumination_test_observer.bsp");
+
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    }
+
+    FVector3d ToVector(const FSDistanceVector& v)
+    {
+        return FVector3d(v.x.km, v.y.km, v.z.km);
+    }
+
+    // A stationary state:  prop2b rejects a zero velocity, so a circular
+    // orbit about a negligible mass
+    void WriteStationary(int Handle, int Body, int Center, const FVector3d& Position)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+
+        constexpr double Tiny = 1e-30;
+        const FVector3d Along = (FVector3d::ZAxisVector ^ Position).GetSafeNormal() * sqrt(Tiny / Position.Length());
+        const TArray<FSPKType5Observation> States = {
+            FSPKType5Observation(et0, FSStateVector(FSDistanceVector(Position.X, Position.Y, Position.Z), FSVelocityVector(Along.X, Along.Y, Along.Z)))
+        };
+
+        const FSEphemerisTime First = et0 - FSEphemerisPeriod(3600.), Last = et0 + FSEphemerisPeriod(3600.);
+        USpice::spkw05(ResultCode, ErrorMessage, Handle, Body, Center, TEXT("J2000"), First, Last, TEXT("ILLUMINATION TEST"), FSMassConstant(Tiny), States);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    }
+
+    // The unit test SPK has no path to the solar system barycenter, which
+    // stellar aberration needs:  the source is placed relative to it, and the
+    // distant observer relative to the target.
+    void WriteDistantObserver()
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        int Handle = 0;
+
+        std::remove(DistantObserverSpk.c_str());
+        USpice::spkopn(ResultCode, ErrorMessage, DistantObserverSpk.c_str(), TEXT("ILLUMINATION TEST"), 0, Handle);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        WriteStationary(Handle, 9995, 0, FVector3d(1.5e8, 0., 0.));
+        WriteStationary(Handle, -999101, 9994, FVector3d(6e4, 8e4, 0.));
+
+        USpice::spkcls(ResultCode, ErrorMessage, Handle);
+        USpice::furnsh_absolute(DistantObserverSpk.c_str());
+    }
+
+    // Compares every texel to illumf_c at the same point and ET, as seen
+    // from the distant observer
+    void CompareToIllumf(ES_AberrationCorrectionWithTransmissions abcorr, double Tolerance)
+    {
+        WriteDistantObserver();
+
+        FSDistanceVector Radii;
+        MaxQ::Data::Bodvrd(Radii, Target, FName(TEXT("RADII")));
+
+        const MaxQ::Illumination::FSurfacePoints Grid = MaxQ::Illumination::FSurfacePoints::EllipsoidGrid(Radii, 24, 12);
+        const TArray<FSEphemerisTime> Ets = { et0, et0 + FSEphemerisPeriod(60.), et0 + FSEphemerisPeriod(120.) };
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        TArray<FVector4f> Texels;
+        MaxQ::Illumination::Bake(Texels, Grid, Ets, Target, Fixref, DistantObserver, Source, abcorr, nullptr, &ResultCode, &ErrorMessage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        ASSERT_EQ(Texels.Num(), Ets.Num() * Grid.Num());
+
+        int32 Lit = 0, Mismatched = 0;
+        for (int32 e = 0; e < Ets.Num(); ++e)
+        {
+            for (int32 p = 0; p < Grid.Num(); ++p)
+            {
+                const FVector3d& Point = Grid.Points[p];
+                FSEphemerisTime trgepc;
+                FSDistanceVector srfvec;
+                FSAngle phase, incdnc, emissn;
+                bool visibl, lit;
+                USpice::illumf(ResultCode, ErrorMessage, trgepc, srfvec, phase, incdnc, emissn, visibl, lit, Ets[e], FSDistanceVector(Point.X, Point.Y, Point.Z), {},
+                    ES_GeometricModel::ELLIPSOID, Target.ToString(), Source.ToString(), Fixref.ToString(), abcorr, DistantObserver.ToString());
+                ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+                const FVector4f& Texel = Texels[e * Grid.Num() + p];
+                EXPECT_NEAR(Texel.X, incdnc.AsRadians(), Tolerance);
+                EXPECT_NEAR(Texel.Y, emissn.AsRadians(), Tolerance);
+                EXPECT_NEAR(Texel.Z, phase.AsRadians(), Tolerance);
+
+                // Only points on the terminator may disagree, from the light time
+                // across the body
+                if ((Texel.W > 0.f) != lit && FMath::Abs(incdnc.AsRadians() - UE_DOUBLE_HALF_PI) > Tolerance)
+                {
+                    ++Mismatched;
+                }
+                Lit += lit;
+            }
+        }
+        EXPECT_EQ(Mismatched, 0);
+        EXPECT_GT(Lit, 0);
+        EXPECT_LT(Lit, Texels.Num());
+    }
+}
+
+
+TEST(illumination_test, Ellipsoid_Grid) {
+
+    const FSDistanceVector Radii(3., 2., 1.);
+    const MaxQ::Illumination::FSurfacePoints Grid = MaxQ::Illumination::FSurfacePoints::EllipsoidGrid(Radii, 8, 4);
+    ASSERT_EQ(Grid.Num(), 32);
+    ASSERT_EQ(Grid.Normals.Num(), 32);
+
+    for (int32 i = 0; i < Grid.Num(); ++i)
+    {
+        const FVector3d& Point = Grid.Points[i];
+        EXPECT_NEAR(FMath::Square(Point.X / 3.) + FMath::Square(Point.Y / 2.) + FMath::Square(Point.Z / 1.), 1., 1e-12);
+        EXPECT_NEAR(Grid.Normals[i].Size(), 1., 1e-12);
+        EXPECT_GT(Grid.Normals[i] | Point, 0.);
+    }
+
+    // North at the top, starting from -180 lon
+    EXPECT_GT(Grid.Points[0].Z, 0.);
+    EXPECT_LT(Grid.Points[31].Z, 0.);
+    EXPECT_LT(Grid.Points[0].X, 0.);
+    EXPECT_LT(Grid.Points[0].Y, 0.);
+}
+
+
+TEST(illumination_test, Matches_Illumf) {
+
+    LoadKernels();
+    CompareToIllumf(ES_AberrationCorrectionWithTransmissions::None, 1e-5);
+}
+
+
+TEST(illumination_test, Matches_Illumf_With_Light_Time) {
+
+    LoadKernels();
+    CompareToIllumf(ES_AberrationCorrectionWithTransmissions::LT_S, 1e-5);
+}
+
+
+TEST(illumination_test, Matches_Illumf_With_Transmission) {
+
+    LoadKernels();
+    CompareToIllumf(ES_AberrationCorrectionWithTransmissions::XCN_S, 1e-5);
+}
+
+
+TEST(illumination_test, Plate_Model_Casts_Shadows) {
+
+    LoadKernels();
+
+    FSDistanceVector Radii;
+    MaxQ::Data::Bodvrd(Radii, Target, FName(TEXT("RADII")));
+    const MaxQ::Illumination::FSurfacePoints Grid = MaxQ::Illumination::FSurfacePoints::EllipsoidGrid(Radii, 24, 12);
+    const TArray<FSEphemerisTime> Ets = { et0 };
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSDistanceVector SourcePosition;
+    FSEphemerisPeriod lt;
+    USpice::spkpos(ResultCode, ErrorMessage, et0, SourcePosition, lt, Source.ToString(), Target.ToString(), Fixref.ToString());
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    // A square, wider than the body, halfway to the source
+    const FVector3d Axis = ToVector(SourcePosition).GetSafeNormal();
+    FVector3d U, V;
+    Axis.FindBestAxisVectors(U, V);
+    const FVector3d Center = 0.5 * ToVector(SourcePosition);
+    ASSERT_GT(Center.Size(), 2. * Radii.x.km);
+    const double HalfWidth = 4. * Radii.x.km;
+
+    TArray<FVector3d> Vertices = { Center - HalfWidth * (U + V), Center + HalfWidth * (U - V), Center + HalfWidth * (U + V), Center - HalfWidth * (U - V) };
+    TArray<FIntVector3> Plates = { FIntVector3(0, 1, 2), FIntVector3(0, 2, 3) };
+    const MaxQ::Dsk::FPlateModel Blocker(MoveTemp(Vertices), MoveTemp(Plates));
+
+    // Behind the body instead, so it shadows nothing
+    Vertices = { -Center - HalfWidth * (U + V), -Center + HalfWidth * (U - V), -Center + HalfWidth * (U + V), -Center - HalfWidth * (U - V) };
+    Plates = { FIntVector3(0, 1, 2), FIntVector3(0, 2, 3) };
+    const MaxQ::Dsk::FPlateModel Behind(MoveTemp(Vertices), MoveTemp(Plates));
+
+    TArray<FVector4f> Unshadowed, Shadowed, Unblocked;
+    MaxQ::Illumination::Bake(Unshadowed, Grid, Ets, Target, Fixref, Observer, Source, ES_AberrationCorrectionWithTransmissions::None, nullptr, &ResultCode, &ErrorMessage);
+    MaxQ::Illumination::Bake(Shadowed, Grid, Ets, Target, Fixref, Observer, Source, ES_AberrationCorrectionWithTransmissions::None, &Blocker, &ResultCode, &ErrorMessage);
+    MaxQ::Illumination::Bake(Unblocked, Grid, Ets, Target, Fixref, Observer, Source, ES_AberrationCorrectionWithTransmissions::None, &Behind, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    int32 Lit = 0;
+    for (int32 p = 0; p < Grid.Num(); ++p)
+    {
+        Lit += Unshadowed[p].W > 0.f;
+        EXPECT_EQ(Shadowed[p].W, 0.f);
+        EXPECT_EQ(Unblocked[p].W, Unshadowed[p].W);
+
+        // Shadows only change the lit flag
+        EXPECT_EQ(Shadowed[p].X, Unshadowed[p].X);
+    }
+    EXPECT_GT(Lit, 0);
+}
+
+
+TEST(illumination_test, Bad_Inputs) {
+
+    LoadKernels();
+
+    MaxQ::Illumination::FSurfacePoints Points;
+    Points.Points.Add(FVector3d(100., 0., 0.));
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FVector4f> Texels;
+    MaxQ::Illumination::Bake(Texels, Points, { et0 }, Target, Fixref, Observer, Source, ES_AberrationCorrectionWithTransmissions::None, nullptr, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_EQ(Texels.Num(), 0);
+
+    Points.Normals.Add(FVector3d(1., 0., 0.));
+    MaxQ::Illumination::Bake(Texels, Points, { et0 }, FName(TEXT("NOT_A_BODY")), Fixref, Observer, Source, ES_AberrationCorrectionWithTransmissions::None, nullptr, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+}
@@ -0,0 +1,129 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+
+
+TEST(interned_names_test, Same_Name_Same_Pointer) {
+
+    const ANSICHAR* a = MaxQ::Core::ToANSIString(FName(TEXT("FAKEBODY9994")));
+    const ANSICHAR* b = MaxQ::Core::ToANSIString(FName(TEXT("FAKEBODY9994")));
+    const ANSICHAR* c = MaxQ::Core::ToANSIString(FName(TEXT("FAKEBODY9995")));
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_STREQ(a, "FAKEBODY9994");
+    EXPECT_STREQ(c, "FAKEBODY9995");
+
+    // FName numbers are part of the name
+    EXPECT_STREQ(MaxQ::Core::ToANSIString(FName(TEXT("BODY_1"))), "BODY_1");
+}
+
+TEST(interned_names_test, Spkezr_Matches_Base_API) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSStateVector state;
+    FSEphemerisPeriod lt;
+    MaxQ::Ephemeris::Spkezr(state, lt, et0, FName(TEXT("FAKEBODY9994")), FName(TEXT("FAKEBODY9995")), FName(TEXT("ECLIPJ2000")), ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+    EXPECT_EQ(IsNear(state, state_target_9994_center_9995_eclipj2000_et0), true);
+
+    FSDistanceVector r = MaxQ::Ephemeris::Spkpos(et0, FName(TEXT("FAKEBODY9994")), FName(TEXT("FAKEBODY9995")), FName(TEXT("ECLIPJ2000")), ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(r.x.km, state.r.x.km);
+    EXPECT_DOUBLE_EQ(r.y.km, state.r.y.km);
+    EXPECT_DOUBLE_EQ(r.z.km, state.r.z.km);
+}
+
+TEST(interned_names_test, Spkezr_Reports_Errors) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    MaxQ::Ephemeris::Spkezr(et0, FName(TEXT("FAKEBODY9994")), FName(TEXT("FAKEBODY9995")), FName(TEXT("ECLIPJ2000")), ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+}
+
+TEST(interned_names_test, Bodvrd_FName_Matches_FString) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSMassConstant ByString = MaxQ::Data::Bodvrd<FSMassConstant>(FString(TEXT("FAKEBODY9993")), FString(TEXT("GM")), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FSMassConstant ByName = MaxQ::Data::Bodvrd<FSMassConstant>(FName(TEXT("FAKEBODY9993")), FName(TEXT("GM")), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    EXPECT_DOUBLE_EQ(ByName.GM, ByString.GM);
+}
+
+// Not a pass/fail test, reports the cost of a 500 body per-tick update
+// by FString (USpice) vs by FName (MaxQ::Ephemeris).
+TEST(interned_names_test, Benchmark_500_Bodies_Per_Tick) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    constexpr int Bodies = 500;
+    constexpr int Ticks = 20;
+
+    const FString TargetStrings[] = { TEXT("FAKEBODY9993"), TEXT("FAKEBODY9994") };
+    const FString Observer = TEXT("FAKEBODY9995");
+    const FString Frame = TEXT("ECLIPJ2000");
+
+    const FName TargetNames[] = { FName(*TargetStrings[0]), FName(*TargetStrings[1]) };
+    const FName ObserverName(*Observer);
+    const FName FrameName(*Frame);
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    FSStateVector ByString, ByName;
+    FSEphemerisPeriod lt;
+
+    double StringSeconds = 0., NameSeconds = 0.;
+
+    for (int tick = 0; tick < Ticks; ++tick)
+    {
+        FSEphemerisTime et = et0 + FSEphemerisPeriod(tick);
+
+        double Start = FPlatformTime::Seconds();
+        for (int i = 0; i < Bodies; ++i)
+        {
+            USpice::spkezr(ResultCode, ErrorMessage, et, ByString, lt, TargetStrings[i & 1], Observer, Frame);
+        }
+        StringSeconds += FPlatformTime::Seconds() - Start;
+
+        Start = FPlatformTime::Seconds();
+        for (int i = 0; i < Bodies; ++i)
+        {
+            MaxQ::Ephemeris::Spkezr(ByName, lt, et, TargetNames[i & 1], ObserverName, FrameName);
+        }
+        NameSeconds += FPlatformTime::Seconds() - Start;
+
+        EXPECT_EQ(IsNear(ByName, ByString), true);
+    }
+
+    printf("[ BENCHMARK] %d bodies x %d ticks: FString %.3f ms/tick, FName %.3f ms/tick\n",
+        Bodies, Ticks, 1000. * StringSeconds / Ticks, 1000. * NameSeconds / Ticks);
+}
@@ -0,0 +1,140 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "SpiceK2.h"
+
+
+namespace
+{
+    TArray<FSDimensionlessVector> MakeVectors(int32 n)
+    {
+        TArray<FSDimensionlessVector> v;
+        v.Reserve(n);
+        for (int32 i = 0; i < n; ++i)
+        {
+            v.Add(FSDimensionlessVector(1. + i, -2. * i, 0.5 * i + 3.));
+        }
+        return v;
+    }
+}
+
+
+TEST(k2_array_ops_test, Mxv_Array_Matches_Scalar) {
+
+    FSRotationMatrix m;
+    USpice::rotate(FSAngle(0.5), ES_Axis::Z, m);
+
+    TArray<FSDimensionlessVector> v = MakeVectors(17);
+    TArray<FSDimensionlessVector> vout = USpiceK2::mxv_vector_array_K2(m, v);
+
+    ASSERT_EQ(vout.Num(), v.Num());
+    for (int32 i = 0; i < v.Num(); ++i)
+    {
+        FSDimensionlessVector expected = USpiceK2::mxv_vector_K2(m, v[i]);
+        EXPECT_DOUBLE_EQ(vout[i].x, expected.x);
+        EXPECT_DOUBLE_EQ(vout[i].y, expected.y);
+        EXPECT_DOUBLE_EQ(vout[i].z, expected.z);
+    }
+}
+
+TEST(k2_array_ops_test, Vadd_Array_Broadcasts_Single_Element) {
+
+    TArray<FSDimensionlessVector> v = MakeVectors(5);
+    TArray<FSDimensionlessVector> offset { FSDimensionlessVector(10., 20., 30.) };
+
+    TArray<FSDimensionlessVector> sum = USpiceK2::vadd_vector_array_K2(v, offset);
+    ASSERT_EQ(sum.Num(), v.Num());
+    for (int32 i = 0; i < v.Num(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(sum[i].x, v[i].x + 10.);
+        EXPECT_DOUBLE_EQ(sum[i].y, v[i].y + 20.);
+        EXPECT_DOUBLE_EQ(sum[i].z, v[i].z + 30.);
+    }
+
+    TArray<FSDimensionlessVector> difference = USpiceK2::vsub_vector_array_K2(offset, v);
+    ASSERT_EQ(difference.Num(), v.Num());
+    EXPECT_DOUBLE_EQ(difference[4].x, 10. - v[4].x);
+
+    // Mismatched lengths are a wiring mistake, and yield nothing
+    EXPECT_EQ(USpiceK2::vadd_vector_array_K2(MakeVectors(3), MakeVectors(7)).Num(), 0);
+    EXPECT_EQ(USpiceK2::vsub_vector_array_K2(MakeVectors(7), MakeVectors(3)).Num(), 0);
+    EXPECT_EQ(USpiceK2::vadd_vector_array_K2(MakeVectors(3), TArray<FSDimensionlessVector>()).Num(), 0);
+}
+
+TEST(k2_array_ops_test, Unorm_Array_Matches_Scalar) {
+
+    TArray<FSDimensionlessVector> v = MakeVectors(9);
+    TArray<FSDimensionlessVector> vout;
+    TArray<double> vmag;
+
+    USpiceK2::unorm_vector_array_K2(v, vout, vmag);
+
+    ASSERT_EQ(vout.Num(), v.Num());
+    ASSERT_EQ(vmag.Num(), v.Num());
+    for (int32 i = 0; i < v.Num(); ++i)
+    {
+        FSDimensionlessVector expected;
+        double expectedMag;
+        USpiceK2::unorm_vector_K2(v[i], expected, expectedMag);
+        EXPECT_DOUBLE_EQ(vmag[i], expectedMag);
+        EXPECT_DOUBLE_EQ(vout[i].x, expected.x);
+    }
+}
+
+TEST(k2_array_ops_test, Array_Conversions_Round_Trip) {
+
+    TArray<FSDimensionlessVector> v = MakeVectors(4);
+    TArray<FSDistanceVector> r = USpiceK2::Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2(v);
+    TArray<FSDimensionlessVector> back = USpiceK2::Conv_SDistanceVectorArrayToSDimensionlessVectorArray_K2(r);
+
+    ASSERT_EQ(back.Num(), v.Num());
+    EXPECT_DOUBLE_EQ(r[3].x.km, v[3].x);
+    EXPECT_DOUBLE_EQ(back[3].z, v[3].z);
+}
+
+// The editor's Blueprint VM isn't available here, so the "loop" side is a
+// native per-element call through the scalar K2 function plus the array
+// bookkeeping a ForEach loop does (Get, Add).  A real Blueprint loop pays
+// VM dispatch on top of this, so the measured ratio is a lower bound.
+TEST(k2_array_ops_test, Benchmark_Loop_vs_Array_Node) {
+
+    constexpr int32 Vectors = 500;
+    constexpr int Ticks = 200;
+
+    FSRotationMatrix m;
+    USpice::rotate(FSAngle(0.25), ES_Axis::X, m);
+    TArray<FSDistanceVector> r = USpiceK2::Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2(MakeVectors(Vectors));
+
+    double LoopSeconds = 0., ArraySeconds = 0.;
+    TArray<FSDistanceVector> ByLoop, ByArray;
+
+    for (int tick = 0; tick < Ticks; ++tick)
+    {
+        double Start = FPlatformTime::Seconds();
+        ByLoop.Reset();
+        for (int32 i = 0; i < r.Num(); ++i)
+        {
+            FSDimensionlessVector vin = USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(r[i]);
+            FSDimensionlessVector vout = USpiceK2::mxv_vector_K2(m, vin);
+            ByLoop.Add(USpiceK2::Conv_SDimensionlessVectorToSDistanceVector_K2(vout));
+        }
+        LoopSeconds += FPlatformTime::Seconds() - Start;
+
+        Start = FPlatformTime::Seconds();
+        ByArray = USpiceK2::Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2(
+            USpiceK2::mxv_vector_array_K2(m, USpiceK2::Conv_SDistanceVectorArrayToSDimensionlessVectorArray_K2(r))
+        );
+        ArraySeconds += FPlatformTime::Seconds() - Start;
+    }
+
+    ASSERT_EQ(ByLoop.Num(), ByArray.Num());
+    EXPECT_DOUBLE_EQ(ByLoop[Vectors - 1].y.km, ByArray[Vectors - 1].y.km);
+
+    printf("[ BENCHMARK] mxv, %d distance vectors: loop %.4f ms/tick, array node %.4f ms/tick\n",
+        Vectors, 1000. * LoopSeconds / Ticks, 1000. * ArraySeconds / Ticks);
+}
@@ -0,0 +1,294 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceData.h"
+#include "SpiceKernelCatalog.h"
+#include "SpiceKernelInspector.h"
+#include <filesystem>
+#include <fstream>
+
+using namespace MaxQ::Catalog;
+
+namespace
+{
+    // The unit test kernels, named so path order isn't load order, plus a
+    // file that isn't a kernel
+    std::string MakeDirectory()
+    {
+        const std::filesystem::path Directory(TestFilePath("kernel_catalog"));
+        std::filesystem::remove_all(Directory);
+        std::filesystem::create_directory(Directory);
+
+        const auto Copy = [&](const char* From, const char* To)
+        {
+            std::filesystem::copy_file(TestFilePath(From), Directory / To);
+        };
+        Copy("maxq_unit_test_spk.bsp", "a_ephemeris.bsp");
+        Copy("maxq_unit_test_fk.tf", "b_frames.tf");
+        Copy("maxq_unit_test_pck.tpc", "c_constants.tpc");
+        Copy("maxq_unit_test_lsk.tls", "d_leapseconds.tls");
+        std::ofstream(Directory / "e_readme.txt") << "Not a kernel" << std::endl;
+
+        return Directory.string();
+    }
+
+    FCatalogSettings CacheSettings()
+    {
+        FCatalogSettings Settings;
+        Settings.CacheFile = TestFilePath("kernel_catalog.bin").c_str();
+        return Settings;
+    }
+}
+
+
+TEST(kernel_catalog_test, Load_Order) {
+
+    const std::string Directory = MakeDirectory();
+
+    FCatalogSettings Settings;
+    Settings.bPersistent = false;
+    ClearCache(Settings, false);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FCatalogEntry> Entries;
+    FCatalogStats Stats;
+    ASSERT_TRUE(Scan(Directory.c_str(), Entries, Settings, &Stats, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    EXPECT_EQ(Stats.Files, 5);
+    EXPECT_EQ(Stats.Kernels, 4);
+    EXPECT_EQ(Stats.Validated, 5);
+    EXPECT_EQ(Stats.Failures, 0);
+
+    // LSK -> PCK -> FK -> SPK, and nothing that isn't a kernel
+    ASSERT_EQ(Entries.Num(), 4);
+    EXPECT_EQ(Entries[0].FileType, TEXT("LSK"));
+    EXPECT_EQ(Entries[1].FileType, TEXT("PCK"));
+    EXPECT_EQ(Entries[2].FileType, TEXT("FK"));
+    EXPECT_EQ(Entries[3].FileType, TEXT("SPK"));
+    EXPECT_TRUE(Entries[3].bBinary);
+    EXPECT_FALSE(Entries[0].bBinary);
+
+    const TArray<FString> Paths = LoadOrder(Entries);
+    ASSERT_EQ(Paths.Num(), 4);
+    EXPECT_EQ(FPaths::GetCleanFilename(Paths[0]), TEXT("d_leapseconds.tls"));
+    EXPECT_EQ(FPaths::GetCleanFilename(Paths[3]), TEXT("a_ephemeris.bsp"));
+
+    // The SPK's coverage is the inspector's
+    MaxQ::Inspector::FKernelSummary Summary;
+    MaxQ::Inspector::InspectKernel(Entries[3].Path, Summary);
+    const TArray<int32> Ids = MaxQ::Inspector::GetIds(Summary);
+    ASSERT_EQ(Entries[3].Coverage.Num(), Ids.Num());
+    for (int32 i = 0; i < Ids.Num(); ++i)
+    {
+        const TArray<FSWindowSegment> Windows = MaxQ::Inspector::GetCoverage(Summary, Ids[i]);
+        EXPECT_EQ(Entries[3].Coverage[i].Id, Ids[i]);
+        ASSERT_EQ(Entries[3].Coverage[i].Windows.Num(), Windows.Num());
+        for (int32 j = 0; j < Windows.Num(); ++j)
+        {
+            EXPECT_EQ(Entries[3].Coverage[i].Windows[j].start, Windows[j].start);
+            EXPECT_EQ(Entries[3].Coverage[i].Windows[j].stop, Windows[j].stop);
+        }
+    }
+    EXPECT_NE(Entries[3].ContentHash, 0ull);
+    EXPECT_EQ(Entries[3].FileSize, (int64)std::filesystem::file_size(TestFilePath("maxq_unit_test_spk.bsp")));
+}
+
+
+TEST(kernel_catalog_test, Cache_Skips_Unchanged) {
+
+    const std::string Directory = MakeDirectory();
+    const FCatalogSettings Settings = CacheSettings();
+    ClearCache(Settings);
+
+    TArray<FCatalogEntry> Entries;
+    FCatalogStats Stats;
+    ASSERT_TRUE(Scan(Directory.c_str(), Entries, Settings, &Stats));
+    EXPECT_EQ(Stats.Validated, 5);
+    EXPECT_EQ(Stats.CacheHits, 0);
+    EXPECT_TRUE(std::filesystem::exists(TestFilePath("kernel_catalog.bin")));
+
+    // Same process
+    ASSERT_TRUE(Scan(Directory.c_str(), Entries, Settings, &Stats));
+    EXPECT_EQ(Stats.Validated, 0);
+    EXPECT_EQ(Stats.CacheHits, 5);
+    ASSERT_EQ(Entries.Num(), 4);
+    for (const FCatalogEntry& Entry : Entries)
+    {
+        EXPECT_TRUE(Entry.bFromCache);
+    }
+
+    // "Next launch":  only the cache file
+    ClearCache(Settings, false);
+    TArray<FCatalogEntry> Reloaded;
+    ASSERT_TRUE(Scan(Directory.c_str(), Reloaded, Settings, &Stats));
+    EXPECT_EQ(Stats.Validated, 0);
+    EXPECT_EQ(Stats.CacheHits, 5);
+    ASSERT_EQ(Reloaded.Num(), Entries.Num());
+    for (int32 i = 0; i < Entries.Num(); ++i)
+    {
+        EXPECT_EQ(Reloaded[i].Path, Entries[i].Path);
+        EXPECT_EQ(Reloaded[i].FileType, Entries[i].FileType);
+        EXPECT_EQ(Reloaded[i].ContentHash, Entries[i].ContentHash);
+        EXPECT_EQ(Reloaded[i].Coverage.Num(), Entries[i].Coverage.Num());
+    }
+
+    // A changed file is read again, a deleted one is forgotten
+    std::filesystem::copy_file(TestFilePath("maxq_unit_test_pck.tpc"), std::filesystem::path(Directory) / "d_leapseconds.tls", std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::remove(std::filesystem::path(Directory) / "b_frames.tf");
+
+    ASSERT_TRUE(Scan(Directory.c_str(), Entries, Settings, &Stats));
+    EXPECT_EQ(Stats.Validated, 1);
+    EXPECT_EQ(Stats.CacheHits, 3);
+    ASSERT_EQ(Entries.Num(), 3);
+    EXPECT_EQ(Entries[0].FileType, TEXT("PCK"));
+    EXPECT_EQ(Entries[1].FileType, TEXT("PCK"));
+    EXPECT_EQ(Entries[2].FileType, TEXT("SPK"));
+
+    ClearCache(Settings);
+    EXPECT_FALSE(std::filesystem::exists(TestFilePath("kernel_catalog.bin")));
+}
+
+
+TEST(kernel_catalog_test, Verify_Hashes) {
+
+    const std::string Directory = MakeDirectory();
+    FCatalogSettings Settings = CacheSettings();
+    ClearCache(Settings);
+
+    TArray<FCatalogEntry> Entries;
+    FCatalogStats Stats;
+    ASSERT_TRUE(Scan(Directory.c_str(), Entries, Settings, &Stats));
+
+    // Same size & time, different bytes
+    const std::filesystem::path Spk = std::filesystem::path(Directory) / "a_ephemeris.bsp";
+    const auto Time = std::filesystem::last_write_time(Spk);
+    {
+        std::fstream File(Spk, std::ios::binary | std::ios::in | std::ios::out);
+        File.seekp(16);
+        File << "CHANGED";
+    }
+    std::filesystem::last_write_time(Spk, Time);
+
+    ASSERT_TRUE(Scan(Directory.c_str(), Entries, Settings, &Stats));
+    EXPECT_EQ(Stats.Validated, 0);
+
+    Settings.bVerifyHashes = true;
+    ASSERT_TRUE(Scan(Directory.c_str(), Entries, Settings, &Stats));
+    EXPECT_EQ(Stats.Validated, 1);
+    EXPECT_EQ(Stats.CacheHits, 4);
+
+    ClearCache(Settings);
+}
+
+
+TEST(kernel_catalog_test, Furnsh_Directory) {
+
+    USpice::init_all();
+    USpice::clear_all();
+
+    const std::string Directory = MakeDirectory();
+
+    // A kernel that can't be decoded fails the load, the rest still load
+    {
+        std::ofstream File(std::filesystem::path(Directory) / "f_truncated.bsp", std::ios::binary);
+        File << "DAF/SPK " << std::string(100, '\0');
+    }
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    EXPECT_FALSE(MaxQ::Data::FurnshDirectory(Directory.c_str(), true, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    int Count = 0;
+    USpice::ktotal(Count);
+    EXPECT_EQ(Count, 4);
+
+    // Loaded in load order
+    ES_FoundCode FoundCode;
+    FString File, Source;
+    ES_KernelType Type;
+    int Handle = 0;
+    USpice::kdata(FoundCode, File, Type, Source, Handle, 0x7f, 0);
+    ASSERT_EQ(FoundCode, ES_FoundCode::Found);
+    EXPECT_EQ(FPaths::GetCleanFilename(File), TEXT("d_leapseconds.tls"));
+    USpice::kdata(FoundCode, File, Type, Source, Handle, 0x7f, 3);
+    ASSERT_EQ(FoundCode, ES_FoundCode::Found);
+    EXPECT_EQ(FPaths::GetCleanFilename(File), TEXT("a_ephemeris.bsp"));
+
+    USpice::clear_all();
+    ClearCache(FCatalogSettings(), false);
+}
+
+
+TEST(kernel_catalog_test, Text_Without_Kpl) {
+
+    USpice::init_all();
+    USpice::clear_all();
+
+    const std::filesystem::path Directory(TestFilePath("kernel_catalog_untyped"));
+    std::filesystem::remove_all(Directory);
+    std::filesystem::create_directory(Directory);
+    std::filesystem::copy_file(TestFilePath("maxq_unit_test_spk.bsp"), Directory / "a_ephemeris.bsp");
+    std::filesystem::copy_file(TestFilePath("maxq_unit_test_lsk.tls"), Directory / "b_leapseconds.tls");
+
+    // Older text kernels start right in with \begintext, no KPL/ line
+    std::ofstream(Directory / "c_untyped.tf")
+        << "\\begintext" << std::endl
+        << "   A text kernel without a KPL/ line" << std::endl
+        << "\\begindata" << std::endl
+        << "   MAXQ_UNTYPED_TEST = ( 1.5 )" << std::endl
+        << "\\begintext" << std::endl;
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    MaxQ::Inspector::FKernelSummary Summary;
+    MaxQ::Inspector::InspectKernel((Directory / "c_untyped.tf").string().c_str(), Summary, MaxQ::Inspector::FInspectSettings(), &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Summary.Architecture, MaxQ::Inspector::EKernelArchitecture::Text);
+    EXPECT_EQ(Summary.FileType, TEXT("TEXT"));
+
+    FCatalogSettings Settings;
+    Settings.bPersistent = false;
+    ClearCache(Settings, false);
+
+    // LSK -> TEXT -> SPK
+    TArray<FCatalogEntry> Entries;
+    ASSERT_TRUE(Scan(Directory.string().c_str(), Entries, Settings, nullptr, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_EQ(Entries.Num(), 3);
+    EXPECT_EQ(Entries[0].FileType, TEXT("LSK"));
+    EXPECT_EQ(Entries[1].FileType, TEXT("TEXT"));
+    EXPECT_EQ(Entries[2].FileType, TEXT("SPK"));
+    EXPECT_LT(LoadRank(TEXT("TEXT")), LoadRank(TEXT("SPK")));
+
+    // And it's loaded, before the SPK
+    ASSERT_TRUE(MaxQ::Data::FurnshDirectory(Directory.string().c_str(), true, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    int Count = 0;
+    USpice::ktotal(Count);
+    EXPECT_EQ(Count, 3);
+
+    ES_FoundCode FoundCode;
+    FString File, Source;
+    ES_KernelType Type;
+    int Handle = 0;
+    USpice::kdata(FoundCode, File, Type, Source, Handle, 0x7f, 1);
+    ASSERT_EQ(FoundCode, ES_FoundCode::Found);
+    EXPECT_EQ(FPaths::GetCleanFilename(File), TEXT("c_untyped.tf"));
+
+    TArray<double> Values;
+    bool bFound = false;
+    USpice::gdpool(ResultCode, ErrorMessage, Values, bFound, TEXT("MAXQ_UNTYPED_TEST"), 0, 1);
+    ASSERT_TRUE(bFound);
+    ASSERT_EQ(Values.Num(), 1);
+    EXPECT_EQ(Values[0], 1.5);
+
+    USpice::clear_all();
+    ClearCache(FCatalogSettings(), false);
+}
@@ -0,0 +1,252 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceKernelInspector.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using namespace MaxQ::Inspector;
+
+namespace
+{
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    }
+
+    const FKernelSummary* Find(const TArray<FKernelSummary>& Summaries, const char* File)
+    {
+        const FString Name(File);
+        return Summaries.FindByPredicate([&](const FKernelSummary& Summary) { return FPaths::GetCleanFilename(Summary.Path) == Name; });
+    }
+}
+
+
+TEST(kernel_inspector_test, Spk_Matches_Spice) {
+
+    LoadKernels();
+
+    const std::string Spk = TestFilePath("maxq_unit_test_spk.bsp");
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FKernelSummary Summary;
+    InspectKernel(Spk.c_str(), Summary, FInspectSettings(), &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    EXPECT_EQ(Summary.Architecture, EKernelArchitecture::DAF);
+    EXPECT_EQ(Summary.FileType, TEXT("SPK"));
+    EXPECT_EQ(Summary.IdWord, TEXT("DAF/SPK"));
+    EXPECT_EQ(Summary.BinaryFormat, TEXT("LTL-IEEE"));
+    EXPECT_TRUE(Summary.bFtpValid);
+    EXPECT_EQ(Summary.ND, 2);
+    EXPECT_EQ(Summary.NI, 6);
+    EXPECT_EQ(Summary.FileSize, (int64)std::filesystem::file_size(Spk));
+    EXPECT_GT(Summary.Segments.Num(), 0);
+
+    TArray<int> SpiceIds;
+    USpice::spkobj(ResultCode, ErrorMessage, Spk.c_str(), SpiceIds);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    SpiceIds.Sort();
+
+    const TArray<int32> Ids = GetIds(Summary);
+    ASSERT_EQ(Ids.Num(), SpiceIds.Num());
+    for (int32 i = 0; i < Ids.Num(); ++i)
+    {
+        EXPECT_EQ(Ids[i], SpiceIds[i]);
+
+        TArray<FSWindowSegment> SpiceCoverage;
+        USpice::spkcov(ResultCode, ErrorMessage, Spk.c_str(), Ids[i], TArray<FSWindowSegment>(), SpiceCoverage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        const TArray<FSWindowSegment> Coverage = GetCoverage(Summary, Ids[i]);
+        ASSERT_EQ(Coverage.Num(), SpiceCoverage.Num()) << Ids[i];
+        for (int32 j = 0; j < Coverage.Num(); ++j)
+        {
+            EXPECT_EQ(Coverage[j].start, SpiceCoverage[j].start);
+            EXPECT_EQ(Coverage[j].stop, SpiceCoverage[j].stop);
+        }
+    }
+
+    EXPECT_FALSE(Report(Summary).IsEmpty());
+}
+
+
+TEST(kernel_inspector_test, Comments_And_Segments) {
+
+    LoadKernels();
+
+    const std::string Spk = TestFilePath("kernel_inspector.bsp");
+    std::remove(Spk.c_str());
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    int Handle = 0;
+    USpice::spkopn(ResultCode, ErrorMessage, Spk.c_str(), TEXT("INSPECTOR TEST"), 4096, Handle);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    USpice::dafac(ResultCode, ErrorMessage, Handle, { TEXT("First comment line"), TEXT("Second comment line") });
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    TArray<FSPKType5Observation> Observations;
+    for (int i = 0; i < 10; ++i)
+    {
+        Observations.Add(FSPKType5Observation(et0 + FSEphemerisPeriod(60. * i), FSStateVector(FSDistanceVector(7000., 100. * i, 0.), FSVelocityVector(0., 7.5, 0.))));
+    }
+    USpice::spkw05(ResultCode, ErrorMessage, Handle, -999301, 399, TEXT("ECLIPJ2000"), Observations[0].et, Observations.Last().et, TEXT("INSPECTED SEGMENT"), FSMassConstant(398600.4418), Observations);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    USpice::spkcls(ResultCode, ErrorMessage, Handle);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    int KernelsBefore = 0, KernelsAfter = 0;
+    USpice::ktotal(KernelsBefore);
+
+    FKernelSummary Summary;
+    InspectKernel(Spk.c_str(), Summary, FInspectSettings(), &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // Nothing loaded
+    USpice::ktotal(KernelsAfter);
+    EXPECT_EQ(KernelsBefore, KernelsAfter);
+
+    EXPECT_EQ(Summary.InternalName, TEXT("INSPECTOR TEST"));
+    EXPECT_EQ(Summary.Comments, TEXT("First comment line\nSecond comment line"));
+
+    ASSERT_EQ(Summary.Segments.Num(), 1);
+    const FSegmentSummary& Segment = Summary.Segments[0];
+    EXPECT_EQ(Segment.Name, TEXT("INSPECTED SEGMENT"));
+    EXPECT_EQ(Segment.Id, -999301);
+    EXPECT_EQ(Segment.Center, 399);
+    EXPECT_EQ(Segment.Frame, 17);
+    EXPECT_EQ(FrameName(Segment.Frame), TEXT("ECLIPJ2000"));
+    EXPECT_EQ(Segment.DataType, 5);
+    EXPECT_EQ(Segment.Begin, Observations[0].et.seconds);
+    EXPECT_EQ(Segment.End, Observations.Last().et.seconds);
+    EXPECT_LT(Segment.BeginAddress, Segment.EndAddress);
+    EXPECT_EQ(Segment.Doubles.Num(), 2);
+    EXPECT_EQ(Segment.Integers.Num(), 6);
+
+    FInspectSettings NoComments;
+    NoComments.bComments = false;
+    InspectKernel(Spk.c_str(), Summary, NoComments, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_TRUE(Summary.Comments.IsEmpty());
+    EXPECT_EQ(Summary.Segments.Num(), 1);
+}
+
+
+TEST(kernel_inspector_test, Inspect_Directory) {
+
+    LoadKernels();
+
+    const FString Directory(std::filesystem::current_path().string().c_str());
+    std::ofstream(TestFilePath("kernel_inspector.txt")) << "Not a kernel" << std::endl;
+
+    TArray<FKernelSummary> Summaries;
+    TArray<FString> Failures;
+    InspectDirectory(Directory, Summaries, false, FInspectSettings(), &Failures);
+
+    const FKernelSummary* Spk = Find(Summaries, "maxq_unit_test_spk.bsp");
+    const FKernelSummary* Lsk = Find(Summaries, "maxq_unit_test_lsk.tls");
+    const FKernelSummary* Fk = Find(Summaries, "maxq_unit_test_fk.tf");
+    const FKernelSummary* Meta = Find(Summaries, "maxq_unit_test_meta.tm");
+    ASSERT_NE(Spk, nullptr);
+    ASSERT_NE(Lsk, nullptr);
+    ASSERT_NE(Fk, nullptr);
+    ASSERT_NE(Meta, nullptr);
+
+    EXPECT_EQ(Spk->FileType, TEXT("SPK"));
+    EXPECT_EQ(Lsk->Architecture, EKernelArchitecture::Text);
+    EXPECT_EQ(Lsk->FileType, TEXT("LSK"));
+    EXPECT_EQ(Fk->FileType, TEXT("FK"));
+    EXPECT_EQ(Meta->FileType, TEXT("MK"));
+
+    // Sorted, and the same as inspecting one file
+    for (int32 i = 1; i < Summaries.Num(); ++i)
+    {
+        EXPECT_LT(Summaries[i - 1].Path, Summaries[i].Path);
+    }
+
+    FKernelSummary Single;
+    InspectKernel(Spk->Path, Single);
+    ASSERT_EQ(Single.Segments.Num(), Spk->Segments.Num());
+    for (int32 i = 0; i < Single.Segments.Num(); ++i)
+    {
+        EXPECT_EQ(Single.Segments[i].Id, Spk->Segments[i].Id);
+        EXPECT_EQ(Single.Segments[i].Begin, Spk->Segments[i].Begin);
+        EXPECT_EQ(Single.Segments[i].End, Spk->Segments[i].End);
+    }
+
+    // Nothing that isn't a kernel
+    EXPECT_EQ(Find(Summaries, "kernel_inspector.txt"), nullptr);
+}
+
+
+TEST(kernel_inspector_test, Format_Tdb_Matches_Timout) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    for (double et : { 0., -43200., 1e9 + 0.25, -1e9 - 0.9999, 86399.9995, 3e10, -1.4e10, 123456789.123456 })
+    {
+        FString Expected;
+        USpice::timout(ResultCode, ErrorMessage, Expected, FSEphemerisTime(et), TEXT("YYYY MON DD HR:MN:SC.### (TDB) ::TDB"));
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        EXPECT_EQ(FormatTdb(et), Expected) << et;
+
+        USpice::timout(ResultCode, ErrorMessage, Expected, FSEphemerisTime(et), TEXT("YYYY MON DD HR:MN:SC.###### (TDB) ::TDB"));
+        EXPECT_EQ(FormatTdb(et, 6), Expected) << et;
+    }
+
+    EXPECT_EQ(FormatTdb(0.), TEXT("2000 JAN 01 12:00:00.000 (TDB)"));
+    EXPECT_EQ(FormatTdb(0., 0), TEXT("2000 JAN 01 12:00:00 (TDB)"));
+}
+
+
+TEST(kernel_inspector_test, Bad_Inputs) {
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FKernelSummary Summary;
+
+    InspectKernel(TestFilePath("no_such_kernel.bsp").c_str(), Summary, FInspectSettings(), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    const std::string Text = TestFilePath("kernel_inspector.txt");
+    std::ofstream(Text) << "Not a kernel" << std::endl;
+    InspectKernel(Text.c_str(), Summary, FInspectSettings(), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // A truncated file record
+    const std::string Truncated = TestFilePath("kernel_inspector_truncated.bsp");
+    {
+        std::ofstream File(Truncated, std::ios::binary);
+        File << "DAF/SPK " << std::string(100, '\0');
+    }
+    InspectKernel(Truncated.c_str(), Summary, FInspectSettings(), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // A summary list that points past the end of the file
+    const std::string Spk = TestFilePath("maxq_unit_test_spk.bsp");
+    const std::string Corrupt = TestFilePath("kernel_inspector_corrupt.bsp");
+    std::filesystem::copy_file(Spk, Corrupt, std::filesystem::copy_options::overwrite_existing);
+    {
+        std::fstream File(Corrupt, std::ios::binary | std::ios::in | std::ios::out);
+        const int32 Forward = 1 << 20;
+        File.seekp(76);
+        File.write((const char*)&Forward, sizeof(Forward));
+    }
+    InspectKernel(Corrupt.c_str(), Summary, FInspectSettings(), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
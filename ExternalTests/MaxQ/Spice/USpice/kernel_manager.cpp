@@ -0,0 +1,92 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceKernelManager.h"
+#include "SpiceCoverage.h"
+
+using MaxQ::KernelManager::EKernelKind;
+
+TEST(kernel_manager_test, Require_Loads_On_Demand) {
+
+    USpice::init_all();
+    USpice::clear_all();
+    MaxQ::KernelManager::UnregisterAll();
+    MaxQ::KernelManager::ResetStats();
+
+    MaxQ::KernelManager::FSettings Settings;
+    Settings.MaxLoadedKernels = 1;
+    Settings.PrefetchSeconds = 0.;
+    MaxQ::KernelManager::Configure(Settings);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    ASSERT_TRUE(MaxQ::KernelManager::Register(TestFilePath("maxq_unit_test_spk.bsp").c_str(), &ResultCode, &ErrorMessage));
+
+    // Registered, not loaded
+    EXPECT_TRUE(MaxQ::KernelManager::IsAvailable(EKernelKind::SPK, 9994, et0.seconds));
+    EXPECT_FALSE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, et0));
+
+    EXPECT_TRUE(MaxQ::KernelManager::Require(EKernelKind::SPK, 9994, et0.seconds, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_TRUE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, et0));
+
+    EXPECT_TRUE(MaxQ::KernelManager::Require(EKernelKind::SPK, 9995, et0.seconds, &ResultCode, &ErrorMessage));
+
+    MaxQ::KernelManager::FStats Stats = MaxQ::KernelManager::GetStats();
+    EXPECT_EQ(Stats.Registered, 1);
+    EXPECT_EQ(Stats.Loaded, 1);
+    EXPECT_EQ(Stats.Requests, 2);
+    EXPECT_EQ(Stats.Misses, 1);
+    EXPECT_EQ(Stats.Hits, 1);
+    EXPECT_EQ(Stats.Loads, 1);
+    EXPECT_DOUBLE_EQ(Stats.HitRate(), 0.5);
+
+    EXPECT_FALSE(MaxQ::KernelManager::Require(EKernelKind::SPK, 1234567, et0.seconds, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    MaxQ::KernelManager::Unregister(TestFilePath("maxq_unit_test_spk.bsp").c_str());
+    EXPECT_EQ(MaxQ::KernelManager::GetStats().Loaded, 0);
+    EXPECT_FALSE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, et0));
+    EXPECT_FALSE(MaxQ::KernelManager::IsAvailable(EKernelKind::SPK, 9994, et0.seconds));
+
+    MaxQ::KernelManager::Configure(MaxQ::KernelManager::FSettings());
+}
+
+TEST(kernel_manager_test, Clear_All_Forgets_Loaded_Kernels) {
+
+    USpice::init_all();
+    MaxQ::KernelManager::UnregisterAll();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    ASSERT_TRUE(MaxQ::KernelManager::Register(TestFilePath("maxq_unit_test_spk.bsp").c_str(), &ResultCode, &ErrorMessage));
+    EXPECT_TRUE(MaxQ::KernelManager::Require(EKernelKind::SPK, 9994, et0.seconds, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(MaxQ::KernelManager::GetStats().Loaded, 1);
+
+    USpice::clear_all();
+    EXPECT_EQ(MaxQ::KernelManager::GetStats().Loaded, 0);
+    EXPECT_EQ(MaxQ::KernelManager::GetStats().Registered, 1);
+
+    // Still registered, loads again on demand
+    EXPECT_TRUE(MaxQ::KernelManager::Require(EKernelKind::SPK, 9994, et0.seconds, &ResultCode, &ErrorMessage));
+    EXPECT_TRUE(MaxQ::Coverage::IsCovered(EKernelKind::SPK, 9994, et0));
+
+    MaxQ::KernelManager::UnregisterAll();
+}
+
+TEST(kernel_manager_test, Rejects_Text_Kernels) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    const FString Lsk = FString(TestFilePath("maxq_unit_test_lsk.tls").c_str());
+    EXPECT_FALSE(MaxQ::KernelManager::Register(Lsk, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
@@ -0,0 +1,252 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceLambert.h"
+#include "SpiceEphemeris.h"
+
+using namespace MaxQ::Lambert;
+
+namespace
+{
+    constexpr double EarthGM = 398600.4418;
+    constexpr double SunGM = 132712440041.94;
+    constexpr double AU = 149597870.7;
+    constexpr double Day = 86400.;
+
+    FVector3d Prop2b(const FVector3d& r, const FVector3d& v, double gm, double dt)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        FSStateVector State;
+        USpice::prop2b(ResultCode, ErrorMessage, FSMassConstant(gm), FSStateVector(FSDistanceVector(r.X, r.Y, r.Z), FSVelocityVector(v.X, v.Y, v.Z)), FSEphemerisPeriod(dt), State);
+        return FVector3d(State.r.x.km, State.r.y.km, State.r.z.km);
+    }
+
+    double Period(const FVector3d& r, const FVector3d& v, double gm)
+    {
+        const double a = 1. / (2. / r.Length() - (v | v) / gm);
+        return 2. * PI * sqrt(a * a * a / gm);
+    }
+
+    // Circular, about the sun, inclined about x
+    FSStateVector Circular(double Radius, double Inclination, double t)
+    {
+        const double n = sqrt(SunGM / (Radius * Radius * Radius)), v = n * Radius;
+        const double c = cos(n * t), s = sin(n * t), ci = cos(Inclination), si = sin(Inclination);
+        return FSStateVector(
+            FSDistanceVector(Radius * c, Radius * s * ci, Radius * s * si),
+            FSVelocityVector(-v * s, v * c * ci, v * c * si)
+        );
+    }
+}
+
+
+TEST(lambert_test, Curtis_Example) {
+
+    // Curtis, Orbital Mechanics for Engineering Students, example 5.2
+    const FVector3d r1(5000., 10000., 2100.), r2(-14600., 2500., 7000.);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FLambertSolution> Solutions;
+    ASSERT_TRUE(Solve(Solutions, r1, r2, 3600., EarthGM, false, 0, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_EQ(Solutions.Num(), 1);
+    EXPECT_EQ(Solutions[0].Revolutions, 0);
+
+    EXPECT_NEAR(Solutions[0].V1.X, -5.9925, 1e-4);
+    EXPECT_NEAR(Solutions[0].V1.Y, 1.9254, 1e-4);
+    EXPECT_NEAR(Solutions[0].V1.Z, 3.2456, 1e-4);
+    EXPECT_NEAR(Solutions[0].V2.X, -3.3125, 1e-4);
+    EXPECT_NEAR(Solutions[0].V2.Y, -4.1966, 1e-4);
+    EXPECT_NEAR(Solutions[0].V2.Z, -0.38529, 1e-4);
+
+    EXPECT_LT((Prop2b(r1, Solutions[0].V1, EarthGM, 3600.) - r2).Length(), 1e-6);
+}
+
+
+TEST(lambert_test, Multiple_Revolutions) {
+
+    const FVector3d r1(7000., 0., 0.), r2(-2000., 8000., 1000.);
+    const double tof = 5. * 3600.;
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FLambertSolution> Solutions;
+    ASSERT_TRUE(Solve(Solutions, r1, r2, tof, EarthGM, false, 10, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // LEO periods are ~1.7h, so 5h allows a couple of revolutions, not 10
+    ASSERT_GE(Solutions.Num(), 3);
+    EXPECT_LT(Solutions.Num(), 1 + 2 * 10);
+    EXPECT_EQ(Solutions.Num() % 2, 1);
+
+    for (int32 i = 0; i < Solutions.Num(); ++i)
+    {
+        const FLambertSolution& Solution = Solutions[i];
+        EXPECT_EQ(Solution.Revolutions, (i + 1) / 2) << i;
+        EXPECT_EQ(Solution.bLeftBranch, i % 2 == 1) << i;
+        EXPECT_LT((Prop2b(r1, Solution.V1, EarthGM, tof) - r2).Length(), 1e-5) << i;
+
+        // N whole periods, and part of another
+        const double P = Period(r1, Solution.V1, EarthGM);
+        EXPECT_GT(tof, Solution.Revolutions * P) << i;
+        EXPECT_LT(tof, (Solution.Revolutions + 1) * P) << i;
+    }
+
+    // Retrograde goes the other way around
+    ASSERT_TRUE(Solve(Solutions, r1, r2, 3600., EarthGM, true));
+    ASSERT_EQ(Solutions.Num(), 1);
+    EXPECT_LT((r1 ^ Solutions[0].V1).Z, 0.);
+    EXPECT_LT((Prop2b(r1, Solutions[0].V1, EarthGM, 3600.) - r2).Length(), 1e-5);
+}
+
+
+TEST(lambert_test, Invalid_Inputs) {
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FLambertSolution> Solutions;
+    const FVector3d r1(7000., 0., 0.), r2(0., 8000., 0.);
+
+    EXPECT_FALSE(Solve(Solutions, r1, r2, 0., EarthGM, false, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(Solve(Solutions, r1, r2, 3600., 0., false, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // Collinear with the center
+    EXPECT_FALSE(Solve(Solutions, r1, r1 * 2., 3600., EarthGM, false, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_EQ(Solutions.Num(), 0);
+}
+
+
+TEST(lambert_test, Porkchop_Grid) {
+
+    // Earth-like (1 AU) to Mars-like (1.524 AU, inclined 1.85 deg) circular
+    // orbits, over a synodic period of departures
+    const double r1 = AU, r2 = 1.524 * AU, Inclination = 1.85 * PI / 180.;
+    const int32 Width = 1000, Height = 1000;
+
+    TArray<double> DepartureTimes, ArrivalTimes;
+    FSStateVectorBuffer DepartureStates, ArrivalStates;
+    for (int32 i = 0; i < Width; ++i)
+    {
+        DepartureTimes.Add(i * 780. * Day / (Width - 1));
+        DepartureStates.Add(Circular(r1, 0., DepartureTimes.Last()));
+    }
+    for (int32 j = 0; j < Height; ++j)
+    {
+        ArrivalTimes.Add(100. * Day + j * 1100. * Day / (Height - 1));
+        ArrivalStates.Add(Circular(r2, Inclination, ArrivalTimes.Last()));
+    }
+
+    FPorkchop Porkchop;
+    FPorkchopStats Stats;
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    ASSERT_TRUE(SolveGrid(Porkchop, DepartureTimes, DepartureStates, ArrivalTimes, ArrivalStates, SunGM, FPorkchopSettings(), &Stats, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    printf("[ BENCHMARK] %dx%d porkchop: %lld transfers, %lld iterations, %.1f ms\n",
+        Width, Height, (long long)Stats.Solved, (long long)Stats.Iterations, 1000. * Stats.Seconds);
+
+    EXPECT_EQ(Stats.Cells, (int64)Width * Height);
+    EXPECT_GT(Stats.Solved, Stats.Cells / 2);
+    ASSERT_EQ(Porkchop.C3.Num(), Width * Height);
+
+    // Arrival before departure isn't a transfer
+    const int32 Late = Porkchop.Index(Width - 1, 0);
+    EXPECT_EQ(Porkchop.Solved[Late], 0);
+    EXPECT_EQ(Porkchop.C3[Late], 0.);
+
+    // Cells are their own Lambert solutions
+    for (int32 Cell = 0; Cell < Porkchop.Num(); Cell += 9973)
+    {
+        const int32 Departure = Cell % Width, Arrival = Cell / Width;
+        if (!Porkchop.Solved[Cell])
+        {
+            continue;
+        }
+        const FSStateVector From = DepartureStates.Get(Departure), To = ArrivalStates.Get(Arrival);
+        TArray<FLambertSolution> Solutions;
+        ASSERT_TRUE(Solve(Solutions, FVector3d(From.r.x.km, From.r.y.km, From.r.z.km), FVector3d(To.r.x.km, To.r.y.km, To.r.z.km), Porkchop.TimeOfFlight[Cell], SunGM));
+        const FVector3d VInfinity = Solutions[0].V1 - FVector3d(From.v.dx.kmps, From.v.dy.kmps, From.v.dz.kmps);
+        EXPECT_NEAR(Porkchop.C3[Cell], VInfinity | VInfinity, 1e-9 * Porkchop.C3[Cell]);
+        EXPECT_DOUBLE_EQ(Porkchop.TimeOfFlight[Cell], ArrivalTimes[Arrival] - DepartureTimes[Departure]);
+    }
+
+    // The best departure is no better than Hohmann's (coplanar), and not
+    // much worse
+    const double Hohmann = sqrt(SunGM / r1) * (sqrt(2. * r2 / (r1 + r2)) - 1.);
+    double MinimumC3 = DBL_MAX;
+    int32 Best = INDEX_NONE;
+    for (int32 Cell = 0; Cell < Porkchop.Num(); ++Cell)
+    {
+        if (Porkchop.Solved[Cell] && Porkchop.C3[Cell] < MinimumC3)
+        {
+            MinimumC3 = Porkchop.C3[Cell];
+            Best = Cell;
+        }
+    }
+    ASSERT_NE(Best, INDEX_NONE);
+    EXPECT_GE(MinimumC3, Hohmann * Hohmann * 0.999);
+    EXPECT_LT(MinimumC3, Hohmann * Hohmann * 1.5);
+
+    // Hohmann's 259 days would be a 180 degree transfer, where the plane
+    // change is expensive, so the best is near but not at it
+    EXPECT_GT(Porkchop.TimeOfFlight[Best] / Day, 150.);
+    EXPECT_LT(Porkchop.TimeOfFlight[Best] / Day, 400.);
+
+    TArray<FVector4f> Texels;
+    Porkchop.ToTexels(Texels);
+    ASSERT_EQ(Texels.Num(), Porkchop.Num());
+    EXPECT_FLOAT_EQ(Texels[Best].X, (float)MinimumC3);
+    EXPECT_FLOAT_EQ(Texels[Best].Z, (float)(Porkchop.TimeOfFlight[Best] / Day));
+    EXPECT_EQ(Texels[Best].W, 1.f);
+    EXPECT_EQ(Texels[Late].W, 0.f);
+}
+
+
+TEST(lambert_test, Porkchop_From_Kernels) {
+
+    USpice::init_all();
+    USpice::clear_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    // FAKEBODY9994 back to itself, about FAKEBODY9993 (GM 0.001)
+    const FName Body(TEXT("FAKEBODY9994")), Center(TEXT("FAKEBODY9993")), Frame(TEXT("J2000"));
+
+    FPorkchop Porkchop;
+    FPorkchopStats Stats;
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    ASSERT_TRUE(MakePorkchop(Porkchop, Body, Body, Center, Frame,
+        et0 - FSEphemerisPeriod(20000.), et0, 5,
+        et0 + FSEphemerisPeriod(10000.), et0 + FSEphemerisPeriod(30000.), 4,
+        FPorkchopSettings(), &Stats, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    EXPECT_EQ(Porkchop.Width, 5);
+    EXPECT_EQ(Porkchop.Height, 4);
+    EXPECT_EQ(Stats.Solved, 20);
+    EXPECT_DOUBLE_EQ(Porkchop.DepartureTimes[4], et0.seconds);
+    EXPECT_DOUBLE_EQ(Porkchop.ArrivalTimes[3], et0.seconds + 30000.);
+
+    const FSEphemerisTime Departure(Porkchop.DepartureTimes[1]), Arrival(Porkchop.ArrivalTimes[2]);
+    const FSStateVector From = MaxQ::Ephemeris::Spkezr(Departure, Body, Center, Frame);
+    const FSStateVector To = MaxQ::Ephemeris::Spkezr(Arrival, Body, Center, Frame);
+    TArray<FLambertSolution> Solutions;
+    ASSERT_TRUE(Solve(Solutions, FVector3d(From.r.x.km, From.r.y.km, From.r.z.km), FVector3d(To.r.x.km, To.r.y.km, To.r.z.km), Arrival.seconds - Departure.seconds, 0.001));
+    const FVector3d VInfinity = Solutions[0].V2 - FVector3d(To.v.dx.kmps, To.v.dy.kmps, To.v.dz.kmps);
+    EXPECT_NEAR(Porkchop.ArrivalVInfinity[Porkchop.Index(1, 2)], VInfinity.Length(), 1e-12);
+
+    // Nothing to sample
+    EXPECT_FALSE(MakePorkchop(Porkchop, FName(TEXT("NOT_A_BODY")), Body, Center, Frame, et0, et0, 1, et0 + FSEphemerisPeriod(100.), et0 + FSEphemerisPeriod(100.), 1, FPorkchopSettings(), nullptr, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    USpice::clear_all();
+}
@@ -0,0 +1,363 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpicePasses.h"
+#include "SpicePropagator.h"
+#include <cstdio>
+
+using namespace MaxQ::Passes;
+
+namespace
+{
+    // Satellites of FAKEBODY9993 (GM 0.001, radii 22.22 x 22.22 x 20km,
+    // spinning 36 deg/day), seen from stations on its surface
+    const FName Body(TEXT("FAKEBODY9993"));
+    const FName BodyFixed(TEXT("IAU_FAKEBODY9993"));
+    constexpr double GM = 0.001;
+    constexpr double Span = 86400.;
+
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+        // cnmfrm doesn't find the unit test FK's frame by itself
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        USpice::pcpool(ResultCode, ErrorMessage, TEXT("OBJECT_FAKEBODY9993_FRAME"), TEXT("IAU_FAKEBODY9993"));
+    }
+
+    // Circular, radius km, inclined & rotated about J2000's z (node), at
+    // phase rad at et0
+    FSStateVector Circular(double Radius, double Inclination, double Node, double Phase)
+    {
+        const double v = sqrt(GM / Radius);
+        const double c = cos(Phase), s = sin(Phase), ci = cos(Inclination), si = sin(Inclination), cn = cos(Node), sn = sin(Node);
+        const double x = Radius * c, y = Radius * s * ci, z = Radius * s * si;
+        const double dx = -v * s, dy = v * c * ci, dz = v * c * si;
+        return FSStateVector(
+            FSDistanceVector(x * cn - y * sn, x * sn + y * cn, z),
+            FSVelocityVector(dx * cn - dy * sn, dx * sn + dy * cn, dz)
+        );
+    }
+
+    struct FTestStation
+    {
+        int Id;                                     // NAIF ID of its SPK "ephemeris"
+        int FrameId;                                // Its topocentric frame
+        FString FrameName;
+        double Longitude, Latitude, Altitude, MinElevation;
+    };
+
+    const FTestStation TestStations[] = {
+        { -9993001, 1399001, TEXT("PASSES_TOPO_1"), .3, .4, .1, 0. },
+        { -9993002, 1399002, TEXT("PASSES_TOPO_2"), 2., -.2, 0., .17 },
+    };
+
+    constexpr int FirstSatellite = -9993101;
+
+    // gfposc needs the stations as ephemeris objects, with topocentric
+    // frames (z up:  latitude is elevation).  A station is a "two-body" orbit
+    // of a negligible GM in the body-fixed frame, so it stays put.
+    void WriteSpk(const char* File, const TArray<FSStateVector>& Satellites)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+
+        const std::string Spk = TestFilePath(File);
+        std::remove(Spk.c_str());
+
+        int Handle = 0;
+        USpice::spkopn(ResultCode, ErrorMessage, Spk.c_str(), TEXT("PASSES TEST"), 0, Handle);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        const FSEphemerisTime First = et0 - FSEphemerisPeriod(Span);
+        const FSEphemerisTime Last = et0 + FSEphemerisPeriod(2. * Span);
+        for (const FTestStation& Station : TestStations)
+        {
+            FGroundStation Ground;
+            ASSERT_TRUE(MakeStation(Ground, FName(*Station.FrameName), Body, FSGeodeticVector(FSLonLat(Station.Longitude, Station.Latitude), FSDistance(Station.Altitude)), FSAngle(Station.MinElevation), &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+            constexpr double Tiny = 1e-30;
+            const FVector3d Along = (FVector3d::ZAxisVector ^ Ground.Position).GetSafeNormal() * sqrt(Tiny / Ground.Position.Length());
+            TArray<FSPKType5Observation> States;
+            States.Add(FSPKType5Observation(et0, FSStateVector(
+                FSDistanceVector(Ground.Position.X, Ground.Position.Y, Ground.Position.Z),
+                FSVelocityVector(Along.X, Along.Y, Along.Z))));
+            USpice::spkw05(ResultCode, ErrorMessage, Handle, Station.Id, 9993, BodyFixed.ToString(), First, Last, TEXT("STATION"), FSMassConstant(Tiny), States);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+            const FString Frame = FString::Printf(TEXT("FRAME_%d_"), Station.FrameId);
+            const FString TkFrame = FString::Printf(TEXT("TKFRAME_%d_"), Station.FrameId);
+            USpice::pipool(ResultCode, ErrorMessage, TEXT("FRAME_") + Station.FrameName, Station.FrameId);
+            USpice::pcpool(ResultCode, ErrorMessage, Frame + TEXT("NAME"), Station.FrameName);
+            USpice::pipool(ResultCode, ErrorMessage, Frame + TEXT("CLASS"), 4);
+            USpice::pipool(ResultCode, ErrorMessage, Frame + TEXT("CLASS_ID"), Station.FrameId);
+            USpice::pipool(ResultCode, ErrorMessage, Frame + TEXT("CENTER"), Station.Id);
+            USpice::pcpool(ResultCode, ErrorMessage, TkFrame + TEXT("RELATIVE"), BodyFixed.ToString());
+            USpice::pcpool(ResultCode, ErrorMessage, TkFrame + TEXT("SPEC"), TEXT("ANGLES"));
+            USpice::pcpool(ResultCode, ErrorMessage, TkFrame + TEXT("UNITS"), TEXT("RADIANS"));
+            USpice::pipool_list(ResultCode, ErrorMessage, TkFrame + TEXT("AXES"), TArray<int>{ 3, 2, 3 });
+            USpice::pdpool_list(ResultCode, ErrorMessage, TkFrame + TEXT("ANGLES"), TArray<double>{ -Station.Longitude, Station.Latitude - HALF_PI, PI });
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        }
+
+        for (int32 i = 0; i < Satellites.Num(); ++i)
+        {
+            TArray<FSPKType5Observation> States;
+            States.Add(FSPKType5Observation(et0, Satellites[i]));
+            USpice::spkw05(ResultCode, ErrorMessage, Handle, FirstSatellite - i, 9993, TEXT("J2000"), First, Last, TEXT("SATELLITE"), FSMassConstant(GM), States);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        }
+
+        USpice::spkcls(ResultCode, ErrorMessage, Handle);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        USpice::furnsh_absolute(Spk.c_str());
+    }
+
+    TArray<FGroundStation> MakeStations()
+    {
+        TArray<FGroundStation> Stations;
+        for (const FTestStation& Station : TestStations)
+        {
+            FGroundStation& Ground = Stations.AddDefaulted_GetRef();
+            MakeStation(Ground, FName(*Station.FrameName), Body, FSGeodeticVector(FSLonLat(Station.Longitude, Station.Latitude), FSDistance(Station.Altitude)), FSAngle(Station.MinElevation));
+        }
+        return Stations;
+    }
+}
+
+
+TEST(passes_test, Planetographic_Station) {
+
+    LoadKernels();
+
+    // FAKEBODY9993 spins prograde, so its planetographic longitudes are west
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FGroundStation Geodetic, Planetographic;
+    ASSERT_TRUE(MakeStation(Geodetic, FName(TEXT("GEODETIC")), Body, FSGeodeticVector(FSLonLat(.3, .4), FSDistance(.1)), FSAngle(.1), &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_TRUE(MakeStation(Planetographic, FName(TEXT("PLANETOGRAPHIC")), Body, FSPlanetographicVector(FSLonLat(-.3, .4), FSDistance(.1)), FSAngle(.1), &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    EXPECT_LT((Geodetic.Position - Planetographic.Position).Length(), 1e-9);
+    EXPECT_LT((Geodetic.Up - Planetographic.Up).Length(), 1e-9);
+    EXPECT_NEAR(Geodetic.Up.Length(), 1., 1e-12);
+    EXPECT_DOUBLE_EQ(Geodetic.MinElevation, .1);
+
+    // The vertical is the ellipsoid's normal, not the radial direction
+    EXPECT_GT(Geodetic.Up.Z, Geodetic.Position.GetSafeNormal().Z);
+
+    EXPECT_FALSE(MakeStation(Geodetic, FName(TEXT("NOWHERE")), FName(TEXT("NOSUCHBODY")), FSGeodeticVector(), FSAngle(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+
+TEST(passes_test, Matches_Gfposc) {
+
+    LoadKernels();
+
+    TArray<FSStateVector> Satellites;
+    TArray<FName> Names;
+    for (int32 i = 0; i < 12; ++i)
+    {
+        Satellites.Add(Circular(25. + 2. * i, .15 * i, .5 * i, .7 * i));
+        Names.Add(FName(*FString::FromInt(FirstSatellite - i)));
+    }
+    WriteSpk("passes_catalog.bsp", Satellites);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    const TArray<FGroundStation> Stations = MakeStations();
+
+    FSatelliteCatalog Catalog;
+    ASSERT_TRUE(SampleCatalog(Catalog, Names, Body, NAME_None, et0, et0 + FSEphemerisPeriod(Span), FSEphemerisPeriod(120.), &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Catalog.Frame, BodyFixed);
+    EXPECT_EQ(Catalog.Num(), Satellites.Num());
+    EXPECT_EQ(Catalog.Times(), 721);
+
+    FPassSettings Settings;
+    Settings.Tolerance = 1e-6;
+    Settings.SatellitesPerTask = 5;
+    FPassStats Stats;
+    TArray<FPass> Passes;
+    ResultCode = ES_ResultCode::Error;
+    ASSERT_TRUE(Predict(Passes, Catalog, Stations, Settings, &Stats, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Stats.Screened, 721LL * 12 * 2);
+    EXPECT_GT(Stats.Passes, 10);
+    EXPECT_LT(Stats.Refined, Stats.Screened / 10);
+
+    for (int32 i = 1; i < Passes.Num(); ++i)
+    {
+        EXPECT_LE(Passes[i - 1].Rise, Passes[i].Rise);
+    }
+
+    // gfposc, a satellite & station at a time, at a step shorter than any
+    // pass that matters
+    constexpr double GfStep = 60.;
+    const TArray<FSEphemerisTimeWindowSegment> Window{ FSEphemerisTimeWindowSegment(et0, et0 + FSEphemerisPeriod(Span)) };
+    int32 Matched = 0;
+    for (int32 Station = 0; Station < Stations.Num(); ++Station)
+    {
+        const FTestStation& Test = TestStations[Station];
+        for (int32 i = 0; i < Satellites.Num(); ++i)
+        {
+            TArray<FPass> Predicted;
+            for (const FPass& Pass : Passes)
+            {
+                if (Pass.Satellite == i && Pass.Station == Station) Predicted.Add(Pass);
+            }
+
+            TArray<FSEphemerisTimeWindowSegment> Up;
+            USpice::gfposc(ResultCode, ErrorMessage, Up, FSEphemerisPeriod(GfStep), Window, Names[i].ToString(), Test.FrameName,
+                ES_AberrationCorrectionWithTransmissions::None, FString::FromInt(Test.Id),
+                ES_CoordinateSystemInclRadec::LATITUDINAL, ES_CoordinateName::LATITUDE, ES_RelationalOperator::GreaterThan, Test.MinElevation);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+            TArray<FSEphemerisTimeWindowSegment> Peaks;
+            USpice::gfposc(ResultCode, ErrorMessage, Peaks, FSEphemerisPeriod(GfStep), Up, Names[i].ToString(), Test.FrameName,
+                ES_AberrationCorrectionWithTransmissions::None, FString::FromInt(Test.Id),
+                ES_CoordinateSystemInclRadec::LATITUDINAL, ES_CoordinateName::LATITUDE, ES_RelationalOperator::ABSMAX, 0.);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+            // Passes too short for gfposc's step may be found only here
+            for (const FPass& Pass : Predicted)
+            {
+                if (Pass.Set - Pass.Rise > 2. * GfStep)
+                {
+                    const bool bFound = Up.ContainsByPredicate([&](const FSEphemerisTimeWindowSegment& Interval) { return FMath::Abs(Interval.start.seconds - Pass.Rise) < 1e-2; });
+                    EXPECT_TRUE(bFound) << "satellite " << i << " station " << Station << " rise " << Pass.Rise - et0.seconds;
+                }
+            }
+
+            for (const FSEphemerisTimeWindowSegment& Interval : Up)
+            {
+                const FPass* Pass = Predicted.FindByPredicate([&](const FPass& Pass) { return FMath::Abs(Interval.start.seconds - Pass.Rise) < 1e-2; });
+                ASSERT_NE(Pass, nullptr) << "satellite " << i << " station " << Station << " rise " << Interval.start.seconds - et0.seconds;
+
+                EXPECT_NEAR(Pass->Rise, Interval.start.seconds, 1e-2);
+                EXPECT_NEAR(Pass->Set, Interval.stop.seconds, 1e-2);
+                EXPECT_EQ(Pass->bRise, Interval.start.seconds > et0.seconds);
+                EXPECT_EQ(Pass->bSet, Interval.stop.seconds < et0.seconds + Span);
+
+                // Culminations (the highest in the pass, when there are two)
+                for (const FSEphemerisTimeWindowSegment& Peak : Peaks)
+                {
+                    if (FMath::Abs(Peak.start.seconds - Pass->Culmination) < 1.)
+                    {
+                        FSStateVector State;
+                        FSEphemerisPeriod lt;
+                        USpice::spkezr(ResultCode, ErrorMessage, Peak.start, State, lt, Names[i].ToString(), FString::FromInt(Test.Id), Test.FrameName);
+                        const FVector3d r(State.r.x.km, State.r.y.km, State.r.z.km);
+                        EXPECT_NEAR(Pass->MaxElevation, asin(r.Z / r.Length()), 1e-7);
+                        ++Matched;
+                    }
+                }
+            }
+        }
+    }
+    EXPECT_GT(Matched, 5);
+}
+
+
+TEST(passes_test, Propagated_Catalog) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    MaxQ::Propagator::FForceModel Model;
+    Model.Center = Body;
+    TSharedPtr<MaxQ::Propagator::FPropagator> Propagator = MaxQ::Propagator::FPropagator::Create(Model, et0, et0 + FSEphemerisPeriod(Span), &ResultCode, &ErrorMessage);
+    ASSERT_TRUE(Propagator.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    MaxQ::Propagator::FSpacecraftBatch Batch;
+    for (int32 i = 0; i < 2048; ++i)
+    {
+        Batch.Add(Circular(25. + (i % 64) * .25, (i % 29) * .11, (i % 31) * .2, i * .37));
+    }
+    TArray<MaxQ::Propagator::FTrajectory> Trajectories;
+    ASSERT_TRUE(Propagator->Propagate(Batch, et0, et0 + FSEphemerisPeriod(Span), MaxQ::Propagator::FIntegratorSettings(), nullptr, &Trajectories, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    FSatelliteCatalog Catalog;
+    ASSERT_TRUE(SampleTrajectories(Catalog, Trajectories, Body, NAME_None, et0, et0 + FSEphemerisPeriod(Span), FSEphemerisPeriod(120.), &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Catalog.Frame, BodyFixed);
+
+    TArray<FGroundStation> Stations = MakeStations();
+    for (int32 i = 0; i < 6; ++i)
+    {
+        FGroundStation& Station = Stations.AddDefaulted_GetRef();
+        MakeStation(Station, FName(*FString::Printf(TEXT("STATION_%d"), i)), Body, FSGeodeticVector(FSLonLat(i * 1.1 - 3., i * .3 - .9), FSDistance(0.)), FSAngle(.05 * i));
+    }
+
+    FPassStats Stats;
+    TArray<FPass> Passes;
+    ResultCode = ES_ResultCode::Error;
+    ASSERT_TRUE(Predict(Passes, Catalog, Stations, FPassSettings(), &Stats, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_GT(Stats.Passes, 1000);
+
+    // A fine scan of a sample of satellites is up exactly inside their
+    // passes
+    for (int32 i = 0; i < Catalog.Num(); i += 97)
+    {
+        for (int32 StationIndex = 0; StationIndex < Stations.Num(); ++StationIndex)
+        {
+            const FGroundStation& Station = Stations[StationIndex];
+            TArray<FPass> Predicted;
+            for (const FPass& Pass : Passes)
+            {
+                if (Pass.Satellite == i && Pass.Station == StationIndex) Predicted.Add(Pass);
+            }
+
+            for (double et = Catalog.First(); et <= Catalog.Last(); et += 7.)
+            {
+                double State[6];
+                Catalog.Evaluate(i, et, State);
+                const FVector3d rho = FVector3d(State[0], State[1], State[2]) - Station.Position;
+                const double Elevation = asin((rho | Station.Up) / rho.Length());
+
+                const FPass* Pass = Predicted.FindByPredicate([&](const FPass& Pass) { return Pass.Rise - 1e-3 <= et && et <= Pass.Set + 1e-3; });
+                if (Pass && et > Pass->Rise + 1e-2 && et < Pass->Set - 1e-2)
+                {
+                    EXPECT_GT(Elevation, Station.MinElevation) << i << " " << StationIndex << " " << et - et0.seconds;
+                    EXPECT_LE(Elevation, Pass->MaxElevation + 1e-9);
+                }
+                else if (!Pass)
+                {
+                    EXPECT_LT(Elevation, Station.MinElevation) << i << " " << StationIndex << " " << et - et0.seconds;
+                }
+            }
+        }
+    }
+}
+
+
+TEST(passes_test, Invalid_Inputs) {
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FPass> Passes;
+    TArray<FGroundStation> Stations;
+    Stations.AddDefaulted();
+
+    FSatelliteCatalog Catalog;
+    Catalog.Init(4, et0.seconds, 60., 1);
+    EXPECT_FALSE(Predict(Passes, Catalog, Stations, FPassSettings(), nullptr, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    Catalog.Init(4, et0.seconds, 60., 3);
+    Catalog.Samples[1].SetNum(3);
+    EXPECT_FALSE(Predict(Passes, Catalog, Stations, FPassSettings(), nullptr, &ResultCode, &ErrorMessage));
+
+    LoadKernels();
+    EXPECT_FALSE(SampleCatalog(Catalog, TArray<FName>(), Body, NAME_None, et0, et0, FSEphemerisPeriod(60.), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
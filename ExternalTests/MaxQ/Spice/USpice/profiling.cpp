@@ -0,0 +1,109 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceProfiling.h"
+
+#if MAXQ_SPICE_PROFILING
+
+namespace
+{
+    const MaxQ::Profiling::FCallStats* FindRow(const TArray<MaxQ::Profiling::FCallStats>& Rows, const TCHAR* Function, const TCHAR* Target)
+    {
+        return Rows.FindByPredicate([=](const MaxQ::Profiling::FCallStats& Row) { return Row.Function == Function && Row.Target == Target; });
+    }
+}
+
+TEST(profiling_test, Capture_Counts_Calls_And_Errors) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSStateVector stateVector;
+    FSEphemerisPeriod lt;
+
+    MaxQ::Profiling::StartCapture();
+    EXPECT_TRUE(MaxQ::Profiling::IsCapturing());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        USpice::spkezr(ResultCode, ErrorMessage, et0, stateVector, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    }
+
+    {
+        MaxQ::Core::FDeferredErrorScope Errors(TEXT("profiling_test"), 16, false);
+        for (int i = 0; i < 3; ++i)
+        {
+            USpice::spkezr(ResultCode, ErrorMessage, et0, stateVector, lt, TEXT("NOSUCHBODY"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+            EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+        }
+    }
+
+    MaxQ::Profiling::StopCapture();
+    EXPECT_FALSE(MaxQ::Profiling::IsCapturing());
+
+    // Outside the window
+    USpice::spkezr(ResultCode, ErrorMessage, et0, stateVector, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+
+    TArray<MaxQ::Profiling::FCallStats> Rows = MaxQ::Profiling::GetCapture();
+
+    const MaxQ::Profiling::FCallStats* Good = FindRow(Rows, TEXT("USpice::spkezr"), TEXT("FAKEBODY9994"));
+    ASSERT_NE(Good, nullptr);
+    EXPECT_EQ(Good->Calls, 10);
+    EXPECT_EQ(Good->Errors, 0);
+    EXPECT_EQ(Good->Observer, TEXT("FAKEBODY9995"));
+    EXPECT_EQ(Good->Frame, TEXT("ECLIPJ2000"));
+    EXPECT_GT(Good->InclusiveSeconds, 0.);
+
+    const MaxQ::Profiling::FCallStats* Bad = FindRow(Rows, TEXT("USpice::spkezr"), TEXT("NOSUCHBODY"));
+    ASSERT_NE(Bad, nullptr);
+    EXPECT_EQ(Bad->Calls, 3);
+    EXPECT_EQ(Bad->Errors, 3);
+
+    for (int32 i = 1; i < Rows.Num(); ++i)
+    {
+        EXPECT_GE(Rows[i - 1].InclusiveSeconds, Rows[i].InclusiveSeconds);
+    }
+}
+
+TEST(profiling_test, Csv_Is_Hottest_First) {
+
+    USpice::init_all();
+
+    MaxQ::Profiling::StartCapture();
+    FSDimensionlessVector v;
+    for (int i = 0; i < 100; ++i)
+    {
+        USpice::vadd(FSDimensionlessVector(1, 2, 3), FSDimensionlessVector(4, 5, 6), v);
+    }
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSRotationMatrix m;
+    USpice::pxform(ResultCode, ErrorMessage, m, et0, TEXT("J2000"), TEXT("ECLIPJ2000"));
+    MaxQ::Profiling::StopCapture();
+
+    TArray<FString> Lines;
+    MaxQ::Profiling::GetCaptureCsv().ParseIntoArrayLines(Lines);
+
+    ASSERT_GE(Lines.Num(), 3);
+    EXPECT_EQ(Lines[0], TEXT("Function,Target,Observer,Frame,Calls,InclusiveMs,MeanUs,Errors"));
+    EXPECT_EQ(Lines.Num(), MaxQ::Profiling::GetCapture().Num() + 1);
+
+    MaxQ::Profiling::GetCaptureCsv(1).ParseIntoArrayLines(Lines);
+    EXPECT_EQ(Lines.Num(), 2);
+
+    // A new window starts empty
+    MaxQ::Profiling::StartCapture();
+    MaxQ::Profiling::StopCapture();
+    EXPECT_EQ(MaxQ::Profiling::GetCapture().Num(), 0);
+}
+
+#endif
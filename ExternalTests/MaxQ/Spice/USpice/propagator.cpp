@@ -0,0 +1,327 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpicePropagator.h"
+#include "SpiceEphemeris.h"
+#include <cstdio>
+
+using namespace MaxQ::Propagator;
+
+namespace
+{
+    // FAKEBODY9993 (GM 0.001, radius ~22km, spinning 36 deg/day about the
+    // ecliptic pole) is the center, FAKEBODY9994 the third body & sun.  The
+    // unit test SPK covers them for about a day either side of et0.
+    const FName Center(TEXT("FAKEBODY9993"));
+    const FName Third(TEXT("FAKEBODY9994"));
+    const FName Frame(TEXT("J2000"));
+    constexpr double GM = 0.001;
+    constexpr double Radius = 40.;
+    constexpr double Span = 40000.;
+
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+        // cnmfrm doesn't find the unit test FK's frame by itself
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        USpice::pcpool(ResultCode, ErrorMessage, TEXT("OBJECT_FAKEBODY9993_FRAME"), TEXT("IAU_FAKEBODY9993"));
+    }
+
+    // The center's pole, in J2000
+    FVector3d Pole(const FSEphemerisTime& et)
+    {
+        double m[3][3];
+        MaxQ::Ephemeris::Pxform(et, FName(TEXT("IAU_FAKEBODY9993")), Frame).CopyTo(m);
+        return FVector3d(m[0][2], m[1][2], m[2][2]);
+    }
+
+    // Zonal harmonics for the center
+    constexpr double J2 = 1e-3, J3 = -2.5e-6, J4 = -1.6e-6;
+
+    void SetHarmonics()
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        USpice::pdpool(ResultCode, ErrorMessage, TEXT("BODY9993_J2"), J2);
+        USpice::pdpool(ResultCode, ErrorMessage, TEXT("BODY9993_J3"), J3);
+        USpice::pdpool(ResultCode, ErrorMessage, TEXT("BODY9993_J4"), J4);
+    }
+
+    // Circular, inclined 0.5 rad, t seconds past et0
+    FSStateVector Circular(double t)
+    {
+        const double n = sqrt(GM / (Radius * Radius * Radius));
+        const double v = n * Radius;
+        const double c = cos(n * t), s = sin(n * t), ci = cos(.5), si = sin(.5);
+        return FSStateVector(
+            FSDistanceVector(Radius * c, Radius * s * ci, Radius * s * si),
+            FSVelocityVector(-v * s, v * c * ci, v * c * si)
+        );
+    }
+
+    double PositionError(const FSStateVector& State, const FSStateVector& Expected)
+    {
+        return FVector3d(State.r.x.km - Expected.r.x.km, State.r.y.km - Expected.r.y.km, State.r.z.km - Expected.r.z.km).Length();
+    }
+
+    FVector3d ToVector(const FSDistanceVector& r)
+    {
+        return FVector3d(r.x.km, r.y.km, r.z.km);
+    }
+}
+
+
+TEST(propagator_test, Two_Body_Matches_Kepler) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FForceModel Model;
+    Model.Center = Center;
+    TSharedPtr<FPropagator> Propagator = FPropagator::Create(Model, et0, et0 + FSEphemerisPeriod(Span), &ResultCode, &ErrorMessage);
+    ASSERT_TRUE(Propagator.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    for (EIntegrator Integrator : { EIntegrator::DOP853, EIntegrator::Symplectic })
+    {
+        FIntegratorSettings Settings;
+        Settings.Integrator = Integrator;
+
+        FSStateVector State = Circular(0.);
+        FTrajectory Trajectory;
+        ASSERT_TRUE(Propagator->Propagate(State, et0, et0 + FSEphemerisPeriod(Span), Settings, 0., 0., &Trajectory, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+        EXPECT_LT(PositionError(State, Circular(Span)), 1e-5);
+
+        // Dense output, between steps
+        EXPECT_DOUBLE_EQ(Trajectory.First(), et0.seconds);
+        EXPECT_DOUBLE_EQ(Trajectory.Last(), et0.seconds + Span);
+        for (double t = 17.; t < Span; t += 1013.)
+        {
+            EXPECT_LT(PositionError(Trajectory.Evaluate(et0 + FSEphemerisPeriod(t)), Circular(t)), 1e-5) << t;
+        }
+
+        // ...and back
+        ASSERT_TRUE(Propagator->Propagate(State, et0 + FSEphemerisPeriod(Span), et0, Settings, 0., 0., nullptr, &ResultCode, &ErrorMessage));
+        EXPECT_LT(PositionError(State, Circular(0.)), 1e-5);
+    }
+
+    // Outside the window it was created for
+    FSStateVector State = Circular(0.);
+    EXPECT_FALSE(Propagator->Propagate(State, et0, et0 + FSEphemerisPeriod(2. * Span), FIntegratorSettings(), 0., 0., nullptr, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+
+TEST(propagator_test, Zonal_Harmonics_Match_Potential) {
+
+    LoadKernels();
+    SetHarmonics();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FForceModel Model;
+    Model.Center = Center;
+    Model.MaxZonalDegree = 4;
+    TSharedPtr<FPropagator> Propagator = FPropagator::Create(Model, et0, et0 + FSEphemerisPeriod(Span), &ResultCode, &ErrorMessage);
+    ASSERT_TRUE(Propagator.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // Perturbing potential about the pole, at the reference radius (RADII,
+    // since there's no ER)
+    const double R = 22.22;
+    const FVector3d Axis = Pole(et0);
+    const auto Potential = [&](const FVector3d& r)
+    {
+        const double d = r.Length(), s = (r | Axis) / d, q = R / d;
+        const double P2 = (3. * s * s - 1.) / 2., P3 = (5. * s * s * s - 3. * s) / 2., P4 = (35. * pow(s, 4) - 30. * s * s + 3.) / 8.;
+        return -GM / d * (J2 * q * q * P2 + J3 * pow(q, 3) * P3 + J4 * pow(q, 4) * P4);
+    };
+
+    for (const FVector3d& r : { FVector3d(30., -12., 17.), FVector3d(-25., 4., -31.), FVector3d(0., 0., 45.) })
+    {
+        const FVector3d Acceleration = Propagator->Acceleration(et0, FSStateVector(FSDistanceVector(r.X, r.Y, r.Z), FSVelocityVector(0., 0., 0.)));
+        const FVector3d Perturbation = Acceleration + r * (GM / pow(r.Length(), 3));
+
+        const double h = 1e-4;
+        const FVector3d Gradient(
+            (Potential(r + FVector3d(h, 0., 0.)) - Potential(r - FVector3d(h, 0., 0.))) / (2. * h),
+            (Potential(r + FVector3d(0., h, 0.)) - Potential(r - FVector3d(0., h, 0.))) / (2. * h),
+            (Potential(r + FVector3d(0., 0., h)) - Potential(r - FVector3d(0., 0., h))) / (2. * h)
+        );
+        EXPECT_LT((Perturbation - Gradient).Length(), 1e-6 * Gradient.Length()) << r.X << " " << r.Y << " " << r.Z;
+    }
+
+    // Missing harmonics fail the model
+    Model.Center = Third;
+    EXPECT_FALSE(FPropagator::Create(Model, et0, et0 + FSEphemerisPeriod(Span), &ResultCode, &ErrorMessage).IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+
+TEST(propagator_test, Third_Body_And_Surface_Forces) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FForceModel Model;
+    Model.Center = Center;
+    Model.Perturbers.Add(Third);
+    Model.EphemerisStep = 600.;
+    Model.bDrag = true;
+    Model.Atmosphere.Add(FDensityBand{ 0., 1e-9, 5. });
+    Model.bSolarRadiationPressure = true;
+    Model.Sun = Third;
+    TSharedPtr<FPropagator> Propagator = FPropagator::Create(Model, et0, et0 + FSEphemerisPeriod(Span), &ResultCode, &ErrorMessage);
+    ASSERT_TRUE(Propagator.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // Third body, from the cached ephemeris
+    const FSEphemerisTime et = et0 + FSEphemerisPeriod(1234.5);
+    const FVector3d Body = ToVector(MaxQ::Ephemeris::Spkpos(et, Third, Center, Frame));
+    const FVector3d r(Radius, 0., 0.);
+    const FSStateVector Still(FSDistanceVector(r.X, r.Y, r.Z), FSVelocityVector(0., 0., 0.));
+    double ThirdGM = 0.;
+    MaxQ::Data::Bodvrd(ThirdGM, Third, FName(TEXT("GM")));
+
+    const FVector3d Expected = -r * (GM / pow(Radius, 3)) + ((Body - r) / pow((Body - r).Length(), 3) - Body / pow(Body.Length(), 3)) * ThirdGM;
+    const FVector3d Acceleration = Propagator->Acceleration(et, Still);
+    EXPECT_LT((Acceleration - Expected).Length(), 1e-6 * (Acceleration + r * (GM / pow(Radius, 3))).Length());
+
+    // Drag against the velocity, and none moving with the atmosphere
+    const FSStateVector Orbiting = Circular(0.);
+    const FVector3d Drag = Propagator->Acceleration(et, Orbiting, 0.01) - Propagator->Acceleration(et, Orbiting);
+    EXPECT_LT(Drag | FVector3d(Orbiting.v.dx.kmps, Orbiting.v.dy.kmps, Orbiting.v.dz.kmps), 0.);
+
+    const FVector3d Wind = (Pole(et) * (36. * PI / 180. / 86400.)).Cross(r);
+    const FSStateVector Corotating(FSDistanceVector(r.X, r.Y, r.Z), FSVelocityVector(Wind.X, Wind.Y, Wind.Z));
+    EXPECT_LT((Propagator->Acceleration(et, Corotating, 0.01) - Propagator->Acceleration(et, Corotating)).Length(), 1e-6 * Drag.Length());
+
+    // Solar pressure pushes away from the sun, except in the shadow
+    const FVector3d SunDirection = Body.GetSafeNormal();
+    const FVector3d Day = SunDirection * Radius, Night = -SunDirection * Radius;
+    const auto Pressure = [&](const FVector3d& p)
+    {
+        const FSStateVector State(FSDistanceVector(p.X, p.Y, p.Z), FSVelocityVector(0., 0., 0.));
+        return Propagator->Acceleration(et, State, 0., 0.02) - Propagator->Acceleration(et, State);
+    };
+    const double AU = 149597870.7;
+    const double Expect = 4.56e-6 * 0.02 * pow(AU / (Body - Day).Length(), 2) * 1e-3;
+    EXPECT_NEAR(Pressure(Day) | -SunDirection, Expect, 1e-6 * Expect);
+    EXPECT_EQ(Pressure(Night).Length(), 0.);
+}
+
+
+TEST(propagator_test, Batch_Matches_Single) {
+
+    LoadKernels();
+    SetHarmonics();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FForceModel Model;
+    Model.Center = Center;
+    Model.MaxZonalDegree = 4;
+    Model.Perturbers.Add(Third);
+    TSharedPtr<FPropagator> Propagator = FPropagator::Create(Model, et0, et0 + FSEphemerisPeriod(Span), &ResultCode, &ErrorMessage);
+    ASSERT_TRUE(Propagator.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    FSpacecraftBatch Batch;
+    for (int32 i = 0; i < 256; ++i)
+    {
+        // Circular, 30 to 40km (FAKEBODY9994 pulls higher orbits away)
+        const FSStateVector State = Circular(i * 150.);
+        const double Scale = .75 + i * 1e-3, Speed = 1. / sqrt(Scale);
+        Batch.Add(FSStateVector(
+            FSDistanceVector(State.r.x.km * Scale, State.r.y.km * Scale, State.r.z.km * Scale),
+            FSVelocityVector(State.v.dx.kmps * Speed, State.v.dy.kmps * Speed, State.v.dz.kmps * Speed)
+        ));
+    }
+    const FSpacecraftBatch Initial = Batch;
+
+    FIntegratorSettings Settings;
+    Settings.RelativeTolerance = 1e-12;
+    Settings.PositionTolerance = 1e-9;
+    Settings.VelocityTolerance = 1e-12;
+    FPropagationStats Stats;
+    ASSERT_TRUE(Propagator->Propagate(Batch, et0, et0 + FSEphemerisPeriod(Span), Settings, &Stats, nullptr, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_GT(Stats.Steps, 0);
+    EXPECT_GT(Stats.Evaluations, Stats.Steps);
+    EXPECT_EQ(Stats.Failures, 0);
+
+    for (int32 i = 0; i < Batch.Num(); i += 37)
+    {
+        FSStateVector State = Initial.States.Get(i);
+        ASSERT_TRUE(Propagator->Propagate(State, et0, et0 + FSEphemerisPeriod(Span), Settings, 0., 0., nullptr, &ResultCode, &ErrorMessage));
+        EXPECT_LT(PositionError(Batch.States.Get(i), State), 1e-6) << i;
+    }
+
+    // The symplectic integrator agrees, at short steps
+    FSpacecraftBatch Symplectic = Initial;
+    Settings.Integrator = EIntegrator::Symplectic;
+    Settings.FixedStep = 5.;
+    ASSERT_TRUE(Propagator->Propagate(Symplectic, et0, et0 + FSEphemerisPeriod(Span), Settings, &Stats, nullptr, &ResultCode, &ErrorMessage));
+    for (int32 i = 0; i < Batch.Num(); i += 37)
+    {
+        EXPECT_LT(PositionError(Batch.States.Get(i), Symplectic.States.Get(i)), 1e-5) << i;
+    }
+
+    // A spacecraft inside the center never gets there
+    FSpacecraftBatch Doomed = Initial;
+    Doomed.States.x[0] = Doomed.States.y[0] = Doomed.States.z[0] = 0.;
+    Settings.Integrator = EIntegrator::DOP853;
+    EXPECT_FALSE(Propagator->Propagate(Doomed, et0, et0 + FSEphemerisPeriod(Span), Settings, &Stats, nullptr, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Stats.Failures, Settings.BlockSize);
+}
+
+
+TEST(propagator_test, Write_Spk) {
+
+    LoadKernels();
+    SetHarmonics();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FForceModel Model;
+    Model.Center = Center;
+    Model.MaxZonalDegree = 2;
+    TSharedPtr<FPropagator> Propagator = FPropagator::Create(Model, et0, et0 + FSEphemerisPeriod(Span), &ResultCode, &ErrorMessage);
+    ASSERT_TRUE(Propagator.IsValid()) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    FSStateVector State = Circular(0.);
+    FTrajectory Trajectory;
+    ASSERT_TRUE(Propagator->Propagate(State, et0, et0 + FSEphemerisPeriod(Span), FIntegratorSettings(), 0., 0., &Trajectory, &ResultCode, &ErrorMessage));
+
+    const std::string Spk = TestFilePath("propagator_trajectory.bsp");
+    std::remove(Spk.c_str());
+
+    int Handle = 0;
+    USpice::spkopn(ResultCode, ErrorMessage, Spk.c_str(), TEXT("PROPAGATOR TEST"), 0, Handle);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    MaxQ::Compression::FChebyshevFitSettings Settings;
+    Settings.PositionTolerance = 1e-5;
+    MaxQ::Compression::FCompressionStats Stats;
+    WriteSpk(Trajectory, Handle, -999301, TEXT("PROPAGATED"), Settings, Stats, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    USpice::spkcls(ResultCode, ErrorMessage, Handle);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Stats.RecordsOverTolerance, 0);
+
+    USpice::furnsh_absolute(Spk.c_str());
+    for (double t = 3.; t < Span; t += 997.)
+    {
+        const FSEphemerisTime et = et0 + FSEphemerisPeriod(t);
+        const FSDistanceVector r = MaxQ::Ephemeris::Spkpos(et, FName(TEXT("-999301")), Center, Frame, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        EXPECT_LT((ToVector(r) - ToVector(Trajectory.Evaluate(et).r)).Length(), 2e-5) << t;
+    }
+}
@@ -0,0 +1,180 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSegments.h"
+#include <random>
+
+using MaxQ::Segments::EKernelKind;
+using MaxQ::Segments::FIntervalTree;
+
+namespace
+{
+    // Short, overlapping segments, like a day-by-day ephemeris per spacecraft
+    TArray<FIntervalTree::FEntry> MakeEntries(int32 Count, std::mt19937& Random)
+    {
+        std::uniform_real_distribution<double> Start(0., 1e8);
+        std::uniform_real_distribution<double> Length(0., 2. * 86400.);
+
+        TArray<FIntervalTree::FEntry> Entries;
+        for (int32 i = 0; i < Count; ++i)
+        {
+            const double t = Start(Random);
+            Entries.Add({ t, t + Length(Random), (int64)i, i });
+        }
+        return Entries;
+    }
+
+    // What a linear segment list does:  the last (highest priority) entry containing Time
+    int32 LinearSearch(const TArray<FIntervalTree::FEntry>& Entries, double Time)
+    {
+        for (int32 i = Entries.Num() - 1; i >= 0; --i)
+        {
+            if (Entries[i].Start <= Time && Time <= Entries[i].Stop)
+            {
+                return Entries[i].Index;
+            }
+        }
+        return INDEX_NONE;
+    }
+}
+
+TEST(segments_test, Interval_Tree_Matches_Linear_Search) {
+
+    std::mt19937 Random(1);
+    std::uniform_real_distribution<double> Time(0., 1e8);
+
+    for (int32 Count : { 0, 1, 2, 3, 17, 1000 })
+    {
+        TArray<FIntervalTree::FEntry> Entries = MakeEntries(Count, Random);
+        FIntervalTree Tree(CopyTemp(Entries));
+        EXPECT_EQ(Tree.Num(), Count);
+
+        for (int32 q = 0; q < 2000; ++q)
+        {
+            const double t = Time(Random);
+            EXPECT_EQ(Tree.FindHighestPriority(t), LinearSearch(Entries, t));
+
+            TArray<int32> All;
+            Tree.FindAll(t, All);
+            for (int32 i : All)
+            {
+                EXPECT_LE(Entries[i].Start, t);
+                EXPECT_GE(Entries[i].Stop, t);
+            }
+        }
+    }
+}
+
+TEST(segments_test, Interval_Tree_Precedence) {
+
+    // Nested & equal intervals, the highest priority wins
+    FIntervalTree Tree({ { 0., 100., 0, 0 }, { 10., 20., 1, 1 }, { 0., 100., 2, 2 }, { 50., 60., 3, 3 } });
+
+    EXPECT_EQ(Tree.FindHighestPriority(15.), 2);
+    EXPECT_EQ(Tree.FindHighestPriority(55.), 3);
+    EXPECT_EQ(Tree.FindHighestPriority(100.), 2);
+    EXPECT_EQ(Tree.FindHighestPriority(100.5), INDEX_NONE);
+    EXPECT_EQ(Tree.FindHighestPriority(-0.5), INDEX_NONE);
+
+    TArray<int32> All;
+    Tree.FindAll(15., All);
+    All.Sort();
+    EXPECT_EQ(All, TArray<int32>({ 0, 1, 2 }));
+}
+
+TEST(segments_test, Select_Loaded_Segments) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    EXPECT_GT(MaxQ::Segments::GetSegmentCount(), 0);
+
+    MaxQ::Segments::FSegment Segment;
+    ASSERT_TRUE(MaxQ::Segments::Select(EKernelKind::SPK, 9994, et0.seconds, Segment));
+    EXPECT_EQ(Segment.Id, 9994);
+    EXPECT_LE(Segment.Start, et0.seconds);
+    EXPECT_GE(Segment.Stop, et0.seconds);
+
+    TArray<MaxQ::Segments::FSegment> Segments;
+    EXPECT_TRUE(MaxQ::Segments::SelectAll(EKernelKind::SPK, 9994, et0.seconds, Segments));
+    ASSERT_GT(Segments.Num(), 0);
+    EXPECT_EQ(Segments[0].Start, Segment.Start);
+    EXPECT_EQ(Segments[0].Stop, Segment.Stop);
+
+    EXPECT_FALSE(MaxQ::Segments::Select(EKernelKind::SPK, 1234567, et0.seconds, Segment));
+
+    USpice::clear_all();
+    EXPECT_EQ(MaxQ::Segments::GetSegmentCount(), 0);
+    EXPECT_FALSE(MaxQ::Segments::Select(EKernelKind::SPK, 9994, et0.seconds, Segment));
+}
+
+TEST(segments_test, Spkgeo_Matches_CSPICE) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSStateVector Expected, Actual;
+    FSEphemerisPeriod ExpectedLt, ActualLt;
+
+    USpice::spkgeo(ResultCode, ErrorMessage, 9994, et0, 9995, Expected, ExpectedLt, TEXT("ECLIPJ2000"));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    EXPECT_TRUE(MaxQ::Segments::Spkgeo(Actual, ActualLt, FName(TEXT("FAKEBODY9994")), et0, FName(TEXT("ECLIPJ2000")), FName(TEXT("FAKEBODY9995")), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(IsNear(Actual, Expected), true);
+    EXPECT_NEAR(ActualLt.seconds, ExpectedLt.seconds, 1e-9);
+
+    EXPECT_FALSE(MaxQ::Segments::Spkgeo(Actual, ActualLt, 1234567, et0, FName(TEXT("J2000")), 9995, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+TEST(segments_test, Benchmark_Selection) {
+
+    std::mt19937 Random(2);
+    std::uniform_real_distribution<double> Time(0., 1e8);
+
+    constexpr int32 Queries = 20000;
+    TArray<double> Times;
+    for (int32 q = 0; q < Queries; ++q)
+    {
+        Times.Add(Time(Random));
+    }
+
+    for (int32 Count : { 1000, 10000, 50000 })
+    {
+        TArray<FIntervalTree::FEntry> Entries = MakeEntries(Count, Random);
+
+        double Start = FPlatformTime::Seconds();
+        FIntervalTree Tree(CopyTemp(Entries));
+        const double BuildSeconds = FPlatformTime::Seconds() - Start;
+
+        int32 Found = 0;
+        Start = FPlatformTime::Seconds();
+        for (double t : Times)
+        {
+            Found += Tree.FindHighestPriority(t) != INDEX_NONE;
+        }
+        const double TreeSeconds = FPlatformTime::Seconds() - Start;
+
+        int32 LinearFound = 0;
+        Start = FPlatformTime::Seconds();
+        for (double t : Times)
+        {
+            LinearFound += LinearSearch(Entries, t) != INDEX_NONE;
+        }
+        const double LinearSeconds = FPlatformTime::Seconds() - Start;
+
+        EXPECT_EQ(Found, LinearFound);
+
+        printf("[ BENCHMARK] %d segments: build %.2f ms, interval tree %.1f ns/query, linear %.1f ns/query\n",
+            Count, 1000. * BuildSeconds, 1e9 * TreeSeconds / Queries, 1e9 * LinearSeconds / Queries);
+    }
+}
@@ -0,0 +1,371 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceStarCatalog.h"
+#include <cstdio>
+#include <random>
+#include <set>
+
+using namespace MaxQ::Stars;
+
+namespace
+{
+    constexpr double JulianYear = 31557600.;
+    constexpr double SpeedOfLight = 299792.458;
+    constexpr double ArcSecond = PI / (180. * 3600.);
+
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    }
+
+    // Uniform over the sky, magnitudes -1.5 to 12, proper motions up to
+    // MaxProperMotion (radians per Julian year), some at Hipparcos' epoch
+    TArray<FStar> RandomStars(int32 Num, double MaxProperMotion, uint32 Seed = 1)
+    {
+        static const char* SpectralTypes[] = { "G2V", "K0II", "B5", "M3V", "A0V", "F5", "O9", "" };
+
+        std::mt19937 Random(Seed);
+        std::uniform_real_distribution<double> Uniform(0., 1.);
+
+        TArray<FStar> Stars;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            FStar& Star = Stars.AddDefaulted_GetRef();
+            Star.CatalogNumber = 1000 + i;
+            Star.RA = 2. * PI * Uniform(Random);
+            Star.Dec = asin(2. * Uniform(Random) - 1.);
+            Star.RaSigma = Uniform(Random) * 1e-6;
+            Star.DecSigma = Uniform(Random) * 1e-6;
+            Star.Magnitude = -1.5 + 13.5 * Uniform(Random);
+            Star.RaProperMotion = (2. * Uniform(Random) - 1.) * MaxProperMotion / FMath::Max(cos(Star.Dec), .1);
+            Star.DecProperMotion = (2. * Uniform(Random) - 1.) * MaxProperMotion;
+            if (i % 3 == 0)
+            {
+                Star.RaEpoch = Star.DecEpoch = -8.75 * JulianYear;
+            }
+            FCStringAnsi::Strncpy(Star.SpectralType, SpectralTypes[i % UE_ARRAY_COUNT(SpectralTypes)], UE_ARRAY_COUNT(Star.SpectralType));
+        }
+        return Stars;
+    }
+
+    FVector3d Direction(double RA, double Dec)
+    {
+        return FVector3d(cos(Dec) * cos(RA), cos(Dec) * sin(RA), sin(Dec));
+    }
+
+    // Independently:  along the sky's tangent to et, then stelab's rotation
+    // toward the velocity
+    FVector3d Apparent(const FStar& Star, const FStarQuery& Query)
+    {
+        const double ra = Star.RA - Star.RaProperMotion * Star.RaEpoch / JulianYear;
+        const double dec = Star.Dec - Star.DecProperMotion * Star.DecEpoch / JulianYear;
+        const FVector3d East(-sin(ra), cos(ra), 0.);
+        const FVector3d North(-sin(dec) * cos(ra), -sin(dec) * sin(ra), cos(dec));
+        const double Years = Query.et / JulianYear;
+        const FVector3d p = (Direction(ra, dec) + (East * (Star.RaProperMotion * cos(dec)) + North * Star.DecProperMotion) * Years).GetSafeNormal();
+
+        const FVector3d h = p ^ (Query.Velocity / SpeedOfLight);
+        const double Sine = h.Length();
+        if (Sine == 0.)
+        {
+            return p;
+        }
+        const double Angle = asin(Sine);
+        const FVector3d Axis = h / Sine;
+        return p * cos(Angle) + (Axis ^ p) * sin(Angle) + Axis * ((Axis | p) * (1. - cos(Angle)));
+    }
+
+    // The stars a query should find, by catalog number, and the ones too
+    // close to its boundary to call
+    template<class FInside>
+    void BruteForce(const FStarCatalog& Catalog, const FStarQuery& Query, FInside Inside, std::set<int32>& Expected, std::set<int32>& Marginal)
+    {
+        for (const FStar& Star : Catalog.Stars)
+        {
+            if (Star.Magnitude > Query.MaxMagnitude)
+            {
+                continue;
+            }
+            const double Margin = Inside(Apparent(Star, Query));
+            if (fabs(Margin) < 1e-12)
+            {
+                Marginal.insert(Star.CatalogNumber);
+            }
+            else if (Margin > 0.)
+            {
+                Expected.insert(Star.CatalogNumber);
+            }
+        }
+    }
+
+    void ExpectSelection(const FStarCatalog& Catalog, const FStarSelection& Selection, const FStarQuery& Query, const std::set<int32>& Expected, const std::set<int32>& Marginal)
+    {
+        std::set<int32> Selected;
+        for (int32 k = 0; k < Selection.Num(); ++k)
+        {
+            const FStar& Star = Catalog.Stars[Selection.Stars[k]];
+            Selected.insert(Star.CatalogNumber);
+            EXPECT_LT((Selection.Direction(k) - Apparent(Star, Query)).Length(), 1e-12);
+            EXPECT_NEAR(Selection.Direction(k).Length(), 1., 1e-14);
+            EXPECT_FLOAT_EQ(Selection.Magnitude[k], (float)Star.Magnitude);
+        }
+        EXPECT_EQ((size_t)Selection.Num(), Selected.size());
+
+        for (int32 CatalogNumber : Expected)
+        {
+            EXPECT_TRUE(Selected.count(CatalogNumber)) << CatalogNumber;
+        }
+        for (int32 CatalogNumber : Selected)
+        {
+            EXPECT_TRUE(Expected.count(CatalogNumber) || Marginal.count(CatalogNumber)) << CatalogNumber;
+        }
+    }
+}
+
+
+TEST(star_catalog_test, Write_Load) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    const TArray<FStar> Stars = RandomStars(500, ArcSecond);
+    const std::string File = TestFilePath("star_catalog_test.bdb");
+
+    ASSERT_TRUE(WriteCatalog(File.c_str(), TEXT("STAR_CATALOG_TEST"), Stars, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    TArray<FStar> Loaded;
+    ASSERT_TRUE(LoadCatalog(Loaded, File.c_str(), &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_EQ(Loaded.Num(), Stars.Num());
+
+    for (const FStar& Star : Loaded)
+    {
+        const FStar* Written = Stars.FindByPredicate([&](const FStar& Other) { return Other.CatalogNumber == Star.CatalogNumber; });
+        ASSERT_TRUE(Written != nullptr);
+        EXPECT_NEAR(Star.RA, Written->RA, 1e-14);
+        EXPECT_NEAR(Star.Dec, Written->Dec, 1e-14);
+        EXPECT_NEAR(Star.RaSigma, Written->RaSigma, 1e-20);
+        EXPECT_NEAR(Star.DecSigma, Written->DecSigma, 1e-20);
+        EXPECT_DOUBLE_EQ(Star.Magnitude, Written->Magnitude);
+        EXPECT_NEAR(Star.RaProperMotion, Written->RaProperMotion, 1e-20);
+        EXPECT_NEAR(Star.DecProperMotion, Written->DecProperMotion, 1e-20);
+        EXPECT_NEAR(Star.RaEpoch, Written->RaEpoch, 1e-3);
+        EXPECT_NEAR(Star.DecEpoch, Written->DecEpoch, 1e-3);
+        EXPECT_EQ(Star.GetSpectralType(), Written->GetSpectralType());
+    }
+
+    // Indexed, without the faint ones
+    FStarCatalog Catalog;
+    FStarCatalogSettings Settings;
+    Settings.MaxMagnitude = 6.;
+    ASSERT_TRUE(LoadCatalog(Catalog, File.c_str(), Settings, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(Catalog.Num(), Stars.FilterByPredicate([](const FStar& Star) { return Star.Magnitude <= 6.; }).Num());
+
+    std::remove(File.c_str());
+}
+
+
+TEST(star_catalog_test, Cone_Matches_Brute_Force) {
+
+    FStarCatalog Catalog;
+    Catalog.Build(RandomStars(20000, 10. * ArcSecond), FStarCatalogSettings());
+    ASSERT_EQ(Catalog.Num(), 20000);
+
+    std::mt19937 Random(7);
+    std::uniform_real_distribution<double> Uniform(0., 1.);
+
+    for (int32 q = 0; q < 40; ++q)
+    {
+        FStarQuery Query;
+        Query.et = (Uniform(Random) - .5) * 200. * JulianYear;
+        Query.Velocity = q % 4 ? FVector3d(30. * Uniform(Random), -25. * Uniform(Random), 12. * Uniform(Random)) : FVector3d::ZeroVector;
+        Query.MaxMagnitude = 4. + 8. * Uniform(Random);
+
+        // Tiny through more than a hemisphere
+        const double RA = 2. * PI * Uniform(Random), Dec = asin(2. * Uniform(Random) - 1.);
+        const double Radius = q == 0 ? 3. : .002 + .6 * Uniform(Random) * Uniform(Random);
+        const FVector3d Axis = Direction(RA, Dec);
+
+        FStarSelection Selection;
+        FStarQueryStats Stats;
+        Catalog.Cone(Selection, RA, Dec, Radius, Query, &Stats);
+        EXPECT_EQ(Stats.Selected, Selection.Num());
+        EXPECT_LE(Stats.Selected, Stats.Tested);
+
+        std::set<int32> Expected, Marginal;
+        BruteForce(Catalog, Query, [&](const FVector3d& p) { return (p | Axis) - cos(Radius); }, Expected, Marginal);
+        ExpectSelection(Catalog, Selection, Query, Expected, Marginal);
+        if (q == 1)
+        {
+            EXPECT_GT(Expected.size(), 0u);
+        }
+    }
+}
+
+
+TEST(star_catalog_test, Frustum_Matches_Brute_Force) {
+
+    FStarCatalog Catalog;
+    FStarCatalogSettings Settings;
+    Settings.Resolution = 16;
+    Catalog.Build(RandomStars(20000, 10. * ArcSecond, 3), Settings);
+
+    std::mt19937 Random(11);
+    std::uniform_real_distribution<double> Uniform(-1., 1.);
+
+    for (int32 q = 0; q < 40; ++q)
+    {
+        FStarQuery Query;
+        Query.et = Uniform(Random) * 100. * JulianYear;
+        Query.Velocity = FVector3d(30. * Uniform(Random), 30. * Uniform(Random), 30. * Uniform(Random));
+        Query.MaxMagnitude = 9.;
+
+        const FVector3d Forward(Uniform(Random), Uniform(Random), Uniform(Random));
+        const FVector3d Up(Uniform(Random), Uniform(Random), Uniform(Random));
+        TArray<FVector3d> Planes;
+        MakeFrustum(Planes, Forward, Up, .1 + .7 * fabs(Uniform(Random)), .1 + .5 * fabs(Uniform(Random)));
+        ASSERT_EQ(Planes.Num(), 4);
+
+        FStarSelection Selection;
+        Catalog.Frustum(Selection, Planes, Query);
+
+        std::set<int32> Expected, Marginal;
+        BruteForce(Catalog, Query, [&](const FVector3d& p)
+        {
+            double Margin = 1.;
+            for (const FVector3d& Plane : Planes) Margin = FMath::Min(Margin, p | Plane);
+            return Margin;
+        }, Expected, Marginal);
+        ExpectSelection(Catalog, Selection, Query, Expected, Marginal);
+
+        // Everything's in front
+        for (int32 k = 0; k < Selection.Num(); ++k)
+        {
+            EXPECT_GT(Selection.Direction(k) | Forward, 0.);
+        }
+    }
+}
+
+
+TEST(star_catalog_test, Proper_Motion_And_Aberration) {
+
+    FStarCatalog Catalog;
+    const TArray<FStar> Stars = RandomStars(2000, ArcSecond, 5);
+    Catalog.Build(Stars);
+
+    // At a star's own epoch, with no velocity, it's where the catalog says
+    TArray<int32> All;
+    for (int32 i = 0; i < Catalog.Num(); ++i) All.Add(i);
+
+    FStarSelection Selection;
+    FStarQuery Query;
+    Query.et = -8.75 * JulianYear;
+    Catalog.Apparent(Selection, All, Query);
+    ASSERT_EQ(Selection.Num(), Catalog.Num());
+    for (int32 k = 0; k < Selection.Num(); ++k)
+    {
+        const FStar& Star = Catalog.Stars[Selection.Stars[k]];
+        if (Star.RaEpoch == Query.et)
+        {
+            EXPECT_LT((Selection.Direction(k) - Direction(Star.RA, Star.Dec)).Length(), 1e-8);
+        }
+    }
+
+    // Aberration moves stars toward the velocity, by up to |v|/c
+    Query.et = 0.;
+    Query.Velocity = FVector3d(0., 29.8, 0.);
+    Catalog.Apparent(Selection, All, Query);
+    double Largest = 0.;
+    for (int32 k = 0; k < Selection.Num(); ++k)
+    {
+        const FStar& Star = Catalog.Stars[Selection.Stars[k]];
+        const FVector3d p = Direction(Star.RA - Star.RaProperMotion * Star.RaEpoch / JulianYear, Star.Dec - Star.DecProperMotion * Star.DecEpoch / JulianYear);
+        const double Shift = atan2((p ^ Selection.Direction(k)).Length(), p | Selection.Direction(k));
+        Largest = FMath::Max(Largest, Shift);
+        EXPECT_LE(Shift, asin(29.8 / SpeedOfLight) + 1e-12);
+        EXPECT_GE(Selection.Y[k] - p.Y, -1e-15);
+    }
+    EXPECT_GT(Largest, .99 * 29.8 / SpeedOfLight);
+}
+
+
+TEST(star_catalog_test, Instances) {
+
+    TArray<FStar> Stars = RandomStars(100, 0.);
+    Stars[0].Magnitude = -1.;
+    FCStringAnsi::Strncpy(Stars[0].SpectralType, "G2V", UE_ARRAY_COUNT(Stars[0].SpectralType));
+    Stars[1].Magnitude = -1.;
+    FCStringAnsi::Strncpy(Stars[1].SpectralType, "X", UE_ARRAY_COUNT(Stars[1].SpectralType));
+
+    FStarCatalog Catalog;
+    Catalog.Build(Stars);
+
+    FStarSelection Selection;
+    Catalog.Cone(Selection, FVector3d(0., 0., 1.), PI, FStarQuery());
+    ASSERT_EQ(Selection.Num(), Stars.FilterByPredicate([](const FStar& Star) { return Star.Magnitude <= 6.5; }).Num());
+
+    TArray<FVector4f> Instances;
+    TArray<FLinearColor> Colors;
+    Catalog.ToInstances(Selection, Instances, &Colors);
+    ASSERT_EQ(Instances.Num(), Selection.Num());
+    ASSERT_EQ(Colors.Num(), Selection.Num());
+
+    for (int32 k = 0; k < Selection.Num(); ++k)
+    {
+        EXPECT_NEAR(Instances[k].X, Selection.X[k], 1e-6);
+        EXPECT_NEAR(Instances[k].Y, Selection.Y[k], 1e-6);
+        EXPECT_NEAR(Instances[k].Z, Selection.Z[k], 1e-6);
+        EXPECT_EQ(Instances[k].W, Selection.Magnitude[k]);
+
+        const FStar& Star = Catalog.Stars[Selection.Stars[k]];
+        if (Star.CatalogNumber == Stars[1].CatalogNumber)
+        {
+            EXPECT_EQ(Colors[k], FLinearColor::White);
+        }
+        else if (Star.SpectralType[0] == 'B')
+        {
+            EXPECT_GT(Colors[k].B, Colors[k].R);
+        }
+        else if (Star.SpectralType[0] == 'M')
+        {
+            EXPECT_GT(Colors[k].R, Colors[k].B);
+        }
+    }
+}
+
+
+TEST(star_catalog_test, Invalid_Inputs) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    const std::string File = TestFilePath("star_catalog_invalid.bdb");
+
+    EXPECT_FALSE(WriteCatalog(File.c_str(), TEXT("STARS"), TArray<FStar>(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // Not a star catalog
+    TArray<FStar> Stars;
+    EXPECT_FALSE(LoadCatalog(Stars, TestFilePath("maxq_unit_test_spk.bsp").c_str(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_EQ(Stars.Num(), 0);
+
+    // Empty catalogs find nothing
+    FStarCatalog Catalog;
+    Catalog.Build(Stars);
+    FStarSelection Selection;
+    Catalog.Cone(Selection, FVector3d(1., 0., 0.), 1., FStarQuery());
+    EXPECT_EQ(Selection.Num(), 0);
+    Catalog.Cone(Selection, FVector3d::ZeroVector, 1., FStarQuery());
+    EXPECT_EQ(Selection.Num(), 0);
+}
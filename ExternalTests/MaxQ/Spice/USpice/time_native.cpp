@@ -0,0 +1,260 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "SpiceTime.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Expected values come from str2et_c/et2utc_c, with maxq_unit_test_lsk.tls
+// loaded.  Its one leap second is at the end of 2021, with TDB = TAI + 10s.
+namespace
+{
+    struct FParseCase
+    {
+        const TCHAR* str;
+        double et;
+    };
+
+    const FParseCase ParseCases[] {
+        { TEXT("2000-01-01T12:00:00"), 59 },
+        { TEXT("2021-12-31T23:59:60.5"), 694267259.5 },
+        { TEXT("2021-12-31T23:59:59.9996"), 694267258.99960005 },
+        { TEXT("1972-01-01T00:00:00"), -883655941 },
+        { TEXT("1980-02-29T06:07:08.25"), -626075512.75 },
+        { TEXT("2096-366T23:59:59.999"), 3061108859.9990001 },
+        { TEXT("1583-01-01"), -13159281541 },
+        { TEXT("2021-06-01 12:34"), 675822899 },
+        { TEXT("2022-01-01T00:00:00Z"), 694267260 },
+    };
+
+    struct FFormatCase
+    {
+        double et;
+        ES_UTCTimeFormat format;
+        int prec;
+        const TCHAR* utc;
+    };
+
+    const FFormatCase FormatCases[] {
+        { 694267259.5, ES_UTCTimeFormat::ISOCalendar, 3, TEXT("2021-12-31T23:59:60.500") },
+        // Rounds out of the leap second, into the next day
+        { 694267259.5, ES_UTCTimeFormat::Calendar, 0, TEXT("2022 JAN 01 00:00:00") },
+        { 694267258.99960005, ES_UTCTimeFormat::ISOCalendar, 3, TEXT("2021-12-31T23:59:60.000") },
+        { 694267258.99960005, ES_UTCTimeFormat::ISODayOfYear, 4, TEXT("2021-365T23:59:59.9996") },
+        { -626075512.75, ES_UTCTimeFormat::DayOfYear, 6, TEXT("1980-060 // 06:07:08.250000") },
+        { -883655941, ES_UTCTimeFormat::Calendar, 13, TEXT("1972 JAN 01 00:00:00.0000000000000") },
+        { 59, ES_UTCTimeFormat::ISOCalendar, 0, TEXT("2000-01-01T12:00:00") },
+    };
+
+    void LoadTestKernels()
+    {
+        USpice::init_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    }
+}
+
+
+TEST(time_native_test, Str2Et_Matches_CSPICE) {
+
+    LoadTestKernels();
+    ASSERT_TRUE(MaxQ::Time::HasConstants());
+
+    for (const FParseCase& Case : ParseCases)
+    {
+        FSEphemerisTime et;
+        ASSERT_TRUE(MaxQ::Time::TryStr2Et(Case.str, et)) << TCHAR_TO_ANSI(Case.str);
+        EXPECT_EQ(et.seconds, Case.et) << TCHAR_TO_ANSI(Case.str);
+    }
+}
+
+TEST(time_native_test, Et2Utc_Matches_CSPICE) {
+
+    LoadTestKernels();
+
+    for (const FFormatCase& Case : FormatCases)
+    {
+        FString utcstr;
+        ASSERT_TRUE(MaxQ::Time::TryEt2Utc(FSEphemerisTime(Case.et), Case.format, Case.prec, utcstr)) << TCHAR_TO_ANSI(Case.utc);
+        EXPECT_EQ(utcstr, Case.utc);
+    }
+}
+
+TEST(time_native_test, Round_Trips_Through_CSPICE) {
+
+    LoadTestKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    // The " UTC" suffix isn't handled natively, so USpice::str2et parses
+    // each native string with str2et_c.
+    for (double et = -8e8; et < 1e9; et += 7654321.123456)
+    {
+        FString utcstr;
+        ASSERT_TRUE(MaxQ::Time::TryEt2Utc(FSEphemerisTime(et), ES_UTCTimeFormat::ISOCalendar, 6, utcstr));
+
+        FSEphemerisTime Parsed;
+        EXPECT_FALSE(MaxQ::Time::TryStr2Et(utcstr + TEXT(" UTC"), Parsed));
+        USpice::str2et(ResultCode, ErrorMessage, Parsed, utcstr + TEXT(" UTC"));
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        EXPECT_NEAR(Parsed.seconds, et, 5e-7) << TCHAR_TO_ANSI(*utcstr);
+
+        FSEphemerisTime Native;
+        ASSERT_TRUE(MaxQ::Time::TryStr2Et(utcstr, Native));
+        EXPECT_EQ(Native.seconds, Parsed.seconds) << TCHAR_TO_ANSI(*utcstr);
+    }
+}
+
+TEST(time_native_test, Unsupported_Input_Falls_Back) {
+
+    LoadTestKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSEphemerisTime et;
+
+    // Not ISO, invalid, or a leap second on a day without one: CSPICE decides
+    const TCHAR* NotNative[] { TEXT("Jan 1 2020"), TEXT("2020-01-01 TDB"), TEXT("2020-02-30"), TEXT("2019-366"), TEXT("2020-01-01T24:00:00"), TEXT("2020-12-31T23:59:60"), TEXT("2020-01-01T"), TEXT("1066-10-14") };
+    for (const TCHAR* str : NotNative)
+    {
+        EXPECT_FALSE(MaxQ::Time::TryStr2Et(str, et)) << TCHAR_TO_ANSI(str);
+    }
+
+    USpice::str2et(ResultCode, ErrorMessage, et, TEXT("Jan 1 2000 12:00:00"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(et.seconds, 59.);
+
+    USpice::str2et(ResultCode, ErrorMessage, et, TEXT("2020-02-30"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // Julian dates are left to et2utc_c
+    FString utcstr;
+    EXPECT_FALSE(MaxQ::Time::TryEt2Utc(FSEphemerisTime(59.), ES_UTCTimeFormat::JulianDate, 3, utcstr));
+    USpice::et2utc(ResultCode, ErrorMessage, FSEphemerisTime(59.), ES_UTCTimeFormat::JulianDate, utcstr, 3);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(utcstr, TEXT("JD 2451545.000"));
+}
+
+TEST(time_native_test, No_Leapseconds_Kernel) {
+
+    USpice::init_all();
+    EXPECT_FALSE(MaxQ::Time::HasConstants());
+
+    FSEphemerisTime et;
+    EXPECT_FALSE(MaxQ::Time::TryStr2Et(TEXT("2000-01-01T12:00:00"), et));
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    USpice::str2et(ResultCode, ErrorMessage, et, TEXT("2000-01-01T12:00:00"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    LoadTestKernels();
+    EXPECT_TRUE(MaxQ::Time::HasConstants());
+}
+
+TEST(time_native_test, Now_Applies_Leapseconds) {
+
+    LoadTestKernels();
+
+    // The test LSK puts UTC 50s behind TAI, and TDB 10s ahead of TAI
+    const FDateTime Utc(2023, 3, 4, 5, 6, 7, 890);
+    FSEphemerisTime et;
+    ASSERT_TRUE(MaxQ::Time::TryUtc2Et(Utc, et));
+
+    FSEphemerisTime Expected;
+    ASSERT_TRUE(MaxQ::Time::TryStr2Et(TEXT("2023-03-04T05:06:07.890"), Expected));
+    EXPECT_NEAR(et.seconds, Expected.seconds, 1e-6);
+
+    const double Naive = (Utc - FDateTime::FromJulianDay(2451545.0)).GetTotalSeconds();
+    EXPECT_NEAR(et.seconds - Naive, 60., 1e-6);
+
+    EXPECT_NEAR(MaxQ::Time::Now().seconds, MaxQ::Data::Now().seconds, 1.);
+}
+
+TEST(time_native_test, Conversions_From_Worker_Threads) {
+
+    LoadTestKernels();
+
+    constexpr int Count = 2000;
+    TArray<FString> Expected;
+    for (int i = 0; i < Count; ++i)
+    {
+        FString utcstr;
+        MaxQ::Time::TryEt2Utc(FSEphemerisTime(i * 1234567.89), ES_UTCTimeFormat::ISOCalendar, 3, utcstr);
+        Expected.Add(utcstr);
+    }
+
+    std::atomic<int> Mismatches { 0 };
+    std::vector<std::thread> Threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        Threads.emplace_back([&]() {
+            for (int i = 0; i < Count; ++i)
+            {
+                FString utcstr;
+                FSEphemerisTime et;
+                if (!MaxQ::Time::TryEt2Utc(FSEphemerisTime(i * 1234567.89), ES_UTCTimeFormat::ISOCalendar, 3, utcstr)
+                    || utcstr != Expected[i]
+                    || !MaxQ::Time::TryStr2Et(utcstr, et))
+                {
+                    ++Mismatches;
+                }
+            }
+        });
+    }
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+
+    EXPECT_EQ(Mismatches.load(), 0);
+}
+
+TEST(time_native_test, Benchmark_Native_vs_CSPICE) {
+
+    LoadTestKernels();
+
+    constexpr int Iterations = 20000;
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FString utcstr;
+    FSEphemerisTime et;
+
+    // " UTC" and "J" route USpice::str2et & et2utc to CSPICE
+    double Start = FPlatformTime::Seconds();
+    for (int i = 0; i < Iterations; ++i)
+    {
+        USpice::str2et(ResultCode, ErrorMessage, et, TEXT("2021-06-01T12:34:56.789 UTC"));
+    }
+    const double CspiceParseSeconds = FPlatformTime::Seconds() - Start;
+
+    Start = FPlatformTime::Seconds();
+    for (int i = 0; i < Iterations; ++i)
+    {
+        MaxQ::Time::TryStr2Et(TEXT("2021-06-01T12:34:56.789"), et);
+    }
+    const double NativeParseSeconds = FPlatformTime::Seconds() - Start;
+
+    Start = FPlatformTime::Seconds();
+    for (int i = 0; i < Iterations; ++i)
+    {
+        USpice::et2utc(ResultCode, ErrorMessage, et, ES_UTCTimeFormat::JulianDate, utcstr, 6);
+    }
+    const double CspiceFormatSeconds = FPlatformTime::Seconds() - Start;
+
+    Start = FPlatformTime::Seconds();
+    for (int i = 0; i < Iterations; ++i)
+    {
+        MaxQ::Time::TryEt2Utc(et, ES_UTCTimeFormat::ISOCalendar, 6, utcstr);
+    }
+    const double NativeFormatSeconds = FPlatformTime::Seconds() - Start;
+
+    printf("[ BENCHMARK] str2et: CSPICE %.1f ns, native %.1f ns\n", 1e9 * CspiceParseSeconds / Iterations, 1e9 * NativeParseSeconds / Iterations);
+    printf("[ BENCHMARK] et2utc: CSPICE %.1f ns, native %.1f ns\n", 1e9 * CspiceFormatSeconds / Iterations, 1e9 * NativeFormatSeconds / Iterations);
+}
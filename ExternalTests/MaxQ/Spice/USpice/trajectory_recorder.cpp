@@ -0,0 +1,227 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceTrajectoryRecorder.h"
+#include "SpiceEphemeris.h"
+#include <cstdio>
+#include <filesystem>
+
+using MaxQ::Recording::FTrajectoryWriter;
+using MaxQ::Recording::FTrajectoryWriterSettings;
+using MaxQ::Recording::FTrajectoryWriterStats;
+
+namespace
+{
+    const FName Recorded(TEXT("-999101"));
+    const FName Center(TEXT("FAKEBODY9994"));
+    const FName Frame(TEXT("J2000"));
+
+    // A circular orbit, 500km out, once an hour
+    constexpr double Radius = 500.;
+    constexpr double Rate = 2. * PI / 3600.;
+
+    void LoadKernels()
+    {
+        USpice::init_all();
+        USpice::clear_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    }
+
+    FSStateVector Orbit(double t)
+    {
+        const double c = cos(Rate * t), s = sin(Rate * t);
+        return FSStateVector(FSDistanceVector(Radius * c, Radius * s, 0.), FSVelocityVector(-Radius * Rate * s, Radius * Rate * c, 0.));
+    }
+
+    FTrajectoryWriterSettings Settings(const char* File, ES_SPKRecordingType Type = ES_SPKRecordingType::Hermite13)
+    {
+        FTrajectoryWriterSettings Settings;
+        Settings.File = TestFilePath(File).c_str();
+        Settings.Body = -999101;
+        Settings.Center = 9994;
+        Settings.Frame = Frame;
+        Settings.SegmentType = Type;
+        Settings.MaxSegmentSamples = 100;
+        return Settings;
+    }
+
+    void RecordOrbit(ES_SPKRecordingType Type, const char* File)
+    {
+        LoadKernels();
+
+        const FTrajectoryWriterSettings WriterSettings = Settings(File, Type);
+        std::remove(TCHAR_TO_ANSI(*WriterSettings.File));
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        TSharedPtr<FTrajectoryWriter> Writer = FTrajectoryWriter::Open(WriterSettings, &ResultCode, &ErrorMessage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        // 10s steps, jittered so the steps are unequal
+        constexpr int32 N = 1000;
+        double t = 0.;
+        for (int32 i = 0; i < N; ++i)
+        {
+            EXPECT_TRUE(Writer->Push(et0 + FSEphemerisPeriod(t), Orbit(t)));
+            t += 10. + 2. * ((i * 7) % 5 - 2) / 4.;
+        }
+        const double Duration = t - 10.;
+
+        Writer->Close(&ResultCode, &ErrorMessage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        const FTrajectoryWriterStats Stats = Writer->GetStats();
+        EXPECT_EQ(Stats.Samples, N);
+        EXPECT_EQ(Stats.Dropped, 0);
+        EXPECT_EQ(Stats.Skipped, 0);
+        EXPECT_GE(Stats.Segments, 10);
+
+        USpice::furnsh_absolute(TCHAR_TO_ANSI(*WriterSettings.File));
+
+        // Between samples, and across segment boundaries
+        double MaxError = 0.;
+        for (double Probe = 3.; Probe < Duration; Probe += 37.)
+        {
+            const FSStateVector State = MaxQ::Ephemeris::Spkezr(et0 + FSEphemerisPeriod(Probe), Recorded, Center, Frame, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+            const FSStateVector Expected = Orbit(Probe);
+            MaxError = FMath::Max(MaxError, FMath::Abs(State.r.x.km - Expected.r.x.km));
+            MaxError = FMath::Max(MaxError, FMath::Abs(State.r.y.km - Expected.r.y.km));
+            MaxError = FMath::Max(MaxError, FMath::Abs(State.r.z.km - Expected.r.z.km));
+        }
+        EXPECT_LT(MaxError, 1e-5);
+    }
+}
+
+
+TEST(trajectory_recorder_test, Hermite_Segments_Reproduce_Trajectory) {
+
+    RecordOrbit(ES_SPKRecordingType::Hermite13, "trajectory_recorder_hermite.bsp");
+}
+
+
+TEST(trajectory_recorder_test, Lagrange_Segments_Reproduce_Trajectory) {
+
+    RecordOrbit(ES_SPKRecordingType::Lagrange9, "trajectory_recorder_lagrange.bsp");
+}
+
+
+TEST(trajectory_recorder_test, Repeated_And_Backwards_Ets) {
+
+    LoadKernels();
+
+    const FTrajectoryWriterSettings WriterSettings = Settings("trajectory_recorder_discontinuous.bsp");
+    std::remove(TCHAR_TO_ANSI(*WriterSettings.File));
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TSharedPtr<FTrajectoryWriter> Writer = FTrajectoryWriter::Open(WriterSettings, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // Every ET twice (a paused clock), then a jump back in time
+    for (int32 i = 0; i < 50; ++i)
+    {
+        Writer->Push(et0 + FSEphemerisPeriod(10. * i), Orbit(10. * i));
+        Writer->Push(et0 + FSEphemerisPeriod(10. * i), Orbit(10. * i));
+    }
+    for (int32 i = 0; i < 50; ++i)
+    {
+        const double t = -3600. + 10. * i;
+        Writer->Push(et0 + FSEphemerisPeriod(t), Orbit(t));
+    }
+
+    Writer->Close(&ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    const FTrajectoryWriterStats Stats = Writer->GetStats();
+    EXPECT_EQ(Stats.Samples, 150);
+    EXPECT_EQ(Stats.Skipped, 50);
+    EXPECT_GE(Stats.Segments, 2);
+
+    USpice::furnsh_absolute(TCHAR_TO_ANSI(*WriterSettings.File));
+
+    for (double t : { 245., -3355. })
+    {
+        const FSDistanceVector Position = MaxQ::Ephemeris::Spkpos(et0 + FSEphemerisPeriod(t), Recorded, Center, Frame, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        EXPECT_NEAR(Position.x.km, Orbit(t).r.x.km, 1e-5);
+        EXPECT_NEAR(Position.y.km, Orbit(t).r.y.km, 1e-5);
+    }
+
+    // Neither run covers the time between them
+    MaxQ::Ephemeris::Spkpos(et0 + FSEphemerisPeriod(-1800.), Recorded, Center, Frame, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+
+TEST(trajectory_recorder_test, Full_Ring_Drops_Samples) {
+
+    LoadKernels();
+
+    FTrajectoryWriterSettings WriterSettings = Settings("trajectory_recorder_dropped.bsp");
+    WriterSettings.BufferCapacity = 16;
+    std::remove(TCHAR_TO_ANSI(*WriterSettings.File));
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TSharedPtr<FTrajectoryWriter> Writer = FTrajectoryWriter::Open(WriterSettings, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    constexpr int32 N = 100000;
+    int64 Accepted = 0;
+    for (int32 i = 0; i < N; ++i)
+    {
+        Accepted += Writer->Push(et0 + FSEphemerisPeriod((double)i), Orbit(i));
+    }
+
+    Writer->Close(&ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // The ring never grows:  whatever the sealer couldn't keep up with is counted
+    const FTrajectoryWriterStats Stats = Writer->GetStats();
+    EXPECT_EQ(Stats.Samples, Accepted);
+    EXPECT_EQ(Stats.Samples + Stats.Dropped, N);
+    EXPECT_FALSE(Writer->IsOpen());
+    EXPECT_FALSE(Writer->Push(et0, Orbit(0.)));
+}
+
+
+TEST(trajectory_recorder_test, Bad_Inputs) {
+
+    LoadKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    FTrajectoryWriterSettings WriterSettings = Settings("trajectory_recorder_bad.bsp");
+    WriterSettings.Frame = FName(TEXT("NOT_A_FRAME"));
+    EXPECT_FALSE(FTrajectoryWriter::Open(WriterSettings, &ResultCode, &ErrorMessage).IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    WriterSettings = Settings("trajectory_recorder_bad.bsp");
+    WriterSettings.Center = WriterSettings.Body;
+    EXPECT_FALSE(FTrajectoryWriter::Open(WriterSettings, &ResultCode, &ErrorMessage).IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    WriterSettings = Settings("trajectory_recorder_bad.bsp");
+    WriterSettings.BufferCapacity = 1;
+    EXPECT_FALSE(FTrajectoryWriter::Open(WriterSettings, &ResultCode, &ErrorMessage).IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // Nothing pushed, nothing written
+    WriterSettings = Settings("trajectory_recorder_bad.bsp");
+    std::remove(TCHAR_TO_ANSI(*WriterSettings.File));
+    TSharedPtr<FTrajectoryWriter> Writer = FTrajectoryWriter::Open(WriterSettings, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    Writer->Close(&ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Writer->GetStats().Segments, 0);
+    EXPECT_FALSE(std::filesystem::exists(TCHAR_TO_ANSI(*WriterSettings.File)));
+}
@@ -0,0 +1,148 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+
+
+TEST(FSStateVectorBufferTest, DefaultConstruction_Is_Empty) {
+    FSStateVectorBuffer buffer;
+
+    EXPECT_EQ(buffer.Num(), 0);
+}
+
+TEST(FSStateVectorBufferTest, CountConstruction_Is_Zeroed) {
+    FSStateVectorBuffer buffer(3);
+
+    EXPECT_EQ(buffer.Num(), 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_DOUBLE_EQ(buffer.x[i], 0.);
+        EXPECT_DOUBLE_EQ(buffer.y[i], 0.);
+        EXPECT_DOUBLE_EQ(buffer.z[i], 0.);
+        EXPECT_DOUBLE_EQ(buffer.dx[i], 0.);
+        EXPECT_DOUBLE_EQ(buffer.dy[i], 0.);
+        EXPECT_DOUBLE_EQ(buffer.dz[i], 0.);
+    }
+}
+
+TEST(FSStateVectorBufferTest, ArrayRoundTrip_Is_Identical) {
+
+    TArray<FSStateVector> states;
+    states.Add(FSStateVector(FSDistanceVector(1.2, -2.3, 3.4), FSVelocityVector(4.5, 5.6, -6.7)));
+    states.Add(FSStateVector(FSDistanceVector(-7.8, 8.9, 9.1), FSVelocityVector(-0.1, 0.2, 0.3)));
+
+    FSStateVectorBuffer buffer(states);
+    TArray<FSStateVector> roundTrip;
+    buffer.CopyTo(roundTrip);
+
+    ASSERT_EQ(roundTrip.Num(), 2);
+    EXPECT_DOUBLE_EQ(buffer.x[1], -7.8);
+    EXPECT_DOUBLE_EQ(buffer.dz[0], -6.7);
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_DOUBLE_EQ(roundTrip[i].r.x.km, states[i].r.x.km);
+        EXPECT_DOUBLE_EQ(roundTrip[i].r.y.km, states[i].r.y.km);
+        EXPECT_DOUBLE_EQ(roundTrip[i].r.z.km, states[i].r.z.km);
+        EXPECT_DOUBLE_EQ(roundTrip[i].v.dx.kmps, states[i].v.dx.kmps);
+        EXPECT_DOUBLE_EQ(roundTrip[i].v.dy.kmps, states[i].v.dy.kmps);
+        EXPECT_DOUBLE_EQ(roundTrip[i].v.dz.kmps, states[i].v.dz.kmps);
+    }
+}
+
+TEST(FSStateVectorBufferTest, Components_Are_Aligned) {
+    FSStateVectorBuffer buffer(5);
+
+    EXPECT_EQ(reinterpret_cast<UPTRINT>(buffer.x.GetData()) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<UPTRINT>(buffer.dz.GetData()) % 64, 0u);
+}
+
+TEST(FSStateVectorBufferTest, GatherScatter_Is_SpiceLayout) {
+    FSStateVectorBuffer buffer(4);
+    buffer.Set(2, FSStateVector(FSDistanceVector(1., 2., 3.), FSVelocityVector(4., 5., 6.)));
+
+    double states[2][6];
+    buffer.Gather(2, 2, states);
+
+    EXPECT_DOUBLE_EQ(states[0][0], 1.);
+    EXPECT_DOUBLE_EQ(states[0][5], 6.);
+    EXPECT_DOUBLE_EQ(states[1][0], 0.);
+
+    states[1][3] = -9.;
+    buffer.Scatter(2, 2, states);
+    EXPECT_DOUBLE_EQ(buffer.dx[3], -9.);
+}
+
+TEST(FSStateVectorBufferTest, MxV_Matches_ScalarMxV) {
+
+    FSStateVector state(FSDistanceVector(1.2, -2.3, 3.4), FSVelocityVector(4.5, 5.6, -6.7));
+    FSRotationMatrix m(FSDimensionlessVector(0., 1., 0.), FSDimensionlessVector(-1., 0., 0.), FSDimensionlessVector(0., 0., 1.));
+
+    FSStateVectorBuffer buffer;
+    buffer.Add(state);
+    buffer.Add(state);
+
+    MaxQ::Math::MxV(buffer, m, buffer);
+
+    FSDistanceVector r = MaxQ::Math::MxV(m, state.r);
+    FSVelocityVector v = MaxQ::Math::MxV(m, state.v);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_DOUBLE_EQ(buffer.x[i], r.x.km);
+        EXPECT_DOUBLE_EQ(buffer.y[i], r.y.km);
+        EXPECT_DOUBLE_EQ(buffer.z[i], r.z.km);
+        EXPECT_DOUBLE_EQ(buffer.dx[i], v.dx.kmps);
+        EXPECT_DOUBLE_EQ(buffer.dy[i], v.dy.kmps);
+        EXPECT_DOUBLE_EQ(buffer.dz[i], v.dz.kmps);
+    }
+}
+
+TEST(FSStateVectorBufferTest, Prop2b_Matches_USpiceProp2b) {
+
+    USpice::init_all();
+
+    FSMassConstant gm(398600.4418);
+    FSStateVector pvinit(FSDistanceVector(7000., 0., 0.), FSVelocityVector(0., 7.546, 0.));
+    FSEphemerisPeriod dt(600.);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSStateVector expected;
+    USpice::prop2b(ResultCode, ErrorMessage, gm, pvinit, dt, expected);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FSStateVectorBuffer buffer;
+    buffer.Add(pvinit);
+    FSStateVectorBuffer propagated;
+    MaxQ::Math::Prop2b(propagated, gm, buffer, dt, &ResultCode, &ErrorMessage);
+
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_EQ(propagated.Num(), 1);
+    EXPECT_TRUE(IsNear(propagated.Get(0), expected, 1e-9, 1e-12));
+}
+
+TEST(FSStateVectorBufferTest, Prop2b_Failure_Zeroes_Output) {
+
+    USpice::init_all();
+
+    FSStateVector pvinit(FSDistanceVector(7000., 0., 0.), FSVelocityVector(0., 7.546, 0.));
+
+    FSStateVectorBuffer buffer;
+    buffer.Add(pvinit);
+    buffer.Add(pvinit);
+
+    // prop2b signals an error for a non-positive gm
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    MaxQ::Math::Prop2b(buffer, FSMassConstant(-1.), buffer, FSEphemerisPeriod(600.), &ResultCode, &ErrorMessage);
+
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    ASSERT_EQ(buffer.Num(), 2);
+    EXPECT_EQ(buffer.Get(0), FSStateVector());
+    EXPECT_EQ(buffer.Get(1), FSStateVector());
+}
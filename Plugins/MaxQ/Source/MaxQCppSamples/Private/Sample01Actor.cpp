@@ -419,11 +419,10 @@ void ASample01Actor::DumpKernelDiagnostics()
     FString LSKKernelPath = TEXT("NonAssetData/naif/kernels/Generic/LSK/naif0012.tls");
     FString SPKKernelPath = TEXT("NonAssetData/naif/kernels/Generic/SPK/planets/de440s.bsp");
  
-    USpiceDiagnostics::DumpSpkSummary(
+    USpiceDiagnostics::DumpSpkCoverage(
         ResultCode,
         ErrorMessage,
         LogString1,
-        MaxQSamples::MaxQPathAbsolutified(LSKKernelPath),
         MaxQSamples::MaxQPathAbsolutified(SPKKernelPath)
     );
 
@@ -442,11 +441,10 @@ void ASample01Actor::DumpKernelDiagnostics()
     FString BinaryPCKKernelPath = TEXT("NonAssetData/naif/kernels/Generic/PCK/earth_200101_990628_predict.bpc");
     FString LogString2;
 
-    USpiceDiagnostics::DumpPckSummary(
+    USpiceDiagnostics::DumpPckCoverage(
         ResultCode,
         ErrorMessage,
         LogString2,
-        MaxQSamples::MaxQPathAbsolutified(LSKKernelPath),
         MaxQSamples::MaxQPathAbsolutified(BinaryPCKKernelPath)
     );
 
@@ -467,12 +465,15 @@ void ASample01Actor::DumpKernelDiagnostics()
     FString BinaryCKKernelPath = TEXT("NonAssetData/naif/kernels/INSIGHT/CK/insight_ida_pot_210801_211218_v1.bc");
     FString LogString3;
 
-    USpiceDiagnostics::DumpCkSummary(
+    // CK coverage is in spacecraft clock ticks.  With the clock's SCLK and
+    // an LSK loaded, it's listed as TDB too.
+    Furnsh(MaxQSamples::MaxQPathAbsolutified(LSKKernelPath));
+    Furnsh(MaxQSamples::MaxQPathAbsolutified(BinarySCLKKernelPath));
+
+    USpiceDiagnostics::DumpCkCoverage(
         ResultCode,
         ErrorMessage,
         LogString3,
-        MaxQSamples::MaxQPathAbsolutified(LSKKernelPath),
-        MaxQSamples::MaxQPathAbsolutified(BinarySCLKKernelPath),
         MaxQSamples::MaxQPathAbsolutified(BinaryCKKernelPath)
     );
 
@@ -508,7 +508,7 @@ void ASample03Actor::InitializeSolarSystem(FSamplesSolarSystemState& State)
     USpice::furnsh(ResultCode, ErrorMessage, AbsPathToOuterPlanetSPKFixups);
     Log(FString::Printf(TEXT("InitializeSolarSystem loaded kernel file %s"), *AbsPathToOuterPlanetSPKFixups), ResultCode);
 
-    USampleUtilities::InitializeTime(State);
+    USampleUtilities::InitializeTime(this, State);
 
     AActor* Actor = nullptr;
     FString ActorName;
@@ -558,7 +558,8 @@ void ASample03Actor::InitializeSolarSystem(FSamplesSolarSystemState& State)
 
 void ASample03Actor::UpdateSolarSystem(FSamplesSolarSystemState& State, float DeltaTime)
 {
-    SolarSystemState.CurrentTime += DeltaTime * SolarSystemState.TimeScale;
+    UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this);
+    if (!Clock) return;
 
     // Intermediate outputs:
     // r: sun's position relative to earth
@@ -570,7 +571,7 @@ void ASample03Actor::UpdateSolarSystem(FSamplesSolarSystemState& State, float De
     FString ErrorMessage;
 
     // When do we want it?   (time: now)
-    FSEphemerisTime et = SolarSystemState.CurrentTime;
+    FSEphemerisTime et = Clock->GetEphemerisTime();
 
     // Where do we want it relative to?
     // SSB = Solar System Barycenter, the point the sun and planets mutually orbit
@@ -630,7 +631,7 @@ void ASample03Actor::UpdateSolarSystem(FSamplesSolarSystemState& State, float De
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale SUN : 1/%s (1/100 of PLANET/MOON scale)"), *USpiceTypes::FormatDoublePrecisely(BodyScale * UE_Units_Per_KM * 100, 0)));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale PLANETS/MOON : 1/%s"), *USpiceTypes::FormatDoublePrecisely(BodyScale * UE_Units_Per_KM, 0)));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale Solar System Distances : 1/%s"), *USpiceTypes::FormatDoublePrecisely(DistanceScale * UE_Units_Per_KM, 0)));
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *SolarSystemState.CurrentTime.ToString()));
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *Clock->GetEphemerisTime().ToString()));
     }
 }
 
@@ -648,26 +649,26 @@ void ASample03Actor::VeryFastSpeed()
 
 void ASample03Actor::FasterSpeed()
 {
-    SolarSystemState.TimeScale *= 10.;
+    MaxQSamples::ScaleTimeWarp(this, 10.);
 }
 
 void ASample03Actor::SlowerSpeed()
 {
-    SolarSystemState.TimeScale *= 0.1;
+    MaxQSamples::ScaleTimeWarp(this, 0.1);
 }
 
 void ASample03Actor::NormalSpeed()
 {
-    SolarSystemState.TimeScale = 1;
+    MaxQSamples::ResetTimeWarp(this);
 }
 
 void ASample03Actor::GoToNow()
 {
-    USpice::et_now(SolarSystemState.CurrentTime);
+    MaxQSamples::GoToNow(this);
     NormalSpeed();
 }
 
 void ASample03Actor::Restart()
 {
-    USampleUtilities::InitializeTime(SolarSystemState, false);
+    USampleUtilities::InitializeTime(this, SolarSystemState, false);
 }
\ No newline at end of file
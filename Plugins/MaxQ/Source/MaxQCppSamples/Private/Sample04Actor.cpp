@@ -96,7 +96,7 @@ void ASample04Actor::Tick(float DeltaTime)
     Super::Tick(DeltaTime);
 
     UpdateSolarSystem(DeltaTime);
-    GetUERotationAndAngularVelocity(SolarSystemState.CurrentTime, OriginReferenceFrame, Name_EARTH, true);
+    GetUERotationAndAngularVelocity(MaxQSamples::ClockTime(this), OriginReferenceFrame, Name_EARTH, true);
 }
 
 
@@ -411,7 +411,7 @@ void ASample04Actor::GetUERotationAndAngularVelocity(const FSEphemerisTime& et,
 
 void ASample04Actor::InitializeSolarSystem()
 {
-    USampleUtilities::InitializeTime(SolarSystemState);
+    USampleUtilities::InitializeTime(this, SolarSystemState);
     MaxQSamples::InitBodyScales(BodyScale, SolarSystemState);
 }
 
@@ -426,11 +426,12 @@ void ASample04Actor::InitializeSolarSystem()
 
 void ASample04Actor::UpdateSolarSystem(float DeltaTime)
 {
-    SolarSystemState.CurrentTime += DeltaTime * SolarSystemState.TimeScale;
+    UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this);
+    if (!Clock) return;
 
     bool success = true;
-    success &= MaxQSamples::UpdateSunDirection(OriginNaifName, OriginReferenceFrame, SolarSystemState.CurrentTime, SunNaifName, SunDirectionalLight);
-    success &= MaxQSamples::UpdateBodyPositions(OriginNaifName, OriginReferenceFrame, DistanceScale, SolarSystemState);
+    success &= MaxQSamples::UpdateSunDirection(OriginNaifName, OriginReferenceFrame, *Clock, SunNaifName, SunDirectionalLight);
+    success &= MaxQSamples::UpdateBodyPositions(OriginNaifName, OriginReferenceFrame, DistanceScale, SolarSystemState, *Clock);
     success &= UpdateBodyOrientations();
 
     if (!success)
@@ -442,10 +443,10 @@ void ASample04Actor::UpdateSolarSystem(float DeltaTime)
     if (GEngine)
     {
         double UE_Units_Per_KM = 100 * 1000.;
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Time Scale: %f x"), SolarSystemState.TimeScale.AsSeconds()));
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Time Scale: %f x"), Clock->GetTimeScale()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale PLANETS/MOON : 1/%d"), (int)(BodyScale * UE_Units_Per_KM)));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale Solar System Distances : 1/%d"), (int)(DistanceScale * UE_Units_Per_KM)));
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *SolarSystemState.CurrentTime.ToString()));
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *Clock->GetEphemerisTime().ToString()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Origin Reference Frame: %s"), *OriginReferenceFrame.ToString()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Origin Observer Naif Name: %s"), *OriginNaifName.ToString()));
     }
@@ -467,7 +468,7 @@ bool ASample04Actor::UpdateBodyOrientations()
     FString ErrorMessage;
 
     // When do we want it?   (time: now)
-    FSEphemerisTime et = SolarSystemState.CurrentTime;
+    FSEphemerisTime et = MaxQSamples::ClockTime(this);
 
     bool result = true;
     for (const auto& [BodyNaifName, BodyActor] : SolarSystemState.SolarSystemBodyMap)
@@ -531,26 +532,26 @@ void ASample04Actor::VeryFastSpeed()
 
 void ASample04Actor::FasterSpeed()
 {
-    SolarSystemState.TimeScale *= 10.;
+    MaxQSamples::ScaleTimeWarp(this, 10.);
 }
 
 void ASample04Actor::SlowerSpeed()
 {
-    SolarSystemState.TimeScale *= 0.1;
+    MaxQSamples::ScaleTimeWarp(this, 0.1);
 }
 
 void ASample04Actor::NormalSpeed()
 {
-    SolarSystemState.TimeScale = 1;
+    MaxQSamples::ResetTimeWarp(this);
 }
 
 void ASample04Actor::GoToNow()
 {
-    USpice::et_now(SolarSystemState.CurrentTime);
+    MaxQSamples::GoToNow(this);
     NormalSpeed();
 }
 
 void ASample04Actor::Restart()
 {
-    USampleUtilities::InitializeTime(SolarSystemState, false);
+    USampleUtilities::InitializeTime(this, SolarSystemState, false);
 }
\ No newline at end of file
@@ -90,17 +90,18 @@ void ASample05Actor::Tick(float DeltaSeconds)
 {
     Super::Tick(DeltaSeconds);
 
-    SolarSystemState.CurrentTime += DeltaSeconds * SolarSystemState.TimeScale;
+    UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this);
+    if (!Clock) return;
 
     bool success = true;
-    success &= MaxQSamples::UpdateBodyPositions(OriginNaifName, OriginReferenceFrame, DistanceScale, SolarSystemState);
-    success &= MaxQSamples::UpdateBodyOrientations(OriginReferenceFrame, SolarSystemState);
-    success &= MaxQSamples::UpdateSunDirection(OriginNaifName, OriginReferenceFrame, SolarSystemState.CurrentTime, SunNaifName, SunDirectionalLight);
+    success &= MaxQSamples::UpdateBodyPositions(OriginNaifName, OriginReferenceFrame, DistanceScale, SolarSystemState, *Clock);
+    success &= MaxQSamples::UpdateBodyOrientations(OriginReferenceFrame, Clock->GetEphemerisTime(), SolarSystemState);
+    success &= MaxQSamples::UpdateSunDirection(OriginNaifName, OriginReferenceFrame, *Clock, SunNaifName, SunDirectionalLight);
 
     if (GEngine)
     {
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Time Scale: %f x"), SolarSystemState.TimeScale.AsSeconds()));
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *SolarSystemState.CurrentTime.ToString()));
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Time Scale: %f x"), Clock->GetTimeScale()));
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *Clock->GetEphemerisTime().ToString()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Origin Reference Frame: %s"), *OriginReferenceFrame.ToString()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Origin Observer Naif Name: %s"), *OriginNaifName.ToString()));
     }
@@ -309,7 +310,7 @@ void ASample05Actor::TLEs()
 
 void ASample05Actor::InitAnimation()
 {
-    USampleUtilities::InitializeTime(SolarSystemState);
+    USampleUtilities::InitializeTime(this, SolarSystemState);
     MaxQSamples::InitBodyScales(DistanceScale, SolarSystemState);
     USpice::getgeophs(EarthConstants, TEXT("EARTH"));
 }
@@ -469,7 +470,7 @@ bool ASample05Actor::PropagateTLE(const FSTwoLineElements& TLEs, FSStateVector&
     FString ErrorMessage;
 
     // Given "Two-Line" Elements, compute a state vector
-    USpice::evsgp4(ResultCode, ErrorMessage, StateVector, SolarSystemState.CurrentTime, EarthConstants, TLEs);
+    USpice::evsgp4(ResultCode, ErrorMessage, StateVector, MaxQSamples::ClockTime(this), EarthConstants, TLEs);
 
     return ResultCode == ES_ResultCode::Success;
 }
@@ -543,7 +544,7 @@ bool ASample05Actor::EvaluateOrbitalElements(const FSConicElements& KeplerianEle
     ES_ResultCode ResultCode;
     FString ErrorMessage;
 
-    USpice::conics(ResultCode, ErrorMessage, KeplerianElements, SolarSystemState.CurrentTime, StateVector);
+    USpice::conics(ResultCode, ErrorMessage, KeplerianElements, MaxQSamples::ClockTime(this), StateVector);
 
     return ResultCode == ES_ResultCode::Success;
 }
@@ -564,7 +565,7 @@ bool ASample05Actor::GetOrbitalElements(const FSStateVector& StateVector, FSConi
     FString ErrorMessage;
 
     // Given a state vector, compute the orbital elements
-    USpice::oscelt(ResultCode, ErrorMessage, StateVector, SolarSystemState.CurrentTime, gm, KeplerianElements);
+    USpice::oscelt(ResultCode, ErrorMessage, StateVector, MaxQSamples::ClockTime(this), gm, KeplerianElements);
 
     return ResultCode == ES_ResultCode::Success;
 }
@@ -580,7 +581,7 @@ bool ASample05Actor::GetOrbitalElements(const FSStateVector& StateVector, FSConi
 
 bool ASample05Actor::GetConicFromKepler(const FSConicElements& KeplerianElements, FSEllipse& OrbitalConic, bool& bIsHyperbolic)
 {
-    USpiceOrbits::ComputeConic(OrbitalConic, bIsHyperbolic, SolarSystemState.CurrentTime, KeplerianElements, J2000, OriginReferenceFrame.ToString());
+    USpiceOrbits::ComputeConic(OrbitalConic, bIsHyperbolic, MaxQSamples::ClockTime(this), KeplerianElements, J2000, OriginReferenceFrame.ToString());
     return true;
 }
 
@@ -597,26 +598,26 @@ void ASample05Actor::VeryFastSpeed()
 
 void ASample05Actor::FasterSpeed()
 {
-    SolarSystemState.TimeScale *= 10.;
+    MaxQSamples::ScaleTimeWarp(this, 10.);
 }
 
 void ASample05Actor::SlowerSpeed()
 {
-    SolarSystemState.TimeScale *= 0.1;
+    MaxQSamples::ScaleTimeWarp(this, 0.1);
 }
 
 void ASample05Actor::NormalSpeed()
 {
-    SolarSystemState.TimeScale = 1;
+    MaxQSamples::ResetTimeWarp(this);
 }
 
 void ASample05Actor::GoToNow()
 {
-    SolarSystemState.CurrentTime = Now();
+    MaxQSamples::GoToNow(this);
     NormalSpeed();
 }
 
 void ASample05Actor::Restart()
 {
-    USampleUtilities::InitializeTime(SolarSystemState, false);
+    USampleUtilities::InitializeTime(this, SolarSystemState, false);
 }
\ No newline at end of file
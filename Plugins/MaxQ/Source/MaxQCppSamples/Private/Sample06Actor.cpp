@@ -181,8 +181,12 @@ void ASample06Actor::BeginPlay()
                     // We found a segment!
                     // There was probably only one.
                     // Anyhoo, set the current solar system time to the SPK segment time.
-                    SolarSystemState.CurrentTime = FSEphemerisTime{ WindowSegment.start };
-                    SolarSystemState.InitialTime = SolarSystemState.CurrentTime.ToString();
+                    // InitializeSolarSystem already set the clock, so set it again.
+                    SolarSystemState.InitialTime = FSEphemerisTime{ WindowSegment.start }.ToString();
+                    if (UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this))
+                    {
+                        Clock->SetEphemerisTime(FSEphemerisTime{ WindowSegment.start });
+                    }
                     break;
                 }
             }
@@ -221,7 +225,7 @@ void ASample06Actor::Tick(float DeltaTime)
 
 void ASample06Actor::InitializeSolarSystem()
 {
-    USampleUtilities::InitializeTime(SolarSystemState);
+    USampleUtilities::InitializeTime(this, SolarSystemState);
     MaxQSamples::InitBodyScales(BodyScale, SolarSystemState);
 }
 
@@ -236,12 +240,13 @@ void ASample06Actor::InitializeSolarSystem()
 
 void ASample06Actor::UpdateSolarSystem(float DeltaTime)
 {
-    SolarSystemState.CurrentTime += DeltaTime * SolarSystemState.TimeScale;
+    UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this);
+    if (!Clock) return;
 
     bool success = true;
-    success &= MaxQSamples::UpdateSunDirection(OriginNaifName, OriginReferenceFrame, SolarSystemState.CurrentTime, SunNaifName, SunDirectionalLight);
-    success &= MaxQSamples::UpdateBodyPositions(OriginNaifName, OriginReferenceFrame, DistanceScale, SolarSystemState);
-    success &= MaxQSamples::UpdateBodyOrientations(OriginReferenceFrame, SolarSystemState);
+    success &= MaxQSamples::UpdateSunDirection(OriginNaifName, OriginReferenceFrame, *Clock, SunNaifName, SunDirectionalLight);
+    success &= MaxQSamples::UpdateBodyPositions(OriginNaifName, OriginReferenceFrame, DistanceScale, SolarSystemState, *Clock);
+    success &= MaxQSamples::UpdateBodyOrientations(OriginReferenceFrame, Clock->GetEphemerisTime(), SolarSystemState);
 
     if (!success)
     {
@@ -252,10 +257,10 @@ void ASample06Actor::UpdateSolarSystem(float DeltaTime)
     if (GEngine)
     {
         double UE_Units_Per_KM = 100 * 1000.;
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Time Scale: %f x"), SolarSystemState.TimeScale.AsSeconds()));
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Time Scale: %f x"), Clock->GetTimeScale()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale PLANETS/MOON : 1/%d"), (int)(BodyScale * UE_Units_Per_KM)));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale Solar System Distances : 1/%d"), (int)(DistanceScale * UE_Units_Per_KM)));
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *SolarSystemState.CurrentTime.ToString()));
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *Clock->GetEphemerisTime().ToString()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Origin Reference Frame: %s"), *OriginReferenceFrame.ToString()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Origin Observer Naif Name: %s"), *OriginNaifName.ToString()));
 
@@ -444,25 +449,25 @@ void ASample06Actor::VeryFastSpeed()
 
 void ASample06Actor::FasterSpeed()
 {
-    SolarSystemState.TimeScale *= 10.;
+    MaxQSamples::ScaleTimeWarp(this, 10.);
     GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Silver, TEXT("Faster"));
 }
 
 void ASample06Actor::SlowerSpeed()
 {
-    SolarSystemState.TimeScale *= 0.1;
+    MaxQSamples::ScaleTimeWarp(this, 0.1);
     GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Silver, TEXT("Slower"));
 }
 
 void ASample06Actor::NormalSpeed()
 {
-    SolarSystemState.TimeScale = 1;
+    MaxQSamples::ResetTimeWarp(this);
     GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Silver, TEXT("Normal Speed (1x)"));
 }
 
 void ASample06Actor::GoToNow()
 {
-    SolarSystemState.CurrentTime = Now();
+    MaxQSamples::GoToNow(this);
     GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Silver, TEXT("Set time to Now"));
     NormalSpeed();
 }
@@ -470,7 +475,7 @@ void ASample06Actor::GoToNow()
 void ASample06Actor::Restart()
 {
     GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Silver, TEXT("Restart Time"));
-    USampleUtilities::InitializeTime(SolarSystemState, false);
+    USampleUtilities::InitializeTime(this, SolarSystemState, false);
 }
 
 
@@ -129,6 +129,46 @@ namespace MaxQSamples
         return AbsolutePaths;
     }
 
+    //-----------------------------------------------------------------------------
+    // Name: ClockTime
+    // Desc:
+    // The world's simulation ET for this frame (UMaxQClockSubsystem).
+    //-----------------------------------------------------------------------------
+    FSEphemerisTime ClockTime(const UObject* WorldContextObject)
+    {
+        UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(WorldContextObject);
+        return Clock ? Clock->GetEphemerisTime() : Now();
+    }
+
+    //-----------------------------------------------------------------------------
+    // Name: ScaleTimeWarp, ResetTimeWarp, GoToNow
+    // Desc:
+    // Speed the world's clock up or down, back to real time, or jump it to now.
+    //-----------------------------------------------------------------------------
+    void ScaleTimeWarp(const UObject* WorldContextObject, double Factor)
+    {
+        if (UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(WorldContextObject))
+        {
+            Clock->SetTimeScale(Clock->GetTimeScale() * Factor);
+        }
+    }
+
+    void ResetTimeWarp(const UObject* WorldContextObject)
+    {
+        if (UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(WorldContextObject))
+        {
+            Clock->SetTimeScale(1.);
+        }
+    }
+
+    void GoToNow(const UObject* WorldContextObject)
+    {
+        if (UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(WorldContextObject))
+        {
+            Clock->SetEphemerisTimeToNow();
+        }
+    }
+
     //-----------------------------------------------------------------------------
     // Name: InitBodyScales
     // Desc:
@@ -190,16 +230,9 @@ namespace MaxQSamples
     // Generalized positioning of solar system bodies.
     // This keeps boilerplate scenario stuff out of the samples.
     //-----------------------------------------------------------------------------
-    bool UpdateBodyPositions(const FName& OriginNaifName, const FName& OriginReferenceFrame, float DistanceScale, const FSamplesSolarSystemState& SolarSystemState)
+    bool UpdateBodyPositions(const FName& OriginNaifName, const FName& OriginReferenceFrame, float DistanceScale, const FSamplesSolarSystemState& SolarSystemState, UMaxQClockSubsystem& Clock)
     {
-        FSDistanceVector r;
-        FSEphemerisPeriod lt;
-
-        ES_ResultCode ResultCode;
-        FString ErrorMessage;
-
-        // When do we want it?   (time: now)
-        FSEphemerisTime et = SolarSystemState.CurrentTime;
+        FSStateVector state;
 
         bool result = true;
         for (const auto& [BodyNaifName, BodyActor] : SolarSystemState.SolarSystemBodyMap)
@@ -209,12 +242,9 @@ namespace MaxQSamples
             if (Actor)
             {
                 // Targ = NaifName = Map Key
-                FString targ = BodyNaifName.ToString();
-
-                // Call SPICE, get the position in rectangular coordinates...
-                USpice::spkpos(ResultCode, ErrorMessage, et, r, lt, targ, OriginNaifName.ToString(), OriginReferenceFrame.ToString());
-
-                result &= (ResultCode == ES_ResultCode::Success);
+                // When do we want it?   (time: the clock's ET for this frame)
+                // The clock shares the result with anyone else asking this frame.
+                result &= Clock.GetFrameState(state, BodyNaifName, OriginNaifName, OriginReferenceFrame);
 
                 if (result)
                 {
@@ -222,7 +252,7 @@ namespace MaxQSamples
                     // Positional data (vectors, quaternions, should only be exchanged through USpiceTypes::Conf_*
                     // SPICE coordinate systems are Right-Handed, and Unreal Engine is Left-Handed.
                     // The USpiceTypes conversions understand this, and how to convert.
-                    FVector BodyLocation = r.Swizzle();
+                    FVector BodyLocation = state.r.Swizzle();
 
                     // Scale and set the body location
                     BodyLocation /= DistanceScale;
@@ -240,14 +270,11 @@ namespace MaxQSamples
     // Generalized orienatation updates of solar system bodies.
     // This keeps boilerplate scenario stuff out of the samples.
     //-----------------------------------------------------------------------------
-    bool UpdateBodyOrientations(const FName& OriginReferenceFrame, const FSamplesSolarSystemState& SolarSystemState)
+    bool UpdateBodyOrientations(const FName& OriginReferenceFrame, const FSEphemerisTime& et, const FSamplesSolarSystemState& SolarSystemState)
     {
         ES_ResultCode ResultCode;
         FString ErrorMessage;
 
-        // When do we want it?   (time: now)
-        FSEphemerisTime et = SolarSystemState.CurrentTime;
-
         bool result = true;
         for (const auto& [BodyNaifName, BodyActor] : SolarSystemState.SolarSystemBodyMap)
         {
@@ -299,25 +326,19 @@ namespace MaxQSamples
     // Generalized directional light (sun) directional updates.
     // This keeps boilerplate scenario stuff out of the samples.
     //-----------------------------------------------------------------------------
-    bool UpdateSunDirection(const FName& OriginNaifName, const FName& OriginReferenceFrame, const FSEphemerisTime& et, const FName& SunNaifName, const TWeakObjectPtr<AActor>& SunDirectionalLight)
+    bool UpdateSunDirection(const FName& OriginNaifName, const FName& OriginReferenceFrame, UMaxQClockSubsystem& Clock, const FName& SunNaifName, const TWeakObjectPtr<AActor>& SunDirectionalLight)
     {
-        FSDistanceVector r;
-        FSEphemerisPeriod lt;
+        FSStateVector state;
 
-        ES_ResultCode ResultCode;
-        FString ErrorMessage;
-
-        // Call SPICE, get the position in rectangular coordinates...
-        USpice::spkpos(ResultCode, ErrorMessage, et, r, lt, SunNaifName.ToString(), OriginNaifName.ToString(), OriginReferenceFrame.ToString());
-
-        bool result = (ResultCode == ES_ResultCode::Success);
+        // Call SPICE (once per frame, via the clock), get the position in rectangular coordinates...
+        bool result = Clock.GetFrameState(state, SunNaifName, OriginNaifName, OriginReferenceFrame);
 
         if (result)
         {
             // We assume we want to point the sun at the origin...
             FSDistance DistanceToSun;
 
-            auto DirectionToSun = MaxQ::Math::Unorm(DistanceToSun, r);
+            auto DirectionToSun = MaxQ::Math::Unorm(DistanceToSun, state.r);
             FVector LightDirection = -DirectionToSun.Swizzle();
 
             AActor* SunActor = SunDirectionalLight.Get();
@@ -466,23 +487,35 @@ bool USampleUtilities::LoadKernelList(const FString& ListName, const TArray<FStr
 // Name: InitializeTime
 // Desc:
 // Generalized handling of time initialization.
-// (Really belongs with InitBodyScales, UpdateBodyPositions,
-// UpdateBodyOrientations, and UpdateSunDirection.)
-// #TODO Refactor per comment
+// Sets the world's MaxQ clock from either the current time, or the
+// InitialTime string.  SetInitialTime is the first initialization: it also
+// records the initial time, and applies the initial time warp.
 //-----------------------------------------------------------------------------
-void USampleUtilities::InitializeTime(FSamplesSolarSystemState& SolarSystemState, bool SetInitialTime)
+void USampleUtilities::InitializeTime(const UObject* WorldContextObject, FSamplesSolarSystemState& SolarSystemState, bool SetInitialTime)
 {
+    UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(WorldContextObject);
+    if (!Clock)
+    {
+        MaxQSamples::Log(TEXT("InitializeTime: this world has no MaxQ clock"), FColor::Red);
+        return;
+    }
+
     // Initialize the time, from either the current time, or the InitialiTime string.
     if (SolarSystemState.InitializeTimeToNow)
     {
-        SolarSystemState.CurrentTime = Now();
+        Clock->SetEphemerisTimeToNow();
         // We may want to record the actual initial time, that way we could rewind to the
         // exact same time later.
-        if(SetInitialTime) SolarSystemState.InitialTime = SolarSystemState.CurrentTime.ToString();
+        if(SetInitialTime) SolarSystemState.InitialTime = Clock->GetEphemerisTime().ToString();
     }
     else
     {
-        SolarSystemState.CurrentTime = FSEphemerisTime::FromString(SolarSystemState.InitialTime);
+        Clock->SetEphemerisTime(FSEphemerisTime::FromString(SolarSystemState.InitialTime));
+    }
+
+    if (SetInitialTime)
+    {
+        Clock->SetTimeScale(SolarSystemState.TimeScale.AsSeconds());
     }
 }
 
@@ -9,6 +9,7 @@
 
 #include "CoreMinimal.h"
 #include "SpiceTypes.h"
+#include "SpiceClock.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Kismet/BlueprintAsyncActionBase.h"
 #include "UObject/WeakObjectPtrTemplates.h"
@@ -39,9 +40,8 @@ struct MAXQCPPSAMPLES_API FSamplesSolarSystemState
     UPROPERTY(EditInstanceOnly, Category = "MaxQ|Samples")
     FString InitialTime;
 
-    UPROPERTY(Transient)
-    FSEphemerisTime CurrentTime;
-
+    // Initial time warp.  The current time & warp belong to the world's
+    // UMaxQClockSubsystem, so every actor sees the same ET each frame.
     UPROPERTY(EditInstanceOnly, Category = "MaxQ|Samples")
     FSEphemerisPeriod TimeScale;
 
@@ -110,8 +110,8 @@ public:
     UFUNCTION(BlueprintCallable, Category = "MaxQSamples", meta = (DevelopmentOnly))
     static bool LoadKernelList(const FString& ListName, const TArray<FString>& KernelFiles);
 
-    UFUNCTION(BlueprintCallable, Category = "MaxQSamples", meta = (DevelopmentOnly))
-    static void InitializeTime(FSamplesSolarSystemState& SolarSystemState, bool SetInitialTime = true);
+    UFUNCTION(BlueprintCallable, Category = "MaxQSamples", meta = (DevelopmentOnly, WorldContext = "WorldContextObject"))
+    static void InitializeTime(const UObject* WorldContextObject, FSamplesSolarSystemState& SolarSystemState, bool SetInitialTime = true);
 
     /* DEPRECATED */
     UFUNCTION(BlueprintCallable, Category = "MaxQSamples", meta = (DevelopmentOnly, DeprecatedFunction, DeprecationMessage = "Use IssueTelemetryRequest"))
@@ -131,8 +131,12 @@ namespace MaxQSamples
 
     // Common solar system posing stuff, so each sample can focus on a particular thing without
     // Reimplementing all this stuff to reduce the noise.
+    FSEphemerisTime ClockTime(const UObject* WorldContextObject);
+    void ScaleTimeWarp(const UObject* WorldContextObject, double Factor);
+    void ResetTimeWarp(const UObject* WorldContextObject);
+    void GoToNow(const UObject* WorldContextObject);
     bool InitBodyScales(float BodyScale, const FSamplesSolarSystemState& SolarSystemState);
-    bool UpdateBodyPositions(const FName& OriginNaifName, const FName& OriginReferenceFrame, float DistanceScale, const FSamplesSolarSystemState& SolarSystemState);
-    bool UpdateBodyOrientations(const FName& OriginReferenceFrame, const FSamplesSolarSystemState& SolarSystemState);
-    bool UpdateSunDirection(const FName& OriginNaifName, const FName& OriginReferenceFrame, const FSEphemerisTime& et, const FName& SunNaifName, const TWeakObjectPtr<AActor>& SunDirectionalLight);
+    bool UpdateBodyPositions(const FName& OriginNaifName, const FName& OriginReferenceFrame, float DistanceScale, const FSamplesSolarSystemState& SolarSystemState, UMaxQClockSubsystem& Clock);
+    bool UpdateBodyOrientations(const FName& OriginReferenceFrame, const FSEphemerisTime& et, const FSamplesSolarSystemState& SolarSystemState);
+    bool UpdateSunDirection(const FName& OriginNaifName, const FName& OriginReferenceFrame, UMaxQClockSubsystem& Clock, const FName& SunNaifName, const TWeakObjectPtr<AActor>& SunDirectionalLight);
 }
@@ -57,6 +57,7 @@
 #include "Misc/AssertionMacros.h"
 #include "SpicePlatformDefs.h"
 #include "SpiceUtilities.h"
+#include "SpiceConstantCache.h"
 #include "SpiceMath.h"
 #include "algorithm"
 
@@ -174,8 +175,10 @@ void USpice::combine_paths(
 
 void USpice::clear_all()
 {
+    MAXQ_SPICE_SCOPE(USpice::clear_all);
     kclear_c();
     clpool_c();
+    OnKernelsCleared();
 
     UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Clear All' cleared kernel memory & pool") );
 }
@@ -187,6 +190,7 @@ void USpice::unload(
     const FString& relativeDirectory
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::unload);
     FString absolutePath = toPath(relativeDirectory);
     unload_c(TCHAR_TO_ANSI(*absolutePath));
 
@@ -194,11 +198,13 @@ void USpice::unload(
     {
         UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Unload' unloaded kernel : %s"), *absolutePath);
     }
+    OnKernelsChanged();
 }
 
 
 void USpice::init_all(bool PrintCallstack)
 {
+    MAXQ_SPICE_SCOPE(USpice::init_all);
     reset();
     clear_all();
     char szBuffer[SpiceLongMessageMaxLength];
@@ -239,6 +245,7 @@ Exceptions
 */
 void USpice::reset()
 {
+    MAXQ_SPICE_SCOPE(USpice::reset);
     reset_c();
 
     UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Reset' reset error handling state"));
@@ -268,6 +275,7 @@ Exceptions
 */
 void USpice::get_erract(ES_ErrorAction& Result)
 {
+    MAXQ_SPICE_SCOPE(USpice::get_erract);
     char szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
 
@@ -297,6 +305,7 @@ void USpice::get_erract(ES_ErrorAction& Result)
 
 void USpice::set_erract(ES_ErrorAction Action)
 {
+    MAXQ_SPICE_SCOPE(USpice::set_erract);
     char szAction[SPICE_MAX_PATH];
 
     switch (Action)
@@ -346,6 +355,7 @@ Exceptions
 
 void USpice::get_errdev(ES_ErrorDevice& device)
 {
+    MAXQ_SPICE_SCOPE(USpice::get_errdev);
     char szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
 
@@ -392,6 +402,7 @@ Exceptions
 
 void USpice::set_errdev(ES_ErrorDevice Device, const FString& LogFilePath)
 {
+    MAXQ_SPICE_SCOPE(USpice::set_errdev);
     char szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
 
@@ -442,6 +453,7 @@ Exceptions
 
 void USpice::get_errprt(FString& message)
 {
+    MAXQ_SPICE_SCOPE(USpice::get_errprt);
     char szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
 
@@ -474,6 +486,7 @@ Exceptions
 */
 void USpice::set_errprt(int32 items)
 {
+    MAXQ_SPICE_SCOPE(USpice::set_errprt);
     char szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
 
@@ -530,6 +543,7 @@ void USpice::axisar(
     FSRotationMatrix& r
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::axisar);
     // Inputs
     SpiceDouble	_axis[3];	axis.CopyTo(_axis);
     SpiceDouble	_angle = angle.AsSpiceDouble();
@@ -561,6 +575,7 @@ void USpice::azlcpo(
     ES_LocalZenithMethod method
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::azlcpo, target, nullptr, nullptr);
     // Unpack inputs, default outputs
     ConstSpiceChar* _method         = nullptr;
     auto _target         = StringCast<ANSICHAR>(*target);
@@ -630,6 +645,7 @@ void USpice::azlrec(
     bool elplsz
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::azlrec);
     // Unpack inputs, set default outputs
     SpiceDouble  _range = range.AsSpiceDouble();
     SpiceDouble  _az = az.AsSpiceDouble();
@@ -703,6 +719,7 @@ void USpice::bodn2c(
     const FString& name
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::bodn2c);
     SpiceInt _code = 0;
     SpiceBoolean _found = SPICEFALSE;
 
@@ -930,6 +947,7 @@ int USpice::bsrchd(
     const TArray<double>& valueArray
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::bsrchd);
     check(sizeof(double) == sizeof(ConstSpiceDouble));
 
     return (int) bsrchd_c(
@@ -954,6 +972,7 @@ void USpice::cgv2el(
     FSEllipse& ellipse
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::cgv2el);
     // Unpack inputs
     SpiceDouble    _center[3];  center.CopyTo(_center);
     SpiceDouble    _vec1[3];    center.CopyTo(_vec1);
@@ -985,6 +1004,7 @@ void USpice::ckcls(
     int handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ckcls);
     // Inputs
     SpiceInt _handle = handle;
 
@@ -1055,6 +1075,7 @@ void USpice::ckcov(
     ES_TimeSystem                   timsys
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ckcov);
     const int smallCellSize = 100;
     const int largeCellSize = 10000;
 
@@ -1174,6 +1195,7 @@ void USpice::ckfrot(
     const FSEphemerisTime& et
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ckfrot);
     // Unpack inputs, set default outputs
     SpiceInt        _inst = inst;
     SpiceDouble     _et = et.AsSpiceDouble();
@@ -1212,6 +1234,7 @@ void USpice::ckfxfm(
     const FSEphemerisTime& et
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ckfxfm);
     // Unpack inputs, set default outputs
     SpiceInt        _inst = inst;
     SpiceDouble     _et = et.AsSpiceDouble();
@@ -1265,6 +1288,7 @@ void USpice::ckgp(
     bool& bFound
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::ckgp, nullptr, nullptr, ref);
     // Inputs
     SpiceInt        _inst = inst;
     SpiceDouble     _sclkdp = sclkdp;
@@ -1300,6 +1324,7 @@ void USpice::ckgpav(
     bool& bFound
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::ckgpav, nullptr, nullptr, ref);
     // Inputs
     SpiceInt        _inst = inst;
     SpiceDouble     _sclkdp = sclkdp;
@@ -1331,6 +1356,7 @@ void USpice::cklpf(
     int& handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::cklpf);
     SpiceInt _handle = 0;
 
     // Invocation
@@ -1378,6 +1404,7 @@ void USpice::ckobj(
     TArray<int>& ids
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ckobj);
     const int MAXOBJ = 1000;
 
     SPICEINT_CELL(idscell, MAXOBJ);
@@ -1421,6 +1448,7 @@ void USpice::ckopn(
     int& handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ckopn);
     // Inputs
     auto _fname = StringCast<ANSICHAR>(*toPath(relativePath));
     auto _ifname = StringCast<ANSICHAR>(*ifname);
@@ -1450,6 +1478,7 @@ void USpice::ckupf(
     int handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ckupf);
     // Inputs
     SpiceInt _handle = handle;
 
@@ -1471,6 +1500,7 @@ void USpice::ckw01(
     const TArray<FSPointingType1Observation>& records
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::ckw01, nullptr, nullptr, ref);
     // Inputs
     SpiceInt        _handle = handle;
     SpiceDouble     _begtim = begtim;
@@ -1511,6 +1541,7 @@ void USpice::ckw02(
     const TArray<FSPointingType2Observation>& records
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::ckw02, nullptr, nullptr, ref);
     // Inputs
     SpiceInt        _handle = handle;
     SpiceDouble     _begtim = begtim;
@@ -1554,6 +1585,7 @@ void USpice::ckw03(
     const TArray<double>& starts
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::ckw03, nullptr, nullptr, ref);
     // Inputs
     SpiceInt        _handle = handle;
     SpiceDouble     _begtim = begtim;
@@ -1605,6 +1637,7 @@ void USpice::ckw05(
     const TArray<double>& starts
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::ckw05, nullptr, nullptr, ref);
     // Inputs
     SpiceInt        _handle = handle;
     SpiceCK05Subtype    _subtyp = (SpiceCK05Subtype)subtyp;
@@ -1680,6 +1713,7 @@ Exceptions
 
 void USpice::clight(FSSpeed& c)
 {
+    MAXQ_SPICE_SCOPE(USpice::clight);
     // Outputs
     SpiceDouble	_c;
 
@@ -1713,6 +1747,7 @@ void USpice::conics(
     FSStateVector& state
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::conics);
     // Inputs
     SpiceDouble _elts[8];	elts.CopyTo(_elts);
     SpiceDouble _et = et.seconds;
@@ -1740,6 +1775,7 @@ void USpice::cyllat(
     FSLatitudinalVector& veclat
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::cyllat);
     // Inputs
     SpiceDouble  _r = veccyl.r.AsSpiceDouble();
     SpiceDouble  _lonc = veccyl.lon.AsSpiceDouble();
@@ -1777,6 +1813,7 @@ void USpice::convrt(
     double& out_value
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::convrt);
     // Inputs
     SpiceDouble		_x = in_value;
     ConstSpiceChar* _in = MaxQ::Core::ToANSIString(in);
@@ -1803,6 +1840,7 @@ void USpice::cylrec(
     FSDistanceVector& rectan
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::cylrec);
     // Inputs
     SpiceDouble _r      = veccyl.r.AsSpiceDouble();
     SpiceDouble _lon    = veccyl.lon.AsSpiceDouble();
@@ -1828,6 +1866,7 @@ void USpice::cylsph(
     FSSphericalVector& sphvec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::cylsph);
     // Inputs
     SpiceDouble _r = veccyl.r.AsSpiceDouble();
     SpiceDouble _lonc = veccyl.lon.AsSpiceDouble();
@@ -1877,6 +1916,7 @@ void USpice::dafac(
     const TArray<FString>& comments
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dafac);
     // Buffers
     int32 maxCommentLineLength = 0;
     for (int32 i = 0; i < comments.Num(); ++i)
@@ -1924,6 +1964,7 @@ void USpice::dafcls(
     int handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dafcls);
     // Input
     SpiceInt    _handle = handle;
 
@@ -1969,6 +2010,7 @@ void USpice::dafec(
     TArray<FString>& comments
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dafec);
     // Inputs
     SpiceInt _handle = handle;
 
@@ -2056,6 +2098,7 @@ void USpice::dafopr(
     int& handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dafopr);
     // Output
     SpiceInt        _handle = 0;
     
@@ -2125,6 +2168,7 @@ void USpice::dafopw(
     int& handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dafopw);
     // Output
     SpiceInt        _handle = 0;
     FString Path = toPath(relativePath);
@@ -2147,6 +2191,7 @@ void USpice::dasopr(
     int& handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dasopr);
     // Output
     SpiceInt        _handle = 0;
 
@@ -2175,6 +2220,7 @@ void USpice::dascls(
     int handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dascls);
     // Input
     SpiceInt        _handle = (SpiceInt)handle;
 
@@ -2189,6 +2235,7 @@ void USpice::dlabfs(
     ES_FoundCode& FoundCode
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dlabfs);
     // Input
     SpiceInt _handle = (SpiceInt)handle;
     
@@ -2242,6 +2289,7 @@ void USpice::deltet(
     FSEphemerisPeriod& delta
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::deltet);
     // Inputs
     SpiceDouble		_epoch = epoch;
     ConstSpiceChar* _eptype = eptype == ES_EpochType::UTC ? "UTC" : "ET";
@@ -2265,6 +2313,7 @@ Exceptions
 */
 void USpice::det(const FSRotationMatrix& m1, double& ReturnValue)
 {
+    MAXQ_SPICE_SCOPE(USpice::det);
     // Inputs
     SpiceDouble _m1[3][3];	m1.CopyTo(_m1);
 
@@ -2279,6 +2328,7 @@ Exceptions
 */
 void USpice::dpmax(double& ReturnValue)
 {
+    MAXQ_SPICE_SCOPE(USpice::dpmax);
     // Invocation, Return Value
     ReturnValue = dpmax_c();
 }
@@ -2290,6 +2340,7 @@ Exceptions
 */
 void USpice::dpmin(double& ReturnValue)
 {
+    MAXQ_SPICE_SCOPE(USpice::dpmin);
     // Invocation, Return Value
     ReturnValue = dpmin_c();
 }
@@ -2301,6 +2352,7 @@ Exceptions
 */
 void USpice::dpr(double& ReturnValue)
 {
+    MAXQ_SPICE_SCOPE(USpice::dpr);
     // Invocation, Return Value
     ReturnValue = dpr_c();
 }
@@ -2343,6 +2395,7 @@ void USpice::dskobj(
     const FString& fileRelativePath
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dskobj);
     const int MAXID = 10000;
 
     // Output
@@ -2375,6 +2428,7 @@ void USpice::dsksrf(
     int bodyid
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dsksrf);
     constexpr int MAXID = 10000;
 
     // Output
@@ -2409,6 +2463,7 @@ void USpice::dskz02(
     const FSDLADescr& dladsc
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dskz02);
     // Inputs
     SpiceInt      _handle = (SpiceInt)handle;
     SpiceDLADescr _dladsc;  dladsc.CopyTo(&_dladsc);
@@ -2442,6 +2497,7 @@ void USpice::dskp02(
     int               start
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dskp02);
     // Inputs
     SpiceInt      _handle = (SpiceInt)handle;
     SpiceDLADescr _dladsc;  dladsc.CopyTo(&_dladsc);
@@ -2491,6 +2547,7 @@ void USpice::dskv02(
     int               start
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dskv02);
     // Inputs
     SpiceInt      _handle = (SpiceInt)handle;
     SpiceDLADescr _dladsc;  dladsc.CopyTo(&_dladsc);
@@ -2540,6 +2597,7 @@ void USpice::dskn02(
     int               plid
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::dskn02);
     // Inputs
     SpiceInt      _handle = (SpiceInt)handle;
     SpiceDLADescr _dladsc;  dladsc.CopyTo(&_dladsc);
@@ -2582,6 +2640,7 @@ void USpice::dskxsi(
     const FString& fixref
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::dskxsi, target, nullptr, fixref);
     // Inputs
     // pri - "In the N0066 SPICE Toolkit, this is the only allowed value."
     SpiceBoolean    _pri = SPICEFALSE;
@@ -2654,6 +2713,7 @@ void USpice::dskxv(
     const FString& fixref
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::dskxv, target, nullptr, fixref);
     // Inputs
     // pri - "In the N0066 SPICE Toolkit, this is the only allowed value"
     SpiceBoolean        _pri = SPICEFALSE;
@@ -2662,44 +2722,58 @@ void USpice::dskxv(
     SpiceInt*           _srflst = (SpiceInt*)srflst.GetData();
     SpiceDouble         _et = et.AsSpiceDouble();
     auto                _fixref = StringCast<ANSICHAR>(*fixref);
-    SpiceInt            _nrays = rayarray.Num();
-    SpiceDouble(*_vtxarr)[3] = (SpiceDouble(*)[3])StackAlloc(_nrays * sizeof(SpiceDouble[3]));
-    SpiceDouble(*_dirarr)[3] = (SpiceDouble(*)[3])StackAlloc(_nrays * sizeof(SpiceDouble[3]));
-
-    for (int i = 0; i < rayarray.Num(); ++i)
-    {
-        rayarray[i].CopyTo(_vtxarr[i], _dirarr[i]);
-    }
+    const int32         NumRays = rayarray.Num();
+
+    // Large batches go through in chunks, with heap buffers (stack
+    // allocating the whole batch overflows the stack).
+    constexpr int32     MaxChunkRays = 4096;
+    const int32         ChunkRays = FMath::Min(NumRays, MaxChunkRays);
+    TArray<SpiceDouble> _vtxbuf, _dirbuf, _xptbuf;
+    TArray<SpiceBoolean> _fndarr;
+    _vtxbuf.SetNumUninitialized(3 * ChunkRays);
+    _dirbuf.SetNumUninitialized(3 * ChunkRays);
+    _xptbuf.SetNumUninitialized(3 * ChunkRays);
+    _fndarr.SetNumUninitialized(ChunkRays);
+    SpiceDouble(*_vtxarr)[3] = reinterpret_cast<SpiceDouble(*)[3]>(_vtxbuf.GetData());
+    SpiceDouble(*_dirarr)[3] = reinterpret_cast<SpiceDouble(*)[3]>(_dirbuf.GetData());
+    SpiceDouble(*_xptarr)[3] = reinterpret_cast<SpiceDouble(*)[3]>(_xptbuf.GetData());
 
     // Outputs
-    SpiceDouble(*_xptarr)[3] = (SpiceDouble(*)[3])StackAlloc(_nrays * sizeof(SpiceDouble[3]));
-    SpiceBoolean    *_fndarr = (SpiceBoolean*)StackAlloc(_nrays * sizeof(SpiceBoolean));
+    xptarr.Init(FSDistanceVector(), NumRays);
+    fndarr.Init(false, NumRays);
 
-    // Invocation
-    dskxv_c(
-        _pri,
-        _target.Get(),
-        _nsurf,
-        _srflst,
-        _et,
-        _fixref.Get(),
-        _nrays,
-        _vtxarr,
-        _dirarr,
-        _xptarr,
-        _fndarr
-    );
+    for (int32 First = 0; First < NumRays && !failed_c(); First += ChunkRays)
+    {
+        const SpiceInt _nrays = FMath::Min(ChunkRays, NumRays - First);
 
-    // Pack up the outputs...
-    xptarr.Init(FSDistanceVector(), _nrays);
-    fndarr.Init(false, _nrays);
+        for (int i = 0; i < _nrays; ++i)
+        {
+            rayarray[First + i].CopyTo(_vtxarr[i], _dirarr[i]);
+        }
 
-    for(int i = 0; i < _nrays; ++i)
-    {
-        fndarr[i] = (_fndarr[i] == SPICETRUE ? true : false);
-        if (fndarr[i])
+        // Invocation
+        dskxv_c(
+            _pri,
+            _target.Get(),
+            _nsurf,
+            _srflst,
+            _et,
+            _fixref.Get(),
+            _nrays,
+            _vtxarr,
+            _dirarr,
+            _xptarr,
+            _fndarr.GetData()
+        );
+
+        // Pack up the outputs...
+        for (int i = 0; i < _nrays; ++i)
         {
-            xptarr[i] = FSDistanceVector(_xptarr[i]);
+            fndarr[First + i] = (_fndarr[i] == SPICETRUE ? true : false);
+            if (fndarr[First + i])
+            {
+                xptarr[First + i] = FSDistanceVector(_xptarr[i]);
+            }
         }
     }
 
@@ -2729,6 +2803,7 @@ void USpice::etcal(
     FString& ReturnValue
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::etcal);
     // Buffers
     SpiceChar szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
@@ -2763,6 +2838,7 @@ void USpice::eqncpv(
     FSStateVector& state
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::eqncpv);
     // Inputs
     SpiceDouble	_et = et.seconds;
     SpiceDouble	_epoch = epoch.seconds;
@@ -2821,6 +2897,7 @@ void USpice::et2lst(
     FString& ampm
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::et2lst);
     // Buffers
     SpiceChar szTime[SPICE_MAX_PATH];
     ZeroOut(szTime);
@@ -2923,48 +3000,8 @@ void USpice::et2utc(
     int prec
 )
 {
-    // Buffers
-    SpiceChar szUtc[SPICE_MAX_PATH];
-    ZeroOut(szUtc);
-
-    // Inputs
-    SpiceDouble     _et = et.seconds;
-    SpiceInt		_prec = prec;
-    ConstSpiceChar* _format;
-    switch (format)
-    {
-    case ES_UTCTimeFormat::Calendar:
-        _format = "C";
-        break;
-    case ES_UTCTimeFormat::DayOfYear:
-        _format = "D";
-        break;
-    case ES_UTCTimeFormat::JulianDate:
-        _format = "J";
-        break;
-    case ES_UTCTimeFormat::ISOCalendar:
-        _format = "ISOC";
-        break;
-    case ES_UTCTimeFormat::ISODayOfYear:
-        _format = "ISOD";
-        break;
-    default:
-        _format = "";
-        break;
-    }
-
-    // Outputs
-    SpiceChar* _utcstr = szUtc;
-    SpiceInt   _lenout = sizeof(szUtc);
-
-    // Invocation
-    et2utc_c(_et, _format, _prec, _lenout, _utcstr);
-
-    // Return Value
-    utcstr = FString(_utcstr);
-
-    // Error Handling
-    ErrorCheck(ResultCode, ErrorMessage);
+    // Natively when possible, else et2utc_c
+    utcstr = MaxQ::Time::Et2Utc(et, format, prec, &ResultCode, &ErrorMessage);
 }
 
 /*
@@ -2987,6 +3024,7 @@ void USpice::eul2m(
     ES_Axis axis1
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::eul2m);
     // Inputs
     SpiceDouble  _angle3 = angle3.AsSpiceDouble();
     SpiceDouble  _angle2 = angle2.AsSpiceDouble();
@@ -3032,6 +3070,7 @@ void USpice::eul2xf(
     FSEulerAngularTransform& xform
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::eul2xf);
     // Inputs
     uint8	_axisa;
     uint8	_axisb;
@@ -3054,6 +3093,7 @@ void USpice::eul2xf(
 
 void USpice::getgeophs(FSTLEGeophysicalConstants& geophs, const FString& body)
 {
+    MAXQ_SPICE_SCOPE(USpice::getgeophs);
     SpiceDouble _geophs[8];
     FMemory::Memset(_geophs, 0, sizeof(_geophs));
 
@@ -3102,6 +3142,7 @@ void USpice::getelm(
     int         frstyr
     )
 {
+    MAXQ_SPICE_SCOPE(USpice::getelm);
     SpiceInt     _frstyr = frstyr;
     SpiceInt     _lineln = SPICE_MAX_PATH;
     SpiceChar    _lines[2][SPICE_MAX_PATH];
@@ -3139,6 +3180,7 @@ void USpice::evsgp4(
     bool IgnoreBadMeanEccentricity
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::evsgp4);
     // Copy inputs & default outputs...
     SpiceDouble _et = et.AsSpiceDouble();
     SpiceDouble _geophs[8]; geophs.CopyTo(_geophs);
@@ -3177,6 +3219,7 @@ int USpice::ev2lin(
     FSStateVector& state
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ev2lin);
     SpiceDouble _et = et.AsSpiceDouble();
     SpiceDouble _geophs[8]; geophs.CopyTo(_geophs);
     SpiceDouble _elems[10]; elems.CopyTo(_elems);
@@ -3249,6 +3292,7 @@ void USpice::frame(
     FSDimensionlessVector& z
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::frame);
     // Input/Output
     SpiceDouble _x[3];   x_in.CopyTo(_x);
     // Outputs
@@ -3275,6 +3319,7 @@ void USpice::gcpool(
     int                 room
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::gcpool);
     // Inputs
     SpiceInt        _start = start;
     SpiceInt        _room = room;
@@ -3314,6 +3359,7 @@ void USpice::frinfo(
     ES_FoundCode& FoundCode
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::frinfo);
     // Input
     SpiceInt _frcode = (SpiceInt)frcode;
     
@@ -3359,6 +3405,7 @@ void USpice::frmnam(
     FString& frname
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::frmnam);
     SpiceChar szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
 
@@ -3392,6 +3439,7 @@ void USpice::fovray(
     const FString& observer
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::fovray, nullptr, observer, nullptr);
     // Inputs
     auto            _inst = StringCast<ANSICHAR>(*inst);
     SpiceDouble     _raydir[3]; raydir.CopyTo(_raydir);
@@ -3434,6 +3482,7 @@ void USpice::fovtrg(
     const FString& obsrvr
     )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::fovtrg, target, obsrvr, nullptr);
     // Inputs
     auto            _inst   = StringCast<ANSICHAR>(*inst);
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -3475,6 +3524,7 @@ void USpice::gdpool(
     int                 room
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::gdpool);
     // Inputs
     SpiceInt        _start = start;
     SpiceInt        _room = room;
@@ -3508,23 +3558,20 @@ void USpice::gdpool_scalar(
     const FString& name
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::gdpool_scalar);
     // Inputs
-    SpiceInt        _start = 0;
-    SpiceInt        _room = 1;
+    int32           _room = 1;
     // Outputs
-    SpiceInt        _n = 0;
+    int32           _n = 0;
     SpiceDouble     _value = 0;
-    SpiceBoolean    _found = SPICEFALSE;
+    bool            _found = false;
 
     // Invocation
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
+    _found = MaxQ::ConstantCache::Gdpool(TCHAR_TO_ANSI(*name), &_value, _room, _n, &ResultCode, &ErrorMessage);
 
     // Return values
     value = _value;
-    bFound = (_found == SPICETRUE);
-
-    // Error Handling
-    ErrorCheck(ResultCode, ErrorMessage);
+    bFound = _found;
 }
 
 void USpice::gdpool_distance(
@@ -3535,23 +3582,20 @@ void USpice::gdpool_distance(
     const FString& name
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::gdpool_distance);
     // Inputs
-    SpiceInt        _start = 0;
-    SpiceInt        _room = 1;
+    int32           _room = 1;
     // Outputs
-    SpiceInt        _n = 0;
+    int32           _n = 0;
     SpiceDouble     _value = 0;
-    SpiceBoolean    _found = SPICEFALSE;
+    bool            _found = false;
 
     // Invocation
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
+    _found = MaxQ::ConstantCache::Gdpool(TCHAR_TO_ANSI(*name), &_value, _room, _n, &ResultCode, &ErrorMessage);
 
     // Return values
     value = FSDistance(_value);
-    bFound = (_found == SPICETRUE);
-
-    // Error Handling
-    ErrorCheck(ResultCode, ErrorMessage);
+    bFound = _found;
 }
 
 void USpice::gdpool_vector(
@@ -3562,23 +3606,20 @@ void USpice::gdpool_vector(
     const FString& name
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::gdpool_vector);
     // Inputs
-    SpiceInt        _start = 0;
-    SpiceInt        _room = 3;
+    int32           _room = 3;
     // Outputs
-    SpiceInt        _n = 0;
+    int32           _n = 0;
     SpiceDouble     _value[3];  ZeroOut(_value);
-    SpiceBoolean    _found = SPICEFALSE;
+    bool            _found = false;
 
     // Invocation
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, _value, &_found);
+    _found = MaxQ::ConstantCache::Gdpool(TCHAR_TO_ANSI(*name), _value, _room, _n, &ResultCode, &ErrorMessage);
 
     // Return values
     value = FSDistanceVector(_value);
-    bFound = (_found == SPICETRUE);
-
-    // Error Handling
-    ErrorCheck(ResultCode, ErrorMessage);
+    bFound = _found;
 }
 
 
@@ -3590,23 +3631,20 @@ void USpice::gdpool_mass(
     const FString& name
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::gdpool_mass);
     // Inputs
-    SpiceInt        _start = 0;
-    SpiceInt        _room = 1;
+    int32           _room = 1;
     // Outputs
-    SpiceInt        _n = 0;
+    int32           _n = 0;
     SpiceDouble     _value = 0;
-    SpiceBoolean    _found = SPICEFALSE;
+    bool            _found = false;
 
     // Invocation
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
+    _found = MaxQ::ConstantCache::Gdpool(TCHAR_TO_ANSI(*name), &_value, _room, _n, &ResultCode, &ErrorMessage);
 
     // Return values
     value = FSMassConstant(_value);
-    bFound = (_found == SPICETRUE);
-
-    // Error Handling
-    ErrorCheck(ResultCode, ErrorMessage);
+    bFound = _found;
 }
 
 
@@ -3649,6 +3687,7 @@ void USpice::georec(
     double f
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::georec);
     SpiceDouble _rectan[3];
     ZeroOut(_rectan);
 
@@ -3709,6 +3748,7 @@ void USpice::getfat(
     const FString& fileRelativePath
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::getfat);
     
     SpiceChar szArchBuffer[SPICE_MAX_PATH];
     ZeroOut(szArchBuffer);
@@ -3749,6 +3789,7 @@ void USpice::getfov(
     TArray<FSDimensionlessVector>&   bounds
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::getfov);
     SpiceInt        _instid = instid;
     SpiceInt        _room = MAXBND;
     SpiceChar       _shape[WDSIZE];     ZeroOut(_shape);
@@ -3802,6 +3843,7 @@ void USpice::gfdist(
     ES_RelationalOperator relate
     )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfdist, target, obsrvr, nullptr);
     const int MAXWIN = 200;
     if (2 * cnfine.Num() > MAXWIN)
     {
@@ -3899,6 +3941,7 @@ void USpice::gfilum(
     ES_RelationalOperator relate
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfilum, target, obsrvr, fixref);
     const int MAXWIN = 200;
     if (2 * cnfine.Num() > MAXWIN)
     {
@@ -4011,6 +4054,7 @@ void USpice::gfoclt(
     const FString& obsrvr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfoclt, nullptr, obsrvr, nullptr);
     const int MAXWIN = 200;
     if (2 * cnfine.Num() > MAXWIN)
     {
@@ -4114,6 +4158,7 @@ void USpice::gfpa(
     ES_RelationalOperator relate
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfpa, target, obsrvr, nullptr);
     const int MAXWIN = 200;
     if (2 * cnfine.Num() > MAXWIN)
     {
@@ -4212,6 +4257,7 @@ void USpice::gfposc(
     int nintvls
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfposc, target, obsrvr, frame);
     const int MAXWIN = 200;
     if (2 * cnfine.Num() > MAXWIN)
     {
@@ -4298,6 +4344,7 @@ void USpice::gfrfov(
     const FString& obsrvr
     )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfrfov, nullptr, obsrvr, nullptr);
     const int MAXWIN = 200;
 
     auto            _inst   = StringCast<ANSICHAR>(*inst);
@@ -4362,6 +4409,7 @@ void USpice::gfrr(
     ES_RelationalOperator relate
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfrr, target, obsrvr, nullptr);
     const int MAXWIN = 200;
     if (2 * cnfine.Num() > MAXWIN)
     {
@@ -4459,6 +4507,7 @@ void USpice::gfsep(
     ES_RelationalOperator relate
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfsep, nullptr, obsrvr, nullptr);
     // Since SPICEDOUBLE_CELL allocates a fixed size on the stack and it's
     // unappealing to mimic it with alloca.
     // But, I guess I could see it it would be easy to go over the limit
@@ -4584,6 +4633,7 @@ void USpice::gfsntc(
     ES_RelationalOperator relate
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfsntc, target, obsrvr, fixref);
     const int MAXWIN = 200;
     if (2 * cnfine.Num() > MAXWIN)
     {
@@ -4694,6 +4744,7 @@ void USpice::gftfov(
     const FString& obsrvr
     )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gftfov, target, obsrvr, nullptr);
     const int MAXWIN = 200;
 
     // Inputs
@@ -4755,6 +4806,7 @@ Exceptions
 */
 void USpice::gfstol(double value)
 {
+    MAXQ_SPICE_SCOPE(USpice::gfstol);
     gfstol_c((SpiceDouble)value);
 
     // Error Handling
@@ -4781,6 +4833,7 @@ void USpice::gfsubc(
     int nintvls
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::gfsubc, target, obsrvr, fixref);
     const int MAXWIN = 200;
 
     // Inputs
@@ -4854,6 +4907,7 @@ void USpice::gipool(
     int             room
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::gipool);
     // Inputs
     SpiceInt        _start = start;
     SpiceInt        _room = room;
@@ -4889,6 +4943,7 @@ void USpice::gnpool(
     int                 room
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::gnpool);
     // Inputs
     SpiceInt        _start = start;
     SpiceInt        _room = room;
@@ -4937,6 +4992,7 @@ void USpice::illumf(
     const FString& obsrvr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::illumf, target, obsrvr, fixref);
     // Inputs
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, surfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -5008,6 +5064,7 @@ void USpice::illumg(
     const FString& obsrvr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::illumg, target, obsrvr, fixref);
     // Inputs
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, surfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -5148,6 +5205,7 @@ void USpice::ilumin(
     const FString&          obsrvr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::ilumin, target, obsrvr, fixref);
     // Inputs
     auto            _method = StringCast<ANSICHAR>(*method);
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -5213,6 +5271,7 @@ void USpice::srfrec(
     int           body
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::srfrec);
     // Inputs
     SpiceInt      _body         = (SpiceInt)body;
     SpiceDouble   _longitude    = lonlat.longitude.AsSpiceDouble();
@@ -5261,13 +5320,8 @@ void USpice::str2et(
     const FString& str
 )
 {
-    SpiceDouble _et;
-
-    str2et_c(TCHAR_TO_ANSI(*str), &_et);
-
-    et = FSEphemerisTime(_et);
-
-    ErrorCheck(ResultCode, ErrorMessage);
+    // Natively when possible, else str2et_c
+    et = MaxQ::Time::Str2Et(str, &ResultCode, &ErrorMessage);
 }
 
 /*
@@ -5298,6 +5352,7 @@ void USpice::timout(
     const FString& pictur
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::timout);
     SpiceChar szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
 
@@ -5323,6 +5378,7 @@ void USpice::tparse(
     const FString& string
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::tparse);
     // Buffer
     SpiceChar szBuffer[SPICE_MAX_PATH];
     ZeroOut(szBuffer);
@@ -5350,11 +5406,7 @@ void USpice::tparse(
 
 void USpice::et_now(FSEphemerisTime& Now)
 {
-    auto now = FDateTime::UtcNow();
-    auto j2000 = FDateTime::FromJulianDay(2451545.0);
-    auto now_j2000 = now - j2000;
-
-    Now = FSEphemerisTime(now_j2000.GetTotalSeconds());
+    Now = MaxQ::Time::Now();
 }
 
 
@@ -5393,6 +5445,7 @@ void USpice::kdata(
     int      which
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::kdata);
     SpiceChar KernelFileBuffer[SPICE_MAX_PATH];
     SpiceChar FileTypeBuffer[64];
     SpiceChar SourceFileBuffer[SPICE_MAX_PATH];
@@ -5465,6 +5518,7 @@ void USpice::kinfo(
     const FString& file
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::kinfo);
     SpiceChar FileTypeBuffer[64];
     SpiceChar SourceFileBuffer[SPICE_MAX_PATH];
 
@@ -5521,6 +5575,7 @@ void USpice::ktotal(
     int32 kind
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ktotal);
     SpiceInt _count = count;
 
     FString Kind = MaxQ::Core::ToString((ES_KernelType)kind);
@@ -5540,6 +5595,7 @@ void USpice::latcyl(
     FSCylindricalVector& cylvec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::latcyl);
     // Input
     SpiceDouble _radius = latvec.r.AsSpiceDouble();
     SpiceDouble _lon = latvec.lonlat.longitude.AsSpiceDouble();
@@ -5570,6 +5626,7 @@ void USpice::latrec(
     FSDistanceVector& rectan
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::latrec);
     // Inputs
     SpiceDouble    _radius = latvec.r.AsSpiceDouble();
     SpiceDouble    _longitude;
@@ -5596,6 +5653,7 @@ void USpice::latsph(
     FSSphericalVector& sphvec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::latsph);
     // Inputs
     SpiceDouble _radius = latvec.r.AsSpiceDouble();
     SpiceDouble _lon = latvec.lonlat.longitude.AsSpiceDouble();
@@ -5693,6 +5751,7 @@ void USpice::latsrf(
 
     )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::latsrf, target, nullptr, fixref);
     // Input
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, shapeSurfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -5764,6 +5823,7 @@ void USpice::limbpt(
     int maxn
     )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::limbpt, target, obsrvr, fixref);
     // Inputs
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, shapeSurfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -5855,6 +5915,7 @@ void USpice::mxvg(
     void* vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::mxvg);
     mxvg_c(m1, v2, nrow1, nc1r2, vout);
 }
 #endif
@@ -5872,6 +5933,7 @@ void USpice::q2m(
     FSRotationMatrix& r
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::q2m);
     SpiceDouble _r[3][3];
     SpiceDouble _q[4];
     q.CopyTo(_q);
@@ -5887,6 +5949,7 @@ void USpice::q2m(
 */
 void USpice::qdq2av(const FSQuaternion& q, const FSQuaternionDerivative& dq, FSAngularVelocity& av)
 {
+    MAXQ_SPICE_SCOPE(USpice::qdq2av);
     SpiceDouble _q[4];
     SpiceDouble _dq[4];
     q.CopyTo(_q);
@@ -5912,6 +5975,7 @@ void USpice::m2q(
     FSQuaternion& q
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::m2q);
     SpiceDouble _m1[3][3];  r.CopyTo(_m1);
     SpiceDouble _q[4];  q.CopyTo(_q);
     m2q_c(_m1, _q);
@@ -5932,6 +5996,7 @@ void USpice::qxq(
     FSQuaternion& qout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::qxq);
     SpiceDouble _qout[4];
     SpiceDouble _q1[4];  q1.CopyTo(_q1);
     SpiceDouble _q2[4];  q2.CopyTo(_q2);
@@ -6065,6 +6130,7 @@ void USpice::m2eul(
     ES_Axis axis1
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::m2eul);
     // Inputs
     SpiceDouble	_r[3][3];	r.CopyTo(_r);
     SpiceInt	_axis3 = (SpiceInt)axis3;
@@ -6106,6 +6172,7 @@ void USpice::hrmint(
     double& df
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::hrmint);
     // Inputs
     SpiceInt		_n = xvals.Num();
     SpiceDouble* _xvals = (SpiceDouble*)StackAlloc(xvals.Num() * sizeof(SpiceDouble));
@@ -6141,11 +6208,13 @@ Exceptions
 */
 void USpice::halfpi(double& half_pi)
 {
+    MAXQ_SPICE_SCOPE(USpice::halfpi);
     half_pi = (double)halfpi_c();
 }
 
 void USpice::halfpi_angle(FSAngle& half_pi)
 {
+    MAXQ_SPICE_SCOPE(USpice::halfpi_angle);
     half_pi = FSAngle(halfpi_c());
 }
 
@@ -6158,6 +6227,7 @@ void USpice::ident(
     FSRotationMatrix& matrix
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::ident);
     SpiceDouble    _matrix[3][3];
     ZeroOut(_matrix);
 
@@ -6194,6 +6264,7 @@ void USpice::inelpl(
     bool& coplanar
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::inelpl);
     // Inputs
     SpiceEllipse _ellips;   CopyTo(ellips, _ellips);
     SpicePlane _plane;      CopyTo(plane, _plane);
@@ -6224,6 +6295,7 @@ void USpice::inelpl(
 
 void USpice::intmax(int& int_max)
 {
+    MAXQ_SPICE_SCOPE(USpice::intmax);
     SpiceInt _int_max = intmax_c();
 
     // This is a little bit terrible, because there's nothing that guarantees the max
@@ -6235,6 +6307,7 @@ void USpice::intmax(int& int_max)
 
 void USpice::intmin(int& int_min)
 {
+    MAXQ_SPICE_SCOPE(USpice::intmin);
     SpiceInt _int_min = intmin_c();
 
     // Ugh.  See intmax() comments
@@ -6259,6 +6332,7 @@ void USpice::invert(
     FSRotationMatrix& mout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::invert);
     // Input
     SpiceDouble  _m1[3][3];		m1.CopyTo(_m1);
     // Output
@@ -6281,6 +6355,7 @@ void USpice::invort(
     FSRotationMatrix& mit
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::invort);
     // Input
     SpiceDouble	_m[3][3];	m.CopyTo(_m);
     // Output
@@ -6305,6 +6380,7 @@ void USpice::invstm(
     FSStateTransform& inverseXform
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::invstm);
     // Input
     SpiceDouble _xform[6][6];     xform.CopyTo(_xform);
     // Output
@@ -6327,6 +6403,7 @@ void USpice::b1900(
     double& JulianDate
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::b1900);
     SpiceDouble _b1900 = b1900_c();
     JulianDate = (double)_b1900;
 }
@@ -6339,6 +6416,7 @@ void USpice::b1950(
     double& JulianDate
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::b1950);
     SpiceDouble _b1950 = b1950_c();
     JulianDate = (double)_b1950;
 }
@@ -6352,6 +6430,7 @@ void USpice::j1900(
     double& JulianDate
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::j1900);
     SpiceDouble _j1900 = j1900_c();
     JulianDate = (double)_j1900;
 }
@@ -6364,6 +6443,7 @@ void USpice::j1950(
     double& JulianDate
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::j1950);
     SpiceDouble _j1950 = j1950_c();
     JulianDate = (double)_j1950;
 }
@@ -6376,6 +6456,7 @@ void USpice::j2000(
     double& JulianDate
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::j2000);
     SpiceDouble _j2000 = j2000_c();
     JulianDate = (double)_j2000;
 }
@@ -6388,6 +6469,7 @@ void USpice::j2100(
     double& JulianDate
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::j2100);
     SpiceDouble _j2100 = j2100_c();
     JulianDate = (double)_j2100;
 }
@@ -6399,6 +6481,7 @@ Exceptions
 */
 void USpice::jyear(double& secondsPerJulianYear)
 {
+    MAXQ_SPICE_SCOPE(USpice::jyear);
     secondsPerJulianYear = jyear_c();
 }
 
@@ -6408,6 +6491,7 @@ Exceptions
 */
 void USpice::tyear(double& secondsPerTropicalYear)
 {
+    MAXQ_SPICE_SCOPE(USpice::tyear);
     secondsPerTropicalYear = tyear_c();
 }
 
@@ -6417,6 +6501,7 @@ Exceptions
 */
 void USpice::jyear_period(FSEphemerisPeriod& oneJulianYear)
 {
+    MAXQ_SPICE_SCOPE(USpice::jyear_period);
     SpiceDouble _jyear = jyear_c();
     oneJulianYear = FSEphemerisPeriod(_jyear);
 }
@@ -6427,6 +6512,7 @@ Exceptions
 */
 void USpice::tyear_period(FSEphemerisPeriod& oneTropicalYear)
 {
+    MAXQ_SPICE_SCOPE(USpice::tyear_period);
     SpiceDouble _tyear = tyear_c();
     oneTropicalYear = FSEphemerisPeriod(_tyear);
 }
@@ -6454,6 +6540,7 @@ void USpice::lgrind(
     double& dp
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::lgrind);
     // Inputs
     SpiceInt		_n = xvals.Num();
     SpiceDouble* _xvals = (SpiceDouble*)StackAlloc(xvals.Num() * sizeof(SpiceDouble));
@@ -6516,6 +6603,7 @@ void USpice::lspcn(
     FSAngle& lon
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::lspcn);
     // Inputs
     SpiceDouble		_et = et.AsSpiceDouble();
     ConstSpiceChar* _abcorr;
@@ -6551,6 +6639,7 @@ void USpice::mequ(
     FSRotationMatrix& mout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::mequ);
     // Input
     SpiceDouble _m1[3][3];		m1.CopyTo(_m1);
 
@@ -6645,6 +6734,7 @@ void USpice::namfrm(
     int& frcode
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::namfrm);
     // Output
     SpiceInt       _frcode = 0;
 
@@ -6682,6 +6772,7 @@ void USpice::npelpt(
     FSDistance& dist
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::npelpt);
     // Input
     SpiceDouble			_point[3];	point.CopyTo(_point);
     SpiceEllipse		_ellips;    CopyTo(ellips, _ellips);
@@ -6739,6 +6830,7 @@ void USpice::nearpt(
     FSDistance& alt
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::nearpt);
     // Inputs
     SpiceDouble _positn[3]; positn.CopyTo(_positn);
     SpiceDouble _a = a.AsSpiceDouble();
@@ -6794,6 +6886,7 @@ void USpice::npedln(
     FSDistance& dist
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::npedln);
     // Inputs
     SpiceDouble       _a;       _a = a.AsSpiceDouble();
     SpiceDouble       _b;       _b = b.AsSpiceDouble();
@@ -6831,6 +6924,7 @@ void USpice::nplnpt(
     double& dist
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::nplnpt);
     // Inputs
     SpiceDouble _linpt[3];  linpt.CopyTo(_linpt);
     SpiceDouble _lindir[3]; lindir.CopyTo(_lindir);
@@ -6864,6 +6958,7 @@ void USpice::nvc2pl(
     FSPlane& plane
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::nvc2pl);
     // Inputs
     SpiceDouble	_normal[3]; normal.CopyTo(_normal);
     SpiceDouble	_constant = constant.AsSpiceDouble();
@@ -6894,6 +6989,7 @@ void USpice::nvp2pl(
     FSPlane& plane
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::nvp2pl);
     // Inputs
     SpiceDouble    _normal[3];	normal.CopyTo(_normal);
     SpiceDouble    _point[3];	point.CopyTo(_normal);
@@ -6931,6 +7027,7 @@ void USpice::occult(
     const FString& obsrvr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::occult, nullptr, obsrvr, nullptr);
     // Inputs
     auto            _targ1  = StringCast<ANSICHAR>(*targ1);
     auto            _shape1 = StringCast<ANSICHAR>(*MaxQ::Core::ToString(shape1, shape1Surfaces));
@@ -7010,6 +7107,7 @@ void USpice::oscelt(
     FSConicElements& elts
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::oscelt);
     SpiceDouble _state[6]; state.CopyTo(_state);
     SpiceDouble _elts[8];  elts.CopyTo(_elts);
    
@@ -7033,6 +7131,7 @@ void USpice::oscltx(
     FSEphemerisPeriod& tau
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::oscltx);
     SpiceDouble _state[6];
     state.CopyTo(_state);
 
@@ -7060,6 +7159,7 @@ void USpice::pckfrm(
     TArray<int>& ids
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pckfrm);
     const int MAXOBJ = 1000;
 
     SPICEINT_CELL(idscell, MAXOBJ);
@@ -7220,6 +7320,7 @@ void USpice::pckcov(
     TArray<FSWindowSegment>& coverage
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pckcov);
     checkcov<pckcov_c>(ResultCode, ErrorMessage, pckFileRelativePath, idcode, merge_to, coverage);
 }
 
@@ -7258,6 +7359,7 @@ void USpice::pcpool_list(
     const TArray<FString>&  cvals
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pcpool_list);
     int32 maxLen = 1;
     for (auto It = cvals.CreateConstIterator(); It; ++It)
     {
@@ -7287,6 +7389,9 @@ void USpice::pcpool_list(
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
+
+    // Drop cached constants this updated
+    MaxQ::ConstantCache::Validate();
 }
 
 void USpice::pcpool(
@@ -7296,6 +7401,7 @@ void USpice::pcpool(
     const FString& cval
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pcpool);
     // Inputs
     auto         _name = StringCast<ANSICHAR>(*name);
     SpiceInt        _n = 1;
@@ -7306,6 +7412,8 @@ void USpice::pcpool(
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
+
+    MaxQ::ConstantCache::Validate();
 }
 
 
@@ -7340,6 +7448,7 @@ void USpice::pdpool_list(
     const TArray<double>& dvals
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pdpool_list);
     if (sizeof(double) == sizeof(ConstSpiceDouble))
     {
         // Inputs
@@ -7362,6 +7471,8 @@ void USpice::pdpool_list(
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
+
+    MaxQ::ConstantCache::Validate();
 }
 
 void USpice::pdpool(
@@ -7371,6 +7482,7 @@ void USpice::pdpool(
     double dval
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pdpool);
     // Inputs
     SpiceInt            _n = 1;
     SpiceDouble _dval = (SpiceDouble)dval;
@@ -7380,6 +7492,8 @@ void USpice::pdpool(
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
+
+    MaxQ::ConstantCache::Validate();
 }
 
 
@@ -7432,6 +7546,7 @@ void USpice::pgrrec(
     double f
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pgrrec);
     // Inputs
     SpiceDouble     _lon = planetographicVec.lonlat.longitude.AsSpiceDouble();
     SpiceDouble     _lat = planetographicVec.lonlat.latitude.AsSpiceDouble();
@@ -7463,6 +7578,7 @@ FSAngle USpice::phaseq(
     ES_AberrationCorrectionWithNewtonians abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::phaseq, target, obsrvr, nullptr);
     // Inputs
     SpiceDouble     _et = et.AsSpiceDouble();
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -7489,11 +7605,13 @@ FSAngle USpice::phaseq(
 
 void USpice::pi(double& pi)
 {
+    MAXQ_SPICE_SCOPE(USpice::pi);
     pi = pi_c();
 }
 
 void USpice::pi_angle(FSAngle& _pi)
 {
+    MAXQ_SPICE_SCOPE(USpice::pi_angle);
     _pi = FSAngle(pi_c());
 }
 
@@ -7529,6 +7647,7 @@ void USpice::pipool_list(
     const TArray<int>& ivals
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pipool_list);
     if (sizeof(int) == sizeof(SpiceInt))
     {
         // Inputs
@@ -7551,6 +7670,8 @@ void USpice::pipool_list(
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
+
+    MaxQ::ConstantCache::Validate();
 }
 
 
@@ -7561,6 +7682,7 @@ void USpice::pipool(
     int ival
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pipool);
     // Inputs
     SpiceInt        _n = 1;
     SpiceInt        _ival = (SpiceInt)ival;
@@ -7570,6 +7692,8 @@ void USpice::pipool(
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
+
+    MaxQ::ConstantCache::Validate();
 }
 
 /*
@@ -7593,6 +7717,7 @@ void USpice::pjelpl(
     FSEllipse& elout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pjelpl);
     // Inputs
     SpiceEllipse _elin;     CopyTo(elin, _elin);
     SpicePlane _plane;      CopyTo(plane, _plane);
@@ -7650,6 +7775,7 @@ void USpice::pl2nvp(
     FSDistanceVector& point
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pl2nvp);
     // Input
     SpicePlane _plane;      CopyTo(plane, _plane);
 
@@ -7690,6 +7816,7 @@ void USpice::pl2psv(
     FSDistanceVector& span2
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pl2psv);
     // Input
     SpicePlane  _plane;     CopyTo(plane, _plane);
     // Output
@@ -7739,6 +7866,7 @@ void USpice::prop2b(
     FSStateVector& pvprop
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::prop2b);
     // Inputs
     SpiceDouble	_gm = gm.AsSpiceDouble();
     SpiceDouble	_pvinit[6]; pvinit.CopyTo(_pvinit);
@@ -7772,6 +7900,7 @@ void USpice::psv2pl(
     FSPlane& plane
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::psv2pl);
     // Inputs
     SpiceDouble	_point[3];	point.CopyTo(_point);
     SpiceDouble	_span1[3];	span1.CopyTo(_span1);
@@ -7798,6 +7927,7 @@ void USpice::pxform(
     const FString& to
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pxform);
     SpiceDouble _rotate[3][3]; rotate.CopyTo(_rotate);
     auto _from = StringCast<ANSICHAR>(*from);
     auto _to = StringCast<ANSICHAR>(*to);
@@ -7817,6 +7947,7 @@ void USpice::pxfrm2(
     const FString& to
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::pxfrm2);
     SpiceDouble _rotate[3][3];
     auto _from = StringCast<ANSICHAR>(*from);
     auto _to = StringCast<ANSICHAR>(*to);
@@ -7833,6 +7964,7 @@ void USpice::radrec(
     FSDistanceVector& rectan
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::radrec);
     SpiceDouble _rectan[3];
     radrec_c(range.km, ra.AsSpiceDouble(), dec.AsSpiceDouble(), _rectan);
     rectan = FSDistanceVector(_rectan);
@@ -7854,6 +7986,7 @@ void USpice::rav2xf(
     FSEulerAngularTransform& xform
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::rav2xf);
     // Inputs
     SpiceDouble    _rot[3][3];          rot.CopyTo(_rot);
     SpiceDouble    _av[3];              av.CopyTo(_av);
@@ -7886,6 +8019,7 @@ void USpice::raxisa(
     FSAngle& angle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::raxisa);
     // Inputs
     SpiceDouble _matrix[3][3];  matrix.CopyTo(_matrix);
     // Outputs
@@ -7922,6 +8056,7 @@ void USpice::recazl(
     bool elplsz
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::recazl);
     SpiceDouble  _rectan[3];  rectan.CopyTo(_rectan);
     SpiceBoolean _azccw = azccw ? SPICETRUE : SPICEFALSE;
     SpiceBoolean _elplsz = elplsz ? SPICETRUE : SPICEFALSE;
@@ -7954,6 +8089,7 @@ void USpice::reccyl(
     FSCylindricalVector& cylvec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::reccyl);
     // Input
     SpiceDouble _rectan[3];
     rectan.CopyTo(_rectan);
@@ -7980,6 +8116,7 @@ void USpice::recgeo(
     double f
     )
 {
+    MAXQ_SPICE_SCOPE(USpice::recgeo);
     SpiceDouble _rectan[3];
     rectan.CopyTo(_rectan);
 
@@ -7999,6 +8136,7 @@ void USpice::reclat(
     FSLatitudinalVector& latvec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::reclat);
     SpiceDouble _rectan[3];
     rectan.CopyTo(_rectan);
 
@@ -8069,6 +8207,7 @@ void USpice::recpgr(
     double                  f
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::recpgr);
     // Inputs
     SpiceDouble      _rectan[3];    rectan.CopyTo(_rectan);
     SpiceDouble     _re             = re.AsSpiceDouble();
@@ -8098,6 +8237,7 @@ void USpice::recrad(
     FSAngle& dec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::recrad);
     SpiceDouble _rectan[3];
     rectan.CopyTo(_rectan);
 
@@ -8118,6 +8258,7 @@ void USpice::recsph(
     FSSphericalVector& vec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::recsph);
     SpiceDouble _rectan[3];
     rectan.CopyTo(_rectan);
 
@@ -8147,6 +8288,7 @@ void USpice::rotate(
     FSRotationMatrix& mout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::rotate);
     // Inputs
     SpiceDouble _angle = angle.AsSpiceDouble();
     SpiceInt    _iaxis = (SpiceInt)iaxis;
@@ -8177,6 +8319,7 @@ void USpice::rotmat(
     FSRotationMatrix& mout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::rotmat);
     // Inputs
     SpiceDouble _m1[3][3];  m1.CopyTo(_m1);
     SpiceDouble _angle;     _angle = angle.AsSpiceDouble();
@@ -8206,6 +8349,7 @@ void USpice::rotvec(
     FSDistanceVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::rotvec);
     // Inputs
     SpiceDouble _v1[3]; v1.CopyTo(_v1);
     SpiceDouble _angle = angle.AsSpiceDouble();
@@ -8227,6 +8371,7 @@ Exceptions
 */
 void USpice::rpd(double& value)
 {
+    MAXQ_SPICE_SCOPE(USpice::rpd);
     SpiceDouble _value = rpd_c();
     value = double(_value);
 }
@@ -8248,6 +8393,7 @@ void USpice::rquad(
     FSComplexScalar& root2
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::rquad);
     // Inputs
     SpiceDouble  _a = a;
     SpiceDouble  _b = b;
@@ -8308,6 +8454,7 @@ void USpice::scdecd(
     FString& sclkch
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::scdecd);
     // Buffers
     SpiceChar szBuffer[SPICE_MAX_PATH];  ZeroOut(szBuffer);
 
@@ -8371,6 +8518,7 @@ void USpice::sce2c(
     double& sclkdp
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sce2c);
     // Inputs
     SpiceInt    _sc = sc;
     SpiceDouble _et = et.AsSpiceDouble();
@@ -8430,6 +8578,7 @@ void USpice::sce2s(
     FString& sclkch
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sce2s);
     // Buffers
     SpiceChar szBuffer[SPICE_MAX_PATH];  ZeroOut(szBuffer);
 
@@ -8494,6 +8643,7 @@ void USpice::sce2t(
     double& clkdp
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sce2t);
     // Inputs
     SpiceInt    _sc = sc;
     SpiceDouble _et = et.AsSpiceDouble();
@@ -8554,6 +8704,7 @@ void USpice::scencd(
     double& sclkdp
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::scencd);
     // Outputs
     SpiceDouble     _sclkdp = 0;
 
@@ -8602,6 +8753,7 @@ void USpice::scfmt(
     FString& clkstr
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::scfmt);
     // Buffers
     SpiceChar szBuffer[SPICE_MAX_PATH];  ZeroOut(szBuffer);
 
@@ -8641,6 +8793,7 @@ void USpice::scpart(
     TArray<double>& pstop
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::scpart);
     const int MXPART = 9999;
     // Inputs
     SpiceInt    _sc = sc;
@@ -8706,6 +8859,7 @@ void USpice::scs2e(
     FSEphemerisTime& et
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::scs2e);
     // Outputs
     SpiceDouble     _et = 0;
 
@@ -8762,6 +8916,7 @@ void USpice::sct2e(
     FSEphemerisTime& et
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sct2e);
     // Inputs
     SpiceInt    _sc = sc;
     SpiceDouble _sclkdp = sclkdp;
@@ -8799,6 +8954,7 @@ void USpice::sctiks(
     double& ticks
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sctiks);
     // Outputs
     SpiceDouble _ticks = 0;
 
@@ -8822,6 +8978,7 @@ void USpice::shelld(
     TArray<double>& OutDoubleArray
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::shelld);
     // You know what they say about assumptions.
     check(sizeof(double) == sizeof(SpiceDouble));
     
@@ -8836,6 +8993,7 @@ void USpice::shelld_ByIndex(
     TArray<int>& Order
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::shelld_ByIndex);
     check(sizeof(double) == sizeof(SpiceDouble));
 
     SpiceInt ndim = DoubleArray.Num();
@@ -8958,6 +9116,7 @@ void USpice::sincpt(
     ES_AberrationCorrectionWithTransmissions abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::sincpt, target, obsrvr, fixref);
     // Inputs
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, shapeSurfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -9007,6 +9166,7 @@ Exceptions
 */
 void USpice::spd(double& value)
 {
+    MAXQ_SPICE_SCOPE(USpice::spd);
     SpiceDouble _value = spd_c();
     value = double(_value);
 }
@@ -9021,6 +9181,7 @@ void USpice::sphcyl(
     FSCylindricalVector& cylvec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sphcyl);
     // Inputs
     SpiceDouble _radius = sphvec.r.AsSpiceDouble();
     SpiceDouble _colat = sphvec.colat.AsSpiceDouble();
@@ -9052,6 +9213,7 @@ void USpice::sphlat(
     FSLatitudinalVector& latvec
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sphlat);
     // Input
     SpiceDouble _radius = sphvec.r.AsSpiceDouble();
     SpiceDouble _colat = sphvec.colat.AsSpiceDouble();
@@ -9082,6 +9244,7 @@ void USpice::sphrec(
     FSDistanceVector& rectan
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sphrec);
     // Input
     SpiceDouble _r = sphvec.r.AsSpiceDouble();
     SpiceDouble _colat = sphvec.colat.AsSpiceDouble();
@@ -9109,6 +9272,7 @@ void USpice::spkcls(
     int handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::spkcls);
     // Inputs
     SpiceInt _handle = handle;
 
@@ -9160,6 +9324,7 @@ void USpice::spkcov(
     TArray<FSWindowSegment>& coverage
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::spkcov);
     checkcov<spkcov_c>(ResultCode, ErrorMessage, spkFileRelativePath, idcode, merge_to, coverage);
 }
 
@@ -9215,6 +9380,7 @@ void USpice::spkcpo(
     abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkcpo, target, nullptr, outref);
     // Inputs
     auto            _target = StringCast<ANSICHAR>(*target);
     SpiceDouble     _et = et.AsSpiceDouble();
@@ -9302,6 +9468,7 @@ void USpice::spkcpt(
     abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkcpt, nullptr, obsrvr, outref);
     // Inputs
     SpiceDouble     _trgpos[3]; trgpos.CopyTo(_trgpos);
     auto            _trgctr = StringCast<ANSICHAR>(*trgctr);
@@ -9390,6 +9557,7 @@ void USpice::spkcvo(
     abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkcvo, target, nullptr, outref);
     // Inputs
     auto            _target = StringCast<ANSICHAR>(*target);
     SpiceDouble     _et = et.AsSpiceDouble();
@@ -9479,6 +9647,7 @@ void USpice::spkcvt(
     abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkcvt, nullptr, obsrvr, outref);
     // Inputs
     SpiceDouble     _trgsta[6]; trgsta.CopyTo(_trgsta);
     SpiceDouble     _trgepc = trgepc.AsSpiceDouble();
@@ -9546,6 +9715,7 @@ void USpice::spkezp(
     ES_AberrationCorrectionWithNewtonians abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkezp, targ, obs, ref);
     SpiceDouble _lt = 0;
     SpiceDouble _ptarg[3];
     ZeroOut(_ptarg);
@@ -9589,6 +9759,7 @@ void USpice::spkezr(
     ES_AberrationCorrectionWithNewtonians abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkezr, targ, obs, ref);
     // #Note (USpice, in general)
     // Outputs, but initialize the values to whatever the caller passed in.
     // We want to return whatever spice returns.  But if Spice doesn't change the value, we don't want to, either
@@ -9628,6 +9799,7 @@ void USpice::spkgeo(
     const FString& ref
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkgeo, targ, obs, ref);
     SpiceDouble _lt = 0;
     SpiceDouble _state[6];
     ZeroOut(_state);
@@ -9658,6 +9830,7 @@ void USpice::spkgps(
     const FString& ref
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkgps, targ, obs, ref);
     SpiceDouble _lt = 0;
     SpiceDouble _pos[3];
     ZeroOut(_pos);
@@ -9700,6 +9873,7 @@ void USpice::spkpos(
     ES_AberrationCorrectionWithNewtonians abcorr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkpos, targ, obs, ref);
     SpiceDouble _lt = lt.AsSpiceDouble();
     SpiceDouble _ptarg[3];  ptarg.CopyTo(_ptarg);
     ZeroOut(_ptarg);
@@ -9739,6 +9913,7 @@ void USpice::spklef(
     int& handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::spklef);
     // Output
     SpiceInt        _handle = 0;
 
@@ -9788,6 +9963,7 @@ void USpice::spkobj(
     TArray<int>& ids
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::spkobj);
     constexpr int MAXOBJ = 1000;
 
     SPICEINT_CELL(idscell, MAXOBJ);
@@ -9839,6 +10015,7 @@ void USpice::spkopa(
     int& handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::spkopa);
     // Output
     SpiceInt _handle = 0;
 
@@ -9877,6 +10054,7 @@ void USpice::spkopn(
     int& handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::spkopn);
     // Inputs
     auto _file = StringCast<ANSICHAR>(*toPath(relativePath));
 
@@ -9906,6 +10084,7 @@ void USpice::spkuef(
     int handle
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::spkuef);
     // Input
     SpiceInt _handle = handle;
 
@@ -9928,6 +10107,7 @@ void USpice::spkw05(
     const TArray<FSPKType5Observation>& states
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkw05, nullptr, nullptr, frame);
     // Inputs
     SpiceInt         _handle = handle;
     SpiceInt         _body = body;
@@ -9980,6 +10160,7 @@ void USpice::spkw15(
     const FSPKType15Observation& state
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkw15, nullptr, nullptr, frame);
     // Inputs
     SpiceInt    _handle = handle;
     SpiceInt    _body = body;
@@ -10016,6 +10197,7 @@ void USpice::srfc2s(
     int   bodyid
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::srfc2s);
     // Buffer
     SpiceChar szBuffer[SPICE_SRF_SFNMLN];
     ZeroOut(szBuffer);
@@ -10083,6 +10265,7 @@ void USpice::srfcss(
     const FString& bodstr
     )
 {
+    MAXQ_SPICE_SCOPE(USpice::srfcss);
     // Buffer
     SpiceChar szBuffer[SPICE_SRF_SFNMLN];
     ZeroOut(szBuffer);
@@ -10181,6 +10364,7 @@ void USpice::srfnrm(
     const FString& fixref
     )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::srfnrm, target, nullptr, fixref);
     // Input
     auto        _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, shapeSurfaces));
     auto        _target = StringCast<ANSICHAR>(*target);
@@ -10259,6 +10443,7 @@ void USpice::srfs2c(
     const FString& bodstr
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::srfs2c);
     // Inputs
     auto _srfstr = StringCast<ANSICHAR>(*srfstr);
     auto _bodstr = StringCast<ANSICHAR>(*bodstr);
@@ -10308,6 +10493,7 @@ void USpice::srfscc(
     int bodyid
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::srfscc);
     // Output
     SpiceInt        _code = 0;
     SpiceBoolean    _found = SPICEFALSE;
@@ -10348,6 +10534,7 @@ void USpice::subpnt(
     const FString& obsrvr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::subpnt, target, obsrvr, fixref);
     // Input
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, surfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -10403,6 +10590,7 @@ void USpice::subslr(
     const FString& obsrvr
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::subslr, target, obsrvr, fixref);
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, surfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
     SpiceDouble     _et = et.AsSpiceDouble();
@@ -10452,6 +10640,7 @@ void USpice::surfnm(
     FSDimensionlessVector& normal
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::surfnm);
     // Input
     SpiceDouble        _a = a.AsSpiceDouble();
     SpiceDouble        _b = b.AsSpiceDouble();
@@ -10491,6 +10680,7 @@ void USpice::surfpt(
     bool& bFound
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::surfpt);
     // Input
     SpiceDouble _positn[3]; positn.CopyTo(_positn);
     SpiceDouble _u[3];      u.CopyTo(_u);
@@ -10532,6 +10722,7 @@ void USpice::sxform(
     const FString& to
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::sxform);
     // Input
     auto _from = StringCast<ANSICHAR>(*from);
     auto _to   = StringCast<ANSICHAR>(*to);
@@ -10577,6 +10768,7 @@ void USpice::termpt(
     int              maxn
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::termpt, target, obsrvr, fixref);
     // Inputs
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(shadow, curveType, method, shapeSurfaces));
     auto            _ilusrc = StringCast<ANSICHAR>(*ilusrc);
@@ -10707,6 +10899,7 @@ void USpice::tisbod(
     const FString& ref
 )
 {
+    MAXQ_SPICE_SCOPE_TAGGED(USpice::tisbod, nullptr, nullptr, ref);
     // Input
     SpiceInt        _body = body;
     SpiceDouble     _et = et.AsSpiceDouble();
@@ -10736,6 +10929,7 @@ void USpice::tpictr(
     const FString& sample
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::tpictr);
     // Buffers
     SpiceChar szPictur[SPICE_MAX_PATH];
     ZeroOut(szPictur);
@@ -10785,6 +10979,7 @@ void USpice::trace(
     double& trace
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::trace);
     SpiceDouble  _matrix[3][3];
     matrix.CopyTo(_matrix);
 
@@ -10802,12 +10997,14 @@ void USpice::twopi(
     double& two_pi
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::twopi);
     two_pi = twopi_c();
 }
 
 
 void USpice::twopi_angle(FSAngle& two_pi)
 {
+    MAXQ_SPICE_SCOPE(USpice::twopi_angle);
     two_pi = FSAngle(twopi_c());
 }
 
@@ -10833,6 +11030,7 @@ void USpice::twovec(
     FSRotationMatrix& mout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::twovec);
     // Input
     SpiceDouble _axdef[3];  axdef.CopyTo(_axdef);
     SpiceInt    _indexa = (SpiceInt)indexa;
@@ -10889,6 +11087,7 @@ void USpice::uddf(
     double& deriv
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::uddf);
     // Inputs
     void (*_udfunc) (SpiceDouble et, SpiceDouble * value) = __udfunc;
     SpiceDouble _x = x;
@@ -10941,6 +11140,7 @@ void USpice::unitim(
     ES_TimeScale outsys
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::unitim);
     // Inputs
     SpiceDouble     _epoch = epoch;
     ConstSpiceChar* _insys = MaxQ::Core::ToANSIString(insys);
@@ -11028,6 +11228,15 @@ void USpice::utc2et(
     FSEphemerisTime& et
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::utc2et);
+    // ISO-8601 UTC natively, anything else through utc2et_c
+    if (MaxQ::Time::TryStr2Et(utcstr, et))
+    {
+        ResultCode = ES_ResultCode::Success;
+        ErrorMessage.Empty();
+        return;
+    }
+
     // Output
     SpiceDouble _et = 0;
 
@@ -11095,6 +11304,7 @@ void USpice::vcrss(
     FSDimensionlessVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vcrss);
     // Inputs
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     SpiceDouble _v2[3];     v2.CopyTo(_v2);
@@ -11117,6 +11327,7 @@ void USpice::vdist(
     double& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vdist);
     // Inputs
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     SpiceDouble _v2[3];     v2.CopyTo(_v2);
@@ -11137,6 +11348,7 @@ void USpice::vdist_distance(
     FSDistance& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vdist_distance);
     // Inputs
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     SpiceDouble _v2[3];     v2.CopyTo(_v2);
@@ -11155,6 +11367,7 @@ void USpice::vdist_velocity(
     FSSpeed& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vdist_velocity);
     // Inputs
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     SpiceDouble _v2[3];     v2.CopyTo(_v2);
@@ -11179,6 +11392,7 @@ void USpice::vdot(
     double& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vdot);
     // Inputs
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     SpiceDouble _v2[3];     v2.CopyTo(_v2);
@@ -11197,6 +11411,7 @@ void USpice::vdot_distance(
     FSDistance& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vdot_distance);
     // Inputs
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     SpiceDouble _v2[3];     v2.CopyTo(_v2);
@@ -11215,6 +11430,7 @@ void USpice::vdot_velocity(
     FSSpeed& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vdot_velocity);
     // Inputs
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     SpiceDouble _v2[3];     v2.CopyTo(_v2);
@@ -11239,6 +11455,7 @@ void USpice::vequ(
     FSDimensionlessVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vequ);
     // Input
     SpiceDouble _vin[3];
     vin.CopyTo(_vin);
@@ -11257,6 +11474,7 @@ void USpice::vequ_distance(
     FSDistanceVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vequ_distance);
     // Input
     SpiceDouble _vin[3];
     vin.CopyTo(_vin);
@@ -11275,6 +11493,7 @@ void USpice::vequ_velocity(
     FSVelocityVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vequ_velocity);
     // Input
     SpiceDouble _vin[3];
     vin.CopyTo(_vin);
@@ -11293,6 +11512,7 @@ void USpice::vequ_angular_velocity(
     FSAngularVelocity& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vequ_angular_velocity);
     // Input
     SpiceDouble _vin[3];
     vin.CopyTo(_vin);
@@ -11319,6 +11539,7 @@ void USpice::vhat(
     FSDimensionlessVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vhat);
     // Input
     SpiceDouble  _v1[3];
     v1.CopyTo(_v1);
@@ -11336,6 +11557,7 @@ void USpice::vhat_distance(
     FSDimensionlessVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vhat_distance);
     // Input
     SpiceDouble  _v1[3];
     v1.CopyTo(_v1);
@@ -11353,6 +11575,7 @@ void USpice::vhat_velocity(
     FSDimensionlessVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vhat_velocity);
     // Input
     SpiceDouble  _v1[3];
     v1.CopyTo(_v1);
@@ -11370,6 +11593,7 @@ void USpice::vhat_angular_velocity(
     FSDimensionlessVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vhat_angular_velocity);
     // Input
     SpiceDouble  _v1[3];
     v1.CopyTo(_v1);
@@ -11479,6 +11703,7 @@ void USpice::vnorm(
     double& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vnorm);
     // Input
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     // Output
@@ -11500,6 +11725,7 @@ void USpice::vnorm_distance(
     FSDistance& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vnorm_distance);
     // Input
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     // Output
@@ -11521,6 +11747,7 @@ void USpice::vnorm_velocity(
     FSSpeed& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vnorm_velocity);
     // Input
     SpiceDouble _v1[3];     v1.CopyTo(_v1);
     // Output
@@ -11589,6 +11816,7 @@ void USpice::vperp(
     FSDimensionlessVector& p
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vperp);
     // Input
     SpiceDouble _a[3]; a.CopyTo(_a);
     SpiceDouble _b[3]; b.CopyTo(_b);
@@ -11616,6 +11844,7 @@ void USpice::vprjp(
     FSDimensionlessVector& vout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vprjp);
     // Input
     SpiceDouble _vin[3];    vin.CopyTo(_vin);
     SpicePlane  _plane;     CopyTo(plane, _plane);
@@ -11643,6 +11872,7 @@ void USpice::vproj(
     FSDimensionlessVector& p
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vproj);
     // Input
     SpiceDouble _a[3]; a.CopyTo(_a);
     SpiceDouble _b[3]; b.CopyTo(_b);
@@ -11669,6 +11899,7 @@ void USpice::vrel(
     double& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vrel);
     // Input
     SpiceDouble _v1[3]; v1.CopyTo(_v1);
     SpiceDouble _v2[3]; v2.CopyTo(_v2);
@@ -11696,6 +11927,7 @@ void USpice::vrotv(
     FSDimensionlessVector& r
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vrotv);
     // Inputs
     SpiceDouble _v[3];      v.CopyTo(_v);
     SpiceDouble _axis[3];   axis.CopyTo(_axis);
@@ -11772,6 +12004,7 @@ void USpice::vsep(
     FSAngle& out
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vsep);
     // Inputs
     SpiceDouble _v1[3]; v1.CopyTo(_v1);
     SpiceDouble _v2[3]; v2.CopyTo(_v2);
@@ -11821,6 +12054,7 @@ double  USpice::vtmv(
     const FSDimensionlessVector& v2
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vtmv);
     // Inputs
     SpiceDouble _v1[3]; v1.CopyTo(_v1);
     SpiceDouble _matrix[3][3];	matrix.CopyTo(_matrix);
@@ -11890,6 +12124,7 @@ void USpice::vzero(
     bool& is_zero
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::vzero);
     // Input
     SpiceDouble _v[3];  v.CopyTo(_v);
     // Output
@@ -11936,6 +12171,7 @@ void USpice::xf2eul(
     ES_Axis axis1
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::xf2eul);
     // Inputs
     SpiceDouble		 _xform[6][6];	xform.CopyTo(_xform);
     SpiceInt		_axisa = (SpiceInt)axis3;
@@ -11970,6 +12206,7 @@ void USpice::xf2rav(
     FSAngularVelocity& av
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::xf2rav);
     // Input
     SpiceDouble _xform[6][6];   xform.CopyTo(_xform);
     // Outputs
@@ -12043,6 +12280,7 @@ void USpice::xfmsta(
     const FString& body
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::xfmsta);
     // Inputs
     SpiceDouble     _input_state[6];
     in.CopyTo(_input_state);
@@ -12071,6 +12309,7 @@ void USpice::xpose(
     FSRotationMatrix& mout
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::xpose);
     // Input
     SpiceDouble _m1[3][3];
     m1.CopyTo(_m1);
@@ -12100,6 +12339,7 @@ void USpice::get_implied_result(
 
 void USpice::raise_spice_error(const FString& ErrorMessage /*= TEXT("This is a test error.")*/, const FString& SpiceError /*= TEXT("SPICE(VALUEOUTOFRANGE)")*/)
 {
+    MAXQ_SPICE_SCOPE(USpice::raise_spice_error);
     setmsg_c(TCHAR_TO_ANSI(*ErrorMessage));
     sigerr_c(TCHAR_TO_ANSI(*SpiceError));
 }
@@ -12109,7 +12349,9 @@ void USpice::furnsh_absolute(
     const FString& absolutePath
 )
 {
+    MAXQ_SPICE_SCOPE(USpice::furnsh_absolute);
     furnsh_c(TCHAR_TO_ANSI(*absolutePath));
+    OnKernelsChanged();
 }
 
 
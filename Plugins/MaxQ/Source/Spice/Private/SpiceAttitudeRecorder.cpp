@@ -0,0 +1,653 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceAttitudeRecorder.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Recording live attitude to CK files, a segment at a time
+//
+// Push is the ring's producer, the sealer thread its consumer (see
+// SpiceRecording.h).  Sealed segments carry ETs and interpolation interval
+// starts as sample indices; the game thread encodes them as SCLK when it
+// writes them, since sce2c needs the kernel pool.
+//
+// ckw03_c is called directly rather than through USpice::ckw03, which
+// copies records through FSPointingType1Observation and stack-allocates
+// its arrays; a 10,000 sample segment would be ~640KB of stack.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceAttitudeRecorder.cpp is part of the "refined Blueprints API".
+//------------------------------------------------------------------------------
+
+#include "SpiceAttitudeRecorder.h"
+#include "Components/PrimitiveComponent.h"
+#include "Containers/Queue.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "SpiceClock.h"
+#include "SpiceCore.h"
+#include "SpiceLog.h"
+#include "SpiceRecording.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using MaxQ::Core::ToANSIString;
+
+    struct FSample
+    {
+        double Et;
+        double Quat[4];
+        double Av[3];
+    };
+
+    struct FSegment
+    {
+        TArray<double> Epochs;
+        TArray<double> Quats;       // 4 per epoch
+        TArray<double> Avs;         // 3 per epoch
+        TArray<int32> Starts;       // Interpolation intervals' first samples
+    };
+}
+
+
+namespace MaxQ::Recording
+{
+    struct FAttitudeWriter::FState
+    {
+        FAttitudeWriterSettings Settings;
+        FString Path;
+
+        TSampleRing<FSample> Ring;
+
+        // Sealer thread only:  samples since the last seal, and where their
+        // interpolation intervals start
+        TArray<FSample> Run;
+        TArray<int32> Starts;
+
+        TQueue<FSegment, EQueueMode::Spsc> Sealed;
+
+        std::atomic<int64> Samples{ 0 };
+        std::atomic<int64> Dropped{ 0 };
+        std::atomic<int64> Skipped{ 0 };
+
+        // Game thread only
+        int32 Segments = 0;
+        bool bCreated = false;
+        TArray<double> Sclk;
+        TArray<double> StartSclk;
+
+        // Moves what's in the ring into Run, sealing wherever a segment must end
+        void Drain()
+        {
+            Ring.Drain([this](const FSample& Pushed)
+            {
+                FSample Sample = Pushed;
+
+                const double Norm = FMath::Sqrt(Sample.Quat[0] * Sample.Quat[0] + Sample.Quat[1] * Sample.Quat[1] + Sample.Quat[2] * Sample.Quat[2] + Sample.Quat[3] * Sample.Quat[3]);
+                const double Scale = Norm > 0. ? 1. / Norm : 0.;
+                for (double& q : Sample.Quat)
+                {
+                    q *= Scale;
+                }
+
+                if (Run.Num() > 0)
+                {
+                    const FSample& Last = Run.Last();
+                    if (Sample.Et == Last.Et)
+                    {
+                        ++Skipped;
+                        return;
+                    }
+
+                    if (Sample.Et < Last.Et)
+                    {
+                        Seal();
+                        Run.Reset();
+                        Starts.Reset();
+                    }
+                    else if (Settings.MaxGapSeconds > 0. && Sample.Et - Last.Et > Settings.MaxGapSeconds)
+                    {
+                        Starts.Add(Run.Num());
+                    }
+                }
+
+                // Same hemisphere as the sample before, so interpolating
+                // between them takes the short way around
+                if (Run.Num() > 0)
+                {
+                    const double(&Previous)[4] = Run.Last().Quat;
+                    const double Dot = Previous[0] * Sample.Quat[0] + Previous[1] * Sample.Quat[1] + Previous[2] * Sample.Quat[2] + Previous[3] * Sample.Quat[3];
+                    if (Dot < 0.)
+                    {
+                        for (double& q : Sample.Quat)
+                        {
+                            q = -q;
+                        }
+                    }
+                }
+
+                if (Run.Num() == 0)
+                {
+                    Starts.Reset();
+                    Starts.Add(0);
+                }
+                Run.Add(Sample);
+
+                if (Run.Num() >= Settings.MaxSegmentSamples)
+                {
+                    Seal();
+                }
+            });
+        }
+
+        // Queues Run as a segment, keeping its last sample to start the next
+        void Seal()
+        {
+            const int32 n = Run.Num();
+            if (n < 2)
+            {
+                return;
+            }
+
+            FSegment Segment;
+            Segment.Epochs.SetNumUninitialized(n);
+            Segment.Quats.SetNumUninitialized(4 * n);
+            Segment.Avs.SetNumUninitialized(3 * n);
+            for (int32 i = 0; i < n; ++i)
+            {
+                Segment.Epochs[i] = Run[i].Et;
+                FMemory::Memcpy(&Segment.Quats[4 * i], Run[i].Quat, sizeof(Run[i].Quat));
+                FMemory::Memcpy(&Segment.Avs[3 * i], Run[i].Av, sizeof(Run[i].Av));
+            }
+            Segment.Starts = Starts;
+            Sealed.Enqueue(MoveTemp(Segment));
+
+            // An interval starting at the last sample begins the next segment
+            const FSample Last = Run.Last();
+            Run.Reset();
+            Run.Add(Last);
+            Starts.Reset();
+            Starts.Add(0);
+        }
+
+        // Encodes Segment's epochs as SCLK, dropping samples that land on
+        // the same tick as the one before.  Game thread.
+        void Encode(FSegment& Segment)
+        {
+            const int32 n = Segment.Epochs.Num();
+            Sclk.Reset(n);
+            StartSclk.Reset(Segment.Starts.Num());
+
+            int32 Kept = 0;
+            int32 NextStart = 0;
+            bool bStartPending = false;
+            for (int32 i = 0; i < n && !failed_c(); ++i)
+            {
+                if (NextStart < Segment.Starts.Num() && Segment.Starts[NextStart] == i)
+                {
+                    bStartPending = true;
+                    ++NextStart;
+                }
+
+                SpiceDouble _sclkdp = 0.;
+                sce2c_c(Settings.Spacecraft, Segment.Epochs[i], &_sclkdp);
+                if (Kept > 0 && _sclkdp <= Sclk.Last())
+                {
+                    ++Skipped;
+                    continue;
+                }
+
+                if (bStartPending)
+                {
+                    StartSclk.Add(_sclkdp);
+                    bStartPending = false;
+                }
+
+                Sclk.Add(_sclkdp);
+                if (Kept != i)
+                {
+                    FMemory::Memcpy(&Segment.Quats[4 * Kept], &Segment.Quats[4 * i], 4 * sizeof(double));
+                    FMemory::Memcpy(&Segment.Avs[3 * Kept], &Segment.Avs[3 * i], 3 * sizeof(double));
+                }
+                ++Kept;
+            }
+        }
+    };
+
+
+    TSharedPtr<FAttitudeWriter> FAttitudeWriter::Open(const FAttitudeWriterSettings& Settings, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Recording::FAttitudeWriter::Open);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        SpiceInt _frcode = 0;
+        namfrm_c(ToANSIString(Settings.Frame), &_frcode);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return nullptr;
+        }
+
+        FString Problem;
+        if (Settings.File.IsEmpty())
+        {
+            Problem = TEXT("No file name");
+        }
+        else if (_frcode == 0)
+        {
+            Problem = FString::Printf(TEXT("Unknown frame %s"), *Settings.Frame.ToString());
+        }
+        else if (Settings.BufferCapacity < 2 || Settings.MaxSegmentSamples < 2 || Settings.FlushSeconds <= 0.)
+        {
+            Problem = TEXT("Buffer capacity and segment samples must be at least 2, flush seconds positive");
+        }
+
+        if (!Problem.IsEmpty())
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = Problem;
+            return nullptr;
+        }
+
+        TSharedPtr<FAttitudeWriter> Writer(new FAttitudeWriter());
+        Writer->State = MakeShared<FState, ESPMode::ThreadSafe>();
+        FState& State = *Writer->State;
+        State.Settings = Settings;
+        State.Path = toPath(Settings.File);
+        State.Ring.Init(Settings.BufferCapacity);
+        State.Run.Reserve(FMath::Min(Settings.MaxSegmentSamples, Settings.BufferCapacity));
+
+        TSharedPtr<FState, ESPMode::ThreadSafe> SealerState = Writer->State;
+        Writer->Sealer = MakeUnique<FRecordingThread>(Settings.FlushSeconds, [SealerState]()
+        {
+            SealerState->Drain();
+            SealerState->Seal();
+        });
+        if (!Writer->Sealer->Start(TEXT("MaxQAttitudeSealer")))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Could not start the sealer thread");
+            return nullptr;
+        }
+
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+        return Writer;
+    }
+
+
+    FAttitudeWriter::~FAttitudeWriter()
+    {
+        StopThread();
+    }
+
+
+    void FAttitudeWriter::StopThread()
+    {
+        if (Sealer)
+        {
+            Sealer->Shutdown();
+        }
+    }
+
+
+    bool FAttitudeWriter::Push(const FSEphemerisTime& et, const FSQuaternion& quat, const FSAngularVelocity& av)
+    {
+        if (!IsOpen())
+        {
+            return false;
+        }
+
+        FSample Sample;
+        Sample.Et = et.seconds;
+        quat.CopyTo(Sample.Quat);
+        av.CopyTo(Sample.Av);
+
+        bool bHalfFull = false;
+        const bool bPushed = State->Ring.Push(Sample, bHalfFull);
+        if (bPushed)
+        {
+            ++State->Samples;
+        }
+        else
+        {
+            ++State->Dropped;
+        }
+
+        // Don't wait out the flush interval with the ring half full
+        if (bHalfFull)
+        {
+            Sealer->Wake();
+        }
+        return bPushed;
+    }
+
+
+    void FAttitudeWriter::Flush()
+    {
+        if (IsOpen())
+        {
+            Sealer->Wake();
+        }
+    }
+
+
+    int32 FAttitudeWriter::Write(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Recording::FAttitudeWriter::Write);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+
+        FState& S = *State;
+        if (S.Sealed.IsEmpty())
+        {
+            return 0;
+        }
+
+        const FAttitudeWriterSettings& Settings = S.Settings;
+
+        // A new recording replaces the file, unless appending.  After that,
+        // every batch appends.
+        if (!S.bCreated && !Settings.bAppend && FPaths::FileExists(S.Path))
+        {
+            IFileManager::Get().Delete(*S.Path);
+        }
+
+        auto _path = StringCast<ANSICHAR>(*S.Path);
+        SpiceInt _handle = 0;
+        if (FPaths::FileExists(S.Path))
+        {
+            dafopw_c(_path.Get(), &_handle);
+        }
+        else
+        {
+            ckopn_c(_path.Get(), "MAXQ ATTITUDE RECORDING", 0, &_handle);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return 0;
+        }
+        S.bCreated = true;
+
+        auto _segid = StringCast<ANSICHAR>(*Settings.SegmentId);
+        const ANSICHAR* _ref = ToANSIString(Settings.Frame);
+        const SpiceBoolean _avflag = Settings.bAngularVelocity ? SPICETRUE : SPICEFALSE;
+
+        int32 Written = 0;
+        FSegment Segment;
+        while (!failed_c() && S.Sealed.Dequeue(Segment))
+        {
+            S.Encode(Segment);
+
+            const int32 n = S.Sclk.Num();
+            if (failed_c() || n < 1)
+            {
+                continue;
+            }
+
+            const ConstSpiceDouble (*_quats)[4] = reinterpret_cast<const SpiceDouble(*)[4]>(Segment.Quats.GetData());
+            const ConstSpiceDouble (*_avvs)[3] = reinterpret_cast<const SpiceDouble(*)[3]>(Segment.Avs.GetData());
+            ckw03_c(_handle, S.Sclk[0], S.Sclk.Last(), Settings.Instrument, _ref, _avflag, _segid.Get(), n, S.Sclk.GetData(), _quats, _avvs, S.StartSclk.Num(), S.StartSclk.GetData());
+
+            Written += !failed_c();
+        }
+
+        // Close even after a failed write, so what was written stays readable
+        const bool bFailed = ErrorCheck(ResultCode, ErrorMessage) != 0;
+        ckcls_c(_handle);
+        if (bFailed)
+        {
+            ES_ResultCode IgnoredResultCode;
+            FString IgnoredErrorMessage;
+            ErrorCheck(IgnoredResultCode, IgnoredErrorMessage, true);
+        }
+        else
+        {
+            ErrorCheck(ResultCode, ErrorMessage);
+        }
+
+        S.Segments += Written;
+        return Written;
+    }
+
+
+    void FAttitudeWriter::Close(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        StopThread();
+        Write(ResultCode, ErrorMessage);
+    }
+
+
+    bool FAttitudeWriter::IsOpen() const
+    {
+        return Sealer && Sealer->IsRunning();
+    }
+
+
+    FAttitudeWriterStats FAttitudeWriter::GetStats() const
+    {
+        FAttitudeWriterStats Stats;
+        Stats.Samples = State->Samples;
+        Stats.Dropped = State->Dropped;
+        Stats.Skipped = State->Skipped;
+        Stats.Segments = State->Segments;
+        return Stats;
+    }
+
+
+    const FString& FAttitudeWriter::GetPath() const
+    {
+        return State->Path;
+    }
+}
+
+
+USpiceAttitudeRecorder::USpiceAttitudeRecorder()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = true;
+
+    // Sample where the owner ended up this frame
+    PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+
+void USpiceAttitudeRecorder::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (bRecordOnBeginPlay)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        StartRecording(ResultCode, ErrorMessage);
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("USpiceAttitudeRecorder (%s) could not start: %s"), *GetNameSafe(GetOwner()), *ErrorMessage);
+        }
+    }
+}
+
+
+void USpiceAttitudeRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (IsRecording())
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        StopRecording(ResultCode, ErrorMessage);
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("USpiceAttitudeRecorder (%s) failed writing %s: %s"), *GetNameSafe(GetOwner()), *File, *ErrorMessage);
+        }
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+void USpiceAttitudeRecorder::StartRecording(ES_ResultCode& ResultCode, FString& ErrorMessage)
+{
+    if (IsRecording())
+    {
+        StopRecording(ResultCode, ErrorMessage);
+    }
+
+    MaxQ::Recording::FAttitudeWriterSettings Settings;
+    Settings.File = File;
+    Settings.bAppend = bAppend;
+    Settings.Instrument = Instrument;
+    Settings.Spacecraft = Spacecraft;
+    Settings.Frame = Frame;
+    Settings.bAngularVelocity = bRecordAngularVelocity;
+    Settings.BufferCapacity = BufferCapacity;
+    Settings.FlushSeconds = FlushSeconds;
+    Settings.MaxGapSeconds = MaxGapSeconds;
+
+    Writer = MaxQ::Recording::FAttitudeWriter::Open(Settings, &ResultCode, &ErrorMessage);
+
+    RecordingStartWorldSeconds = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.;
+    bSampled = false;
+    bHasPreviousRotation = false;
+}
+
+
+void USpiceAttitudeRecorder::StopRecording(ES_ResultCode& ResultCode, FString& ErrorMessage)
+{
+    ResultCode = ES_ResultCode::Success;
+    ErrorMessage.Empty();
+
+    if (Writer)
+    {
+        Writer->Close(&ResultCode, &ErrorMessage);
+        LastStats = Writer->GetStats();
+        Writer.Reset();
+    }
+}
+
+
+void USpiceAttitudeRecorder::Flush()
+{
+    if (Writer)
+    {
+        Writer->Flush();
+    }
+}
+
+
+void USpiceAttitudeRecorder::GetRecordingStats(int64& Samples, int64& Dropped, int& Segments) const
+{
+    const MaxQ::Recording::FAttitudeWriterStats Stats = Writer ? Writer->GetStats() : LastStats;
+    Samples = Stats.Samples;
+    Dropped = Stats.Dropped;
+    Segments = Stats.Segments;
+}
+
+
+void USpiceAttitudeRecorder::GetAttitudeToRecord_Implementation(const FSEphemerisTime& et, FSQuaternion& quat, FSAngularVelocity& av)
+{
+    const AActor* Owner = GetOwner();
+    if (!Owner)
+    {
+        quat = FSQuaternion::Identity;
+        av = FSAngularVelocity();
+        return;
+    }
+
+    // The actor's rotation takes its axes to the world's, the C-matrix the
+    // world's (Frame's) to the instrument's
+    const FQuat Rotation = Owner->GetActorQuat();
+    quat = FSQuaternion::Swizzle(Rotation.Inverse());
+
+    // World angular velocity, radians per ET second
+    FVector Omega = FVector::ZeroVector;
+    const UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(Owner->GetRootComponent());
+    if (Root && Root->IsSimulatingPhysics())
+    {
+        const UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this);
+        const double EtPerSecond = Clock && Clock->GetTimeScale() != 0. ? Clock->GetTimeScale() : 1.;
+        Omega = Root->GetPhysicsAngularVelocityInRadians() / EtPerSecond;
+    }
+    else if (bHasPreviousRotation && et.seconds != PreviousRotationEt)
+    {
+        FVector Axis;
+        double Angle;
+        (Rotation * PreviousRotation.Inverse()).GetShortestArcWith(FQuat::Identity).ToAxisAndAngle(Axis, Angle);
+        Omega = Axis * (Angle / (et.seconds - PreviousRotationEt));
+    }
+
+    PreviousRotation = Rotation;
+    PreviousRotationEt = et.seconds;
+    bHasPreviousRotation = true;
+
+    av = FSAngularVelocity::Swizzle(Omega);
+}
+
+
+void USpiceAttitudeRecorder::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (!Writer)
+    {
+        return;
+    }
+
+    const FSEphemerisTime et = GetRecordingEt();
+    if (!bSampled || FMath::Abs(et.seconds - LastSampleEt) >= SampleInterval)
+    {
+        FSQuaternion quat;
+        FSAngularVelocity av;
+        GetAttitudeToRecord(et, quat, av);
+        Writer->Push(et, quat, av);
+        LastSampleEt = et.seconds;
+        bSampled = true;
+    }
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    Writer->Write(&ResultCode, &ErrorMessage);
+    if (ResultCode != ES_ResultCode::Success)
+    {
+        UE_LOG(LogSpice, Warning, TEXT("USpiceAttitudeRecorder (%s) failed writing %s: %s"), *GetNameSafe(GetOwner()), *File, *ErrorMessage);
+    }
+}
+
+
+FSEphemerisTime USpiceAttitudeRecorder::GetRecordingEt() const
+{
+    if (const UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this))
+    {
+        return Clock->GetEphemerisTime();
+    }
+
+    const double WorldSeconds = GetWorld() ? GetWorld()->GetTimeSeconds() : RecordingStartWorldSeconds;
+    return FSEphemerisTime(StartEt.seconds + WorldSeconds - RecordingStartWorldSeconds);
+}
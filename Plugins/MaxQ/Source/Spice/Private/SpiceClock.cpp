@@ -0,0 +1,233 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceClock.cpp
+//
+// Implementation Comments
+//
+// Purpose:  One authoritative simulation ET per frame
+//
+// The clock advances from FWorldDelegates::OnWorldPreActorTick, which UWorld
+// broadcasts before any tick group runs, so actors never see the previous
+// frame's ET.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceClock.cpp is part of the "refined Blueprints API".
+//------------------------------------------------------------------------------
+
+#include "SpiceClock.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "SpiceEphemeris.h"
+#include "SpiceTime.h"
+
+
+UMaxQClockSubsystem* UMaxQClockSubsystem::Get(const UObject* WorldContextObject)
+{
+    UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+    return World ? World->GetSubsystem<UMaxQClockSubsystem>() : nullptr;
+}
+
+
+void UMaxQClockSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    EphemerisTime = MaxQ::Time::Now();
+    PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UMaxQClockSubsystem::OnWorldPreActorTick);
+}
+
+
+void UMaxQClockSubsystem::Deinitialize()
+{
+    FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+
+    Super::Deinitialize();
+}
+
+
+bool UMaxQClockSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+
+void UMaxQClockSubsystem::OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+    if (World == GetWorld() && !World->IsPaused())
+    {
+        Advance(DeltaSeconds);
+    }
+}
+
+
+void UMaxQClockSubsystem::Advance(double RealDeltaSeconds)
+{
+    Elapsed = FSEphemerisPeriod(bPaused ? 0. : RealDeltaSeconds * TimeScale);
+    EphemerisTime.seconds += Elapsed.seconds;
+    ++FrameNumber;
+
+    FrameStates.Reset();
+
+    ScheduleFixedSteps();
+
+    OnClockAdvanced.Broadcast(EphemerisTime, Elapsed);
+    OnClockAdvancedNative.Broadcast(EphemerisTime, Elapsed);
+}
+
+
+void UMaxQClockSubsystem::ScheduleFixedSteps()
+{
+    FixedStepTimesThisFrame.Reset();
+    SkippedFixedStepsThisFrame = 0;
+
+    const double Step = FixedStep.seconds;
+    if (Step <= 0.)
+    {
+        FixedStepTime = EphemerisTime;
+        FixedStepAlpha = 0.;
+        return;
+    }
+
+    const double et = EphemerisTime.seconds;
+
+    // Fixed steps only run forwards
+    if (bRestartFixedSteps || et < FixedStepTime.seconds - Step)
+    {
+        bRestartFixedSteps = false;
+        FixedStepTime = EphemerisTime;
+        AddFixedStep(FixedStepTime);
+    }
+
+    if (et >= FixedStepTime.seconds)
+    {
+        const int64 Needed = FMath::FloorToInt64((et - FixedStepTime.seconds) / Step) + 1;
+        const int64 Skipped = FMath::Max<int64>(0, Needed - MaxFixedStepsPerFrame);
+
+        FixedStepTime.seconds += Skipped * Step;
+        SkippedFixedStepsThisFrame = Skipped;
+
+        for (int64 i = Skipped; i < Needed; ++i)
+        {
+            FixedStepTime.seconds += Step;
+            AddFixedStep(FixedStepTime);
+        }
+    }
+
+    FixedStepAlpha = FMath::Clamp((et - (FixedStepTime.seconds - Step)) / Step, 0., 1.);
+}
+
+
+void UMaxQClockSubsystem::AddFixedStep(const FSEphemerisTime& et)
+{
+    FixedStepTimesThisFrame.Add(et);
+    OnFixedStep.Broadcast(et, FixedStep);
+    OnFixedStepNative.Broadcast(et, FixedStep);
+}
+
+
+void UMaxQClockSubsystem::SetEphemerisTime(const FSEphemerisTime& et)
+{
+    EphemerisTime = et;
+    bRestartFixedSteps = true;
+    FrameStates.Reset();
+}
+
+
+void UMaxQClockSubsystem::SetEphemerisTimeToNow()
+{
+    SetEphemerisTime(MaxQ::Time::Now());
+}
+
+
+void UMaxQClockSubsystem::SetEphemerisTimeFromString(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& TimeString)
+{
+    FSEphemerisTime et = MaxQ::Time::Str2Et(TimeString, &ResultCode, &ErrorMessage);
+    if (ResultCode == ES_ResultCode::Success)
+    {
+        SetEphemerisTime(et);
+    }
+}
+
+
+void UMaxQClockSubsystem::SetTimeScale(double NewTimeScale)
+{
+    TimeScale = FMath::IsFinite(NewTimeScale) ? FMath::Clamp(NewTimeScale, -MaxTimeScale, MaxTimeScale) : 1.;
+}
+
+
+void UMaxQClockSubsystem::SetFixedStep(const FSEphemerisPeriod& NewFixedStep, int32 NewMaxFixedStepsPerFrame)
+{
+    FixedStep = FSEphemerisPeriod(FMath::Max(0., NewFixedStep.seconds));
+    MaxFixedStepsPerFrame = FMath::Max(1, NewMaxFixedStepsPerFrame);
+    bRestartFixedSteps = true;
+}
+
+
+void UMaxQClockSubsystem::K2_GetFrameState(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    FSStateVector& state,
+    FSEphemerisPeriod& lt,
+    FName targ,
+    FName obs,
+    FName ref,
+    ES_AberrationCorrectionWithNewtonians abcorr
+)
+{
+    GetFrameState(state, targ, obs, ref, abcorr, &lt, &ResultCode, &ErrorMessage);
+}
+
+
+bool UMaxQClockSubsystem::GetFrameState(
+    FSStateVector& state,
+    const FName& targ,
+    const FName& obs,
+    const FName& ref,
+    ES_AberrationCorrectionWithNewtonians abcorr,
+    FSEphemerisPeriod* lt,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+)
+{
+    const FFrameStateKey Key { targ, obs, ref, abcorr };
+
+    if (const FFrameState* Cached = FrameStates.Find(Key))
+    {
+        state = Cached->State;
+        if (lt) *lt = Cached->LightTime;
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+    // Only successes are cached:  a failure (kernels not loaded yet, say)
+    // is retried by the next caller.
+    FFrameState Computed;
+    ES_ResultCode ComputedResultCode;
+    FString ComputedErrorMessage;
+    MaxQ::Ephemeris::Spkezr(Computed.State, Computed.LightTime, EphemerisTime, targ, obs, ref, abcorr, &ComputedResultCode, &ComputedErrorMessage);
+
+    const bool bSuccess = ComputedResultCode == ES_ResultCode::Success;
+    if (bSuccess)
+    {
+        FrameStates.Add(Key, Computed);
+    }
+
+    state = Computed.State;
+    if (lt) *lt = Computed.LightTime;
+    if (ResultCode) *ResultCode = ComputedResultCode;
+    if (ErrorMessage) *ErrorMessage = ComputedErrorMessage;
+
+    return bSuccess;
+}
@@ -0,0 +1,540 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCompression.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Compressing dense trajectories to Chebyshev SPK segments
+//
+// Coefficients come from the discrete cosine transform of the trajectory at
+// a record's n = degree + 1 Chebyshev nodes, which interpolates it there.
+// Records are evaluated (and differentiated, for type 2 velocities) the way
+// SPICE's readers do:  c0 + c1 T1(x) + ... + cn Tn(x), x in -1..1 over the
+// record.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCompression.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceCompression.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "SpiceCore.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Compression;
+    using MaxQ::Core::ToANSIString;
+
+    constexpr int32 DegreeLimit = 25;
+    constexpr int32 CoefficientsLimit = DegreeLimit + 1;
+
+    // Coverage left over smaller than this (seconds) is rounding
+    constexpr double Tiny = 1e-6;
+
+    struct FRecord
+    {
+        double Coefficients[6 * CoefficientsLimit];
+        int32 Degree = 0;
+        bool bPass = false;
+        int32 Checks = 0;
+        double MaxPosition = 0.;
+        double MaxVelocity = 0.;
+        double SumPosition2 = 0.;
+        double SumVelocity2 = 0.;
+    };
+
+    // Clenshaw's recurrence
+    double Chebyshev(const double* c, int32 Degree, double x)
+    {
+        double b1 = 0., b2 = 0.;
+        for (int32 k = Degree; k >= 1; --k)
+        {
+            const double b = c[k] + 2. * x * b1 - b2;
+            b2 = b1;
+            b1 = b;
+        }
+        return c[0] + x * b1 - b2;
+    }
+
+    // d/dx of a series of Degree >= 1, as a series of Degree - 1
+    void Derivative(const double* c, int32 Degree, double* d)
+    {
+        double dk = 0., dk1 = 0.;
+        for (int32 k = Degree; k >= 1; --k)
+        {
+            const double dkm1 = dk1 + 2. * k * c[k];
+            dk1 = dk;
+            dk = dkm1;
+            d[k - 1] = dkm1;
+        }
+        d[0] *= .5;
+    }
+
+    void FitRecord(FStateSampler Sampler, double Begin, double Length, int32 Degree, const FChebyshevFitSettings& Settings, FRecord& Record)
+    {
+        const int32 n = Degree + 1;
+        const int32 Components = Settings.bFitVelocity ? 6 : 3;
+        const double Radius = .5 * Length;
+        const double Mid = Begin + Radius;
+
+        double Values[6][CoefficientsLimit];
+        double State[6];
+        for (int32 k = 0; k < n; ++k)
+        {
+            Sampler(Mid + Radius * FMath::Cos(PI * (k + .5) / n), State);
+            for (int32 c = 0; c < 6; ++c)
+            {
+                Values[c][k] = State[c];
+            }
+        }
+
+        for (int32 c = 0; c < Components; ++c)
+        {
+            double* Out = &Record.Coefficients[c * n];
+            for (int32 j = 0; j < n; ++j)
+            {
+                double Sum = 0.;
+                for (int32 k = 0; k < n; ++k)
+                {
+                    Sum += Values[c][k] * FMath::Cos(PI * j * (k + .5) / n);
+                }
+                Out[j] = Sum * (j == 0 ? 1. : 2.) / n;
+            }
+        }
+
+        double Velocity[3][CoefficientsLimit];
+        if (!Settings.bFitVelocity)
+        {
+            for (int32 c = 0; c < 3; ++c)
+            {
+                Derivative(&Record.Coefficients[c * n], Degree, Velocity[c]);
+            }
+        }
+
+        // The ends (where records meet), and between the nodes
+        Record.Degree = Degree;
+        Record.Checks = 2 * n + 1;
+        Record.MaxPosition = Record.MaxVelocity = Record.SumPosition2 = Record.SumVelocity2 = 0.;
+        for (int32 i = 0; i < Record.Checks; ++i)
+        {
+            const double x = -1. + 2. * i / (Record.Checks - 1);
+            Sampler(Mid + Radius * x, State);
+
+            double Position2 = 0., Velocity2 = 0.;
+            for (int32 c = 0; c < 3; ++c)
+            {
+                const double p = Chebyshev(&Record.Coefficients[c * n], Degree, x);
+                const double v = Settings.bFitVelocity ? Chebyshev(&Record.Coefficients[(3 + c) * n], Degree, x) : Chebyshev(Velocity[c], Degree - 1, x) / Radius;
+                Position2 += FMath::Square(p - State[c]);
+                Velocity2 += FMath::Square(v - State[3 + c]);
+            }
+
+            Record.MaxPosition = FMath::Max(Record.MaxPosition, FMath::Sqrt(Position2));
+            Record.MaxVelocity = FMath::Max(Record.MaxVelocity, FMath::Sqrt(Velocity2));
+            Record.SumPosition2 += Position2;
+            Record.SumVelocity2 += Velocity2;
+        }
+
+        Record.bPass = Record.MaxPosition <= Settings.PositionTolerance && Record.MaxVelocity <= Settings.VelocityTolerance;
+    }
+
+    // The lowest degree that fits, or the highest degree's fit
+    bool FitLowestDegree(FStateSampler Sampler, double Begin, double Length, const FChebyshevFitSettings& Settings, FRecord& Record)
+    {
+        for (int32 Degree = Settings.MinDegree; Degree <= Settings.MaxDegree; ++Degree)
+        {
+            FitRecord(Sampler, Begin, Length, Degree, Settings, Record);
+            if (Record.bPass)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // What spkw02/spkw03 write:  MID, RADIUS & coefficients per record, and a
+    // 4 double trailer per segment
+    int64 SegmentBytes(const FChebyshevSegment& Segment)
+    {
+        const int64 RecordSize = 2 + (Segment.bVelocity ? 6 : 3) * (Segment.Degree + 1);
+        return sizeof(double) * (RecordSize * Segment.Records + 4);
+    }
+}
+
+
+namespace MaxQ::Compression
+{
+    void FitChebyshev(
+        FStateSampler Sampler,
+        double First,
+        double Last,
+        const FChebyshevFitSettings& InSettings,
+        TArray<FChebyshevSegment>& Segments,
+        FCompressionStats& Stats
+    )
+    {
+        if (!(Last > First))
+        {
+            return;
+        }
+
+        FChebyshevFitSettings Settings = InSettings;
+        Settings.MinDegree = FMath::Clamp(Settings.MinDegree, 1, DegreeLimit);
+        Settings.MaxDegree = FMath::Clamp(Settings.MaxDegree, Settings.MinDegree, DegreeLimit);
+        Settings.MinRecordSeconds = FMath::Max(Settings.MinRecordSeconds, Tiny);
+        Settings.MaxRecordSeconds = FMath::Max(Settings.MaxRecordSeconds, Settings.MinRecordSeconds);
+        const int32 Components = Settings.bFitVelocity ? 6 : 3;
+
+        // Record ends can round past the coverage
+        auto Clamped = [&Sampler, First, Last](double et, double(&State)[6])
+        {
+            Sampler(FMath::Clamp(et, First, Last), State);
+        };
+
+        double SumPosition2 = FMath::Square(Stats.RmsPositionError) * Stats.Checks;
+        double SumVelocity2 = FMath::Square(Stats.RmsVelocityError) * Stats.Checks;
+
+        FRecord Record, Candidate;
+        double Begin = First;
+        double Length = Settings.MaxRecordSeconds;
+
+        while (Last - Begin > Tiny)
+        {
+            // The longest record, at the lowest degree, that fits from here
+            const double Remaining = Last - Begin;
+            Length = FMath::Min(Length, Remaining);
+
+            bool bPass = FitLowestDegree(Clamped, Begin, Length, Settings, Record);
+            if (bPass)
+            {
+                while (Length < Remaining && Length < Settings.MaxRecordSeconds)
+                {
+                    const double Longer = FMath::Min3(2. * Length, Remaining, Settings.MaxRecordSeconds);
+                    if (!FitLowestDegree(Clamped, Begin, Longer, Settings, Candidate))
+                    {
+                        break;
+                    }
+                    Record = Candidate;
+                    Length = Longer;
+                }
+            }
+            else
+            {
+                while (!bPass && .5 * Length >= Settings.MinRecordSeconds)
+                {
+                    Length *= .5;
+                    bPass = FitLowestDegree(Clamped, Begin, Length, Settings, Record);
+                }
+            }
+
+            FChebyshevSegment& Segment = Segments.AddDefaulted_GetRef();
+            Segment.First = Begin;
+            Segment.IntervalLength = Length;
+            Segment.Degree = Record.Degree;
+            Segment.bVelocity = Settings.bFitVelocity;
+
+            auto Accept = [&](const FRecord& Accepted)
+            {
+                Segment.Coefficients.Append(Accepted.Coefficients, Components * (Segment.Degree + 1));
+                ++Segment.Records;
+                ++Stats.Records;
+                Stats.RecordsOverTolerance += !Accepted.bPass;
+                Stats.Checks += Accepted.Checks;
+                Stats.MaxPositionError = FMath::Max(Stats.MaxPositionError, Accepted.MaxPosition);
+                Stats.MaxVelocityError = FMath::Max(Stats.MaxVelocityError, Accepted.MaxVelocity);
+                SumPosition2 += Accepted.SumPosition2;
+                SumVelocity2 += Accepted.SumVelocity2;
+                Begin = Segment.First + Segment.Records * Length;
+            };
+            Accept(Record);
+
+            // Records of the same length & degree, while they fit, and until
+            // records twice as long would (past periapsis, say)
+            while (Last - Begin >= Length - Tiny)
+            {
+                const double Longer = 2. * Length;
+                if (Last - Begin >= Longer && Longer <= Settings.MaxRecordSeconds && FitLowestDegree(Clamped, Begin, Longer, Settings, Candidate))
+                {
+                    break;
+                }
+
+                FitRecord(Clamped, Begin, Length, Segment.Degree, Settings, Candidate);
+                if (!Candidate.bPass)
+                {
+                    break;
+                }
+                Accept(Candidate);
+            }
+
+            Segment.Last = Last - Begin > Tiny ? Begin : Last;
+            ++Stats.Segments;
+        }
+
+        if (Stats.Checks > 0)
+        {
+            Stats.RmsPositionError = FMath::Sqrt(SumPosition2 / Stats.Checks);
+            Stats.RmsVelocityError = FMath::Sqrt(SumVelocity2 / Stats.Checks);
+        }
+    }
+
+
+    void FitChebyshev(
+        const TArray<double>& Epochs,
+        const TArray<double>& States,
+        const FChebyshevFitSettings& Settings,
+        TArray<FChebyshevSegment>& Segments,
+        FCompressionStats& Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MakeErrorGutter(ResultCode, ErrorMessage);
+
+        const int32 n = Epochs.Num();
+        bool bIncreasing = true;
+        for (int32 i = 1; i < n && bIncreasing; ++i)
+        {
+            bIncreasing = Epochs[i] > Epochs[i - 1];
+        }
+
+        if (n < 2 || States.Num() != 6 * n || !bIncreasing)
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("FitChebyshev needs at least 2 strictly increasing epochs, with 6 state components each (%d epochs, %d components)"), n, States.Num());
+            return;
+        }
+
+        // Cubic Hermite between the samples bracketing et
+        auto Hermite = [&Epochs, &States, n](double et, double(&State)[6])
+        {
+            const int32 i = FMath::Clamp(Algo::UpperBound(Epochs, et) - 1, 0, n - 2);
+            const double h = Epochs[i + 1] - Epochs[i];
+            const double s = (et - Epochs[i]) / h;
+            const double s2 = s * s, s3 = s2 * s;
+
+            const double h00 = 2. * s3 - 3. * s2 + 1., h10 = s3 - 2. * s2 + s, h01 = -2. * s3 + 3. * s2, h11 = s3 - s2;
+            const double d00 = 6. * s2 - 6. * s, d10 = 3. * s2 - 4. * s + 1., d01 = -d00, d11 = 3. * s2 - 2. * s;
+
+            const double* a = &States[6 * i];
+            const double* b = &States[6 * (i + 1)];
+            for (int32 c = 0; c < 3; ++c)
+            {
+                State[c] = h00 * a[c] + h10 * h * a[3 + c] + h01 * b[c] + h11 * h * b[3 + c];
+                State[3 + c] = (d00 * a[c] + d01 * b[c]) / h + d10 * a[3 + c] + d11 * b[3 + c];
+            }
+        };
+
+        const int32 FirstNew = Segments.Num();
+        FitChebyshev(Hermite, Epochs[0], Epochs.Last(), Settings, Segments, Stats);
+
+        // An epoch & a state per sample
+        Stats.InputBytes += sizeof(double) * 7 * n;
+        for (int32 i = FirstNew; i < Segments.Num(); ++i)
+        {
+            Stats.OutputBytes += SegmentBytes(Segments[i]);
+        }
+
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+    }
+
+
+    bool WriteChebyshev(
+        int handle,
+        int body,
+        int center,
+        const FName& frame,
+        const FString& segid,
+        const TArray<FChebyshevSegment>& Segments,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Compression::WriteChebyshev);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        const ANSICHAR* _frame = ToANSIString(frame);
+        auto _segid = StringCast<ANSICHAR>(*segid);
+
+        for (int32 i = 0; i < Segments.Num() && !failed_c(); ++i)
+        {
+            const FChebyshevSegment& Segment = Segments[i];
+            if (Segment.bVelocity)
+            {
+                spkw03_c(handle, body, center, _frame, Segment.First, Segment.Last, _segid.Get(), Segment.IntervalLength, Segment.Records, Segment.Degree, Segment.Coefficients.GetData(), Segment.First);
+            }
+            else
+            {
+                spkw02_c(handle, body, center, _frame, Segment.First, Segment.Last, _segid.Get(), Segment.IntervalLength, Segment.Records, Segment.Degree, Segment.Coefficients.GetData(), Segment.First);
+            }
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    void CompressSpk(
+        const FString& InputFile,
+        const FString& OutputFile,
+        const FChebyshevFitSettings& Settings,
+        FCompressionStats& Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Compression::CompressSpk);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        const FString InputPath = toPath(InputFile);
+        const FString OutputPath = toPath(OutputFile);
+        if (FPaths::IsSamePath(InputPath, OutputPath))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("CompressSpk can't write over its input");
+            return;
+        }
+
+        auto _input = StringCast<ANSICHAR>(*InputPath);
+        SpiceChar _arch[SPICE_MAX_PATH], _type[SPICE_MAX_PATH];
+        getfat_c(_input.Get(), sizeof(_arch), sizeof(_type), _arch, _type);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return;
+        }
+        if (strcmp(_arch, "DAF") || strcmp(_type, "SPK"))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("%s is not an SPK (%s/%s)"), *InputPath, ANSI_TO_TCHAR(_arch), ANSI_TO_TCHAR(_type));
+            return;
+        }
+
+        SpiceInt _in = 0;
+        dafopr_c(_input.Get(), &_in);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return;
+        }
+
+        struct FInputSegment
+        {
+            SpiceDouble Descriptor[5];
+            SpiceChar Id[SPICE_MAX_PATH];
+            SpiceInt Body;
+            SpiceInt Center;
+            SpiceInt Frame;
+            SpiceDouble First;
+            SpiceDouble Last;
+        };
+
+        TArray<FInputSegment> Inputs;
+        SpiceBoolean _found = SPICEFALSE;
+        dafbfs_c(_in);
+        daffna_c(&_found);
+        while (_found && !failed_c())
+        {
+            FInputSegment& Input = Inputs.AddDefaulted_GetRef();
+            SpiceDouble _dc[2];
+            SpiceInt _ic[6];
+            dafgs_c(Input.Descriptor);
+            dafgn_c(sizeof(Input.Id), Input.Id);
+            dafus_c(Input.Descriptor, 2, 6, _dc, _ic);
+            Input.First = _dc[0];
+            Input.Last = _dc[1];
+            Input.Body = _ic[0];
+            Input.Center = _ic[1];
+            Input.Frame = _ic[2];
+            daffna_c(&_found);
+        }
+
+        // A new file, of fits to each input segment
+        if (!failed_c() && FPaths::FileExists(OutputPath))
+        {
+            IFileManager::Get().Delete(*OutputPath);
+        }
+
+        auto _output = StringCast<ANSICHAR>(*OutputPath);
+        SpiceInt _out = 0;
+        bool bOutputOpen = false;
+        if (!failed_c())
+        {
+            spkopn_c(_output.Get(), "MAXQ CHEBYSHEV COMPRESSION", 0, &_out);
+            bOutputOpen = !failed_c();
+        }
+
+        TArray<FChebyshevSegment> Segments;
+        for (int32 i = 0; i < Inputs.Num() && !failed_c(); ++i)
+        {
+            const FInputSegment& Input = Inputs[i];
+
+            SpiceChar _frname[SPICE_MAX_PATH];
+            frmnam_c(Input.Frame, sizeof(_frname), _frname);
+            if (!_frname[0])
+            {
+                *ResultCode = ES_ResultCode::Error;
+                *ErrorMessage = FString::Printf(TEXT("Unknown frame %d (segment %s)"), Input.Frame, ANSI_TO_TCHAR(Input.Id));
+                break;
+            }
+
+            auto Sampler = [_in, &Input](double et, double(&State)[6])
+            {
+                SpiceInt _ref = 0, _center = 0;
+                spkpvn_c(_in, Input.Descriptor, et, &_ref, State, &_center);
+            };
+
+            Segments.Reset();
+            FitChebyshev(Sampler, Input.First, Input.Last, Settings, Segments, Stats);
+            if (failed_c() || !WriteChebyshev(_out, Input.Body, Input.Center, FName(_frname), ANSI_TO_TCHAR(Input.Id), Segments, ResultCode, ErrorMessage))
+            {
+                break;
+            }
+        }
+
+        // Close both files whatever happened, keeping the first error
+        const bool bFailed = *ResultCode == ES_ResultCode::Error || ErrorCheck(ResultCode, ErrorMessage);
+        if (bOutputOpen)
+        {
+            spkcls_c(_out);
+        }
+        dafcls_c(_in);
+        if (bFailed)
+        {
+            ES_ResultCode IgnoredResultCode;
+            FString IgnoredErrorMessage;
+            ErrorCheck(IgnoredResultCode, IgnoredErrorMessage, true);
+            return;
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return;
+        }
+
+        Stats.InputBytes += IFileManager::Get().FileSize(*InputPath);
+        Stats.OutputBytes += IFileManager::Get().FileSize(*OutputPath);
+    }
+}
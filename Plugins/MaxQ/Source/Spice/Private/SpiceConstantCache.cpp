@@ -0,0 +1,518 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceConstantCache.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Cache kernel pool constants (RADII, GM, ...) between pool updates
+//
+// Entries live in an open addressing hash table of fixed size slots.  The
+// game thread is the only writer.  A slot's key is written before its hash
+// is published, and slots are never removed (invalidation zeroes Num), so
+// readers can probe without locks.  Each slot's values are guarded by a
+// sequence lock:  the writer makes Sequence odd while it writes, readers
+// retry if it was odd or changed under them.
+//
+// The table grows by doubling.  Retired tables are kept until shutdown since
+// a reader may still be probing one; growth is geometric, so they cost at
+// most as much as the current table.
+//
+// There's one watcher agent per pool variable, shared by every entry that
+// depends on the variable (CSPICE allows 1000 agents per variable).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceConstantCache.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceConstantCache.h"
+#include "Hash/CityHash.h"
+#include "HAL/IConsoleManager.h"
+#include "SpiceProfiling.h"
+#include "SpiceUtilities.h"
+#include <atomic>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+using MaxQ::ConstantCache::FStats;
+using MaxQ::ConstantCache::FValues;
+using MaxQ::ConstantCache::MaxKeyLength;
+using MaxQ::ConstantCache::MaxValues;
+
+namespace
+{
+    constexpr int32 InitialCapacity = 256;
+
+    struct FSlot
+    {
+        std::atomic<uint64> Hash { 0 };         // 0 => empty, published after Key
+        std::atomic<uint32> Sequence { 0 };     // Odd while Num/Values are written
+        int32 Num = 0;                          // 0 => invalidated
+        int32 Entry = INDEX_NONE;               // Game thread only
+        ANSICHAR Key[MaxKeyLength];
+        double Values[MaxValues];
+    };
+
+    struct FTable
+    {
+        explicit FTable(uint32 Capacity) : Slots(new FSlot[Capacity]), Mask(Capacity - 1) {}
+
+        TUniquePtr<FSlot[]> Slots;
+        uint32 Mask;
+    };
+
+    struct FWatch
+    {
+        ANSICHAR Agent[32];
+        TArray<int32> Entries;
+    };
+
+    std::atomic<FTable*> CurrentTable { nullptr };
+
+    // Game thread state
+    TArray<TUniquePtr<FTable>> Tables;          // Last is current, the rest retired
+    TArray<int32> EntrySlots;                   // Entry => slot index in the current table
+    TMap<FString, int32> WatchByVariable;
+    TArray<FWatch> Watches;
+    int32 ValidEntries = 0;
+    int64 Invalidations = 0;
+
+    std::atomic<int64> Hits { 0 };
+    std::atomic<int64> Misses { 0 };
+
+    uint64 HashKey(const ANSICHAR* Key)
+    {
+        const uint64 Hash = CityHash64(Key, FCStringAnsi::Strlen(Key));
+        return Hash ? Hash : 1;
+    }
+
+    // The slot holding Key, or the empty slot where it belongs
+    uint32 Probe(const FTable& Table, const ANSICHAR* Key, uint64 Hash)
+    {
+        for (uint32 i = Hash & Table.Mask;; i = (i + 1) & Table.Mask)
+        {
+            const FSlot& Slot = Table.Slots[i];
+            const uint64 SlotHash = Slot.Hash.load(std::memory_order_acquire);
+            if (SlotHash == 0 || (SlotHash == Hash && FCStringAnsi::Strcmp(Slot.Key, Key) == 0))
+            {
+                return i;
+            }
+        }
+    }
+
+    void WriteValues(FSlot& Slot, const double* Values, int32 Num)
+    {
+        const uint32 Sequence = Slot.Sequence.load(std::memory_order_relaxed);
+        Slot.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Slot.Num = Num;
+        FMemory::Memcpy(Slot.Values, Values, Num * sizeof(double));
+
+        Slot.Sequence.store(Sequence + 2, std::memory_order_release);
+    }
+
+    void Publish(FTable& Table, uint32 Index, const ANSICHAR* Key, uint64 Hash, int32 Entry)
+    {
+        FSlot& Slot = Table.Slots[Index];
+        FCStringAnsi::Strncpy(Slot.Key, Key, MaxKeyLength);
+        Slot.Entry = Entry;
+        Slot.Hash.store(Hash, std::memory_order_release);
+    }
+
+    void Grow()
+    {
+        FTable* Old = CurrentTable.load(std::memory_order_relaxed);
+        TUniquePtr<FTable> New = MakeUnique<FTable>(Old ? 2 * (Old->Mask + 1) : InitialCapacity);
+
+        for (int32 Entry = 0; Entry < EntrySlots.Num(); ++Entry)
+        {
+            const FSlot& OldSlot = Old->Slots[EntrySlots[Entry]];
+            const uint64 Hash = OldSlot.Hash.load(std::memory_order_relaxed);
+            const uint32 Index = Probe(*New, OldSlot.Key, Hash);
+
+            WriteValues(New->Slots[Index], OldSlot.Values, OldSlot.Num);
+            Publish(*New, Index, OldSlot.Key, Hash, Entry);
+            EntrySlots[Entry] = Index;
+        }
+
+        CurrentTable.store(New.Get(), std::memory_order_release);
+        Tables.Add(MoveTemp(New));
+    }
+
+    void Invalidate(int32 Entry)
+    {
+        FSlot& Slot = CurrentTable.load(std::memory_order_relaxed)->Slots[EntrySlots[Entry]];
+        if (Slot.Num > 0)
+        {
+            WriteValues(Slot, Slot.Values, 0);
+            --ValidEntries;
+            ++Invalidations;
+        }
+    }
+
+    // The watch on Variable, set on first use
+    int32 Watch(const ANSICHAR* Variable)
+    {
+        const FString Name = ANSI_TO_TCHAR(Variable);
+        if (const int32* Existing = WatchByVariable.Find(Name))
+        {
+            return *Existing;
+        }
+
+        FWatch NewWatch;
+        FCStringAnsi::Snprintf(NewWatch.Agent, sizeof(NewWatch.Agent), "MAXQ_CONSTANT_%d", Watches.Num());
+
+        swpool_c(NewWatch.Agent, 1, FCStringAnsi::Strlen(Variable) + 1, Variable);
+
+        // swpool_c posts an initial notice, the values being cached are current.
+        SpiceBoolean _update = SPICEFALSE;
+        cvpool_c(NewWatch.Agent, &_update);
+
+        if (UnexpectedErrorCheck())
+        {
+            return INDEX_NONE;
+        }
+
+        WatchByVariable.Add(Name, Watches.Num());
+        return Watches.Add(MoveTemp(NewWatch));
+    }
+
+    // Concatenates Parts into Key, false if they don't fit
+    bool MakeKey(ANSICHAR (&Key)[MaxKeyLength], std::initializer_list<const ANSICHAR*> Parts)
+    {
+        int32 Length = 0;
+        for (const ANSICHAR* Part : Parts)
+        {
+            const int32 PartLength = FCStringAnsi::Strlen(Part);
+            if (Length + PartLength >= MaxKeyLength)
+            {
+                return false;
+            }
+            FMemory::Memcpy(Key + Length, Part, PartLength);
+            Length += PartLength;
+        }
+        Key[Length] = '\0';
+        return true;
+    }
+
+    void CopyOut(const FValues& Cached, double* Values, int32 Room, int32& N)
+    {
+        N = Cached.Num;
+        FMemory::Memcpy(Values, Cached.Values, FMath::Min(N, Room) * sizeof(double));
+    }
+
+    void Succeeded(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+    }
+
+    void LogStats()
+    {
+        const FStats Current = MaxQ::ConstantCache::GetStats();
+        UE_LOG(LogSpice, Log, TEXT("MaxQ constant cache: %d entries, %d watched variables, %lld hits, %lld misses (%.1f%% hits), %lld invalidations"),
+            Current.Entries, Current.WatchedVariables, Current.Hits, Current.Misses, 100. * Current.HitRate(), Current.Invalidations);
+    }
+
+    FAutoConsoleCommand StatsCommand(
+        TEXT("MaxQ.Spice.Constants.Stats"),
+        TEXT("Logs the MaxQ kernel pool constant cache's statistics"),
+        FConsoleCommandDelegate::CreateStatic(&LogStats)
+    );
+}
+
+
+namespace MaxQ::ConstantCache
+{
+    SPICE_API bool Find(const ANSICHAR* Key, FValues& Values)
+    {
+        if (const FTable* Table = CurrentTable.load(std::memory_order_acquire))
+        {
+            const FSlot& Slot = Table->Slots[Probe(*Table, Key, HashKey(Key))];
+            if (Slot.Hash.load(std::memory_order_relaxed) != 0)
+            {
+                uint32 Sequence;
+                do
+                {
+                    Sequence = Slot.Sequence.load(std::memory_order_acquire);
+                    Values.Num = FMath::Clamp(Slot.Num, 0, MaxValues);
+                    FMemory::Memcpy(Values.Values, Slot.Values, Values.Num * sizeof(double));
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                }
+                while ((Sequence & 1) || Slot.Sequence.load(std::memory_order_relaxed) != Sequence);
+
+                if (Values.Num > 0)
+                {
+                    Hits.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+
+        Misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+
+    SPICE_API void Add(const ANSICHAR* Key, const FValues& Values, TArrayView<const ANSICHAR* const> Variables)
+    {
+        check(IsInGameThread());
+
+        if (Values.Num <= 0 || Values.Num > MaxValues || FCStringAnsi::Strlen(Key) >= MaxKeyLength)
+        {
+            return;
+        }
+
+        // An entry nothing watches would never be invalidated
+        TArray<int32, TInlineAllocator<4>> EntryWatches;
+        for (const ANSICHAR* Variable : Variables)
+        {
+            const int32 WatchIndex = Watch(Variable);
+            if (WatchIndex == INDEX_NONE)
+            {
+                return;
+            }
+            EntryWatches.Add(WatchIndex);
+        }
+
+        FTable* Table = CurrentTable.load(std::memory_order_relaxed);
+        if (!Table || 2 * (EntrySlots.Num() + 1) > (int32)(Table->Mask + 1))
+        {
+            Grow();
+            Table = CurrentTable.load(std::memory_order_relaxed);
+        }
+
+        const uint64 Hash = HashKey(Key);
+        const uint32 Index = Probe(*Table, Key, Hash);
+        FSlot& Slot = Table->Slots[Index];
+
+        if (Slot.Hash.load(std::memory_order_relaxed) == 0)
+        {
+            WriteValues(Slot, Values.Values, Values.Num);
+            Publish(*Table, Index, Key, Hash, EntrySlots.Add(Index));
+            ++ValidEntries;
+        }
+        else
+        {
+            ValidEntries += Slot.Num == 0;
+            WriteValues(Slot, Values.Values, Values.Num);
+        }
+
+        for (int32 WatchIndex : EntryWatches)
+        {
+            Watches[WatchIndex].Entries.AddUnique(Slot.Entry);
+        }
+    }
+
+
+    SPICE_API void Validate()
+    {
+        check(IsInGameThread());
+
+        for (FWatch& Watch : Watches)
+        {
+            SpiceBoolean _update = SPICEFALSE;
+            cvpool_c(Watch.Agent, &_update);
+
+            if (_update)
+            {
+                for (int32 Entry : Watch.Entries)
+                {
+                    Invalidate(Entry);
+                }
+                Watch.Entries.Reset();
+            }
+        }
+
+        UnexpectedErrorCheck();
+    }
+
+
+    SPICE_API void InvalidateAll()
+    {
+        check(IsInGameThread());
+
+        for (int32 Entry = 0; Entry < EntrySlots.Num(); ++Entry)
+        {
+            Invalidate(Entry);
+        }
+        for (FWatch& Watch : Watches)
+        {
+            Watch.Entries.Reset();
+        }
+    }
+
+
+    SPICE_API bool Bodvrd(const ANSICHAR* bodynm, const ANSICHAR* item, double* Values, int32 Room, int32& N, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        // The separators keep bodvrd keys apart from pool variable names
+        ANSICHAR Key[MaxKeyLength];
+        FValues Cached;
+        const bool bCacheable = Room <= MaxValues && MakeKey(Key, { "\x1f", bodynm, "\x1f", item });
+
+        if (bCacheable && Find(Key, Cached))
+        {
+            CopyOut(Cached, Values, Room, N);
+            Succeeded(ResultCode, ErrorMessage);
+            return true;
+        }
+
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Data::Bodvrd, bodynm, nullptr, nullptr);
+        SpiceInt _n = 0;
+
+        if (!bCacheable || !IsInGameThread())
+        {
+            bodvrd_c(bodynm, item, Room, &_n, Values);
+            N = _n;
+            return !ErrorCheck(ResultCode, ErrorMessage);
+        }
+
+        bodvrd_c(bodynm, item, MaxValues, &_n, Cached.Values);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        Cached.Num = _n;
+
+        // bodvrd_c reads BODY<code>_<item>, the code depends on the name mappings
+        SpiceInt _code = 0;
+        SpiceBoolean _found = SPICEFALSE;
+        bods2c_c(bodynm, &_code, &_found);
+
+        ANSICHAR Code[16];
+        FCStringAnsi::Snprintf(Code, sizeof(Code), "%d", (int)_code);
+
+        ANSICHAR Variable[MaxKeyLength];
+        if (!UnexpectedErrorCheck() && _found && MakeKey(Variable, { "BODY", Code, "_", item }))
+        {
+            const ANSICHAR* Variables[] = { Variable, "NAIF_BODY_NAME", "NAIF_BODY_CODE" };
+            Add(Key, Cached, Variables);
+        }
+
+        CopyOut(Cached, Values, Room, N);
+        return true;
+    }
+
+
+    SPICE_API bool Bodvcd(int bodyid, const ANSICHAR* item, double* Values, int32 Room, int32& N, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        // The pool variable bodvcd_c reads, shared with gdpool lookups
+        ANSICHAR Code[16];
+        FCStringAnsi::Snprintf(Code, sizeof(Code), "%d", bodyid);
+
+        ANSICHAR Key[MaxKeyLength];
+        FValues Cached;
+        const bool bCacheable = Room <= MaxValues && MakeKey(Key, { "BODY", Code, "_", item });
+
+        if (bCacheable && Find(Key, Cached))
+        {
+            CopyOut(Cached, Values, Room, N);
+            Succeeded(ResultCode, ErrorMessage);
+            return true;
+        }
+
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Data::Bodvcd, bodyid, nullptr, nullptr);
+        SpiceInt _n = 0;
+
+        if (!bCacheable || !IsInGameThread())
+        {
+            bodvcd_c(bodyid, item, Room, &_n, Values);
+            N = _n;
+            return !ErrorCheck(ResultCode, ErrorMessage);
+        }
+
+        bodvcd_c(bodyid, item, MaxValues, &_n, Cached.Values);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        Cached.Num = _n;
+
+        const ANSICHAR* Variables[] = { Key };
+        Add(Key, Cached, Variables);
+
+        CopyOut(Cached, Values, Room, N);
+        return true;
+    }
+
+
+    SPICE_API bool Gdpool(const ANSICHAR* name, double* Values, int32 Room, int32& N, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        FValues Cached;
+        const bool bCacheable = Room <= MaxValues && FCStringAnsi::Strlen(name) < MaxKeyLength;
+
+        if (bCacheable && Find(name, Cached))
+        {
+            CopyOut(Cached, Values, Room, N);
+            N = FMath::Min(N, Room);
+            Succeeded(ResultCode, ErrorMessage);
+            return true;
+        }
+
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Gdpool);
+        SpiceInt _n = 0;
+        SpiceBoolean _found = SPICEFALSE;
+
+        if (!bCacheable || !IsInGameThread())
+        {
+            gdpool_c(name, 0, Room, &_n, Values, &_found);
+            N = _n;
+            return !ErrorCheck(ResultCode, ErrorMessage) && _found;
+        }
+
+        gdpool_c(name, 0, MaxValues, &_n, Cached.Values, &_found);
+        if (ErrorCheck(ResultCode, ErrorMessage) || !_found)
+        {
+            return false;
+        }
+        Cached.Num = _n;
+
+        // A full buffer may be a truncated variable
+        if (_n < MaxValues)
+        {
+            const ANSICHAR* Variables[] = { name };
+            Add(name, Cached, Variables);
+        }
+
+        CopyOut(Cached, Values, Room, N);
+        N = FMath::Min(N, Room);
+        return true;
+    }
+
+
+    SPICE_API FStats GetStats()
+    {
+        FStats Current;
+        Current.Entries = ValidEntries;
+        Current.WatchedVariables = Watches.Num();
+        Current.Hits = Hits.load(std::memory_order_relaxed);
+        Current.Misses = Misses.load(std::memory_order_relaxed);
+        Current.Invalidations = Invalidations;
+        return Current;
+    }
+
+
+    SPICE_API void ResetStats()
+    {
+        Hits.store(0, std::memory_order_relaxed);
+        Misses.store(0, std::memory_order_relaxed);
+        Invalidations = 0;
+    }
+}
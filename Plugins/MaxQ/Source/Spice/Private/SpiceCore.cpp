@@ -23,6 +23,8 @@
 
 #include "SpiceCore.h"
 #include "SpiceUtilities.h"
+#include "Misc/StringBuilder.h"
+#include "Misc/ScopeRWLock.h"
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 extern "C"
@@ -37,6 +39,7 @@ namespace MaxQ::Core
 {
     SPICE_API void InitAll(bool PrintCallstack)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Core::InitAll);
         Reset();
         ClearAll();
         char szBuffer[SpiceLongMessageMaxLength];
@@ -77,6 +80,7 @@ namespace MaxQ::Core
     */
     SPICE_API void Reset()
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Core::Reset);
         reset_c();
 
         UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Reset' reset error handling state"));
@@ -84,9 +88,178 @@ namespace MaxQ::Core
 
     SPICE_API void ClearAll()
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Core::ClearAll);
         kclear_c();
         clpool_c();
+        OnKernelsCleared();
 
         UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Clear All' cleared kernel memory & pool"));
     }
+
+
+    namespace
+    {
+        // Names are interned for the life of the process, nothing is ever freed.
+        // The number of distinct body/frame/item names any app uses is small.
+        struct FInternedANSIStrings
+        {
+            FRWLock Lock;
+            TMap<uint64, const ANSICHAR*> Strings;
+
+            static uint64 KeyOf(const FName& Name)
+            {
+                return (uint64(Name.GetDisplayIndex().ToUnstableInt()) << 32) | uint64(uint32(Name.GetNumber()));
+            }
+
+            static FInternedANSIStrings& Get()
+            {
+                static FInternedANSIStrings Singleton;
+                return Singleton;
+            }
+        };
+    }
+
+    SPICE_API const ANSICHAR* ToANSIString(const FName& Name)
+    {
+        FInternedANSIStrings& Interned = FInternedANSIStrings::Get();
+        const uint64 Key = FInternedANSIStrings::KeyOf(Name);
+
+        {
+            FReadScopeLock ReadLock(Interned.Lock);
+            if (const ANSICHAR* const* Found = Interned.Strings.Find(Key))
+            {
+                return *Found;
+            }
+        }
+
+        // First sighting, convert it outside the lock...
+        TStringBuilder<FName::StringBufferSize> NameString;
+        Name.AppendString(NameString);
+        auto _name = StringCast<ANSICHAR>(NameString.ToString(), NameString.Len());
+
+        const int32 Size = _name.Length() + 1;
+        ANSICHAR* Copy = static_cast<ANSICHAR*>(FMemory::Malloc(Size));
+        FMemory::Memcpy(Copy, _name.Get(), Size - 1);
+        Copy[Size - 1] = '\0';
+
+        FWriteScopeLock WriteLock(Interned.Lock);
+
+        // ... and another thread may have won the race
+        if (const ANSICHAR* const* Found = Interned.Strings.Find(Key))
+        {
+            FMemory::Free(Copy);
+            return *Found;
+        }
+
+        Interned.Strings.Add(Key, Copy);
+        return Copy;
+    }
+
+    SPICE_API int32 GetInternedANSIStringCount()
+    {
+        FInternedANSIStrings& Interned = FInternedANSIStrings::Get();
+
+        FReadScopeLock ReadLock(Interned.Lock);
+        return Interned.Strings.Num();
+    }
+
+
+    static thread_local FDeferredErrorScope* CurrentDeferredErrorScope = nullptr;
+
+    FDeferredErrorScope::FDeferredErrorScope(const TCHAR* _ScopeName, int32 _MaxDistinctErrors, bool _bLogOnExit)
+        : ScopeName(_ScopeName)
+        , MaxDistinctErrors(FMath::Max(_MaxDistinctErrors, 1))
+        , bLogOnExit(_bLogOnExit)
+        , ItemIndex(INDEX_NONE)
+        , FailureCount(0)
+        , UntrackedFailureCount(0)
+        , OuterScope(CurrentDeferredErrorScope)
+    {
+        CurrentDeferredErrorScope = this;
+    }
+
+    FDeferredErrorScope::~FDeferredErrorScope()
+    {
+        check(CurrentDeferredErrorScope == this);
+        CurrentDeferredErrorScope = OuterScope;
+
+        if (bLogOnExit && FailureCount > 0)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("%s"), *GetSummary());
+
+#if WITH_EDITORONLY_DATA
+            // Once per scope, rather than once per failure
+            PrintScriptCallstack();
+#endif
+        }
+    }
+
+    FDeferredErrorScope* FDeferredErrorScope::Current()
+    {
+        return CurrentDeferredErrorScope;
+    }
+
+    void FDeferredErrorScope::RecordFailure(ES_ResultCode& ResultCode, FString& ErrorMessage)
+    {
+        ++FailureCount;
+        ResultCode = ES_ResultCode::Error;
+
+        ANSICHAR szShort[sizeof(FErrorRecord::ShortMessage)];
+        szShort[0] = '\0';
+        getmsg_c("SHORT", sizeof(szShort), szShort);
+
+        FErrorRecord* Record = Records.FindByPredicate([&szShort](const FErrorRecord& Other) { return !FCStringAnsi::Strcmp(Other.ShortMessage, szShort); });
+
+        if (!Record)
+        {
+            if (Records.Num() >= MaxDistinctErrors)
+            {
+                ++UntrackedFailureCount;
+                ErrorMessage = szShort;
+                return;
+            }
+
+            Record = &Records.AddDefaulted_GetRef();
+            SpiceStringCopy(Record->ShortMessage, szShort);
+
+            // The long message is only fetched for the first occurrence
+            char szLong[SpiceLongMessageMaxLength];
+            szLong[0] = '\0';
+            getmsg_c("LONG", sizeof(szLong), szLong);
+            Record->FirstLongMessage = szLong;
+        }
+
+        ++Record->Count;
+        if (Record->ItemIndices.Num() < MaxIndicesPerError)
+        {
+            Record->ItemIndices.Add(ItemIndex);
+        }
+
+        ErrorMessage = Record->ShortMessage;
+    }
+
+    FString FDeferredErrorScope::GetSummary() const
+    {
+        TStringBuilder<2048> sb;
+
+        sb.Appendf(TEXT("MaxQ deferred errors (%s): %d failure(s), %d distinct"), ScopeName, FailureCount, Records.Num());
+
+        for (const FErrorRecord& Record : Records)
+        {
+            sb.Appendf(TEXT("\n  %s x%d, items ["), ANSI_TO_TCHAR(Record.ShortMessage), Record.Count);
+            for (int32 i = 0; i < Record.ItemIndices.Num(); ++i)
+            {
+                sb.Appendf(i ? TEXT(", %d") : TEXT("%d"), Record.ItemIndices[i]);
+            }
+            sb.Append(Record.Count > Record.ItemIndices.Num() ? TEXT(", ...]") : TEXT("]"));
+            sb.Appendf(TEXT("\n    %s"), *Record.FirstLongMessage);
+        }
+
+        if (UntrackedFailureCount > 0)
+        {
+            sb.Appendf(TEXT("\n  %d further failure(s) with other error codes"), UntrackedFailureCount);
+        }
+
+        return FString(sb.ToString());
+    }
 }
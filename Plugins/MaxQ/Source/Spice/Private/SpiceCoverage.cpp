@@ -0,0 +1,439 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCoverage.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Is there data for this body/frame/instrument at this ET?
+//
+// The game thread keeps each indexed file's raw coverage (IndexedFiles).  On
+// refresh, only ids touched by a loaded/unloaded file are re-merged; the new
+// index shares every other id's windows with the previous one, and replaces
+// it atomically.  Readers hold a reference to an immutable index, so they
+// never wait on a refresh.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCoverage.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceCoverage.h"
+#include "Algo/BinarySearch.h"
+#include "Misc/ScopeRWLock.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using MaxQ::Coverage::EKernelKind;
+
+    typedef TArray<FSWindowSegment> FWindows;
+    typedef TSharedPtr<const FWindows, ESPMode::ThreadSafe> FWindowsPtr;
+
+    struct FCoverageIndex
+    {
+        TMap<FKernelId, FWindowsPtr> Windows;
+        TArray<FString> Files;
+    };
+
+    typedef TSharedPtr<const FCoverageIndex, ESPMode::ThreadSafe> FCoverageIndexPtr;
+
+    FRWLock IndexLock;
+    FCoverageIndexPtr CurrentIndex;
+
+    FCoverageIndexPtr GetIndex()
+    {
+        FReadScopeLock Lock(IndexLock);
+        return CurrentIndex;
+    }
+
+    // Raw coverage per loaded file, game thread only
+    struct FFileCoverage
+    {
+        EKernelKind Kind = EKernelKind::SPK;
+        TMap<int32, FWindows> Windows;
+    };
+
+    TMap<FString, FFileCoverage> IndexedFiles;
+
+    // Which indexed files cover each id
+    TMap<FKernelId, TArray<FString>> FilesByKey;
+
+    // A heap-allocated cell.  SPICEINT_CELL/SPICEDOUBLE_CELL are static, with
+    // a size fixed at compile time.
+    template<typename T, SpiceCellDataType DataType>
+    struct TDynamicCell
+    {
+        explicit TDynamicCell(int32 Size)
+        {
+            Storage.SetNumZeroed(SPICE_CELL_CTRLSZ + Size);
+            Cell = { DataType, 0, Size, 0, SPICETRUE, SPICEFALSE, SPICEFALSE, Storage.GetData(), Storage.GetData() + SPICE_CELL_CTRLSZ };
+        }
+
+        TArray<T> Storage;
+        SpiceCell Cell;
+    };
+
+    typedef TDynamicCell<SpiceInt, SPICE_INT> FIntCell;
+    typedef TDynamicCell<SpiceDouble, SPICE_DP> FDoubleCell;
+
+    constexpr int32 InitialCellSize = 1000;
+    constexpr int32 MaxCellSize = 1 << 22;
+
+    bool IsCellTooSmall()
+    {
+        ANSICHAR szShort[SpiceLongMessageMaxLength];
+        szShort[0] = '\0';
+        getmsg_c("SHORT", sizeof(szShort), szShort);
+
+        return !FCStringAnsi::Strcmp(szShort, "SPICE(WINDOWEXCESS)")
+            || !FCStringAnsi::Strcmp(szShort, "SPICE(SETEXCESS)")
+            || !FCStringAnsi::Strcmp(szShort, "SPICE(CELLTOOSMALL)");
+    }
+
+    // Runs a CSPICE call that fills a cell, growing the cell as long as CSPICE
+    // says it's too small.  Null if it fails, with the CSPICE error left set.
+    template<typename CellType, typename FillType>
+    TUniquePtr<CellType> FillCell(FillType&& Fill)
+    {
+        for (int32 Size = InitialCellSize; Size <= MaxCellSize; Size *= 4)
+        {
+            TUniquePtr<CellType> Cell = MakeUnique<CellType>(Size);
+            Fill(&Cell->Cell);
+
+            if (!failed_c())
+            {
+                return Cell;
+            }
+            if (!IsCellTooSmall())
+            {
+                break;
+            }
+            reset_c();
+        }
+        return nullptr;
+    }
+
+    // False if any of the file couldn't be read
+    bool ScanFile(const FString& File, FFileCoverage& Coverage)
+    {
+        auto _file = StringCast<ANSICHAR>(*File);
+
+        TUniquePtr<FIntCell> Ids = FillCell<FIntCell>([&](SpiceCell* _ids)
+        {
+            switch (Coverage.Kind)
+            {
+            case EKernelKind::SPK: spkobj_c(_file.Get(), _ids); break;
+            case EKernelKind::CK:  ckobj_c(_file.Get(), _ids); break;
+            case EKernelKind::PCK: pckfrm_c(_file.Get(), _ids); break;
+            }
+        });
+
+        if (!Ids)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ coverage index could not read kernel %s"), *File);
+            UnexpectedErrorCheck();
+            return false;
+        }
+
+        for (SpiceInt i = 0; i < card_c(&Ids->Cell); ++i)
+        {
+            const SpiceInt _id = SPICE_CELL_ELEM_I(&Ids->Cell, i);
+
+            TUniquePtr<FDoubleCell> Cover = FillCell<FDoubleCell>([&](SpiceCell* _cover)
+            {
+                switch (Coverage.Kind)
+                {
+                case EKernelKind::SPK: spkcov_c(_file.Get(), _id, _cover); break;
+                // Any pointing, at the granularity of the segments' interpolation intervals
+                case EKernelKind::CK:  ckcov_c(_file.Get(), _id, SPICEFALSE, "INTERVAL", 0., "TDB", _cover); break;
+                case EKernelKind::PCK: pckcov_c(_file.Get(), _id, _cover); break;
+                }
+            });
+
+            if (!Cover)
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ coverage index could not read coverage of %d in kernel %s"), _id, *File);
+                UnexpectedErrorCheck();
+                return false;
+            }
+
+            FWindows& Windows = Coverage.Windows.Add(_id);
+            const SpiceInt Count = wncard_c(&Cover->Cell);
+            Windows.Reserve(Count);
+            for (SpiceInt j = 0; j < Count; ++j)
+            {
+                SpiceDouble _start, _stop;
+                wnfetd_c(&Cover->Cell, j, &_start, &_stop);
+                Windows.Emplace(_start, _stop);
+            }
+        }
+
+        return true;
+    }
+
+    // Sorted by start, overlapping & touching windows combined
+    FWindows MergeWindows(FWindows&& Windows)
+    {
+        Windows.Sort([](const FSWindowSegment& A, const FSWindowSegment& B) { return A.start < B.start; });
+
+        FWindows Merged;
+        Merged.Reserve(Windows.Num());
+        for (const FSWindowSegment& Window : Windows)
+        {
+            if (Merged.Num() > 0 && Window.start <= Merged.Last().stop)
+            {
+                Merged.Last().stop = FMath::Max(Merged.Last().stop, Window.stop);
+            }
+            else
+            {
+                Merged.Add(Window);
+            }
+        }
+        return Merged;
+    }
+
+    FWindowsPtr FindWindows(EKernelKind Kind, int32 Id)
+    {
+        FCoverageIndexPtr Index = GetIndex();
+        const FWindowsPtr* Windows = Index.IsValid() ? Index->Windows.Find(FKernelId { Kind, Id }) : nullptr;
+        return Windows ? *Windows : FWindowsPtr();
+    }
+
+    // Index of the last window starting at or before et, or INDEX_NONE
+    int32 FindWindowAtOrBefore(const FWindows& Windows, double et)
+    {
+        return Algo::UpperBoundBy(Windows, et, &FSWindowSegment::start) - 1;
+    }
+}
+
+
+namespace MaxQ::Coverage
+{
+    SPICE_API void Refresh()
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Coverage::Refresh);
+
+        // Binary PCKs are "PCK", text PCKs are "TEXT"
+        TArray<FLoadedKernel> Kernels;
+        if (!GetLoadedKernels(TEXT("SPK CK PCK"), Kernels))
+        {
+            return;
+        }
+
+        TMap<FString, EKernelKind> Loaded;
+        for (const FLoadedKernel& Kernel : Kernels)
+        {
+            EKernelKind Kind;
+            if (KernelKindFromType(Kernel.Type, Kind))
+            {
+                Loaded.Add(Kernel.File, Kind);
+            }
+        }
+
+        TSet<FKernelId> Affected;
+        bool bFilesChanged = false;
+
+        for (auto It = IndexedFiles.CreateIterator(); It; ++It)
+        {
+            const EKernelKind* Kind = Loaded.Find(It.Key());
+            if (!Kind || *Kind != It.Value().Kind)
+            {
+                for (const auto& [Id, Windows] : It.Value().Windows)
+                {
+                    const FKernelId Key { It.Value().Kind, Id };
+                    FilesByKey.FindChecked(Key).RemoveSingle(It.Key());
+                    Affected.Add(Key);
+                }
+                It.RemoveCurrent();
+                bFilesChanged = true;
+            }
+        }
+
+        for (const auto& [File, Kind] : Loaded)
+        {
+            if (!IndexedFiles.Contains(File))
+            {
+                FFileCoverage Scanned;
+                Scanned.Kind = Kind;
+
+                // Not indexed, so the next refresh tries it again
+                if (!ScanFile(File, Scanned))
+                {
+                    continue;
+                }
+
+                const FFileCoverage& Coverage = IndexedFiles.Add(File, MoveTemp(Scanned));
+                for (const auto& [Id, Windows] : Coverage.Windows)
+                {
+                    const FKernelId Key { Kind, Id };
+                    FilesByKey.FindOrAdd(Key).Add(File);
+                    Affected.Add(Key);
+                }
+                bFilesChanged = true;
+            }
+        }
+
+        FCoverageIndexPtr Previous = GetIndex();
+        if (!bFilesChanged && Previous.IsValid())
+        {
+            return;
+        }
+
+        TSharedRef<FCoverageIndex, ESPMode::ThreadSafe> Next = Previous.IsValid()
+            ? MakeShared<FCoverageIndex, ESPMode::ThreadSafe>(*Previous)
+            : MakeShared<FCoverageIndex, ESPMode::ThreadSafe>();
+
+        for (const FKernelId& Key : Affected)
+        {
+            FWindows Windows;
+            const TArray<FString>* Files = FilesByKey.Find(Key);
+            if (Files)
+            {
+                for (const FString& File : *Files)
+                {
+                    Windows.Append(IndexedFiles[File].Windows[Key.Id]);
+                }
+                if (Files->IsEmpty())
+                {
+                    FilesByKey.Remove(Key);
+                }
+            }
+
+            if (Windows.Num() > 0)
+            {
+                Next->Windows.Add(Key, MakeShared<const FWindows, ESPMode::ThreadSafe>(MergeWindows(MoveTemp(Windows))));
+            }
+            else
+            {
+                Next->Windows.Remove(Key);
+            }
+        }
+
+        IndexedFiles.GenerateKeyArray(Next->Files);
+        Next->Files.Sort();
+
+        FWriteScopeLock Lock(IndexLock);
+        CurrentIndex = Next;
+    }
+
+
+    SPICE_API bool IsCovered(EKernelKind Kind, int32 Id, const FSEphemerisTime& et)
+    {
+        FWindowsPtr Windows = FindWindows(Kind, Id);
+        if (!Windows.IsValid())
+        {
+            return false;
+        }
+
+        const int32 i = FindWindowAtOrBefore(*Windows, et.seconds);
+        return i != INDEX_NONE && et.seconds <= (*Windows)[i].stop;
+    }
+
+
+    SPICE_API bool GetCoverage(EKernelKind Kind, int32 Id, TArray<FSWindowSegment>& Windows)
+    {
+        FWindowsPtr Found = FindWindows(Kind, Id);
+        Windows = Found.IsValid() ? *Found : FWindows();
+        return Windows.Num() > 0;
+    }
+
+
+    SPICE_API bool NearestCovered(EKernelKind Kind, int32 Id, const FSEphemerisTime& et, FSEphemerisTime& Nearest)
+    {
+        FWindowsPtr Windows = FindWindows(Kind, Id);
+        if (!Windows.IsValid())
+        {
+            return false;
+        }
+
+        const int32 i = FindWindowAtOrBefore(*Windows, et.seconds);
+        if (i != INDEX_NONE && et.seconds <= (*Windows)[i].stop)
+        {
+            Nearest = et;
+            return true;
+        }
+
+        // Between windows i and i + 1 (either may not exist)
+        const bool bHasBefore = i != INDEX_NONE;
+        const bool bHasAfter = i + 1 < Windows->Num();
+        const double Before = bHasBefore ? (*Windows)[i].stop : 0.;
+        const double After = bHasAfter ? (*Windows)[i + 1].start : 0.;
+
+        if (bHasBefore && (!bHasAfter || et.seconds - Before <= After - et.seconds))
+        {
+            Nearest = FSEphemerisTime(Before);
+        }
+        else
+        {
+            Nearest = FSEphemerisTime(After);
+        }
+        return true;
+    }
+
+
+    SPICE_API TArray<int32> GetIds(EKernelKind Kind)
+    {
+        TArray<int32> Ids;
+
+        FCoverageIndexPtr Index = GetIndex();
+        if (Index.IsValid())
+        {
+            for (const auto& [Key, Windows] : Index->Windows)
+            {
+                if (Key.Kind == Kind)
+                {
+                    Ids.Add(Key.Id);
+                }
+            }
+        }
+
+        Ids.Sort();
+        return Ids;
+    }
+
+
+    SPICE_API TArray<FString> GetIndexedFiles()
+    {
+        FCoverageIndexPtr Index = GetIndex();
+        return Index.IsValid() ? Index->Files : TArray<FString>();
+    }
+
+
+    SPICE_API bool IsCovered(const FName& Body, const FSEphemerisTime& et)
+    {
+        int Id;
+        return MaxQ::Data::Bods2c(Id, Body) && IsCovered(EKernelKind::SPK, Id, et);
+    }
+
+
+    SPICE_API bool GetCoverage(const FName& Body, TArray<FSWindowSegment>& Windows)
+    {
+        int Id;
+        if (!MaxQ::Data::Bods2c(Id, Body))
+        {
+            Windows.Empty();
+            return false;
+        }
+        return GetCoverage(EKernelKind::SPK, Id, Windows);
+    }
+}
@@ -22,6 +22,10 @@
 //------------------------------------------------------------------------------
 
 #include "SpiceData.h"
+#include "SpiceConstantCache.h"
+#include "SpiceCore.h"
+#include "SpiceKernelCatalog.h"
+#include "SpiceTime.h"
 #include "SpiceUtilities.h"
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
@@ -96,6 +100,7 @@ namespace MaxQ::Data
 
     SPICE_API bool Furnsh(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Furnsh);
         FString fullPathToFile {toPath(relativePath)};
 
 #ifdef SET_WORKING_DIRECTORY_IN_FURNSH
@@ -126,6 +131,7 @@ namespace MaxQ::Data
 #endif
 
         bool bSuccess = !ErrorCheck(ResultCode, ErrorMessage);
+        OnKernelsChanged();
         if (bSuccess)
         {
             UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Furnsh' loaded kernel: %s"), *fullPathToFile);
@@ -135,6 +141,8 @@ namespace MaxQ::Data
 
     SPICE_API bool Furnsh(const TArray<FString>& relativePaths, ES_ResultCode* ResultCode, FString* ErrorMessage)
     {
+        FDeferKernelsChanged DeferKernelsChanged;
+
         bool bSuccess = true;
         for (auto file : relativePaths)
         {
@@ -152,27 +160,63 @@ namespace MaxQ::Data
     }
 
 
-    SPICE_API bool FurnshDirectory(const FString& relativeDirectory, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    SPICE_API bool FurnshDirectory(const FString& relativeDirectory, bool ErrorIfNoFilesFound, ES_ResultCode* pResultCode, FString* pErrorMessage)
     {
-        TArray<FString> relativePaths { EnumerateDirectory(relativeDirectory, true, ResultCode, ErrorMessage) };
+        MakeErrorGutter(pResultCode, pErrorMessage);
+        ES_ResultCode& ResultCode = *pResultCode;
+        FString& ErrorMessage = *pErrorMessage;
+
+        // Kernels only, in load order (LSK, PCK, FK... see SpiceKernelCatalog.h),
+        // rather than whatever order the file system lists them in
+        MaxQ::Catalog::FCatalogSettings Settings;
+        Settings.bRecursive = false;
+
+        TArray<MaxQ::Catalog::FCatalogEntry> Entries;
+        if (!MaxQ::Catalog::Scan(relativeDirectory, Entries, Settings, nullptr, &ResultCode, &ErrorMessage))
+        {
+            UE_LOG(LogSpice, Error, TEXT("MaxQ Spice Furnsh Directory: %s"), *ErrorMessage);
+            return false;
+        }
 
-        if (relativePaths.Num() > 0)
+        const TArray<FString> Paths { MaxQ::Catalog::LoadOrder(Entries) };
+        if (Paths.Num() == 0)
         {
-            return Furnsh(relativePaths, ResultCode, ErrorMessage);
+            if (ErrorIfNoFilesFound)
+            {
+                ErrorMessage = FString::Printf(TEXT("no kernel files were found in directory %s"), *relativeDirectory);
+                UE_LOG(LogSpice, Error, TEXT("MaxQ Spice Furnsh Directory: %s"), *ErrorMessage);
+                ResultCode = ES_ResultCode::Error;
+            }
+            return false;
         }
 
-        return false;
+        bool bSuccess = Furnsh(Paths, &ResultCode, &ErrorMessage);
+
+        for (const MaxQ::Catalog::FCatalogEntry& Entry : Entries)
+        {
+            if (!Entry.IsValid())
+            {
+                UE_LOG(LogSpice, Error, TEXT("MaxQ Spice Furnsh Directory: %s"), *Entry.Error);
+                ResultCode = ES_ResultCode::Error;
+                ErrorMessage = Entry.Error;
+                bSuccess = false;
+            }
+        }
+
+        return bSuccess;
     }
 
 
 
     SPICE_API bool Unload(const FString& relativePath, ES_ResultCode* ResultCode /*= nullptr*/, FString* ErrorMessage /*= nullptr */)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Unload);
         FString absolutePath = toPath(relativePath);
 
         unload_c(TCHAR_TO_ANSI(*absolutePath));
 
         bool bSuccess = !ErrorCheck(ResultCode, ErrorMessage);
+        OnKernelsChanged();
         if (bSuccess)
         {
             UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Unload' unloaded kernel : %s"), *absolutePath);
@@ -182,206 +226,259 @@ namespace MaxQ::Data
 
     SPICE_API FSEphemerisTime Now()
     {
-        auto now = FDateTime::UtcNow();
-        auto j2000 = FDateTime::FromJulianDay(2451545.0);
-        auto now_j2000 = now - j2000;
-
-        return FSEphemerisTime(now_j2000.GetTotalSeconds());
+        return MaxQ::Time::Now();
     }
 
-    // Size of FSAngle != sizeof double, ...
-    template<>
-    SPICE_API void Bodvrd(
-        FSAngle& Value,
-        const FString& bodynm,
-        const FString& item,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
+    // Every Bodvrd/Bodvcd/Gdpool overload funnels into these.  The FString
+    // overloads convert their arguments per call, the FName overloads pass the
+    // interned strings from MaxQ::Core::ToANSIString(FName) straight through.
+    // All of them read through MaxQ::ConstantCache.
+    namespace
     {
-        double _value;
-        Bodvrd(_value, bodynm, item, ResultCode, ErrorMessage);
-        Value = FSAngle::FromDegrees(_value);
-    }
+        inline void SizeMismatch(ES_ResultCode* ResultCode, FString* ErrorMessage, const FString& VariableName, SpiceInt n_expected, SpiceInt n_actual)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Blueprint request for %s Expected double[%d] but proc returned double[%d]"), *VariableName, n_expected, n_actual);
+        }
 
-    // With a little extra complexity we could get rid of this specialized version...
-    // Doubt if that's a net win, though.  Complexity FTL.
-    SPICE_API void Bodvrd(
-        double& Value,
-        const FString& bodynm,
-        const FString& item,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
-    {
-        constexpr SpiceInt N = sizeof (Value) / sizeof (SpiceDouble);
-        SpiceDouble _result[N]; ZeroOut(Value);
-        SpiceInt n_actual = 0;
+        inline void NotFound(ES_ResultCode* ResultCode, FString* ErrorMessage, const ANSICHAR* name)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Could not find pool variable %s"), ANSI_TO_TCHAR(name));
+        }
 
-        auto _bodynm = StringCast<ANSICHAR>(*bodynm);
-        auto _item = StringCast<ANSICHAR>(*item);
-        bodvrd_c(_bodynm.Get(), _item.Get(), N, &n_actual, _result);
+        inline FString BodyItemName(const ANSICHAR* bodynm, const ANSICHAR* item)
+        {
+            return FString::Printf(TEXT("%s_%s"), ANSI_TO_TCHAR(bodynm), ANSI_TO_TCHAR(item));
+        }
 
-        Value = _result[0];
+        inline FString BodyItemName(int bodyid, const ANSICHAR* item)
+        {
+            return FString::Printf(TEXT("BODY%d_%s"), bodyid, ANSI_TO_TCHAR(item));
+        }
 
-        if (!ErrorCheck(ResultCode, ErrorMessage) && n_actual != N)
+        // bodvrd_c
+        void BodvrdImpl(double& Value, const ANSICHAR* bodynm, const ANSICHAR* item, ES_ResultCode* ResultCode, FString* ErrorMessage)
         {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Blueprint request for %s_%s Expected double[%d] but proc returned double[%d]"), *bodynm, *item, N, n_actual);
+            SpiceDouble _result[1]; ZeroOut(_result);
+            int32 n_actual = 0;
+
+            bool bSuccess = MaxQ::ConstantCache::Bodvrd(bodynm, item, _result, 1, n_actual, ResultCode, ErrorMessage);
+
+            Value = _result[0];
+
+            if (bSuccess && n_actual != 1)
+            {
+                SizeMismatch(ResultCode, ErrorMessage, BodyItemName(bodynm, item), 1, n_actual);
+            }
         }
-    }
 
-    // TArray version...
-    // Caller must initialize TArray size to expected size
-    template<>
-    SPICE_API void Bodvrd(
-        TArray<double>& Values,
-        const FString& bodynm,
-        const FString& item,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
-    {
-        SpiceDouble* _result = Values.GetData();
-        SpiceInt n_actual, n_expected = Values.Num();
-        Values.Init(0, n_expected);
+        // Caller must initialize TArray size to expected size
+        void BodvrdImpl(TArray<double>& Values, const ANSICHAR* bodynm, const ANSICHAR* item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            int32 n_actual = 0, n_expected = Values.Num();
+            Values.Init(0, n_expected);
 
-        auto _bodynm = StringCast<ANSICHAR>(*bodynm);
-        auto _item = StringCast<ANSICHAR>(*item);
-        bodvrd_c(_bodynm.Get(), _item.Get(), n_expected, &n_actual, _result);
+            bool bSuccess = MaxQ::ConstantCache::Bodvrd(bodynm, item, Values.GetData(), n_expected, n_actual, ResultCode, ErrorMessage);
 
-        if (!ErrorCheck(ResultCode, ErrorMessage) && n_actual != n_expected)
+            if (bSuccess && n_actual != n_expected)
+            {
+                SizeMismatch(ResultCode, ErrorMessage, BodyItemName(bodynm, item), n_expected, n_actual);
+            }
+        }
+
+        // Size of FSAngle != sizeof double, ...
+        void BodvrdImpl(FSAngle& Value, const ANSICHAR* bodynm, const ANSICHAR* item, ES_ResultCode* ResultCode, FString* ErrorMessage)
         {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Blueprint request for %s_%s Expected double[%d] but proc returned double[%d]"), *bodynm, *item, n_expected, n_actual);
+            double _value;
+            BodvrdImpl(_value, bodynm, item, ResultCode, ErrorMessage);
+            Value = FSAngle::FromDegrees(_value);
         }
-    }
-    
-    template<typename ValueType>
-    SPICE_API void Bodvrd(
-        ValueType& Value,
-        const FString& bodynm,
-        const FString& item,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
-    {
-        constexpr SpiceInt N = sizeof (Value) / sizeof (SpiceDouble);
-        SpiceDouble _result[N]; ZeroOut(Value);
-        SpiceInt n_actual = 0;
 
-        auto _bodynm = StringCast<ANSICHAR>(*bodynm);
-        auto _item = StringCast<ANSICHAR>(*item);
+        template<typename ValueType>
+        void BodvrdImpl(ValueType& Value, const ANSICHAR* bodynm, const ANSICHAR* item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            constexpr SpiceInt N = sizeof (Value) / sizeof (SpiceDouble);
+            SpiceDouble _result[N]; ZeroOut(_result);
+            int32 n_actual = 0;
 
-        bodvrd_c(_bodynm.Get(), _item.Get(), N, &n_actual, _result);
+            bool bSuccess = MaxQ::ConstantCache::Bodvrd(bodynm, item, _result, N, n_actual, ResultCode, ErrorMessage);
 
-        Value = ValueType{ _result };
+            Value = ValueType{ _result };
 
-        if (!ErrorCheck(ResultCode, ErrorMessage) && n_actual != N)
-        {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Blueprint request for %s_%s Expected double[%d] but proc returned double[%d]"), *bodynm, *item, N, n_actual);
+            if (bSuccess && n_actual != N)
+            {
+                SizeMismatch(ResultCode, ErrorMessage, BodyItemName(bodynm, item), N, n_actual);
+            }
         }
-    }
 
-    template SPICE_API void Bodvrd<FSAngularVelocity>(FSAngularVelocity&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
-    template SPICE_API void Bodvrd<FSDistanceVector>(FSDistanceVector&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
-    template SPICE_API void Bodvrd<FSVelocityVector>(FSVelocityVector&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
-    template SPICE_API void Bodvrd<FSDimensionlessVector>(FSDimensionlessVector&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
-    template SPICE_API void Bodvrd<FSDistance>(FSDistance&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
-    template SPICE_API void Bodvrd<FSMassConstant>(FSMassConstant&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+        // bodvcd_c
+        void BodvcdImpl(double& Value, int bodyid, const ANSICHAR* item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            SpiceDouble _result[1]; ZeroOut(_result);
+            int32 n_actual = 0;
 
+            bool bSuccess = MaxQ::ConstantCache::Bodvcd(bodyid, item, _result, 1, n_actual, ResultCode, ErrorMessage);
 
-    // Size of FSAngle != sizeof double, ...
-    template<>
-    SPICE_API void Bodvcd(
-        FSAngle& Value,
-        int bodyid,
-        const FString& item,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
-    {
-        double _value;
-        Bodvcd(_value, bodyid, item, ResultCode, ErrorMessage);
-        Value = FSAngle::FromDegrees(_value);
-    }
+            Value = _result[0];
+
+            if (bSuccess && n_actual != 1)
+            {
+                SizeMismatch(ResultCode, ErrorMessage, BodyItemName(bodyid, item), 1, n_actual);
+            }
+        }
 
+        // Caller must initialize TArray size to expected size
+        void BodvcdImpl(TArray<double>& Values, int bodyid, const ANSICHAR* item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            int32 n_actual = 0, n_expected = Values.Num();
+            Values.Init(0, n_expected);
 
-    // TArray version...
-    // Caller must initialize TArray size to expected size
-    template<>
-    SPICE_API void Bodvcd(
-        TArray<double>& Values,
-        int bodyid,
-        const FString& item,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
-    {
-        SpiceDouble* _result = Values.GetData();
-        SpiceInt n_actual, n_expected = Values.Num();
-        Values.Init(0, n_expected);
+            bool bSuccess = MaxQ::ConstantCache::Bodvcd(bodyid, item, Values.GetData(), n_expected, n_actual, ResultCode, ErrorMessage);
 
-        bodvcd_c(bodyid, TCHAR_TO_ANSI(*item), n_expected, &n_actual, _result);
+            if (bSuccess && n_actual != n_expected)
+            {
+                SizeMismatch(ResultCode, ErrorMessage, BodyItemName(bodyid, item), n_expected, n_actual);
+            }
+        }
 
-        if (!ErrorCheck(ResultCode, ErrorMessage) && n_actual != n_expected)
+        // Size of FSAngle != sizeof double, ...
+        void BodvcdImpl(FSAngle& Value, int bodyid, const ANSICHAR* item, ES_ResultCode* ResultCode, FString* ErrorMessage)
         {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Blueprint request for BODY%d_%s Expected double[%d] but proc returned double[%d]"), bodyid, *item, n_expected, n_actual);
+            double _value;
+            BodvcdImpl(_value, bodyid, item, ResultCode, ErrorMessage);
+            Value = FSAngle::FromDegrees(_value);
         }
-    }
 
+        template<typename ValueType>
+        void BodvcdImpl(ValueType& Value, int bodyid, const ANSICHAR* item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            constexpr SpiceInt N = sizeof (Value) / sizeof (SpiceDouble);
+            SpiceDouble _result[N]; ZeroOut(_result);
+            int32 n_actual = 0;
 
-    // With a little extra complexity we could get rid of this specialized version...
-    // Doubt if that's a net win, though.  Complexity FTL.
-    SPICE_API void Bodvcd(
-        double& Value,
-        int bodyid,
-        const FString& item,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
-    {
-        constexpr SpiceInt N = sizeof (Value) / sizeof (SpiceDouble);
-        SpiceDouble _result[N]; ZeroOut(Value);
-        SpiceInt n_actual = 0;
+            bool bSuccess = MaxQ::ConstantCache::Bodvcd(bodyid, item, _result, N, n_actual, ResultCode, ErrorMessage);
 
-        bodvcd_c(bodyid, TCHAR_TO_ANSI(*item), N, &n_actual, _result);
+            Value = ValueType{ _result };
 
-        Value = _result[0];
+            if (bSuccess && n_actual != N)
+            {
+                SizeMismatch(ResultCode, ErrorMessage, BodyItemName(bodyid, item), N, n_actual);
+            }
+        }
 
-        if (!ErrorCheck(ResultCode, ErrorMessage) && n_actual != N)
+        // gdpool_c
+        void GdpoolImpl(double* Values, int32 Room, const ANSICHAR* name, ES_ResultCode* ResultCode, FString* ErrorMessage)
         {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Blueprint request for BODY%d_%s Expected double[%d] but proc returned double[%d]"), bodyid, *item, N, n_actual);
+            MakeErrorGutter(ResultCode, ErrorMessage);
+            int32 _n = 0;
+
+            if (!MaxQ::ConstantCache::Gdpool(name, Values, Room, _n, ResultCode, ErrorMessage) && *ResultCode == ES_ResultCode::Success)
+            {
+                NotFound(ResultCode, ErrorMessage, name);
+            }
         }
+
+        void GdpoolImpl(double& Value, const ANSICHAR* name, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            SpiceDouble _value{ 0 };
+            GdpoolImpl(&_value, 1, name, ResultCode, ErrorMessage);
+            Value = double{ _value };
+        }
+
+        // Caller must initialize TArray size to expected size
+        void GdpoolImpl(TArray<double>& Values, const ANSICHAR* name, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            const int32 _room = Values.Num();
+            Values.Init(0, _room);
+            GdpoolImpl(Values.GetData(), _room, name, ResultCode, ErrorMessage);
+        }
+
+        // Size of FSAngle != sizeof double, ...
+        void GdpoolImpl(FSAngle& Value, const ANSICHAR* name, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            double _value;
+            GdpoolImpl(_value, name, ResultCode, ErrorMessage);
+            Value = FSAngle::FromDegrees(_value);
+        }
+
+        template<typename ValueType>
+        void GdpoolImpl(ValueType& Value, const ANSICHAR* name, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            constexpr SpiceInt N = sizeof (ValueType) / sizeof (SpiceDouble);
+            SpiceDouble _values[N]; ZeroOut(_values);
+            GdpoolImpl(_values, N, name, ResultCode, ErrorMessage);
+            Value = ValueType{ _values };
+        }
+    }
+
+    // Bodvrd
+    SPICE_API void Bodvrd(double& Value, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        BodvrdImpl(Value, StringCast<ANSICHAR>(*bodynm).Get(), StringCast<ANSICHAR>(*item).Get(), ResultCode, ErrorMessage);
+    }
+
+    SPICE_API void Bodvrd(double& Value, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        BodvrdImpl(Value, MaxQ::Core::ToANSIString(bodynm), MaxQ::Core::ToANSIString(item), ResultCode, ErrorMessage);
     }
 
     template<typename ValueType>
-    SPICE_API void Bodvcd(
-        ValueType& Value,
-        int bodyid,
-        const FString& item,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
+    SPICE_API void Bodvrd(ValueType& Value, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        BodvrdImpl(Value, StringCast<ANSICHAR>(*bodynm).Get(), StringCast<ANSICHAR>(*item).Get(), ResultCode, ErrorMessage);
+    }
+
+    template<typename ValueType>
+    SPICE_API void Bodvrd(ValueType& Value, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        BodvrdImpl(Value, MaxQ::Core::ToANSIString(bodynm), MaxQ::Core::ToANSIString(item), ResultCode, ErrorMessage);
+    }
+
+    template SPICE_API void Bodvrd<FSAngle>(FSAngle&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<TArray<double>>(TArray<double>&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSAngularVelocity>(FSAngularVelocity&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSDistanceVector>(FSDistanceVector&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSVelocityVector>(FSVelocityVector&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSDimensionlessVector>(FSDimensionlessVector&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSDistance>(FSDistance&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSMassConstant>(FSMassConstant&, const FString& bodynm, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+
+    template SPICE_API void Bodvrd<FSAngle>(FSAngle&, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<TArray<double>>(TArray<double>&, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSAngularVelocity>(FSAngularVelocity&, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSDistanceVector>(FSDistanceVector&, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSVelocityVector>(FSVelocityVector&, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSDimensionlessVector>(FSDimensionlessVector&, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSDistance>(FSDistance&, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvrd<FSMassConstant>(FSMassConstant&, const FName& bodynm, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+
+
+    // Bodvcd
+    SPICE_API void Bodvcd(double& Value, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage)
     {
-        constexpr SpiceInt N = sizeof (Value) / sizeof (SpiceDouble);
-        SpiceDouble _result[N]; ZeroOut(Value);
-        SpiceInt n_actual = 0;
+        BodvcdImpl(Value, bodyid, StringCast<ANSICHAR>(*item).Get(), ResultCode, ErrorMessage);
+    }
 
-        bodvcd_c(bodyid, TCHAR_TO_ANSI(*item), N, &n_actual, _result);
+    SPICE_API void Bodvcd(double& Value, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        BodvcdImpl(Value, bodyid, MaxQ::Core::ToANSIString(item), ResultCode, ErrorMessage);
+    }
 
-        Value = ValueType{ _result };
+    template<typename ValueType>
+    SPICE_API void Bodvcd(ValueType& Value, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        BodvcdImpl(Value, bodyid, StringCast<ANSICHAR>(*item).Get(), ResultCode, ErrorMessage);
+    }
 
-        if (!ErrorCheck(ResultCode, ErrorMessage) && n_actual != N)
-        {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Blueprint request for BODY%s_%s Expected double[%d] but proc returned double[%d]"), bodyid, *item, N, n_actual);
-        }
+    template<typename ValueType>
+    SPICE_API void Bodvcd(ValueType& Value, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        BodvcdImpl(Value, bodyid, MaxQ::Core::ToANSIString(item), ResultCode, ErrorMessage);
     }
 
+    template SPICE_API void Bodvcd<FSAngle>(FSAngle&, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvcd<TArray<double>>(TArray<double>&, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
     template SPICE_API void Bodvcd<FSAngularVelocity>(FSAngularVelocity&, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
     template SPICE_API void Bodvcd<FSDistanceVector>(FSDistanceVector&, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
     template SPICE_API void Bodvcd<FSVelocityVector>(FSVelocityVector&, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
@@ -389,98 +486,41 @@ namespace MaxQ::Data
     template SPICE_API void Bodvcd<FSDistance>(FSDistance&, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
     template SPICE_API void Bodvcd<FSMassConstant>(FSMassConstant&, int bodyid, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
 
-    // TArray version...
-    // Caller must initialize TArray size to expected size
-    SPICE_API void Gdpool(
-        double& Value,
-        const FString& name,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
-    {
-        SpiceInt        _start{ 0 };
-        SpiceInt        _room{ 1 };
-        SpiceInt        _n{ 0 };
-        SpiceDouble     _value { 0 };
-        SpiceBoolean    _found = SPICEFALSE;
+    template SPICE_API void Bodvcd<FSAngle>(FSAngle&, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvcd<TArray<double>>(TArray<double>&, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvcd<FSAngularVelocity>(FSAngularVelocity&, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvcd<FSDistanceVector>(FSDistanceVector&, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvcd<FSVelocityVector>(FSVelocityVector&, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvcd<FSDimensionlessVector>(FSDimensionlessVector&, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvcd<FSDistance>(FSDistance&, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Bodvcd<FSMassConstant>(FSMassConstant&, int bodyid, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
 
-        gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
 
-        Value = double{ _value };
-
-        if (!ErrorCheck(ResultCode, ErrorMessage) && !_found)
-        {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Could not find pool variable %s"), *name);
-        }
+    // Gdpool
+    SPICE_API void Gdpool(double& Value, const FString& name, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        GdpoolImpl(Value, StringCast<ANSICHAR>(*name).Get(), ResultCode, ErrorMessage);
     }
 
-    // Size of FSAngle != sizeof double, ...
-    template<>
-    SPICE_API void Gdpool(
-        FSAngle& Value,
-        const FString& name,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
+    SPICE_API void Gdpool(double& Value, const FName& name, ES_ResultCode* ResultCode, FString* ErrorMessage)
     {
-        double _value;
-        Gdpool(_value, name, ResultCode, ErrorMessage);
-        Value = FSAngle::FromDegrees(_value);
+        GdpoolImpl(Value, MaxQ::Core::ToANSIString(name), ResultCode, ErrorMessage);
     }
 
-    // TArray version...
-    // Caller must initialize TArray size to expected size
-    template<>
-    SPICE_API void Gdpool(
-        TArray<double>& Values,
-        const FString& name,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
+    template<typename ValueType>
+    SPICE_API void Gdpool(ValueType& Value, const FString& name, ES_ResultCode* ResultCode, FString* ErrorMessage)
     {
-        SpiceInt        _start{ 0 };
-        SpiceInt        _room{ Values.Num() };
-        SpiceInt        _n{ 0 };
-        SpiceDouble*    _values{ Values.GetData() };
-        SpiceBoolean    _found = SPICEFALSE;
-
-        Values.Init(0, _room);
-
-        gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
-
-        if (!ErrorCheck(ResultCode, ErrorMessage) && !_found)
-        {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Could not find pool variable %s"), *name);
-        }
+        GdpoolImpl(Value, StringCast<ANSICHAR>(*name).Get(), ResultCode, ErrorMessage);
     }
 
     template<typename ValueType>
-    SPICE_API void Gdpool(
-        ValueType& Value,
-        const FString& name,
-        ES_ResultCode* ResultCode,
-        FString* ErrorMessage
-    )
+    SPICE_API void Gdpool(ValueType& Value, const FName& name, ES_ResultCode* ResultCode, FString* ErrorMessage)
     {
-        SpiceInt        _start { 0 };
-        SpiceInt        _room { sizeof (ValueType) / sizeof (SpiceDouble) };
-        SpiceInt        _n { 0 };
-        SpiceDouble     _values[sizeof (ValueType) / sizeof (SpiceDouble) ];
-        SpiceBoolean    _found = SPICEFALSE;
-
-        gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
-
-        Value = ValueType{ _values };
-
-        if (!ErrorCheck(ResultCode, ErrorMessage) && !_found)
-        {
-            if (ResultCode) *ResultCode = ES_ResultCode::Error;
-            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Could not find pool variable %s"), *name );
-        }
+        GdpoolImpl(Value, MaxQ::Core::ToANSIString(name), ResultCode, ErrorMessage);
     }
 
+    template SPICE_API void Gdpool<FSAngle>(FSAngle&, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Gdpool<TArray<double>>(TArray<double>&, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
     template SPICE_API void Gdpool<FSAngularVelocity>(FSAngularVelocity&, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
     template SPICE_API void Gdpool<FSDistanceVector>(FSDistanceVector&, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
     template SPICE_API void Gdpool<FSVelocityVector>(FSVelocityVector&, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
@@ -488,6 +528,15 @@ namespace MaxQ::Data
     template SPICE_API void Gdpool<FSDistance>(FSDistance&, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
     template SPICE_API void Gdpool<FSMassConstant>(FSMassConstant&, const FString& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
 
+    template SPICE_API void Gdpool<FSAngle>(FSAngle&, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Gdpool<TArray<double>>(TArray<double>&, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Gdpool<FSAngularVelocity>(FSAngularVelocity&, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Gdpool<FSDistanceVector>(FSDistanceVector&, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Gdpool<FSVelocityVector>(FSVelocityVector&, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Gdpool<FSDimensionlessVector>(FSDimensionlessVector&, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Gdpool<FSDistance>(FSDistance&, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+    template SPICE_API void Gdpool<FSMassConstant>(FSMassConstant&, const FName& item, ES_ResultCode* ResultCode, FString* ErrorMessage);
+
 
      SPICE_API bool Bodc2n(FString& name, int code /*= 399 */)
     {
@@ -508,6 +557,7 @@ namespace MaxQ::Data
 
     SPICE_API bool Bods2c(int& code, const FString& name /*= TEXT("EARTH") */)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Bods2c);
         SpiceInt _code = code;
         SpiceBoolean _found = SPICEFALSE;
         bods2c_c(TCHAR_TO_ANSI(*name), &_code, &_found);
@@ -520,8 +570,24 @@ namespace MaxQ::Data
         return _found == SPICETRUE;
     }
 
+    SPICE_API bool Bods2c(int& code, const FName& name)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Bods2c);
+        SpiceInt _code = code;
+        SpiceBoolean _found = SPICEFALSE;
+        bods2c_c(MaxQ::Core::ToANSIString(name), &_code, &_found);
+
+        if (_found) code = (int)_code;
+
+        // Reset the current spice error in case a spice exception happened.
+        UnexpectedErrorCheck(true);
+
+        return _found == SPICETRUE;
+    }
+
     SPICE_API bool Bodfnd(int body, const FString& item /*= TEXT("RADII") */)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Bodfnd);
         SpiceBoolean _found = bodfnd_c(body, TCHAR_TO_ANSI(*item));
 
         // Reset the current spice error in case a spice exception happened.
@@ -530,10 +596,35 @@ namespace MaxQ::Data
         return _found == SPICETRUE;
     }
 
+    SPICE_API bool Bodfnd(int body, const FName& item)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Bodfnd);
+        SpiceBoolean _found = bodfnd_c(body, MaxQ::Core::ToANSIString(item));
+
+        // Reset the current spice error in case a spice exception happened.
+        UnexpectedErrorCheck(true);
+
+        return _found == SPICETRUE;
+    }
+
     SPICE_API void Boddef(const FString& name, int code /*= 3788040 */)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Boddef);
         boddef_c(TCHAR_TO_ANSI(*name), (SpiceInt)code);
 
         UnexpectedErrorCheck(true);
+
+        // Name/code mappings aren't pool variables, nothing watches them
+        MaxQ::ConstantCache::InvalidateAll();
+    }
+
+    SPICE_API void Boddef(const FName& name, int code /*= 3788040 */)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Data::Boddef);
+        boddef_c(MaxQ::Core::ToANSIString(name), (SpiceInt)code);
+
+        UnexpectedErrorCheck(true);
+
+        MaxQ::ConstantCache::InvalidateAll();
     }
 }
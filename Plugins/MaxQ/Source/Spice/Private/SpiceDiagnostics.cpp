@@ -16,6 +16,7 @@
 //------------------------------------------------------------------------------
 
 #include "SpiceDiagnostics.h"
+#include "SpiceKernelInspector.h"
 #include "SpiceTypes.h"
 #include "Containers/StringFwd.h"
 #include "Spice.h"
@@ -36,463 +37,169 @@ PRAGMA_POP_PLATFORM_DEFAULT_PACKING
 
 using namespace MaxQ;
 using namespace MaxQ::Private;
+using namespace MaxQ::Inspector;
 
 DEFINE_LOG_CATEGORY(LogSpiceDiagnostics);
 
-void USpiceDiagnostics::DumpSpkSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath, const FString& relativeSpkPath)
+namespace
 {
-    LogString.Empty();
-    FString fullPathToFile = toPath(relativeSpkPath);
-
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Get the current working directory...
-    TCHAR buffer[WINDOWS_MAX_PATH];
-    TCHAR* oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
-
-    // Trim the file name to just the full directory path...
-    FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
-    fullPathToDirectory.ReplaceCharInline('/', '\\');
-
-    if (FPaths::DirectoryExists(fullPathToDirectory))
+    // Reads the file's summaries, without loading it
+    bool InspectForDump(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& relativePath, const TCHAR* ExpectedType, FKernelSummary& Summary)
     {
-        // Set the current working directory
-        _tchdir(*fullPathToDirectory);
-    }
-#endif
-
-    // Implementation from:
-    // https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/spkcov_c.html
-    constexpr int32  MAXIV{ 1000 };
-    constexpr int32  WINSIZ{ (2 * MAXIV) };
-    constexpr int32  TIMLEN{ 51 };
-    constexpr int32  MAXOBJ{ 1000 };
-
-    /*
-        Local variables
-    */
-
-    SPICEDOUBLE_CELL(cover, WINSIZ);
-    SPICEINT_CELL(ids, MAXOBJ);
-
-    SpiceChar               timstr[TIMLEN];
-
-    SpiceDouble             b;
-    SpiceDouble             e;
-
-    SpiceInt                i;
-    SpiceInt                j;
-    SpiceInt                niv;
-    SpiceInt                obj;
-
-
-    /*
-    Load a leapseconds kernel for output time conversion.
-    spkcov_c itself does not require a leapseconds kernel.
-    */
-    furnsh_c(TCHAR_TO_ANSI(*toPath(relativeLskPath)));
-
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
-
-    /*
-    Get name of SPK file.
-    */
-    LogString += FString::Printf(TEXT("Name of LSK file > %s\n"), *relativeLskPath);
-
-    /*
-    Find the set of objects in the SPK file.
-    */
-    spkobj_c(TCHAR_TO_ANSI(*toPath(relativeSpkPath)), &ids);
-
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
-
-    LogString += FString::Printf(TEXT("Name of SPK file > %s\n"), *relativeSpkPath);
-
-    /*
-    We want to display the coverage for each object.Loop over
-    the contents of the ID code set, find the coverage for
-    each item in the set, and display the coverage.
-    */
-    for (i = 0; i < card_c(&ids); i++)
-    {
-        /*
-        Find the coverage window for the current object.
-        Empty the coverage window each time so we don't
-        include data for the previous object.
-        */
-        obj = SPICE_CELL_ELEM_I(&ids, i);
-
-        scard_c(0, &cover);
-        spkcov_c(TCHAR_TO_ANSI(*toPath(relativeSpkPath)), obj, &cover);
-
-        if (ErrorCheck(ResultCode, ErrorMessage)) return;
+        FInspectSettings Settings;
+        Settings.bComments = false;
 
-        /*
-        Get the number of intervals in the coverage window.
-        */
-        niv = wncard_c(&cover);
-
-        /*
-        Display a simple banner.
-        */
-        LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
-        SpiceBoolean found;
-        char szBodyName[256];
-        bodc2n_c(obj, sizeof(szBodyName) - 1, szBodyName, &found);
-
-        LogString += FString::Printf(TEXT("Coverage for object %d (%s)\n"), (int)obj, found ? *FString(szBodyName) : TEXT("NAIF ID not found"));
-
-        /*
-        Convert the coverage interval start and stop times to TDB
-        calendar strings.
-        */
-        for (j = 0; j < niv; j++)
+        InspectKernel(relativePath, Summary, Settings, &ResultCode, &ErrorMessage);
+        if (ResultCode != ES_ResultCode::Success)
         {
-            /*
-            Get the endpoints of the jth interval.
-            */
-            wnfetd_c(&cover, j, &b, &e);
-
-            /*
-            Convert the endpoints to TDB calendar
-            format time strings and display them.
-            */
-            timout_c(b,
-                "YYYY MON DD HR:MN:SC.### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-
-            LogString += FString::Printf(TEXT("\n")
-                TEXT("Interval:  %d\n")
-                TEXT("Start:     %s\n"),
-                (int)j,
-                *FString(timstr));
-
-            timout_c(e,
-                "YYYY MON DD HR:MN:SC.### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-            LogString += FString::Printf(TEXT("Stop:      %s\n"), *FString(timstr));
-
+            return false;
         }
+        if (Summary.FileType != ExpectedType)
+        {
+            ResultCode = ES_ResultCode::Error;
+            ErrorMessage = FString::Printf(TEXT("%s is not a binary %s file (%s)"), *relativePath, ExpectedType, *Summary.IdWord);
+            return false;
+        }
+        return true;
     }
 
-    LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
-    UE_LOG(LogSpiceDiagnostics, Log, TEXT("Spice SPK Coverage diagnostic:\n%s"), *LogString);
-
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Reset the working directory to prior state...
-    if (oldWorkingDirectory)
+    // The same listing spkcov_c's example prints, per id
+    template<typename LabelType, typename TimeType>
+    void AppendCoverage(FString& LogString, const FKernelSummary& Summary, LabelType&& Label, TimeType&& Time)
     {
-        _tchdir(oldWorkingDirectory);
-    }
-#endif
+        for (int32 Id : GetIds(Summary))
+        {
+            LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
+            LogString += Label(Id);
+
+            const TArray<FSWindowSegment> Coverage = GetCoverage(Summary, Id);
+            for (int32 j = 0; j < Coverage.Num(); ++j)
+            {
+                LogString += FString::Printf(TEXT("\n")
+                    TEXT("Interval:  %d\n")
+                    TEXT("Start:     %s\n"),
+                    j,
+                    *Time(Id, Coverage[j].start));
+                LogString += FString::Printf(TEXT("Stop:      %s\n"), *Time(Id, Coverage[j].stop));
+            }
+        }
 
-    ErrorCheck(ResultCode, ErrorMessage);
+        LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
+    }
 }
 
-void USpiceDiagnostics::DumpPckSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath /*= TEXT("NonAssetData/naif/kernels/Generic/LSK/naif0012.tls")*/, const FString& relativePckPath /*= TEXT("NonAssetData/naif/kernels/Generic/PCK/earth_200101_990628_predict.bpc") */)
+
+// Reads the SPK's segment summaries directly (SpiceKernelInspector.h), without
+// loading it, and formats TDB without a leapseconds kernel.  bodc2n_c only
+// reads the built-in & loaded body names.
+void USpiceDiagnostics::DumpSpkCoverage(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeSpkPath)
 {
+    check(IsInGameThread());
     LogString.Empty();
-    FString fullPathToFile = toPath(relativePckPath);
-
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Get the current working directory...
-    TCHAR buffer[WINDOWS_MAX_PATH];
-    TCHAR* oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
-
-    // Trim the file name to just the full directory path...
-    FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
-    fullPathToDirectory.ReplaceCharInline('/', '\\');
-
-    if (FPaths::DirectoryExists(fullPathToDirectory))
-    {
-        // Set the current working directory
-        _tchdir(*fullPathToDirectory);
-    }
-#endif
-
-    // Implementation from:
-    // https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/pckfrm_c.html
-
-    /*
-        Local parameters
-    */
-    constexpr int32  FILSIZ{ 256 };
-    constexpr int32  MAXIV{ 1000 };
-    constexpr int32  WINSIZ{ (2 * MAXIV) };
-    constexpr int32  TIMLEN{ 51 };
-    constexpr int32  MAXOBJ{ 1000 };
-
-    /*
-    Local variables
-    */
-    SPICEDOUBLE_CELL(cover, WINSIZ);
-    SPICEINT_CELL(ids, MAXOBJ);
-
-    SpiceChar               timstr[TIMLEN];
-
-    SpiceDouble             b{ 0. };
-    SpiceDouble             e{ 0. };
-
-    SpiceInt                i;
-    SpiceInt                j;
-    SpiceInt                niv;
-    SpiceInt                obj;
 
+    FKernelSummary Summary;
+    if (!InspectForDump(ResultCode, ErrorMessage, relativeSpkPath, TEXT("SPK"), Summary)) return;
 
-    /*
-        Load a leapseconds kernel for output time conversion.
-        pckcov_c itself does not require a leapseconds kernel.
-        */
-
-    furnsh_c(TCHAR_TO_ANSI(*toPath(relativeLskPath)));
+    LogString += FString::Printf(TEXT("Name of SPK file > %s\n"), *relativeSpkPath);
 
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
+    AppendCoverage(LogString, Summary,
+        [](int32 obj)
+        {
+            SpiceBoolean found = SPICEFALSE;
+            char szBodyName[256];
+            bodc2n_c(obj, sizeof(szBodyName) - 1, szBodyName, &found);
+            UnexpectedErrorCheck(true);
 
-    LogString += FString::Printf(TEXT("Name of LSK file > %s\n"), *relativeLskPath);
+            return FString::Printf(TEXT("Coverage for object %d (%s)\n"), obj, found ? *FString(szBodyName) : TEXT("NAIF ID not found"));
+        },
+        [](int32, double et) { return FormatTdb(et); });
 
+    UE_LOG(LogSpiceDiagnostics, Log, TEXT("Spice SPK Coverage diagnostic:\n%s"), *LogString);
+}
 
-    /*
-        Find the set of frames in the PCK file.
-        */
-    pckfrm_c(TCHAR_TO_ANSI(*toPath(relativePckPath)), &ids);
+void USpiceDiagnostics::DumpPckCoverage(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativePckPath)
+{
+    check(IsInGameThread());
+    LogString.Empty();
 
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
+    FKernelSummary Summary;
+    if (!InspectForDump(ResultCode, ErrorMessage, relativePckPath, TEXT("PCK"), Summary)) return;
 
     LogString += FString::Printf(TEXT("Name of PCK file > %s\n"), *relativePckPath);
 
-    /*
-        We want to display the coverage for each frame.Loop over
-        the contents of the ID code set, find the coverage for
-        each item in the set, and display the coverage.
-        */
-    for (i = 0; i < card_c(&ids); i++)
-    {
-        /*
-            Find the coverage window for the current frame.
-            Empty the coverage window each time so we don't
-            include data for the previous frame.
-            */
-        obj = SPICE_CELL_ELEM_I(&ids, i);
-
-        scard_c(0, &cover);
-        pckcov_c(TCHAR_TO_ANSI(*toPath(relativePckPath)), obj, &cover);
-
-        if (ErrorCheck(ResultCode, ErrorMessage)) return;
-
-        /*
-            Get the number of intervals in the coverage window.
-            */
-        niv = wncard_c(&cover);
-
-        /*
-            Display a simple banner.
-            */
-        LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
-        LogString += FString::Printf(TEXT("Coverage for frame %d\n"), (int)obj);
-
-        /*
-            Convert the coverage interval start and stop times to TDB
-            calendar strings.
-            */
-        for (j = 0; j < niv; j++)
-        {
-            /*
-                Get the endpoints of the jth interval.
-                . /
-                wnfetd_c(&cover, j, &b, &e);
-
-            */
-            timout_c(b,
-                "YYYY MON DD HR:MN:SC.### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-
-            LogString += FString::Printf(TEXT("\n")
-                TEXT("Interval:  %d\n")
-                TEXT("Start:     %s\n"),
-                (int)j,
-                *FString(timstr));
-
-            timout_c(e,
-                "YYYY MON DD HR:MN:SC.### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-            LogString += FString::Printf(TEXT("Stop:      %s\n"), *FString(timstr));
-        }
-    }
-
-    LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
+    AppendCoverage(LogString, Summary,
+        [](int32 obj) { return FString::Printf(TEXT("Coverage for frame %d\n"), obj); },
+        [](int32, double et) { return FormatTdb(et); });
 
     UE_LOG(LogSpiceDiagnostics, Log, TEXT("Spice Binary PCK Coverage diagnostic:\n%s"), *LogString);
-
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Reset the working directory to prior state...
-    if (oldWorkingDirectory)
-    {
-        _tchdir(oldWorkingDirectory);
-    }
-#endif
-
-    ErrorCheck(ResultCode, ErrorMessage);
 }
 
-void USpiceDiagnostics::DumpCkSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath /*= TEXT("NonAssetData/naif/kernels/Generic/LSK/naif0012.tls")*/, const FString& relativeSclkPath /*= TEXT("NonAssetData/naif/kernels/INSIGHT/SCLK/NSY_SCLKSCET.00023.tsc")*/, const FString& relativeCkPath /*= TEXT("NonAssetData/naif/kernels/INSIGHT/CK/ckckck") */)
+// CK coverage is in encoded SCLK.  If the object's spacecraft clock and a
+// leapseconds kernel are already loaded, it's shown as TDB too;  nothing is
+// loaded here.
+void USpiceDiagnostics::DumpCkCoverage(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeCkPath)
 {
+    check(IsInGameThread());
     LogString.Empty();
-    FString fullPathToFile = toPath(relativeCkPath);
 
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Get the current working directory...
-    TCHAR buffer[WINDOWS_MAX_PATH];
-    TCHAR* oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
+    FKernelSummary Summary;
+    if (!InspectForDump(ResultCode, ErrorMessage, relativeCkPath, TEXT("CK"), Summary)) return;
 
-    // Trim the file name to just the full directory path...
-    FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
-    fullPathToDirectory.ReplaceCharInline('/', '\\');
+    LogString += FString::Printf(TEXT("Name of CK file > %s\n"), *relativeCkPath);
 
-    if (FPaths::DirectoryExists(fullPathToDirectory))
+    auto IsInPool = [](const ANSICHAR* name)
     {
-        // Set the current working directory
-        _tchdir(*fullPathToDirectory);
-    }
-#endif
-
-
-    // Implementation from:
-    // https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/ckcov_c.html
-
-    /*
-        Local parameters
-        */
-    constexpr int32  FILSIZ{ 256 };
-    constexpr int32  MAXIV{ 100000 };
-    constexpr int32  WINSIZ{ (2 * MAXIV) };
-    constexpr int32  TIMLEN{ 51 };
-    constexpr int32  MAXOBJ{ 1000 };
-
-    /*
-            Local variables
-            */
-    SPICEDOUBLE_CELL(cover, WINSIZ);
-    SPICEINT_CELL(ids, MAXOBJ);
-
-    SpiceChar               timstr[TIMLEN];
-
-    SpiceDouble             b;
-    SpiceDouble             e;
-
-    SpiceInt                i;
-    SpiceInt                j;
-    SpiceInt                niv;
-    SpiceInt                obj;
-
-
-    /*
-        Load a leapseconds kernel and SCLK kernel for output time
-        conversion.Note that we assume a single spacecraft clock is
-        associated with all of the objects in the CK.
-        */
-
-    furnsh_c(TCHAR_TO_ANSI(*toPath(relativeLskPath)));
-
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
-    LogString += FString::Printf(TEXT("Name of LSK file > %s\n"), *relativeLskPath);
-
-    furnsh_c(TCHAR_TO_ANSI(*toPath(relativeSclkPath)));
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
-    LogString += FString::Printf(TEXT("Name of SCLK file > %s\n"), *relativeSclkPath);
-
-    /*
-        Find the set of objects in the CK file.
-        */
-    ckobj_c(TCHAR_TO_ANSI(*toPath(relativeCkPath)), &ids);
-
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
-
-    /*
-        We want to display the coverage for each object.Loop over
-        the contents of the ID code set, find the coverage for
-        each item in the set, and display the coverage.
-        */
-    for (i = 0; i < card_c(&ids); i++)
-    {
-        /*
-            Find the coverage window for the current object.
-            Empty the coverage window each time so we don't
-            include data for the previous object.
-            */
-        obj = SPICE_CELL_ELEM_I(&ids, i);
-
-        scard_c(0, &cover);
-        ckcov_c(TCHAR_TO_ANSI(*toPath(relativeCkPath)), obj, SPICEFALSE,
-            "INTERVAL", 0.0, "TDB", &cover);
-
-        if (ErrorCheck(ResultCode, ErrorMessage)) return;
-        /*
-            Get the number of intervals in the coverage window.
-            */
-        niv = wncard_c(&cover);
-
-        /*
-            Display a simple banner.
-            */
-        LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
-        LogString += FString::Printf(TEXT("Coverage for object %d\n"), (int)obj);
-
-        /*
-            Convert the coverage interval start and stop times to TDB
-            calendar strings.
-            */
-        for (j = 0; j < niv; j++)
+        SpiceBoolean found = SPICEFALSE;
+        SpiceInt n = 0;
+        SpiceChar type = 'N';
+        dtpool_c(name, &found, &n, &type);
+        return found == SPICETRUE;
+    };
+    const bool bHaveLsk = IsInPool("DELTET/DELTA_AT");
+
+    AppendCoverage(LogString, Summary,
+        [](int32 obj) { return FString::Printf(TEXT("Coverage for object %d\n"), obj); },
+        [&](int32 obj, double sclkdp)
         {
-            /*
-                Get the endpoints of the jth interval.
-                */
-            wnfetd_c(&cover, j, &b, &e);
-
-            /*
-                Convert the endpoints to TDB calendar
-                format time strings and display them.
-                */
-            timout_c(b,
-                "YYYY MON DD HR:MN:SC.###### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-
-            LogString += FString::Printf(TEXT("\n")
-                TEXT("Interval:  %d\n")
-                TEXT("Start:     %s\n"),
-                (int)j,
-                *FString(timstr));
-
-            timout_c(e,
-                "YYYY MON DD HR:MN:SC.###### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-            LogString += FString::Printf(TEXT("Stop:      %s\n"), *FString(timstr));
-
-        }
-    }
-
-    LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
+            FString Result = FString::Printf(TEXT("%.3f (SCLK ticks)"), sclkdp);
+
+            SpiceInt sc = 0;
+            ckmeta_c(obj, "SCLK", &sc);
+            if (!failed_c() && bHaveLsk && IsInPool(TCHAR_TO_ANSI(*FString::Printf(TEXT("SCLK01_COEFFICIENTS_%d"), FMath::Abs((int32)sc)))))
+            {
+                SpiceDouble et = 0.;
+                sct2e_c(sc, sclkdp, &et);
+                if (!failed_c())
+                {
+                    Result = FormatTdb(et, 6) + TEXT(", ") + Result;
+                }
+            }
+
+            // No clock for this object is fine, the ticks are listed anyway
+            if (failed_c())
+            {
+                reset_c();
+            }
+            return Result;
+        });
 
     UE_LOG(LogSpiceDiagnostics, Log, TEXT("Spice CK Coverage diagnostic:\n%s"), *LogString);
+}
 
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Reset the working directory to prior state...
-    if (oldWorkingDirectory)
-    {
-        _tchdir(oldWorkingDirectory);
-    }
-#endif
+// Deprecated:  nothing is loaded any more, so the LSK & SCLK paths are unused
+void USpiceDiagnostics::DumpSpkSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath, const FString& relativeSpkPath)
+{
+    DumpSpkCoverage(ResultCode, ErrorMessage, LogString, relativeSpkPath);
+}
 
-    ErrorCheck(ResultCode, ErrorMessage);
+void USpiceDiagnostics::DumpPckSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath, const FString& relativePckPath)
+{
+    DumpPckCoverage(ResultCode, ErrorMessage, LogString, relativePckPath);
+}
+
+void USpiceDiagnostics::DumpCkSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath, const FString& relativeSclkPath, const FString& relativeCkPath)
+{
+    DumpCkCoverage(ResultCode, ErrorMessage, LogString, relativeCkPath);
 }
 
 void USpiceDiagnostics::DumpLoadedKernelFiles(FString& LogString)
@@ -0,0 +1,582 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDsk.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Fast ray casting against DSK type 2 (triangular plate) shape
+// models
+//
+// The hierarchy is built top down.  Each node's plates are binned by
+// centroid along every axis, and split where the surface area heuristic is
+// cheapest; nodes that no split improves on become leaves.  Siblings are
+// stored side by side.
+//
+// Rays are cast in packets of PacketSize, stored structure-of-arrays.  A
+// node is visited if any ray in the packet may hit it, and the per-ray slab
+// and triangle tests are plain loops over the packet the compiler can
+// vectorize.  Rays that already hit something nearer than a node drop out of
+// its test.  Coherent batches (scan lines, LIDAR sweeps, ...) share most of
+// their traversal.
+//
+// Like dskx02_c, plates are hit from either side, and slightly expanded
+// (PlateExpansion, in barycentric units) so rays through shared edges and
+// vertices can't slip between plates.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDsk.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceDsk.h"
+#include "Algo/Partition.h"
+#include "Async/ParallelFor.h"
+#include "SpiceData.h"
+#include "SpiceProfiling.h"
+#include "SpiceUtilities.h"
+#include <algorithm>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr int32 SahBins = 16;
+    constexpr int32 MaxLeafPlates = 8;
+
+    // Relative costs of a node visit and a plate test
+    constexpr double TraversalCost = 1.;
+    constexpr double IntersectionCost = 1.;
+
+    constexpr double PlateExpansion = 1e-10;
+
+    struct FBuildPlate
+    {
+        FBox3d Box;
+        FVector3d Centroid;
+        int32 Plate;
+    };
+
+    double HalfArea(const FBox3d& Box)
+    {
+        const FVector3d Extent = Box.Max - Box.Min;
+        return Extent.X * Extent.Y + Extent.Y * Extent.Z + Extent.Z * Extent.X;
+    }
+
+    // Nearer than anything a ray can hit
+    constexpr double NoHit = TNumericLimits<double>::Max();
+
+    // Stands in for zero ray direction components
+    constexpr double TinyDirection = 1e-300;
+
+    // Appends a type 2 segment's vertices and plates (made zero-based)
+    bool ReadSegment(SpiceInt Handle, const SpiceDLADescr& Dla, TArray<FVector3d>& Vertices, TArray<FIntVector3>& Plates)
+    {
+        static_assert(sizeof(FVector3d) == sizeof(SpiceDouble[3]), "dskv02_c writes straight into FVector3d");
+        static_assert(sizeof(FIntVector3) == sizeof(SpiceInt[3]), "dskp02_c writes straight into FIntVector3");
+
+        SpiceInt _nv = 0, _np = 0;
+        dskz02_c(Handle, &Dla, &_nv, &_np);
+        if (failed_c())
+        {
+            return false;
+        }
+
+        const int32 VertexBase = Vertices.Num();
+        const int32 PlateBase = Plates.Num();
+        Vertices.AddUninitialized(_nv);
+        Plates.AddUninitialized(_np);
+
+        SpiceInt _n = 0;
+        dskv02_c(Handle, &Dla, 1, _nv, &_n, (SpiceDouble(*)[3])(Vertices.GetData() + VertexBase));
+        dskp02_c(Handle, &Dla, 1, _np, &_n, (SpiceInt(*)[3])(Plates.GetData() + PlateBase));
+        if (failed_c())
+        {
+            return false;
+        }
+
+        const FIntVector3 Offset(VertexBase - 1);
+        for (int32 i = PlateBase; i < Plates.Num(); ++i)
+        {
+            Plates[i] += Offset;
+        }
+        return true;
+    }
+}
+
+
+namespace MaxQ::Dsk
+{
+    struct FPlateModel::FPacket
+    {
+        double Ox[PacketSize], Oy[PacketSize], Oz[PacketSize];
+        double Dx[PacketSize], Dy[PacketSize], Dz[PacketSize];
+        double InvDx[PacketSize], InvDy[PacketSize], InvDz[PacketSize];
+        double Nearest[PacketSize];     // Ray parameter of the nearest hit so far, < 0 if inactive
+        int32 Triangle[PacketSize];
+    };
+
+
+    FPlateModel::FPlateModel(TArray<FVector3d>&& InVertices, TArray<FIntVector3>&& InPlates, int32 InBody, int32 InFrameId)
+        : Bounds(ForceInit)
+        , NumModelVertices(InVertices.Num())
+        , Body(InBody)
+        , FrameId(InFrameId)
+    {
+        Build(InVertices, InPlates);
+    }
+
+
+    void FPlateModel::Build(const TArray<FVector3d>& Vertices, const TArray<FIntVector3>& Plates)
+    {
+        TArray<FBuildPlate> BuildPlates;
+        BuildPlates.Reserve(Plates.Num());
+
+        for (int32 i = 0; i < Plates.Num(); ++i)
+        {
+            const FIntVector3& Plate = Plates[i];
+            if (!Vertices.IsValidIndex(Plate.X) || !Vertices.IsValidIndex(Plate.Y) || !Vertices.IsValidIndex(Plate.Z))
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ::Dsk::FPlateModel skipping plate %d, vertex index out of range"), i + 1);
+                continue;
+            }
+
+            FBox3d Box(ForceInit);
+            Box += Vertices[Plate.X];
+            Box += Vertices[Plate.Y];
+            Box += Vertices[Plate.Z];
+            BuildPlates.Add({ Box, Box.GetCenter(), i });
+            Bounds += Box;
+        }
+
+        Nodes.Reset();
+        Triangles.Reset(BuildPlates.Num());
+
+        if (BuildPlates.IsEmpty())
+        {
+            return;
+        }
+
+        Nodes.Reserve(2 * BuildPlates.Num() / MaxLeafPlates + 1);
+
+        struct FRange
+        {
+            int32 Node;
+            int32 Begin;
+            int32 End;
+        };
+
+        TArray<FRange, TInlineAllocator<64>> Pending;
+        Nodes.AddDefaulted();
+        Pending.Push({ 0, 0, BuildPlates.Num() });
+
+        while (Pending.Num() > 0)
+        {
+            const FRange Range = Pending.Pop(false);
+            const int32 Count = Range.End - Range.Begin;
+
+            FBox3d NodeBox(ForceInit), CentroidBox(ForceInit);
+            for (int32 i = Range.Begin; i < Range.End; ++i)
+            {
+                NodeBox += BuildPlates[i].Box;
+                CentroidBox += BuildPlates[i].Centroid;
+            }
+
+            Nodes[Range.Node].Min = NodeBox.Min;
+            Nodes[Range.Node].Max = NodeBox.Max;
+
+            // Cheapest binned split over all three axes
+            int32 BestAxis = INDEX_NONE, BestBin = 0;
+            double BestCost = IntersectionCost * Count;
+
+            const FVector3d CentroidExtent = CentroidBox.Max - CentroidBox.Min;
+            if (Count > 1)
+            {
+                for (int32 Axis = 0; Axis < 3; ++Axis)
+                {
+                    if (CentroidExtent[Axis] <= 0.)
+                    {
+                        continue;
+                    }
+
+                    int32 BinCounts[SahBins] = {};
+                    FBox3d BinBoxes[SahBins];
+                    for (FBox3d& BinBox : BinBoxes) BinBox = FBox3d(ForceInit);
+
+                    const double Scale = SahBins / CentroidExtent[Axis];
+                    for (int32 i = Range.Begin; i < Range.End; ++i)
+                    {
+                        const int32 Bin = FMath::Min(SahBins - 1, (int32)((BuildPlates[i].Centroid[Axis] - CentroidBox.Min[Axis]) * Scale));
+                        ++BinCounts[Bin];
+                        BinBoxes[Bin] += BuildPlates[i].Box;
+                    }
+
+                    // Sweep from the right, then evaluate splits sweeping from the left
+                    double RightArea[SahBins];
+                    int32 RightCount[SahBins];
+                    FBox3d Accumulated(ForceInit);
+                    int32 Accumulating = 0;
+                    for (int32 Bin = SahBins - 1; Bin > 0; --Bin)
+                    {
+                        Accumulated += BinBoxes[Bin];
+                        Accumulating += BinCounts[Bin];
+                        RightArea[Bin] = Accumulating ? HalfArea(Accumulated) : 0.;
+                        RightCount[Bin] = Accumulating;
+                    }
+
+                    const double InvNodeArea = 1. / FMath::Max(HalfArea(NodeBox), UE_DOUBLE_SMALL_NUMBER);
+                    Accumulated = FBox3d(ForceInit);
+                    Accumulating = 0;
+                    for (int32 Bin = 0; Bin < SahBins - 1; ++Bin)
+                    {
+                        Accumulated += BinBoxes[Bin];
+                        Accumulating += BinCounts[Bin];
+                        if (Accumulating == 0 || RightCount[Bin + 1] == 0)
+                        {
+                            continue;
+                        }
+
+                        const double Cost = TraversalCost + IntersectionCost * InvNodeArea *
+                            (Accumulating * HalfArea(Accumulated) + RightCount[Bin + 1] * RightArea[Bin + 1]);
+                        if (Cost < BestCost)
+                        {
+                            BestCost = Cost;
+                            BestAxis = Axis;
+                            BestBin = Bin;
+                        }
+                    }
+                }
+            }
+
+            // Large nodes get split even when the heuristic says otherwise, down
+            // the middle if every centroid coincides along the best axis.
+            int32 Middle = INDEX_NONE;
+            if (BestAxis != INDEX_NONE)
+            {
+                const double Scale = SahBins / CentroidExtent[BestAxis];
+                Middle = Algo::Partition(BuildPlates.GetData() + Range.Begin, Count, [&](const FBuildPlate& Plate)
+                {
+                    return FMath::Min(SahBins - 1, (int32)((Plate.Centroid[BestAxis] - CentroidBox.Min[BestAxis]) * Scale)) <= BestBin;
+                }) + Range.Begin;
+            }
+            else if (Count > MaxLeafPlates)
+            {
+                BestAxis = CentroidExtent.X >= CentroidExtent.Y && CentroidExtent.X >= CentroidExtent.Z ? 0 : (CentroidExtent.Y >= CentroidExtent.Z ? 1 : 2);
+                Middle = Range.Begin + Count / 2;
+                std::nth_element(BuildPlates.GetData() + Range.Begin, BuildPlates.GetData() + Middle, BuildPlates.GetData() + Range.End,
+                    [BestAxis](const FBuildPlate& A, const FBuildPlate& B) { return A.Centroid[BestAxis] < B.Centroid[BestAxis]; });
+            }
+
+            if (Middle == INDEX_NONE || Middle == Range.Begin || Middle == Range.End)
+            {
+                FNode& Leaf = Nodes[Range.Node];
+                Leaf.Offset = Triangles.Num();
+                Leaf.Count = Count;
+
+                for (int32 i = Range.Begin; i < Range.End; ++i)
+                {
+                    const FIntVector3& Plate = Plates[BuildPlates[i].Plate];
+                    const FVector3d& V0 = Vertices[Plate.X];
+                    Triangles.Add({ V0, Vertices[Plate.Y] - V0, Vertices[Plate.Z] - V0, BuildPlates[i].Plate + 1 });
+                }
+                continue;
+            }
+
+            // Children are allocated as a pair
+            const int32 Left = Nodes.AddDefaulted(2);
+            Nodes[Range.Node].Offset = Left;
+            Nodes[Range.Node].Axis = BestAxis;
+
+            Pending.Push({ Left + 1, Middle, Range.End });
+            Pending.Push({ Left, Range.Begin, Middle });
+        }
+    }
+
+
+    void FPlateModel::IntersectPacket(FPacket& Packet) const
+    {
+        TArray<int32, TInlineAllocator<64>> Stack;
+        Stack.Push(0);
+
+        while (Stack.Num() > 0)
+        {
+            const FNode& Node = Nodes[Stack.Pop(false)];
+
+            bool bAny = false;
+            for (int32 Lane = 0; Lane < PacketSize; ++Lane)
+            {
+                const double tx1 = (Node.Min.X - Packet.Ox[Lane]) * Packet.InvDx[Lane];
+                const double tx2 = (Node.Max.X - Packet.Ox[Lane]) * Packet.InvDx[Lane];
+                const double ty1 = (Node.Min.Y - Packet.Oy[Lane]) * Packet.InvDy[Lane];
+                const double ty2 = (Node.Max.Y - Packet.Oy[Lane]) * Packet.InvDy[Lane];
+                const double tz1 = (Node.Min.Z - Packet.Oz[Lane]) * Packet.InvDz[Lane];
+                const double tz2 = (Node.Max.Z - Packet.Oz[Lane]) * Packet.InvDz[Lane];
+
+                const double Enter = FMath::Max(FMath::Max(FMath::Min(tx1, tx2), FMath::Min(ty1, ty2)), FMath::Max(FMath::Min(tz1, tz2), 0.));
+                const double Exit = FMath::Min(FMath::Min(FMath::Max(tx1, tx2), FMath::Max(ty1, ty2)), FMath::Min(FMath::Max(tz1, tz2), Packet.Nearest[Lane]));
+
+                bAny |= Enter <= Exit;
+            }
+
+            if (!bAny)
+            {
+                continue;
+            }
+
+            if (Node.Count > 0)
+            {
+                for (int32 i = Node.Offset; i < Node.Offset + Node.Count; ++i)
+                {
+                    const FTriangle& Triangle = Triangles[i];
+
+                    for (int32 Lane = 0; Lane < PacketSize; ++Lane)
+                    {
+                        // Moller-Trumbore, either side
+                        const double Px = Packet.Dy[Lane] * Triangle.Edge2.Z - Packet.Dz[Lane] * Triangle.Edge2.Y;
+                        const double Py = Packet.Dz[Lane] * Triangle.Edge2.X - Packet.Dx[Lane] * Triangle.Edge2.Z;
+                        const double Pz = Packet.Dx[Lane] * Triangle.Edge2.Y - Packet.Dy[Lane] * Triangle.Edge2.X;
+                        const double Det = Triangle.Edge1.X * Px + Triangle.Edge1.Y * Py + Triangle.Edge1.Z * Pz;
+                        const double InvDet = Det != 0. ? 1. / Det : 0.;
+
+                        const double Sx = Packet.Ox[Lane] - Triangle.Vertex.X;
+                        const double Sy = Packet.Oy[Lane] - Triangle.Vertex.Y;
+                        const double Sz = Packet.Oz[Lane] - Triangle.Vertex.Z;
+                        const double U = (Sx * Px + Sy * Py + Sz * Pz) * InvDet;
+
+                        const double Qx = Sy * Triangle.Edge1.Z - Sz * Triangle.Edge1.Y;
+                        const double Qy = Sz * Triangle.Edge1.X - Sx * Triangle.Edge1.Z;
+                        const double Qz = Sx * Triangle.Edge1.Y - Sy * Triangle.Edge1.X;
+                        const double V = (Packet.Dx[Lane] * Qx + Packet.Dy[Lane] * Qy + Packet.Dz[Lane] * Qz) * InvDet;
+                        const double T = (Triangle.Edge2.X * Qx + Triangle.Edge2.Y * Qy + Triangle.Edge2.Z * Qz) * InvDet;
+
+                        const bool bHit = Det != 0.
+                            && U >= -PlateExpansion && V >= -PlateExpansion && U + V <= 1. + PlateExpansion
+                            && T >= 0. && T < Packet.Nearest[Lane];
+
+                        Packet.Nearest[Lane] = bHit ? T : Packet.Nearest[Lane];
+                        Packet.Triangle[Lane] = bHit ? i : Packet.Triangle[Lane];
+                    }
+                }
+                continue;
+            }
+
+            // Nearer child on top, as seen by the packet's first ray
+            const double Direction = Node.Axis == 0 ? Packet.Dx[0] : (Node.Axis == 1 ? Packet.Dy[0] : Packet.Dz[0]);
+            if (Direction < 0.)
+            {
+                Stack.Push(Node.Offset);
+                Stack.Push(Node.Offset + 1);
+            }
+            else
+            {
+                Stack.Push(Node.Offset + 1);
+                Stack.Push(Node.Offset);
+            }
+        }
+    }
+
+
+    void FPlateModel::Intersect(TArrayView<const FSRay> Rays, TArray<FSDistanceVector>& Points, TArray<bool>& Found, TArray<int32>* PlateIds) const
+    {
+        const int32 NumRays = Rays.Num();
+        Points.Init(FSDistanceVector(), NumRays);
+        Found.Init(false, NumRays);
+        if (PlateIds)
+        {
+            PlateIds->Init(0, NumRays);
+        }
+
+        if (NumRays == 0 || Nodes.IsEmpty())
+        {
+            return;
+        }
+
+        constexpr int32 RaysPerChunk = PacketSize * PacketsPerChunk;
+        const int32 NumChunks = FMath::DivideAndRoundUp(NumRays, RaysPerChunk);
+
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            const int32 ChunkEnd = FMath::Min(NumRays, (Chunk + 1) * RaysPerChunk);
+
+            for (int32 First = Chunk * RaysPerChunk; First < ChunkEnd; First += PacketSize)
+            {
+                FPacket Packet;
+                for (int32 Lane = 0; Lane < PacketSize; ++Lane)
+                {
+                    // Short packets repeat their last ray, inactive
+                    const FSRay& Ray = Rays[FMath::Min(First + Lane, ChunkEnd - 1)];
+
+                    Packet.Ox[Lane] = Ray.point.x.km;
+                    Packet.Oy[Lane] = Ray.point.y.km;
+                    Packet.Oz[Lane] = Ray.point.z.km;
+                    Packet.Dx[Lane] = Ray.direction.x;
+                    Packet.Dy[Lane] = Ray.direction.y;
+                    Packet.Dz[Lane] = Ray.direction.z;
+
+                    // Zero components give huge (rather than infinite) slab
+                    // distances, so the slab test can't produce 0 * inf
+                    Packet.InvDx[Lane] = 1. / (Packet.Dx[Lane] != 0. ? Packet.Dx[Lane] : TinyDirection);
+                    Packet.InvDy[Lane] = 1. / (Packet.Dy[Lane] != 0. ? Packet.Dy[Lane] : TinyDirection);
+                    Packet.InvDz[Lane] = 1. / (Packet.Dz[Lane] != 0. ? Packet.Dz[Lane] : TinyDirection);
+
+                    const bool bActive = First + Lane < ChunkEnd && (Ray.direction.x != 0. || Ray.direction.y != 0. || Ray.direction.z != 0.);
+                    Packet.Nearest[Lane] = bActive ? NoHit : -1.;
+                    Packet.Triangle[Lane] = INDEX_NONE;
+                }
+
+                IntersectPacket(Packet);
+
+                for (int32 Lane = 0; Lane < PacketSize && First + Lane < ChunkEnd; ++Lane)
+                {
+                    const int32 Hit = Packet.Triangle[Lane];
+                    if (Hit != INDEX_NONE)
+                    {
+                        const double T = Packet.Nearest[Lane];
+                        Points[First + Lane] = FSDistanceVector(
+                            Packet.Ox[Lane] + T * Packet.Dx[Lane],
+                            Packet.Oy[Lane] + T * Packet.Dy[Lane],
+                            Packet.Oz[Lane] + T * Packet.Dz[Lane]);
+                        Found[First + Lane] = true;
+                        if (PlateIds)
+                        {
+                            (*PlateIds)[First + Lane] = Triangles[Hit].Plate;
+                        }
+                    }
+                }
+            }
+        }, NumChunks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+    }
+
+
+    bool FPlateModel::Intersect(const FSRay& Ray, FSDistanceVector& Point, int32* PlateId) const
+    {
+        TArray<FSDistanceVector> Points;
+        TArray<bool> Found;
+        TArray<int32> PlateIds;
+        Intersect(MakeArrayView(&Ray, 1), Points, Found, PlateId ? &PlateIds : nullptr);
+
+        if (Found[0])
+        {
+            Point = Points[0];
+            if (PlateId)
+            {
+                *PlateId = PlateIds[0];
+            }
+        }
+        return Found[0];
+    }
+
+
+    FPlateModelPtr FPlateModel::Load(int32 Body, const TArray<int32>& Surfaces, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Dsk::FPlateModel::Load, Body, nullptr, nullptr);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        TArray<FDskSegment> Segments;
+        GetDskType2Segments(Body, Surfaces, Segments);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return nullptr;
+        }
+
+        TArray<FVector3d> Vertices;
+        TArray<FIntVector3> Plates;
+        for (const FDskSegment& Segment : Segments)
+        {
+            if (Segment.Dsk.frmcde != Segments[0].Dsk.frmcde)
+            {
+                *ResultCode = ES_ResultCode::Error;
+                *ErrorMessage = FString::Printf(TEXT("DSK segments for body %d are in different frames (%d, %d)"), Body, (int32)Segments[0].Dsk.frmcde, (int32)Segment.Dsk.frmcde);
+                return nullptr;
+            }
+
+            if (!ReadSegment(Segment.Handle, Segment.Dla, Vertices, Plates))
+            {
+                break;
+            }
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return nullptr;
+        }
+
+        if (Segments.IsEmpty())
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("No type 2 DSK segments loaded for body %d"), Body);
+            return nullptr;
+        }
+
+        return MakeShared<FPlateModel, ESPMode::ThreadSafe>(MoveTemp(Vertices), MoveTemp(Plates), Body, (int32)Segments[0].Dsk.frmcde);
+    }
+
+
+    FPlateModelPtr FPlateModel::Load(const FName& Body, const TArray<int32>& Surfaces, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        int Code = 0;
+        if (!MaxQ::Data::Bods2c(Code, Body))
+        {
+            MakeErrorGutter(ResultCode, ErrorMessage);
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("Unknown body %s"), *Body.ToString());
+            return nullptr;
+        }
+        return Load(Code, Surfaces, ResultCode, ErrorMessage);
+    }
+}
+
+
+namespace MaxQ::Private
+{
+    bool GetDskType2Segments(int32 Body, const TArray<int32>& Surfaces, TArray<FDskSegment>& Segments)
+    {
+        Segments.Reset();
+
+        TArray<FLoadedKernel> Kernels;
+        GetLoadedKernels(TEXT("DSK"), Kernels);
+
+        for (const FLoadedKernel& Kernel : Kernels)
+        {
+            FDskSegment Segment;
+            Segment.File = Kernel.File;
+            Segment.Handle = Kernel.Handle;
+
+            SpiceBoolean _found = SPICEFALSE;
+            dlabfs_c(Kernel.Handle, &Segment.Dla, &_found);
+
+            while (_found && !failed_c())
+            {
+                dskgd_c(Kernel.Handle, &Segment.Dla, &Segment.Dsk);
+
+                if (!failed_c() && Segment.Dsk.center == Body && Segment.Dsk.dtype == 2 && (Surfaces.IsEmpty() || Surfaces.Contains(Segment.Dsk.surfce)))
+                {
+                    Segments.Add(Segment);
+                }
+
+                SpiceDLADescr _next;
+                dlafns_c(Kernel.Handle, &Segment.Dla, &_next, &_found);
+                Segment.Dla = _next;
+            }
+        }
+
+        return !failed_c();
+    }
+}
@@ -0,0 +1,799 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskMesh.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Renderable, tiled and LOD'd mesh data from DSK type 2 shape models
+//
+// A builder moves through Lookup (editor DDC fetch, worker thread), Reading
+// (game thread, chunked dskv02_c/dskp02_c calls under a time budget) and
+// Building (worker thread), to Done.  The state is shared with the worker, so
+// a builder can be dropped mid-flight.
+//
+// Plates are bucketed by tile with a counting sort, so tiles are views into
+// one index array rather than arrays of their own.  Coarser LODs cluster
+// every model vertex into a grid cell per LOD, one LOD at a time, so only one
+// LOD's clusters are held at once.
+//
+// Peak memory is tracked as the bytes held by the plate data, intermediates
+// and output at the high points of the build, not measured from the
+// allocator.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskMesh.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceDskMesh.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Containers/Ticker.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SpiceLog.h"
+#include "SpiceProfiling.h"
+#include "SpiceUtilities.h"
+#include <atomic>
+
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#endif
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+using namespace MaxQ::Dsk;
+
+namespace
+{
+    // Change when the mesh data, or how it's built, changes
+    const TCHAR* DerivedDataVersion = TEXT("9A3E61C4D2B84F0FA7E5C13B6D20F001");
+    constexpr int32 SerializationVersion = 1;
+
+    // Distance from a grid cell's center to its corners, per unit cell size
+    constexpr double CellCornerDistance = 0.8660254037844386;
+
+    // Plates sampled to estimate the mean edge length
+    constexpr int32 EdgeSamples = 4096;
+
+    // Cube face tile a direction (from the model's center) falls in
+    int32 TileOf(const FVector3d& Direction, int32 TilesPerFace)
+    {
+        const FVector3d Abs = Direction.GetAbs();
+        const int32 Axis = Abs.X >= Abs.Y && Abs.X >= Abs.Z ? 0 : (Abs.Y >= Abs.Z ? 1 : 2);
+        const double Major = Abs[Axis];
+        if (Major <= 0.)
+        {
+            return 0;
+        }
+
+        const int32 Face = 2 * Axis + (Direction[Axis] < 0. ? 1 : 0);
+        const double U = Direction[(Axis + 1) % 3] / Major;
+        const double V = Direction[(Axis + 2) % 3] / Major;
+        const int32 I = FMath::Clamp((int32)((U + 1.) * 0.5 * TilesPerFace), 0, TilesPerFace - 1);
+        const int32 J = FMath::Clamp((int32)((V + 1.) * 0.5 * TilesPerFace), 0, TilesPerFace - 1);
+
+        return (Face * TilesPerFace + I) * TilesPerFace + J;
+    }
+
+    // Appends a tile's LOD from plates.  Remap maps model vertices to this
+    // LOD's vertices (null at LOD 0, where they're the same).  Plates that
+    // collapse are dropped.
+    void EmitLod(TArrayView<const int32> TilePlates, const TArray<FIntVector3>& Plates, const int32* Remap, const TArray<FVector3d>& Positions, const TArray<FVector3f>& Normals, const FVector3d& Origin, FMeshLod& Lod)
+    {
+        TMap<int32, uint32> Local;
+        Local.Reserve(TilePlates.Num());
+        Lod.Indices.Reserve(3 * TilePlates.Num());
+
+        for (int32 Plate : TilePlates)
+        {
+            int32 Corners[3] = { Plates[Plate].X, Plates[Plate].Y, Plates[Plate].Z };
+            if (Remap)
+            {
+                for (int32& Corner : Corners)
+                {
+                    Corner = Remap[Corner];
+                }
+                if (Corners[0] == Corners[1] || Corners[1] == Corners[2] || Corners[2] == Corners[0])
+                {
+                    continue;
+                }
+            }
+
+            for (int32 Corner : Corners)
+            {
+                const uint32* Index = Local.Find(Corner);
+                if (!Index)
+                {
+                    Index = &Local.Add(Corner, Lod.Positions.Num());
+                    Lod.Positions.Add(FVector3f(Positions[Corner] - Origin));
+                    Lod.Normals.Add(Normals[Corner]);
+                }
+                Lod.Indices.Add(*Index);
+            }
+        }
+
+        Lod.Positions.Shrink();
+        Lod.Normals.Shrink();
+        Lod.Indices.Shrink();
+    }
+
+    void BuildMesh(TArray<FVector3d>& Vertices, TArray<FIntVector3>& Plates, const FMeshSettings& Settings, FShapeMesh& Mesh, FMeshStats& Stats)
+    {
+        const double Start = FPlatformTime::Seconds();
+
+        const int32 TilesPerFace = FMath::Max(1, Settings.TilesPerFace);
+        const int32 NumLods = FMath::Max(1, Settings.NumLods);
+
+        const int32 Dropped = Plates.RemoveAll([&Vertices](const FIntVector3& Plate)
+        {
+            return !Vertices.IsValidIndex(Plate.X) || !Vertices.IsValidIndex(Plate.Y) || !Vertices.IsValidIndex(Plate.Z);
+        });
+        if (Dropped > 0)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ::Dsk mesh dropped %d plates, vertex index out of range"), Dropped);
+        }
+
+        Mesh.NumVertices = Vertices.Num();
+        Mesh.NumPlates = Plates.Num();
+        Mesh.Bounds = FBox3d(ForceInit);
+        for (const FVector3d& Vertex : Vertices)
+        {
+            Mesh.Bounds += Vertex;
+        }
+
+        SIZE_T Held = Vertices.GetAllocatedSize() + Plates.GetAllocatedSize();
+        auto Sample = [&Stats, &Held](SIZE_T Transient)
+        {
+            Stats.PeakBytes = FMath::Max(Stats.PeakBytes, Held + Transient);
+        };
+
+        // Area weighted vertex normals
+        TArray<FVector3f> Normals;
+        Normals.SetNumZeroed(Vertices.Num());
+        for (const FIntVector3& Plate : Plates)
+        {
+            const FVector3d& V0 = Vertices[Plate.X];
+            const FVector3f Normal((Vertices[Plate.Y] - V0) ^ (Vertices[Plate.Z] - V0));
+            Normals[Plate.X] += Normal;
+            Normals[Plate.Y] += Normal;
+            Normals[Plate.Z] += Normal;
+        }
+        ParallelFor(Normals.Num(), [&Normals](int32 i) { Normals[i] = Normals[i].GetSafeNormal(); });
+        Held += Normals.GetAllocatedSize();
+
+        // Plates by tile (counting sort)
+        const FVector3d Center = Mesh.Bounds.GetCenter();
+        const int32 NumTiles = 6 * TilesPerFace * TilesPerFace;
+
+        TArray<int32> PlateTile;
+        PlateTile.SetNumUninitialized(Plates.Num());
+        ParallelFor(Plates.Num(), [&](int32 i)
+        {
+            const FIntVector3& Plate = Plates[i];
+            const FVector3d Centroid = (Vertices[Plate.X] + Vertices[Plate.Y] + Vertices[Plate.Z]) / 3.;
+            PlateTile[i] = TileOf(Centroid - Center, TilesPerFace);
+        });
+
+        TArray<int32> TileStart;
+        TileStart.SetNumZeroed(NumTiles + 1);
+        for (int32 Tile : PlateTile)
+        {
+            ++TileStart[Tile + 1];
+        }
+        for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+        {
+            TileStart[Tile + 1] += TileStart[Tile];
+        }
+
+        TArray<int32> TilePlates;
+        TilePlates.SetNumUninitialized(Plates.Num());
+        {
+            TArray<int32> Next(TileStart.GetData(), NumTiles);
+            for (int32 i = 0; i < Plates.Num(); ++i)
+            {
+                TilePlates[Next[PlateTile[i]]++] = i;
+            }
+        }
+
+        Held += TileStart.GetAllocatedSize() + TilePlates.GetAllocatedSize();
+        Sample(PlateTile.GetAllocatedSize());
+        PlateTile.Empty();
+
+        // Tiles with plates, as views into TilePlates
+        TArray<TArrayView<const int32>> TileViews;
+        for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+        {
+            if (TileStart[Tile + 1] > TileStart[Tile])
+            {
+                TileViews.Add(MakeArrayView(TilePlates.GetData() + TileStart[Tile], TileStart[Tile + 1] - TileStart[Tile]));
+            }
+        }
+        Mesh.Tiles.SetNum(TileViews.Num());
+
+        // LOD 0
+        ParallelFor(Mesh.Tiles.Num(), [&](int32 Tile)
+        {
+            FMeshTile& Out = Mesh.Tiles[Tile];
+            Out.Bounds = FBox3d(ForceInit);
+            for (int32 Plate : TileViews[Tile])
+            {
+                Out.Bounds += Vertices[Plates[Plate].X];
+                Out.Bounds += Vertices[Plates[Plate].Y];
+                Out.Bounds += Vertices[Plates[Plate].Z];
+            }
+            Out.Origin = Out.Bounds.GetCenter();
+
+            EmitLod(TileViews[Tile], Plates, nullptr, Vertices, Normals, Out.Origin, Out.Lods.AddDefaulted_GetRef());
+        });
+        Sample(Mesh.GetAllocatedSize());
+
+        // LOD 1's cell is twice the mean edge length
+        double EdgeLength = 0.;
+        int32 Edges = 0;
+        const int32 Stride = FMath::Max(1, Plates.Num() / EdgeSamples);
+        for (int32 i = 0; i < Plates.Num(); i += Stride)
+        {
+            const FIntVector3& Plate = Plates[i];
+            EdgeLength += FVector3d::Dist(Vertices[Plate.X], Vertices[Plate.Y]);
+            EdgeLength += FVector3d::Dist(Vertices[Plate.Y], Vertices[Plate.Z]);
+            EdgeLength += FVector3d::Dist(Vertices[Plate.Z], Vertices[Plate.X]);
+            Edges += 3;
+        }
+        const double BaseCell = Edges > 0 ? EdgeLength / Edges : 0.;
+
+        // Coarser LODs, clustering every vertex into this LOD's grid cells
+        TArray<int32> Cluster;
+        TArray<FVector3d> ClusterPositions;
+        TArray<FVector3f> ClusterNormals;
+        TArray<int32> ClusterCounts;
+        TMap<FIntVector, int32> Cells;
+
+        for (int32 LodIndex = 1; LodIndex < NumLods && BaseCell > 0.; ++LodIndex)
+        {
+            const double Cell = BaseCell * (double)(1 << LodIndex);
+            const double InvCell = 1. / Cell;
+
+            Cluster.SetNumUninitialized(Vertices.Num());
+            ClusterPositions.Reset();
+            ClusterNormals.Reset();
+            ClusterCounts.Reset();
+            Cells.Reset();
+
+            for (int32 v = 0; v < Vertices.Num(); ++v)
+            {
+                const FVector3d Offset = (Vertices[v] - Mesh.Bounds.Min) * InvCell;
+                const FIntVector Key(FMath::FloorToInt32(Offset.X), FMath::FloorToInt32(Offset.Y), FMath::FloorToInt32(Offset.Z));
+
+                int32 Id;
+                if (const int32* Found = Cells.Find(Key))
+                {
+                    Id = *Found;
+                }
+                else
+                {
+                    Id = Cells.Add(Key, ClusterPositions.Num());
+                    ClusterPositions.Add(FVector3d::ZeroVector);
+                    ClusterNormals.Add(FVector3f::ZeroVector);
+                    ClusterCounts.Add(0);
+                }
+
+                ClusterPositions[Id] += Vertices[v];
+                ClusterNormals[Id] += Normals[v];
+                ++ClusterCounts[Id];
+                Cluster[v] = Id;
+            }
+
+            for (int32 Id = 0; Id < ClusterPositions.Num(); ++Id)
+            {
+                ClusterPositions[Id] /= ClusterCounts[Id];
+                ClusterNormals[Id] = ClusterNormals[Id].GetSafeNormal();
+            }
+
+            Sample(Cluster.GetAllocatedSize() + ClusterPositions.GetAllocatedSize() + ClusterNormals.GetAllocatedSize()
+                + ClusterCounts.GetAllocatedSize() + Cells.GetAllocatedSize() + Mesh.GetAllocatedSize());
+
+            const float GeometricError = (float)(CellCornerDistance * Cell);
+            ParallelFor(Mesh.Tiles.Num(), [&](int32 Tile)
+            {
+                FMeshTile& Out = Mesh.Tiles[Tile];
+                if (Out.Lods.Num() < LodIndex)
+                {
+                    // Stopped coarsening already
+                    return;
+                }
+
+                FMeshLod Lod;
+                EmitLod(TileViews[Tile], Plates, Cluster.GetData(), ClusterPositions, ClusterNormals, Out.Origin, Lod);
+
+                if (Lod.Indices.Num() > 0 && Lod.Indices.Num() < Out.Lods.Last().Indices.Num())
+                {
+                    Lod.GeometricError = GeometricError;
+                    Out.Lods.Add(MoveTemp(Lod));
+                }
+            });
+        }
+
+        Sample(Mesh.GetAllocatedSize());
+
+        Stats.Tiles = Mesh.Tiles.Num();
+        Stats.Triangles = 0;
+        for (const FMeshTile& Tile : Mesh.Tiles)
+        {
+            for (const FMeshLod& Lod : Tile.Lods)
+            {
+                Stats.Triangles += Lod.Indices.Num() / 3;
+            }
+        }
+        Stats.BuildSeconds = FPlatformTime::Seconds() - Start;
+    }
+}
+
+
+namespace MaxQ::Dsk
+{
+    struct FShapeMeshBuilder::FState
+    {
+        enum class EStep : uint8 { Lookup, Reading, Building, Done };
+
+        std::atomic<EStep> Step { EStep::Reading };
+
+        FMeshSettings Settings;
+        int32 Body = 0;
+        int32 FrameId = 0;
+
+        TArray<FDskSegment> Segments;
+        TArray<FIntPoint> SegmentSizes;     // Vertices, plates
+        int32 TotalVertices = 0;
+        int32 TotalPlates = 0;
+
+        // Reading position
+        int32 Segment = 0;
+        int32 SegmentVertex = 0;
+        int32 SegmentPlate = 0;
+        int32 SegmentVertexBase = 0;
+
+        TArray<FVector3d> Vertices;
+        TArray<FIntVector3> Plates;
+
+        FString CacheKey;
+
+        // Written before Step becomes Done
+        FShapeMeshPtr Result;
+        FString Error;
+        FMeshStats Stats;
+    };
+
+    using FState = FShapeMeshBuilder::FState;
+    using EStep = FShapeMeshBuilder::FState::EStep;
+
+    namespace
+    {
+        // One dskv02_c or dskp02_c call's worth, false on a CSPICE error
+        bool ReadChunk(FState& State)
+        {
+            static_assert(sizeof(FVector3d) == sizeof(SpiceDouble[3]), "dskv02_c writes straight into FVector3d");
+            static_assert(sizeof(FIntVector3) == sizeof(SpiceInt[3]), "dskp02_c writes straight into FIntVector3");
+
+            if (State.Vertices.Max() == 0)
+            {
+                State.Vertices.Reserve(State.TotalVertices);
+                State.Plates.Reserve(State.TotalPlates);
+            }
+
+            const FDskSegment& Segment = State.Segments[State.Segment];
+            const FIntPoint& Size = State.SegmentSizes[State.Segment];
+            const int32 ChunkSize = FMath::Max(1, State.Settings.ChunkSize);
+            SpiceInt _n = 0;
+
+            if (State.SegmentVertex < Size.X)
+            {
+                const int32 Room = FMath::Min(ChunkSize, Size.X - State.SegmentVertex);
+                const int32 At = State.Vertices.AddUninitialized(Room);
+                dskv02_c(Segment.Handle, &Segment.Dla, State.SegmentVertex + 1, Room, &_n, (SpiceDouble(*)[3])(State.Vertices.GetData() + At));
+                State.SegmentVertex += Room;
+            }
+            else if (State.SegmentPlate < Size.Y)
+            {
+                const int32 Room = FMath::Min(ChunkSize, Size.Y - State.SegmentPlate);
+                const int32 At = State.Plates.AddUninitialized(Room);
+                dskp02_c(Segment.Handle, &Segment.Dla, State.SegmentPlate + 1, Room, &_n, (SpiceInt(*)[3])(State.Plates.GetData() + At));
+                State.SegmentPlate += Room;
+
+                // One-based, per segment => zero-based, per model
+                const FIntVector3 Offset(State.SegmentVertexBase - 1);
+                for (int32 i = At; i < State.Plates.Num(); ++i)
+                {
+                    State.Plates[i] += Offset;
+                }
+            }
+
+            if (State.SegmentVertex >= Size.X && State.SegmentPlate >= Size.Y)
+            {
+                ++State.Segment;
+                State.SegmentVertex = 0;
+                State.SegmentPlate = 0;
+                State.SegmentVertexBase = State.Vertices.Num();
+            }
+
+            return !failed_c();
+        }
+
+
+#if WITH_EDITOR
+        FString MakeCacheKey(const FState& State)
+        {
+            FSHA1 Sha;
+            Sha.Update((const uint8*)&State.Settings.TilesPerFace, sizeof(State.Settings.TilesPerFace));
+            Sha.Update((const uint8*)&State.Settings.NumLods, sizeof(State.Settings.NumLods));
+
+            for (const FDskSegment& Segment : State.Segments)
+            {
+                const FString Name = FPaths::GetCleanFilename(Segment.File);
+                const int64 FileSize = IFileManager::Get().FileSize(*Segment.File);
+                Sha.UpdateWithString(*Name, Name.Len());
+                Sha.Update((const uint8*)&FileSize, sizeof(FileSize));
+                Sha.Update((const uint8*)&Segment.Dla, sizeof(Segment.Dla));
+                Sha.Update((const uint8*)&Segment.Dsk, sizeof(Segment.Dsk));
+            }
+            Sha.Final();
+
+            FSHAHash Hash;
+            Sha.GetHash(Hash.Hash);
+            return FDerivedDataCacheInterface::BuildCacheKey(TEXT("MAXQ_DSKMESH"), DerivedDataVersion, *Hash.ToString());
+        }
+#endif
+
+
+        void LaunchLookup(const TSharedRef<FState, ESPMode::ThreadSafe>& State)
+        {
+#if WITH_EDITOR
+            State->Step = EStep::Lookup;
+
+            Async(EAsyncExecution::Thread, [State]()
+            {
+                TArray<uint8> Data;
+                if (GetDerivedDataCacheRef().GetSynchronous(*State->CacheKey, Data, TEXT("MaxQ DSK mesh")))
+                {
+                    TSharedRef<FShapeMesh, ESPMode::ThreadSafe> Mesh = MakeShared<FShapeMesh, ESPMode::ThreadSafe>();
+                    FMemoryReader Reader(Data);
+                    Reader << *Mesh;
+
+                    if (!Reader.IsError())
+                    {
+                        State->Stats.bFromCache = true;
+                        State->Stats.Tiles = Mesh->Tiles.Num();
+                        State->Stats.PeakBytes = Data.GetAllocatedSize() + Mesh->GetAllocatedSize();
+                        State->Result = Mesh;
+                        State->Step = EStep::Done;
+                        return;
+                    }
+                }
+
+                State->Step = EStep::Reading;
+            });
+#endif
+        }
+
+
+        void LaunchBuild(const TSharedRef<FState, ESPMode::ThreadSafe>& State)
+        {
+            State->Step = EStep::Building;
+
+            // A dedicated thread, conversions run for seconds
+            Async(EAsyncExecution::Thread, [State]()
+            {
+                TSharedRef<FShapeMesh, ESPMode::ThreadSafe> Mesh = MakeShared<FShapeMesh, ESPMode::ThreadSafe>();
+                Mesh->Body = State->Body;
+                Mesh->FrameId = State->FrameId;
+
+                BuildMesh(State->Vertices, State->Plates, State->Settings, *Mesh, State->Stats);
+                State->Vertices.Empty();
+                State->Plates.Empty();
+
+#if WITH_EDITOR
+                if (!State->CacheKey.IsEmpty())
+                {
+                    TArray<uint8> Data;
+                    FMemoryWriter Writer(Data);
+                    Writer << *Mesh;
+                    GetDerivedDataCacheRef().Put(*State->CacheKey, TArrayView64<const uint8>(Data.GetData(), Data.Num()), TEXT("MaxQ DSK mesh"));
+                }
+#endif
+
+                State->Result = Mesh;
+                State->Step = EStep::Done;
+            });
+        }
+    }
+
+
+    FShapeMeshPtr FShapeMesh::Build(TArray<FVector3d>&& Vertices, TArray<FIntVector3>&& Plates, const FMeshSettings& Settings, FMeshStats* Stats)
+    {
+        TArray<FVector3d> ModelVertices(MoveTemp(Vertices));
+        TArray<FIntVector3> ModelPlates(MoveTemp(Plates));
+
+        FMeshStats BuildStats;
+        TSharedRef<FShapeMesh, ESPMode::ThreadSafe> Mesh = MakeShared<FShapeMesh, ESPMode::ThreadSafe>();
+        BuildMesh(ModelVertices, ModelPlates, Settings, *Mesh, BuildStats);
+
+        if (Stats)
+        {
+            *Stats = BuildStats;
+        }
+        return Mesh;
+    }
+
+
+    void FShapeMesh::SelectLods(const FVector3d& ViewPoint, double MaxAngularError, TArray<int32>& TileLods) const
+    {
+        TileLods.SetNumUninitialized(Tiles.Num());
+
+        for (int32 i = 0; i < Tiles.Num(); ++i)
+        {
+            const FMeshTile& Tile = Tiles[i];
+            const double Distance = FMath::Sqrt(Tile.Bounds.ComputeSquaredDistanceToPoint(ViewPoint));
+
+            int32 Lod = 0;
+            while (Lod + 1 < Tile.Lods.Num() && Tile.Lods[Lod + 1].GeometricError <= MaxAngularError * Distance)
+            {
+                ++Lod;
+            }
+            TileLods[i] = Lod;
+        }
+    }
+
+
+    SIZE_T FShapeMesh::GetAllocatedSize() const
+    {
+        SIZE_T Size = Tiles.GetAllocatedSize();
+        for (const FMeshTile& Tile : Tiles)
+        {
+            Size += Tile.Lods.GetAllocatedSize();
+            for (const FMeshLod& Lod : Tile.Lods)
+            {
+                Size += Lod.Positions.GetAllocatedSize() + Lod.Normals.GetAllocatedSize() + Lod.Indices.GetAllocatedSize();
+            }
+        }
+        return Size;
+    }
+
+
+    FArchive& operator<<(FArchive& Ar, FShapeMesh& Mesh)
+    {
+        int32 Version = SerializationVersion;
+        Ar << Version;
+        if (Ar.IsLoading() && Version != SerializationVersion)
+        {
+            Ar.SetError();
+            return Ar;
+        }
+
+        Ar << Mesh.Bounds << Mesh.Body << Mesh.FrameId << Mesh.NumPlates << Mesh.NumVertices;
+
+        int32 NumTiles = Mesh.Tiles.Num();
+        Ar << NumTiles;
+        if (Ar.IsLoading())
+        {
+            Mesh.Tiles.SetNum(FMath::Max(0, NumTiles));
+        }
+
+        for (FMeshTile& Tile : Mesh.Tiles)
+        {
+            Ar << Tile.Origin << Tile.Bounds;
+
+            int32 NumLods = Tile.Lods.Num();
+            Ar << NumLods;
+            if (Ar.IsLoading())
+            {
+                Tile.Lods.SetNum(FMath::Max(0, NumLods));
+            }
+
+            for (FMeshLod& Lod : Tile.Lods)
+            {
+                Ar << Lod.Positions << Lod.Normals << Lod.Indices << Lod.GeometricError;
+            }
+
+            if (Ar.IsError())
+            {
+                break;
+            }
+        }
+
+        return Ar;
+    }
+
+
+    TSharedPtr<FShapeMeshBuilder> FShapeMeshBuilder::Start(int32 Body, const TArray<int32>& Surfaces, const FMeshSettings& Settings, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Dsk::FShapeMeshBuilder::Start, Body, nullptr, nullptr);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        TSharedRef<FState, ESPMode::ThreadSafe> State = MakeShared<FState, ESPMode::ThreadSafe>();
+        State->Settings = Settings;
+        State->Body = Body;
+
+        GetDskType2Segments(Body, Surfaces, State->Segments);
+        for (const FDskSegment& Segment : State->Segments)
+        {
+            SpiceInt _nv = 0, _np = 0;
+            dskz02_c(Segment.Handle, &Segment.Dla, &_nv, &_np);
+            State->SegmentSizes.Add(FIntPoint(_nv, _np));
+            State->TotalVertices += _nv;
+            State->TotalPlates += _np;
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return nullptr;
+        }
+
+        if (State->Segments.IsEmpty())
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("No type 2 DSK segments loaded for body %d"), Body);
+            return nullptr;
+        }
+
+        State->FrameId = State->Segments[0].Dsk.frmcde;
+        for (const FDskSegment& Segment : State->Segments)
+        {
+            if (Segment.Dsk.frmcde != State->FrameId)
+            {
+                *ResultCode = ES_ResultCode::Error;
+                *ErrorMessage = FString::Printf(TEXT("DSK segments for body %d are in different frames (%d, %d)"), Body, State->FrameId, (int32)Segment.Dsk.frmcde);
+                return nullptr;
+            }
+        }
+
+        TSharedPtr<FShapeMeshBuilder> Builder = MakeShareable(new FShapeMeshBuilder());
+        Builder->State = State;
+
+#if WITH_EDITOR
+        if (Settings.bUseDerivedDataCache && GetDerivedDataCache())
+        {
+            State->CacheKey = MakeCacheKey(*State);
+            LaunchLookup(State);
+        }
+#endif
+
+        return Builder;
+    }
+
+
+    TFuture<FShapeMeshPtr> FShapeMeshBuilder::BuildAsync(int32 Body, const TArray<int32>& Surfaces, const FMeshSettings& Settings)
+    {
+        TSharedRef<TPromise<FShapeMeshPtr>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<FShapeMeshPtr>, ESPMode::ThreadSafe>();
+        TFuture<FShapeMeshPtr> Future = Promise->GetFuture();
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        TSharedPtr<FShapeMeshBuilder> Builder = Start(Body, Surfaces, Settings, &ResultCode, &ErrorMessage);
+        if (!Builder)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ::Dsk::FShapeMeshBuilder::BuildAsync %s"), *ErrorMessage);
+            Promise->SetValue(nullptr);
+            return Future;
+        }
+
+        const double BudgetSeconds = Settings.ReadBudgetSeconds;
+        FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Builder, Promise, BudgetSeconds](float)
+        {
+            if (!Builder->Tick(BudgetSeconds))
+            {
+                return true;
+            }
+
+            if (!Builder->GetError().IsEmpty())
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ::Dsk::FShapeMeshBuilder::BuildAsync %s"), *Builder->GetError());
+            }
+            Promise->SetValue(Builder->GetResult());
+            return false;
+        }));
+
+        return Future;
+    }
+
+
+    bool FShapeMeshBuilder::Tick(double BudgetSeconds)
+    {
+        check(IsInGameThread());
+
+        if (State->Step != EStep::Reading)
+        {
+            return IsDone();
+        }
+
+        MAXQ_SPICE_SCOPE(MaxQ::Dsk::FShapeMeshBuilder::Tick);
+        const double Start = FPlatformTime::Seconds();
+        double Now = Start;
+
+        do
+        {
+            if (!ReadChunk(*State))
+            {
+                ES_ResultCode ResultCode;
+                ErrorCheck(&ResultCode, &State->Error);
+                State->Vertices.Empty();
+                State->Plates.Empty();
+                State->Step = EStep::Done;
+                return true;
+            }
+            Now = FPlatformTime::Seconds();
+        }
+        while (State->Segment < State->Segments.Num() && Now - Start < BudgetSeconds);
+
+        State->Stats.ReadSeconds += Now - Start;
+
+        if (State->Segment == State->Segments.Num())
+        {
+            LaunchBuild(State.ToSharedRef());
+        }
+
+        return IsDone();
+    }
+
+
+    bool FShapeMeshBuilder::IsDone() const
+    {
+        return State->Step == EStep::Done;
+    }
+
+
+    FShapeMeshPtr FShapeMeshBuilder::GetResult() const
+    {
+        return IsDone() ? State->Result : nullptr;
+    }
+
+
+    const FString& FShapeMeshBuilder::GetError() const
+    {
+        return State->Error;
+    }
+
+
+    float FShapeMeshBuilder::GetProgress() const
+    {
+        switch (State->Step)
+        {
+        case EStep::Lookup:
+            return 0.f;
+        case EStep::Reading:
+        {
+            const int32 Total = State->TotalVertices + State->TotalPlates;
+            return Total > 0 ? 0.5f * (State->Vertices.Num() + State->Plates.Num()) / Total : 0.f;
+        }
+        case EStep::Building:
+            return 0.5f;
+        default:
+            return 1.f;
+        }
+    }
+
+
+    const FMeshStats& FShapeMeshBuilder::GetStats() const
+    {
+        return State->Stats;
+    }
+}
@@ -0,0 +1,350 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEclipse.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Eclipse state & sunlight fraction for large batches of positions
+//
+// Positions are evaluated in runs of PositionsPerTask, one ParallelFor task
+// each, an occulter at a time.  The per-position work is a straight-line
+// loop over the run's structure-of-arrays inputs, with the cases resolved by
+// selects rather than branches, so the compiler can vectorize it.  Shadows
+// are merged as "darkest wins", via Rank.
+//
+// Angles between directions are atan2(|a x b|, a . b), accurate near zero
+// separation where acos isn't.
+//
+// Ellipsoid limbs:  in body-fixed coordinates scaled so the occulter is a
+// unit sphere, a ray from the position P along d = cos(t) L + sin(t) u (L
+// toward the center, u toward the source on the sky) is tangent when
+//   (W . D)^2 = |D|^2 (|W|^2 - 1),   W = scaled P - C,  D = scaled d
+// which is a quadratic in tan(t) with one positive root, the limb.
+//
+// Conical model (disk overlap on the sky, see Montenbruck & Gill, Satellite
+// Orbits, 3.4.2) with apparent radii a (source), b (occulter) and center
+// separation c:
+//   c >= a + b     clear
+//   c <= b - a     umbra
+//   c <= a - b     antumbra, visible 1 - b^2/a^2
+//   otherwise      penumbra, visible 1 - overlap / (pi a^2)
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEclipse.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceEclipse.h"
+#include "Async/ParallelFor.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using MaxQ::Core::ToANSIString;
+    using FBody = MaxQ::Eclipse::FEclipseEngine::FBody;
+
+    constexpr int32 PositionsPerTask = 4096;
+
+    // Below this, the source is (nearly) behind the occulter's center and the
+    // direction toward it on the sky is undefined
+    constexpr double TinySine = 1e-12;
+
+    // Shadows, in order of darkness
+    enum ERank : uint8 { Clear, Partial, Annular, Umbra };
+
+    const ES_OccultationType RankToShadow[] = { ES_OccultationType::NONE, ES_OccultationType::PARTIAL, ES_OccultationType::ANNULAR, ES_OccultationType::FULL };
+
+    bool LoadBody(FBody& Body, const FName& Name, bool bFrame, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Body.Name = Name;
+        Body.ToBodyFixed[0] = FVector3d::XAxisVector;
+        Body.ToBodyFixed[1] = FVector3d::YAxisVector;
+        Body.ToBodyFixed[2] = FVector3d::ZAxisVector;
+
+        FSDistanceVector Radii;
+        MaxQ::Data::Bodvrd(Radii, Name, FName(TEXT("RADII")), ResultCode, ErrorMessage);
+        if (*ResultCode != ES_ResultCode::Success)
+        {
+            return false;
+        }
+        Body.Radii = FVector3d(Radii.x.km, Radii.y.km, Radii.z.km);
+        Body.MeanRadius = (Body.Radii.X + Body.Radii.Y + Body.Radii.Z) / 3.;
+
+        if (bFrame)
+        {
+            SpiceInt _frcode = 0;
+            SpiceChar _frname[SPICE_MAX_PATH];
+            SpiceBoolean _found = SPICEFALSE;
+            cnmfrm_c(ToANSIString(Name), sizeof(_frname), &_frcode, _frname, &_found);
+
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+            if (!_found)
+            {
+                *ResultCode = ES_ResultCode::Error;
+                *ErrorMessage = FString::Printf(TEXT("No body-fixed frame for %s"), *Name.ToString());
+                return false;
+            }
+            Body.Frame = FName(_frname);
+        }
+
+        return true;
+    }
+
+    // One occulter against Num positions, darkening Visible and Rank
+    template<bool bEllipsoid>
+    void Occult(const FBody& Source, const FBody& Occulter, const double* X, const double* Y, const double* Z, int32 Num, float* Visible, uint8* Rank)
+    {
+        const FVector3d& S = Source.Position;
+        const FVector3d& O = Occulter.Position;
+        const FVector3d& M0 = Occulter.ToBodyFixed[0];
+        const FVector3d& M1 = Occulter.ToBodyFixed[1];
+        const FVector3d& M2 = Occulter.ToBodyFixed[2];
+        const FVector3d& R = Occulter.Radii;
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            // From the position to the source and to the occulter
+            const double Sx = S.X - X[i], Sy = S.Y - Y[i], Sz = S.Z - Z[i];
+            const double Ox = O.X - X[i], Oy = O.Y - Y[i], Oz = O.Z - Z[i];
+            const double Ds = FMath::Sqrt(Sx * Sx + Sy * Sy + Sz * Sz);
+            const double Do = FMath::Sqrt(Ox * Ox + Oy * Oy + Oz * Oz);
+
+            const double Dot = Sx * Ox + Sy * Oy + Sz * Oz;
+            const double Cx = Sy * Oz - Sz * Oy, Cy = Sz * Ox - Sx * Oz, Cz = Sx * Oy - Sy * Ox;
+            const double Cross = FMath::Sqrt(Cx * Cx + Cy * Cy + Cz * Cz);
+            const double c = FMath::Atan2(Cross, Dot);
+
+            // Apparent radii
+            const double a = FMath::Asin(FMath::Min(Source.MeanRadius / Ds, 1.));
+            double b = FMath::Asin(FMath::Min(Occulter.MeanRadius / Do, 1.));
+            bool bInside = Do <= Occulter.MeanRadius;
+
+            if constexpr (bEllipsoid)
+            {
+                // The limb's angle from the occulter's center toward the
+                // source's center (direction u on the sky), solved in the
+                // body-fixed frame scaled to a unit sphere
+                const double InvDs = 1. / Ds, InvDo = 1. / Do;
+                const double CosC = Dot * InvDs * InvDo, SinC = Cross * InvDs * InvDo;
+                const double InvSinC = 1. / FMath::Max(SinC, TinySine);
+                const double Lx = Ox * InvDo, Ly = Oy * InvDo, Lz = Oz * InvDo;
+                const double Ux = (Sx * InvDs - CosC * Lx) * InvSinC;
+                const double Uy = (Sy * InvDs - CosC * Ly) * InvSinC;
+                const double Uz = (Sz * InvDs - CosC * Lz) * InvSinC;
+
+                const double Ax = (M0.X * Lx + M0.Y * Ly + M0.Z * Lz) / R.X;
+                const double Ay = (M1.X * Lx + M1.Y * Ly + M1.Z * Lz) / R.Y;
+                const double Az = (M2.X * Lx + M2.Y * Ly + M2.Z * Lz) / R.Z;
+                const double Bx = (M0.X * Ux + M0.Y * Uy + M0.Z * Uz) / R.X;
+                const double By = (M1.X * Ux + M1.Y * Uy + M1.Z * Uz) / R.Y;
+                const double Bz = (M2.X * Ux + M2.Y * Uy + M2.Z * Uz) / R.Z;
+                const double AA = Ax * Ax + Ay * Ay + Az * Az;
+                const double AB = Ax * Bx + Ay * By + Az * Bz;
+                const double BB = Bx * Bx + By * By + Bz * Bz;
+
+                const double K = Do * Do * AA - 1.;
+                const double Qa = Do * Do * AB * AB - K * BB;
+                const double Tangent = (AB + FMath::Sqrt(FMath::Max(AB * AB - Qa * AA, 0.))) / FMath::Max(-Qa, TinySine);
+
+                const double Limb = K > 0. && Qa < 0. ? FMath::Atan(Tangent) : UE_DOUBLE_HALF_PI;
+                b = SinC > TinySine ? Limb : b;
+                bInside = K <= 0.;
+            }
+
+            // Overlap of the disks, used when partial
+            const double Cc = FMath::Max(c, UE_DOUBLE_SMALL_NUMBER);
+            const double x = (Cc * Cc + a * a - b * b) / (2. * Cc);
+            const double y = FMath::Sqrt(FMath::Max(a * a - x * x, 0.));
+            const double Overlap = a * a * FMath::Acos(FMath::Clamp(x / a, -1., 1.)) + b * b * FMath::Acos(FMath::Clamp((Cc - x) / b, -1., 1.)) - Cc * y;
+
+            // Only an occulter nearer than the source can cast a shadow
+            const bool bClear = Do >= Ds || c >= a + b;
+            const uint8 Shadow = bInside ? Umbra : bClear ? Clear : c <= b - a ? Umbra : c <= a - b ? Annular : Partial;
+
+            const double Fraction =
+                Shadow == Umbra ? 0. :
+                Shadow == Clear ? 1. :
+                Shadow == Annular ? 1. - (b * b) / (a * a) :
+                1. - Overlap / (UE_DOUBLE_PI * a * a);
+
+            Visible[i] = FMath::Min(Visible[i], (float)FMath::Clamp(Fraction, 0., 1.));
+            Rank[i] = FMath::Max(Rank[i], Shadow);
+        }
+    }
+}
+
+
+namespace MaxQ::Eclipse
+{
+    TSharedPtr<FEclipseEngine> FEclipseEngine::Create(
+        const FName& source,
+        const TArray<FName>& occulters,
+        const FName& center,
+        const FName& frame,
+        bool bEllipsoids,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Eclipse::FEclipseEngine::Create);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        *ResultCode = ES_ResultCode::Success;
+
+        TSharedPtr<FEclipseEngine> Engine(new FEclipseEngine());
+        Engine->Center = center;
+        Engine->Frame = frame;
+        Engine->bEllipsoids = bEllipsoids;
+
+        if (!LoadBody(Engine->Source, source, false, ResultCode, ErrorMessage))
+        {
+            return nullptr;
+        }
+
+        for (const FName& Occulter : occulters)
+        {
+            if (!LoadBody(Engine->Occulters.AddDefaulted_GetRef(), Occulter, bEllipsoids, ResultCode, ErrorMessage))
+            {
+                return nullptr;
+            }
+        }
+
+        return Engine;
+    }
+
+
+    void FEclipseEngine::Update(
+        const FSEphemerisTime& et,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Eclipse::FEclipseEngine::Update, Source.Name, Center, Frame);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        const ANSICHAR* _abcorr = ToANSIString(abcorr);
+        const bool bLightTime = abcorr != ES_AberrationCorrectionWithNewtonians::None;
+        SpiceDouble _pos[3], _lt = 0.;
+
+        spkpos_c(ToANSIString(Source.Name), et.AsSpiceDouble(), ToANSIString(Frame), _abcorr, ToANSIString(Center), _pos, &_lt);
+        Source.Position = FVector3d(_pos[0], _pos[1], _pos[2]);
+
+        for (int32 i = 0; i < Occulters.Num() && !failed_c(); ++i)
+        {
+            FBody& Occulter = Occulters[i];
+            spkpos_c(ToANSIString(Occulter.Name), et.AsSpiceDouble(), ToANSIString(Frame), _abcorr, ToANSIString(Center), _pos, &_lt);
+            Occulter.Position = FVector3d(_pos[0], _pos[1], _pos[2]);
+
+            if (bEllipsoids)
+            {
+                // Body orientation at the same epoch its position was seen at
+                SpiceDouble _rotate[3][3];
+                pxform_c(ToANSIString(Frame), ToANSIString(Occulter.Frame), et.AsSpiceDouble() - (bLightTime ? _lt : 0.), _rotate);
+                for (int32 Row = 0; Row < 3; ++Row)
+                {
+                    Occulter.ToBodyFixed[Row] = FVector3d(_rotate[Row][0], _rotate[Row][1], _rotate[Row][2]);
+                }
+            }
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        Et = et;
+    }
+
+
+    void FEclipseEngine::Evaluate(const FPositionBatch& Positions, TArray<float>& Visible, TArray<ES_OccultationType>& Shadow) const
+    {
+        const int32 Num = Positions.Num();
+        check(Positions.Y.Num() == Num && Positions.Z.Num() == Num);
+
+        Visible.SetNumUninitialized(Num);
+        Shadow.SetNumUninitialized(Num);
+
+        ParallelFor(FMath::DivideAndRoundUp(Num, PositionsPerTask), [&](int32 Task)
+        {
+            const int32 Begin = Task * PositionsPerTask;
+            const int32 Count = FMath::Min(Num - Begin, PositionsPerTask);
+            const double* X = Positions.X.GetData() + Begin;
+            const double* Y = Positions.Y.GetData() + Begin;
+            const double* Z = Positions.Z.GetData() + Begin;
+            float* OutVisible = Visible.GetData() + Begin;
+
+            uint8 Rank[PositionsPerTask];
+            for (int32 i = 0; i < Count; ++i)
+            {
+                OutVisible[i] = 1.f;
+                Rank[i] = Clear;
+            }
+
+            for (const FBody& Occulter : Occulters)
+            {
+                if (bEllipsoids)
+                {
+                    Occult<true>(Source, Occulter, X, Y, Z, Count, OutVisible, Rank);
+                }
+                else
+                {
+                    Occult<false>(Source, Occulter, X, Y, Z, Count, OutVisible, Rank);
+                }
+            }
+
+            ES_OccultationType* OutShadow = Shadow.GetData() + Begin;
+            for (int32 i = 0; i < Count; ++i)
+            {
+                OutShadow[i] = RankToShadow[Rank[i]];
+            }
+        });
+    }
+
+
+    ES_OccultationType FEclipseEngine::Evaluate(const FVector3d& Position, float* Visible) const
+    {
+        float _visible = 1.f;
+        uint8 Rank = Clear;
+
+        for (const FBody& Occulter : Occulters)
+        {
+            if (bEllipsoids)
+            {
+                Occult<true>(Source, Occulter, &Position.X, &Position.Y, &Position.Z, 1, &_visible, &Rank);
+            }
+            else
+            {
+                Occult<false>(Source, Occulter, &Position.X, &Position.Y, &Position.Z, 1, &_visible, &Rank);
+            }
+        }
+
+        if (Visible)
+        {
+            *Visible = _visible;
+        }
+        return RankToShadow[Rank];
+    }
+}
@@ -0,0 +1,252 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+//------------------------------------------------------------------------------
+// SpiceEphemeris.cpp
+// 
+// Implementation Comments
+// 
+// Purpose:  Per-tick ephemeris & frame queries, by FName
+// 
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemeris.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceEphemeris.h"
+#include "SpiceCore.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace MaxQ::Ephemeris
+{
+    namespace
+    {
+        // FName (interned) & enum overloads
+        using MaxQ::Core::ToANSIString;
+
+        // Same strings as MaxQ::Core::ToString(method, {}), without the FString
+        const ANSICHAR* MethodString(ES_ComputationMethod method)
+        {
+            switch (method)
+            {
+            case ES_ComputationMethod::NEAR_POINT_ELLIPSOID:
+                return "NEAR POINT/ELLIPSOID";
+            case ES_ComputationMethod::INTERCEPT_ELLIPSOID:
+                return "INTERCEPT/ELLIPSOID";
+            case ES_ComputationMethod::NADIR_DSK:
+                return "NADIR/DSK/UNPRIORITIZED";
+            case ES_ComputationMethod::INTERCEPT_DSK:
+                return "INTERCEPT/DSK/UNPRIORITIZED";
+            default:
+                break;
+            }
+
+            return "NONE";
+        }
+
+        const ANSICHAR* MethodString(ES_GeometricModel method)
+        {
+            switch (method)
+            {
+            case ES_GeometricModel::ELLIPSOID:
+                return "ELLIPSOID";
+            case ES_GeometricModel::POINT:
+                return "POINT";
+            case ES_GeometricModel::DSK:
+                return "DSK/UNPRIORITIZED";
+            default:
+                break;
+            }
+
+            return "NONE";
+        }
+    }
+
+    SPICE_API void Spkezr(
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FSEphemerisTime& et,
+        const FName& targ,
+        const FName& obs,
+        const FName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Ephemeris::Spkezr, targ, obs, ref);
+        SpiceDouble _lt = lt.AsSpiceDouble();
+        SpiceDouble _state[6];  state.CopyTo(_state);
+
+        spkezr_c(ToANSIString(targ), et.AsSpiceDouble(), ToANSIString(ref), ToANSIString(abcorr), ToANSIString(obs), _state, &_lt);
+
+        ErrorCheck(ResultCode, ErrorMessage);
+
+        lt = FSEphemerisPeriod(_lt);
+        state = FSStateVector(_state);
+    }
+
+    SPICE_API void Spkpos(
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt,
+        const FSEphemerisTime& et,
+        const FName& targ,
+        const FName& obs,
+        const FName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Ephemeris::Spkpos, targ, obs, ref);
+        SpiceDouble _lt = lt.AsSpiceDouble();
+        SpiceDouble _ptarg[3];  ZeroOut(_ptarg);
+
+        spkpos_c(ToANSIString(targ), et.AsSpiceDouble(), ToANSIString(ref), ToANSIString(abcorr), ToANSIString(obs), _ptarg, &_lt);
+
+        lt = FSEphemerisPeriod(_lt);
+        ptarg = FSDistanceVector(_ptarg);
+
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+    SPICE_API void Pxform(
+        FSRotationMatrix& rotate,
+        const FSEphemerisTime& et,
+        const FName& from,
+        const FName& to,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Ephemeris::Pxform);
+        SpiceDouble _rotate[3][3];  rotate.CopyTo(_rotate);
+
+        pxform_c(ToANSIString(from), ToANSIString(to), et.AsSpiceDouble(), _rotate);
+
+        ErrorCheck(ResultCode, ErrorMessage);
+
+        rotate = FSRotationMatrix(_rotate);
+    }
+
+    SPICE_API void Sxform(
+        FSStateTransform& xform,
+        const FSEphemerisTime& et,
+        const FName& from,
+        const FName& to,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Ephemeris::Sxform);
+        SpiceDouble _xform[6][6];  xform.CopyTo(_xform);
+
+        sxform_c(ToANSIString(from), ToANSIString(to), et.AsSpiceDouble(), _xform);
+
+        ErrorCheck(ResultCode, ErrorMessage);
+
+        xform = FSStateTransform(_xform);
+    }
+
+    SPICE_API void Subpnt(
+        FSDistanceVector& spoint,
+        FSEphemerisTime& trgepc,
+        FSDistanceVector& srfvec,
+        const FSEphemerisTime& et,
+        const FName& target,
+        const FName& fixref,
+        const FName& obsrvr,
+        ES_ComputationMethod method,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Ephemeris::Subpnt, target, obsrvr, fixref);
+        SpiceDouble _spoint[3];  ZeroOut(_spoint);
+        SpiceDouble _trgepc = 0.;
+        SpiceDouble _srfvec[3];  ZeroOut(_srfvec);
+
+        subpnt_c(
+            MethodString(method),
+            ToANSIString(target),
+            et.AsSpiceDouble(),
+            ToANSIString(fixref),
+            ToANSIString(abcorr),
+            ToANSIString(obsrvr),
+            _spoint,
+            &_trgepc,
+            _srfvec
+        );
+
+        spoint = FSDistanceVector(_spoint);
+        trgepc = FSEphemerisTime(_trgepc);
+        srfvec = FSDistanceVector(_srfvec);
+
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+    SPICE_API bool Sincpt(
+        FSDistanceVector& spoint,
+        FSEphemerisTime& trgepc,
+        FSDistanceVector& srfvec,
+        const FSEphemerisTime& et,
+        const FName& target,
+        const FName& fixref,
+        const FName& obsrvr,
+        const FName& dref,
+        const FSDimensionlessVector& dvec,
+        ES_GeometricModel method,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Ephemeris::Sincpt, target, obsrvr, fixref);
+        SpiceDouble  _dvec[3];    dvec.CopyTo(_dvec);
+        SpiceDouble  _spoint[3];  ZeroOut(_spoint);
+        SpiceDouble  _trgepc = 0.;
+        SpiceDouble  _srfvec[3];  ZeroOut(_srfvec);
+        SpiceBoolean _found = SPICEFALSE;
+
+        sincpt_c(
+            MethodString(method),
+            ToANSIString(target),
+            et.AsSpiceDouble(),
+            ToANSIString(fixref),
+            ToANSIString(abcorr),
+            ToANSIString(obsrvr),
+            ToANSIString(dref),
+            _dvec,
+            _spoint,
+            &_trgepc,
+            _srfvec,
+            &_found
+        );
+
+        spoint = FSDistanceVector(_spoint);
+        trgepc = FSEphemerisTime(_trgepc);
+        srfvec = FSDistanceVector(_srfvec);
+
+        ErrorCheck(ResultCode, ErrorMessage);
+
+        return _found != SPICEFALSE;
+    }
+}
@@ -0,0 +1,1229 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceExpression.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Compiled vector/matrix expressions
+//
+// Source text is parsed into a small tree, then type-checked and flattened
+// into a postfix program in one pass.  Evaluation runs the program over a
+// fixed stack of double[36] slots (wide enough for a 6x6 state transform),
+// so nothing is allocated per evaluation.  Operands are read straight from
+// the caller's structs, and the result is written straight into theirs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceExpression.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceExpression.h"
+#include "SpiceLog.h"
+#include "Misc/ScopeRWLock.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+namespace MaxQ::Math
+{
+    namespace
+    {
+        enum class EShape : uint8 { Scalar, Vector, State, Matrix, Transform };
+        enum class EUnit : uint8 { Dimensionless, Distance, Speed, AngularRate, Angle, MassConstant };
+
+        // SStateVector mixes km & km/s; it's tagged "Distance", which is only
+        // ever compared for equality.
+        struct FTypeInfo
+        {
+            EShape Shape;
+            EUnit Unit;
+            const TCHAR* Name;
+        };
+
+        const FTypeInfo TypeInfo[] =
+        {
+            { EShape::Scalar, EUnit::Dimensionless, TEXT("Double") },
+            { EShape::Scalar, EUnit::Distance, TEXT("SDistance") },
+            { EShape::Scalar, EUnit::Speed, TEXT("SSpeed") },
+            { EShape::Scalar, EUnit::AngularRate, TEXT("SAngularRate") },
+            { EShape::Scalar, EUnit::Angle, TEXT("SAngle") },
+            { EShape::Scalar, EUnit::MassConstant, TEXT("SMassConstant") },
+            { EShape::Vector, EUnit::Dimensionless, TEXT("SDimensionlessVector") },
+            { EShape::Vector, EUnit::Distance, TEXT("SDistanceVector") },
+            { EShape::Vector, EUnit::Speed, TEXT("SVelocityVector") },
+            { EShape::Vector, EUnit::AngularRate, TEXT("SAngularVelocity") },
+            { EShape::State, EUnit::Dimensionless, TEXT("SDimensionlessStateVector") },
+            { EShape::State, EUnit::Distance, TEXT("SStateVector") },
+            { EShape::Matrix, EUnit::Dimensionless, TEXT("SRotationMatrix") },
+            { EShape::Transform, EUnit::Dimensionless, TEXT("SStateTransform") },
+        };
+        static_assert(UE_ARRAY_COUNT(TypeInfo) == (int32)EExpressionType::Invalid, "TypeInfo must match EExpressionType");
+
+        constexpr int32 SlotWidth = 36;
+
+        uint8 Width(EShape Shape)
+        {
+            switch (Shape)
+            {
+            case EShape::Scalar: return 1;
+            case EShape::Vector: return 3;
+            case EShape::State: return 6;
+            case EShape::Matrix: return 9;
+            case EShape::Transform: return 36;
+            default: break;
+            }
+            return 0;
+        }
+
+        EExpressionType FindType(EShape Shape, EUnit Unit)
+        {
+            for (int32 i = 0; i < UE_ARRAY_COUNT(TypeInfo); ++i)
+            {
+                if (TypeInfo[i].Shape == Shape && TypeInfo[i].Unit == Unit) return (EExpressionType)i;
+            }
+            return EExpressionType::Invalid;
+        }
+
+        EExpressionType FindType(const TCHAR* Name)
+        {
+            for (int32 i = 0; i < UE_ARRAY_COUNT(TypeInfo); ++i)
+            {
+                // Case-insensitive, program strings travel as FNames
+                if (FCString::Stricmp(TypeInfo[i].Name, Name) == 0) return (EExpressionType)i;
+            }
+            return EExpressionType::Invalid;
+        }
+
+        enum class EOp : uint8
+        {
+            Load,
+            Constant,
+            Add,
+            Sub,
+            Neg,
+            ScaleLeft,      // s * x
+            ScaleRight,     // x * s
+            Divide,         // x / s
+            Mxv,
+            Mtxv,
+            Mxm,
+            Txs,            // 6x6 * state
+            Txt,            // 6x6 * 6x6
+            Vhat,
+            Vnorm,
+            Vdot,
+            Vcrss,
+            Vsep
+        };
+
+        enum class EFunction : uint8 { Unorm, Vhat, Vnorm, Vdot, Vcrss, Vsep, Mxv, Mtxv, Mxm, None };
+
+        struct FFunctionInfo
+        {
+            const TCHAR* Name;
+            int32 NumArgs;
+        };
+
+        const FFunctionInfo FunctionInfo[] =
+        {
+            { TEXT("unorm"), 1 },
+            { TEXT("vhat"), 1 },
+            { TEXT("vnorm"), 1 },
+            { TEXT("vdot"), 2 },
+            { TEXT("vcrss"), 2 },
+            { TEXT("vsep"), 2 },
+            { TEXT("mxv"), 2 },
+            { TEXT("mtxv"), 2 },
+            { TEXT("mxm"), 2 },
+        };
+        static_assert(UE_ARRAY_COUNT(FunctionInfo) == (int32)EFunction::None, "FunctionInfo must match EFunction");
+
+        struct FNode
+        {
+            enum class EKind : uint8 { Constant, Operand, Negate, Binary, Call };
+
+            EKind Kind { EKind::Constant };
+            TCHAR Operator { 0 };
+            EFunction Function { EFunction::None };
+            double Value { 0. };
+            int32 Operand { INDEX_NONE };
+            int32 Args[2] { INDEX_NONE, INDEX_NONE };
+        };
+
+        // Recursive descent:
+        //   sum     := product (('+' | '-') product)*
+        //   product := unary (('*' | '/') unary)*
+        //   unary   := ('-' | '+') unary | primary
+        //   primary := number | name | name '(' sum (',' sum)* ')' | '(' sum ')'
+        // In a program string operands are "$n" rather than names.
+        class FParser
+        {
+        public:
+            FParser(const FString& Source, bool bIsProgram) : p(*Source), bProgram(bIsProgram) {}
+
+            bool Parse(int32& Root)
+            {
+                Root = ParseSum();
+                SkipWhitespace();
+                if (Error.IsEmpty() && *p)
+                {
+                    Fail(FString::Printf(TEXT("Unexpected '%c'"), *p));
+                }
+                return Error.IsEmpty();
+            }
+
+            TArray<FNode> Nodes;
+            TArray<FString> Names;
+            FString Error;
+
+        private:
+            const TCHAR* p;
+            bool bProgram;
+            int32 Depth { 0 };
+
+            static constexpr int32 MaxNesting = 64;
+
+            int32 Fail(const FString& Message)
+            {
+                if (Error.IsEmpty()) Error = Message;
+                return INDEX_NONE;
+            }
+
+            void SkipWhitespace()
+            {
+                while (FChar::IsWhitespace(*p)) ++p;
+            }
+
+            int32 Add(const FNode& Node)
+            {
+                return Nodes.Add(Node);
+            }
+
+            int32 Binary(TCHAR Operator, int32 Left, int32 Right)
+            {
+                FNode Node;
+                Node.Kind = FNode::EKind::Binary;
+                Node.Operator = Operator;
+                Node.Args[0] = Left;
+                Node.Args[1] = Right;
+                return Add(Node);
+            }
+
+            int32 ParseSum()
+            {
+                int32 Left = ParseProduct();
+                while (Error.IsEmpty())
+                {
+                    SkipWhitespace();
+                    if (*p != '+' && *p != '-') break;
+                    const TCHAR Operator = *p++;
+                    const int32 Right = ParseProduct();
+                    Left = Binary(Operator, Left, Right);
+                }
+                return Error.IsEmpty() ? Left : INDEX_NONE;
+            }
+
+            int32 ParseProduct()
+            {
+                int32 Left = ParseUnary();
+                while (Error.IsEmpty())
+                {
+                    SkipWhitespace();
+                    if (*p != '*' && *p != '/') break;
+                    const TCHAR Operator = *p++;
+                    const int32 Right = ParseUnary();
+                    Left = Binary(Operator, Left, Right);
+                }
+                return Error.IsEmpty() ? Left : INDEX_NONE;
+            }
+
+            int32 ParseUnary()
+            {
+                if (++Depth > MaxNesting)
+                {
+                    return Fail(TEXT("Expression is nested too deeply"));
+                }
+
+                int32 Result = INDEX_NONE;
+                SkipWhitespace();
+                if (*p == '-')
+                {
+                    ++p;
+                    FNode Node;
+                    Node.Kind = FNode::EKind::Negate;
+                    Node.Args[0] = ParseUnary();
+                    Result = Add(Node);
+                }
+                else if (*p == '+')
+                {
+                    ++p;
+                    Result = ParseUnary();
+                }
+                else
+                {
+                    Result = ParsePrimary();
+                }
+
+                --Depth;
+                return Error.IsEmpty() ? Result : INDEX_NONE;
+            }
+
+            int32 ParsePrimary()
+            {
+                SkipWhitespace();
+
+                if (*p == '(')
+                {
+                    ++p;
+                    const int32 Inner = ParseSum();
+                    SkipWhitespace();
+                    if (*p != ')') return Fail(TEXT("Expected ')'"));
+                    ++p;
+                    return Inner;
+                }
+
+                if (FChar::IsDigit(*p) || *p == '.')
+                {
+                    TCHAR* End = nullptr;
+                    FNode Node;
+                    Node.Kind = FNode::EKind::Constant;
+                    Node.Value = FCString::Strtod(p, &End);
+                    if (End == p) return Fail(TEXT("Malformed number"));
+                    p = End;
+                    return Add(Node);
+                }
+
+                if (bProgram && *p == '$')
+                {
+                    ++p;
+                    if (!FChar::IsDigit(*p)) return Fail(TEXT("Expected an operand index after '$'"));
+                    FNode Node;
+                    Node.Kind = FNode::EKind::Operand;
+                    Node.Operand = 0;
+                    while (FChar::IsDigit(*p) && Node.Operand < FExpression::MaxOperands)
+                    {
+                        Node.Operand = Node.Operand * 10 + (*p++ - '0');
+                    }
+                    return Add(Node);
+                }
+
+                if (FChar::IsAlpha(*p) || *p == '_')
+                {
+                    const TCHAR* Start = p;
+                    while (FChar::IsAlnum(*p) || *p == '_') ++p;
+                    const FString Name(UE_PTRDIFF_TO_INT32(p - Start), Start);
+
+                    SkipWhitespace();
+                    if (*p == '(')
+                    {
+                        return ParseCall(Name);
+                    }
+
+                    if (bProgram)
+                    {
+                        return Fail(FString::Printf(TEXT("Unexpected name '%s' in a program string"), *Name));
+                    }
+
+                    FNode Node;
+                    Node.Kind = FNode::EKind::Operand;
+                    // Names become pin names, which aren't case-sensitive
+                    Node.Operand = Names.IndexOfByPredicate([&Name](const FString& Other) { return Other.Equals(Name, ESearchCase::IgnoreCase); });
+                    if (Node.Operand == INDEX_NONE)
+                    {
+                        if (Names.Num() >= FExpression::MaxOperands) return Fail(TEXT("Too many operands"));
+                        Node.Operand = Names.Add(Name);
+                    }
+                    return Add(Node);
+                }
+
+                if (!*p) return Fail(TEXT("Unexpected end of expression"));
+                return Fail(FString::Printf(TEXT("Unexpected '%c'"), *p));
+            }
+
+            int32 ParseCall(const FString& Name)
+            {
+                FNode Node;
+                Node.Kind = FNode::EKind::Call;
+
+                for (int32 i = 0; i < UE_ARRAY_COUNT(FunctionInfo); ++i)
+                {
+                    if (Name.Equals(FunctionInfo[i].Name, ESearchCase::IgnoreCase)) Node.Function = (EFunction)i;
+                }
+
+                if (Node.Function == EFunction::None)
+                {
+                    return Fail(FString::Printf(TEXT("Unknown function '%s'"), *Name));
+                }
+
+                // Skip '('
+                ++p;
+
+                const int32 NumArgs = FunctionInfo[(int32)Node.Function].NumArgs;
+                for (int32 i = 0; i < NumArgs; ++i)
+                {
+                    if (i > 0)
+                    {
+                        SkipWhitespace();
+                        if (*p != ',') return Fail(FString::Printf(TEXT("%s expects %d arguments"), FunctionInfo[(int32)Node.Function].Name, NumArgs));
+                        ++p;
+                    }
+                    Node.Args[i] = ParseSum();
+                    if (!Error.IsEmpty()) return INDEX_NONE;
+                }
+
+                SkipWhitespace();
+                if (*p != ')') return Fail(FString::Printf(TEXT("%s expects %d argument%s"), FunctionInfo[(int32)Node.Function].Name, NumArgs, NumArgs > 1 ? TEXT("s") : TEXT("")));
+                ++p;
+
+                return Add(Node);
+            }
+        };
+
+        struct FNodeType
+        {
+            EShape Shape;
+            EUnit Unit;
+        };
+
+        FString Describe(const FNodeType& Type)
+        {
+            const EExpressionType Concrete = FindType(Type.Shape, Type.Unit);
+            if (Concrete != EExpressionType::Invalid) return TypeInfo[(int32)Concrete].Name;
+            return TEXT("an unsupported type");
+        }
+
+        // The unit of a product, where at most one side may have units
+        bool ProductUnit(EUnit a, EUnit b, EUnit& Unit)
+        {
+            if (a == EUnit::Dimensionless) { Unit = b; return true; }
+            if (b == EUnit::Dimensionless) { Unit = a; return true; }
+            return false;
+        }
+
+        // Scalars, matrices & transforms only as operands or the result; the
+        // evaluator works on plain doubles.
+        void LoadOperand(double* Out, EExpressionType Type, const void* Operand)
+        {
+            switch (Type)
+            {
+            case EExpressionType::Double: Out[0] = *static_cast<const double*>(Operand); break;
+            case EExpressionType::SDistance: Out[0] = static_cast<const FSDistance*>(Operand)->km; break;
+            case EExpressionType::SSpeed: Out[0] = static_cast<const FSSpeed*>(Operand)->kmps; break;
+            case EExpressionType::SAngularRate: Out[0] = static_cast<const FSAngularRate*>(Operand)->radiansPerSecond; break;
+            case EExpressionType::SAngle: Out[0] = static_cast<const FSAngle*>(Operand)->AsRadians(); break;
+            case EExpressionType::SMassConstant: Out[0] = static_cast<const FSMassConstant*>(Operand)->GM; break;
+            case EExpressionType::SDimensionlessVector:
+            {
+                const FSDimensionlessVector& v = *static_cast<const FSDimensionlessVector*>(Operand);
+                Out[0] = v.x; Out[1] = v.y; Out[2] = v.z;
+                break;
+            }
+            case EExpressionType::SDistanceVector:
+            {
+                const FSDistanceVector& v = *static_cast<const FSDistanceVector*>(Operand);
+                Out[0] = v.x.km; Out[1] = v.y.km; Out[2] = v.z.km;
+                break;
+            }
+            case EExpressionType::SVelocityVector:
+            {
+                const FSVelocityVector& v = *static_cast<const FSVelocityVector*>(Operand);
+                Out[0] = v.dx.kmps; Out[1] = v.dy.kmps; Out[2] = v.dz.kmps;
+                break;
+            }
+            case EExpressionType::SAngularVelocity:
+            {
+                const FSAngularVelocity& v = *static_cast<const FSAngularVelocity*>(Operand);
+                Out[0] = v.x.radiansPerSecond; Out[1] = v.y.radiansPerSecond; Out[2] = v.z.radiansPerSecond;
+                break;
+            }
+            case EExpressionType::SDimensionlessStateVector:
+            {
+                const FSDimensionlessStateVector& v = *static_cast<const FSDimensionlessStateVector*>(Operand);
+                Out[0] = v.r.x; Out[1] = v.r.y; Out[2] = v.r.z;
+                Out[3] = v.dr.x; Out[4] = v.dr.y; Out[5] = v.dr.z;
+                break;
+            }
+            case EExpressionType::SStateVector:
+            {
+                const FSStateVector& v = *static_cast<const FSStateVector*>(Operand);
+                Out[0] = v.r.x.km; Out[1] = v.r.y.km; Out[2] = v.r.z.km;
+                Out[3] = v.v.dx.kmps; Out[4] = v.v.dy.kmps; Out[5] = v.v.dz.kmps;
+                break;
+            }
+            case EExpressionType::SRotationMatrix:
+            {
+                const FSRotationMatrix& m = *static_cast<const FSRotationMatrix*>(Operand);
+                for (int32 i = 0; i < 3; ++i)
+                {
+                    const FSDimensionlessVector& Row = m.m.IsValidIndex(i) ? m.m[i] : FSDimensionlessVector::Zero;
+                    Out[3 * i] = Row.x; Out[3 * i + 1] = Row.y; Out[3 * i + 2] = Row.z;
+                }
+                break;
+            }
+            case EExpressionType::SStateTransform:
+            {
+                static const FSDimensionlessStateVector ZeroRow;
+                const FSStateTransform& m = *static_cast<const FSStateTransform*>(Operand);
+                for (int32 i = 0; i < 6; ++i)
+                {
+                    const FSDimensionlessStateVector& Row = m.m.IsValidIndex(i) ? m.m[i] : ZeroRow;
+                    double* Out6 = Out + 6 * i;
+                    Out6[0] = Row.r.x; Out6[1] = Row.r.y; Out6[2] = Row.r.z;
+                    Out6[3] = Row.dr.x; Out6[4] = Row.dr.y; Out6[5] = Row.dr.z;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        void StoreResult(const double* In, EExpressionType Type, void* Result)
+        {
+            switch (Type)
+            {
+            case EExpressionType::Double: *static_cast<double*>(Result) = In[0]; break;
+            case EExpressionType::SDistance: static_cast<FSDistance*>(Result)->km = In[0]; break;
+            case EExpressionType::SSpeed: static_cast<FSSpeed*>(Result)->kmps = In[0]; break;
+            case EExpressionType::SAngularRate: static_cast<FSAngularRate*>(Result)->radiansPerSecond = In[0]; break;
+            case EExpressionType::SAngle: *static_cast<FSAngle*>(Result) = FSAngle(In[0]); break;
+            case EExpressionType::SMassConstant: static_cast<FSMassConstant*>(Result)->GM = In[0]; break;
+            case EExpressionType::SDimensionlessVector:
+            {
+                FSDimensionlessVector& v = *static_cast<FSDimensionlessVector*>(Result);
+                v.x = In[0]; v.y = In[1]; v.z = In[2];
+                break;
+            }
+            case EExpressionType::SDistanceVector:
+            {
+                FSDistanceVector& v = *static_cast<FSDistanceVector*>(Result);
+                v.x.km = In[0]; v.y.km = In[1]; v.z.km = In[2];
+                break;
+            }
+            case EExpressionType::SVelocityVector:
+            {
+                FSVelocityVector& v = *static_cast<FSVelocityVector*>(Result);
+                v.dx.kmps = In[0]; v.dy.kmps = In[1]; v.dz.kmps = In[2];
+                break;
+            }
+            case EExpressionType::SAngularVelocity:
+            {
+                FSAngularVelocity& v = *static_cast<FSAngularVelocity*>(Result);
+                v.x.radiansPerSecond = In[0]; v.y.radiansPerSecond = In[1]; v.z.radiansPerSecond = In[2];
+                break;
+            }
+            case EExpressionType::SDimensionlessStateVector:
+            {
+                FSDimensionlessStateVector& v = *static_cast<FSDimensionlessStateVector*>(Result);
+                v.r.x = In[0]; v.r.y = In[1]; v.r.z = In[2];
+                v.dr.x = In[3]; v.dr.y = In[4]; v.dr.z = In[5];
+                break;
+            }
+            case EExpressionType::SStateVector:
+            {
+                FSStateVector& v = *static_cast<FSStateVector*>(Result);
+                v.r.x.km = In[0]; v.r.y.km = In[1]; v.r.z.km = In[2];
+                v.v.dx.kmps = In[3]; v.v.dy.kmps = In[4]; v.v.dz.kmps = In[5];
+                break;
+            }
+            case EExpressionType::SRotationMatrix:
+            {
+                FSRotationMatrix& m = *static_cast<FSRotationMatrix*>(Result);
+                m.m.SetNum(3);
+                for (int32 i = 0; i < 3; ++i)
+                {
+                    m.m[i] = FSDimensionlessVector(In[3 * i], In[3 * i + 1], In[3 * i + 2]);
+                }
+                break;
+            }
+            case EExpressionType::SStateTransform:
+            {
+                FSStateTransform& m = *static_cast<FSStateTransform*>(Result);
+                m.m.SetNum(6);
+                for (int32 i = 0; i < 6; ++i)
+                {
+                    const double* In6 = In + 6 * i;
+                    m.m[i].r = FSDimensionlessVector(In6[0], In6[1], In6[2]);
+                    m.m[i].dr = FSDimensionlessVector(In6[3], In6[4], In6[5]);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+    // Type-checks the parse tree while flattening it into a postfix program
+    class FExpressionCompiler
+    {
+    public:
+        static TSharedPtr<FExpression> Compile(const FString& Body, bool bIsProgram, const TArray<EExpressionType>& OperandTypes, FString& ErrorMessage)
+        {
+            FParser Parser(Body, bIsProgram);
+            int32 Root = INDEX_NONE;
+            if (!Parser.Parse(Root))
+            {
+                ErrorMessage = Parser.Error;
+                return nullptr;
+            }
+
+            if (!bIsProgram && Parser.Names.Num() != OperandTypes.Num())
+            {
+                ErrorMessage = FString::Printf(TEXT("Expected %d operand types, got %d"), Parser.Names.Num(), OperandTypes.Num());
+                return nullptr;
+            }
+
+            for (int32 i = 0; i < OperandTypes.Num(); ++i)
+            {
+                if (OperandTypes[i] == EExpressionType::Invalid)
+                {
+                    ErrorMessage = bIsProgram ?
+                        FString::Printf(TEXT("Operand $%d has an unsupported type"), i) :
+                        FString::Printf(TEXT("Operand '%s' has an unsupported type"), *Parser.Names[i]);
+                    return nullptr;
+                }
+            }
+
+            TSharedPtr<FExpression> Expression = MakeShared<FExpression>();
+            Expression->OperandTypes = OperandTypes;
+
+            FExpressionCompiler Compiler(Parser, *Expression);
+            FNodeType ResultType;
+            if (!Compiler.Emit(Root, ResultType))
+            {
+                ErrorMessage = Compiler.Error;
+                return nullptr;
+            }
+
+            Expression->ResultType = FindType(ResultType.Shape, ResultType.Unit);
+            if (Expression->ResultType == EExpressionType::Invalid)
+            {
+                ErrorMessage = TEXT("The result has no MaxQ type (check units)");
+                return nullptr;
+            }
+
+            if (Compiler.MaxDepth > FExpression::MaxStackDepth)
+            {
+                ErrorMessage = TEXT("Expression is too complex to evaluate");
+                return nullptr;
+            }
+
+            TStringBuilder<256> Program;
+            for (int32 i = 0; i < OperandTypes.Num(); ++i)
+            {
+                if (i > 0) Program.AppendChar(',');
+                Program.Append(TypeInfo[(int32)OperandTypes[i]].Name);
+            }
+            Program.AppendChar('|');
+            Compiler.Print(Root, Program);
+
+            Expression->ProgramString = Program.ToString();
+            Expression->bIsValid = true;
+            return Expression;
+        }
+
+    private:
+        FExpressionCompiler(const FParser& InParser, FExpression& InExpression) : Parser(InParser), Expression(InExpression) {}
+
+        const FParser& Parser;
+        FExpression& Expression;
+        FString Error;
+        int32 Depth { 0 };
+        int32 MaxDepth { 0 };
+
+        bool Fail(const FString& Message)
+        {
+            if (Error.IsEmpty()) Error = Message;
+            return false;
+        }
+
+        const TCHAR* OperandName(int32 Index) const
+        {
+            return Parser.Names.IsValidIndex(Index) ? *Parser.Names[Index] : TEXT("$");
+        }
+
+        // Pops NumPopped slots & pushes one
+        void Emit(EOp Op, uint8 Width, int32 NumPopped, int32 Index = 0)
+        {
+            Expression.Program.Add({ (uint8)Op, Width, Index });
+            Depth += 1 - NumPopped;
+            MaxDepth = FMath::Max(MaxDepth, Depth);
+        }
+
+        bool Scaled(const FNodeType& x, EUnit ScalarUnit, FNodeType& Type)
+        {
+            if (ScalarUnit == EUnit::Dimensionless)
+            {
+                Type = x;
+                return true;
+            }
+            if (x.Unit == EUnit::Dimensionless && (x.Shape == EShape::Scalar || x.Shape == EShape::Vector))
+            {
+                Type = { x.Shape, ScalarUnit };
+                return true;
+            }
+            return false;
+        }
+
+        bool Emit(int32 NodeIndex, FNodeType& Type)
+        {
+            const FNode& Node = Parser.Nodes[NodeIndex];
+
+            switch (Node.Kind)
+            {
+            case FNode::EKind::Constant:
+                Type = { EShape::Scalar, EUnit::Dimensionless };
+                Emit(EOp::Constant, 1, 0, Expression.Constants.Add(Node.Value));
+                return true;
+
+            case FNode::EKind::Operand:
+            {
+                if (!Expression.OperandTypes.IsValidIndex(Node.Operand))
+                {
+                    return Fail(FString::Printf(TEXT("Operand $%d is out of range"), Node.Operand));
+                }
+                const FTypeInfo& Info = TypeInfo[(int32)Expression.OperandTypes[Node.Operand]];
+                Type = { Info.Shape, Info.Unit };
+                Emit(EOp::Load, Width(Type.Shape), 0, Node.Operand);
+                return true;
+            }
+
+            case FNode::EKind::Negate:
+                if (!Emit(Node.Args[0], Type)) return false;
+                Emit(EOp::Neg, Width(Type.Shape), 1);
+                return true;
+
+            case FNode::EKind::Binary:
+                return EmitBinary(Node, Type);
+
+            case FNode::EKind::Call:
+                return EmitCall(Node, Type);
+
+            default:
+                break;
+            }
+
+            return Fail(TEXT("Internal error"));
+        }
+
+        bool EmitBinary(const FNode& Node, FNodeType& Type)
+        {
+            FNodeType L, R;
+            if (!Emit(Node.Args[0], L) || !Emit(Node.Args[1], R)) return false;
+
+            switch (Node.Operator)
+            {
+            case '+':
+            case '-':
+                if (L.Shape != R.Shape || L.Unit != R.Unit)
+                {
+                    return Fail(FString::Printf(TEXT("Can't %s %s and %s"), Node.Operator == '+' ? TEXT("add") : TEXT("subtract"), *Describe(L), *Describe(R)));
+                }
+                Type = L;
+                Emit(Node.Operator == '+' ? EOp::Add : EOp::Sub, Width(L.Shape), 2);
+                return true;
+
+            case '*':
+                if (L.Shape == EShape::Scalar && R.Shape != EShape::Scalar)
+                {
+                    if (!Scaled(R, L.Unit, Type)) break;
+                    Emit(EOp::ScaleLeft, Width(R.Shape), 2);
+                    return true;
+                }
+                if (R.Shape == EShape::Scalar)
+                {
+                    if (L.Shape == EShape::Scalar)
+                    {
+                        EUnit Unit;
+                        if (!ProductUnit(L.Unit, R.Unit, Unit)) break;
+                        Type = { EShape::Scalar, Unit };
+                    }
+                    else if (!Scaled(L, R.Unit, Type))
+                    {
+                        break;
+                    }
+                    Emit(EOp::ScaleRight, Width(L.Shape), 2);
+                    return true;
+                }
+                if (L.Shape == EShape::Matrix && R.Shape == EShape::Vector)
+                {
+                    Type = R;
+                    Emit(EOp::Mxv, 3, 2);
+                    return true;
+                }
+                if (L.Shape == EShape::Matrix && R.Shape == EShape::Matrix)
+                {
+                    Type = R;
+                    Emit(EOp::Mxm, 9, 2);
+                    return true;
+                }
+                if (L.Shape == EShape::Transform && R.Shape == EShape::State)
+                {
+                    Type = R;
+                    Emit(EOp::Txs, 6, 2);
+                    return true;
+                }
+                if (L.Shape == EShape::Transform && R.Shape == EShape::Transform)
+                {
+                    Type = R;
+                    Emit(EOp::Txt, 36, 2);
+                    return true;
+                }
+                if (L.Shape == EShape::Vector && R.Shape == EShape::Vector)
+                {
+                    return Fail(TEXT("Can't multiply two vectors, use vdot or vcrss"));
+                }
+                break;
+
+            case '/':
+                if (R.Shape != EShape::Scalar)
+                {
+                    return Fail(FString::Printf(TEXT("Can't divide by %s"), *Describe(R)));
+                }
+                if (R.Unit == EUnit::Dimensionless)
+                {
+                    Type = L;
+                }
+                else if (L.Unit == R.Unit && (L.Shape == EShape::Scalar || L.Shape == EShape::Vector))
+                {
+                    Type = { L.Shape, EUnit::Dimensionless };
+                }
+                else
+                {
+                    break;
+                }
+                Emit(EOp::Divide, Width(L.Shape), 2);
+                return true;
+
+            default:
+                break;
+            }
+
+            return Fail(FString::Printf(TEXT("Can't %s %s by %s"), Node.Operator == '*' ? TEXT("multiply") : TEXT("divide"), *Describe(L), *Describe(R)));
+        }
+
+        bool EmitCall(const FNode& Node, FNodeType& Type)
+        {
+            const TCHAR* Name = FunctionInfo[(int32)Node.Function].Name;
+            const int32 NumArgs = FunctionInfo[(int32)Node.Function].NumArgs;
+
+            FNodeType Args[2];
+            for (int32 i = 0; i < NumArgs; ++i)
+            {
+                if (!Emit(Node.Args[i], Args[i])) return false;
+            }
+
+            const bool bVectors = Args[0].Shape == EShape::Vector && (NumArgs < 2 || Args[1].Shape == EShape::Vector);
+
+            switch (Node.Function)
+            {
+            case EFunction::Unorm:
+            case EFunction::Vhat:
+                if (!bVectors) break;
+                Type = { EShape::Vector, EUnit::Dimensionless };
+                Emit(EOp::Vhat, 3, 1);
+                return true;
+
+            case EFunction::Vnorm:
+                if (!bVectors) break;
+                Type = { EShape::Scalar, Args[0].Unit };
+                Emit(EOp::Vnorm, 3, 1);
+                return true;
+
+            case EFunction::Vdot:
+            case EFunction::Vcrss:
+            {
+                EUnit Unit;
+                if (!bVectors) break;
+                if (!ProductUnit(Args[0].Unit, Args[1].Unit, Unit))
+                {
+                    return Fail(FString::Printf(TEXT("%s of %s and %s has no MaxQ type"), Name, *Describe(Args[0]), *Describe(Args[1])));
+                }
+                const bool bDot = Node.Function == EFunction::Vdot;
+                Type = { bDot ? EShape::Scalar : EShape::Vector, Unit };
+                Emit(bDot ? EOp::Vdot : EOp::Vcrss, 3, 2);
+                return true;
+            }
+
+            case EFunction::Vsep:
+                if (!bVectors) break;
+                Type = { EShape::Scalar, EUnit::Angle };
+                Emit(EOp::Vsep, 3, 2);
+                return true;
+
+            case EFunction::Mxv:
+                if (Args[0].Shape == EShape::Matrix && Args[1].Shape == EShape::Vector)
+                {
+                    Type = Args[1];
+                    Emit(EOp::Mxv, 3, 2);
+                    return true;
+                }
+                if (Args[0].Shape == EShape::Transform && Args[1].Shape == EShape::State)
+                {
+                    Type = Args[1];
+                    Emit(EOp::Txs, 6, 2);
+                    return true;
+                }
+                break;
+
+            case EFunction::Mtxv:
+                if (Args[0].Shape == EShape::Matrix && Args[1].Shape == EShape::Vector)
+                {
+                    Type = Args[1];
+                    Emit(EOp::Mtxv, 3, 2);
+                    return true;
+                }
+                break;
+
+            case EFunction::Mxm:
+                if (Args[0].Shape == EShape::Matrix && Args[1].Shape == EShape::Matrix)
+                {
+                    Type = Args[1];
+                    Emit(EOp::Mxm, 9, 2);
+                    return true;
+                }
+                if (Args[0].Shape == EShape::Transform && Args[1].Shape == EShape::Transform)
+                {
+                    Type = Args[1];
+                    Emit(EOp::Txt, 36, 2);
+                    return true;
+                }
+                break;
+
+            default:
+                break;
+            }
+
+            return NumArgs > 1 ?
+                Fail(FString::Printf(TEXT("%s doesn't accept %s and %s"), Name, *Describe(Args[0]), *Describe(Args[1]))) :
+                Fail(FString::Printf(TEXT("%s doesn't accept %s"), Name, *Describe(Args[0])));
+        }
+
+        void Print(int32 NodeIndex, FStringBuilderBase& Out) const
+        {
+            const FNode& Node = Parser.Nodes[NodeIndex];
+
+            switch (Node.Kind)
+            {
+            case FNode::EKind::Constant:
+                Out.Appendf(TEXT("%.17g"), Node.Value);
+                break;
+            case FNode::EKind::Operand:
+                Out.Appendf(TEXT("$%d"), Node.Operand);
+                break;
+            case FNode::EKind::Negate:
+                Out.Append(TEXT("(-"));
+                Print(Node.Args[0], Out);
+                Out.AppendChar(')');
+                break;
+            case FNode::EKind::Binary:
+                Out.AppendChar('(');
+                Print(Node.Args[0], Out);
+                Out.AppendChar(Node.Operator);
+                Print(Node.Args[1], Out);
+                Out.AppendChar(')');
+                break;
+            case FNode::EKind::Call:
+                Out.Append(FunctionInfo[(int32)Node.Function].Name);
+                Out.AppendChar('(');
+                Print(Node.Args[0], Out);
+                if (Node.Args[1] != INDEX_NONE)
+                {
+                    Out.AppendChar(',');
+                    Print(Node.Args[1], Out);
+                }
+                Out.AppendChar(')');
+                break;
+            default:
+                break;
+            }
+        }
+    };
+
+
+    const TCHAR* ToString(EExpressionType Type)
+    {
+        return Type < EExpressionType::Invalid ? TypeInfo[(int32)Type].Name : TEXT("Invalid");
+    }
+
+
+    bool FExpression::GetOperandNames(const FString& Source, TArray<FString>& OperandNames, FString& ErrorMessage)
+    {
+        FParser Parser(Source, false);
+        int32 Root;
+        const bool bParsed = Parser.Parse(Root);
+
+        OperandNames = MoveTemp(Parser.Names);
+        ErrorMessage = MoveTemp(Parser.Error);
+        return bParsed;
+    }
+
+
+    TSharedPtr<FExpression> FExpression::Compile(const FString& Source, const TArray<EExpressionType>& OperandTypes, FString& ErrorMessage)
+    {
+        return FExpressionCompiler::Compile(Source, false, OperandTypes, ErrorMessage);
+    }
+
+
+    const FExpression* FExpression::FindOrCompileProgram(FName Program)
+    {
+        struct FProgramCache
+        {
+            FRWLock Lock;
+            TMap<FName, TSharedPtr<FExpression>> Programs;
+        };
+        static FProgramCache Cache;
+
+        {
+            FReadScopeLock ReadLock(Cache.Lock);
+            if (const TSharedPtr<FExpression>* Found = Cache.Programs.Find(Program))
+            {
+                return Found->Get();
+            }
+        }
+
+        // "Type,Type|body"
+        const FString ProgramString = Program.ToString();
+        FString Prefix, Body;
+        if (!ProgramString.Split(TEXT("|"), &Prefix, &Body))
+        {
+            Body = ProgramString;
+        }
+
+        TArray<FString> TypeNames;
+        Prefix.ParseIntoArray(TypeNames, TEXT(","));
+
+        TArray<EExpressionType> OperandTypes;
+        for (const FString& TypeName : TypeNames)
+        {
+            OperandTypes.Add(FindType(*TypeName));
+        }
+
+        // More operands than execexpression_K2 can hold never compile
+        FString ErrorMessage;
+        TSharedPtr<FExpression> Expression;
+        if (OperandTypes.Num() > MaxOperands)
+        {
+            ErrorMessage = FString::Printf(TEXT("More than %d operands"), MaxOperands);
+        }
+        else
+        {
+            Expression = FExpressionCompiler::Compile(Body, true, OperandTypes, ErrorMessage);
+        }
+        if (!Expression.IsValid())
+        {
+            UE_LOG(LogSpice, Error, TEXT("MaxQ expression program '%s' does not compile: %s"), *ProgramString, *ErrorMessage);
+
+            // Keep the operand count, so callers can still walk their arguments
+            Expression = MakeShared<FExpression>();
+            Expression->OperandTypes = OperandTypes;
+        }
+
+        FWriteScopeLock WriteLock(Cache.Lock);
+        // Another thread may have got here first, in which case use theirs
+        return Cache.Programs.FindOrAdd(Program, Expression).Get();
+    }
+
+
+    void FExpression::Evaluate(const void* const* Operands, void* Result) const
+    {
+        if (!bIsValid) return;
+
+        double Stack[MaxStackDepth][SlotWidth];
+        int32 sp = 0;
+
+        for (const FInstruction& Instruction : Program)
+        {
+            const int32 n = Instruction.Width;
+
+            switch ((EOp)Instruction.Op)
+            {
+            case EOp::Load:
+                LoadOperand(Stack[sp++], OperandTypes[Instruction.Index], Operands[Instruction.Index]);
+                break;
+
+            case EOp::Constant:
+                Stack[sp++][0] = Constants[Instruction.Index];
+                break;
+
+            case EOp::Add:
+            {
+                double* a = Stack[sp - 2];
+                const double* b = Stack[sp - 1];
+                for (int32 i = 0; i < n; ++i) a[i] += b[i];
+                --sp;
+                break;
+            }
+
+            case EOp::Sub:
+            {
+                double* a = Stack[sp - 2];
+                const double* b = Stack[sp - 1];
+                for (int32 i = 0; i < n; ++i) a[i] -= b[i];
+                --sp;
+                break;
+            }
+
+            case EOp::Neg:
+            {
+                double* a = Stack[sp - 1];
+                for (int32 i = 0; i < n; ++i) a[i] = -a[i];
+                break;
+            }
+
+            case EOp::ScaleLeft:
+            {
+                const double s = Stack[sp - 2][0];
+                double* out = Stack[sp - 2];
+                const double* x = Stack[sp - 1];
+                for (int32 i = 0; i < n; ++i) out[i] = s * x[i];
+                --sp;
+                break;
+            }
+
+            case EOp::ScaleRight:
+            {
+                double* x = Stack[sp - 2];
+                const double s = Stack[sp - 1][0];
+                for (int32 i = 0; i < n; ++i) x[i] *= s;
+                --sp;
+                break;
+            }
+
+            case EOp::Divide:
+            {
+                double* x = Stack[sp - 2];
+                const double s = Stack[sp - 1][0];
+                for (int32 i = 0; i < n; ++i) x[i] /= s;
+                --sp;
+                break;
+            }
+
+            case EOp::Mxv:
+            {
+                double* m = Stack[sp - 2];
+                const double* v = Stack[sp - 1];
+                const double t[3]
+                {
+                    m[0] * v[0] + m[1] * v[1] + m[2] * v[2],
+                    m[3] * v[0] + m[4] * v[1] + m[5] * v[2],
+                    m[6] * v[0] + m[7] * v[1] + m[8] * v[2]
+                };
+                m[0] = t[0]; m[1] = t[1]; m[2] = t[2];
+                --sp;
+                break;
+            }
+
+            case EOp::Mtxv:
+            {
+                double* m = Stack[sp - 2];
+                const double* v = Stack[sp - 1];
+                const double t[3]
+                {
+                    m[0] * v[0] + m[3] * v[1] + m[6] * v[2],
+                    m[1] * v[0] + m[4] * v[1] + m[7] * v[2],
+                    m[2] * v[0] + m[5] * v[1] + m[8] * v[2]
+                };
+                m[0] = t[0]; m[1] = t[1]; m[2] = t[2];
+                --sp;
+                break;
+            }
+
+            case EOp::Mxm:
+            {
+                double* a = Stack[sp - 2];
+                const double* b = Stack[sp - 1];
+                double t[9];
+                for (int32 i = 0; i < 3; ++i)
+                {
+                    for (int32 j = 0; j < 3; ++j)
+                    {
+                        t[3 * i + j] = a[3 * i] * b[j] + a[3 * i + 1] * b[3 + j] + a[3 * i + 2] * b[6 + j];
+                    }
+                }
+                FMemory::Memcpy(a, t, sizeof(t));
+                --sp;
+                break;
+            }
+
+            case EOp::Txs:
+            {
+                double* m = Stack[sp - 2];
+                const double* v = Stack[sp - 1];
+                double t[6];
+                for (int32 i = 0; i < 6; ++i)
+                {
+                    const double* Row = m + 6 * i;
+                    t[i] = Row[0] * v[0] + Row[1] * v[1] + Row[2] * v[2] + Row[3] * v[3] + Row[4] * v[4] + Row[5] * v[5];
+                }
+                FMemory::Memcpy(m, t, sizeof(t));
+                --sp;
+                break;
+            }
+
+            case EOp::Txt:
+            {
+                double* a = Stack[sp - 2];
+                const double* b = Stack[sp - 1];
+                double t[36];
+                for (int32 i = 0; i < 6; ++i)
+                {
+                    for (int32 j = 0; j < 6; ++j)
+                    {
+                        double Sum = 0.;
+                        for (int32 k = 0; k < 6; ++k) Sum += a[6 * i + k] * b[6 * k + j];
+                        t[6 * i + j] = Sum;
+                    }
+                }
+                FMemory::Memcpy(a, t, sizeof(t));
+                --sp;
+                break;
+            }
+
+            case EOp::Vhat:
+                // vhat_c returns the zero vector for a zero input, like unorm_c
+                vhat_c(Stack[sp - 1], Stack[sp - 1]);
+                break;
+
+            case EOp::Vnorm:
+                Stack[sp - 1][0] = vnorm_c(Stack[sp - 1]);
+                break;
+
+            case EOp::Vdot:
+                Stack[sp - 2][0] = vdot_c(Stack[sp - 2], Stack[sp - 1]);
+                --sp;
+                break;
+
+            case EOp::Vcrss:
+                vcrss_c(Stack[sp - 2], Stack[sp - 1], Stack[sp - 2]);
+                --sp;
+                break;
+
+            case EOp::Vsep:
+                Stack[sp - 2][0] = vsep_c(Stack[sp - 2], Stack[sp - 1]);
+                --sp;
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        StoreResult(Stack[0], ResultType, Result);
+    }
+}
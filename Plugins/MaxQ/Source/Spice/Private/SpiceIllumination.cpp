@@ -0,0 +1,248 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceIllumination.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Batch illumination angles & shadowing over a body's surface
+//
+// Geometry is gathered for every ET up front (two spkpos_c calls each), then
+// the angle pass runs over (ET, block of points) work items in one
+// ParallelFor, so short point lists still spread over many ETs.  Shadow rays
+// are cast an ET at a time, only for points facing the source.
+//
+// Angles are taken as atan2(|a x b|, a . b), which is accurate across the
+// whole range, as vsep_c is.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceIllumination.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceIllumination.h"
+#include "Async/ParallelFor.h"
+#include "SpiceCore.h"
+#include "SpiceDsk.h"
+#include "SpiceDskMesh.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using MaxQ::Core::ToANSIString;
+
+    constexpr int32 PointsPerTask = 4096;
+
+    // Shadow rays start this far above the surface, relative to the model's size
+    constexpr double ShadowBias = 1e-6;
+
+    // Target center to observer, and to illumination source, body-fixed
+    struct FEpochGeometry
+    {
+        FVector3d Observer;
+        FVector3d Source;
+    };
+
+    double Angle(const FVector3d& A, const FVector3d& B)
+    {
+        return FMath::Atan2((A ^ B).Size(), A | B);
+    }
+}
+
+
+namespace MaxQ::Illumination
+{
+    FSurfacePoints FSurfacePoints::EllipsoidGrid(const FSDistanceVector& Radii, int32 Width, int32 Height)
+    {
+        const FVector3d InvRadii2(1. / (Radii.x.km * Radii.x.km), 1. / (Radii.y.km * Radii.y.km), 1. / (Radii.z.km * Radii.z.km));
+
+        FSurfacePoints Grid;
+        Grid.Points.SetNumUninitialized(FMath::Max(0, Width * Height));
+        Grid.Normals.SetNumUninitialized(Grid.Points.Num());
+
+        for (int32 Row = 0; Row < Height; ++Row)
+        {
+            const double Lat = UE_DOUBLE_HALF_PI - (Row + 0.5) * UE_DOUBLE_PI / Height;
+            for (int32 Column = 0; Column < Width; ++Column)
+            {
+                const double Lon = -UE_DOUBLE_PI + (Column + 0.5) * UE_DOUBLE_TWO_PI / Width;
+                const FVector3d Direction(FMath::Cos(Lat) * FMath::Cos(Lon), FMath::Cos(Lat) * FMath::Sin(Lon), FMath::Sin(Lat));
+
+                // On the ellipsoid, along Direction; the normal is the gradient
+                const FVector3d Point = Direction / FMath::Sqrt((Direction * Direction) | InvRadii2);
+                const int32 i = Row * Width + Column;
+                Grid.Points[i] = Point;
+                Grid.Normals[i] = (Point * InvRadii2).GetSafeNormal();
+            }
+        }
+
+        return Grid;
+    }
+
+
+    FSurfacePoints FSurfacePoints::FromShapeMesh(const MaxQ::Dsk::FShapeMesh& Mesh, int32 Lod)
+    {
+        FSurfacePoints Vertices;
+        for (const MaxQ::Dsk::FMeshTile& Tile : Mesh.Tiles)
+        {
+            const MaxQ::Dsk::FMeshLod& Data = Tile.Lods[FMath::Clamp(Lod, 0, Tile.Lods.Num() - 1)];
+            for (int32 v = 0; v < Data.Positions.Num(); ++v)
+            {
+                Vertices.Points.Add(Tile.Origin + FVector3d(Data.Positions[v]));
+                Vertices.Normals.Add(FVector3d(Data.Normals[v]));
+            }
+        }
+        return Vertices;
+    }
+
+
+    SPICE_API void Bake(
+        TArray<FVector4f>& Texels,
+        const FSurfacePoints& Points,
+        const TArray<FSEphemerisTime>& Ets,
+        const FName& target,
+        const FName& fixref,
+        const FName& obsrvr,
+        const FName& ilusrc,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const MaxQ::Dsk::FPlateModel* Shadows,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Illumination::Bake, target, obsrvr, fixref);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        Texels.Reset();
+        if (Points.Normals.Num() != Points.Num())
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("%d surface points but %d normals"), Points.Num(), Points.Normals.Num());
+            return;
+        }
+
+        // Shared geometry, once per ET
+        const ANSICHAR* _abcorr = ToANSIString(abcorr);
+        const bool bTransmission = _abcorr[0] == 'X';
+        const bool bCorrected = abcorr != ES_AberrationCorrectionWithTransmissions::None;
+
+        TArray<FEpochGeometry> Geometry;
+        Geometry.SetNumUninitialized(Ets.Num());
+        for (int32 e = 0; e < Ets.Num() && !failed_c(); ++e)
+        {
+            SpiceDouble _trgpos[3], _srcpos[3], _lt = 0.;
+
+            // As illumf_c, the target as seen by the observer, so fixref is
+            // evaluated at the target's epoch.  (Observer relative to target
+            // would evaluate it at et, off by the rotation over the light
+            // time.)
+            spkpos_c(ToANSIString(target), Ets[e].AsSpiceDouble(), ToANSIString(fixref), _abcorr, ToANSIString(obsrvr), _trgpos, &_lt);
+
+            // The target's epoch, as seen by (or sending to) the observer.
+            // spkpos_c returns the light time even when it isn't applied.
+            SpiceDouble _trgepc = Ets[e].AsSpiceDouble();
+            if (bCorrected)
+            {
+                _trgepc += bTransmission ? _lt : -_lt;
+            }
+            spkpos_c(ToANSIString(ilusrc), _trgepc, ToANSIString(fixref), _abcorr, ToANSIString(target), _srcpos, &_lt);
+
+            Geometry[e].Observer = -FVector3d(_trgpos[0], _trgpos[1], _trgpos[2]);
+            Geometry[e].Source = FVector3d(_srcpos[0], _srcpos[1], _srcpos[2]);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return;
+        }
+
+        const int32 NumPoints = Points.Num();
+        Texels.SetNumUninitialized(Ets.Num() * NumPoints);
+
+        // Every point at every ET
+        const int32 BlocksPerEt = FMath::DivideAndRoundUp(NumPoints, PointsPerTask);
+        ParallelFor(Ets.Num() * BlocksPerEt, [&](int32 Task)
+        {
+            const int32 e = Task / BlocksPerEt;
+            const int32 Begin = (Task % BlocksPerEt) * PointsPerTask;
+            const int32 End = FMath::Min(NumPoints, Begin + PointsPerTask);
+            const FEpochGeometry& Epoch = Geometry[e];
+            FVector4f* Out = Texels.GetData() + e * NumPoints;
+
+            for (int32 p = Begin; p < End; ++p)
+            {
+                const FVector3d& Normal = Points.Normals[p];
+                const FVector3d ToSource = Epoch.Source - Points.Points[p];
+                const FVector3d ToObserver = Epoch.Observer - Points.Points[p];
+
+                const double Incidence = Angle(Normal, ToSource);
+                const double Emission = Angle(Normal, ToObserver);
+                const double Phase = Angle(ToSource, ToObserver);
+                Out[p] = FVector4f((float)Incidence, (float)Emission, (float)Phase, Incidence < UE_DOUBLE_HALF_PI ? 1.f : 0.f);
+            }
+        });
+
+        if (!Shadows || NumPoints == 0)
+        {
+            return;
+        }
+
+        // Cast shadows, toward the source from points facing it
+        const double Bias = ShadowBias * FMath::Max(Shadows->GetBounds().GetExtent().GetMax(), UE_DOUBLE_SMALL_NUMBER);
+
+        TArray<int32> Facing;
+        TArray<FSRay> Rays;
+        TArray<FSDistanceVector> Hits;
+        TArray<bool> Found;
+
+        for (int32 e = 0; e < Ets.Num(); ++e)
+        {
+            FVector4f* Out = Texels.GetData() + e * NumPoints;
+
+            Facing.Reset();
+            Rays.Reset();
+            for (int32 p = 0; p < NumPoints; ++p)
+            {
+                if (Out[p].W > 0.f)
+                {
+                    const FVector3d Origin = Points.Points[p] + Bias * Points.Normals[p];
+                    const FVector3d Direction = Geometry[e].Source - Origin;
+
+                    FSRay& Ray = Rays.AddDefaulted_GetRef();
+                    Ray.point = FSDistanceVector(Origin.X, Origin.Y, Origin.Z);
+                    Ray.direction = FSDimensionlessVector(Direction.X, Direction.Y, Direction.Z);
+                    Facing.Add(p);
+                }
+            }
+
+            Shadows->Intersect(Rays, Hits, Found);
+
+            for (int32 i = 0; i < Facing.Num(); ++i)
+            {
+                if (Found[i])
+                {
+                    Out[Facing[i]].W = 0.f;
+                }
+            }
+        }
+    }
+}
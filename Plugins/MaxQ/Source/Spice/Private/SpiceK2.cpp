@@ -24,6 +24,7 @@
 #include "Spice.h"
 #include "SpiceUtilities.h"
 #include "SpiceMath.h"
+#include "SpiceLog.h"
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 extern "C"
@@ -35,6 +36,54 @@ PRAGMA_POP_PLATFORM_DEFAULT_PACKING
 using namespace MaxQ;
 using namespace MaxQ::Private;
 
+namespace
+{
+    // Element-wise binary op over two arrays.  A single-element operand is
+    // broadcast across the other; otherwise the lengths must match, and a
+    // mismatch (a wiring mistake) is logged & yields an empty array.
+    template<typename ValueType, typename OpType>
+    TArray<ValueType> ElementWise(const TCHAR* Name, const TArray<ValueType>& v1, const TArray<ValueType>& v2, OpType Op)
+    {
+        TArray<ValueType> Result;
+
+        const int32 n1 = v1.Num();
+        const int32 n2 = v2.Num();
+
+        if (n1 == 0 || n2 == 0) return Result;
+
+        if (n1 != n2 && n1 != 1 && n2 != 1)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ %s: arrays of %d and %d elements, the lengths must match"), Name, n1, n2);
+            PrintScriptCallstack();
+            return Result;
+        }
+
+        const int32 n = (n1 == 1) ? n2 : n1;
+        const int32 stride1 = (n1 == 1) ? 0 : 1;
+        const int32 stride2 = (n2 == 1) ? 0 : 1;
+
+        Result.Reserve(n);
+        for (int32 i = 0; i < n; ++i)
+        {
+            Result.Add(Op(v1[i * stride1], v2[i * stride2]));
+        }
+
+        return Result;
+    }
+
+    template<typename OutType, typename InType, typename OpType>
+    TArray<OutType> ConvertArray(const TArray<InType>& value, OpType Op)
+    {
+        TArray<OutType> Result;
+        Result.Reserve(value.Num());
+        for (const InType& Element : value)
+        {
+            Result.Add(Op(Element));
+        }
+        return Result;
+    }
+}
+
 double USpiceK2::bodvrd_double_K2(
     ES_ResultCode& ResultCode,
     FString& ErrorMessage,
@@ -191,6 +240,16 @@ FSDimensionlessStateVector USpiceK2::mxv_state_vector_K2(const FSStateTransform&
     return MaxQ::Math::MxV(m, v);
 }
 
+TArray<FSDimensionlessVector> USpiceK2::mxv_vector_array_K2(const FSRotationMatrix& m, const TArray<FSDimensionlessVector>& v)
+{
+    return ConvertArray<FSDimensionlessVector>(v, [&m](const FSDimensionlessVector& vin) { return MaxQ::Math::MxV(m, vin); });
+}
+
+TArray<FSDimensionlessStateVector> USpiceK2::mxv_state_vector_array_K2(const FSStateTransform& m, const TArray<FSDimensionlessStateVector>& v)
+{
+    return ConvertArray<FSDimensionlessStateVector>(v, [&m](const FSDimensionlessStateVector& vin) { return MaxQ::Math::MxV(m, vin); });
+}
+
 FSDimensionlessVector USpiceK2::qderiv_vector_K2(const FSDimensionlessVector& f0, const FSDimensionlessVector& f2, double delta)
 {
     return MaxQ::Math::Qderiv<FSDimensionlessVector, FSDimensionlessVector>(f0, f2, delta);
@@ -216,6 +275,16 @@ void USpiceK2::unorm_vector_K2(const FSDimensionlessVector& v1, FSDimensionlessV
     MaxQ::Math::Unorm(vout, vmag, v1);
 }
 
+void USpiceK2::unorm_vector_array_K2(const TArray<FSDimensionlessVector>& v, TArray<FSDimensionlessVector>& vout, TArray<double>& vmag)
+{
+    vout.SetNum(v.Num());
+    vmag.SetNum(v.Num());
+    for (int32 i = 0; i < v.Num(); ++i)
+    {
+        MaxQ::Math::Unorm(vout[i], vmag[i], v[i]);
+    }
+}
+
 FSDimensionlessVector USpiceK2::vadd_vector_K2(const FSDimensionlessVector& v1, const FSDimensionlessVector& v2)
 {
     return MaxQ::Math::Vadd(v1, v2);
@@ -226,6 +295,16 @@ FSDimensionlessStateVector USpiceK2::vadd_state_vector_K2(const FSDimensionlessS
     return MaxQ::Math::Vadd(v1, v2);
 }
 
+TArray<FSDimensionlessVector> USpiceK2::vadd_vector_array_K2(const TArray<FSDimensionlessVector>& v1, const TArray<FSDimensionlessVector>& v2)
+{
+    return ElementWise(TEXT("vadd"), v1, v2, [](const FSDimensionlessVector& a, const FSDimensionlessVector& b) { return MaxQ::Math::Vadd(a, b); });
+}
+
+TArray<FSDimensionlessStateVector> USpiceK2::vadd_state_vector_array_K2(const TArray<FSDimensionlessStateVector>& v1, const TArray<FSDimensionlessStateVector>& v2)
+{
+    return ElementWise(TEXT("vadd"), v1, v2, [](const FSDimensionlessStateVector& a, const FSDimensionlessStateVector& b) { return MaxQ::Math::Vadd(a, b); });
+}
+
 FSDimensionlessVector USpiceK2::vcrss_vector_K2(const FSDimensionlessVector& v1, const FSDimensionlessVector& v2)
 {
     return MaxQ::Math::Vcrss(v1, v2);
@@ -357,6 +436,16 @@ FSDimensionlessStateVector USpiceK2::vsub_state_vector_K2(const FSDimensionlessS
     return MaxQ::Math::Vsub(v1, v2);
 }
 
+TArray<FSDimensionlessVector> USpiceK2::vsub_vector_array_K2(const TArray<FSDimensionlessVector>& v1, const TArray<FSDimensionlessVector>& v2)
+{
+    return ElementWise(TEXT("vsub"), v1, v2, [](const FSDimensionlessVector& a, const FSDimensionlessVector& b) { return MaxQ::Math::Vsub(a, b); });
+}
+
+TArray<FSDimensionlessStateVector> USpiceK2::vsub_state_vector_array_K2(const TArray<FSDimensionlessStateVector>& v1, const TArray<FSDimensionlessStateVector>& v2)
+{
+    return ElementWise(TEXT("vsub"), v1, v2, [](const FSDimensionlessStateVector& a, const FSDimensionlessStateVector& b) { return MaxQ::Math::Vsub(a, b); });
+}
+
 void USpiceK2::vupack_vector_K2(const FSDimensionlessVector& v, double& x, double& y, double& z)
 {
     // Trivial, so not implemented by MaxQ::Math
@@ -564,3 +653,109 @@ FSDistance USpiceK2::Conv_SDimensionlessVector_Z_ToSDistance_K2(const FSDimensio
     return value.z;
 }
 
+TArray<FSDistanceVector> USpiceK2::Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2(const TArray<FSDimensionlessVector>& value)
+{
+    return ConvertArray<FSDistanceVector>(value, [](const FSDimensionlessVector& v) { return FSDistanceVector(v); });
+}
+
+TArray<FSVelocityVector> USpiceK2::Conv_SDimensionlessVectorArrayToSVelocityVectorArray_K2(const TArray<FSDimensionlessVector>& value)
+{
+    return ConvertArray<FSVelocityVector>(value, [](const FSDimensionlessVector& v) { return FSVelocityVector(v); });
+}
+
+TArray<FSAngularVelocity> USpiceK2::Conv_SDimensionlessVectorArrayToSAngularVelocityArray_K2(const TArray<FSDimensionlessVector>& value)
+{
+    return ConvertArray<FSAngularVelocity>(value, [](const FSDimensionlessVector& v) { return FSAngularVelocity(v); });
+}
+
+TArray<FSDimensionlessVector> USpiceK2::Conv_SDistanceVectorArrayToSDimensionlessVectorArray_K2(const TArray<FSDistanceVector>& value)
+{
+    return ConvertArray<FSDimensionlessVector>(value, [](const FSDistanceVector& v) { return v.AsDimensionlessVector(); });
+}
+
+TArray<FSDimensionlessVector> USpiceK2::Conv_SVelocityVectorArrayToSDimensionlessVectorArray_K2(const TArray<FSVelocityVector>& value)
+{
+    return ConvertArray<FSDimensionlessVector>(value, [](const FSVelocityVector& v) { return v.AsDimensionlessVector(); });
+}
+
+TArray<FSDimensionlessVector> USpiceK2::Conv_SAngularVelocityArrayToSDimensionlessVectorArray_K2(const TArray<FSAngularVelocity>& value)
+{
+    return ConvertArray<FSDimensionlessVector>(value, [](const FSAngularVelocity& v) { return v.AsDimensionlessVector(); });
+}
+
+TArray<FSStateVector> USpiceK2::Conv_SDimensionlessStateVectorArrayToSStateVectorArray_K2(const TArray<FSDimensionlessStateVector>& value)
+{
+    return ConvertArray<FSStateVector>(value, [](const FSDimensionlessStateVector& v) { return FSStateVector(v); });
+}
+
+TArray<FSDimensionlessStateVector> USpiceK2::Conv_SStateVectorArrayToSDimensionlessStateVectorArray_K2(const TArray<FSStateVector>& value)
+{
+    return ConvertArray<FSDimensionlessStateVector>(value, [](const FSStateVector& v) { return v.AsDimensionlessVector(); });
+}
+
+TArray<FSDistance> USpiceK2::Conv_DoubleArrayToSDistanceArray_K2(const TArray<double>& value)
+{
+    return ConvertArray<FSDistance>(value, [](double v) { return FSDistance(v); });
+}
+
+TArray<FSSpeed> USpiceK2::Conv_DoubleArrayToSSpeedArray_K2(const TArray<double>& value)
+{
+    return ConvertArray<FSSpeed>(value, [](double v) { return FSSpeed(v); });
+}
+
+TArray<FSAngularRate> USpiceK2::Conv_DoubleArrayToSAngularRateArray_K2(const TArray<double>& value)
+{
+    return ConvertArray<FSAngularRate>(value, [](double v) { return FSAngularRate(v); });
+}
+
+bool USpiceK2::expression_K2(FName Program)
+{
+    // Only ever called through execexpression_K2
+    check(0);
+    return false;
+}
+
+DEFINE_FUNCTION(USpiceK2::execexpression_K2)
+{
+    P_GET_PROPERTY(FNameProperty, Program);
+
+    const MaxQ::Math::FExpression* Expression = MaxQ::Math::FExpression::FindOrCompileProgram(Program);
+
+    // Operands are read where they are, the result is written where it is.
+    // Every operand pin is stepped over, so the result is the result even
+    // if there are too many (the program doesn't compile then).
+    const void* Operands[MaxQ::Math::FExpression::MaxOperands];
+    const int32 NumOperands = Expression ? Expression->NumOperands() : 0;
+    for (int32 i = 0; i < NumOperands; ++i)
+    {
+        Stack.MostRecentProperty = nullptr;
+        Stack.MostRecentPropertyAddress = nullptr;
+        Stack.StepCompiledIn<FProperty>(nullptr);
+        if (i < MaxQ::Math::FExpression::MaxOperands)
+        {
+            Operands[i] = Stack.MostRecentPropertyAddress;
+        }
+    }
+
+    Stack.MostRecentProperty = nullptr;
+    Stack.MostRecentPropertyAddress = nullptr;
+    Stack.StepCompiledIn<FProperty>(nullptr);
+    void* Result = Stack.MostRecentPropertyAddress;
+
+    P_FINISH;
+
+    bool bValid = Expression && Expression->IsValid() && NumOperands <= MaxQ::Math::FExpression::MaxOperands && Result != nullptr;
+    for (int32 i = 0; bValid && i < NumOperands; ++i)
+    {
+        bValid = Operands[i] != nullptr;
+    }
+
+    if (bValid)
+    {
+        P_NATIVE_BEGIN;
+        Expression->Evaluate(Operands, Result);
+        P_NATIVE_END;
+    }
+
+    *(bool*)RESULT_PARAM = bValid;
+}
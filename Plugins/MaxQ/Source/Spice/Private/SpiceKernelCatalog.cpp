@@ -0,0 +1,454 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelCatalog.cpp
+//
+// Implementation Comments
+//
+// Purpose:  What kernels a directory holds, and what order to load them in
+//
+// One catalog per process (KnownFiles), by absolute path, guarded by a
+// critical section.  It holds files that aren't kernels too (empty FileType),
+// so they aren't read again either.  A scan stats every file, takes the
+// unchanged ones from the catalog, inspects the rest in parallel outside the
+// lock, then updates the catalog, forgets files that have disappeared from
+// the directory, and rewrites the cache file if anything changed.  A cache
+// file is read into the catalog the first time a scan uses it; entries
+// already in the catalog are newer, and win.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelCatalog.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelCatalog.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SpiceKernelInspector.h"
+#include "SpiceUtilities.h"
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Catalog;
+
+    constexpr uint32 CacheMagic = 0x4B43514D;  // "MQCK"
+
+    // Bump when the format changes, or the inspector's results do
+    constexpr int32 CacheVersion = 2;
+
+    // Load order.  Types not listed go after EK, meta-kernels after those.
+    // Untyped text kernels (no KPL/ line) go with the other text kernels.
+    const TCHAR* const LoadOrderTypes[] = {
+        TEXT("LSK"), TEXT("PCK"), TEXT("FK"), TEXT("SCLK"), TEXT("IK"), TEXT("TEXT"), TEXT("SPK"), TEXT("CK"), TEXT("DSK"), TEXT("EK")
+    };
+
+    FCriticalSection CatalogLock;
+    TMap<FString, FCatalogEntry> KnownFiles;      // By absolute path
+    TSet<FString> CacheFilesRead;
+
+
+    FString CacheFilePath(const FCatalogSettings& Settings)
+    {
+        return Settings.CacheFile.IsEmpty()
+            ? FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MaxQ"), TEXT("KernelCatalog.bin")))
+            : toPath(Settings.CacheFile);
+    }
+
+
+    // Kernels, or files that look like kernels but couldn't be decoded
+    bool IsCataloged(const FCatalogEntry& Entry)
+    {
+        return !Entry.FileType.IsEmpty() || !Entry.Error.IsEmpty();
+    }
+
+
+    void Serialize(FArchive& Ar, FCatalogEntry& Entry)
+    {
+        Ar << Entry.Path << Entry.FileType << Entry.bBinary << Entry.FileSize << Entry.Timestamp << Entry.ContentHash << Entry.Error;
+
+        int32 NumCoverage = Entry.Coverage.Num();
+        Ar << NumCoverage;
+        if (Ar.IsLoading())
+        {
+            if (NumCoverage < 0 || NumCoverage > Ar.TotalSize() - Ar.Tell())
+            {
+                Ar.SetError();
+                return;
+            }
+            Entry.Coverage.SetNum(NumCoverage);
+        }
+
+        for (FCoverage& Coverage : Entry.Coverage)
+        {
+            int32 NumWindows = Coverage.Windows.Num();
+            Ar << Coverage.Id << NumWindows;
+            if (Ar.IsLoading())
+            {
+                if (NumWindows < 0 || NumWindows > Ar.TotalSize() - Ar.Tell())
+                {
+                    Ar.SetError();
+                    return;
+                }
+                Coverage.Windows.SetNum(NumWindows);
+            }
+
+            for (FSWindowSegment& Window : Coverage.Windows)
+            {
+                Ar << Window.start << Window.stop;
+            }
+        }
+    }
+
+
+    // Caller holds CatalogLock
+    void ReadCacheFile(const FString& CacheFile)
+    {
+        bool bAlreadyRead = false;
+        CacheFilesRead.Add(CacheFile, &bAlreadyRead);
+        if (bAlreadyRead)
+        {
+            return;
+        }
+
+        TArray<uint8> Data;
+        if (!FFileHelper::LoadFileToArray(Data, *CacheFile, FILEREAD_Silent))
+        {
+            return;
+        }
+
+        FMemoryReader Reader(Data);
+        uint32 Magic = 0;
+        int32 Version = 0;
+        int32 NumEntries = 0;
+        Reader << Magic << Version << NumEntries;
+        if (Reader.IsError() || Magic != CacheMagic || Version != CacheVersion || NumEntries < 0)
+        {
+            UE_LOG(LogSpice, Log, TEXT("MaxQ Kernel Catalog: ignoring %s, it's from another version"), *CacheFile);
+            return;
+        }
+
+        TArray<FCatalogEntry> Entries;
+        Entries.SetNum(FMath::Min(NumEntries, Data.Num()));
+        for (FCatalogEntry& Entry : Entries)
+        {
+            Serialize(Reader, Entry);
+            if (Reader.IsError())
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ Kernel Catalog: ignoring %s, it's damaged"), *CacheFile);
+                return;
+            }
+        }
+
+        for (FCatalogEntry& Entry : Entries)
+        {
+            if (!KnownFiles.Contains(Entry.Path))
+            {
+                FString Path = Entry.Path;
+                KnownFiles.Add(MoveTemp(Path), MoveTemp(Entry));
+            }
+        }
+    }
+
+
+    // Caller holds CatalogLock
+    void WriteCacheFile(const FString& CacheFile)
+    {
+        TArray<uint8> Data;
+        FMemoryWriter Writer(Data);
+
+        uint32 Magic = CacheMagic;
+        int32 Version = CacheVersion;
+        int32 NumEntries = KnownFiles.Num();
+        Writer << Magic << Version << NumEntries;
+        for (TPair<FString, FCatalogEntry>& Pair : KnownFiles)
+        {
+            Serialize(Writer, Pair.Value);
+        }
+
+        // Replace the old file only once the new one is complete
+        const FString TempFile = CacheFile + TEXT(".tmp");
+        if (!FFileHelper::SaveArrayToFile(Data, *TempFile) || !IFileManager::Get().Move(*CacheFile, *TempFile, true, true))
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ Kernel Catalog: could not write %s"), *CacheFile);
+        }
+    }
+
+
+    TArray<FString> FindFiles(const FString& Directory, bool bRecursive)
+    {
+        TArray<FString> Files;
+        if (bRecursive)
+        {
+            IFileManager::Get().FindFilesRecursive(Files, *Directory, TEXT("*"), true, false);
+        }
+        else
+        {
+            IFileManager::Get().FindFiles(Files, *FPaths::Combine(Directory, TEXT("*")), true, false);
+            for (FString& File : Files)
+            {
+                File = FPaths::Combine(Directory, File);
+            }
+        }
+        return Files;
+    }
+
+
+    // From a fresh inspection.  Path, size & time are the scan's, from before
+    // the file was read.
+    void Fill(FCatalogEntry& Entry, const MaxQ::Inspector::FKernelSummary& Summary, ES_ResultCode ResultCode, const FString& ErrorMessage)
+    {
+        using namespace MaxQ::Inspector;
+
+        Entry.FileType = Summary.FileType;
+        Entry.bBinary = Summary.Architecture == EKernelArchitecture::DAF || Summary.Architecture == EKernelArchitecture::DAS;
+        Entry.ContentHash = Summary.ContentHash;
+        Entry.Coverage.Empty();
+        Entry.Error.Empty();
+        Entry.bFromCache = false;
+
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            if (!Summary.IdWord.IsEmpty())
+            {
+                Entry.Error = ErrorMessage;
+            }
+            return;
+        }
+
+        for (int32 Id : GetIds(Summary))
+        {
+            Entry.Coverage.Add({ Id, GetCoverage(Summary, Id) });
+        }
+    }
+}
+
+
+namespace MaxQ::Catalog
+{
+    SPICE_API int32 LoadRank(const FString& FileType)
+    {
+        constexpr int32 NumTypes = UE_ARRAY_COUNT(LoadOrderTypes);
+        for (int32 i = 0; i < NumTypes; ++i)
+        {
+            if (FileType == LoadOrderTypes[i])
+            {
+                return i;
+            }
+        }
+        return FileType == TEXT("MK") ? NumTypes + 1 : NumTypes;
+    }
+
+
+    SPICE_API bool Scan(
+        const FString& relativeDirectory,
+        TArray<FCatalogEntry>& Entries,
+        const FCatalogSettings& Settings,
+        FCatalogStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        // Not MakeErrorGutter, its statics are shared with other threads
+        ES_ResultCode LocalResultCode;
+        FString LocalErrorMessage;
+        FCatalogStats LocalStats;
+        if (!ResultCode) ResultCode = &LocalResultCode;
+        if (!ErrorMessage) ErrorMessage = &LocalErrorMessage;
+        if (!Stats) Stats = &LocalStats;
+
+        const double StartSeconds = FPlatformTime::Seconds();
+        *Stats = FCatalogStats();
+        Entries.Empty();
+
+        FString Directory = toPath(relativeDirectory);
+        FPaths::NormalizeDirectoryName(Directory);
+        if (!FPaths::DirectoryExists(Directory))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("Directory %s does not exist (MaxQ expanded the path to %s)"), *relativeDirectory, *Directory);
+            return false;
+        }
+
+        const FString CacheFile = CacheFilePath(Settings);
+        const TArray<FString> Files = FindFiles(Directory, Settings.bRecursive);
+
+        TArray<FCatalogEntry> Found;
+        Found.SetNum(Files.Num());
+        ParallelFor(Files.Num(), [&](int32 i)
+        {
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*Files[i]);
+            Found[i].Path = Files[i];
+            Found[i].FileSize = Stat.FileSize;
+            Found[i].Timestamp = Stat.ModificationTime;
+        });
+
+        // Unchanged files come from the catalog
+        TArray<bool> bUnchanged;
+        bUnchanged.SetNumZeroed(Files.Num());
+        {
+            FScopeLock Lock(&CatalogLock);
+            if (Settings.bPersistent)
+            {
+                ReadCacheFile(CacheFile);
+            }
+
+            for (int32 i = 0; i < Files.Num(); ++i)
+            {
+                const FCatalogEntry* Cached = KnownFiles.Find(Files[i]);
+                if (Cached && Cached->FileSize == Found[i].FileSize && Cached->Timestamp == Found[i].Timestamp)
+                {
+                    Found[i] = *Cached;
+                    bUnchanged[i] = true;
+                }
+            }
+        }
+
+        // The rest are read, unless bVerifyHashes reads them all
+        ParallelFor(Files.Num(), [&](int32 i)
+        {
+            if (bUnchanged[i] && !Settings.bVerifyHashes)
+            {
+                return;
+            }
+
+            MaxQ::Inspector::FInspectSettings InspectSettings;
+            InspectSettings.bComments = false;
+            InspectSettings.bContentHash = true;
+
+            MaxQ::Inspector::FKernelSummary Summary;
+            ES_ResultCode InspectResultCode;
+            FString InspectErrorMessage;
+            MaxQ::Inspector::InspectKernel(Files[i], Summary, InspectSettings, &InspectResultCode, &InspectErrorMessage);
+
+            if (bUnchanged[i] && Summary.ContentHash == Found[i].ContentHash)
+            {
+                return;
+            }
+
+            bUnchanged[i] = false;
+            Fill(Found[i], Summary, InspectResultCode, InspectErrorMessage);
+        });
+
+        bool bChanged = false;
+        {
+            FScopeLock Lock(&CatalogLock);
+
+            TSet<FString> FileSet;
+            FileSet.Reserve(Files.Num());
+            for (int32 i = 0; i < Files.Num(); ++i)
+            {
+                FileSet.Add(Files[i]);
+                if (!bUnchanged[i])
+                {
+                    KnownFiles.Add(Files[i], Found[i]);
+                    bChanged = true;
+                }
+            }
+
+            // Forget files that were in this directory, but aren't any more
+            const FString Prefix = Directory + TEXT("/");
+            for (auto It = KnownFiles.CreateIterator(); It; ++It)
+            {
+                const FString& Path = It.Key();
+                if (Path.StartsWith(Prefix) && !FileSet.Contains(Path) && (Settings.bRecursive || !Path.RightChop(Prefix.Len()).Contains(TEXT("/"))))
+                {
+                    It.RemoveCurrent();
+                    bChanged = true;
+                }
+            }
+
+            if (bChanged && Settings.bPersistent)
+            {
+                WriteCacheFile(CacheFile);
+            }
+        }
+
+        Stats->Files = Files.Num();
+        for (int32 i = 0; i < Files.Num(); ++i)
+        {
+            if (bUnchanged[i])
+            {
+                ++Stats->CacheHits;
+            }
+            else
+            {
+                ++Stats->Validated;
+            }
+
+            if (IsCataloged(Found[i]))
+            {
+                ++Stats->Kernels;
+                Stats->Failures += Found[i].IsValid() ? 0 : 1;
+                Found[i].bFromCache = bUnchanged[i];
+                Entries.Add(MoveTemp(Found[i]));
+            }
+        }
+
+        Entries.Sort([](const FCatalogEntry& a, const FCatalogEntry& b)
+        {
+            const int32 RankA = LoadRank(a.FileType);
+            const int32 RankB = LoadRank(b.FileType);
+            return RankA != RankB ? RankA < RankB : a.Path < b.Path;
+        });
+
+        Stats->Seconds = FPlatformTime::Seconds() - StartSeconds;
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API TArray<FString> LoadOrder(const TArray<FCatalogEntry>& Entries)
+    {
+        TArray<const FCatalogEntry*> Valid;
+        for (const FCatalogEntry& Entry : Entries)
+        {
+            if (Entry.IsValid())
+            {
+                Valid.Add(&Entry);
+            }
+        }
+
+        // Stable, Entries may be in load order already, with ties in an order
+        // the caller chose
+        Valid.StableSort([](const FCatalogEntry& a, const FCatalogEntry& b) { return LoadRank(a.FileType) < LoadRank(b.FileType); });
+
+        TArray<FString> Paths;
+        Paths.Reserve(Valid.Num());
+        for (const FCatalogEntry* Entry : Valid)
+        {
+            Paths.Add(Entry->Path);
+        }
+        return Paths;
+    }
+
+
+    SPICE_API void ClearCache(const FCatalogSettings& Settings, bool bDeleteFile)
+    {
+        FScopeLock Lock(&CatalogLock);
+
+        KnownFiles.Empty();
+        CacheFilesRead.Empty();
+
+        if (bDeleteFile)
+        {
+            IFileManager::Get().Delete(*CacheFilePath(Settings), false, false, true);
+        }
+    }
+}
@@ -0,0 +1,1030 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelInspector.cpp
+//
+// Implementation Comments
+//
+// Purpose:  What's in a kernel file, without loading it
+//
+// The layouts are SPICE's (DAF, DAS and DLA Required Reading):
+// * DAF:  1024 byte records.  The file record, comment records up to FWARD,
+//   then a doubly linked list of summary records, each followed by its name
+//   record.  Addresses are 1-based double precision words.
+// * DAS:  1024 byte records.  The file record, reserved & comment records,
+//   then directory records, each followed by the data records it describes.
+//   The char/dp/int logical address spaces map to clusters of records, see
+//   dasa2l.  DSK segments are DLA segments:  a linked list of 8-integer
+//   descriptors, whose d.p. component begins with the 24-double DSK
+//   descriptor.
+//
+// Nothing here is shared:  every file is mapped, decoded and released by the
+// calling thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelInspector.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelInspector.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/xxhash.h"
+#include "Misc/ByteSwap.h"
+#include "Misc/FileHelper.h"
+#include "SpiceUtilities.h"
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Inspector;
+
+    constexpr int64 RecordBytes = 1024;
+
+    // DAF file record
+    constexpr int64 DafNDOffset = 8;
+    constexpr int64 DafNIOffset = 12;
+    constexpr int64 DafIfnameOffset = 16;
+    constexpr int32 DafIfnameLength = 60;
+    constexpr int64 DafFwardOffset = 76;
+    constexpr int64 DafFormatOffset = 88;
+    constexpr int32 DafCommentCharsPerRecord = 1000;
+    constexpr int32 DafMaxSummaryDoubles = 125;
+
+    // DAS file record
+    constexpr int64 DasIfnameOffset = 8;
+    constexpr int32 DasIfnameLength = 60;
+    constexpr int64 DasNresvrOffset = 68;
+    constexpr int64 DasNcomrOffset = 76;
+    constexpr int64 DasNcomcOffset = 80;
+    constexpr int64 DasFormatOffset = 84;
+
+    // DAS data types, as in directory records
+    enum EDasType : int32 { DasChar = 1, DasDouble = 2, DasInt = 3 };
+    constexpr int32 DasWordsPerRecord[] = { 0, 1024, 128, 256 };
+    constexpr int32 DasBytesPerWord[] = { 0, 1, 8, 4 };
+
+    // DAS directory records:  pointers, address ranges, then the first
+    // cluster's type & size and the signed sizes of the rest
+    constexpr int32 DasDirectoryForward = 1;
+    constexpr int32 DasDirectoryFirstType = 8;
+    constexpr int32 DasDirectoryWords = 256;
+
+    // DLA (SpiceDLA.h)
+    constexpr int64 DlaFirstSegmentAddress = 2;
+    constexpr int32 DlaDescriptorSize = 8;
+    constexpr int32 DlaForward = 1;
+    constexpr int32 DlaDoubleBase = 4;
+
+    // DSK descriptor (SpiceDSK.h)
+    constexpr int32 DskDescriptorSize = 24;
+    constexpr int32 DskSurface = 0;
+    constexpr int32 DskCenter = 1;
+    constexpr int32 DskType = 3;
+    constexpr int32 DskFrame = 4;
+    constexpr int32 DskBegin = 22;
+    constexpr int32 DskEnd = 23;
+
+    const ANSICHAR FtpString[] = "FTPSTR:\r:\n:\r\n:\r\0:\x81:\x10\xce:ENDFTP";
+    constexpr int32 FtpStringLength = sizeof(FtpString) - 1;
+
+    // The file's bytes, memory-mapped if the platform can, otherwise read
+    class FKernelBytes
+    {
+    public:
+        bool Open(const FString& Path, FString& Error)
+        {
+            IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+            Size = PlatformFile.FileSize(*Path);
+            if (Size < 0)
+            {
+                Error = TEXT("file not found");
+                return false;
+            }
+            if (Size == 0)
+            {
+                return true;
+            }
+
+            MappedFile.Reset(PlatformFile.OpenMapped(*Path));
+            if (MappedFile.IsValid())
+            {
+                MappedRegion.Reset(MappedFile->MapRegion(0, Size));
+                if (MappedRegion.IsValid())
+                {
+                    Data = MappedRegion->GetMappedPtr();
+                    Size = MappedRegion->GetMappedSize();
+                    return true;
+                }
+            }
+
+            if (!FFileHelper::LoadFileToArray(Loaded, *Path))
+            {
+                Error = TEXT("file could not be read");
+                return false;
+            }
+            Data = Loaded.GetData();
+            Size = Loaded.Num();
+            return true;
+        }
+
+        const uint8* Data = nullptr;
+        int64 Size = 0;
+
+    private:
+        // Region before handle, it's released first
+        TUniquePtr<IMappedFileHandle> MappedFile;
+        TUniquePtr<IMappedFileRegion> MappedRegion;
+        TArray64<uint8> Loaded;
+    };
+
+    struct FReader
+    {
+        const uint8* Data = nullptr;
+        int64 Size = 0;
+        bool bSwap = false;
+
+        bool Has(int64 Offset, int64 Bytes) const
+        {
+            return Offset >= 0 && Bytes >= 0 && Offset + Bytes <= Size;
+        }
+
+        int32 Int(int64 Offset) const
+        {
+            uint32 Value;
+            FMemory::Memcpy(&Value, Data + Offset, sizeof(Value));
+            return (int32)(bSwap ? BYTESWAP_ORDER32(Value) : Value);
+        }
+
+        double Double(int64 Offset) const
+        {
+            uint64 Bits;
+            FMemory::Memcpy(&Bits, Data + Offset, sizeof(Bits));
+            if (bSwap)
+            {
+                Bits = BYTESWAP_ORDER64(Bits);
+            }
+            double Value;
+            FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+            return Value;
+        }
+
+        // Blank- or null-padded Fortran string
+        FString Chars(int64 Offset, int32 Count) const
+        {
+            const ANSICHAR* Start = (const ANSICHAR*)(Data + Offset);
+            int32 Length = 0;
+            while (Length < Count && Start[Length] != '\0')
+            {
+                ++Length;
+            }
+            FString Result(Length, Start);
+            Result.TrimEndInline();
+            return Result;
+        }
+
+        bool Matches(int64 Offset, const ANSICHAR* Text, int32 Count) const
+        {
+            return Has(Offset, Count) && !FMemory::Memcmp(Data + Offset, Text, Count);
+        }
+
+        static int64 RecordOffset(int64 Record)
+        {
+            return (Record - 1) * RecordBytes;
+        }
+
+        int64 Records() const
+        {
+            return Size / RecordBytes;
+        }
+    };
+
+    bool IsBigEndianHost()
+    {
+        return !PLATFORM_LITTLE_ENDIAN;
+    }
+
+    // "LTL-IEEE" / "BIG-IEEE".  Old files leave it blank, in native order.
+    bool SetByteOrder(FReader& File, const FString& Format, FString& Error)
+    {
+        if (Format.IsEmpty())
+        {
+            File.bSwap = false;
+        }
+        else if (Format == TEXT("LTL-IEEE"))
+        {
+            File.bSwap = IsBigEndianHost();
+        }
+        else if (Format == TEXT("BIG-IEEE"))
+        {
+            File.bSwap = !IsBigEndianHost();
+        }
+        else
+        {
+            Error = FString::Printf(TEXT("unsupported binary format '%s'"), *Format);
+            return false;
+        }
+        return true;
+    }
+
+    void CheckFtpString(const FReader& File, FKernelSummary& Summary)
+    {
+        const int64 Limit = FMath::Min<int64>(RecordBytes, File.Size) - 7;
+        for (int64 Offset = 0; Offset < Limit; ++Offset)
+        {
+            if (File.Matches(Offset, FtpString, 7))
+            {
+                Summary.bFtpValid = File.Matches(Offset, FtpString, FtpStringLength);
+                return;
+            }
+        }
+    }
+
+    // Comment characters:  '\0' ends a line, EOT ends the comments
+    void AppendComments(const FReader& File, int64 Offset, int64 Count, TArray<ANSICHAR>& Buffer)
+    {
+        for (int64 i = 0; i < Count; ++i)
+        {
+            const ANSICHAR c = (ANSICHAR)File.Data[Offset + i];
+            if (c == '\x04')
+            {
+                break;
+            }
+            Buffer.Add(c == '\0' ? '\n' : c);
+        }
+    }
+
+    FString CommentString(TArray<ANSICHAR>& Buffer)
+    {
+        FString Comments(Buffer.Num(), Buffer.GetData());
+        Comments.TrimEndInline();
+        return Comments;
+    }
+
+    bool InspectDaf(const FReader& File, const FInspectSettings& Settings, FKernelSummary& Summary, FString& Error)
+    {
+        const int32 ND = File.Int(DafNDOffset);
+        const int32 NI = File.Int(DafNIOffset);
+        const int32 SS = ND + (NI + 1) / 2;
+        if (ND < 0 || NI < 2 || SS > DafMaxSummaryDoubles - 3)
+        {
+            Error = FString::Printf(TEXT("invalid summary format ND=%d NI=%d"), ND, NI);
+            return false;
+        }
+        Summary.ND = ND;
+        Summary.NI = NI;
+        Summary.InternalName = File.Chars(DafIfnameOffset, DafIfnameLength);
+
+        const int32 Forward = File.Int(DafFwardOffset);
+        const int64 Records = File.Records();
+        if (Forward < 2 || Forward > Records)
+        {
+            Error = FString::Printf(TEXT("first summary record %d is outside the file (%lld records)"), Forward, Records);
+            return false;
+        }
+
+        if (Settings.bComments)
+        {
+            TArray<ANSICHAR> Buffer;
+            for (int32 Record = 2; Record < Forward; ++Record)
+            {
+                const int32 Before = Buffer.Num();
+                AppendComments(File, FReader::RecordOffset(Record), DafCommentCharsPerRecord, Buffer);
+                if (Buffer.Num() - Before < DafCommentCharsPerRecord)
+                {
+                    break;
+                }
+            }
+            Summary.Comments = CommentString(Buffer);
+        }
+
+        // Pre-N0044 NAIF/DAF files are SPK or CK, which share a summary
+        // format.  Like getfat, guess from the first summary:  CK integers
+        // are instrument, frame, type 1-6, angular velocity flag 0/1.
+        if (Summary.FileType == TEXT("DAF") && ND == 2 && NI == 6)
+        {
+            const int64 First = FReader::RecordOffset(Forward) + 8 * (3 + ND);
+            const bool bCkLike = File.Has(First, 16)
+                && (int32)File.Double(FReader::RecordOffset(Forward) + 16) > 0
+                && File.Int(First) <= -1000
+                && File.Int(First + 8) >= 1 && File.Int(First + 8) <= 6
+                && (File.Int(First + 12) == 0 || File.Int(First + 12) == 1);
+            Summary.FileType = bCkLike ? TEXT("CK") : TEXT("SPK");
+        }
+
+        if (!Settings.bSegments)
+        {
+            return true;
+        }
+
+        const bool bSpk = Summary.FileType == TEXT("SPK") && ND == 2 && NI == 6;
+        const bool bCk = Summary.FileType == TEXT("CK") && ND == 2 && NI == 6;
+        const bool bPck = Summary.FileType == TEXT("PCK") && ND == 2 && NI == 5;
+        const int32 NameLength = 8 * SS;
+
+        int32 Record = Forward;
+        for (int64 Visited = 0; Record > 0; ++Visited)
+        {
+            // Name records follow summary records
+            if (Record >= Records || Visited >= Records)
+            {
+                Error = FString::Printf(TEXT("summary record %d is outside the file, or the summary list loops"), Record);
+                return false;
+            }
+
+            const int64 Base = FReader::RecordOffset(Record);
+            const int32 Next = (int32)File.Double(Base);
+            const int32 Count = (int32)File.Double(Base + 16);
+            if (Count < 0 || 3 + Count * SS > DafMaxSummaryDoubles)
+            {
+                Error = FString::Printf(TEXT("summary record %d holds %d summaries"), Record, Count);
+                return false;
+            }
+
+            for (int32 i = 0; i < Count; ++i)
+            {
+                if (Summary.Segments.Num() >= Settings.MaxSegments)
+                {
+                    Error = FString::Printf(TEXT("more than %d segments"), Settings.MaxSegments);
+                    return false;
+                }
+
+                const int64 Offset = Base + 8 * (3 + i * SS);
+                FSegmentSummary& Segment = Summary.Segments.AddDefaulted_GetRef();
+                Segment.Name = File.Chars(Base + RecordBytes + i * NameLength, NameLength);
+
+                Segment.Doubles.SetNumUninitialized(ND);
+                for (int32 d = 0; d < ND; ++d)
+                {
+                    Segment.Doubles[d] = File.Double(Offset + 8 * d);
+                }
+                // Integers are packed into the doubles that follow, in the
+                // file's byte order
+                Segment.Integers.SetNumUninitialized(NI);
+                for (int32 n = 0; n < NI; ++n)
+                {
+                    Segment.Integers[n] = File.Int(Offset + 8 * ND + 4 * n);
+                }
+
+                const TArray<double>& D = Segment.Doubles;
+                const TArray<int32>& I = Segment.Integers;
+                if (ND >= 2)
+                {
+                    Segment.Begin = D[0];
+                    Segment.End = D[1];
+                }
+                Segment.BeginAddress = I[NI - 2];
+                Segment.EndAddress = I[NI - 1];
+
+                if (bSpk)
+                {
+                    Segment.Id = I[0];
+                    Segment.Center = I[1];
+                    Segment.Frame = I[2];
+                    Segment.DataType = I[3];
+                }
+                else if (bCk)
+                {
+                    Segment.Id = I[0];
+                    Segment.Frame = I[1];
+                    Segment.DataType = I[2];
+                    Segment.bAngularVelocity = I[3] != 0;
+                }
+                else if (bPck)
+                {
+                    Segment.Id = I[0];
+                    Segment.Frame = I[1];
+                    Segment.DataType = I[2];
+                }
+            }
+
+            Record = Next;
+        }
+
+        return true;
+    }
+
+    // Maps DAS logical addresses to file offsets
+    class FDasAddressMap
+    {
+    public:
+        bool Build(const FReader& File, int32 FirstDirectory, FString& Error)
+        {
+            const int64 Records = File.Records();
+            int32 Directory = FirstDirectory;
+            for (int64 Visited = 0; Directory > 0; ++Visited)
+            {
+                if (Directory > Records || Visited >= Records)
+                {
+                    Error = FString::Printf(TEXT("directory record %d is outside the file, or the directory list loops"), Directory);
+                    return false;
+                }
+
+                const int64 Base = FReader::RecordOffset(Directory);
+                auto Word = [&](int32 i) { return File.Int(Base + 4 * i); };
+
+                int32 Type = Word(DasDirectoryFirstType);
+                int32 Record = Directory + 1;
+                for (int32 i = DasDirectoryFirstType + 1; i < DasDirectoryWords && Word(i) != 0; ++i)
+                {
+                    const int32 Descriptor = Word(i);
+
+                    // After the first, a cluster's type is the next (+) or
+                    // previous (-) of its predecessor's:  char, dp, int, char...
+                    if (i > DasDirectoryFirstType + 1)
+                    {
+                        Type = Descriptor > 0 ? Type % 3 + 1 : (Type + 1) % 3 + 1;
+                    }
+                    if (Type < DasChar || Type > DasInt)
+                    {
+                        Error = FString::Printf(TEXT("directory record %d has an invalid data type %d"), Directory, Type);
+                        return false;
+                    }
+
+                    const int32 Count = FMath::Abs(Descriptor);
+                    Clusters[Type].Add({ Record, Count });
+                    Record += Count;
+                }
+
+                Directory = Word(DasDirectoryForward);
+            }
+            return true;
+        }
+
+        bool Locate(const FReader& File, int32 Type, int64 Address, int64& Offset) const
+        {
+            const int64 WordsPerRecord = DasWordsPerRecord[Type];
+            int64 Word = Address - 1;
+            if (Word < 0)
+            {
+                return false;
+            }
+
+            for (const FCluster& Cluster : Clusters[Type])
+            {
+                const int64 Words = Cluster.Records * WordsPerRecord;
+                if (Word < Words)
+                {
+                    Offset = FReader::RecordOffset(Cluster.Record + Word / WordsPerRecord) + (Word % WordsPerRecord) * DasBytesPerWord[Type];
+                    return File.Has(Offset, DasBytesPerWord[Type]);
+                }
+                Word -= Words;
+            }
+            return false;
+        }
+
+    private:
+        struct FCluster
+        {
+            int32 Record;
+            int32 Records;
+        };
+
+        TArray<FCluster> Clusters[4];
+    };
+
+    bool InspectDsk(const FReader& File, int32 FirstDirectory, const FInspectSettings& Settings, FKernelSummary& Summary, FString& Error)
+    {
+        FDasAddressMap Map;
+        if (!Map.Build(File, FirstDirectory, Error))
+        {
+            return false;
+        }
+
+        auto ReadInt = [&](int64 Address, int32& Value)
+        {
+            int64 Offset;
+            if (!Map.Locate(File, DasInt, Address, Offset)) return false;
+            Value = File.Int(Offset);
+            return true;
+        };
+
+        auto ReadDouble = [&](int64 Address, double& Value)
+        {
+            int64 Offset;
+            if (!Map.Locate(File, DasDouble, Address, Offset)) return false;
+            Value = File.Double(Offset);
+            return true;
+        };
+
+        // -1 if there are no segments
+        int32 Descriptor = -1;
+        if (!ReadInt(DlaFirstSegmentAddress, Descriptor))
+        {
+            Error = TEXT("DLA segment list is unreadable");
+            return false;
+        }
+
+        while (Descriptor != -1)
+        {
+            if (Summary.Segments.Num() >= Settings.MaxSegments)
+            {
+                Error = FString::Printf(TEXT("more than %d segments, or the segment list loops"), Settings.MaxSegments);
+                return false;
+            }
+
+            FSegmentSummary& Segment = Summary.Segments.AddDefaulted_GetRef();
+            Segment.Integers.SetNumUninitialized(DlaDescriptorSize);
+            for (int32 i = 0; i < DlaDescriptorSize; ++i)
+            {
+                if (!ReadInt(Descriptor + i, Segment.Integers[i]))
+                {
+                    Error = FString::Printf(TEXT("DLA descriptor at %d is outside the file"), Descriptor);
+                    return false;
+                }
+            }
+
+            Segment.Doubles.SetNumUninitialized(DskDescriptorSize);
+            const int32 DoubleBase = Segment.Integers[DlaDoubleBase];
+            for (int32 i = 0; i < DskDescriptorSize; ++i)
+            {
+                if (!ReadDouble(DoubleBase + 1 + i, Segment.Doubles[i]))
+                {
+                    Error = FString::Printf(TEXT("DSK descriptor at %d is outside the file"), DoubleBase + 1);
+                    return false;
+                }
+            }
+
+            const TArray<double>& D = Segment.Doubles;
+            Segment.Surface = (int32)D[DskSurface];
+            Segment.Id = (int32)D[DskCenter];
+            Segment.DataType = (int32)D[DskType];
+            Segment.Frame = (int32)D[DskFrame];
+            Segment.Begin = D[DskBegin];
+            Segment.End = D[DskEnd];
+
+            Descriptor = Segment.Integers[DlaForward];
+        }
+
+        return true;
+    }
+
+    bool InspectDas(const FReader& File, const FInspectSettings& Settings, FKernelSummary& Summary, FString& Error)
+    {
+        Summary.InternalName = File.Chars(DasIfnameOffset, DasIfnameLength);
+
+        const int32 ReservedRecords = File.Int(DasNresvrOffset);
+        const int32 CommentRecords = File.Int(DasNcomrOffset);
+        const int32 CommentChars = File.Int(DasNcomcOffset);
+        const int64 Records = File.Records();
+        if (ReservedRecords < 0 || CommentRecords < 0 || CommentChars < 0 || CommentChars > CommentRecords * RecordBytes || 1 + ReservedRecords + CommentRecords > Records)
+        {
+            Error = FString::Printf(TEXT("invalid file record (%d reserved records, %d comment records, %d comment characters)"), ReservedRecords, CommentRecords, CommentChars);
+            return false;
+        }
+
+        const int32 FirstComment = 2 + ReservedRecords;
+        if (Settings.bComments)
+        {
+            TArray<ANSICHAR> Buffer;
+            AppendComments(File, FReader::RecordOffset(FirstComment), CommentChars, Buffer);
+            Summary.Comments = CommentString(Buffer);
+        }
+
+        // DSK is the only DAS kernel with segments that are summarized
+        // alike.  EK segments aren't decoded.
+        if (Settings.bSegments && Summary.FileType == TEXT("DSK"))
+        {
+            return InspectDsk(File, FirstComment + CommentRecords, Settings, Summary, Error);
+        }
+        return true;
+    }
+
+    // True if a line starts (after blanks) with \begindata or \begintext.
+    // False at the first null:  that's not a text file.
+    bool HasTextMarker(const FReader& File)
+    {
+        bool bLineStart = true;
+        for (int64 Offset = 0; Offset < File.Size; ++Offset)
+        {
+            const uint8 Char = File.Data[Offset];
+            if (Char == '\0')
+            {
+                return false;
+            }
+            if (Char == '\n' || Char == '\r')
+            {
+                bLineStart = true;
+            }
+            else if (bLineStart && Char == '\\')
+            {
+                if (File.Matches(Offset, "\\begindata", 10) || File.Matches(Offset, "\\begintext", 10))
+                {
+                    return true;
+                }
+                bLineStart = false;
+            }
+            else if (Char != ' ' && Char != '\t')
+            {
+                bLineStart = false;
+            }
+        }
+        return false;
+    }
+
+    // KPL/<type>, possibly after blank lines.  Without one (older kernels
+    // don't always have it), a \begindata or \begintext line makes it an
+    // untyped text kernel, "TEXT".
+    bool InspectText(const FReader& File, FKernelSummary& Summary)
+    {
+        int64 Offset = 0;
+        while (Offset < File.Size && FChar::IsWhitespace((TCHAR)File.Data[Offset]))
+        {
+            ++Offset;
+        }
+        if (!File.Matches(Offset, "KPL/", 4))
+        {
+            if (!HasTextMarker(File))
+            {
+                return false;
+            }
+            Summary.Architecture = EKernelArchitecture::Text;
+            Summary.FileType = TEXT("TEXT");
+            return true;
+        }
+
+        int64 End = Offset + 4;
+        while (End < File.Size && End - Offset < 16 && !FChar::IsWhitespace((TCHAR)File.Data[End]))
+        {
+            ++End;
+        }
+
+        Summary.Architecture = EKernelArchitecture::Text;
+        Summary.IdWord = File.Chars(Offset, (int32)(End - Offset));
+        Summary.FileType = Summary.IdWord.Mid(4);
+        if (Summary.FileType == TEXT("FRAMES"))
+        {
+            Summary.FileType = TEXT("FK");
+        }
+        return true;
+    }
+
+    // False if it's not a kernel at all
+    bool IsKernel(const FReader& File)
+    {
+        return File.Matches(0, "DAF/", 4) || File.Matches(0, "DAS/", 4) || File.Matches(0, "NAIF/DAF", 8) || File.Matches(0, "NAIF/DAS", 8);
+    }
+
+    // Inspects Path, which is absolute.  False with an empty Error if it's
+    // not a kernel.
+    bool Inspect(const FString& Path, const FInspectSettings& Settings, FKernelSummary& Summary, FString& Error)
+    {
+        Summary = FKernelSummary();
+        Summary.Path = Path;
+
+        FKernelBytes Bytes;
+        if (!Bytes.Open(Path, Error))
+        {
+            return false;
+        }
+        Summary.FileSize = Bytes.Size;
+
+        FReader File;
+        File.Data = Bytes.Data;
+        File.Size = Bytes.Size;
+
+        const bool bBinary = IsKernel(File);
+        if (!bBinary && !InspectText(File, Summary))
+        {
+            return false;
+        }
+
+        if (Settings.bContentHash)
+        {
+            Summary.ContentHash = FXxHash64::HashBuffer(Bytes.Data, Bytes.Size).Hash;
+        }
+
+        if (!bBinary)
+        {
+            return true;
+        }
+
+        const FString IdWord = File.Chars(0, 8);
+        FString Architecture, Type;
+        if (!IdWord.Split(TEXT("/"), &Architecture, &Type))
+        {
+            Architecture = IdWord;
+        }
+        Summary.IdWord = IdWord;
+
+        if (File.Size < RecordBytes)
+        {
+            Error = TEXT("file is shorter than its file record");
+            return false;
+        }
+
+        CheckFtpString(File, Summary);
+
+        // Pre-N0044 NAIF/DAF & NAIF/DAS files don't say what they hold
+        if (Architecture == TEXT("NAIF"))
+        {
+            Architecture = Type;
+            Type.Empty();
+        }
+
+        if (Architecture == TEXT("DAF"))
+        {
+            Summary.Architecture = EKernelArchitecture::DAF;
+            Summary.FileType = Type.IsEmpty() ? Architecture : Type;
+            Summary.BinaryFormat = File.Chars(DafFormatOffset, 8);
+            return SetByteOrder(File, Summary.BinaryFormat, Error) && InspectDaf(File, Settings, Summary, Error);
+        }
+
+        Summary.Architecture = EKernelArchitecture::DAS;
+        Summary.FileType = Type.IsEmpty() ? Architecture : Type;
+        Summary.BinaryFormat = File.Chars(DasFormatOffset, 8);
+        return SetByteOrder(File, Summary.BinaryFormat, Error) && InspectDas(File, Settings, Summary, Error);
+    }
+
+    const TCHAR* IdLabel(const FKernelSummary& Summary)
+    {
+        if (Summary.FileType == TEXT("CK")) return TEXT("instrument");
+        if (Summary.FileType == TEXT("PCK")) return TEXT("frame");
+        if (Summary.FileType == TEXT("DSK")) return TEXT("body");
+        return TEXT("object");
+    }
+
+    FString FormatTime(const FKernelSummary& Summary, double Time)
+    {
+        return Summary.FileType == TEXT("CK") ? FString::Printf(TEXT("%.3f (SCLK ticks)"), Time) : FormatTdb(Time);
+    }
+}
+
+
+namespace MaxQ::Inspector
+{
+    SPICE_API void InspectKernel(
+        const FString& Path,
+        FKernelSummary& Summary,
+        const FInspectSettings& Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        // Not MakeErrorGutter, its statics are shared with other threads
+        ES_ResultCode LocalResultCode;
+        FString LocalErrorMessage;
+        if (!ResultCode) ResultCode = &LocalResultCode;
+        if (!ErrorMessage) ErrorMessage = &LocalErrorMessage;
+
+        const FString FullPath = toPath(Path);
+
+        FString Error;
+        if (Inspect(FullPath, Settings, Summary, Error))
+        {
+            *ResultCode = ES_ResultCode::Success;
+            ErrorMessage->Empty();
+        }
+        else
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("%s: %s"), *FullPath, Error.IsEmpty() ? TEXT("not a SPICE kernel") : *Error);
+        }
+    }
+
+
+    SPICE_API void InspectDirectory(
+        const FString& Directory,
+        TArray<FKernelSummary>& Summaries,
+        bool bRecursive,
+        const FInspectSettings& Settings,
+        TArray<FString>* Failures
+    )
+    {
+        const FString FullPath = toPath(Directory);
+
+        TArray<FString> Files;
+        if (bRecursive)
+        {
+            IFileManager::Get().FindFilesRecursive(Files, *FullPath, TEXT("*"), true, false);
+        }
+        else
+        {
+            IFileManager::Get().FindFiles(Files, *FPaths::Combine(FullPath, TEXT("*")), true, false);
+            for (FString& File : Files)
+            {
+                File = FPaths::Combine(FullPath, File);
+            }
+        }
+        Files.Sort();
+
+        TArray<FKernelSummary> Results;
+        TArray<FString> Errors;
+        TArray<bool> bValid;
+        Results.SetNum(Files.Num());
+        Errors.SetNum(Files.Num());
+        bValid.SetNumZeroed(Files.Num());
+
+        ParallelFor(Files.Num(), [&](int32 i)
+        {
+            bValid[i] = Inspect(Files[i], Settings, Results[i], Errors[i]);
+        });
+
+        Summaries.Empty(Files.Num());
+        for (int32 i = 0; i < Files.Num(); ++i)
+        {
+            if (bValid[i])
+            {
+                Summaries.Add(MoveTemp(Results[i]));
+            }
+            else if (Failures && !Errors[i].IsEmpty())
+            {
+                Failures->Add(FString::Printf(TEXT("%s: %s"), *Files[i], *Errors[i]));
+            }
+        }
+    }
+
+
+    SPICE_API TArray<int32> GetIds(const FKernelSummary& Summary)
+    {
+        TArray<int32> Ids;
+        for (const FSegmentSummary& Segment : Summary.Segments)
+        {
+            Ids.AddUnique(Segment.Id);
+        }
+        Ids.Sort();
+        return Ids;
+    }
+
+
+    SPICE_API TArray<FSWindowSegment> GetCoverage(const FKernelSummary& Summary, int32 Id)
+    {
+        TArray<FSWindowSegment> Intervals;
+        for (const FSegmentSummary& Segment : Summary.Segments)
+        {
+            if (Segment.Id == Id)
+            {
+                Intervals.Emplace(Segment.Begin, Segment.End);
+            }
+        }
+
+        Intervals.Sort([](const FSWindowSegment& a, const FSWindowSegment& b) { return a.start < b.start; });
+
+        TArray<FSWindowSegment> Window;
+        for (const FSWindowSegment& Interval : Intervals)
+        {
+            if (Window.Num() > 0 && Interval.start <= Window.Last().stop)
+            {
+                Window.Last().stop = FMath::Max(Window.Last().stop, Interval.stop);
+            }
+            else
+            {
+                Window.Add(Interval);
+            }
+        }
+        return Window;
+    }
+
+
+    SPICE_API FString FormatTdb(double et, int32 Decimals)
+    {
+        static const TCHAR* Months[] = { TEXT("JAN"), TEXT("FEB"), TEXT("MAR"), TEXT("APR"), TEXT("MAY"), TEXT("JUN"), TEXT("JUL"), TEXT("AUG"), TEXT("SEP"), TEXT("OCT"), TEXT("NOV"), TEXT("DEC") };
+
+        // Whole units of the last decimal place, truncated like timout_c's
+        Decimals = FMath::Clamp(Decimals, 0, 6);
+        int64 UnitsPerSecond = 1;
+        for (int32 i = 0; i < Decimals; ++i)
+        {
+            UnitsPerSecond *= 10;
+        }
+
+        // Julian day number 2451545 begins at 2000 JAN 01 00:00:00 TDB, 43200s before J2000
+        constexpr int64 J2000DayNumber = 2451545;
+        constexpr int64 Year1DayNumber = 1721426;           // 1 JAN 01
+        constexpr double MaxUnits = 4e18;
+
+        if (!FMath::IsFinite(et) || (FMath::Abs(et) + 43200.) * UnitsPerSecond > MaxUnits)
+        {
+            return FString::Printf(TEXT("%.*f (TDB seconds past J2000)"), Decimals, et);
+        }
+
+        // Whole seconds & the fraction separately, so scaling doesn't round
+        // the fraction up
+        const double WholeSeconds = FMath::FloorToDouble(et);
+        const int64 Units = ((int64)WholeSeconds + 43200) * UnitsPerSecond + (int64)FMath::FloorToDouble((et - WholeSeconds) * UnitsPerSecond);
+        const int64 UnitsPerDay = 86400 * UnitsPerSecond;
+        const int64 Day = Units >= 0 ? Units / UnitsPerDay : -((-Units + UnitsPerDay - 1) / UnitsPerDay);
+        int64 TimeOfDay = Units - Day * UnitsPerDay;
+
+        const int64 J = J2000DayNumber + Day;
+        if (J < Year1DayNumber)
+        {
+            return FString::Printf(TEXT("%.*f (TDB seconds past J2000)"), Decimals, et);
+        }
+
+        // Richards' Julian day number to Gregorian calendar conversion
+        const int64 f = J + 1401 + (((4 * J + 274277) / 146097) * 3) / 4 - 38;
+        const int64 e = 4 * f + 3;
+        const int64 g = (e % 1461) / 4;
+        const int64 h = 5 * g + 2;
+        const int32 DayOfMonth = (int32)((h % 153) / 5 + 1);
+        const int32 Month = (int32)((h / 153 + 2) % 12 + 1);
+        const int64 Year = e / 1461 - 4716 + (12 + 2 - Month) / 12;
+
+        const int64 Fraction = TimeOfDay % UnitsPerSecond;
+        TimeOfDay /= UnitsPerSecond;
+        const int32 Hour = (int32)(TimeOfDay / 3600);
+        const int32 Minute = (int32)(TimeOfDay / 60 % 60);
+        const int32 Second = (int32)(TimeOfDay % 60);
+
+        FString Result = FString::Printf(TEXT("%4lld %s %02d %02d:%02d:%02d"), Year, Months[Month - 1], DayOfMonth, Hour, Minute, Second);
+        if (Decimals > 0)
+        {
+            Result += FString::Printf(TEXT(".%0*lld"), Decimals, Fraction);
+        }
+        return Result + TEXT(" (TDB)");
+    }
+
+
+    SPICE_API FString FrameName(int32 FrameId)
+    {
+        // CSPICE's built-in inertial frames (chgirf), ids 1-21
+        static const TCHAR* InertialFrames[] = {
+            TEXT("J2000"), TEXT("B1950"), TEXT("FK4"), TEXT("DE-118"), TEXT("DE-96"), TEXT("DE-102"), TEXT("DE-108"),
+            TEXT("DE-111"), TEXT("DE-114"), TEXT("DE-122"), TEXT("DE-125"), TEXT("DE-130"), TEXT("GALACTIC"), TEXT("DE-200"),
+            TEXT("DE-202"), TEXT("MARSIAU"), TEXT("ECLIPJ2000"), TEXT("ECLIPB1950"), TEXT("DE-140"), TEXT("DE-142"), TEXT("DE-143")
+        };
+
+        if (FrameId >= 1 && FrameId <= (int32)UE_ARRAY_COUNT(InertialFrames))
+        {
+            return InertialFrames[FrameId - 1];
+        }
+        return FString::FromInt(FrameId);
+    }
+
+
+    SPICE_API FString Report(const FKernelSummary& Summary, bool bComments, bool bSegments)
+    {
+        FString Result;
+        Result += FString::Printf(TEXT("File:          %s (%lld bytes)\n"), *Summary.Path, Summary.FileSize);
+        Result += FString::Printf(TEXT("Type:          %s (%s%s%s)\n"), *Summary.FileType, *Summary.IdWord, Summary.BinaryFormat.IsEmpty() ? TEXT("") : TEXT(", "), *Summary.BinaryFormat);
+        if (!Summary.InternalName.IsEmpty())
+        {
+            Result += FString::Printf(TEXT("Internal name: %s\n"), *Summary.InternalName);
+        }
+        if (!Summary.bFtpValid)
+        {
+            Result += TEXT("FTP test string is damaged, the file was transferred as text\n");
+        }
+        if (Summary.Architecture == EKernelArchitecture::DAF)
+        {
+            Result += FString::Printf(TEXT("Summary format: ND=%d NI=%d\n"), Summary.ND, Summary.NI);
+        }
+        if (Summary.Architecture != EKernelArchitecture::Text)
+        {
+            Result += FString::Printf(TEXT("Segments:      %d\n"), Summary.Segments.Num());
+        }
+
+        if (bComments && !Summary.Comments.IsEmpty())
+        {
+            Result += TEXT("Comments:\n");
+            Result += Summary.Comments;
+            Result += TEXT("\n");
+        }
+
+        if (bSegments)
+        {
+            for (int32 i = 0; i < Summary.Segments.Num(); ++i)
+            {
+                const FSegmentSummary& Segment = Summary.Segments[i];
+                Result += FString::Printf(TEXT("Segment %d:  '%s' %s %d"), i, *Segment.Name, IdLabel(Summary), Segment.Id);
+                if (Summary.FileType == TEXT("SPK"))
+                {
+                    Result += FString::Printf(TEXT(" center %d"), Segment.Center);
+                }
+                if (Summary.FileType == TEXT("DSK"))
+                {
+                    Result += FString::Printf(TEXT(" surface %d"), Segment.Surface);
+                }
+                Result += FString::Printf(TEXT(" frame %s type %d%s\n"), *FrameName(Segment.Frame), Segment.DataType, Segment.bAngularVelocity ? TEXT(" with angular velocity") : TEXT(""));
+                Result += FString::Printf(TEXT("    %s - %s\n"), *FormatTime(Summary, Segment.Begin), *FormatTime(Summary, Segment.End));
+            }
+        }
+
+        for (int32 Id : GetIds(Summary))
+        {
+            Result += TEXT("========================================\n");
+            Result += FString::Printf(TEXT("Coverage for %s %d\n"), IdLabel(Summary), Id);
+
+            const TArray<FSWindowSegment> Window = GetCoverage(Summary, Id);
+            for (int32 i = 0; i < Window.Num(); ++i)
+            {
+                Result += FString::Printf(TEXT("Interval %d:  %s - %s\n"), i, *FormatTime(Summary, Window[i].start), *FormatTime(Summary, Window[i].stop));
+            }
+        }
+
+        return Result;
+    }
+}
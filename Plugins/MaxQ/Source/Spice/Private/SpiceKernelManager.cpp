@@ -0,0 +1,665 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelManager.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Load more binary kernels than CSPICE can hold open
+//
+// Registered kernels live in a sparse array (stable indices).  Per id, an
+// interval tree maps time to the kernels covering it; trees are rebuilt
+// lazily, the first time they're queried after a (un)registration.  Loaded
+// kernels are threaded onto an intrusive LRU list, most recently required at
+// the head.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelManager.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelManager.h"
+#include "HAL/IConsoleManager.h"
+#include "SpiceData.h"
+#include "SpiceSegments.h"
+#include "SpiceUtilities.h"
+
+#if PLATFORM_WINDOWS
+#include <stdio.h>
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <sys/resource.h>
+#endif
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+using MaxQ::KernelManager::EKernelKind;
+using MaxQ::KernelManager::FSettings;
+using MaxQ::KernelManager::FStats;
+using MaxQ::Segments::FIntervalTree;
+
+namespace
+{
+    // zzddhman's FTSIZE
+    constexpr int32 DafTableSize = 5000;
+
+    // Left for kernels loaded outside the manager, and the rest of the process
+    constexpr int32 DafHeadroom = 100;
+    constexpr int32 FileHeadroom = 128;
+
+    struct FManagedKernel
+    {
+        FString Path;
+        EKernelKind Kind = EKernelKind::SPK;
+        int64 Sequence = 0;
+        TArray<int32> Ids;
+        bool bLoaded = false;
+        bool bPrefetched = false;       // Loaded by a prefetch, not required since
+        int32 LruPrev = INDEX_NONE;     // More recent
+        int32 LruNext = INDEX_NONE;     // Less recent
+    };
+
+    struct FIdKernels
+    {
+        TArray<FIntervalTree::FEntry> Entries;  // Entry.Index => Kernels
+        FIntervalTree Tree;
+        bool bDirty = true;
+    };
+
+    FSettings Settings;
+    FStats Stats;
+    TSparseArray<FManagedKernel> Kernels;
+    TMap<FString, int32> KernelsByPath;
+    TMap<FKernelId, FIdKernels> IdKernels;
+    TMap<FKernelId, double> LastRequired;
+    int64 NextSequence = 1;
+    int32 LruHead = INDEX_NONE;
+    int32 LruTail = INDEX_NONE;
+    int32 LoadedCount = 0;
+
+    void LruUnlink(int32 i)
+    {
+        FManagedKernel& Kernel = Kernels[i];
+        if (Kernel.LruPrev != INDEX_NONE) Kernels[Kernel.LruPrev].LruNext = Kernel.LruNext; else LruHead = Kernel.LruNext;
+        if (Kernel.LruNext != INDEX_NONE) Kernels[Kernel.LruNext].LruPrev = Kernel.LruPrev; else LruTail = Kernel.LruPrev;
+        Kernel.LruPrev = Kernel.LruNext = INDEX_NONE;
+    }
+
+    void LruPushFront(int32 i)
+    {
+        FManagedKernel& Kernel = Kernels[i];
+        Kernel.LruPrev = INDEX_NONE;
+        Kernel.LruNext = LruHead;
+        if (LruHead != INDEX_NONE) Kernels[LruHead].LruPrev = i; else LruTail = i;
+        LruHead = i;
+    }
+
+    void LruTouch(int32 i)
+    {
+        if (LruHead != i)
+        {
+            LruUnlink(i);
+            LruPushFront(i);
+        }
+    }
+
+    int32 GetProcessFileLimit()
+    {
+#if PLATFORM_WINDOWS
+        // CSPICE opens files through the CRT
+        return _getmaxstdio();
+#elif PLATFORM_UNIX || PLATFORM_MAC
+        struct rlimit Limit;
+        if (getrlimit(RLIMIT_NOFILE, &Limit) == 0 && Limit.rlim_cur != RLIM_INFINITY)
+        {
+            return (int32)FMath::Min<rlim_t>(Limit.rlim_cur, MAX_int32);
+        }
+        return MAX_int32;
+#else
+        return 512;
+#endif
+    }
+
+    int32 GetBudget()
+    {
+        if (Settings.MaxLoadedKernels > 0)
+        {
+            return Settings.MaxLoadedKernels;
+        }
+
+        SpiceInt _count = 0;
+        ktotal_c("SPK CK PCK DSK EK", &_count);
+        const int32 Unmanaged = FMath::Max(0, (int32)_count - LoadedCount);
+
+        const int32 DafBudget = DafTableSize - DafHeadroom - Unmanaged;
+        const int32 FileBudget = GetProcessFileLimit() - FileHeadroom;
+        return FMath::Max(1, FMath::Min(DafBudget, FileBudget));
+    }
+
+    // Kernels covering the id at Time, in registration order
+    void FindKernels(const FKernelId& Key, double Time, TArray<int32>& Found)
+    {
+        Found.Reset();
+
+        FIdKernels* Id = IdKernels.Find(Key);
+        if (!Id)
+        {
+            return;
+        }
+
+        if (Id->bDirty)
+        {
+            Id->Tree = FIntervalTree(CopyTemp(Id->Entries));
+            Id->bDirty = false;
+        }
+
+        Id->Tree.FindAll(Time, Found);
+        Found.Sort([](int32 A, int32 B) { return Kernels[A].Sequence < Kernels[B].Sequence; });
+    }
+
+    bool ReadSummaries(const FString& File, EKernelKind Kind, TMap<int32, TArray<FSWindowSegment>>& Windows, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        auto _file = StringCast<ANSICHAR>(*File);
+
+        SpiceInt _handle = 0;
+        dafopr_c(_file.Get(), &_handle);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        const SpiceInt _nd = 2;
+        const SpiceInt _ni = Kind == EKernelKind::PCK ? 5 : 6;
+
+        dafbfs_c(_handle);
+        SpiceBoolean _found = SPICEFALSE;
+        daffna_c(&_found);
+
+        while (_found && !failed_c())
+        {
+            SpiceDouble _sum[5];
+            SpiceDouble _dc[2];
+            SpiceInt _ic[6];
+            dafgs_c(_sum);
+            dafus_c(_sum, _nd, _ni, _dc, _ic);
+            if (failed_c())
+            {
+                break;
+            }
+
+            Windows.FindOrAdd(_ic[0]).Emplace(_dc[0], _dc[1]);
+
+            daffna_c(&_found);
+        }
+
+        // Take (and reset) the error first:  dafcls_c doesn't run while
+        // failed_c() is set, which would leak the handle.
+        const bool bFailed = ErrorCheck(ResultCode, ErrorMessage);
+        dafcls_c(_handle);
+
+        if (bFailed)
+        {
+            ES_ResultCode IgnoredResultCode;
+            FString IgnoredErrorMessage;
+            ErrorCheck(IgnoredResultCode, IgnoredErrorMessage, true);
+            Windows.Reset();
+            return false;
+        }
+
+        // One window per overlapping run of segments
+        for (auto& [Id, IdWindows] : Windows)
+        {
+            IdWindows.Sort([](const FSWindowSegment& A, const FSWindowSegment& B) { return A.start < B.start; });
+
+            TArray<FSWindowSegment> Merged;
+            for (const FSWindowSegment& Window : IdWindows)
+            {
+                if (Merged.Num() > 0 && Window.start <= Merged.Last().stop)
+                {
+                    Merged.Last().stop = FMath::Max(Merged.Last().stop, Window.stop);
+                }
+                else
+                {
+                    Merged.Add(Window);
+                }
+            }
+            IdWindows = MoveTemp(Merged);
+        }
+
+        return !failed_c();
+    }
+
+    void Unload(int32 i)
+    {
+        FManagedKernel& Kernel = Kernels[i];
+        unload_c(TCHAR_TO_ANSI(*Kernel.Path));
+        UnexpectedErrorCheck();
+
+        Kernel.bLoaded = false;
+        Kernel.bPrefetched = false;
+        LruUnlink(i);
+        --LoadedCount;
+        OnKernelsChanged();
+    }
+
+    // Evicts least recently required kernels, other than those in Keep, until
+    // there's room for one more
+    void MakeRoom(const TArray<int32>& Keep)
+    {
+        const int32 Budget = GetBudget();
+
+        int32 Victim = LruTail;
+        while (LoadedCount >= Budget && Victim != INDEX_NONE)
+        {
+            const int32 Previous = Kernels[Victim].LruPrev;
+            if (!Keep.Contains(Victim))
+            {
+                Unload(Victim);
+                ++Stats.Evictions;
+            }
+            Victim = Previous;
+        }
+
+        if (LoadedCount >= Budget)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ kernel manager needs more than %d kernels loaded at once"), Budget);
+        }
+    }
+
+    // Loaded managed kernels registered after the kernels just loaded, with an
+    // id in common, are reloaded so they take precedence again
+    void RestorePrecedence(const TArray<int32>& JustLoaded)
+    {
+        TArray<int32> Reload;
+        for (int32 i : JustLoaded)
+        {
+            const FManagedKernel& Loaded = Kernels[i];
+            for (int32 Id : Loaded.Ids)
+            {
+                for (const FIntervalTree::FEntry& Entry : IdKernels[FKernelId { Loaded.Kind, Id }].Entries)
+                {
+                    const FManagedKernel& Other = Kernels[Entry.Index];
+                    if (Other.bLoaded && Other.Sequence > Loaded.Sequence && !JustLoaded.Contains(Entry.Index))
+                    {
+                        Reload.AddUnique(Entry.Index);
+                    }
+                }
+            }
+        }
+
+        Reload.Sort([](int32 A, int32 B) { return Kernels[A].Sequence < Kernels[B].Sequence; });
+        for (int32 i : Reload)
+        {
+            // furnsh_c of a loaded file unloads it, then loads it last
+            furnsh_c(TCHAR_TO_ANSI(*Kernels[i].Path));
+            UnexpectedErrorCheck();
+            ++Stats.Reloads;
+        }
+    }
+
+    // Loads whichever of Wanted aren't loaded, keeping Keep loaded
+    int32 Load(const TArray<int32>& Wanted, const TArray<int32>& Keep, bool bPrefetch, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        FDeferKernelsChanged DeferKernelsChanged;
+
+        TArray<int32> JustLoaded;
+        for (int32 i : Wanted)
+        {
+            if (Kernels[i].bLoaded)
+            {
+                continue;
+            }
+
+            MakeRoom(Keep);
+
+            FManagedKernel& Kernel = Kernels[i];
+            furnsh_c(TCHAR_TO_ANSI(*Kernel.Path));
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                continue;
+            }
+
+            Kernel.bLoaded = true;
+            Kernel.bPrefetched = bPrefetch;
+            LruPushFront(i);
+            ++LoadedCount;
+            ++Stats.Loads;
+            JustLoaded.Add(i);
+        }
+
+        if (JustLoaded.Num() > 0)
+        {
+            RestorePrecedence(JustLoaded);
+            OnKernelsChanged();
+        }
+
+        return JustLoaded.Num();
+    }
+
+    void Prefetch(const FKernelId& Key, double Time, const TArray<int32>& Required)
+    {
+        const double Horizon = Key.Kind == EKernelKind::CK ? Settings.PrefetchTicks : Settings.PrefetchSeconds;
+
+        // Which way is time going?
+        double& Last = LastRequired.FindOrAdd(Key, Time);
+        const double Direction = Time < Last ? -1. : 1.;
+        Last = Time;
+
+        if (Horizon <= 0.)
+        {
+            return;
+        }
+
+        TArray<int32> Ahead;
+        FindKernels(Key, Time + Direction * Horizon, Ahead);
+
+        TArray<int32> Keep = Required;
+        Keep.Append(Ahead);
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        Stats.Prefetches += Load(Ahead, Keep, true, &ResultCode, &ErrorMessage);
+    }
+
+    void RemoveEntries(int32 i)
+    {
+        const FManagedKernel& Kernel = Kernels[i];
+        for (int32 Id : Kernel.Ids)
+        {
+            const FKernelId Key { Kernel.Kind, Id };
+            FIdKernels& IdKernel = IdKernels[Key];
+            IdKernel.Entries.RemoveAll([i](const FIntervalTree::FEntry& Entry) { return Entry.Index == i; });
+            IdKernel.bDirty = true;
+
+            if (IdKernel.Entries.IsEmpty())
+            {
+                IdKernels.Remove(Key);
+                LastRequired.Remove(Key);
+            }
+        }
+    }
+
+    void LogStats()
+    {
+        const FStats Current = MaxQ::KernelManager::GetStats();
+        UE_LOG(LogSpice, Log, TEXT("MaxQ kernel manager: %d registered, %d/%d loaded, %lld requests, %.1f%% hits, %lld loads, %lld reloads, %lld evictions, %lld prefetches (%lld used)"),
+            Current.Registered, Current.Loaded, Current.MaxLoaded, Current.Requests, 100. * Current.HitRate(),
+            Current.Loads, Current.Reloads, Current.Evictions, Current.Prefetches, Current.PrefetchHits);
+    }
+
+    FAutoConsoleCommand StatsCommand(
+        TEXT("MaxQ.Spice.Kernels.Stats"),
+        TEXT("Logs the MaxQ kernel manager's load/hit statistics"),
+        FConsoleCommandDelegate::CreateStatic(&LogStats)
+    );
+}
+
+
+namespace MaxQ::Private
+{
+    void ForgetLoadedManagedKernels()
+    {
+        for (FManagedKernel& Kernel : Kernels)
+        {
+            Kernel.bLoaded = false;
+            Kernel.bPrefetched = false;
+            Kernel.LruPrev = Kernel.LruNext = INDEX_NONE;
+        }
+
+        LruHead = LruTail = INDEX_NONE;
+        LoadedCount = 0;
+    }
+}
+
+
+namespace MaxQ::KernelManager
+{
+    SPICE_API void Configure(const FSettings& NewSettings)
+    {
+        Settings = NewSettings;
+
+        // Shrink to the new budget now
+        if (LoadedCount > GetBudget())
+        {
+            FDeferKernelsChanged DeferKernelsChanged;
+            while (LoadedCount > GetBudget() && LruTail != INDEX_NONE)
+            {
+                Unload(LruTail);
+                ++Stats.Evictions;
+            }
+        }
+    }
+
+
+    SPICE_API FSettings GetSettings()
+    {
+        return Settings;
+    }
+
+
+    SPICE_API bool Register(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::KernelManager::Register);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+
+        const FString File = toPath(relativePath);
+        if (KernelsByPath.Contains(File))
+        {
+            *ResultCode = ES_ResultCode::Success;
+            return true;
+        }
+
+        SpiceChar _arch[32];
+        SpiceChar _type[32];
+        getfat_c(TCHAR_TO_ANSI(*File), sizeof(_arch), sizeof(_type), _arch, _type);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        EKernelKind Kind;
+        if (FCStringAnsi::Strcmp(_arch, "DAF") || !KernelKindFromType(ANSI_TO_TCHAR(_type), Kind))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("MaxQ kernel manager only manages SPK, CK and binary PCK files, %s is %s/%s"), *File, ANSI_TO_TCHAR(_arch), ANSI_TO_TCHAR(_type));
+            return false;
+        }
+
+        TMap<int32, TArray<FSWindowSegment>> Windows;
+        if (!ReadSummaries(File, Kind, Windows, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        const int32 i = Kernels.Add(FManagedKernel());
+        FManagedKernel& Kernel = Kernels[i];
+        Kernel.Path = File;
+        Kernel.Kind = Kind;
+        Kernel.Sequence = NextSequence++;
+        KernelsByPath.Add(File, i);
+
+        for (const auto& [Id, IdWindows] : Windows)
+        {
+            Kernel.Ids.Add(Id);
+
+            FIdKernels& IdKernel = IdKernels.FindOrAdd(FKernelId { Kind, Id });
+            for (const FSWindowSegment& Window : IdWindows)
+            {
+                IdKernel.Entries.Add({ Window.start, Window.stop, Kernel.Sequence, i });
+            }
+            IdKernel.bDirty = true;
+        }
+
+        *ResultCode = ES_ResultCode::Success;
+        return true;
+    }
+
+
+    SPICE_API bool Register(const TArray<FString>& relativePaths, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        bool bSuccess = true;
+        for (const FString& relativePath : relativePaths)
+        {
+            ES_ResultCode LocalResultCode;
+            FString LocalErrorMessage;
+            if (!Register(relativePath, &LocalResultCode, &LocalErrorMessage))
+            {
+                if (ResultCode) *ResultCode = LocalResultCode;
+                if (ErrorMessage) *ErrorMessage = LocalErrorMessage;
+                bSuccess = false;
+            }
+        }
+        return bSuccess;
+    }
+
+
+    SPICE_API bool RegisterDirectory(const FString& relativeDirectory, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        TArray<FString> relativePaths { MaxQ::Data::EnumerateDirectory(relativeDirectory, true, ResultCode, ErrorMessage) };
+        return relativePaths.Num() > 0 && Register(relativePaths, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void Unregister(const FString& relativePath)
+    {
+        int32 i;
+        if (!KernelsByPath.RemoveAndCopyValue(toPath(relativePath), i))
+        {
+            return;
+        }
+
+        if (Kernels[i].bLoaded)
+        {
+            Unload(i);
+        }
+
+        RemoveEntries(i);
+        Kernels.RemoveAt(i);
+    }
+
+
+    SPICE_API void UnregisterAll()
+    {
+        FDeferKernelsChanged DeferKernelsChanged;
+
+        while (LruTail != INDEX_NONE)
+        {
+            Unload(LruTail);
+        }
+
+        Kernels.Empty();
+        KernelsByPath.Empty();
+        IdKernels.Empty();
+        LastRequired.Empty();
+    }
+
+
+    SPICE_API bool Require(EKernelKind Kind, int32 Id, double Time, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::KernelManager::Require, Id, nullptr, nullptr);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+
+        const FKernelId Key { Kind, Id };
+
+        TArray<int32> Required;
+        FindKernels(Key, Time, Required);
+        if (Required.IsEmpty())
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("No kernel registered with the MaxQ kernel manager covers %d at %f"), Id, Time);
+            return false;
+        }
+
+        ++Stats.Requests;
+
+        bool bHit = true;
+        for (int32 i : Required)
+        {
+            FManagedKernel& Kernel = Kernels[i];
+            bHit &= Kernel.bLoaded;
+            if (Kernel.bPrefetched)
+            {
+                Kernel.bPrefetched = false;
+                ++Stats.PrefetchHits;
+            }
+        }
+
+        *ResultCode = ES_ResultCode::Success;
+
+        if (bHit)
+        {
+            ++Stats.Hits;
+        }
+        else
+        {
+            ++Stats.Misses;
+            Load(Required, Required, false, ResultCode, ErrorMessage);
+        }
+
+        for (int32 i : Required)
+        {
+            if (Kernels[i].bLoaded)
+            {
+                LruTouch(i);
+            }
+        }
+
+        Prefetch(Key, Time, Required);
+
+        return *ResultCode == ES_ResultCode::Success;
+    }
+
+
+    SPICE_API bool Require(const FName& Body, const FSEphemerisTime& et, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MakeErrorGutter(ResultCode, ErrorMessage);
+
+        int Id;
+        if (!MaxQ::Data::Bods2c(Id, Body))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("Could not translate %s to an NAIF ID code"), *Body.ToString());
+            return false;
+        }
+
+        return Require(EKernelKind::SPK, Id, et.seconds, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API bool IsAvailable(EKernelKind Kind, int32 Id, double Time)
+    {
+        TArray<int32> Found;
+        FindKernels(FKernelId { Kind, Id }, Time, Found);
+        return Found.Num() > 0;
+    }
+
+
+    SPICE_API FStats GetStats()
+    {
+        FStats Current = Stats;
+        Current.Registered = Kernels.Num();
+        Current.Loaded = LoadedCount;
+        Current.MaxLoaded = GetBudget();
+        return Current;
+    }
+
+
+    SPICE_API void ResetStats()
+    {
+        Stats = FStats();
+    }
+}
@@ -0,0 +1,567 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLambert.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Lambert's problem (Izzo's algorithm), and porkchop plots
+//
+// Izzo, "Revisiting Lambert's problem" (2015), as PyKEP implements it.  With
+// c = |r2 - r1|, s = (|r1| + |r2| + c) / 2, the problem reduces to one
+// parameter λ = ±sqrt(1 - c/s) and the non-dimensional time of flight
+// T = sqrt(2 gm / s^3) tof.  The unknown x (x < 1 elliptic, x > 1
+// hyperbolic) solves T(x) = T by Householder iterations, from Izzo's initial
+// guesses.  T(x) is Battin's hypergeometric series near x = 1, Lagrange's
+// form a little further out, and Lancaster's elsewhere.
+//
+// N revolutions are possible when T is at least T(x) at its minimum, found
+// by Halley iterations on dT/dx = 0 for the largest N, floor(T / π).  Each
+// such N has two solutions, from Izzo's left and right guesses.
+//
+// Porkchop cells are independent:  rows of arrival times are split into
+// tasks of RowsPerTask, one ParallelFor task each.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLambert.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceLambert.h"
+#include "Async/ParallelFor.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using MaxQ::Core::ToANSIString;
+    using MaxQ::Lambert::FLambertSolution;
+
+    // Below this, r1 & r2 are collinear with the center
+    constexpr double TinySine = 1e-12;
+
+    // |x - 1| bounds for Battin's series & Lagrange's form
+    constexpr double BattinDistance = 0.01;
+    constexpr double LagrangeDistance = 0.2;
+
+    // Householder tolerances on x, direct & multi-revolution, and iterations
+    constexpr double DirectTolerance = 1e-5;
+    constexpr double RevolutionsTolerance = 1e-8;
+    constexpr int32 MaxIterations = 15;
+
+    // Halley iterations for the minimum time of flight
+    constexpr double MinimumTolerance = 1e-13;
+    constexpr int32 MaxMinimumIterations = 12;
+
+    struct FProblem
+    {
+        double Lambda;
+        double Lambda2;
+        double Lambda3;
+        double T;
+    };
+
+    double Hypergeometric(double z, double Tolerance)
+    {
+        double Sum = 1., Term = 1.;
+        for (int32 j = 0; FMath::Abs(Term) > Tolerance; ++j)
+        {
+            Term = Term * (3. + j) * (1. + j) / (2.5 + j) * z / (j + 1.);
+            Sum += Term;
+        }
+        return Sum;
+    }
+
+    // Non-dimensional time of flight at x, N revolutions
+    double TimeOfFlight(const FProblem& P, double x, int32 N)
+    {
+        const double Distance = FMath::Abs(x - 1.);
+
+        if (Distance < LagrangeDistance && Distance > BattinDistance)
+        {
+            const double a = 1. / (1. - x * x);
+            if (a > 0.)
+            {
+                const double Alpha = 2. * FMath::Acos(x);
+                double Beta = 2. * FMath::Asin(FMath::Sqrt(P.Lambda2 / a));
+                if (P.Lambda < 0.) Beta = -Beta;
+                return a * FMath::Sqrt(a) * ((Alpha - FMath::Sin(Alpha)) - (Beta - FMath::Sin(Beta)) + 2. * PI * N) / 2.;
+            }
+            const double Alpha = 2. * acosh(x);
+            double Beta = 2. * asinh(FMath::Sqrt(-P.Lambda2 / a));
+            if (P.Lambda < 0.) Beta = -Beta;
+            return -a * FMath::Sqrt(-a) * ((Beta - sinh(Beta)) - (Alpha - sinh(Alpha))) / 2.;
+        }
+
+        const double E = x * x - 1.;
+        const double Rho = FMath::Abs(E);
+        const double z = FMath::Sqrt(1. + P.Lambda2 * E);
+
+        if (Distance < BattinDistance)
+        {
+            const double Eta = z - P.Lambda * x;
+            const double S1 = 0.5 * (1. - P.Lambda - x * Eta);
+            const double Q = 4. / 3. * Hypergeometric(S1, 1e-11);
+            return (Eta * Eta * Eta * Q + 4. * P.Lambda * Eta) / 2. + N * PI / FMath::Pow(Rho, 1.5);
+        }
+
+        const double y = FMath::Sqrt(Rho);
+        const double g = x * z - P.Lambda * E;
+        double d;
+        if (E < 0.)
+        {
+            d = N * PI + FMath::Acos(g);
+        }
+        else
+        {
+            const double f = y * (z - P.Lambda * x);
+            d = FMath::Loge(f + g);
+        }
+        return (x - P.Lambda * z - d / y) / E;
+    }
+
+    // dT/dx and the next two derivatives, at x & its T
+    void Derivatives(const FProblem& P, double x, double T, double& DT, double& DDT, double& DDDT)
+    {
+        const double umx2 = 1. - x * x;
+        const double y = FMath::Sqrt(1. - P.Lambda2 * umx2);
+        const double y2 = y * y, y3 = y2 * y;
+        DT = (3. * T * x - 2. + 2. * P.Lambda3 * x / y) / umx2;
+        DDT = (3. * T + 5. * x * DT + 2. * (1. - P.Lambda2) * P.Lambda3 / y3) / umx2;
+        DDDT = (7. * x * DDT + 8. * DT - 6. * (1. - P.Lambda2) * P.Lambda2 * P.Lambda3 * x / y3 / y2) / umx2;
+    }
+
+    int32 Householder(const FProblem& P, double& x, int32 N, double Tolerance)
+    {
+        int32 Iterations = 0;
+        for (double Error = 1.; Error > Tolerance && Iterations < MaxIterations; ++Iterations)
+        {
+            const double T = TimeOfFlight(P, x, N);
+            double DT, DDT, DDDT;
+            Derivatives(P, x, T, DT, DDT, DDDT);
+            const double Delta = T - P.T;
+            const double DT2 = DT * DT;
+            const double Next = x - Delta * (DT2 - Delta * DDT / 2.) / (DT * (DT2 - Delta * DDT) + DDDT * Delta * Delta / 6.);
+            Error = FMath::Abs(x - Next);
+            x = Next;
+        }
+        return Iterations;
+    }
+
+    // Appends the transfers, or returns false if the geometry is degenerate.
+    // tof & gm are positive.
+    bool Transfers(TArray<FLambertSolution>& Solutions, const FVector3d& r1, const FVector3d& r2, double tof, double gm, bool bRetrograde, int32 MaxRevolutions)
+    {
+        const double R1 = r1.Length(), R2 = r2.Length();
+        if (!(R1 > 0.) || !(R2 > 0.))
+        {
+            return false;
+        }
+        const FVector3d ir1 = r1 / R1, ir2 = r2 / R2;
+        FVector3d ih = ir1 ^ ir2;
+        const double Sine = ih.Length();
+        if (!(Sine > TinySine))
+        {
+            return false;
+        }
+        ih /= Sine;
+
+        const double c = (r2 - r1).Length();
+        const double s = (R1 + R2 + c) / 2.;
+
+        FProblem P;
+        P.Lambda = FMath::Sqrt(FMath::Max(0., 1. - c / s));
+        FVector3d it1, it2;
+        if (ih.Z < 0.)
+        {
+            P.Lambda = -P.Lambda;
+            it1 = ir1 ^ ih;
+            it2 = ir2 ^ ih;
+        }
+        else
+        {
+            it1 = ih ^ ir1;
+            it2 = ih ^ ir2;
+        }
+        if (bRetrograde)
+        {
+            P.Lambda = -P.Lambda;
+            it1 = -it1;
+            it2 = -it2;
+        }
+        P.Lambda2 = P.Lambda * P.Lambda;
+        P.Lambda3 = P.Lambda2 * P.Lambda;
+        P.T = FMath::Sqrt(2. * gm / (s * s * s)) * tof;
+
+        // The most revolutions T allows
+        const double T00 = FMath::Acos(P.Lambda) + P.Lambda * FMath::Sqrt(1. - P.Lambda2);
+        const double T1 = 2. / 3. * (1. - P.Lambda3);
+        const double Revolutions = FMath::FloorToDouble(P.T / PI);
+        int32 NMax = 0;
+        if (Revolutions > MaxRevolutions)
+        {
+            // Fewer than floor(T / π) always fit
+            NMax = MaxRevolutions;
+        }
+        else if (Revolutions > 0.)
+        {
+            NMax = (int32)Revolutions;
+            const double T0 = T00 + NMax * PI;
+            if (P.T < T0)
+            {
+                double TMin = T0, x = 0.;
+                for (int32 i = 0; i <= MaxMinimumIterations; ++i)
+                {
+                    double DT, DDT, DDDT;
+                    Derivatives(P, x, TMin, DT, DDT, DDDT);
+                    const double Next = DT != 0. ? x - DT * DDT / (DDT * DDT - DT * DDDT / 2.) : x;
+                    if (FMath::Abs(x - Next) < MinimumTolerance)
+                    {
+                        break;
+                    }
+                    TMin = TimeOfFlight(P, Next, NMax);
+                    x = Next;
+                }
+                if (TMin > P.T)
+                {
+                    --NMax;
+                }
+            }
+        }
+
+        const double Gamma = FMath::Sqrt(gm * s / 2.);
+        const double Rho = (R1 - R2) / c;
+        const double Sigma = FMath::Sqrt(FMath::Max(0., 1. - Rho * Rho));
+
+        const auto Add = [&](double x, int32 N, bool bLeft, int32 Iterations)
+        {
+            const double y = FMath::Sqrt(1. - P.Lambda2 + P.Lambda2 * x * x);
+            const double Vr1 = Gamma * ((P.Lambda * y - x) - Rho * (P.Lambda * y + x)) / R1;
+            const double Vr2 = -Gamma * ((P.Lambda * y - x) + Rho * (P.Lambda * y + x)) / R2;
+            const double Vt = Gamma * Sigma * (y + P.Lambda * x);
+
+            FLambertSolution& Solution = Solutions.AddDefaulted_GetRef();
+            Solution.V1 = ir1 * Vr1 + it1 * (Vt / R1);
+            Solution.V2 = ir2 * Vr2 + it2 * (Vt / R2);
+            Solution.Revolutions = N;
+            Solution.bLeftBranch = bLeft;
+            Solution.Iterations = Iterations;
+        };
+
+        // Direct
+        double x;
+        if (P.T >= T00)
+        {
+            x = -(P.T - T00) / (P.T - T00 + 4.);
+        }
+        else if (P.T <= T1)
+        {
+            x = T1 * (T1 - P.T) / (2. / 5. * (1. - P.Lambda2 * P.Lambda3) * P.T) + 1.;
+        }
+        else
+        {
+            x = FMath::Pow(P.T / T00, 0.69314718055994529 / FMath::Loge(T1 / T00)) - 1.;
+        }
+        int32 Iterations = Householder(P, x, 0, DirectTolerance);
+        Add(x, 0, false, Iterations);
+
+        for (int32 N = 1; N <= NMax; ++N)
+        {
+            double Guess = FMath::Pow((N * PI + PI) / (8. * P.T), 2. / 3.);
+            x = (Guess - 1.) / (Guess + 1.);
+            Iterations = Householder(P, x, N, RevolutionsTolerance);
+            Add(x, N, true, Iterations);
+
+            Guess = FMath::Pow((8. * P.T) / (N * PI), 2. / 3.);
+            x = (Guess - 1.) / (Guess + 1.);
+            Iterations = Householder(P, x, N, RevolutionsTolerance);
+            Add(x, N, false, Iterations);
+        }
+
+        return true;
+    }
+
+    bool IsFinite(const FVector3d& v)
+    {
+        return FMath::IsFinite(v.X) && FMath::IsFinite(v.Y) && FMath::IsFinite(v.Z);
+    }
+}
+
+
+namespace MaxQ::Lambert
+{
+    bool Solve(
+        TArray<FLambertSolution>& Solutions,
+        const FVector3d& r1,
+        const FVector3d& r2,
+        double tof,
+        double gm,
+        bool bRetrograde,
+        int32 MaxRevolutions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        // Any thread:  no error gutter
+        ES_ResultCode LocalResultCode;
+        FString LocalErrorMessage;
+        if (!ResultCode) ResultCode = &LocalResultCode;
+        if (!ErrorMessage) ErrorMessage = &LocalErrorMessage;
+
+        Solutions.Reset();
+
+        if (!(tof > 0.) || !(gm > 0.) || MaxRevolutions < 0)
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Lambert needs tof > 0, gm > 0 and MaxRevolutions >= 0");
+            return false;
+        }
+
+        if (!Transfers(Solutions, r1, r2, tof, gm, bRetrograde, MaxRevolutions))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Lambert's r1 & r2 are collinear with the center, the transfer plane is undefined");
+            return false;
+        }
+
+        *ResultCode = ES_ResultCode::Success;
+        return true;
+    }
+
+
+    void FPorkchop::ToTexels(TArray<FVector4f>& Texels) const
+    {
+        Texels.SetNumUninitialized(Num());
+        for (int32 i = 0; i < Texels.Num(); ++i)
+        {
+            Texels[i] = FVector4f((float)C3[i], (float)ArrivalVInfinity[i], (float)(TimeOfFlight[i] / 86400.), Solved[i] ? 1.f : 0.f);
+        }
+    }
+
+
+    bool SolveGrid(
+        FPorkchop& Porkchop,
+        const TArray<double>& DepartureTimes,
+        const FSStateVectorBuffer& DepartureStates,
+        const TArray<double>& ArrivalTimes,
+        const FSStateVectorBuffer& ArrivalStates,
+        double gm,
+        const FPorkchopSettings& Settings,
+        FPorkchopStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Lambert::SolveGrid);
+
+        // Any thread:  no error gutter
+        ES_ResultCode LocalResultCode;
+        FString LocalErrorMessage;
+        if (!ResultCode) ResultCode = &LocalResultCode;
+        if (!ErrorMessage) ErrorMessage = &LocalErrorMessage;
+
+        FPorkchopStats LocalStats;
+        if (!Stats) Stats = &LocalStats;
+        *Stats = FPorkchopStats();
+
+        const double Start = FPlatformTime::Seconds();
+
+        if (DepartureTimes.Num() != DepartureStates.Num() || ArrivalTimes.Num() != ArrivalStates.Num() || !(gm > 0.) || Settings.MaxRevolutions < 0 || Settings.MaxRevolutions > MAX_uint8)
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Porkchop needs a state per departure & arrival time, gm > 0 and MaxRevolutions 0..255");
+            return false;
+        }
+
+        const int32 Width = DepartureTimes.Num();
+        const int32 Height = ArrivalTimes.Num();
+        Porkchop.Width = Width;
+        Porkchop.Height = Height;
+        Porkchop.DepartureTimes = DepartureTimes;
+        Porkchop.ArrivalTimes = ArrivalTimes;
+        Porkchop.C3.SetNumZeroed(Width * Height);
+        Porkchop.ArrivalVInfinity.SetNumZeroed(Width * Height);
+        Porkchop.TimeOfFlight.SetNumZeroed(Width * Height);
+        Porkchop.Revolutions.SetNumZeroed(Width * Height);
+        Porkchop.Solved.SetNumZeroed(Width * Height);
+
+        TArray<FVector3d> DeparturePositions, DepartureVelocities;
+        DeparturePositions.SetNumUninitialized(Width);
+        DepartureVelocities.SetNumUninitialized(Width);
+        for (int32 i = 0; i < Width; ++i)
+        {
+            DeparturePositions[i] = FVector3d(DepartureStates.x[i], DepartureStates.y[i], DepartureStates.z[i]);
+            DepartureVelocities[i] = FVector3d(DepartureStates.dx[i], DepartureStates.dy[i], DepartureStates.dz[i]);
+        }
+
+        const int32 RowsPerTask = FMath::Max(1, Settings.RowsPerTask);
+        const int32 Tasks = FMath::DivideAndRoundUp(Height, RowsPerTask);
+
+        struct FTaskResult
+        {
+            int64 Solved = 0;
+            int64 Iterations = 0;
+        };
+        TArray<FTaskResult> Results;
+        Results.SetNum(Tasks);
+
+        ParallelFor(Tasks, [&](int32 Task)
+        {
+            FTaskResult& Result = Results[Task];
+            TArray<FLambertSolution> Solutions;
+            Solutions.Reserve(1 + 2 * Settings.MaxRevolutions);
+
+            const int32 RowEnd = FMath::Min(Height, (Task + 1) * RowsPerTask);
+            for (int32 Row = Task * RowsPerTask; Row < RowEnd; ++Row)
+            {
+                const FVector3d r2(ArrivalStates.x[Row], ArrivalStates.y[Row], ArrivalStates.z[Row]);
+                const FVector3d v2(ArrivalStates.dx[Row], ArrivalStates.dy[Row], ArrivalStates.dz[Row]);
+
+                for (int32 Column = 0; Column < Width; ++Column)
+                {
+                    const double tof = ArrivalTimes[Row] - DepartureTimes[Column];
+                    Solutions.Reset();
+                    if (!(tof > 0.) || !Transfers(Solutions, DeparturePositions[Column], r2, tof, gm, Settings.bRetrograde, Settings.MaxRevolutions))
+                    {
+                        continue;
+                    }
+
+                    // Lowest total v-infinity
+                    int32 Best = INDEX_NONE;
+                    double BestTotal = 0., BestDeparture = 0., BestArrival = 0.;
+                    for (int32 k = 0; k < Solutions.Num(); ++k)
+                    {
+                        const FLambertSolution& Solution = Solutions[k];
+                        Result.Iterations += Solution.Iterations;
+                        const FVector3d Departure = Solution.V1 - DepartureVelocities[Column];
+                        const FVector3d Arrival = Solution.V2 - v2;
+                        if (!IsFinite(Departure) || !IsFinite(Arrival))
+                        {
+                            continue;
+                        }
+                        const double DepartureSpeed = Departure.Length(), ArrivalSpeed = Arrival.Length();
+                        if (Best == INDEX_NONE || DepartureSpeed + ArrivalSpeed < BestTotal)
+                        {
+                            Best = k;
+                            BestTotal = DepartureSpeed + ArrivalSpeed;
+                            BestDeparture = DepartureSpeed;
+                            BestArrival = ArrivalSpeed;
+                        }
+                    }
+                    if (Best == INDEX_NONE)
+                    {
+                        continue;
+                    }
+
+                    const int32 Cell = Row * Width + Column;
+                    Porkchop.C3[Cell] = BestDeparture * BestDeparture;
+                    Porkchop.ArrivalVInfinity[Cell] = BestArrival;
+                    Porkchop.TimeOfFlight[Cell] = tof;
+                    Porkchop.Revolutions[Cell] = (uint8)Solutions[Best].Revolutions;
+                    Porkchop.Solved[Cell] = 1;
+                    ++Result.Solved;
+                }
+            }
+        });
+
+        Stats->Cells = (int64)Width * Height;
+        for (const FTaskResult& Result : Results)
+        {
+            Stats->Solved += Result.Solved;
+            Stats->Iterations += Result.Iterations;
+        }
+        Stats->Seconds = FPlatformTime::Seconds() - Start;
+
+        *ResultCode = ES_ResultCode::Success;
+        return true;
+    }
+
+
+    bool MakePorkchop(
+        FPorkchop& Porkchop,
+        const FName& departure,
+        const FName& arrival,
+        const FName& center,
+        const FName& frame,
+        const FSEphemerisTime& DepartureFirst,
+        const FSEphemerisTime& DepartureLast,
+        int32 Width,
+        const FSEphemerisTime& ArrivalFirst,
+        const FSEphemerisTime& ArrivalLast,
+        int32 Height,
+        const FPorkchopSettings& Settings,
+        FPorkchopStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Lambert::MakePorkchop, arrival, departure, frame);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        if (Width < 1 || Height < 1)
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Porkchop needs at least one departure & arrival time");
+            return false;
+        }
+
+        double gm = 0.;
+        MaxQ::Data::Bodvrd(gm, center, FName(TEXT("GM")), ResultCode, ErrorMessage);
+        if (*ResultCode != ES_ResultCode::Success)
+        {
+            return false;
+        }
+
+        const ANSICHAR* _frame = ToANSIString(frame);
+        const ANSICHAR* _center = ToANSIString(center);
+
+        // One spkezr per column & row
+        const auto Sample = [&](const FName& Body, const FSEphemerisTime& First, const FSEphemerisTime& Last, int32 Count, TArray<double>& Times, FSStateVectorBuffer& States)
+        {
+            const double et0 = First.AsSpiceDouble(), et1 = Last.AsSpiceDouble();
+            const ANSICHAR* _target = ToANSIString(Body);
+            Times.SetNumUninitialized(Count);
+            States.SetNum(Count);
+            for (int32 i = 0; i < Count && !failed_c(); ++i)
+            {
+                Times[i] = Count > 1 ? et0 + (et1 - et0) * i / (Count - 1) : et0;
+
+                SpiceDouble _state[6], _lt = 0.;
+                spkezr_c(_target, Times[i], _frame, "NONE", _center, _state, &_lt);
+                States.CopyFrom(i, _state);
+            }
+        };
+
+        TArray<double> DepartureTimes, ArrivalTimes;
+        FSStateVectorBuffer DepartureStates, ArrivalStates;
+        Sample(departure, DepartureFirst, DepartureLast, Width, DepartureTimes, DepartureStates);
+        Sample(arrival, ArrivalFirst, ArrivalLast, Height, ArrivalTimes, ArrivalStates);
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        return SolveGrid(Porkchop, DepartureTimes, DepartureStates, ArrivalTimes, ArrivalStates, gm, Settings, Stats, ResultCode, ErrorMessage);
+    }
+}
@@ -71,6 +71,7 @@ namespace MaxQ::Math
         const FSRotationMatrix& m,
         const VectorType& vin)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MxV);
         xV<VectorType,mxv_c>(vout, m, vin);
     }
 
@@ -124,6 +125,7 @@ namespace MaxQ::Math
         const VectorType& vin
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MxV);
         return xV<VectorType, mxvg_c>(vout, m, vin);
     }
 
@@ -137,6 +139,7 @@ namespace MaxQ::Math
         const VectorType& vin
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MTxV);
         xV<VectorType, mtxv_c>(vout, m, vin);
     }
 
@@ -152,6 +155,7 @@ namespace MaxQ::Math
         const VectorType& vin
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MTxV);
         xV<VectorType, mtxvg_c>(vout, m, vin);
     }
 
@@ -172,6 +176,7 @@ namespace MaxQ::Math
 
     SPICE_API void MxM(FSRotationMatrix& mout, const FSRotationMatrix& m1, const FSRotationMatrix& m2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MxM);
         xM<mxm_c>(mout, m1, m2);
     }
 
@@ -194,26 +199,31 @@ namespace MaxQ::Math
 
     SPICE_API void MxM(FSStateTransform& mout, const FSStateTransform& m1, const FSStateTransform& m2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MxM);
         xM<mxmg_c>(mout, m1, m2);
     }
 
     SPICE_API void MTxM(FSRotationMatrix& mout, const FSRotationMatrix& m1, const FSRotationMatrix& m2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MTxM);
         xM<mtxm_c>(mout, m1, m2);
     }
 
     SPICE_API void MTxM(FSStateTransform& mout, const FSStateTransform& m1, const FSStateTransform& m2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MTxM);
         xM<mtxmg_c>(mout, m1, m2);
     }
 
     SPICE_API void MxMT(FSRotationMatrix& mout, const FSRotationMatrix& m1, const FSRotationMatrix& m2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MxMT);
         xM<mxmt_c>(mout, m1, m2);
     }
 
     SPICE_API void MxMT(FSStateTransform& mout, const FSStateTransform& m1, const FSStateTransform& m2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::MxMT);
         xM<mxmtg_c>(mout, m1, m2);
     }
 
@@ -318,6 +328,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vadd(VectorType& vsum, const VectorType& v1, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vadd);
         v3op<VectorType,vadd_c>(vsum, v1, v2);
     }
 
@@ -330,12 +341,14 @@ namespace MaxQ::Math
     template<>
     SPICE_API void Vadd(FSStateVector& sum, const FSStateVector& v1, const FSStateVector& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vadd);
         v6op<FSStateVector,vaddg_c>(sum, v1, v2);
     }
 
     template<>
     SPICE_API void Vadd(FSDimensionlessStateVector& sum, const FSDimensionlessStateVector& v1, const FSDimensionlessStateVector& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vadd);
         v6op<FSDimensionlessStateVector, vaddg_c>(sum, v1, v2);
     }
 
@@ -343,6 +356,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vhat(FSDimensionlessVector& vhat, const VectorType& v)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vhat);
         v3op<FSDimensionlessVector, VectorType,  vhat_c>(vhat, v);
     }
 
@@ -353,6 +367,7 @@ namespace MaxQ::Math
 
     SPICE_API void Vrel(double& vnorm, const FSDimensionlessVector& v1, const FSDimensionlessVector& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vrel);
         SpiceDouble _v1[3]; v1.CopyTo(_v1);
         SpiceDouble _v2[3]; v2.CopyTo(_v2);
 
@@ -362,6 +377,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vscl(VectorType& vscaled, double s, const VectorType& v)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vscl);
         ConstSpiceDouble _s = s;
         SpiceDouble _v[3]; v.CopyTo(_v);
         SpiceDouble _vscaled[3]; vscaled.CopyTo(_vscaled);
@@ -379,6 +395,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vsub(VectorType& vdifference, const VectorType& v1, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vsub);
         v3op<VectorType, vsub_c>(vdifference, v1, v2);
     }
 
@@ -391,24 +408,28 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vrel(VectorType& vdifference, const VectorType& v1, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vrel);
         v3sop<VectorType, vrel_c>(vdifference, v1, v2);
     }
 
     template<>
     SPICE_API void Vsub(FSStateVector& vdifference, const FSStateVector& v1, const FSStateVector& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vsub);
         v6op<FSStateVector, vsubg_c>(vdifference, v1, v2);
     }
 
     template<>
     SPICE_API void Vsub(FSDimensionlessStateVector& vdifference, const FSDimensionlessStateVector& v1, const FSDimensionlessStateVector& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vsub);
         v6op<FSDimensionlessStateVector, vsubg_c>(vdifference, v1, v2);
     }
 
     template<class VectorType>
     SPICE_API void Vminus(VectorType& vminus, const VectorType& v)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vminus);
         v3op<VectorType, vminus_c>(vminus, v);
     }
 
@@ -420,18 +441,21 @@ namespace MaxQ::Math
     template<>
     SPICE_API void Vminus(FSStateVector& vminus, const FSStateVector& v)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vminus);
         v6op<FSStateVector, vminug_c>(vminus, v);
     }
 
     template<>
     SPICE_API void Vminus(FSDimensionlessStateVector& vminus, const FSDimensionlessStateVector& v)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vminus);
         v6op<FSDimensionlessStateVector, vminug_c>(vminus, v);
     }
 
     template<class ParamRateType, class ParamType>
     SPICE_API void Qderiv(ParamRateType& dfdt, const ParamType& f0, const ParamType& f2, double delta)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Qderiv);
         constexpr SpiceInt _ndim{ 3 };
         SpiceDouble    _f0[3];      f0.CopyTo(_f0);
         SpiceDouble    _f2[3];      f2.CopyTo(_f2);
@@ -449,6 +473,7 @@ namespace MaxQ::Math
     template<>
     SPICE_API void Qderiv(FSSpeed& dfdt, const FSDistance& f0, const FSDistance& f2, double delta)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Qderiv);
         constexpr SpiceInt _ndim{ 1 };
         SpiceDouble    _f0 = f0.AsSpiceDouble();
         SpiceDouble    _f2 = f2.AsSpiceDouble();
@@ -463,6 +488,7 @@ namespace MaxQ::Math
     template<>
     SPICE_API void Qderiv(double& dfdt, const double& f0, const double& f2, double delta)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Qderiv);
         constexpr SpiceInt _ndim{ 1 };
         SpiceDouble    _f0 = f0;
         SpiceDouble    _f2 = f2;
@@ -477,6 +503,7 @@ namespace MaxQ::Math
     template<>
     SPICE_API void Qderiv(TArray<double>& dfdt, const TArray<double>& f0, const TArray<double>& f2, double delta)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Qderiv);
         const SpiceInt _ndim{ FMath::Min(f0.Num(), f2.Num()) };
         ConstSpiceDouble* _f0 = f0.GetData();
         ConstSpiceDouble* _f2 = f2.GetData();
@@ -497,6 +524,7 @@ namespace MaxQ::Math
         FString* ErrorMessage
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::TwoVec);
         SpiceDouble _axdef[3];   axdef.CopyTo(_axdef);
         SpiceInt    _indexa = (SpiceInt)axisa;
         SpiceDouble _plndef[3];  plndef.CopyTo(_plndef);
@@ -521,6 +549,7 @@ namespace MaxQ::Math
         FString* ErrorMessage
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::TwoVXF);
         SpiceDouble _axdef[6];   axdef.CopyTo(_axdef);
         SpiceInt    _indexa = (SpiceInt)axisa;
         SpiceDouble _plndef[6];  plndef.CopyTo(_plndef);
@@ -538,6 +567,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Ucrss(VectorType& vout, const VectorType& v1, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Ucrss);
         return v3op<VectorType, ucrss_c>(vout, v1, v2);
     }
 
@@ -548,12 +578,14 @@ namespace MaxQ::Math
 
     SPICE_API void Ucrss(FSDimensionlessVector& vout, const FSDistanceVector& v1, const FSVelocityVector& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Ucrss);
         return v3op<FSDimensionlessVector, FSDistanceVector, FSVelocityVector, ucrss_c>(vout, v1, v2);
     }
 
     template<class VectorType>
     SPICE_API void Vcrss(VectorType& vout, const VectorType& v1, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vcrss);
         return v3op<VectorType, vcrss_c>(vout, v1, v2);
     }
 
@@ -564,12 +596,14 @@ namespace MaxQ::Math
 
     SPICE_API void Vcrss(FSDimensionlessVector& vout, const FSDistanceVector& v1, const FSVelocityVector& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vcrss);
         return v3op<FSDimensionlessVector, FSDistanceVector, FSVelocityVector, vcrss_c>(vout, v1, v2);
     }
 
     template<class VectorType>
     SPICE_API void Vperp(VectorType& vout, const VectorType& v1, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vperp);
         return v3op<VectorType, vperp_c>(vout, v1, v2);
     }
 
@@ -581,6 +615,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vproj(VectorType& vout, const VectorType& v1, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vproj);
         return v3op<VectorType, vproj_c>(vout, v1, v2);
     }
 
@@ -593,6 +628,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vprjp(VectorType& vout, const VectorType& v, const FSPlane& plane)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vprjp);
         SpiceDouble _vin[3]; v.CopyTo(_vin);
         SpicePlane _plane;          CopyTo(plane, _plane);
         SpiceDouble _vout[3]{ 0, 0, 0 };
@@ -613,6 +649,7 @@ namespace MaxQ::Math
     template<class ScalarType, class VectorType>
     inline void Unorm(FSDimensionlessVector& vout, ScalarType& vmag, const VectorType& v)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Unorm);
         // input
         SpiceDouble  _v1[3];    v.CopyTo(_v1);
         // Outputs
@@ -635,6 +672,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vlcom(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vlcom);
         ConstSpiceDouble _a{ a };
         SpiceDouble _v1[3]; v1.CopyTo(_v1);
         ConstSpiceDouble _b{ b };
@@ -654,6 +692,7 @@ namespace MaxQ::Math
     template<class VectorType, SpiceInt N>
     inline void vlcomN(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vlcom);
         ConstSpiceDouble _a{ a };
         SpiceDouble _v1[N]; v1.CopyTo(_v1);
         ConstSpiceDouble _b{ b };
@@ -680,6 +719,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vlcom3(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2, double c, const VectorType& v3)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vlcom3);
         ConstSpiceDouble _a{ a };
         SpiceDouble _v1[3]; v1.CopyTo(_v1);
         ConstSpiceDouble _b{ b };
@@ -706,6 +746,7 @@ namespace MaxQ::Math
         const VectorType& v2
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vdot);
         v3sop<OutputType, VectorType, VectorType, vdot_c>(dot, v1, v2);
     }
 
@@ -731,6 +772,7 @@ namespace MaxQ::Math
         const FSDimensionlessVector& v2
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vdist);
         v3sop<double, FSDimensionlessVector, FSDimensionlessVector, vdist_c>(dist, v1, v2);
     }
 
@@ -742,6 +784,7 @@ namespace MaxQ::Math
         const VectorType& v2
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vdist);
         v3sop<OutputType, VectorType, VectorType, vdist_c>(dist, v1, v2);
     }
 
@@ -752,6 +795,7 @@ namespace MaxQ::Math
 
     SPICE_API void Vnorm(double& vnorm, const FSDimensionlessVector& v)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vnorm);
         SpiceDouble _v[3]; v.CopyTo(_v);
 
         vnorm = vnorm_c(_v);
@@ -760,6 +804,7 @@ namespace MaxQ::Math
     template<class VectorType>
     SPICE_API void Vsep(FSAngle& angle, const VectorType& v1, const VectorType& v2)
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Vsep);
         v3sop<FSAngle, VectorType, VectorType, vsep_c>(angle, v1, v2);
     }
     template SPICE_API void Vsep<FSDimensionlessVector>(FSAngle&, const FSDimensionlessVector&, const FSDimensionlessVector&);
@@ -777,6 +822,7 @@ namespace MaxQ::Math
         const VectorType& v2
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::VTxMxV);
         // Inputs
         SpiceDouble    _v1[3];		v1.CopyTo(_v1);
         SpiceDouble    _m[3][3];	m.CopyTo(_m);
@@ -799,6 +845,7 @@ namespace MaxQ::Math
         const VectorType& v2
     )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::VTxMxV);
         // Inputs
         SpiceDouble    _v1[6];		v1.CopyTo(_v1);
         SpiceDouble    _m[6][6];	m.CopyTo(_m);
@@ -821,6 +868,7 @@ namespace MaxQ::Math
         FString* ErrorMessage
         )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::M2q);
         SpiceDouble _r[3][3];  r.CopyTo(_r);
         SpiceDouble _q[4];  q.CopyTo(_q);
         m2q_c(_r, _q);
@@ -836,6 +884,7 @@ namespace MaxQ::Math
         const FSQuaternion& q
         )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Q2m);
         SpiceDouble _r[3][3];
         SpiceDouble _q[4];
         q.CopyTo(_q);
@@ -851,6 +900,7 @@ namespace MaxQ::Math
         const FSQuaternion& q2
         )
     {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::QxQ);
         SpiceDouble _qout[4];
         SpiceDouble _q1[4];  q1.CopyTo(_q1);
         SpiceDouble _q2[4];  q2.CopyTo(_q2);
@@ -910,4 +960,156 @@ namespace MaxQ::Math
 
         return radians;
     }
+
+
+    SPICE_API void MxV(FSStateVectorBuffer& vout, const FSStateTransform& m, const FSStateVectorBuffer& vin)
+    {
+        double _m[6][6]; m.CopyTo(_m);
+
+        const int32 Count = vin.Num();
+        if (&vout != &vin) vout.SetNum(Count);
+
+        for (int32 i = 0; i < Count; ++i)
+        {
+            const double _v[6] = { vin.x[i], vin.y[i], vin.z[i], vin.dx[i], vin.dy[i], vin.dz[i] };
+            double _vout[6];
+
+            for (int row = 0; row < 6; ++row)
+            {
+                _vout[row] = _m[row][0] * _v[0] + _m[row][1] * _v[1] + _m[row][2] * _v[2] + _m[row][3] * _v[3] + _m[row][4] * _v[4] + _m[row][5] * _v[5];
+            }
+
+            vout.CopyFrom(i, _vout);
+        }
+    }
+
+    template<bool bTranspose>
+    inline void RotateBuffer(FSStateVectorBuffer& vout, const FSRotationMatrix& m, const FSStateVectorBuffer& vin)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::RotateBuffer);
+        double _m[3][3]; m.CopyTo(_m);
+        if (bTranspose)
+        {
+            xpose_c(_m, _m);
+        }
+
+        const int32 Count = vin.Num();
+        if (&vout != &vin) vout.SetNum(Count);
+
+        for (int32 i = 0; i < Count; ++i)
+        {
+            const double x = vin.x[i], y = vin.y[i], z = vin.z[i];
+            const double dx = vin.dx[i], dy = vin.dy[i], dz = vin.dz[i];
+
+            vout.x[i] = _m[0][0] * x + _m[0][1] * y + _m[0][2] * z;
+            vout.y[i] = _m[1][0] * x + _m[1][1] * y + _m[1][2] * z;
+            vout.z[i] = _m[2][0] * x + _m[2][1] * y + _m[2][2] * z;
+            vout.dx[i] = _m[0][0] * dx + _m[0][1] * dy + _m[0][2] * dz;
+            vout.dy[i] = _m[1][0] * dx + _m[1][1] * dy + _m[1][2] * dz;
+            vout.dz[i] = _m[2][0] * dx + _m[2][1] * dy + _m[2][2] * dz;
+        }
+    }
+
+    SPICE_API void MxV(FSStateVectorBuffer& vout, const FSRotationMatrix& m, const FSStateVectorBuffer& vin)
+    {
+        RotateBuffer<false>(vout, m, vin);
+    }
+
+    SPICE_API void MTxV(FSStateVectorBuffer& vout, const FSRotationMatrix& m, const FSStateVectorBuffer& vin)
+    {
+        RotateBuffer<true>(vout, m, vin);
+    }
+
+    // sign: +1 for addition, -1 for subtraction
+    inline void OffsetBuffer(FSStateVectorBuffer& vout, const FSStateVectorBuffer& vin, const FSStateVector& offset, double sign)
+    {
+        double _offset[6]; offset.CopyTo(_offset);
+
+        const int32 Count = vin.Num();
+        if (&vout != &vin) vout.SetNum(Count);
+
+        for (int32 i = 0; i < Count; ++i) vout.x[i] = vin.x[i] + sign * _offset[0];
+        for (int32 i = 0; i < Count; ++i) vout.y[i] = vin.y[i] + sign * _offset[1];
+        for (int32 i = 0; i < Count; ++i) vout.z[i] = vin.z[i] + sign * _offset[2];
+        for (int32 i = 0; i < Count; ++i) vout.dx[i] = vin.dx[i] + sign * _offset[3];
+        for (int32 i = 0; i < Count; ++i) vout.dy[i] = vin.dy[i] + sign * _offset[4];
+        for (int32 i = 0; i < Count; ++i) vout.dz[i] = vin.dz[i] + sign * _offset[5];
+    }
+
+    SPICE_API void Vadd(FSStateVectorBuffer& vsum, const FSStateVectorBuffer& v1, const FSStateVector& v2)
+    {
+        OffsetBuffer(vsum, v1, v2, +1.);
+    }
+
+    SPICE_API void Vsub(FSStateVectorBuffer& vdifference, const FSStateVectorBuffer& v1, const FSStateVector& v2)
+    {
+        OffsetBuffer(vdifference, v1, v2, -1.);
+    }
+
+    SPICE_API void Prop2b(
+        FSStateVectorBuffer& pvprop,
+        const FSMassConstant& gm,
+        const FSStateVectorBuffer& pvinit,
+        const FSEphemerisPeriod& dt,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Math::Prop2b);
+        SpiceDouble _gm = gm.AsSpiceDouble();
+        SpiceDouble _dt = dt.AsSpiceDouble();
+
+        // Propagate into a temporary (pvprop may alias pvinit), so a failure
+        // leaves no partly propagated output.
+        const int32 Count = pvinit.Num();
+        FSStateVectorBuffer Result(Count);
+
+        for (int32 i = 0; i < Count; ++i)
+        {
+            SpiceDouble _pvinit[6]; pvinit.CopyTo(i, _pvinit);
+            SpiceDouble _pvprop[6];
+
+            prop2b_c(_gm, _pvinit, _dt, _pvprop);
+
+            // Bad gm or a degenerate state fails every element the same way,
+            // so stop at the first failure.
+            if (failed_c())
+            {
+                break;
+            }
+
+            Result.CopyFrom(i, _pvprop);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            // As the scalar wrapper:  zeroed output on failure
+            pvprop = FSStateVectorBuffer(Count);
+            return;
+        }
+
+        pvprop = MoveTemp(Result);
+    }
+
+    SPICE_API void SwizzlePositions(TArray<FVector>& positions, const FSStateVectorBuffer& states)
+    {
+        const int32 Count = states.Num();
+        positions.SetNumUninitialized(Count);
+
+        for (int32 i = 0; i < Count; ++i)
+        {
+            positions[i] = FVector((FVector::FReal)states.y[i], (FVector::FReal)states.x[i], (FVector::FReal)states.z[i]);
+        }
+    }
+
+    SPICE_API void SwizzleVelocities(TArray<FVector>& velocities, const FSStateVectorBuffer& states)
+    {
+        const int32 Count = states.Num();
+        velocities.SetNumUninitialized(Count);
+
+        for (int32 i = 0; i < Count; ++i)
+        {
+            velocities[i] = FVector((FVector::FReal)states.dy[i], (FVector::FReal)states.dx[i], (FVector::FReal)states.dz[i]);
+        }
+    }
 }
@@ -0,0 +1,691 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePasses.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Ground station pass prediction for large satellite catalogs
+//
+// With rho the satellite's position from the station, d = |rho| and U the
+// station's vertical, the search works on sin(elevation) rather than the
+// elevation (same roots, same extrema, no asin):
+//
+//   e  = (rho . U) / d
+//   e' = ((v . U) - e (rho . v) / d) / d
+//
+// The screen evaluates both at every sample, for a block of satellites at a
+// time, in straight-line loops over the catalog's structure-of-arrays
+// states.  An interval is refined only if e - sin(MinElevation) changes sign
+// across it, or e' does (an extremum, which may be a pass too short to
+// straddle a sample, or a dip below the minimum between two up samples).
+//
+// Refinement splits the interval at the extremum (the root of e'), then
+// finds each crossing of the minimum in the pieces, in time order, so rises,
+// culminations & sets come out in sequence for each satellite.  Samples are
+// exact, and the Hermite interpolant matches their positions & velocities,
+// so the roots bracket with the screen's own values.
+//
+// Tasks are blocks of SatellitesPerTask satellites, a station at a time;
+// their passes are merged & sorted afterwards.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePasses.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpicePasses.h"
+#include "Async/ParallelFor.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using MaxQ::Core::ToANSIString;
+    using namespace MaxQ::Passes;
+
+    bool BodyFrame(FName& Frame, const FName& body, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        SpiceInt _frcode = 0;
+        SpiceChar _frname[SPICE_MAX_PATH];
+        SpiceBoolean _found = SPICEFALSE;
+        cnmfrm_c(ToANSIString(body), sizeof(_frname), &_frcode, _frname, &_found);
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        if (!_found)
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("No body-fixed frame for %s"), *body.ToString());
+            return false;
+        }
+        Frame = FName(_frname);
+        return true;
+    }
+
+    bool MakeStationAt(FGroundStation& Station, const FName& name, const FName& body, const FSAngle& MinElevation, const TFunctionRef<void(double re, double f, double(&rectan)[3])>& Rectangular, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        FSDistanceVector Radii;
+        MaxQ::Data::Bodvrd(Radii, body, FName(TEXT("RADII")), ResultCode, ErrorMessage);
+        if (*ResultCode != ES_ResultCode::Success)
+        {
+            return false;
+        }
+
+        const double re = Radii.x.km;
+        const double f = re > 0. ? (re - Radii.z.km) / re : 0.;
+
+        // The geodetic latitude & longitude give the ellipsoid's normal
+        SpiceDouble _rectan[3] = { 0., 0., 0. };
+        SpiceDouble _lon = 0., _lat = 0., _alt = 0.;
+        Rectangular(re, f, _rectan);
+        recgeo_c(_rectan, re, f, &_lon, &_lat, &_alt);
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        Station.Name = name;
+        Station.Position = FVector3d(_rectan[0], _rectan[1], _rectan[2]);
+        Station.Up = FVector3d(FMath::Cos(_lat) * FMath::Cos(_lon), FMath::Cos(_lat) * FMath::Sin(_lon), FMath::Sin(_lat));
+        Station.MinElevation = MinElevation.AsSpiceDouble();
+        return true;
+    }
+
+    // Samples from First through Last, evenly spaced no more than Step apart
+    bool MakeGrid(FSatelliteCatalog& Catalog, int32 Satellites, const FSEphemerisTime& First, const FSEphemerisTime& Last, const FSEphemerisPeriod& Step, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        const double et0 = First.AsSpiceDouble(), et1 = Last.AsSpiceDouble(), h = Step.AsSpiceDouble();
+        if (!(et1 > et0) || !(h > 0.))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Catalog needs Last after First, and a positive Step");
+            return false;
+        }
+
+        const int32 Intervals = FMath::Max(1, (int32)FMath::CeilToDouble((et1 - et0) / h));
+        Catalog.Init(Satellites, et0, (et1 - et0) / Intervals, Intervals + 1);
+        return true;
+    }
+
+    struct FElevation
+    {
+        double Px, Py, Pz;
+        double Ux, Uy, Uz;
+        double SinMin;
+
+        explicit FElevation(const FGroundStation& Station)
+            : Px(Station.Position.X), Py(Station.Position.Y), Pz(Station.Position.Z)
+            , Ux(Station.Up.X), Uy(Station.Up.Y), Uz(Station.Up.Z)
+            , SinMin(FMath::Sin(Station.MinElevation))
+        {
+        }
+
+        // sin(elevation) - sin(MinElevation), and its rate
+        void operator()(const double(&State)[6], double& F, double& D) const
+        {
+            const double rx = State[0] - Px, ry = State[1] - Py, rz = State[2] - Pz;
+            const double InvD = 1. / FMath::Sqrt(rx * rx + ry * ry + rz * rz);
+            const double e = (rx * Ux + ry * Uy + rz * Uz) * InvD;
+            F = e - SinMin;
+            D = ((State[3] * Ux + State[4] * Uy + State[5] * Uz) - e * (rx * State[3] + ry * State[4] + rz * State[5]) * InvD) * InvD;
+        }
+
+        // The screen:  Num satellites from Begin, at one sample
+        void operator()(const FSStateVectorBuffer& States, int32 Begin, int32 Num, double* F, double* D) const
+        {
+            const double* X = States.x.GetData() + Begin;
+            const double* Y = States.y.GetData() + Begin;
+            const double* Z = States.z.GetData() + Begin;
+            const double* DX = States.dx.GetData() + Begin;
+            const double* DY = States.dy.GetData() + Begin;
+            const double* DZ = States.dz.GetData() + Begin;
+
+            for (int32 j = 0; j < Num; ++j)
+            {
+                const double rx = X[j] - Px, ry = Y[j] - Py, rz = Z[j] - Pz;
+                const double InvD = 1. / FMath::Sqrt(rx * rx + ry * ry + rz * rz);
+                const double e = (rx * Ux + ry * Uy + rz * Uz) * InvD;
+                F[j] = e - SinMin;
+                D[j] = ((DX[j] * Ux + DY[j] * Uy + DZ[j] * Uz) - e * (rx * DX[j] + ry * DY[j] + rz * DZ[j]) * InvD) * InvD;
+            }
+        }
+    };
+
+    // Brent's method for a root of Function in [a, b], given f(a) & f(b) of
+    // opposite signs (or zero)
+    template<typename FunctionType>
+    double Brent(const FunctionType& Function, double a, double b, double fa, double fb, double Tolerance, int32 MaxIterations)
+    {
+        if (fa == 0.) return a;
+        if (fb == 0.) return b;
+
+        double c = a, fc = fa, d = b - a, e = d;
+        for (int32 Iteration = 0; Iteration < MaxIterations; ++Iteration)
+        {
+            if ((fb > 0.) == (fc > 0.))
+            {
+                c = a; fc = fa; d = b - a; e = d;
+            }
+            if (FMath::Abs(fc) < FMath::Abs(fb))
+            {
+                a = b; b = c; c = a;
+                fa = fb; fb = fc; fc = fa;
+            }
+
+            const double Tol = 2. * DBL_EPSILON * FMath::Abs(b) + .5 * Tolerance;
+            const double m = .5 * (c - b);
+            if (FMath::Abs(m) <= Tol || fb == 0.)
+            {
+                break;
+            }
+
+            if (FMath::Abs(e) >= Tol && FMath::Abs(fa) > FMath::Abs(fb))
+            {
+                // Inverse quadratic interpolation, or secant
+                double p, q;
+                const double s = fb / fa;
+                if (a == c)
+                {
+                    p = 2. * m * s;
+                    q = 1. - s;
+                }
+                else
+                {
+                    const double r = fb / fc;
+                    const double t = fa / fc;
+                    p = s * (2. * m * t * (t - r) - (b - a) * (r - 1.));
+                    q = (t - 1.) * (r - 1.) * (s - 1.);
+                }
+                if (p > 0.) q = -q; else p = -p;
+
+                if (2. * p < FMath::Min(3. * m * q - FMath::Abs(Tol * q), FMath::Abs(e * q)))
+                {
+                    e = d;
+                    d = p / q;
+                }
+                else
+                {
+                    d = m; e = m;
+                }
+            }
+            else
+            {
+                d = m; e = m;
+            }
+
+            a = b;
+            fa = fb;
+            b += FMath::Abs(d) > Tol ? d : (m > 0. ? Tol : -Tol);
+            fb = Function(b);
+        }
+        return b;
+    }
+
+    // A satellite's pass in progress
+    struct FOpenPass
+    {
+        FPass Pass;
+        double MaxSine = 0.;                        // sin(elevation) - sin(MinElevation)
+        bool bOpen = false;
+    };
+
+    struct FTaskResult
+    {
+        TArray<FPass> Passes;
+        int64 Refined = 0;
+        int64 Evaluations = 0;
+    };
+
+    void OpenPass(FOpenPass& Open, int32 Satellite, int32 Station, double et, double F, bool bRise)
+    {
+        Open.bOpen = true;
+        Open.Pass = FPass();
+        Open.Pass.Satellite = Satellite;
+        Open.Pass.Station = Station;
+        Open.Pass.Rise = et;
+        Open.Pass.bRise = bRise;
+        Open.Pass.Culmination = et;
+        Open.MaxSine = F;
+    }
+
+    void PeakPass(FOpenPass& Open, double et, double F)
+    {
+        if (Open.bOpen && F > Open.MaxSine)
+        {
+            Open.Pass.Culmination = et;
+            Open.MaxSine = F;
+        }
+    }
+
+    void ClosePass(FOpenPass& Open, double et, double F, bool bSet, double SinMin, TArray<FPass>& Passes)
+    {
+        if (!Open.bOpen)
+        {
+            return;
+        }
+        PeakPass(Open, et, F);
+        Open.Pass.Set = et;
+        Open.Pass.bSet = bSet;
+        Open.Pass.MaxElevation = FMath::Asin(FMath::Clamp(Open.MaxSine + SinMin, -1., 1.));
+        Passes.Add(Open.Pass);
+        Open.bOpen = false;
+    }
+}
+
+
+namespace MaxQ::Passes
+{
+    bool MakeStation(
+        FGroundStation& Station,
+        const FName& name,
+        const FName& body,
+        const FSGeodeticVector& location,
+        const FSAngle& MinElevation,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Passes::MakeStation, name, body, nullptr);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        return MakeStationAt(Station, name, body, MinElevation, [&](double re, double f, double(&rectan)[3])
+        {
+            georec_c(location.lonlat.longitude.AsSpiceDouble(), location.lonlat.latitude.AsSpiceDouble(), location.alt.AsSpiceDouble(), re, f, rectan);
+        }, ResultCode, ErrorMessage);
+    }
+
+    bool MakeStation(
+        FGroundStation& Station,
+        const FName& name,
+        const FName& body,
+        const FSPlanetographicVector& location,
+        const FSAngle& MinElevation,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Passes::MakeStation, name, body, nullptr);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        return MakeStationAt(Station, name, body, MinElevation, [&](double re, double f, double(&rectan)[3])
+        {
+            pgrrec_c(ToANSIString(body), location.lonlat.longitude.AsSpiceDouble(), location.lonlat.latitude.AsSpiceDouble(), location.alt.AsSpiceDouble(), re, f, rectan);
+        }, ResultCode, ErrorMessage);
+    }
+
+    void FSatelliteCatalog::Init(int32 Satellites, double First, double _Step, int32 Times)
+    {
+        Start = First;
+        Step = _Step;
+        Samples.SetNum(Times);
+        for (FSStateVectorBuffer& States : Samples)
+        {
+            States.SetNum(Satellites);
+        }
+    }
+
+    void FSatelliteCatalog::Evaluate(int32 Satellite, double et, double(&State)[6]) const
+    {
+        const int32 Count = Samples.Num();
+        if (Count < 2 || !(Step > 0.))
+        {
+            Samples[0].CopyTo(Satellite, State);
+            return;
+        }
+
+        const double u = FMath::Clamp((et - Start) / Step, 0., (double)(Count - 1));
+        const int32 k = FMath::Min((int32)u, Count - 2);
+        const double s = u - k, s2 = s * s, s3 = s2 * s;
+        const double h = Step;
+
+        const FSStateVectorBuffer& A = Samples[k];
+        const FSStateVectorBuffer& B = Samples[k + 1];
+        const int32 i = Satellite;
+
+        // Cubic Hermite basis, and its derivatives in s
+        const double h00 = 2. * s3 - 3. * s2 + 1., h10 = (s3 - 2. * s2 + s) * h, h01 = 3. * s2 - 2. * s3, h11 = (s3 - s2) * h;
+        const double d00 = (6. * s2 - 6. * s) / h, d10 = 3. * s2 - 4. * s + 1., d01 = -d00, d11 = 3. * s2 - 2. * s;
+
+        State[0] = h00 * A.x[i] + h10 * A.dx[i] + h01 * B.x[i] + h11 * B.dx[i];
+        State[1] = h00 * A.y[i] + h10 * A.dy[i] + h01 * B.y[i] + h11 * B.dy[i];
+        State[2] = h00 * A.z[i] + h10 * A.dz[i] + h01 * B.z[i] + h11 * B.dz[i];
+        State[3] = d00 * A.x[i] + d10 * A.dx[i] + d01 * B.x[i] + d11 * B.dx[i];
+        State[4] = d00 * A.y[i] + d10 * A.dy[i] + d01 * B.y[i] + d11 * B.dy[i];
+        State[5] = d00 * A.z[i] + d10 * A.dz[i] + d01 * B.z[i] + d11 * B.dz[i];
+    }
+
+    bool SampleCatalog(
+        FSatelliteCatalog& Catalog,
+        const TArray<FName>& satellites,
+        const FName& body,
+        const FName& frame,
+        const FSEphemerisTime& First,
+        const FSEphemerisTime& Last,
+        const FSEphemerisPeriod& Step,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Passes::SampleCatalog, nullptr, body, frame);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        FName Frame = frame;
+        if (Frame == NAME_None && !BodyFrame(Frame, body, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        if (!MakeGrid(Catalog, satellites.Num(), First, Last, Step, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        Catalog.Body = body;
+        Catalog.Frame = Frame;
+        Catalog.Names = satellites;
+
+        // A satellite at a time, so its segment stays in SPICE's buffers
+        const ANSICHAR* _frame = ToANSIString(Frame);
+        const ANSICHAR* _body = ToANSIString(body);
+        for (int32 i = 0; i < satellites.Num() && !failed_c(); ++i)
+        {
+            const ANSICHAR* _target = ToANSIString(satellites[i]);
+            for (int32 k = 0; k < Catalog.Times() && !failed_c(); ++k)
+            {
+                SpiceDouble _state[6], _lt = 0.;
+                spkezr_c(_target, Catalog.Start + k * Catalog.Step, _frame, "NONE", _body, _state, &_lt);
+                Catalog.Samples[k].CopyFrom(i, _state);
+            }
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+    bool SampleTrajectories(
+        FSatelliteCatalog& Catalog,
+        const TArray<MaxQ::Propagator::FTrajectory>& Trajectories,
+        const FName& body,
+        const FName& frame,
+        const FSEphemerisTime& First,
+        const FSEphemerisTime& Last,
+        const FSEphemerisPeriod& Step,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Passes::SampleTrajectories, nullptr, body, frame);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        const FName Inertial = Trajectories.Num() ? Trajectories[0].Frame : NAME_None;
+        for (const MaxQ::Propagator::FTrajectory& Trajectory : Trajectories)
+        {
+            if (Trajectory.Center != body || Trajectory.Frame != Inertial || Trajectory.First() > First.AsSpiceDouble() || Trajectory.Last() < Last.AsSpiceDouble())
+            {
+                *ResultCode = ES_ResultCode::Error;
+                *ErrorMessage = FString::Printf(TEXT("Trajectories must be relative to %s, in one frame, and cover the catalog's times"), *body.ToString());
+                return false;
+            }
+        }
+
+        FName Frame = frame;
+        if (Frame == NAME_None && !BodyFrame(Frame, body, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        if (!MakeGrid(Catalog, Trajectories.Num(), First, Last, Step, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        Catalog.Body = body;
+        Catalog.Frame = Frame;
+        Catalog.Names.Reset();
+
+        if (Trajectories.Num() == 0)
+        {
+            *ResultCode = ES_ResultCode::Success;
+            ErrorMessage->Empty();
+            return true;
+        }
+
+        // One state transformation per sample
+        TArray<double> Transforms;
+        Transforms.SetNumUninitialized(36 * Catalog.Times());
+        const ANSICHAR* _from = ToANSIString(Inertial);
+        const ANSICHAR* _to = ToANSIString(Frame);
+        for (int32 k = 0; k < Catalog.Times() && !failed_c(); ++k)
+        {
+            sxform_c(_from, _to, Catalog.Start + k * Catalog.Step, (SpiceDouble(*)[6]) &Transforms[36 * k]);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        ParallelFor(Catalog.Times(), [&](int32 k)
+        {
+            const double et = Catalog.Start + k * Catalog.Step;
+            const double* M = &Transforms[36 * k];
+            FSStateVectorBuffer& States = Catalog.Samples[k];
+
+            for (int32 i = 0; i < Trajectories.Num(); ++i)
+            {
+                double In[6], Out[6];
+                Trajectories[i].Evaluate(et, In);
+                for (int32 Row = 0; Row < 6; ++Row)
+                {
+                    const double* m = M + 6 * Row;
+                    Out[Row] = m[0] * In[0] + m[1] * In[1] + m[2] * In[2] + m[3] * In[3] + m[4] * In[4] + m[5] * In[5];
+                }
+                States.CopyFrom(i, Out);
+            }
+        });
+
+        return true;
+    }
+
+    bool Predict(
+        TArray<FPass>& Passes,
+        const FSatelliteCatalog& Catalog,
+        const TArray<FGroundStation>& Stations,
+        const FPassSettings& Settings,
+        FPassStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Passes::Predict);
+
+        // Any thread:  no error gutter
+        ES_ResultCode LocalResultCode;
+        FString LocalErrorMessage;
+        if (!ResultCode) ResultCode = &LocalResultCode;
+        if (!ErrorMessage) ErrorMessage = &LocalErrorMessage;
+
+        FPassStats LocalStats;
+        if (!Stats) Stats = &LocalStats;
+        *Stats = FPassStats();
+
+        const double StartSeconds = FPlatformTime::Seconds();
+        Passes.Reset();
+
+        const int32 Times = Catalog.Times();
+        const int32 Satellites = Catalog.Num();
+        bool bValid = Times >= 2 && Catalog.Step > 0. && Settings.Tolerance > 0.;
+        for (int32 k = 0; k < Times && bValid; ++k)
+        {
+            bValid = Catalog.Samples[k].Num() == Satellites;
+        }
+        if (!bValid)
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Pass prediction needs a catalog of two or more samples (each of every satellite), a positive Step, and a positive Tolerance");
+            return false;
+        }
+
+        const int32 SatellitesPerTask = FMath::Max(1, Settings.SatellitesPerTask);
+        const int32 Tasks = FMath::DivideAndRoundUp(Satellites, SatellitesPerTask);
+
+        TArray<FTaskResult> Results;
+        Results.SetNum(Tasks);
+
+        ParallelFor(Tasks, [&](int32 Task)
+        {
+            FTaskResult& Result = Results[Task];
+            const int32 Begin = Task * SatellitesPerTask;
+            const int32 Num = FMath::Min(SatellitesPerTask, Satellites - Begin);
+
+            // sin(elevation) - sin(minimum) & its rate, at the previous &
+            // current samples
+            TArray<double> F0, D0, F1, D1;
+            F0.SetNumUninitialized(Num);
+            D0.SetNumUninitialized(Num);
+            F1.SetNumUninitialized(Num);
+            D1.SetNumUninitialized(Num);
+            TArray<FOpenPass> Pending;
+
+            for (int32 StationIndex = 0; StationIndex < Stations.Num(); ++StationIndex)
+            {
+                const FElevation Elevation(Stations[StationIndex]);
+                Pending.Reset();
+                Pending.SetNum(Num);
+
+                Elevation(Catalog.Samples[0], Begin, Num, F0.GetData(), D0.GetData());
+                for (int32 j = 0; j < Num; ++j)
+                {
+                    if (F0[j] >= 0.)
+                    {
+                        OpenPass(Pending[j], Begin + j, StationIndex, Catalog.Start, F0[j], false);
+                    }
+                }
+
+                for (int32 k = 1; k < Times; ++k)
+                {
+                    Elevation(Catalog.Samples[k], Begin, Num, F1.GetData(), D1.GetData());
+
+                    const double t0 = Catalog.Start + (k - 1) * Catalog.Step;
+                    const double t1 = Catalog.Start + k * Catalog.Step;
+
+                    for (int32 j = 0; j < Num; ++j)
+                    {
+                        const bool bUp0 = F0[j] >= 0., bUp1 = F1[j] >= 0.;
+                        const bool bPeak = D0[j] > 0. && D1[j] < 0.;
+                        const bool bTrough = D0[j] < 0. && D1[j] > 0.;
+                        if (bUp0 == bUp1 && !bPeak && !(bTrough && bUp0))
+                        {
+                            continue;
+                        }
+
+                        ++Result.Refined;
+                        const int32 Satellite = Begin + j;
+                        double State[6];
+                        const auto Sine = [&](double et)
+                        {
+                            double F, D;
+                            ++Result.Evaluations;
+                            Catalog.Evaluate(Satellite, et, State);
+                            Elevation(State, F, D);
+                            return F;
+                        };
+                        const auto Rate = [&](double et)
+                        {
+                            double F, D;
+                            ++Result.Evaluations;
+                            Catalog.Evaluate(Satellite, et, State);
+                            Elevation(State, F, D);
+                            return D;
+                        };
+
+                        // Split at the extremum, if any
+                        double Bounds[3] = { t0, t1, t1 };
+                        double Values[3] = { F0[j], F1[j], F1[j] };
+                        int32 Pieces = 1;
+                        if (bPeak || bTrough)
+                        {
+                            const double te = Brent(Rate, t0, t1, D0[j], D1[j], Settings.Tolerance, Settings.MaxIterations);
+                            Bounds[1] = te;
+                            Values[1] = Sine(te);
+                            Pieces = 2;
+                        }
+
+                        for (int32 Piece = 0; Piece < Pieces; ++Piece)
+                        {
+                            const double ta = Bounds[Piece], tb = Bounds[Piece + 1];
+                            const double fa = Values[Piece], fb = Values[Piece + 1];
+                            if (fa < 0. && fb >= 0.)
+                            {
+                                const double Rise = Brent(Sine, ta, tb, fa, fb, Settings.Tolerance, Settings.MaxIterations);
+                                OpenPass(Pending[j], Satellite, StationIndex, Rise, 0., true);
+                            }
+                            else if (fa >= 0. && fb < 0.)
+                            {
+                                const double Set = Brent(Sine, ta, tb, fa, fb, Settings.Tolerance, Settings.MaxIterations);
+                                ClosePass(Pending[j], Set, 0., true, Elevation.SinMin, Result.Passes);
+                            }
+
+                            if (Piece == 0 && bPeak)
+                            {
+                                PeakPass(Pending[j], Bounds[1], Values[1]);
+                            }
+                        }
+                    }
+
+                    Swap(F0, F1);
+                    Swap(D0, D1);
+                }
+
+                for (int32 j = 0; j < Num; ++j)
+                {
+                    ClosePass(Pending[j], Catalog.Last(), F0[j], false, Elevation.SinMin, Result.Passes);
+                }
+            }
+        });
+
+        for (FTaskResult& Result : Results)
+        {
+            Passes.Append(Result.Passes);
+            Stats->Refined += Result.Refined;
+            Stats->Evaluations += Result.Evaluations;
+        }
+
+        Passes.Sort([](const FPass& A, const FPass& B)
+        {
+            if (A.Rise != B.Rise) return A.Rise < B.Rise;
+            if (A.Station != B.Station) return A.Station < B.Station;
+            return A.Satellite < B.Satellite;
+        });
+
+        Stats->Screened = (int64)Times * Satellites * Stations.Num();
+        Stats->Passes = Passes.Num();
+        Stats->Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+        return true;
+    }
+}
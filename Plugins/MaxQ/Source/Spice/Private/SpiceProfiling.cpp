@@ -0,0 +1,386 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceProfiling.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Where does SPICE time go?
+//
+// A scope costs two channel checks and a stat scope when nobody's looking.
+// Capture totals are keyed by call site + tags and kept in one map behind a
+// critical section; the lock is only taken while a capture window is open.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceProfiling.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceProfiling.h"
+#include "SpiceLog.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/StringBuilder.h"
+
+#if MAXQ_SPICE_PROFILING
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(MaxQSpiceChannel);
+
+DEFINE_STAT(STAT_MaxQSpiceCalls);
+DEFINE_STAT(STAT_MaxQSpiceErrors);
+#endif
+
+namespace MaxQ::Profiling
+{
+#if MAXQ_SPICE_PROFILING
+    namespace
+    {
+        struct FCaptureKey
+        {
+            const FCallSite* Site;
+            FString Target;
+            FString Observer;
+            FString Frame;
+
+            bool operator==(const FCaptureKey& Other) const
+            {
+                return Site == Other.Site && Target == Other.Target && Observer == Other.Observer && Frame == Other.Frame;
+            }
+
+            friend uint32 GetTypeHash(const FCaptureKey& Key)
+            {
+                return HashCombine(HashCombine(PointerHash(Key.Site), GetTypeHash(Key.Target)), HashCombine(GetTypeHash(Key.Observer), GetTypeHash(Key.Frame)));
+            }
+        };
+
+        struct FCaptureTotals
+        {
+            int64 Calls = 0;
+            int64 Errors = 0;
+            uint64 Cycles = 0;
+        };
+
+        struct FCapture
+        {
+            std::atomic<bool> bCapturing { false };
+            FCriticalSection Lock;
+            TMap<FCaptureKey, FCaptureTotals> Totals;
+            double StartSeconds = 0.;
+            double StopSeconds = 0.;
+
+            static FCapture& Get()
+            {
+                static FCapture Capture;
+                return Capture;
+            }
+        };
+
+        thread_local FCallScope* CurrentCallScope = nullptr;
+
+        inline bool IsTraceEnabled()
+        {
+#if CPUPROFILERTRACE_ENABLED
+            return UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel | MaxQSpiceChannel);
+#else
+            return false;
+#endif
+        }
+    }
+
+
+    FCallSite::FCallSite(const TCHAR* _Name)
+        : Name(_Name)
+    {
+#if STATS
+        StatId = FDynamicStats::CreateStatId<FStatGroup_STATGROUP_MaxQSpice>(FString(Name));
+        ErrorsStatName = FDynamicStats::CreateStatIdInt64<FStatGroup_STATGROUP_MaxQSpice>(FString(Name) + TEXT(" errors")).GetName();
+#endif
+    }
+
+
+    uint32 FCallSite::GetTraceSpecId()
+    {
+        uint32 SpecId = TraceSpecId.load(std::memory_order_relaxed);
+#if CPUPROFILERTRACE_ENABLED
+        if (!SpecId)
+        {
+            // Racing threads may both register it, which is harmless
+            SpecId = FCpuProfilerTrace::OutputEventType(Name);
+            TraceSpecId.store(SpecId, std::memory_order_relaxed);
+        }
+#endif
+        return SpecId;
+    }
+
+
+    bool FCallScope::WantsTags()
+    {
+        return FCapture::Get().bCapturing.load(std::memory_order_relaxed) || IsTraceEnabled();
+    }
+
+
+    void FCallScope::Begin()
+    {
+        OuterScope = CurrentCallScope;
+        CurrentCallScope = this;
+
+        INC_DWORD_STAT(STAT_MaxQSpiceCalls);
+
+#if CPUPROFILERTRACE_ENABLED
+        if (IsTraceEnabled())
+        {
+            bTraced = true;
+            if (Target.IsEmpty() && Observer.IsEmpty() && Frame.IsEmpty())
+            {
+                FCpuProfilerTrace::OutputBeginEvent(Site.GetTraceSpecId());
+            }
+            else
+            {
+                FCpuProfilerTrace::OutputBeginDynamicEvent(*FString::Printf(TEXT("%s %s/%s/%s"), Site.Name, *Target, *Observer, *Frame));
+            }
+        }
+#endif
+
+        if (FCapture::Get().bCapturing.load(std::memory_order_relaxed))
+        {
+            StartCycles = FPlatformTime::Cycles64();
+        }
+    }
+
+
+    void FCallScope::End()
+    {
+        const uint64 EndCycles = StartCycles ? FPlatformTime::Cycles64() : 0;
+
+#if CPUPROFILERTRACE_ENABLED
+        if (bTraced)
+        {
+            FCpuProfilerTrace::OutputEndEvent();
+        }
+#endif
+
+        check(CurrentCallScope == this);
+        CurrentCallScope = OuterScope;
+
+        if (bFailed)
+        {
+            INC_DWORD_STAT(STAT_MaxQSpiceErrors);
+#if STATS
+            INC_DWORD_STAT_FNAME_BY(Site.ErrorsStatName, 1);
+#endif
+        }
+
+        FCapture& Capture = FCapture::Get();
+        if (StartCycles && Capture.bCapturing.load(std::memory_order_relaxed))
+        {
+            FScopeLock Lock(&Capture.Lock);
+
+            FCaptureTotals& Totals = Capture.Totals.FindOrAdd(FCaptureKey { &Site, MoveTemp(Target), MoveTemp(Observer), MoveTemp(Frame) });
+            ++Totals.Calls;
+            Totals.Errors += bFailed ? 1 : 0;
+            Totals.Cycles += EndCycles - StartCycles;
+        }
+    }
+
+
+    void FCallScope::NoteError()
+    {
+        if (CurrentCallScope)
+        {
+            CurrentCallScope->bFailed = true;
+        }
+    }
+
+
+    SPICE_API void StartCapture()
+    {
+        FCapture& Capture = FCapture::Get();
+
+        FScopeLock Lock(&Capture.Lock);
+        Capture.Totals.Reset();
+        Capture.StartSeconds = FPlatformTime::Seconds();
+        Capture.StopSeconds = 0.;
+        Capture.bCapturing = true;
+    }
+
+
+    SPICE_API void StopCapture()
+    {
+        FCapture& Capture = FCapture::Get();
+
+        FScopeLock Lock(&Capture.Lock);
+        if (Capture.bCapturing)
+        {
+            Capture.bCapturing = false;
+            Capture.StopSeconds = FPlatformTime::Seconds();
+        }
+    }
+
+
+    SPICE_API bool IsCapturing()
+    {
+        return FCapture::Get().bCapturing;
+    }
+
+
+    SPICE_API TArray<FCallStats> GetCapture()
+    {
+        FCapture& Capture = FCapture::Get();
+        TArray<FCallStats> Rows;
+
+        {
+            FScopeLock Lock(&Capture.Lock);
+
+            // Template functions have a call site per instantiation, merge them by name
+            TMap<FString, int32> RowIndices;
+            for (const auto& [Key, Totals] : Capture.Totals)
+            {
+                const FString RowKey = FString::Printf(TEXT("%s|%s|%s|%s"), Key.Site->Name, *Key.Target, *Key.Observer, *Key.Frame);
+                int32* RowIndex = RowIndices.Find(RowKey);
+                if (!RowIndex)
+                {
+                    RowIndex = &RowIndices.Add(RowKey, Rows.Num());
+                    FCallStats& Row = Rows.AddDefaulted_GetRef();
+                    Row.Function = Key.Site->Name;
+                    Row.Target = Key.Target;
+                    Row.Observer = Key.Observer;
+                    Row.Frame = Key.Frame;
+                }
+
+                FCallStats& Row = Rows[*RowIndex];
+                Row.Calls += Totals.Calls;
+                Row.Errors += Totals.Errors;
+                Row.InclusiveSeconds += FPlatformTime::ToSeconds64(Totals.Cycles);
+            }
+        }
+
+        Rows.Sort([](const FCallStats& A, const FCallStats& B) { return A.InclusiveSeconds > B.InclusiveSeconds; });
+
+        return Rows;
+    }
+
+
+    static void AppendCsvField(FStringBuilderBase& sb, const FString& Field)
+    {
+        int32 Index;
+        if (Field.FindChar(TEXT(','), Index) || Field.FindChar(TEXT('"'), Index))
+        {
+            sb << TEXT('"') << Field.Replace(TEXT("\""), TEXT("\"\"")) << TEXT('"');
+        }
+        else
+        {
+            sb << Field;
+        }
+    }
+
+
+    SPICE_API FString GetCaptureCsv(int32 MaxRows)
+    {
+        TArray<FCallStats> Rows = GetCapture();
+        if (MaxRows > 0 && Rows.Num() > MaxRows)
+        {
+            Rows.SetNum(MaxRows);
+        }
+
+        TStringBuilder<4096> sb;
+        sb << TEXT("Function,Target,Observer,Frame,Calls,InclusiveMs,MeanUs,Errors\n");
+
+        for (const FCallStats& Row : Rows)
+        {
+            AppendCsvField(sb, Row.Function); sb << TEXT(',');
+            AppendCsvField(sb, Row.Target); sb << TEXT(',');
+            AppendCsvField(sb, Row.Observer); sb << TEXT(',');
+            AppendCsvField(sb, Row.Frame); sb << TEXT(',');
+
+            const double MeanUs = Row.Calls ? 1e6 * Row.InclusiveSeconds / Row.Calls : 0.;
+            sb.Appendf(TEXT("%lld,%.3f,%.3f,%lld\n"), Row.Calls, 1e3 * Row.InclusiveSeconds, MeanUs, Row.Errors);
+        }
+
+        return FString(sb.ToString());
+    }
+
+
+    SPICE_API bool DumpCaptureCsv(FString& Path, int32 MaxRows)
+    {
+        const FString Directory = FPaths::Combine(FPaths::ProfilingDir(), TEXT("MaxQ"));
+        Path = FPaths::Combine(Directory, FString::Printf(TEXT("MaxQSpice-%s.csv"), *FDateTime::Now().ToString()));
+
+        return FFileHelper::SaveStringToFile(GetCaptureCsv(MaxRows), *Path);
+    }
+
+
+    namespace
+    {
+        void DumpCaptureCommand(const TArray<FString>& Args)
+        {
+            int32 MaxRows = 0;
+            if (Args.Num() > 0)
+            {
+                LexFromString(MaxRows, *Args[0]);
+            }
+
+            FCapture& Capture = FCapture::Get();
+            const double WindowSeconds = (Capture.bCapturing ? FPlatformTime::Seconds() : Capture.StopSeconds) - Capture.StartSeconds;
+
+            FString Path;
+            if (DumpCaptureCsv(Path, MaxRows))
+            {
+                UE_LOG(LogSpice, Log, TEXT("MaxQ Spice capture (%.2f s) written to %s"), WindowSeconds, *FPaths::ConvertRelativePathToFull(Path));
+            }
+            else
+            {
+                UE_LOG(LogSpice, Error, TEXT("MaxQ Spice capture could not be written to %s"), *Path);
+            }
+
+            TArray<FCallStats> Rows = GetCapture();
+            for (int32 i = 0; i < FMath::Min(Rows.Num(), 10); ++i)
+            {
+                const FCallStats& Row = Rows[i];
+                UE_LOG(LogSpice, Log, TEXT("  %8.3f ms %8lld calls %6lld errors  %s %s/%s/%s"), 1e3 * Row.InclusiveSeconds, Row.Calls, Row.Errors, *Row.Function, *Row.Target, *Row.Observer, *Row.Frame);
+            }
+        }
+
+        FAutoConsoleCommand StartCaptureCommand(
+            TEXT("MaxQ.Spice.Capture.Start"),
+            TEXT("Starts totaling MaxQ SPICE calls, discarding any previous capture"),
+            FConsoleCommandDelegate::CreateStatic(&StartCapture)
+        );
+
+        FAutoConsoleCommand StopCaptureCommand(
+            TEXT("MaxQ.Spice.Capture.Stop"),
+            TEXT("Stops totaling MaxQ SPICE calls"),
+            FConsoleCommandDelegate::CreateStatic(&StopCapture)
+        );
+
+        FAutoConsoleCommand DumpCaptureConsoleCommand(
+            TEXT("MaxQ.Spice.Capture.Dump"),
+            TEXT("Writes the MaxQ SPICE capture to Saved/Profiling/MaxQ as CSV, hottest calls first.  Optional arg: max rows"),
+            FConsoleCommandWithArgsDelegate::CreateStatic(&DumpCaptureCommand)
+        );
+    }
+
+#else
+
+    SPICE_API void StartCapture() {}
+    SPICE_API void StopCapture() {}
+    SPICE_API bool IsCapturing() { return false; }
+    SPICE_API TArray<FCallStats> GetCapture() { return TArray<FCallStats>(); }
+    SPICE_API FString GetCaptureCsv(int32 MaxRows) { return FString(); }
+    SPICE_API bool DumpCaptureCsv(FString& Path, int32 MaxRows) { Path.Empty(); return false; }
+
+#endif
+}
@@ -0,0 +1,1355 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePropagator.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Numerical propagation of spacecraft under perturbations
+//
+// A block's state is 6 arrays of N doubles (x, y, z, dx, dy, dz), and so is
+// each stage's derivative.  Stage sums & error norms are loops over all 6N
+// doubles;  the accelerations are a loop over the N spacecraft, with the
+// model's switches (harmonics, drag...) hoisted out of it.
+//
+// DOP853 is Hairer's (Solving Ordinary Differential Equations I), as SciPy
+// implements it:  12 stages & an FSAL derivative per step, the combined
+// 5th & 3rd order error estimate, step factors 0.9 * err^(-1/8) within
+// [0.2, 10], and no growth right after a rejection.  A block's error is its
+// worst spacecraft's.  Dense output costs 3 more stages per step, and is
+// stored per step as y0 & the 7 interpolant coefficients F0..F6:
+//   y(x) = y0 + x (F0 + (1-x) (F1 + x (F2 + (1-x) (F3 + x (F4 + (1-x) (F5 + x F6))))))
+// with x the fraction of the step.
+//
+// Forest-Ruth (4th order) alternates drifts x += c h v and kicks
+// v += d h a(x), with c = θ/2, (1-θ)/2, (1-θ)/2, θ/2 and d = θ, 1-2θ, θ,
+// θ = 1/(2 - 2^(1/3)).  The clock advances with the drifts.  Its dense
+// output stores position, velocity & acceleration at each step boundary
+// (one more acceleration per step) for quintic Hermite interpolation.
+//
+// Zonal harmonic n, with s = r^.k (k the pole) and Legendre P_n(s):
+//   a = GM J_n R^n / r^(n+2) [((n+1) P_n + s P_n') r^ - P_n' k]
+// Third body at Rb:  a = GM_b ((Rb - r)/|Rb - r|^3 - Rb/|Rb|^3)
+// Drag:  a = -1/2 (Cd A/m) ρ |v_rel| v_rel, v_rel = v - ω x r
+// Solar pressure:  a = P (Cr A/m) (1 AU / d)^2 d^, d from the sun, zero in
+// the center's cylindrical shadow.  The shadow's edge is a linear ramp as
+// wide as the sun's apparent diameter times the distance behind the center
+// (~60 km in LEO), a stand-in for the penumbra.  Crossings aren't located:
+// a step spanning one loses accuracy (meters a day in LEO, at 100 s steps).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePropagator.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpicePropagator.h"
+#include "Async/ParallelFor.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using MaxQ::Core::ToANSIString;
+    using namespace MaxQ::Propagator;
+
+    // DOP853 (Hairer's dop853.f, via SciPy's dop853_coefficients.py):  12
+    // stages, the FSAL derivative, and 3 more for dense output
+    constexpr int32 Stages = 16;
+    constexpr int32 StepStages = 12;
+
+    const double C[Stages] = {
+        0.0, 0.526001519587677318785587544488e-01, 0.789002279381515978178381316732e-01,
+        0.118350341907227396726757197510, 0.281649658092772603273242802490, 0.333333333333333333333333333333,
+        0.25, 0.307692307692307692307692307692, 0.651282051282051282051282051282,
+        0.6, 0.857142857142857142857142857142, 1.0,
+        1.0, 0.1, 0.2,
+        0.777777777777777777777777777778
+    };
+
+    // Leading entries of each row, the rest are zero;  row 12 is B
+    const double A[Stages][Stages] = {
+        {},
+        {
+            5.26001519587677318785587544488e-2
+        },
+        {
+            1.97250569845378994544595329183e-2, 5.91751709536136983633785987549e-2
+        },
+        {
+            2.95875854768068491816892993775e-2, 0., 8.87627564304205475450678981324e-2
+        },
+        {
+            2.41365134159266685502369798665e-1, 0., -8.84549479328286085344864962717e-1,
+            9.24834003261792003115737966543e-1
+        },
+        {
+            3.7037037037037037037037037037e-2, 0., 0.,
+            1.70828608729473871279604482173e-1, 1.25467687566822425016691814123e-1
+        },
+        {
+            3.7109375e-2, 0., 0.,
+            1.70252211019544039314978060272e-1, 6.02165389804559606850219397283e-2, -1.7578125e-2
+        },
+        {
+            3.70920001185047927108779319836e-2, 0., 0.,
+            1.70383925712239993810214054705e-1, 1.07262030446373284651809199168e-1, -1.53194377486244017527936158236e-2,
+            8.27378916381402288758473766002e-3
+        },
+        {
+            6.24110958716075717114429577812e-1, 0., 0.,
+            -3.36089262944694129406857109825, -8.68219346841726006818189891453e-1, 2.75920996994467083049415600797e1,
+            2.01540675504778934086186788979e1, -4.34898841810699588477366255144e1
+        },
+        {
+            4.77662536438264365890433908527e-1, 0., 0.,
+            -2.48811461997166764192642586468, -5.90290826836842996371446475743e-1, 2.12300514481811942347288949897e1,
+            1.52792336328824235832596922938e1, -3.32882109689848629194453265587e1, -2.03312017085086261358222928593e-2
+        },
+        {
+            -9.3714243008598732571704021658e-1, 0., 0.,
+            5.18637242884406370830023853209, 1.09143734899672957818500254654, -8.14978701074692612513997267357,
+            -1.85200656599969598641566180701e1, 2.27394870993505042818970056734e1, 2.49360555267965238987089396762,
+            -3.0467644718982195003823669022
+        },
+        {
+            2.27331014751653820792359768449, 0., 0.,
+            -1.05344954667372501984066689879e1, -2.00087205822486249909675718444, -1.79589318631187989172765950534e1,
+            2.79488845294199600508499808837e1, -2.85899827713502369474065508674, -8.87285693353062954433549289258,
+            1.23605671757943030647266201528e1, 6.43392746015763530355970484046e-1
+        },
+        {
+            5.42937341165687622380535766363e-2, 0., 0.,
+            0., 0., 4.45031289275240888144113950566,
+            1.89151789931450038304281599044, -5.8012039600105847814672114227, 3.1116436695781989440891606237e-1,
+            -1.52160949662516078556178806805e-1, 2.01365400804030348374776537501e-1, 4.47106157277725905176885569043e-2
+        },
+        {
+            5.61675022830479523392909219681e-2, 0., 0.,
+            0., 0., 0.,
+            2.53500210216624811088794765333e-1, -2.46239037470802489917441475441e-1, -1.24191423263816360469010140626e-1,
+            1.5329179827876569731206322685e-1, 8.20105229563468988491666602057e-3, 7.56789766054569976138603589584e-3,
+            -8.298e-3
+        },
+        {
+            3.18346481635021405060768473261e-2, 0., 0.,
+            0., 0., 2.83009096723667755288322961402e-2,
+            5.35419883074385676223797384372e-2, -5.49237485713909884646569340306e-2, 0.,
+            0., -1.08347328697249322858509316994e-4, 3.82571090835658412954920192323e-4,
+            -3.40465008687404560802977114492e-4, 1.41312443674632500278074618366e-1
+        },
+        {
+            -4.28896301583791923408573538692e-1, 0., 0.,
+            0., 0., -4.69762141536116384314449447206,
+            7.68342119606259904184240953878, 4.06898981839711007970213554331, 3.56727187455281109270669543021e-1,
+            0., 0., 0.,
+            -1.39902416515901462129418009734e-3, 2.9475147891527723389556272149, -9.15095847217987001081870187138
+        },
+    };
+
+    const double E5[12] = {
+        0.1312004499419488073250102996e-1, 0., 0.,
+        0., 0., -0.1225156446376204440720569753e+1,
+        -0.4957589496572501915214079952, 0.1664377182454986536961530415e+1, -0.3503288487499736816886487290,
+        0.3341791187130174790297318841, 0.8192320648511571246570742613e-1, -0.2235530786388629525884427845e-1
+    };
+
+    const double D[4][Stages] = {
+        {
+            -0.84289382761090128651353491142e+1, 0., 0.,
+            0., 0., 0.56671495351937776962531783590,
+            -0.30689499459498916912797304727e+1, 0.23846676565120698287728149680e+1, 0.21170345824450282767155149946e+1,
+            -0.87139158377797299206789907490, 0.22404374302607882758541771650e+1, 0.63157877876946881815570249290,
+            -0.88990336451333310820698117400e-1, 0.18148505520854727256656404962e+2, -0.91946323924783554000451984436e+1,
+            -0.44360363875948939664310572000e+1
+        },
+        {
+            0.10427508642579134603413151009e+2, 0., 0.,
+            0., 0., 0.24228349177525818288430175319e+3,
+            0.16520045171727028198505394887e+3, -0.37454675472269020279518312152e+3, -0.22113666853125306036270938578e+2,
+            0.77334326684722638389603898808e+1, -0.30674084731089398182061213626e+2, -0.93321305264302278729567221706e+1,
+            0.15697238121770843886131091075e+2, -0.31139403219565177677282850411e+2, -0.93529243588444783865713862664e+1,
+            0.35816841486394083752465898540e+2
+        },
+        {
+            0.19985053242002433820987653617e+2, 0., 0.,
+            0., 0., -0.38703730874935176555105901742e+3,
+            -0.18917813819516756882830838328e+3, 0.52780815920542364900561016686e+3, -0.11573902539959630126141871134e+2,
+            0.68812326946963000169666922661e+1, -0.10006050966910838403183860980e+1, 0.77771377980534432092869265740,
+            -0.27782057523535084065932004339e+1, -0.60196695231264120758267380846e+2, 0.84320405506677161018159903784e+2,
+            0.11992291136182789328035130030e+2
+        },
+        {
+            -0.25693933462703749003312586129e+2, 0., 0.,
+            0., 0., -0.15418974869023643374053993627e+3,
+            -0.23152937917604549567536039109e+3, 0.35763911791061412378285349910e+3, 0.93405324183624310003907691704e+2,
+            -0.37458323136451633156875139351e+2, 0.10409964950896230045147246184e+3, 0.29840293426660503123344363579e+2,
+            -0.43533456590011143754432175058e+2, 0.96324553959188282948394950600e+2, -0.39177261675615439165231486172e+2,
+            -0.14972683625798562581422125276e+3
+        },
+    };
+
+    // E3 is B, less these at stages 0, 8 & 11
+    const double E3Correction[3] = {
+        0.244094488188976377952755905512, 0.733846688281611857341361741547, 0.220588235294117647058823529412e-1
+    };
+
+    constexpr double Safety = 0.9;
+    constexpr double MinFactor = 0.2;
+    constexpr double MaxFactor = 10.;
+    constexpr double ErrorExponent = -1. / 8.;
+
+    // Per step:  y0 & F0..F6
+    constexpr int32 DenseSize = 48;
+
+    // Per time:  position, velocity, acceleration
+    constexpr int32 HermiteSize = 9;
+
+    // Forest-Ruth
+    const double Theta = 1. / (2. - 1.2599210498948731648);
+    const double Drift[4] = { Theta / 2., (1. - Theta) / 2., (1. - Theta) / 2., Theta / 2. };
+    const double Kick[3] = { Theta, 1. - 2. * Theta, Theta };
+
+    constexpr double AstronomicalUnit = 149597870.7;     // km
+
+    // Vallado, table 8-4
+    const FDensityBand EarthBands[] = {
+        {    0., 1.225,     7.249 }, {   25., 3.899e-2,  6.349 }, {   30., 1.774e-2,  6.682 }, {   40., 3.972e-3,  7.554 },
+        {   50., 1.057e-3,  8.382 }, {   60., 3.206e-4,  7.714 }, {   70., 8.770e-5,  6.549 }, {   80., 1.905e-5,  5.799 },
+        {   90., 3.396e-6,  5.382 }, {  100., 5.297e-7,  5.877 }, {  110., 9.661e-8,  7.263 }, {  120., 2.438e-8,  9.473 },
+        {  130., 8.484e-9, 12.636 }, {  140., 3.845e-9, 16.149 }, {  150., 2.070e-9, 22.523 }, {  180., 5.464e-10, 29.740 },
+        {  200., 2.789e-10, 37.105 }, {  250., 7.248e-11, 45.546 }, {  300., 2.418e-11, 53.628 }, {  350., 9.518e-12, 53.298 },
+        {  400., 3.725e-12, 58.515 }, {  450., 1.585e-12, 60.828 }, {  500., 6.967e-13, 63.822 }, {  600., 1.454e-13, 71.835 },
+        {  700., 3.614e-14, 88.667 }, {  800., 1.170e-14, 124.64 }, {  900., 5.245e-15, 181.05 }, { 1000., 3.019e-15, 268.00 }
+    };
+
+    // Cubic Hermite between two states, h apart, at fraction s
+    FVector3d Hermite(const double* State0, const double* State1, double h, double s)
+    {
+        const double s2 = s * s, s3 = s2 * s;
+        const double H00 = 2. * s3 - 3. * s2 + 1., H10 = (s3 - 2. * s2 + s) * h;
+        const double H01 = 3. * s2 - 2. * s3, H11 = (s3 - s2) * h;
+        return FVector3d(
+            H00 * State0[0] + H10 * State0[3] + H01 * State1[0] + H11 * State1[3],
+            H00 * State0[1] + H10 * State0[4] + H01 * State1[1] + H11 * State1[4],
+            H00 * State0[2] + H10 * State0[5] + H01 * State1[2] + H11 * State1[5]
+        );
+    }
+
+    bool IsFinite(const double* Values, int32 Num)
+    {
+        for (int32 e = 0; e < Num; ++e)
+        {
+            if (!FMath::IsFinite(Values[e]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+
+namespace MaxQ::Propagator
+{
+    struct FPropagator::FEnvironment
+    {
+        TArray<FVector3d, TInlineAllocator<8>> Positions;    // Bodies, relative to the center
+        FVector3d Pole = FVector3d::ZAxisVector;
+        FVector3d Spin = FVector3d::ZeroVector;             // rad/s
+    };
+
+
+    // One block of spacecraft, stepping together
+    struct FBlock
+    {
+        const FPropagator& Propagator;
+        const FIntegratorSettings& Settings;
+        const int32 N;
+        const double* Drag;
+        const double* Solar;
+        TArray<FTrajectory*, TInlineAllocator<64>> Trajectories;
+
+        TArray<double> Y;                                   // 6N
+        FPropagator::FEnvironment Environment;
+        double t = 0.;
+
+        int64 Steps = 0;
+        int64 RejectedSteps = 0;
+        int64 Evaluations = 0;
+        FString Error;
+
+        FBlock(const FPropagator& InPropagator, const FIntegratorSettings& InSettings, int32 InN, const double* InDrag, const double* InSolar)
+            : Propagator(InPropagator), Settings(InSettings), N(InN), Drag(InDrag), Solar(InSolar)
+        {
+            Y.SetNumUninitialized(6 * N);
+        }
+
+        void Derivatives(double et, const double* State, double* F)
+        {
+            Propagator.Sample(et, Environment);
+            Propagator.Derivatives(Environment, N, State, Drag, Solar, F);
+            Evaluations += N;
+        }
+
+        double Tolerance(int32 Component) const
+        {
+            return Component < 3 ? Settings.PositionTolerance : Settings.VelocityTolerance;
+        }
+
+        void AddTimes(double et)
+        {
+            for (FTrajectory* Trajectory : Trajectories)
+            {
+                Trajectory->Times.Add(et);
+            }
+        }
+
+        // SciPy's select_initial_step, per spacecraft, the smallest
+        double InitialStep(double Span, double MaxStep, const double* F0)
+        {
+            const double Direction = FMath::Sign(Span);
+            const double Interval = FMath::Abs(Span);
+
+            TArray<double> Scale, d0, d1;
+            Scale.SetNumUninitialized(6 * N);
+            d0.SetNumZeroed(N);
+            d1.SetNumZeroed(N);
+            for (int32 c = 0; c < 6; ++c)
+            {
+                for (int32 i = 0; i < N; ++i)
+                {
+                    const int32 e = c * N + i;
+                    Scale[e] = Tolerance(c) + FMath::Abs(Y[e]) * Settings.RelativeTolerance;
+                    d0[i] += FMath::Square(Y[e] / Scale[e]) / 6.;
+                    d1[i] += FMath::Square(F0[e] / Scale[e]) / 6.;
+                }
+            }
+
+            double h0 = Interval;
+            for (int32 i = 0; i < N; ++i)
+            {
+                d0[i] = FMath::Sqrt(d0[i]);
+                d1[i] = FMath::Sqrt(d1[i]);
+                h0 = FMath::Min(h0, d0[i] < 1e-5 || d1[i] < 1e-5 ? 1e-6 : 0.01 * d0[i] / d1[i]);
+            }
+
+            TArray<double> Y1, F1;
+            Y1.SetNumUninitialized(6 * N);
+            F1.SetNumUninitialized(6 * N);
+            for (int32 e = 0; e < 6 * N; ++e)
+            {
+                Y1[e] = Y[e] + h0 * Direction * F0[e];
+            }
+            Derivatives(t + h0 * Direction, Y1.GetData(), F1.GetData());
+
+            double h = FMath::Min(Interval, MaxStep);
+            for (int32 i = 0; i < N; ++i)
+            {
+                double d2 = 0.;
+                for (int32 c = 0; c < 6; ++c)
+                {
+                    const int32 e = c * N + i;
+                    d2 += FMath::Square((F1[e] - F0[e]) / Scale[e]) / 6.;
+                }
+                d2 = FMath::Sqrt(d2) / h0;
+
+                const double h1 = d1[i] <= 1e-15 && d2 <= 1e-15
+                    ? FMath::Max(1e-6, h0 * 1e-3)
+                    : FMath::Pow(0.01 / FMath::Max(d1[i], d2), 1. / 8.);
+                h = FMath::Min(h, FMath::Min(100. * h0, h1));
+            }
+            return h;
+        }
+
+        bool Dop853(double t1)
+        {
+            const double Direction = t1 >= t ? 1. : -1.;
+            const double MaxStep = Settings.MaxStep > 0. ? Settings.MaxStep : UE_DOUBLE_BIG_NUMBER;
+            const int32 Size = 6 * N;
+
+            TArray<double> K, Stage, Increment, YNew, Error3, Error5;
+            K.SetNumUninitialized(Stages * Size);
+            Stage.SetNumUninitialized(Size);
+            Increment.SetNumUninitialized(Size);
+            YNew.SetNumUninitialized(Size);
+            Error3.SetNumUninitialized(N);
+            Error5.SetNumUninitialized(N);
+            const auto KStage = [&](int32 s) { return K.GetData() + s * Size; };
+
+            Derivatives(t, Y.GetData(), KStage(0));
+            if (!IsFinite(KStage(0), Size))
+            {
+                Error = FString::Printf(TEXT("Non-finite acceleration, at %.3f"), t);
+                return false;
+            }
+            AddTimes(t);
+
+            if (t == t1)
+            {
+                // A zero-length step, so the trajectory still has the state
+                for (int32 i = 0; i < Trajectories.Num(); ++i)
+                {
+                    FTrajectory& Trajectory = *Trajectories[i];
+                    Trajectory.Times.Add(t);
+                    double* Dense = &Trajectory.Coefficients.AddZeroed_GetRef(DenseSize);
+                    for (int32 c = 0; c < 6; ++c)
+                    {
+                        Dense[c] = Y[c * N + i];
+                    }
+                }
+                return true;
+            }
+
+            double hAbs = Settings.InitialStep > 0. ? Settings.InitialStep : InitialStep(t1 - t, MaxStep, KStage(0));
+            bool bRejected = false;
+
+            while (Direction * (t1 - t) > 0.)
+            {
+                if (Steps >= Settings.MaxSteps)
+                {
+                    Error = FString::Printf(TEXT("More than %d steps, at %.3f"), Settings.MaxSteps, t);
+                    return false;
+                }
+
+                const double MinStep = 10. * FMath::Max(FMath::Abs(t), 1.) * DBL_EPSILON;
+                hAbs = FMath::Clamp(hAbs, MinStep, MaxStep);
+                bRejected = false;
+
+                double tNew = t, h = 0.;
+                while (true)
+                {
+                    if (!(hAbs >= MinStep))
+                    {
+                        Error = FString::Printf(TEXT("Step size too small, at %.3f"), t);
+                        return false;
+                    }
+
+                    h = hAbs * Direction;
+                    tNew = t + h;
+                    if (Direction * (tNew - t1) > 0.)
+                    {
+                        tNew = t1;
+                    }
+                    h = tNew - t;
+                    hAbs = FMath::Abs(h);
+
+                    for (int32 s = 1; s < StepStages; ++s)
+                    {
+                        FMemory::Memzero(Stage.GetData(), Size * sizeof(double));
+                        for (int32 j = 0; j < s; ++j)
+                        {
+                            const double a = A[s][j];
+                            if (a != 0.)
+                            {
+                                const double* Kj = KStage(j);
+                                for (int32 e = 0; e < Size; ++e)
+                                {
+                                    Stage[e] += a * Kj[e];
+                                }
+                            }
+                        }
+                        for (int32 e = 0; e < Size; ++e)
+                        {
+                            Stage[e] = Y[e] + h * Stage[e];
+                        }
+                        Derivatives(t + C[s] * h, Stage.GetData(), KStage(s));
+                    }
+
+                    FMemory::Memzero(Increment.GetData(), Size * sizeof(double));
+                    for (int32 j = 0; j < StepStages; ++j)
+                    {
+                        const double b = A[StepStages][j];
+                        if (b != 0.)
+                        {
+                            const double* Kj = KStage(j);
+                            for (int32 e = 0; e < Size; ++e)
+                            {
+                                Increment[e] += b * Kj[e];
+                            }
+                        }
+                    }
+                    for (int32 e = 0; e < Size; ++e)
+                    {
+                        YNew[e] = Y[e] + h * Increment[e];
+                    }
+                    Derivatives(tNew, YNew.GetData(), KStage(StepStages));
+
+                    // Error norm, the block's worst
+                    FMemory::Memzero(Error3.GetData(), N * sizeof(double));
+                    FMemory::Memzero(Error5.GetData(), N * sizeof(double));
+                    for (int32 c = 0; c < 6; ++c)
+                    {
+                        const double* K0 = KStage(0) + c * N;
+                        const double* K5 = KStage(5) + c * N;
+                        const double* K6 = KStage(6) + c * N;
+                        const double* K7 = KStage(7) + c * N;
+                        const double* K8 = KStage(8) + c * N;
+                        const double* K9 = KStage(9) + c * N;
+                        const double* K10 = KStage(10) + c * N;
+                        const double* K11 = KStage(11) + c * N;
+                        for (int32 i = 0; i < N; ++i)
+                        {
+                            const int32 e = c * N + i;
+                            const double Scale = Tolerance(c) + FMath::Max(FMath::Abs(Y[e]), FMath::Abs(YNew[e])) * Settings.RelativeTolerance;
+                            const double e5 = E5[0] * K0[i] + E5[5] * K5[i] + E5[6] * K6[i] + E5[7] * K7[i] + E5[8] * K8[i] + E5[9] * K9[i] + E5[10] * K10[i] + E5[11] * K11[i];
+                            const double e3 = Increment[e] - E3Correction[0] * K0[i] - E3Correction[1] * K8[i] - E3Correction[2] * K11[i];
+                            Error5[i] += FMath::Square(e5 / Scale);
+                            Error3[i] += FMath::Square(e3 / Scale);
+                        }
+                    }
+
+                    double ErrorNorm = 0.;
+                    for (int32 i = 0; i < N; ++i)
+                    {
+                        const double Denominator = Error5[i] + 0.01 * Error3[i];
+                        const double Norm = Denominator > 0. ? hAbs * Error5[i] / FMath::Sqrt(Denominator * 6.) : 0.;
+                        ErrorNorm = FMath::IsFinite(Norm) ? FMath::Max(ErrorNorm, Norm) : UE_DOUBLE_BIG_NUMBER;
+                    }
+
+                    if (ErrorNorm < 1.)
+                    {
+                        double Factor = ErrorNorm == 0. ? MaxFactor : FMath::Min(MaxFactor, Safety * FMath::Pow(ErrorNorm, ErrorExponent));
+                        if (bRejected)
+                        {
+                            Factor = FMath::Min(1., Factor);
+                        }
+                        hAbs *= Factor;
+                        break;
+                    }
+
+                    hAbs *= FMath::Max(MinFactor, Safety * FMath::Pow(ErrorNorm, ErrorExponent));
+                    bRejected = true;
+                    ++RejectedSteps;
+                }
+
+                if (!IsFinite(YNew.GetData(), Size))
+                {
+                    Error = FString::Printf(TEXT("Non-finite state, at %.3f"), tNew);
+                    return false;
+                }
+
+                if (Trajectories.Num())
+                {
+                    Dense(h, YNew.GetData(), K, Stage);
+                }
+
+                Swap(Y, YNew);
+                FMemory::Memcpy(KStage(0), KStage(StepStages), Size * sizeof(double));
+                t = tNew;
+                ++Steps;
+                AddTimes(t);
+            }
+
+            return true;
+        }
+
+        // The step's dense output, from its stages
+        void Dense(double h, const double* YNew, TArray<double>& K, TArray<double>& Stage)
+        {
+            const int32 Size = 6 * N;
+            const auto KStage = [&](int32 s) { return K.GetData() + s * Size; };
+
+            for (int32 s = StepStages + 1; s < Stages; ++s)
+            {
+                FMemory::Memzero(Stage.GetData(), Size * sizeof(double));
+                for (int32 j = 0; j < s; ++j)
+                {
+                    const double a = A[s][j];
+                    if (a != 0.)
+                    {
+                        const double* Kj = KStage(j);
+                        for (int32 e = 0; e < Size; ++e)
+                        {
+                            Stage[e] += a * Kj[e];
+                        }
+                    }
+                }
+                for (int32 e = 0; e < Size; ++e)
+                {
+                    Stage[e] = Y[e] + h * Stage[e];
+                }
+                Derivatives(t + C[s] * h, Stage.GetData(), KStage(s));
+            }
+
+            const double* FOld = KStage(0);
+            const double* FNew = KStage(StepStages);
+            for (int32 i = 0; i < N; ++i)
+            {
+                double* Coefficients = &Trajectories[i]->Coefficients.AddUninitialized_GetRef(DenseSize);
+                for (int32 c = 0; c < 6; ++c)
+                {
+                    const int32 e = c * N + i;
+                    const double Delta = YNew[e] - Y[e];
+                    Coefficients[c] = Y[e];
+                    Coefficients[6 + c] = Delta;
+                    Coefficients[12 + c] = h * FOld[e] - Delta;
+                    Coefficients[18 + c] = 2. * Delta - h * (FNew[e] + FOld[e]);
+                    for (int32 Row = 0; Row < 4; ++Row)
+                    {
+                        double Sum = 0.;
+                        for (int32 s = 0; s < Stages; ++s)
+                        {
+                            Sum += D[Row][s] * K[s * Size + e];
+                        }
+                        Coefficients[24 + 6 * Row + c] = h * Sum;
+                    }
+                }
+            }
+        }
+
+        // Position, velocity & acceleration, for quintic Hermite
+        void AddNode(const double* F)
+        {
+            for (int32 i = 0; i < N; ++i)
+            {
+                double* Node = &Trajectories[i]->Coefficients.AddUninitialized_GetRef(HermiteSize);
+                for (int32 c = 0; c < 6; ++c)
+                {
+                    Node[c] = Y[c * N + i];
+                }
+                for (int32 c = 0; c < 3; ++c)
+                {
+                    Node[6 + c] = F[(3 + c) * N + i];
+                }
+            }
+            AddTimes(t);
+        }
+
+        bool Symplectic(double t0, double t1)
+        {
+            const int32 Size = 6 * N;
+            const double Span = t1 - t0;
+            const int32 Count = Span == 0. ? 0 : FMath::Max(1, (int32)FMath::CeilToDouble(FMath::Abs(Span) / FMath::Max(Settings.FixedStep, UE_DOUBLE_SMALL_NUMBER)));
+            if (Count > Settings.MaxSteps)
+            {
+                Error = FString::Printf(TEXT("More than %d steps"), Settings.MaxSteps);
+                return false;
+            }
+            const double h = Count ? Span / Count : 0.;
+
+            TArray<double> F;
+            F.SetNumUninitialized(Size);
+            double* X = Y.GetData();
+            double* V = Y.GetData() + 3 * N;
+            const double* Acceleration = F.GetData() + 3 * N;
+
+            if (Trajectories.Num())
+            {
+                Derivatives(t, X, F.GetData());
+                AddNode(F.GetData());
+            }
+
+            for (int32 Step = 0; Step < Count; ++Step)
+            {
+                const double tStart = t0 + Step * h;
+                double tStage = tStart;
+                for (int32 k = 0; k < 4; ++k)
+                {
+                    for (int32 e = 0; e < 3 * N; ++e)
+                    {
+                        X[e] += Drift[k] * h * V[e];
+                    }
+                    tStage += Drift[k] * h;
+
+                    if (k < 3)
+                    {
+                        Derivatives(tStage, X, F.GetData());
+                        for (int32 e = 0; e < 3 * N; ++e)
+                        {
+                            V[e] += Kick[k] * h * Acceleration[e];
+                        }
+                    }
+                }
+
+                if (!IsFinite(X, Size))
+                {
+                    Error = FString::Printf(TEXT("Non-finite state, at %.3f"), tStart);
+                    return false;
+                }
+
+                t = Step + 1 == Count ? t1 : t0 + (Step + 1) * h;
+                ++Steps;
+
+                if (Trajectories.Num())
+                {
+                    Derivatives(t, X, F.GetData());
+                    AddNode(F.GetData());
+                }
+            }
+
+            t = t1;
+            return true;
+        }
+    };
+
+
+    TArray<FDensityBand> EarthAtmosphere()
+    {
+        return TArray<FDensityBand>(EarthBands, UE_ARRAY_COUNT(EarthBands));
+    }
+
+
+    void FTrajectory::Evaluate(double et, double(&State)[6]) const
+    {
+        const int32 Stride = Integrator == EIntegrator::DOP853 ? DenseSize : HermiteSize;
+        const int32 Steps = Times.Num() - 1;
+        if (Steps < 0 || Coefficients.Num() < Stride)
+        {
+            FMemory::Memzero(State, sizeof(State));
+            return;
+        }
+
+        const bool bForward = Times.Last() >= Times[0];
+        et = FMath::Clamp(et, First(), Last());
+
+        // The step holding et
+        int32 Lo = 0, Hi = FMath::Max(Steps, 1);
+        while (Hi - Lo > 1)
+        {
+            const int32 Mid = (Lo + Hi) / 2;
+            const bool bPast = bForward ? Times[Mid] <= et : Times[Mid] >= et;
+            (bPast ? Lo : Hi) = Mid;
+        }
+
+        if (Integrator == EIntegrator::DOP853)
+        {
+            const double* Dense = &Coefficients[Lo * DenseSize];
+            const double h = Steps > 0 ? Times[Lo + 1] - Times[Lo] : 0.;
+            const double x = h != 0. ? (et - Times[Lo]) / h : 0.;
+            const double x1 = 1. - x;
+            for (int32 c = 0; c < 6; ++c)
+            {
+                const double* F = Dense + 6 + c;
+                State[c] = Dense[c] + x * (F[0] + x1 * (F[6] + x * (F[12] + x1 * (F[18] + x * (F[24] + x1 * (F[30] + x * F[36]))))));
+            }
+            return;
+        }
+
+        const double* Node0 = &Coefficients[Lo * HermiteSize];
+        if (Steps == 0)
+        {
+            FMemory::Memcpy(State, Node0, sizeof(State));
+            return;
+        }
+
+        // Quintic Hermite
+        const double* Node1 = Node0 + HermiteSize;
+        const double h = Times[Lo + 1] - Times[Lo];
+        const double s = (et - Times[Lo]) / h;
+        const double s2 = s * s, s3 = s2 * s, s4 = s3 * s, s5 = s4 * s;
+
+        const double H0 = 1. - 10. * s3 + 15. * s4 - 6. * s5;
+        const double H1 = s - 6. * s3 + 8. * s4 - 3. * s5;
+        const double H2 = 0.5 * s2 - 1.5 * s3 + 1.5 * s4 - 0.5 * s5;
+        const double H3 = 0.5 * s3 - s4 + 0.5 * s5;
+        const double H4 = -4. * s3 + 7. * s4 - 3. * s5;
+        const double H5 = 10. * s3 - 15. * s4 + 6. * s5;
+
+        const double D0 = -30. * s2 + 60. * s3 - 30. * s4;
+        const double D1 = 1. - 18. * s2 + 32. * s3 - 15. * s4;
+        const double D2 = s - 4.5 * s2 + 6. * s3 - 2.5 * s4;
+        const double D3 = 1.5 * s2 - 4. * s3 + 2.5 * s4;
+        const double D4 = -12. * s2 + 28. * s3 - 15. * s4;
+        const double D5 = -D0;
+
+        for (int32 c = 0; c < 3; ++c)
+        {
+            const double p0 = Node0[c], v0 = Node0[3 + c], a0 = Node0[6 + c];
+            const double p1 = Node1[c], v1 = Node1[3 + c], a1 = Node1[6 + c];
+            State[c] = H0 * p0 + H1 * h * v0 + H2 * h * h * a0 + H3 * h * h * a1 + H4 * h * v1 + H5 * p1;
+            State[3 + c] = (D0 * p0 + D5 * p1) / h + D1 * v0 + D4 * v1 + h * (D2 * a0 + D3 * a1);
+        }
+    }
+
+
+    FSStateVector FTrajectory::Evaluate(const FSEphemerisTime& et) const
+    {
+        double State[6];
+        Evaluate(et.AsSpiceDouble(), State);
+        return FSStateVector(FSDistanceVector(State[0], State[1], State[2]), FSVelocityVector(State[3], State[4], State[5]));
+    }
+
+
+    TSharedPtr<FPropagator> FPropagator::Create(
+        const FForceModel& Model,
+        const FSEphemerisTime& First,
+        const FSEphemerisTime& Last,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Propagator::FPropagator::Create, Model.Center, nullptr, Model.Frame);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        *ResultCode = ES_ResultCode::Success;
+
+        const double et0 = First.AsSpiceDouble(), et1 = Last.AsSpiceDouble();
+        if (!(et1 >= et0) || Model.EphemerisStep <= 0. || (Model.MaxZonalDegree != 0 && (Model.MaxZonalDegree < 2 || Model.MaxZonalDegree > 4)))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Propagator needs First <= Last, EphemerisStep > 0, and MaxZonalDegree 0 or 2..4");
+            return nullptr;
+        }
+
+        TSharedPtr<FPropagator> Propagator(new FPropagator());
+        Propagator->Model = Model;
+        Propagator->First = et0;
+        Propagator->Last = et1;
+        if (Model.bDrag && !Model.Atmosphere.Num())
+        {
+            Propagator->Model.Atmosphere = EarthAtmosphere();
+        }
+
+        MaxQ::Data::Bodvrd(Propagator->GM, Model.Center, FName(TEXT("GM")), ResultCode, ErrorMessage);
+        if (*ResultCode != ES_ResultCode::Success)
+        {
+            return nullptr;
+        }
+
+        const bool bHarmonics = Model.MaxZonalDegree >= 2;
+        const bool bSpin = bHarmonics || Model.bDrag;
+        if (bHarmonics || Model.bDrag || (Model.bSolarRadiationPressure && Model.bShadow))
+        {
+            FSDistanceVector Radii;
+            MaxQ::Data::Bodvrd(Radii, Model.Center, FName(TEXT("RADII")), ResultCode, ErrorMessage);
+            if (*ResultCode != ES_ResultCode::Success)
+            {
+                return nullptr;
+            }
+            Propagator->EquatorialRadius = Radii.x.km;
+            Propagator->ReferenceRadius = Radii.x.km;
+        }
+
+        if (bHarmonics)
+        {
+            // Harmonics are normalized to ER (geophysical.ker), when it's there
+            int Code = 0;
+            if (MaxQ::Data::Bods2c(Code, Model.Center) && MaxQ::Data::Bodfnd(Code, FName(TEXT("ER"))))
+            {
+                MaxQ::Data::Bodvrd(Propagator->ReferenceRadius, Model.Center, FName(TEXT("ER")), ResultCode, ErrorMessage);
+            }
+            for (int32 n = 2; n <= Model.MaxZonalDegree && *ResultCode == ES_ResultCode::Success; ++n)
+            {
+                MaxQ::Data::Bodvrd(Propagator->J[n], Model.Center, FName(*FString::Printf(TEXT("J%d"), n)), ResultCode, ErrorMessage);
+            }
+            if (*ResultCode != ES_ResultCode::Success)
+            {
+                return nullptr;
+            }
+        }
+
+        for (const FName& Perturber : Model.Perturbers)
+        {
+            FBody& Body = Propagator->Bodies.AddDefaulted_GetRef();
+            Body.Name = Perturber;
+            MaxQ::Data::Bodvrd(Body.GM, Perturber, FName(TEXT("GM")), ResultCode, ErrorMessage);
+            if (*ResultCode != ES_ResultCode::Success)
+            {
+                return nullptr;
+            }
+            if (Perturber == Model.Sun)
+            {
+                Propagator->SunIndex = Propagator->Bodies.Num() - 1;
+            }
+        }
+        if (Model.bSolarRadiationPressure && Propagator->SunIndex == INDEX_NONE)
+        {
+            FBody& Sun = Propagator->Bodies.AddDefaulted_GetRef();
+            Sun.Name = Model.Sun;
+            Sun.bGravity = false;
+            Propagator->SunIndex = Propagator->Bodies.Num() - 1;
+        }
+        if (Model.bSolarRadiationPressure && Model.bShadow)
+        {
+            FSDistanceVector Radii;
+            MaxQ::Data::Bodvrd(Radii, Model.Sun, FName(TEXT("RADII")), ResultCode, ErrorMessage);
+            if (*ResultCode != ES_ResultCode::Success)
+            {
+                return nullptr;
+            }
+            Propagator->SunRadius = Radii.x.km;
+        }
+
+        SpiceChar _bodyFrame[SPICE_MAX_PATH] = "";
+        if (bSpin)
+        {
+            SpiceInt _frcode = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            cnmfrm_c(ToANSIString(Model.Center), sizeof(_bodyFrame), &_frcode, _bodyFrame, &_found);
+
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                return nullptr;
+            }
+            if (!_found)
+            {
+                *ResultCode = ES_ResultCode::Error;
+                *ErrorMessage = FString::Printf(TEXT("No body-fixed frame for %s"), *Model.Center.ToString());
+                return nullptr;
+            }
+        }
+
+        // A grid time either side of the window, so Hermite never
+        // extrapolates
+        const double Span = et1 - et0;
+        const int32 Intervals = FMath::Max(1, (int32)FMath::CeilToDouble(Span / Model.EphemerisStep));
+        Propagator->GridStep = Span > 0. ? Span / Intervals : Model.EphemerisStep;
+        Propagator->GridStart = et0 - Propagator->GridStep;
+        Propagator->GridTimes = Intervals + 3;
+
+        const ANSICHAR* _frame = ToANSIString(Model.Frame);
+        const ANSICHAR* _center = ToANSIString(Model.Center);
+        for (FBody& Body : Propagator->Bodies)
+        {
+            Body.States.SetNumUninitialized(6 * Propagator->GridTimes);
+            const ANSICHAR* _target = ToANSIString(Body.Name);
+            for (int32 k = 0; k < Propagator->GridTimes && !failed_c(); ++k)
+            {
+                SpiceDouble _lt = 0.;
+                spkezr_c(_target, Propagator->GridStart + k * Propagator->GridStep, _frame, "NONE", _center, &Body.States[6 * k], &_lt);
+            }
+        }
+
+        if (bSpin)
+        {
+            Propagator->Spin.SetNumUninitialized(6 * Propagator->GridTimes);
+            for (int32 k = 0; k < Propagator->GridTimes && !failed_c(); ++k)
+            {
+                SpiceDouble _xform[6][6], _rotate[3][3], _av[3];
+                sxform_c(_frame, _bodyFrame, Propagator->GridStart + k * Propagator->GridStep, _xform);
+                xf2rav_c(_xform, _rotate, _av);
+
+                // The body's z axis and its angular velocity, both in the
+                // frame
+                double* Spin = &Propagator->Spin[6 * k];
+                Spin[0] = _rotate[2][0];
+                Spin[1] = _rotate[2][1];
+                Spin[2] = _rotate[2][2];
+                Spin[3] = _av[0];
+                Spin[4] = _av[1];
+                Spin[5] = _av[2];
+            }
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return nullptr;
+        }
+
+        return Propagator;
+    }
+
+
+    void FPropagator::Sample(double et, FEnvironment& Environment) const
+    {
+        const double u = FMath::Clamp((et - GridStart) / GridStep, 0., (double)(GridTimes - 1));
+        const int32 k = FMath::Min((int32)u, GridTimes - 2);
+        const double s = u - k;
+
+        Environment.Positions.SetNumUninitialized(Bodies.Num(), false);
+        for (int32 b = 0; b < Bodies.Num(); ++b)
+        {
+            const double* State0 = &Bodies[b].States[6 * k];
+            Environment.Positions[b] = Hermite(State0, State0 + 6, GridStep, s);
+        }
+
+        if (Spin.Num())
+        {
+            const double* Spin0 = &Spin[6 * k];
+            const double* Spin1 = Spin0 + 6;
+            Environment.Pole = FVector3d(
+                Spin0[0] + s * (Spin1[0] - Spin0[0]),
+                Spin0[1] + s * (Spin1[1] - Spin0[1]),
+                Spin0[2] + s * (Spin1[2] - Spin0[2])
+            ).GetSafeNormal();
+            Environment.Spin = FVector3d(
+                Spin0[3] + s * (Spin1[3] - Spin0[3]),
+                Spin0[4] + s * (Spin1[4] - Spin0[4]),
+                Spin0[5] + s * (Spin1[5] - Spin0[5])
+            );
+        }
+    }
+
+
+    void FPropagator::Derivatives(const FEnvironment& Environment, int32 N, const double* Y, const double* Drag, const double* Solar, double* F) const
+    {
+        const double* X = Y;
+        const double* Yp = Y + N;
+        const double* Z = Y + 2 * N;
+        const double* VX = Y + 3 * N;
+        const double* VY = Y + 4 * N;
+        const double* VZ = Y + 5 * N;
+        double* AX = F + 3 * N;
+        double* AY = F + 4 * N;
+        double* AZ = F + 5 * N;
+
+        FMemory::Memcpy(F, VX, 3 * N * sizeof(double));
+
+        for (int32 i = 0; i < N; ++i)
+        {
+            const double r2 = X[i] * X[i] + Yp[i] * Yp[i] + Z[i] * Z[i];
+            const double InvR = 1. / FMath::Sqrt(r2);
+            const double Central = -GM * InvR * InvR * InvR;
+            AX[i] = Central * X[i];
+            AY[i] = Central * Yp[i];
+            AZ[i] = Central * Z[i];
+        }
+
+        if (Model.MaxZonalDegree >= 2)
+        {
+            const FVector3d& k = Environment.Pole;
+            const int32 Degree = Model.MaxZonalDegree;
+            for (int32 i = 0; i < N; ++i)
+            {
+                const double InvR = 1. / FMath::Sqrt(X[i] * X[i] + Yp[i] * Yp[i] + Z[i] * Z[i]);
+                const double Ux = X[i] * InvR, Uy = Yp[i] * InvR, Uz = Z[i] * InvR;
+                const double s = Ux * k.X + Uy * k.Y + Uz * k.Z;
+                const double s2 = s * s;
+                const double Ratio = ReferenceRadius * InvR;
+                double Scale = GM * InvR * InvR * Ratio * Ratio;
+
+                // Radial & polar coefficients, summed over degrees
+                double Radial = J[2] * Scale * (3. * 0.5 * (3. * s2 - 1.) + s * 3. * s);
+                double Polar = J[2] * Scale * 3. * s;
+                if (Degree >= 3)
+                {
+                    Scale *= Ratio;
+                    const double P3 = 0.5 * (5. * s2 - 3.) * s, dP3 = 0.5 * (15. * s2 - 3.);
+                    Radial += J[3] * Scale * (4. * P3 + s * dP3);
+                    Polar += J[3] * Scale * dP3;
+                }
+                if (Degree >= 4)
+                {
+                    Scale *= Ratio;
+                    const double P4 = (35. * s2 * s2 - 30. * s2 + 3.) / 8., dP4 = 0.5 * (35. * s2 - 15.) * s;
+                    Radial += J[4] * Scale * (5. * P4 + s * dP4);
+                    Polar += J[4] * Scale * dP4;
+                }
+
+                AX[i] += Radial * Ux - Polar * k.X;
+                AY[i] += Radial * Uy - Polar * k.Y;
+                AZ[i] += Radial * Uz - Polar * k.Z;
+            }
+        }
+
+        for (int32 b = 0; b < Bodies.Num(); ++b)
+        {
+            const FBody& Body = Bodies[b];
+            if (!Body.bGravity)
+            {
+                continue;
+            }
+
+            const FVector3d& R = Environment.Positions[b];
+            const FVector3d Indirect = R * (Body.GM / FMath::Cube(R.Length()));
+            for (int32 i = 0; i < N; ++i)
+            {
+                const double Dx = R.X - X[i], Dy = R.Y - Yp[i], Dz = R.Z - Z[i];
+                const double InvD = 1. / FMath::Sqrt(Dx * Dx + Dy * Dy + Dz * Dz);
+                const double Direct = Body.GM * InvD * InvD * InvD;
+                AX[i] += Direct * Dx - Indirect.X;
+                AY[i] += Direct * Dy - Indirect.Y;
+                AZ[i] += Direct * Dz - Indirect.Z;
+            }
+        }
+
+        if (Model.bDrag)
+        {
+            const FVector3d& w = Environment.Spin;
+            const TArray<FDensityBand>& Bands = Model.Atmosphere;
+            for (int32 i = 0; i < N; ++i)
+            {
+                if (Drag[i] <= 0.)
+                {
+                    continue;
+                }
+
+                const double Altitude = FMath::Sqrt(X[i] * X[i] + Yp[i] * Yp[i] + Z[i] * Z[i]) - EquatorialRadius;
+                int32 Band = 0;
+                while (Band + 1 < Bands.Num() && Bands[Band + 1].Altitude <= Altitude)
+                {
+                    ++Band;
+                }
+                const double Density = Bands[Band].Density * FMath::Exp(-(Altitude - Bands[Band].Altitude) / Bands[Band].ScaleHeight);
+
+                // Relative to the co-rotating atmosphere.  km/s & kg/m^3
+                // make the acceleration 1e3 km/s^2.
+                const double Vx = VX[i] - (w.Y * Z[i] - w.Z * Yp[i]);
+                const double Vy = VY[i] - (w.Z * X[i] - w.X * Z[i]);
+                const double Vz = VZ[i] - (w.X * Yp[i] - w.Y * X[i]);
+                const double Speed = FMath::Sqrt(Vx * Vx + Vy * Vy + Vz * Vz);
+                const double Deceleration = -0.5e3 * Drag[i] * Density * Speed;
+                AX[i] += Deceleration * Vx;
+                AY[i] += Deceleration * Vy;
+                AZ[i] += Deceleration * Vz;
+            }
+        }
+
+        if (Model.bSolarRadiationPressure)
+        {
+            const FVector3d& S = Environment.Positions[SunIndex];
+            const FVector3d SunDirection = S.GetSafeNormal();
+            const double SunAngularDiameter = 2. * SunRadius / S.Length();
+
+            // N/m^2 * m^2/kg = m/s^2
+            const double Pressure = Model.SolarPressure * AstronomicalUnit * AstronomicalUnit * 1e-3;
+            for (int32 i = 0; i < N; ++i)
+            {
+                const double Dx = X[i] - S.X, Dy = Yp[i] - S.Y, Dz = Z[i] - S.Z;
+                const double d2 = Dx * Dx + Dy * Dy + Dz * Dz;
+
+                // Behind the center:  dark within the cylinder, ramping to
+                // lit across a penumbra as wide as the sun looks
+                const double Along = X[i] * SunDirection.X + Yp[i] * SunDirection.Y + Z[i] * SunDirection.Z;
+                const double Across = FMath::Sqrt(FMath::Max(X[i] * X[i] + Yp[i] * Yp[i] + Z[i] * Z[i] - Along * Along, 0.));
+                const double Penumbra = FMath::Max(-Along * SunAngularDiameter, UE_DOUBLE_SMALL_NUMBER);
+                const double Lit = !Model.bShadow || Along >= 0. ? 1. : FMath::Clamp((Across - EquatorialRadius) / Penumbra + 0.5, 0., 1.);
+
+                const double Push = Lit * Pressure * Solar[i] / (d2 * FMath::Sqrt(d2));
+                AX[i] += Push * Dx;
+                AY[i] += Push * Dy;
+                AZ[i] += Push * Dz;
+            }
+        }
+    }
+
+
+    bool FPropagator::Propagate(
+        FSpacecraftBatch& Batch,
+        const FSEphemerisTime& et0,
+        const FSEphemerisTime& et1,
+        const FIntegratorSettings& Settings,
+        FPropagationStats* Stats,
+        TArray<FTrajectory>* Trajectories,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    ) const
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Propagator::FPropagator::Propagate);
+
+        // Any thread:  no error gutter
+        ES_ResultCode LocalResultCode;
+        FString LocalErrorMessage;
+        if (!ResultCode) ResultCode = &LocalResultCode;
+        if (!ErrorMessage) ErrorMessage = &LocalErrorMessage;
+
+        const double Start = FPlatformTime::Seconds();
+        const double t0 = et0.AsSpiceDouble(), t1 = et1.AsSpiceDouble();
+        const int32 Num = Batch.Num();
+
+        FPropagationStats LocalStats;
+        if (!Stats) Stats = &LocalStats;
+        *Stats = FPropagationStats();
+
+        // Past the window only by rounding
+        const double Slack = 1e-9 * FMath::Max(1., FMath::Abs(First) + FMath::Abs(Last));
+        if (FMath::Min(t0, t1) < First - Slack || FMath::Max(t0, t1) > Last + Slack)
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("Propagation from %.3f to %.3f is outside the propagator's window [%.3f, %.3f]"), t0, t1, First, Last);
+            return false;
+        }
+
+        TArray<double> NoCoefficients;
+        const bool bCoefficients = Batch.DragCoefficient.Num() == Num && Batch.SolarCoefficient.Num() == Num;
+        if (!bCoefficients)
+        {
+            NoCoefficients.SetNumZeroed(Num);
+        }
+        const double* Drag = bCoefficients ? Batch.DragCoefficient.GetData() : NoCoefficients.GetData();
+        const double* Solar = bCoefficients ? Batch.SolarCoefficient.GetData() : NoCoefficients.GetData();
+
+        if (Trajectories)
+        {
+            Trajectories->SetNum(Num);
+            for (FTrajectory& Trajectory : *Trajectories)
+            {
+                Trajectory.Integrator = Settings.Integrator;
+                Trajectory.Center = Model.Center;
+                Trajectory.Frame = Model.Frame;
+                Trajectory.Times.Reset();
+                Trajectory.Coefficients.Reset();
+            }
+        }
+
+        const int32 BlockSize = FMath::Clamp(Settings.BlockSize, 1, 64);
+        const int32 Blocks = FMath::DivideAndRoundUp(Num, BlockSize);
+
+        struct FBlockResult
+        {
+            int64 Steps = 0;
+            int64 RejectedSteps = 0;
+            int64 Evaluations = 0;
+            FString Error;
+        };
+        TArray<FBlockResult> Results;
+        Results.SetNum(Blocks);
+
+        FSStateVectorBuffer& States = Batch.States;
+        double* Components[6] = { States.x.GetData(), States.y.GetData(), States.z.GetData(), States.dx.GetData(), States.dy.GetData(), States.dz.GetData() };
+
+        ParallelFor(Blocks, [&](int32 b)
+        {
+            const int32 Begin = b * BlockSize;
+            const int32 N = FMath::Min(Num - Begin, BlockSize);
+
+            FBlock Block(*this, Settings, N, Drag + Begin, Solar + Begin);
+            Block.t = t0;
+            for (int32 c = 0; c < 6; ++c)
+            {
+                FMemory::Memcpy(&Block.Y[c * N], Components[c] + Begin, N * sizeof(double));
+            }
+            if (Trajectories)
+            {
+                for (int32 i = 0; i < N; ++i)
+                {
+                    Block.Trajectories.Add(&(*Trajectories)[Begin + i]);
+                }
+            }
+
+            if (!IsFinite(Block.Y.GetData(), 6 * N))
+            {
+                Block.Error = TEXT("Non-finite initial state");
+            }
+            else if (Settings.Integrator == EIntegrator::DOP853)
+            {
+                Block.Dop853(t1);
+            }
+            else
+            {
+                Block.Symplectic(t0, t1);
+            }
+
+            for (int32 c = 0; c < 6; ++c)
+            {
+                FMemory::Memcpy(Components[c] + Begin, &Block.Y[c * N], N * sizeof(double));
+            }
+
+            FBlockResult& Result = Results[b];
+            Result.Steps = Block.Steps;
+            Result.RejectedSteps = Block.RejectedSteps;
+            Result.Evaluations = Block.Evaluations;
+            if (!Block.Error.IsEmpty())
+            {
+                Result.Error = FString::Printf(TEXT("Spacecraft %d..%d:  %s"), Begin, Begin + N - 1, *Block.Error);
+            }
+        });
+
+        *ResultCode = ES_ResultCode::Success;
+        for (int32 b = 0; b < Blocks; ++b)
+        {
+            const FBlockResult& Result = Results[b];
+            Stats->Steps += Result.Steps;
+            Stats->RejectedSteps += Result.RejectedSteps;
+            Stats->Evaluations += Result.Evaluations;
+            if (!Result.Error.IsEmpty())
+            {
+                Stats->Failures += FMath::Min(Num - b * BlockSize, BlockSize);
+                if (*ResultCode == ES_ResultCode::Success)
+                {
+                    *ResultCode = ES_ResultCode::Error;
+                    *ErrorMessage = Result.Error;
+                }
+            }
+        }
+
+        Stats->Seconds = FPlatformTime::Seconds() - Start;
+        return *ResultCode == ES_ResultCode::Success;
+    }
+
+
+    bool FPropagator::Propagate(
+        FSStateVector& State,
+        const FSEphemerisTime& et0,
+        const FSEphemerisTime& et1,
+        const FIntegratorSettings& Settings,
+        double Drag,
+        double Solar,
+        FTrajectory* Trajectory,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    ) const
+    {
+        FSpacecraftBatch Batch;
+        Batch.Add(State, Drag, Solar);
+
+        TArray<FTrajectory> Trajectories;
+        const bool bSuccess = Propagate(Batch, et0, et1, Settings, nullptr, Trajectory ? &Trajectories : nullptr, ResultCode, ErrorMessage);
+
+        State = Batch.States.Get(0);
+        if (Trajectory)
+        {
+            *Trajectory = MoveTemp(Trajectories[0]);
+        }
+        return bSuccess;
+    }
+
+
+    FVector3d FPropagator::Acceleration(const FSEphemerisTime& et, const FSStateVector& State, double Drag, double Solar) const
+    {
+        const double Y[6] = { State.r.x.km, State.r.y.km, State.r.z.km, State.v.dx.kmps, State.v.dy.kmps, State.v.dz.kmps };
+        double F[6];
+
+        FEnvironment Environment;
+        Sample(et.AsSpiceDouble(), Environment);
+        Derivatives(Environment, 1, Y, &Drag, &Solar, F);
+        return FVector3d(F[3], F[4], F[5]);
+    }
+
+
+    void WriteSpk(
+        const FTrajectory& Trajectory,
+        int handle,
+        int body,
+        const FString& segid,
+        const MaxQ::Compression::FChebyshevFitSettings& Settings,
+        MaxQ::Compression::FCompressionStats& Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Propagator::WriteSpk);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        int Center = 0;
+        if (Trajectory.Last() <= Trajectory.First() || !MaxQ::Data::Bods2c(Center, Trajectory.Center))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("Trajectory for %d is empty, or its center %s has no id code"), body, *Trajectory.Center.ToString());
+            return;
+        }
+
+        TArray<MaxQ::Compression::FChebyshevSegment> Segments;
+        MaxQ::Compression::FitChebyshev(
+            [&](double et, double(&State)[6]) { Trajectory.Evaluate(et, State); },
+            Trajectory.First(),
+            Trajectory.Last(),
+            Settings,
+            Segments,
+            Stats
+        );
+
+        MaxQ::Compression::WriteChebyshev(handle, body, Center, Trajectory.Frame, segid, Segments, ResultCode, ErrorMessage);
+    }
+}
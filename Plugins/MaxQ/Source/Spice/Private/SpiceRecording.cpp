@@ -0,0 +1,82 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceRecording.cpp
+//
+// Implementation Comments
+//
+// Purpose:  What the trajectory & attitude recorders share
+//------------------------------------------------------------------------------
+
+#include "SpiceRecording.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+namespace MaxQ::Recording
+{
+    FRecordingThread::FRecordingThread(double PeriodSeconds, TFunction<void()>&& InWork)
+        : Work(MoveTemp(InWork))
+        , PeriodMs((uint32)FMath::Max(1., 1000. * PeriodSeconds))
+    {
+        WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    }
+
+
+    FRecordingThread::~FRecordingThread()
+    {
+        Shutdown();
+        FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+    }
+
+
+    bool FRecordingThread::Start(const TCHAR* ThreadName)
+    {
+        check(!Thread);
+        Thread = FRunnableThread::Create(this, ThreadName, 0, TPri_BelowNormal);
+        return Thread != nullptr;
+    }
+
+
+    void FRecordingThread::Wake()
+    {
+        WakeEvent->Trigger();
+    }
+
+
+    void FRecordingThread::Shutdown()
+    {
+        if (Thread)
+        {
+            Thread->Kill(true);
+            delete Thread;
+            Thread = nullptr;
+        }
+    }
+
+
+    uint32 FRecordingThread::Run()
+    {
+        while (!bStop)
+        {
+            WakeEvent->Wait(PeriodMs);
+            Work();
+        }
+
+        // Whatever came in before stopping
+        Work();
+        return 0;
+    }
+
+
+    void FRecordingThread::Stop()
+    {
+        bStop = true;
+        WakeEvent->Trigger();
+    }
+}
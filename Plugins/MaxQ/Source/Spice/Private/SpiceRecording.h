@@ -0,0 +1,115 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceRecording.h
+//
+// Private API Comments
+//
+// Purpose:
+// What the trajectory & attitude recorders share
+//
+// TSampleRing is a single producer, single consumer ring:  the producer owns
+// Head and the consumer owns Tail, each published with release and read with
+// acquire, so neither side ever locks.  The consumer is done with each slot
+// before publishing Tail, which frees it.
+//
+// FRecordingThread is the consumer's thread, waking every period (or when
+// asked) to seal what's been pushed, and once more when it stops.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+
+namespace MaxQ::Recording
+{
+    template<typename SampleType>
+    class TSampleRing
+    {
+    public:
+        void Init(int32 Capacity)
+        {
+            Samples.SetNumUninitialized(Capacity);
+        }
+
+        // Producer.  False if the ring is full.  bHalfFull says the consumer
+        // shouldn't wait to drain it.
+        bool Push(const SampleType& Sample, bool& bHalfFull)
+        {
+            const uint64 Capacity = Samples.Num();
+            const uint64 Written = Head.load(std::memory_order_relaxed);
+            const uint64 Read = Tail.load(std::memory_order_acquire);
+
+            if (Written - Read >= Capacity)
+            {
+                bHalfFull = true;
+                return false;
+            }
+
+            Samples[Written % Capacity] = Sample;
+            Head.store(Written + 1, std::memory_order_release);
+
+            bHalfFull = Written + 1 - Read >= Capacity / 2;
+            return true;
+        }
+
+        // Consumer.  Visits everything pushed so far, oldest first.
+        template<typename VisitorType>
+        void Drain(VisitorType&& Visit)
+        {
+            const uint64 Capacity = Samples.Num();
+            const uint64 Written = Head.load(std::memory_order_acquire);
+            uint64 Read = Tail.load(std::memory_order_relaxed);
+
+            for (; Read < Written; ++Read)
+            {
+                Visit(Samples[Read % Capacity]);
+            }
+
+            Tail.store(Read, std::memory_order_release);
+        }
+
+    private:
+        TArray<SampleType> Samples;
+        std::atomic<uint64> Head{ 0 };
+        std::atomic<uint64> Tail{ 0 };
+    };
+
+
+    class FRecordingThread : public FRunnable
+    {
+    public:
+        FRecordingThread(double PeriodSeconds, TFunction<void()>&& InWork);
+        virtual ~FRecordingThread();
+
+        bool Start(const TCHAR* ThreadName);
+
+        // Any thread.  Runs the work now, rather than at the end of the period.
+        void Wake();
+
+        // Waits for the last run of the work
+        void Shutdown();
+
+        bool IsRunning() const { return Thread != nullptr; }
+
+        virtual uint32 Run() override;
+        virtual void Stop() override;
+
+    private:
+        TFunction<void()> Work;
+        uint32 PeriodMs = 1000;
+        FEvent* WakeEvent = nullptr;
+        FRunnableThread* Thread = nullptr;
+        std::atomic<bool> bStop{ false };
+    };
+}
@@ -0,0 +1,651 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSegments.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Segment selection that scales with the number of loaded kernels
+//
+// Precedence is a 64 bit priority:  the file's load sequence in the high 32
+// bits, the segment's position in the file in the low 32.  CSPICE moves a
+// reloaded file to the end of the load order, so a file whose sequence is out
+// of order in kdata_c's list is re-read with a new sequence.
+//
+// As with the coverage index, the game thread keeps the raw segments per id,
+// re-sorts only the ids touched by a load/unload, and publishes an immutable
+// index that readers hold by reference.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSegments.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceSegments.h"
+#include "Misc/ScopeRWLock.h"
+#include "SpiceConstants.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+using MaxQ::Segments::EKernelKind;
+using MaxQ::Segments::FSegment;
+using MaxQ::Segments::FIntervalTree;
+
+
+namespace MaxQ::Segments
+{
+    FIntervalTree::FIntervalTree(TArray<FEntry>&& InEntries)
+        : Entries(MoveTemp(InEntries))
+    {
+        Entries.Sort([](const FEntry& A, const FEntry& B) { return A.Start < B.Start; });
+
+        MaxStop.SetNumUninitialized(Entries.Num());
+        MaxPriority.SetNumUninitialized(Entries.Num());
+
+        if (Entries.Num() > 0)
+        {
+            Build(0, Entries.Num());
+        }
+    }
+
+
+    void FIntervalTree::Build(int32 Lo, int32 Hi)
+    {
+        const int32 Mid = Lo + (Hi - Lo) / 2;
+        MaxStop[Mid] = Entries[Mid].Stop;
+        MaxPriority[Mid] = Entries[Mid].Priority;
+
+        if (Lo < Mid)
+        {
+            Build(Lo, Mid);
+            const int32 Left = Lo + (Mid - Lo) / 2;
+            MaxStop[Mid] = FMath::Max(MaxStop[Mid], MaxStop[Left]);
+            MaxPriority[Mid] = FMath::Max(MaxPriority[Mid], MaxPriority[Left]);
+        }
+
+        if (Mid + 1 < Hi)
+        {
+            Build(Mid + 1, Hi);
+            const int32 Right = Mid + 1 + (Hi - Mid - 1) / 2;
+            MaxStop[Mid] = FMath::Max(MaxStop[Mid], MaxStop[Right]);
+            MaxPriority[Mid] = FMath::Max(MaxPriority[Mid], MaxPriority[Right]);
+        }
+    }
+
+
+    int32 FIntervalTree::FindHighestPriority(double Time) const
+    {
+        int32 Best = INDEX_NONE;
+        FindHighestPriority(Time, 0, Entries.Num(), Best);
+        return Best != INDEX_NONE ? Entries[Best].Index : INDEX_NONE;
+    }
+
+
+    void FIntervalTree::FindHighestPriority(double Time, int32 Lo, int32 Hi, int32& Best) const
+    {
+        if (Lo >= Hi)
+        {
+            return;
+        }
+
+        const int32 Mid = Lo + (Hi - Lo) / 2;
+
+        // Nothing in this subtree reaches Time, or can beat what we have
+        if (MaxStop[Mid] < Time || (Best != INDEX_NONE && MaxPriority[Mid] <= Entries[Best].Priority))
+        {
+            return;
+        }
+
+        FindHighestPriority(Time, Lo, Mid, Best);
+
+        const FEntry& Entry = Entries[Mid];
+        if (Entry.Start > Time)
+        {
+            // ...and everything to the right starts later still
+            return;
+        }
+
+        if (Time <= Entry.Stop && (Best == INDEX_NONE || Entry.Priority > Entries[Best].Priority))
+        {
+            Best = Mid;
+        }
+
+        FindHighestPriority(Time, Mid + 1, Hi, Best);
+    }
+
+
+    void FIntervalTree::FindAll(double Time, TArray<int32>& Indices) const
+    {
+        Indices.Reset();
+        FindAll(Time, 0, Entries.Num(), Indices);
+    }
+
+
+    void FIntervalTree::FindAll(double Time, int32 Lo, int32 Hi, TArray<int32>& Indices) const
+    {
+        if (Lo >= Hi)
+        {
+            return;
+        }
+
+        const int32 Mid = Lo + (Hi - Lo) / 2;
+        if (MaxStop[Mid] < Time)
+        {
+            return;
+        }
+
+        FindAll(Time, Lo, Mid, Indices);
+
+        const FEntry& Entry = Entries[Mid];
+        if (Entry.Start > Time)
+        {
+            return;
+        }
+
+        if (Time <= Entry.Stop)
+        {
+            Indices.Add(Entry.Index);
+        }
+
+        FindAll(Time, Mid + 1, Hi, Indices);
+    }
+}
+
+
+namespace
+{
+    struct FIdSegments
+    {
+        TArray<FSegment> Segments;  // Highest precedence first
+        FIntervalTree Tree;         // Entry.Index => Segments
+    };
+
+    typedef TSharedPtr<const FIdSegments, ESPMode::ThreadSafe> FIdSegmentsPtr;
+
+    struct FSegmentIndex
+    {
+        TMap<FKernelId, FIdSegmentsPtr> Ids;
+        int32 SegmentCount = 0;
+    };
+
+    typedef TSharedPtr<const FSegmentIndex, ESPMode::ThreadSafe> FSegmentIndexPtr;
+
+    FRWLock IndexLock;
+    FSegmentIndexPtr CurrentIndex;
+
+    FSegmentIndexPtr GetIndex()
+    {
+        FReadScopeLock Lock(IndexLock);
+        return CurrentIndex;
+    }
+
+    // Game thread only, from here...
+    struct FPrioritizedSegment
+    {
+        FSegment Segment;
+        int64 Priority = 0;
+
+        int64 GetSequence() const { return Priority >> 32; }
+    };
+
+    struct FIndexedFile
+    {
+        EKernelKind Kind = EKernelKind::SPK;
+        int32 Handle = 0;
+        int64 Sequence = 0;
+        TArray<int32> Ids;
+        int32 SegmentCount = 0;
+    };
+
+    TMap<FString, FIndexedFile> IndexedFiles;
+    TMap<FKernelId, TArray<FPrioritizedSegment>> SegmentsByKey;
+    int64 NextSequence = 1;
+    // ... to here.
+
+    // False if any of the file couldn't be read
+    bool ScanFile(const FString& File, FIndexedFile& Indexed, TSet<FKernelId>& Affected)
+    {
+        // Summary layouts, see the SPK, CK and PCK Required Reading
+        const SpiceInt _nd = 2;
+        const SpiceInt _ni = Indexed.Kind == EKernelKind::PCK ? 5 : 6;
+
+        dafbfs_c(Indexed.Handle);
+
+        SpiceBoolean _found = SPICEFALSE;
+        daffna_c(&_found);
+
+        int64 Position = 0;
+        while (_found && !failed_c())
+        {
+            FPrioritizedSegment Entry;
+            Entry.Priority = (Indexed.Sequence << 32) | Position++;
+
+            FSegment& Segment = Entry.Segment;
+            dafgs_c(Segment.Descriptor);
+
+            SpiceDouble _dc[2];
+            SpiceInt _ic[6];
+            dafus_c(Segment.Descriptor, _nd, _ni, _dc, _ic);
+
+            Segment.Start = _dc[0];
+            Segment.Stop = _dc[1];
+            Segment.Handle = Indexed.Handle;
+            Segment.Id = _ic[0];
+
+            switch (Indexed.Kind)
+            {
+            case EKernelKind::SPK:
+                Segment.Center = _ic[1];
+                Segment.Frame = _ic[2];
+                Segment.Type = _ic[3];
+                break;
+            case EKernelKind::CK:
+                Segment.Frame = _ic[1];
+                Segment.Type = _ic[2];
+                Segment.bHasAngularVelocity = _ic[3] != 0;
+                break;
+            case EKernelKind::PCK:
+                Segment.Frame = _ic[1];
+                Segment.Type = _ic[2];
+                break;
+            }
+
+            const FKernelId Key { Indexed.Kind, Segment.Id };
+            SegmentsByKey.FindOrAdd(Key).Add(Entry);
+            Indexed.Ids.AddUnique(Segment.Id);
+            ++Indexed.SegmentCount;
+            Affected.Add(Key);
+
+            daffna_c(&_found);
+        }
+
+        if (failed_c())
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ segment index could not read all segments of kernel %s"), *File);
+            UnexpectedErrorCheck();
+            return false;
+        }
+        return true;
+    }
+
+    void RemoveFile(const FIndexedFile& Indexed, TSet<FKernelId>& Affected)
+    {
+        for (int32 Id : Indexed.Ids)
+        {
+            const FKernelId Key { Indexed.Kind, Id };
+            if (TArray<FPrioritizedSegment>* Segments = SegmentsByKey.Find(Key))
+            {
+                Segments->RemoveAll([&](const FPrioritizedSegment& Entry) { return Entry.GetSequence() == Indexed.Sequence; });
+                if (Segments->IsEmpty())
+                {
+                    SegmentsByKey.Remove(Key);
+                }
+            }
+            Affected.Add(Key);
+        }
+    }
+
+    FIdSegmentsPtr BuildIdSegments(TArray<FPrioritizedSegment> Raw)
+    {
+        Raw.Sort([](const FPrioritizedSegment& A, const FPrioritizedSegment& B) { return A.Priority > B.Priority; });
+
+        TSharedRef<FIdSegments, ESPMode::ThreadSafe> IdSegments = MakeShared<FIdSegments, ESPMode::ThreadSafe>();
+        IdSegments->Segments.Reserve(Raw.Num());
+
+        TArray<FIntervalTree::FEntry> Entries;
+        Entries.Reserve(Raw.Num());
+
+        for (int32 i = 0; i < Raw.Num(); ++i)
+        {
+            IdSegments->Segments.Add(Raw[i].Segment);
+            Entries.Add({ Raw[i].Segment.Start, Raw[i].Segment.Stop, Raw[i].Priority, i });
+        }
+
+        IdSegments->Tree = FIntervalTree(MoveTemp(Entries));
+        return IdSegments;
+    }
+
+    const FSegment* FindSegment(const FSegmentIndex& Index, EKernelKind Kind, int32 Id, double Time)
+    {
+        const FIdSegmentsPtr* IdSegments = Index.Ids.Find(FKernelId { Kind, Id });
+        if (!IdSegments)
+        {
+            return nullptr;
+        }
+
+        const int32 i = (*IdSegments)->Tree.FindHighestPriority(Time);
+        return i != INDEX_NONE ? &(*IdSegments)->Segments[i] : nullptr;
+    }
+
+    // Deeper than any real ephemeris tree; stops a malformed kernel's cycle
+    constexpr int32 MaxChainDepth = 100;
+
+    struct FLink
+    {
+        int32 Center = 0;
+        SpiceDouble State[6] = {};  // The chain's body relative to Center, J2000
+    };
+
+    // Link 0 is the body itself, each following link is the next center of
+    // motion, up to the last body that has a segment at et.
+    bool ChainToRoot(const FSegmentIndex& Index, int32 Body, SpiceDouble et, TArray<FLink>& Chain)
+    {
+        Chain.Reset();
+        Chain.Add(FLink { Body });
+
+        for (int32 Depth = 0; Depth < MaxChainDepth; ++Depth)
+        {
+            const FSegment* Segment = FindSegment(Index, EKernelKind::SPK, Chain.Last().Center, et);
+            if (!Segment)
+            {
+                return true;
+            }
+
+            SpiceInt _ref = 0, _center = 0;
+            SpiceDouble _state[6];
+            spkpvn_c(Segment->Handle, Segment->Descriptor, et, &_ref, _state, &_center);
+
+            if (_ref != 1 /* J2000 */)
+            {
+                SpiceChar _frname[SPICE_MAX_PATH];
+                frmnam_c(_ref, sizeof(_frname), _frname);
+
+                SpiceDouble _xform[6][6];
+                sxform_c(_frname, "J2000", et, _xform);
+                mxvg_c(_xform, _state, 6, 6, _state);
+            }
+
+            if (failed_c())
+            {
+                return false;
+            }
+
+            FLink Next { (int32)_center };
+            vaddg_c(Chain.Last().State, _state, 6, Next.State);
+            Chain.Add(Next);
+        }
+
+        return true;
+    }
+}
+
+
+namespace MaxQ::Segments
+{
+    SPICE_API void Refresh()
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Segments::Refresh);
+
+        TArray<FLoadedKernel> Kernels;
+        if (!GetLoadedKernels(TEXT("SPK CK PCK"), Kernels))
+        {
+            return;
+        }
+
+        // Files loaded as some other kind, or reloaded (out of sequence), are
+        // stale.
+        TMap<FString, EKernelKind> Loaded;
+        TSet<FString> Stale;
+        int64 LastSequence = 0;
+
+        for (const FLoadedKernel& Kernel : Kernels)
+        {
+            EKernelKind Kind;
+            if (!KernelKindFromType(Kernel.Type, Kind))
+            {
+                continue;
+            }
+
+            Loaded.Add(Kernel.File, Kind);
+
+            if (const FIndexedFile* Indexed = IndexedFiles.Find(Kernel.File))
+            {
+                if (Indexed->Kind != Kind || Indexed->Handle != Kernel.Handle || Indexed->Sequence < LastSequence)
+                {
+                    Stale.Add(Kernel.File);
+                }
+                else
+                {
+                    LastSequence = Indexed->Sequence;
+                }
+            }
+            else
+            {
+                // Indexed below with a new sequence, so what's loaded after
+                // it (e.g. after a failed scan's retry) is out of sequence
+                LastSequence = NextSequence;
+            }
+        }
+
+        TSet<FKernelId> Affected;
+        bool bFilesChanged = false;
+
+        for (auto It = IndexedFiles.CreateIterator(); It; ++It)
+        {
+            if (!Loaded.Contains(It.Key()) || Stale.Contains(It.Key()))
+            {
+                RemoveFile(It.Value(), Affected);
+                It.RemoveCurrent();
+                bFilesChanged = true;
+            }
+        }
+
+        for (const FLoadedKernel& Kernel : Kernels)
+        {
+            const EKernelKind* Kind = Loaded.Find(Kernel.File);
+            if (Kind && !IndexedFiles.Contains(Kernel.File))
+            {
+                FIndexedFile Indexed;
+                Indexed.Kind = *Kind;
+                Indexed.Handle = Kernel.Handle;
+                Indexed.Sequence = NextSequence++;
+                bFilesChanged = true;
+
+                // Not indexed, so the next refresh tries it again
+                if (!ScanFile(Kernel.File, Indexed, Affected))
+                {
+                    RemoveFile(Indexed, Affected);
+                    continue;
+                }
+
+                IndexedFiles.Add(Kernel.File, MoveTemp(Indexed));
+            }
+        }
+
+        FSegmentIndexPtr Previous = GetIndex();
+        if (!bFilesChanged && Previous.IsValid())
+        {
+            return;
+        }
+
+        TSharedRef<FSegmentIndex, ESPMode::ThreadSafe> Next = Previous.IsValid()
+            ? MakeShared<FSegmentIndex, ESPMode::ThreadSafe>(*Previous)
+            : MakeShared<FSegmentIndex, ESPMode::ThreadSafe>();
+
+        for (const FKernelId& Key : Affected)
+        {
+            const TArray<FPrioritizedSegment>* Raw = SegmentsByKey.Find(Key);
+            if (Raw)
+            {
+                Next->Ids.Add(Key, BuildIdSegments(*Raw));
+            }
+            else
+            {
+                Next->Ids.Remove(Key);
+            }
+        }
+
+        Next->SegmentCount = 0;
+        for (const auto& [File, Indexed] : IndexedFiles)
+        {
+            Next->SegmentCount += Indexed.SegmentCount;
+        }
+
+        FWriteScopeLock Lock(IndexLock);
+        CurrentIndex = Next;
+    }
+
+
+    SPICE_API bool Select(EKernelKind Kind, int32 Id, double Time, FSegment& Segment)
+    {
+        FSegmentIndexPtr Index = GetIndex();
+        const FSegment* Found = Index.IsValid() ? FindSegment(*Index, Kind, Id, Time) : nullptr;
+        if (Found)
+        {
+            Segment = *Found;
+        }
+        return Found != nullptr;
+    }
+
+
+    SPICE_API bool SelectAll(EKernelKind Kind, int32 Id, double Time, TArray<FSegment>& Segments)
+    {
+        Segments.Reset();
+
+        FSegmentIndexPtr Index = GetIndex();
+        const FIdSegmentsPtr* IdSegments = Index.IsValid() ? Index->Ids.Find(FKernelId { Kind, Id }) : nullptr;
+        if (IdSegments)
+        {
+            TArray<int32> Indices;
+            (*IdSegments)->Tree.FindAll(Time, Indices);
+
+            // Segments are stored by precedence
+            Indices.Sort();
+            for (int32 i : Indices)
+            {
+                Segments.Add((*IdSegments)->Segments[i]);
+            }
+        }
+
+        return Segments.Num() > 0;
+    }
+
+
+    SPICE_API bool GetSegments(EKernelKind Kind, int32 Id, TArray<FSegment>& Segments)
+    {
+        FSegmentIndexPtr Index = GetIndex();
+        const FIdSegmentsPtr* IdSegments = Index.IsValid() ? Index->Ids.Find(FKernelId { Kind, Id }) : nullptr;
+        Segments = IdSegments ? (*IdSegments)->Segments : TArray<FSegment>();
+        return Segments.Num() > 0;
+    }
+
+
+    SPICE_API int32 GetSegmentCount()
+    {
+        FSegmentIndexPtr Index = GetIndex();
+        return Index.IsValid() ? Index->SegmentCount : 0;
+    }
+
+
+    SPICE_API bool Spkgeo(
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        int32 targ,
+        const FSEphemerisTime& et,
+        const FName& ref,
+        int32 obs,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE_TAGGED(MaxQ::Segments::Spkgeo, targ, obs, ref);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+
+        FSegmentIndexPtr Index = GetIndex();
+        const SpiceDouble _et = et.AsSpiceDouble();
+
+        TArray<FLink> TargChain, ObsChain;
+        if (!Index.IsValid() || !ChainToRoot(*Index, targ, _et, TargChain) || !ChainToRoot(*Index, obs, _et, ObsChain))
+        {
+            if (!ErrorCheck(ResultCode, ErrorMessage))
+            {
+                *ResultCode = ES_ResultCode::Error;
+                *ErrorMessage = TEXT("MaxQ segment index has not been built");
+            }
+            return false;
+        }
+
+        // The first center common to both chains
+        const FLink* TargLink = nullptr;
+        const FLink* ObsLink = nullptr;
+        for (const FLink& Link : ObsChain)
+        {
+            TargLink = TargChain.FindByPredicate([&](const FLink& Other) { return Other.Center == Link.Center; });
+            if (TargLink)
+            {
+                ObsLink = &Link;
+                break;
+            }
+        }
+
+        if (!TargLink)
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("Insufficient ephemeris data has been loaded to compute the state of %d relative to %d at the ephemeris epoch %f"), targ, obs, _et);
+            return false;
+        }
+
+        SpiceDouble _state[6];
+        vsubg_c(TargLink->State, ObsLink->State, 6, _state);
+
+        if (ref != MaxQ::Constants::Name_J2000)
+        {
+            SpiceDouble _xform[6][6];
+            sxform_c("J2000", MaxQ::Core::ToANSIString(ref), _et, _xform);
+            mxvg_c(_xform, _state, 6, 6, _state);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        state = FSStateVector(_state);
+        lt = FSEphemerisPeriod(vnorm_c(_state) / clight_c());
+        *ResultCode = ES_ResultCode::Success;
+        return true;
+    }
+
+
+    SPICE_API bool Spkgeo(
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FName& targ,
+        const FSEphemerisTime& et,
+        const FName& ref,
+        const FName& obs,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MakeErrorGutter(ResultCode, ErrorMessage);
+
+        int _targ, _obs;
+        if (!MaxQ::Data::Bods2c(_targ, targ) || !MaxQ::Data::Bods2c(_obs, obs))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = FString::Printf(TEXT("Could not translate %s or %s to an NAIF ID code"), *targ.ToString(), *obs.ToString());
+            return false;
+        }
+
+        return Spkgeo(state, lt, _targ, et, ref, _obs, ResultCode, ErrorMessage);
+    }
+}
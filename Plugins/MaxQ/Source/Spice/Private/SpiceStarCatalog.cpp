@@ -0,0 +1,800 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStarCatalog.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Star fields from SPICE type 1 star catalogs
+//
+// Each star is indexed at J2000:  its direction u, and its proper motion as
+// a vector w tangent to the sky (radians per Julian year).  Its apparent
+// direction at t Julian years past J2000, seen moving at v, is
+//
+//   p  = (u + w t) / |u + w t|
+//   p' = p (sqrt(1 - |p x b|^2) - p . b) + b        b = v / c
+//
+// p' is stelab's:  p rotated toward b by asin(|p x b|), with no trig.
+//
+// Neither moves a star farther than |w| |t| + asin(|b|) from where it's
+// indexed, so a query pads each cell's extent by that much, and then tests
+// the stars' apparent directions exactly.  The stars of a cell are
+// contiguous, so each overlapping cell is one batch:  transformed into the
+// selection, then compacted to the ones that pass.
+//
+// A cube face's coordinates (s, t) are the other two components over the
+// major one's magnitude, and its cells are uniform in atan(s) & atan(t), so
+// they're much closer to equal areas than cells uniform in s & t.  Lines of
+// constant s (or t) are great circles, so a cell's extent is its center's
+// angle to its farthest corner.
+//
+// stcl01, stcf01 & stcg01 have no CSPICE wrappers, so they're called through
+// f2c (as Spice.cpp calls ev2lin).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStarCatalog.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceStarCatalog.h"
+#include "Async/ParallelFor.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+
+// for stcl01, stcf01, stcg01
+#include "SpiceZfc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Stars;
+
+    // jyear_c, clight_c
+    constexpr double JulianYear = 31557600.;
+    constexpr double SpeedOfLight = 299792.458;
+
+    // Faces +X, -X, +Y, -Y, +Z, -Z
+    int32 CellOf(double x, double y, double z, int32 Resolution)
+    {
+        const double ax = FMath::Abs(x), ay = FMath::Abs(y), az = FMath::Abs(z);
+        int32 Face;
+        double m, s, t;
+        if (ax >= ay && ax >= az)
+        {
+            Face = x >= 0. ? 0 : 1; m = ax; s = y; t = z;
+        }
+        else if (ay >= az)
+        {
+            Face = y >= 0. ? 2 : 3; m = ay; s = z; t = x;
+        }
+        else
+        {
+            Face = z >= 0. ? 4 : 5; m = az; s = x; t = y;
+        }
+
+        // atan(s) & atan(t) are within +/- pi/4
+        const double Scale = 2. * Resolution / PI;
+        const int32 i = FMath::Clamp((int32)FMath::FloorToDouble(FMath::Atan(s / m) * Scale + 0.5 * Resolution), 0, Resolution - 1);
+        const int32 j = FMath::Clamp((int32)FMath::FloorToDouble(FMath::Atan(t / m) * Scale + 0.5 * Resolution), 0, Resolution - 1);
+        return (Face * Resolution + j) * Resolution + i;
+    }
+
+    // The unit vector at face coordinates atan(s) = a, atan(t) = b
+    FVector3d FacePoint(int32 Face, double a, double b)
+    {
+        const double s = FMath::Tan(a), t = FMath::Tan(b);
+        switch (Face)
+        {
+        case 0: return FVector3d(1., s, t).GetSafeNormal();
+        case 1: return FVector3d(-1., s, t).GetSafeNormal();
+        case 2: return FVector3d(t, 1., s).GetSafeNormal();
+        case 3: return FVector3d(t, -1., s).GetSafeNormal();
+        case 4: return FVector3d(s, t, 1.).GetSafeNormal();
+        default: return FVector3d(s, t, -1.).GetSafeNormal();
+        }
+    }
+
+    // Main sequence temperatures at subclass 0, O through M (then L), K
+    float SpectralTemperature(const ANSICHAR* SpectralType)
+    {
+        static const ANSICHAR Classes[] = "OBAFGKM";
+        static const float Temperatures[] = { 50000.f, 30000.f, 10000.f, 7400.f, 6000.f, 5300.f, 3900.f, 2400.f };
+
+        for (int32 k = 0; k < 7; ++k)
+        {
+            if (SpectralType[0] == Classes[k])
+            {
+                const ANSICHAR Subclass = SpectralType[1];
+                const float Fraction = (Subclass >= '0' && Subclass <= '9') ? (Subclass - '0') / 10.f : 0.5f;
+                return FMath::Lerp(Temperatures[k], Temperatures[k + 1], Fraction);
+            }
+        }
+        return 0.f;
+    }
+
+    // Proper motion, then aberration, for a batch of stars
+    struct FApparent
+    {
+        double Years;
+        double bx, by, bz, b2;
+
+        explicit FApparent(const FStarQuery& Query)
+        {
+            Years = Query.et / JulianYear;
+            bx = Query.Velocity.X / SpeedOfLight;
+            by = Query.Velocity.Y / SpeedOfLight;
+            bz = Query.Velocity.Z / SpeedOfLight;
+            b2 = bx * bx + by * by + bz * bz;
+        }
+
+        // How far a star can move from where it's indexed
+        double Pad(double MaxProperMotion) const
+        {
+            return MaxProperMotion * FMath::Abs(Years) + FMath::Asin(FMath::Min(FMath::Sqrt(b2), 1.)) + 1e-9;
+        }
+
+        void operator()(int32 Num, const double* X, const double* Y, const double* Z, const double* PX, const double* PY, const double* PZ, double* OX, double* OY, double* OZ) const
+        {
+            for (int32 k = 0; k < Num; ++k)
+            {
+                double x = X[k] + PX[k] * Years;
+                double y = Y[k] + PY[k] * Years;
+                double z = Z[k] + PZ[k] * Years;
+                const double r = 1. / FMath::Sqrt(x * x + y * y + z * z);
+                x *= r; y *= r; z *= r;
+
+                const double pb = x * bx + y * by + z * bz;
+                const double c = FMath::Sqrt(FMath::Max(0., 1. - (b2 - pb * pb))) - pb;
+                OX[k] = x * c + bx;
+                OY[k] = y * c + by;
+                OZ[k] = z * c + bz;
+            }
+        }
+    };
+}
+
+
+namespace MaxQ::Stars
+{
+    void FStarSelection::Reset()
+    {
+        Stars.Reset();
+        X.Reset();
+        Y.Reset();
+        Z.Reset();
+        Magnitude.Reset();
+    }
+
+    void FStarSelection::SetNum(int32 Count)
+    {
+        Stars.SetNumUninitialized(Count, false);
+        X.SetNumUninitialized(Count, false);
+        Y.SetNumUninitialized(Count, false);
+        Z.SetNumUninitialized(Count, false);
+        Magnitude.SetNumUninitialized(Count, false);
+    }
+
+
+    void FStarCatalog::Build(const TArray<FStar>& stars, const FStarCatalogSettings& Settings)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Stars::FStarCatalog::Build);
+
+        Resolution = FMath::Max(1, Settings.Resolution);
+        const int32 Count = Cells();
+
+        struct FEntry
+        {
+            int32 Cell;
+            int32 Star;
+            FVector3d Direction;
+            FVector3d Motion;
+        };
+
+        TArray<FEntry> Entries;
+        Entries.Reserve(stars.Num());
+        for (int32 i = 0; i < stars.Num(); ++i)
+        {
+            const FStar& Star = stars[i];
+            if (!(Star.Magnitude <= Settings.MaxMagnitude))
+            {
+                continue;
+            }
+
+            // Back to J2000
+            const double ra = Star.RA - Star.RaProperMotion * Star.RaEpoch / JulianYear;
+            const double dec = Star.Dec - Star.DecProperMotion * Star.DecEpoch / JulianYear;
+            const double cr = FMath::Cos(ra), sr = FMath::Sin(ra), cd = FMath::Cos(dec), sd = FMath::Sin(dec);
+
+            FEntry& Entry = Entries.AddDefaulted_GetRef();
+            Entry.Star = i;
+            Entry.Direction = FVector3d(cd * cr, cd * sr, sd);
+            Entry.Motion = FVector3d(-sr, cr, 0.) * (Star.RaProperMotion * cd) + FVector3d(-sd * cr, -sd * sr, cd) * Star.DecProperMotion;
+            Entry.Cell = CellOf(Entry.Direction.X, Entry.Direction.Y, Entry.Direction.Z, Resolution);
+        }
+
+        Entries.Sort([&stars](const FEntry& A, const FEntry& B)
+        {
+            if (A.Cell != B.Cell) return A.Cell < B.Cell;
+            if (stars[A.Star].Magnitude != stars[B.Star].Magnitude) return stars[A.Star].Magnitude < stars[B.Star].Magnitude;
+            return A.Star < B.Star;
+        });
+
+        // stars may be Stars itself
+        TArray<FStar> Indexed;
+        const int32 Num = Entries.Num();
+        Indexed.SetNumUninitialized(Num);
+        X.SetNumUninitialized(Num);
+        Y.SetNumUninitialized(Num);
+        Z.SetNumUninitialized(Num);
+        PX.SetNumUninitialized(Num);
+        PY.SetNumUninitialized(Num);
+        PZ.SetNumUninitialized(Num);
+        Magnitude.SetNumUninitialized(Num);
+        Temperature.SetNumUninitialized(Num);
+        CellStart.SetNumZeroed(Count + 1);
+        MaxProperMotion = 0.;
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const FEntry& Entry = Entries[i];
+            Indexed[i] = stars[Entry.Star];
+            X[i] = Entry.Direction.X;
+            Y[i] = Entry.Direction.Y;
+            Z[i] = Entry.Direction.Z;
+            PX[i] = Entry.Motion.X;
+            PY[i] = Entry.Motion.Y;
+            PZ[i] = Entry.Motion.Z;
+            Magnitude[i] = (float)Indexed[i].Magnitude;
+            Temperature[i] = SpectralTemperature(Indexed[i].SpectralType);
+            MaxProperMotion = FMath::Max(MaxProperMotion, Entry.Motion.Length());
+            ++CellStart[Entry.Cell + 1];
+        }
+        for (int32 Cell = 0; Cell < Count; ++Cell)
+        {
+            CellStart[Cell + 1] += CellStart[Cell];
+        }
+        Stars = MoveTemp(Indexed);
+
+        CellCenter.SetNumUninitialized(Count);
+        CellCos.SetNumUninitialized(Count);
+        CellSin.SetNumUninitialized(Count);
+        MaxCellExtent = 0.;
+
+        const double Step = HALF_PI / Resolution;
+        for (int32 Face = 0; Face < 6; ++Face)
+        {
+            for (int32 j = 0; j < Resolution; ++j)
+            {
+                for (int32 i = 0; i < Resolution; ++i)
+                {
+                    const int32 Cell = (Face * Resolution + j) * Resolution + i;
+                    const double a = -0.25 * PI + i * Step, b = -0.25 * PI + j * Step;
+                    const FVector3d Center = FacePoint(Face, a + 0.5 * Step, b + 0.5 * Step);
+
+                    double MinCos = 1.;
+                    MinCos = FMath::Min(MinCos, Center | FacePoint(Face, a, b));
+                    MinCos = FMath::Min(MinCos, Center | FacePoint(Face, a + Step, b));
+                    MinCos = FMath::Min(MinCos, Center | FacePoint(Face, a, b + Step));
+                    MinCos = FMath::Min(MinCos, Center | FacePoint(Face, a + Step, b + Step));
+
+                    const double Extent = FMath::Acos(FMath::Clamp(MinCos, -1., 1.));
+                    CellCenter[Cell] = Center;
+                    CellCos[Cell] = FMath::Cos(Extent);
+                    CellSin[Cell] = FMath::Sin(Extent);
+                    MaxCellExtent = FMath::Max(MaxCellExtent, Extent);
+                }
+            }
+        }
+    }
+
+
+    template<class FCellTest, class FStarTest>
+    void FStarCatalog::Select(FStarSelection& Selection, const FStarQuery& Query, FStarQueryStats* Stats, FCellTest CellTest, FStarTest StarTest) const
+    {
+        FStarQueryStats LocalStats;
+        if (!Stats) Stats = &LocalStats;
+        *Stats = FStarQueryStats();
+
+        const double StartSeconds = FPlatformTime::Seconds();
+        Selection.Reset();
+
+        const FApparent Transform(Query);
+        const int32 Count = CellStart.Num() - 1;
+        for (int32 Cell = 0; Cell < Count; ++Cell)
+        {
+            const int32 Begin = CellStart[Cell];
+            const int32 CellEnd = CellStart[Cell + 1];
+            if (Begin == CellEnd || Magnitude[Begin] > Query.MaxMagnitude || !CellTest(Cell))
+            {
+                continue;
+            }
+
+            // Brightest first:  just the ones bright enough
+            int32 End = Begin + 1;
+            while (End < CellEnd && Magnitude[End] <= Query.MaxMagnitude)
+            {
+                ++End;
+            }
+
+            const int32 First = Selection.Num();
+            const int32 Num = End - Begin;
+            ++Stats->Cells;
+            Stats->Tested += Num;
+
+            Selection.SetNum(First + Num);
+            Transform(Num, X.GetData() + Begin, Y.GetData() + Begin, Z.GetData() + Begin, PX.GetData() + Begin, PY.GetData() + Begin, PZ.GetData() + Begin,
+                Selection.X.GetData() + First, Selection.Y.GetData() + First, Selection.Z.GetData() + First);
+
+            int32 Kept = First;
+            for (int32 k = 0; k < Num; ++k)
+            {
+                const int32 From = First + k;
+                if (StarTest(Selection.X[From], Selection.Y[From], Selection.Z[From]))
+                {
+                    Selection.X[Kept] = Selection.X[From];
+                    Selection.Y[Kept] = Selection.Y[From];
+                    Selection.Z[Kept] = Selection.Z[From];
+                    Selection.Stars[Kept] = Begin + k;
+                    Selection.Magnitude[Kept] = Magnitude[Begin + k];
+                    ++Kept;
+                }
+            }
+            Selection.SetNum(Kept);
+        }
+
+        Stats->Selected = Selection.Num();
+        Stats->Seconds = FPlatformTime::Seconds() - StartSeconds;
+    }
+
+
+    void FStarCatalog::Cone(FStarSelection& Selection, const FVector3d& Axis, double Radius, const FStarQuery& Query, FStarQueryStats* Stats) const
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Stars::FStarCatalog::Cone);
+
+        const FVector3d A = Axis.GetSafeNormal();
+        if (A.IsZero() || Radius < 0.)
+        {
+            Selection.Reset();
+            if (Stats) *Stats = FStarQueryStats();
+            return;
+        }
+
+        const double Reach = Radius + FApparent(Query).Pad(MaxProperMotion);
+        const double CosRadius = FMath::Cos(Radius);
+        const double CosReach = FMath::Cos(Reach), SinReach = FMath::Sin(Reach);
+        const bool bAll = Reach + MaxCellExtent >= PI;
+
+        Select(Selection, Query, Stats,
+            [&](int32 Cell)
+            {
+                // The cell's center is within Reach + its extent of the axis
+                return bAll || (CellCenter[Cell] | A) >= CosReach * CellCos[Cell] - SinReach * CellSin[Cell];
+            },
+            [&](double x, double y, double z)
+            {
+                return x * A.X + y * A.Y + z * A.Z >= CosRadius;
+            });
+    }
+
+
+    void FStarCatalog::Cone(FStarSelection& Selection, double RA, double Dec, double Radius, const FStarQuery& Query, FStarQueryStats* Stats) const
+    {
+        const double cd = FMath::Cos(Dec);
+        Cone(Selection, FVector3d(cd * FMath::Cos(RA), cd * FMath::Sin(RA), FMath::Sin(Dec)), Radius, Query, Stats);
+    }
+
+
+    void FStarCatalog::Frustum(FStarSelection& Selection, const TArray<FVector3d>& Planes, const FStarQuery& Query, FStarQueryStats* Stats) const
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Stars::FStarCatalog::Frustum);
+
+        const double Pad = FApparent(Query).Pad(MaxProperMotion);
+        const double CosPad = FMath::Cos(Pad), SinPad = FMath::Sin(Pad);
+        const bool bAll = Pad + MaxCellExtent >= HALF_PI;
+
+        Select(Selection, Query, Stats,
+            [&](int32 Cell)
+            {
+                // The cell's center is within 90 degrees + Pad + its extent
+                // of every plane's normal
+                if (bAll)
+                {
+                    return true;
+                }
+                const double Reach = CellSin[Cell] * CosPad + CellCos[Cell] * SinPad;
+                for (const FVector3d& Plane : Planes)
+                {
+                    if ((CellCenter[Cell] | Plane) < -Reach)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            },
+            [&](double x, double y, double z)
+            {
+                for (const FVector3d& Plane : Planes)
+                {
+                    if (x * Plane.X + y * Plane.Y + z * Plane.Z < 0.)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            });
+    }
+
+
+    void FStarCatalog::Apparent(FStarSelection& Selection, const TArray<int32>& stars, const FStarQuery& Query) const
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Stars::FStarCatalog::Apparent);
+
+        constexpr int32 StarsPerTask = 4096;
+
+        const int32 Num = stars.Num();
+        Selection.Reset();
+        Selection.SetNum(Num);
+
+        const FApparent Transform(Query);
+        ParallelFor(FMath::DivideAndRoundUp(Num, StarsPerTask), [&](int32 Task)
+        {
+            const int32 Begin = Task * StarsPerTask;
+            const int32 End = FMath::Min(Num, Begin + StarsPerTask);
+            for (int32 k = Begin; k < End; ++k)
+            {
+                const int32 i = stars[k];
+                Transform(1, &X[i], &Y[i], &Z[i], &PX[i], &PY[i], &PZ[i], &Selection.X[k], &Selection.Y[k], &Selection.Z[k]);
+                Selection.Stars[k] = i;
+                Selection.Magnitude[k] = Magnitude[i];
+            }
+        });
+    }
+
+
+    void FStarCatalog::ToInstances(const FStarSelection& Selection, TArray<FVector4f>& Instances, TArray<FLinearColor>* Colors) const
+    {
+        const int32 Num = Selection.Num();
+        Instances.SetNumUninitialized(Num);
+        for (int32 k = 0; k < Num; ++k)
+        {
+            Instances[k] = FVector4f((float)Selection.X[k], (float)Selection.Y[k], (float)Selection.Z[k], Selection.Magnitude[k]);
+        }
+
+        if (Colors)
+        {
+            Colors->SetNumUninitialized(Num);
+            for (int32 k = 0; k < Num; ++k)
+            {
+                const float Kelvin = Temperature[Selection.Stars[k]];
+                (*Colors)[k] = Kelvin > 0.f ? FLinearColor::MakeFromColorTemperature(Kelvin) : FLinearColor::White;
+            }
+        }
+    }
+
+
+    void MakeFrustum(TArray<FVector3d>& Planes, const FVector3d& Forward, const FVector3d& Up, double HalfWidth, double HalfHeight)
+    {
+        const FVector3d F = Forward.GetSafeNormal();
+        const FVector3d R = (F ^ Up).GetSafeNormal();
+        const FVector3d U = R ^ F;
+
+        // Each side's normal is perpendicular to its edge, F cos(h) +/- R sin(h)
+        const double cw = FMath::Cos(HalfWidth), sw = FMath::Sin(HalfWidth);
+        const double ch = FMath::Cos(HalfHeight), sh = FMath::Sin(HalfHeight);
+
+        Planes.Reset();
+        Planes.Add(F * sw - R * cw);
+        Planes.Add(F * sw + R * cw);
+        Planes.Add(F * sh - U * ch);
+        Planes.Add(F * sh + U * ch);
+    }
+
+
+    bool LoadCatalog(
+        TArray<FStar>& Stars,
+        const FString& relativePath,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Stars::LoadCatalog);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        Stars.Reset();
+
+        const FString Path = toPath(relativePath);
+        auto _path = StringCast<ANSICHAR>(*Path);
+
+        // Blank padded (Fortran)
+        ANSICHAR _table[SPICE_EK_TSTRLN];
+        integer _handle = 0;
+        stcl01_(const_cast<ANSICHAR*>(_path.Get()), _table, &_handle, (ftnlen)_path.Length(), (ftnlen)(SPICE_EK_TSTRLN - 1));
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        _table[SPICE_EK_TSTRLN - 1] = '\0';
+        for (int32 n = SPICE_EK_TSTRLN - 2; n >= 0 && _table[n] == ' '; --n)
+        {
+            _table[n] = '\0';
+        }
+
+        // The whole sky
+        doublereal _westra = 0., _eastra = twopi_c(), _sthdec = -halfpi_c(), _nthdec = halfpi_c();
+        integer _nstars = 0;
+        stcf01_(_table, &_westra, &_eastra, &_sthdec, &_nthdec, &_nstars, (ftnlen)FCStringAnsi::Strlen(_table));
+
+        TMap<int32, int32> ByCatalogNumber;
+        Stars.Reserve(_nstars);
+        for (integer _index = 1; _index <= _nstars && !failed_c(); ++_index)
+        {
+            doublereal _ra = 0., _dec = 0., _rasig = 0., _decsig = 0., _vmag = 0.;
+            integer _catnum = 0;
+            ANSICHAR _sptype[4];
+            stcg01_(&_index, &_ra, &_dec, &_rasig, &_decsig, &_catnum, _sptype, &_vmag, (ftnlen)sizeof(_sptype));
+
+            FStar& Star = Stars.AddDefaulted_GetRef();
+            Star.CatalogNumber = _catnum;
+            Star.RA = _ra;
+            Star.Dec = _dec;
+            Star.RaSigma = _rasig;
+            Star.DecSigma = _decsig;
+            Star.Magnitude = _vmag;
+            FMemory::Memcpy(Star.SpectralType, _sptype, sizeof(_sptype));
+            ByCatalogNumber.Add(_catnum, Stars.Num() - 1);
+        }
+
+        // Proper motions, if the table has them
+        bool bRaPm = false, bDecPm = false, bRaEpoch = false, bDecEpoch = false;
+        SpiceInt _ccount = 0;
+        if (!failed_c())
+        {
+            ekccnt_c(_table, &_ccount);
+        }
+        for (SpiceInt _cindex = 0; _cindex < _ccount && !failed_c(); ++_cindex)
+        {
+            SpiceChar _column[SPICE_EK_CSTRLN];
+            SpiceEKAttDsc _attdsc;
+            ekcii_c(_table, _cindex, sizeof(_column), _column, &_attdsc);
+            bRaPm |= !strcmp(_column, "RA_PM");
+            bDecPm |= !strcmp(_column, "DEC_PM");
+            bRaEpoch |= !strcmp(_column, "RA_EPOCH");
+            bDecEpoch |= !strcmp(_column, "DEC_EPOCH");
+        }
+
+        if (bRaPm && bDecPm && !failed_c())
+        {
+            const FString Query = FString::Printf(TEXT("SELECT CATALOG_NUMBER, RA_PM, DEC_PM%s%s FROM %s"),
+                bRaEpoch ? TEXT(", RA_EPOCH") : TEXT(""), bDecEpoch ? TEXT(", DEC_EPOCH") : TEXT(""), ANSI_TO_TCHAR(_table));
+
+            SpiceInt _nmrows = 0;
+            SpiceBoolean _error = SPICEFALSE;
+            SpiceChar _errmsg[SPICE_MAX_PATH];
+            ekfind_c(TCHAR_TO_ANSI(*Query), sizeof(_errmsg), &_nmrows, &_error, _errmsg);
+            if (_error && !failed_c())
+            {
+                setmsg_c("Star catalog proper motion query failed: #");
+                errch_c("#", _errmsg);
+                sigerr_c("SPICE(QUERYFAILURE)");
+            }
+
+            for (SpiceInt _row = 0; _row < _nmrows && !failed_c(); ++_row)
+            {
+                SpiceInt _catnum = 0;
+                SpiceDouble _values[4] = { 0., 0., 2000., 2000. };
+                SpiceBoolean _null = SPICEFALSE, _found = SPICEFALSE;
+                ekgi_c(0, _row, 0, &_catnum, &_null, &_found);
+
+                SpiceInt _selidx = 1;
+                for (int32 k = 0; k < 4; ++k)
+                {
+                    if ((k == 2 && !bRaEpoch) || (k == 3 && !bDecEpoch))
+                    {
+                        continue;
+                    }
+                    SpiceDouble _value = 0.;
+                    ekgd_c(_selidx++, _row, 0, &_value, &_null, &_found);
+                    if (!_null)
+                    {
+                        _values[k] = _value;
+                    }
+                }
+
+                if (const int32* Index = ByCatalogNumber.Find(_catnum))
+                {
+                    // Degrees per Julian year, Julian years
+                    FStar& Star = Stars[*Index];
+                    Star.RaProperMotion = _values[0] * rpd_c();
+                    Star.DecProperMotion = _values[1] * rpd_c();
+                    Star.RaEpoch = (_values[2] - 2000.) * JulianYear;
+                    Star.DecEpoch = (_values[3] - 2000.) * JulianYear;
+                }
+            }
+        }
+
+        // Unload it whatever happened, keeping the first error
+        const bool bFailed = ErrorCheck(ResultCode, ErrorMessage);
+        ekuef_c(_handle);
+        if (bFailed)
+        {
+            Stars.Reset();
+            ES_ResultCode IgnoredResultCode;
+            FString IgnoredErrorMessage;
+            ErrorCheck(IgnoredResultCode, IgnoredErrorMessage, true);
+            return false;
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    bool LoadCatalog(
+        FStarCatalog& Catalog,
+        const FString& relativePath,
+        const FStarCatalogSettings& Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        TArray<FStar> Stars;
+        if (!LoadCatalog(Stars, relativePath, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        Catalog.Build(Stars, Settings);
+        return true;
+    }
+
+
+    bool WriteCatalog(
+        const FString& relativePath,
+        const FString& Table,
+        const TArray<FStar>& Stars,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Stars::WriteCatalog);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        const int32 Num = Stars.Num();
+        if (!Num || Table.IsEmpty())
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("A star catalog needs a table name, and one or more stars");
+            return false;
+        }
+
+        // stcc01's columns, then the proper motions
+        constexpr int32 Columns = 11;
+        constexpr int32 DeclarationLength = 64;
+        static const SpiceChar _cnames[Columns][SPICE_EK_CSTRLN] =
+        {
+            "CATALOG_NUMBER", "RA", "DEC", "RA_SIGMA", "DEC_SIGMA", "VISUAL_MAGNITUDE", "SPECTRAL_TYPE",
+            "RA_PM", "DEC_PM", "RA_EPOCH", "DEC_EPOCH"
+        };
+        static const SpiceChar _decls[Columns][DeclarationLength] =
+        {
+            "DATATYPE = INTEGER, INDEXED = TRUE",
+            "DATATYPE = DOUBLE PRECISION, INDEXED = TRUE",
+            "DATATYPE = DOUBLE PRECISION, INDEXED = TRUE",
+            "DATATYPE = DOUBLE PRECISION",
+            "DATATYPE = DOUBLE PRECISION",
+            "DATATYPE = DOUBLE PRECISION, INDEXED = TRUE",
+            "DATATYPE = CHARACTER*(4)",
+            "DATATYPE = DOUBLE PRECISION",
+            "DATATYPE = DOUBLE PRECISION",
+            "DATATYPE = DOUBLE PRECISION",
+            "DATATYPE = DOUBLE PRECISION"
+        };
+
+        const FString Path = toPath(relativePath);
+        if (FPaths::FileExists(Path))
+        {
+            IFileManager::Get().Delete(*Path);
+        }
+
+        auto _path = StringCast<ANSICHAR>(*Path);
+        auto _table = StringCast<ANSICHAR>(*Table);
+        SpiceInt _handle = 0;
+        ekopn_c(_path.Get(), "MAXQ STAR CATALOG", 0, &_handle);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        TArray<SpiceInt> _rcptrs, _wkindx, _entszs, _ivals;
+        TArray<SpiceBoolean> _nlflgs;
+        TArray<SpiceDouble> _dvals;
+        TArray<SpiceChar> _cvals;
+        _rcptrs.SetNumZeroed(Num);
+        _wkindx.SetNumZeroed(Num);
+        _entszs.Init(1, Num);
+        _nlflgs.Init(SPICEFALSE, Num);
+        _ivals.SetNumUninitialized(Num);
+        _dvals.SetNumUninitialized(Num);
+        _cvals.SetNumZeroed(Num * 5);
+
+        SpiceInt _segno = 0;
+        ekifld_c(_handle, _table.Get(), Columns, Num, SPICE_EK_CSTRLN, _cnames, DeclarationLength, _decls, &_segno, _rcptrs.GetData());
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            _ivals[i] = Stars[i].CatalogNumber;
+            FMemory::Memcpy(&_cvals[i * 5], Stars[i].SpectralType, 4);
+        }
+        if (!failed_c())
+        {
+            ekacli_c(_handle, _segno, "CATALOG_NUMBER", _ivals.GetData(), _entszs.GetData(), _nlflgs.GetData(), _rcptrs.GetData(), _wkindx.GetData());
+        }
+        if (!failed_c())
+        {
+            ekaclc_c(_handle, _segno, "SPECTRAL_TYPE", 5, _cvals.GetData(), _entszs.GetData(), _nlflgs.GetData(), _rcptrs.GetData(), _wkindx.GetData());
+        }
+
+        // Degrees, degrees per Julian year, Julian years
+        static const SpiceChar* _dcolumns[] = { "RA", "DEC", "RA_SIGMA", "DEC_SIGMA", "VISUAL_MAGNITUDE", "RA_PM", "DEC_PM", "RA_EPOCH", "DEC_EPOCH" };
+        const double dpr = dpr_c();
+        const auto Value = [dpr](int32 Column, const FStar& Star)
+        {
+            switch (Column)
+            {
+            case 0: return Star.RA * dpr;
+            case 1: return Star.Dec * dpr;
+            case 2: return Star.RaSigma * dpr;
+            case 3: return Star.DecSigma * dpr;
+            case 4: return Star.Magnitude;
+            case 5: return Star.RaProperMotion * dpr;
+            case 6: return Star.DecProperMotion * dpr;
+            case 7: return 2000. + Star.RaEpoch / JulianYear;
+            default: return 2000. + Star.DecEpoch / JulianYear;
+            }
+        };
+
+        for (int32 c = 0; c < (int32)UE_ARRAY_COUNT(_dcolumns) && !failed_c(); ++c)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                _dvals[i] = Value(c, Stars[i]);
+            }
+            ekacld_c(_handle, _segno, _dcolumns[c], _dvals.GetData(), _entszs.GetData(), _nlflgs.GetData(), _rcptrs.GetData(), _wkindx.GetData());
+        }
+
+        if (!failed_c())
+        {
+            ekffld_c(_handle, _segno, _rcptrs.GetData());
+        }
+
+        // Close it whatever happened, keeping the first error
+        const bool bFailed = ErrorCheck(ResultCode, ErrorMessage);
+        ekcls_c(_handle);
+        if (bFailed)
+        {
+            ES_ResultCode IgnoredResultCode;
+            FString IgnoredErrorMessage;
+            ErrorCheck(IgnoredResultCode, IgnoredErrorMessage, true);
+            return false;
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+}
@@ -142,6 +142,12 @@ FString FSComplexScalar::ToString() const
 
 FString FSEphemerisTime::ToString() const
 {
+    FString utcstr;
+    if (MaxQ::Time::TryEt2Utc(*this, ES_UTCTimeFormat::Calendar, 4, utcstr))
+    {
+        return utcstr + TEXT(" UTC");
+    }
+
     SpiceChar sz[SPICE_MAX_PATH];
     memset(sz, 0, sizeof(sz));
 
@@ -163,6 +169,12 @@ FString FSEphemerisTime::ToString(ES_UTCTimeFormat TimeFormat, int precision /*=
 
 FSEphemerisTime FSEphemerisTime::FromString(const FString& Str)
 {
+    FSEphemerisTime Native;
+    if (MaxQ::Time::TryStr2Et(Str, Native))
+    {
+        return Native;
+    }
+
     double et = 0.;
     str2et_c(TCHAR_TO_ANSI(*Str), &et);
 
@@ -230,6 +242,65 @@ FString FSStateVector::ToString() const
     return FString::Printf(TEXT("[(%s, %s, %s); (%s, %s, %s)]"), *USpiceTypes::FormatDouble(r.x.km), *USpiceTypes::FormatDouble(r.y.km), *USpiceTypes::FormatDouble(r.z.km), *USpiceTypes::FormatDouble(v.dx.kmps), *USpiceTypes::FormatDouble(v.dy.kmps), *USpiceTypes::FormatDouble(v.dz.kmps));
 }
 
+void FSStateVectorBuffer::CopyFrom(const TArray<FSStateVector>& States)
+{
+    const int32 Count = States.Num();
+    SetNum(Count);
+
+    for (int32 i = 0; i < Count; ++i)
+    {
+        Set(i, States[i]);
+    }
+}
+
+void FSStateVectorBuffer::CopyTo(TArray<FSStateVector>& States) const
+{
+    const int32 Count = Num();
+    States.SetNum(Count);
+
+    for (int32 i = 0; i < Count; ++i)
+    {
+        States[i] = Get(i);
+    }
+}
+
+void FSStateVectorBuffer::Gather(int32 Start, int32 Count, double(*states)[6]) const
+{
+    check(Start >= 0 && Start + Count <= Num());
+
+    for (int32 i = 0; i < Count; ++i)
+    {
+        CopyTo(Start + i, states[i]);
+    }
+}
+
+void FSStateVectorBuffer::Scatter(int32 Start, int32 Count, const double(*states)[6])
+{
+    check(Start >= 0 && Start + Count <= Num());
+
+    for (int32 i = 0; i < Count; ++i)
+    {
+        CopyFrom(Start + i, states[i]);
+    }
+}
+
+void FSStateVectorBuffer::GatherPositions(int32 Start, int32 Count, double(*positions)[3]) const
+{
+    check(Start >= 0 && Start + Count <= Num());
+
+    for (int32 i = 0; i < Count; ++i)
+    {
+        positions[i][0] = x[Start + i];
+        positions[i][1] = y[Start + i];
+        positions[i][2] = z[Start + i];
+    }
+}
+
+FString FSStateVectorBuffer::ToString() const
+{
+    return FString::Printf(TEXT("[%d state vectors]"), Num());
+}
+
 FString FSCylindricalVector::ToString() const
 {
     return FString::Printf(TEXT("(%s, %s, %s)"), *USpiceTypes::FormatDouble(r.km), *USpiceTypes::FormatDouble(lon.degrees), *USpiceTypes::FormatDouble(z.km));
@@ -0,0 +1,586 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTime.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Native, thread-safe UTC <-> ET (TDB) conversion
+//
+// The table build, UTC <-> TAI and TAI <-> TDB steps mirror CSPICE's ttrans.c
+// and unitim.c; the formatting mirrors et2utc.c.  Day numbers count days past
+// 1 Jan 0001 (proleptic Gregorian), as in ttrans.  Keep the order of floating
+// point operations as-is, it's what keeps the results bit-identical to CSPICE.
+//
+// The table is immutable once built.  Readers take a reference under a read
+// lock, so a refresh on the game thread never disturbs a conversion in flight.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTime.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceTime.h"
+#include "Algo/BinarySearch.h"
+#include "Misc/ScopeRWLock.h"
+#include "SpiceUtilities.h"
+#include "SpiceLog.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double SecondsPerDay = 86400.;
+    constexpr double HalfDay = 43200.;
+
+    // ttrans.c's MAXLP: DELTET/DELTA_AT holds at most 140 (delta, epoch) pairs
+    constexpr int32 MaxDeltaAt = 280;
+
+    constexpr int32 DaysToJan0[12] { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+    constexpr int32 DaysInMonth[12] { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    constexpr const TCHAR* MonthNames[12] { TEXT("JAN"), TEXT("FEB"), TEXT("MAR"), TEXT("APR"), TEXT("MAY"), TEXT("JUN"), TEXT("JUL"), TEXT("AUG"), TEXT("SEP"), TEXT("OCT"), TEXT("NOV"), TEXT("DEC") };
+
+    // CSPICE parses dates before 15 Oct 1582 as Julian calendar dates.
+    // The native parser only handles the Gregorian years after that.
+    constexpr int32 MinParseYear = 1583;
+    constexpr int32 MaxYear = 9999;
+    // et2utc's own output range
+    constexpr int32 MinFormatYear = 1000;
+    constexpr int32 MaxNativePrecision = 13;
+
+    inline bool IsLeapYear(int32 Year)
+    {
+        return (Year % 4 == 0 && Year % 100 != 0) || Year % 400 == 0;
+    }
+
+    inline int32 DayNumber(int32 Year, int32 DayOfYear)
+    {
+        const int32 y = Year - 1;
+        return y * 365 + y / 4 - y / 100 + y / 400 + DayOfYear - 1;
+    }
+
+    inline int32 DaysBeforeMonth(int32 Year, int32 Month)
+    {
+        return DaysToJan0[Month - 1] + (Month > 2 && IsLeapYear(Year) ? 1 : 0);
+    }
+
+    const int32 DayNumber2000 = DayNumber(2000, 1);
+
+    // rmaind_: the remainder is always non-negative
+    inline void Rmaind(double Num, double Denom, double& Q, double& Rem)
+    {
+        Q = FMath::TruncToDouble(Num / Denom);
+        Rem = Num - Q * Denom;
+        if (Rem < 0.)
+        {
+            Q -= 1.;
+            Rem += Denom;
+        }
+    }
+
+    // Calendar date of a day number (ttrans's YMD from DAYNUM)
+    void Calendar(int32 Daynum, int32& Year, int32& Month, int32& Day, int32& DayOfYear)
+    {
+        int32 Yr400 = Daynum / 146097;
+        int32 Rem = Daynum - Yr400 * 146097;
+        if (Rem < 0)
+        {
+            --Yr400;
+            Rem += 146097;
+        }
+        const int32 Yr100 = FMath::Min(3, Rem / 36524);
+        Rem -= Yr100 * 36524;
+        const int32 Yr4 = FMath::Min(24, Rem / 1461);
+        Rem -= Yr4 * 1461;
+        const int32 Yr1 = FMath::Min(3, Rem / 365);
+        Rem -= Yr1 * 365;
+
+        DayOfYear = Rem + 1;
+        Year = Yr400 * 400 + Yr100 * 100 + Yr4 * 4 + Yr1 + 1;
+
+        Month = 12;
+        while (Month > 1 && DaysBeforeMonth(Year, Month) >= DayOfYear)
+        {
+            --Month;
+        }
+        Day = DayOfYear - DaysBeforeMonth(Year, Month);
+    }
+
+    struct FTimeTable
+    {
+        // DELTET/DELTA_T_A, K, EB, M
+        double DeltaTA = 0.;
+        double K = 0.;
+        double EB = 0.;
+        double M0 = 0.;
+        double M1 = 0.;
+
+        // For each leap second, the TAI & day number at the start of the
+        // day it's added to, then at the start of the day after it.
+        TArray<double> TaiTab;
+        TArray<int32> DayTab;
+
+        bool Build(const double* DeltaAt, int32 N)
+        {
+            TaiTab.SetNumUninitialized(N);
+            DayTab.SetNumUninitialized(N);
+
+            double LastDt = DeltaAt[0] - 1.;
+            for (int32 i = 0; i + 1 < N; i += 2)
+            {
+                const double Dt = DeltaAt[i];
+                const double Formal = DeltaAt[i + 1];
+
+                TaiTab[i] = Formal - SecondsPerDay + LastDt;
+                TaiTab[i + 1] = Formal + Dt;
+
+                const int32 Daynum = (int32)((Formal + HalfDay) / SecondsPerDay) + DayNumber2000;
+                DayTab[i] = Daynum - 1;
+                DayTab[i + 1] = Daynum;
+
+                LastDt = Dt;
+            }
+
+            for (int32 i = 1; i < N; ++i)
+            {
+                if (TaiTab[i - 1] >= TaiTab[i]) return false;
+            }
+            return true;
+        }
+
+        // Last index with Tab[i] <= Value, -1 if none
+        int32 LastTai(double Tai) const { return Algo::UpperBound(TaiTab, Tai) - 1; }
+        int32 LastDay(int32 Daynum) const { return Algo::UpperBound(DayTab, Daynum) - 1; }
+
+        double UtcToTai(int32 Daynum, double Secs) const
+        {
+            const int32 p = FMath::Max(0, LastDay(Daynum));
+            Secs += (double)(Daynum - DayTab[p]) * SecondsPerDay;
+            return TaiTab[p] + Secs;
+        }
+
+        void TaiToUtc(double Tai, int32& Daynum, double& Secs) const
+        {
+            int32 p = LastTai(Tai);
+
+            // Even entries open a leap second day, which runs past 86400
+            if (p >= 0 && p % 2 == 0)
+            {
+                Daynum = DayTab[p];
+                Secs = Tai - TaiTab[p];
+            }
+            else
+            {
+                p = FMath::Max(p, 0);
+                double Q;
+                Rmaind(Tai - TaiTab[p], SecondsPerDay, Q, Secs);
+                Daynum = (int32)Q + DayTab[p];
+            }
+        }
+
+        double TaiToTdb(double Tai) const
+        {
+            const double Tdt = Tai + DeltaTA;
+            return Tdt + K * FMath::Sin(M0 + M1 * Tdt + EB * FMath::Sin(M0 + M1 * Tdt));
+        }
+
+        double TdbToTai(double Tdb) const
+        {
+            double Tdt = Tdb;
+            for (int32 i = 0; i < 3; ++i)
+            {
+                Tdt = Tdb - K * FMath::Sin(M0 + M1 * Tdt + EB * FMath::Sin(M0 + M1 * Tdt));
+            }
+            return Tdt - DeltaTA;
+        }
+
+        // Length of a UTC day in seconds; 86401 on leap second days
+        double DayLength(int32 Daynum) const
+        {
+            const int32 p = LastDay(Daynum);
+            if (p >= 0 && p % 2 == 0 && p + 1 < TaiTab.Num())
+            {
+                return TaiTab[p + 1] - TaiTab[p];
+            }
+            return SecondsPerDay;
+        }
+    };
+
+    typedef TSharedPtr<const FTimeTable, ESPMode::ThreadSafe> FTimeTablePtr;
+
+    FRWLock TableLock;
+    FTimeTablePtr CurrentTable;
+
+    FTimeTablePtr GetTable()
+    {
+        FReadScopeLock Lock(TableLock);
+        return CurrentTable;
+    }
+
+    // CSPICE may be called to build it, on the game thread only
+    FTimeTablePtr GetOrRefreshTable()
+    {
+        FTimeTablePtr Table = GetTable();
+        if (!Table.IsValid() && IsInGameThread())
+        {
+            MaxQ::Time::RefreshConstants();
+            Table = GetTable();
+        }
+        return Table;
+    }
+
+    bool ReadPool(ConstSpiceChar* Name, SpiceInt Room, SpiceInt& N, SpiceDouble* Values)
+    {
+        SpiceBoolean Found = SPICEFALSE;
+        N = 0;
+        gdpool_c(Name, 0, Room, &N, Values, &Found);
+        return !UnexpectedErrorCheck() && Found && N > 0;
+    }
+
+
+    // ISO-8601 subset, see SpiceTime.h
+    bool Digits(const TCHAR*& p, int32 n, int32& Value)
+    {
+        Value = 0;
+        for (int32 i = 0; i < n; ++i)
+        {
+            if (p[i] < '0' || p[i] > '9') return false;
+            Value = Value * 10 + (p[i] - '0');
+        }
+        if (p[n] >= '0' && p[n] <= '9') return false;
+        p += n;
+        return true;
+    }
+
+    bool ParseIso(const FTimeTable& Table, const TCHAR* s, double& et)
+    {
+        const TCHAR* p = s;
+        while (*p == ' ') ++p;
+
+        int32 Year, Month = 0, Day = 0, DayOfYear = 0;
+        if (!Digits(p, 4, Year) || *p++ != '-') return false;
+
+        const TCHAR* q = p;
+        if (Digits(q, 3, DayOfYear))
+        {
+            p = q;
+        }
+        else if (!Digits(p, 2, Month) || *p++ != '-' || !Digits(p, 2, Day))
+        {
+            return false;
+        }
+
+        if (Year < MinParseYear || Year > MaxYear) return false;
+
+        int32 Hour = 0, Minute = 0;
+        double Second = 0.;
+        if (*p == 'T' || (*p == ' ' && p[1] >= '0' && p[1] <= '9'))
+        {
+            // A T without an hour is left to str2et_c
+            ++p;
+            if (!Digits(p, 2, Hour)) return false;
+            if (*p == ':')
+            {
+                ++p;
+                if (!Digits(p, 2, Minute)) return false;
+                if (*p == ':')
+                {
+                    ++p;
+                    if (p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9') return false;
+                    Second = (p[0] - '0') * 10 + (p[1] - '0');
+                    p += 2;
+                    if (*p == '.')
+                    {
+                        ++p;
+                        double Scale = 0.1;
+                        while (*p >= '0' && *p <= '9')
+                        {
+                            Second += (*p - '0') * Scale;
+                            Scale *= 0.1;
+                            ++p;
+                        }
+                    }
+                    else if (*p >= '0' && *p <= '9')
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        if (*p == 'Z') ++p;
+        while (*p == ' ') ++p;
+        if (*p) return false;
+
+        const int32 Leap = IsLeapYear(Year) ? 1 : 0;
+        if (DayOfYear)
+        {
+            if (DayOfYear < 1 || DayOfYear > 365 + Leap) return false;
+        }
+        else
+        {
+            if (Month < 1 || Month > 12 || Day < 1 || Day > DaysInMonth[Month - 1] + (Month == 2 ? Leap : 0)) return false;
+            DayOfYear = DaysBeforeMonth(Year, Month) + Day;
+        }
+
+        if (Hour > 23 || Minute > 59) return false;
+
+        const int32 Daynum = DayNumber(Year, DayOfYear);
+
+        // 23:59:60.x only on days that have a leap second
+        if (Second >= 60. && (Hour != 23 || Minute != 59 || Second >= Table.DayLength(Daynum) - 86340.)) return false;
+
+        const double Secs = Hour * 3600. + Minute * 60. + Second;
+        et = Table.TaiToTdb(Table.UtcToTai(Daynum, Secs));
+        return true;
+    }
+
+    bool FormatUtc(const FTimeTable& Table, double et, ES_UTCTimeFormat format, int prec, FString& utcstr)
+    {
+        if (prec > MaxNativePrecision) return false;
+
+        // et2utc_c rounds, then picks the calendar date, so a time that
+        // rounds up to the next second lands in the next day, as it should.
+        const int32 MyPrec = FMath::Max(0, prec);
+        const double Tai = Table.TdbToTai(et);
+
+        double WholeSecs = FMath::TruncToDouble(Tai);
+        if (Tai < 0. && Tai != WholeSecs) WholeSecs -= 1.;
+
+        const double Scale = FMath::RoundHalfFromZero(FMath::Pow(10., (double)MyPrec));
+        double FracSecs = FMath::RoundHalfFromZero(Scale * (Tai - WholeSecs));
+        if (FracSecs == Scale)
+        {
+            WholeSecs += 1.;
+            FracSecs = 0.;
+        }
+
+        int32 Daynum;
+        double Secs;
+        Table.TaiToUtc(WholeSecs, Daynum, Secs);
+
+        int32 Year, Month, Day, DayOfYear;
+        Calendar(Daynum, Year, Month, Day, DayOfYear);
+        if (Year < MinFormatYear || Year > MaxYear) return false;
+
+        // A leap second reads 23:59:60
+        const double ExtraSecs = FMath::Max(0., Secs - SecondsPerDay + 1.);
+        double TSecs = Secs - ExtraSecs;
+        double Hours, Temp, Minutes;
+        Rmaind(TSecs, 3600., Hours, Temp);
+        Rmaind(Temp, 60., Minutes, TSecs);
+        TSecs += ExtraSecs;
+
+        const int32 h = (int32)Hours, m = (int32)Minutes, s = (int32)TSecs;
+
+        switch (format)
+        {
+        case ES_UTCTimeFormat::Calendar:
+            utcstr = FString::Printf(TEXT("%d %s %02d %02d:%02d:%02d"), Year, MonthNames[Month - 1], Day, h, m, s);
+            break;
+        case ES_UTCTimeFormat::DayOfYear:
+            utcstr = FString::Printf(TEXT("%d-%03d // %02d:%02d:%02d"), Year, DayOfYear, h, m, s);
+            break;
+        case ES_UTCTimeFormat::ISOCalendar:
+            utcstr = FString::Printf(TEXT("%d-%02d-%02dT%02d:%02d:%02d"), Year, Month, Day, h, m, s);
+            break;
+        case ES_UTCTimeFormat::ISODayOfYear:
+            utcstr = FString::Printf(TEXT("%d-%03dT%02d:%02d:%02d"), Year, DayOfYear, h, m, s);
+            break;
+        default:
+            // JulianDate rounds through dpstrf, leave it to CSPICE
+            return false;
+        }
+
+        if (MyPrec > 0)
+        {
+            // FracSecs is a whole number below 10^MyPrec, so this is exact
+            FString Fraction = FString::Printf(TEXT("%lld"), (int64)FracSecs);
+            utcstr += TEXT(".");
+            utcstr += Fraction.LeftPad(MyPrec).Replace(TEXT(" "), TEXT("0"));
+        }
+
+        return true;
+    }
+
+    bool OffGameThread(ES_ResultCode* ResultCode, FString* ErrorMessage, const TCHAR* What, const FString& Value)
+    {
+        if (IsInGameThread()) return false;
+
+        *ResultCode = ES_ResultCode::Error;
+        *ErrorMessage = FString::Printf(TEXT("MaxQ::Time %s could not convert '%s' natively, and CSPICE may only be called from the game thread"), What, *Value);
+        return true;
+    }
+}
+
+
+namespace MaxQ::Time
+{
+    SPICE_API bool RefreshConstants()
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Time::RefreshConstants);
+        check(IsInGameThread());
+
+        // Leave a pending error (e.g. from furnsh_absolute) to its caller,
+        // the next refresh picks the pool up.
+        if (failed_c())
+        {
+            return HasConstants();
+        }
+
+        SpiceDouble DeltaAt[MaxDeltaAt];
+        SpiceDouble M[2];
+        SpiceDouble DeltaTA, K, EB;
+        SpiceInt n, nDeltaAt;
+
+        TSharedRef<FTimeTable, ESPMode::ThreadSafe> Table = MakeShared<FTimeTable, ESPMode::ThreadSafe>();
+
+        bool bValid =
+            ReadPool("DELTET/DELTA_AT", MaxDeltaAt, nDeltaAt, DeltaAt) && nDeltaAt % 2 == 0
+            && ReadPool("DELTET/DELTA_T_A", 1, n, &DeltaTA)
+            && ReadPool("DELTET/K", 1, n, &K)
+            && ReadPool("DELTET/EB", 1, n, &EB)
+            && ReadPool("DELTET/M", 2, n, M) && n == 2;
+
+        if (bValid)
+        {
+            Table->DeltaTA = DeltaTA;
+            Table->K = K;
+            Table->EB = EB;
+            Table->M0 = M[0];
+            Table->M1 = M[1];
+            bValid = Table->Build(DeltaAt, nDeltaAt);
+
+            if (!bValid)
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ::Time DELTET/DELTA_AT is not in increasing order, native time conversion disabled"));
+            }
+        }
+
+        FWriteScopeLock Lock(TableLock);
+        CurrentTable = bValid ? FTimeTablePtr(Table) : FTimeTablePtr();
+
+        return bValid;
+    }
+
+    SPICE_API bool HasConstants()
+    {
+        return GetTable().IsValid();
+    }
+
+    SPICE_API bool TryStr2Et(const FString& str, FSEphemerisTime& et)
+    {
+        FTimeTablePtr Table = GetTable();
+        return Table.IsValid() && ParseIso(*Table, *str, et.seconds);
+    }
+
+    SPICE_API bool TryEt2Utc(const FSEphemerisTime& et, ES_UTCTimeFormat format, int prec, FString& utcstr)
+    {
+        FTimeTablePtr Table = GetTable();
+        return Table.IsValid() && FormatUtc(*Table, et.seconds, format, prec, utcstr);
+    }
+
+    SPICE_API bool TryUtc2Et(const FDateTime& utc, FSEphemerisTime& et)
+    {
+        FTimeTablePtr Table = GetTable();
+        if (!Table.IsValid()) return false;
+
+        const int32 Daynum = DayNumber(utc.GetYear(), utc.GetDayOfYear());
+        const double Secs = utc.GetTimeOfDay().GetTicks() / (double)ETimespan::TicksPerSecond;
+
+        et = FSEphemerisTime(Table->TaiToTdb(Table->UtcToTai(Daynum, Secs)));
+        return true;
+    }
+
+    SPICE_API FSEphemerisTime Str2Et(const FString& str, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Time::Str2Et);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+
+        FSEphemerisTime et;
+        FTimeTablePtr Table = GetOrRefreshTable();
+        if (Table.IsValid() && ParseIso(*Table, *str, et.seconds))
+        {
+            *ResultCode = ES_ResultCode::Success;
+            ErrorMessage->Empty();
+            return et;
+        }
+
+        if (OffGameThread(ResultCode, ErrorMessage, TEXT("Str2Et"), str)) return et;
+
+        SpiceDouble _et = 0.;
+        str2et_c(TCHAR_TO_ANSI(*str), &_et);
+        ErrorCheck(ResultCode, ErrorMessage);
+
+        return FSEphemerisTime(_et);
+    }
+
+    SPICE_API FString Et2Utc(const FSEphemerisTime& et, ES_UTCTimeFormat format, int prec, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Time::Et2Utc);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+
+        FString utcstr;
+        FTimeTablePtr Table = GetOrRefreshTable();
+        if (Table.IsValid() && FormatUtc(*Table, et.seconds, format, prec, utcstr))
+        {
+            *ResultCode = ES_ResultCode::Success;
+            ErrorMessage->Empty();
+            return utcstr;
+        }
+
+        if (OffGameThread(ResultCode, ErrorMessage, TEXT("Et2Utc"), FString::Printf(TEXT("%.3f"), et.seconds))) return utcstr;
+
+        ConstSpiceChar* _format;
+        switch (format)
+        {
+        case ES_UTCTimeFormat::Calendar:     _format = "C";    break;
+        case ES_UTCTimeFormat::DayOfYear:    _format = "D";    break;
+        case ES_UTCTimeFormat::JulianDate:   _format = "J";    break;
+        case ES_UTCTimeFormat::ISOCalendar:  _format = "ISOC"; break;
+        case ES_UTCTimeFormat::ISODayOfYear: _format = "ISOD"; break;
+        default:                             _format = "";     break;
+        }
+
+        SpiceChar szUtc[SPICE_MAX_PATH];
+        ZeroOut(szUtc);
+        et2utc_c(et.seconds, _format, prec, sizeof(szUtc), szUtc);
+
+        if (!ErrorCheck(ResultCode, ErrorMessage))
+        {
+            utcstr = szUtc;
+        }
+        return utcstr;
+    }
+
+    SPICE_API FSEphemerisTime Now()
+    {
+        const FDateTime UtcNow = FDateTime::UtcNow();
+
+        FSEphemerisTime et;
+        if (GetOrRefreshTable().IsValid() && TryUtc2Et(UtcNow, et))
+        {
+            return et;
+        }
+
+        // No leapseconds kernel: UTC seconds past J2000, as before
+        const FTimespan SinceJ2000 = UtcNow - FDateTime::FromJulianDay(2451545.0);
+        return FSEphemerisTime(SinceJ2000.GetTotalSeconds());
+    }
+}
@@ -0,0 +1,559 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTrajectoryRecorder.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Recording live trajectories to SPK files, a segment at a time
+//
+// Push is the ring's producer, the sealer thread its consumer (see
+// SpiceRecording.h).  Sealed segments go to the game thread through an SPSC
+// queue.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTrajectoryRecorder.cpp is part of the "refined Blueprints API".
+//------------------------------------------------------------------------------
+
+#include "SpiceTrajectoryRecorder.h"
+#include "Containers/Queue.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "SpiceClock.h"
+#include "SpiceCore.h"
+#include "SpiceLog.h"
+#include "SpiceRecording.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using MaxQ::Core::ToANSIString;
+
+    // Interpolation degree limits (spkw09_c, spkw13_c)
+    constexpr int32 MaxDegree = 27;
+
+    struct FSample
+    {
+        double Et;
+        double State[6];
+    };
+
+    struct FSegment
+    {
+        TArray<double> Epochs;
+        TArray<double> States;      // 6 per epoch
+    };
+}
+
+
+namespace MaxQ::Recording
+{
+    struct FTrajectoryWriter::FState
+    {
+        FTrajectoryWriterSettings Settings;
+        FString Path;
+
+        TSampleRing<FSample> Ring;
+
+        // Sealer thread only:  samples since the last seal
+        TArray<FSample> Run;
+
+        TQueue<FSegment, EQueueMode::Spsc> Sealed;
+
+        std::atomic<int64> Samples{ 0 };
+        std::atomic<int64> Dropped{ 0 };
+        std::atomic<int64> Skipped{ 0 };
+
+        // Game thread only
+        int32 Segments = 0;
+        bool bCreated = false;
+
+        // Moves what's in the ring into Run, sealing wherever a segment must end
+        void Drain()
+        {
+            Ring.Drain([this](const FSample& Sample)
+            {
+                if (Run.Num() > 0)
+                {
+                    const double Last = Run.Last().Et;
+                    if (Sample.Et == Last)
+                    {
+                        ++Skipped;
+                        return;
+                    }
+
+                    // Time ran backwards, or jumped too far to interpolate across
+                    const bool bBackwards = Sample.Et < Last;
+                    const bool bGap = Settings.MaxGapSeconds > 0. && Sample.Et - Last > Settings.MaxGapSeconds;
+                    if (bBackwards || bGap)
+                    {
+                        Seal();
+                        Run.Reset();
+                    }
+                }
+
+                Run.Add(Sample);
+
+                if (Run.Num() >= Settings.MaxSegmentSamples)
+                {
+                    Seal();
+                }
+            });
+        }
+
+        // Queues Run as a segment, keeping its last sample to start the next
+        void Seal()
+        {
+            const int32 n = Run.Num();
+            if (n < 2)
+            {
+                return;
+            }
+
+            FSegment Segment;
+            Segment.Epochs.SetNumUninitialized(n);
+            Segment.States.SetNumUninitialized(6 * n);
+            for (int32 i = 0; i < n; ++i)
+            {
+                Segment.Epochs[i] = Run[i].Et;
+                FMemory::Memcpy(&Segment.States[6 * i], Run[i].State, sizeof(Run[i].State));
+            }
+            Sealed.Enqueue(MoveTemp(Segment));
+
+            const FSample Last = Run.Last();
+            Run.Reset();
+            Run.Add(Last);
+        }
+    };
+
+
+    TSharedPtr<FTrajectoryWriter> FTrajectoryWriter::Open(const FTrajectoryWriterSettings& Settings, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Recording::FTrajectoryWriter::Open);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        SpiceInt _frcode = 0;
+        namfrm_c(ToANSIString(Settings.Frame), &_frcode);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return nullptr;
+        }
+
+        FString Problem;
+        if (Settings.File.IsEmpty())
+        {
+            Problem = TEXT("No file name");
+        }
+        else if (_frcode == 0)
+        {
+            Problem = FString::Printf(TEXT("Unknown frame %s"), *Settings.Frame.ToString());
+        }
+        else if (Settings.Body == Settings.Center)
+        {
+            Problem = FString::Printf(TEXT("Body and center are both %d"), Settings.Body);
+        }
+        else if (Settings.BufferCapacity < 2 || Settings.MaxSegmentSamples < 2 || Settings.FlushSeconds <= 0.)
+        {
+            Problem = TEXT("Buffer capacity and segment samples must be at least 2, flush seconds positive");
+        }
+
+        if (!Problem.IsEmpty())
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = Problem;
+            return nullptr;
+        }
+
+        TSharedPtr<FTrajectoryWriter> Writer(new FTrajectoryWriter());
+        Writer->State = MakeShared<FState, ESPMode::ThreadSafe>();
+        FState& State = *Writer->State;
+        State.Settings = Settings;
+        State.Path = toPath(Settings.File);
+        State.Ring.Init(Settings.BufferCapacity);
+        State.Run.Reserve(FMath::Min(Settings.MaxSegmentSamples, Settings.BufferCapacity));
+
+        TSharedPtr<FState, ESPMode::ThreadSafe> SealerState = Writer->State;
+        Writer->Sealer = MakeUnique<FRecordingThread>(Settings.FlushSeconds, [SealerState]()
+        {
+            SealerState->Drain();
+            SealerState->Seal();
+        });
+        if (!Writer->Sealer->Start(TEXT("MaxQTrajectorySealer")))
+        {
+            *ResultCode = ES_ResultCode::Error;
+            *ErrorMessage = TEXT("Could not start the sealer thread");
+            return nullptr;
+        }
+
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+        return Writer;
+    }
+
+
+    FTrajectoryWriter::~FTrajectoryWriter()
+    {
+        StopThread();
+    }
+
+
+    void FTrajectoryWriter::StopThread()
+    {
+        if (Sealer)
+        {
+            Sealer->Shutdown();
+        }
+    }
+
+
+    bool FTrajectoryWriter::Push(const FSEphemerisTime& et, const FSStateVector& state)
+    {
+        if (!IsOpen())
+        {
+            return false;
+        }
+
+        FSample Sample;
+        Sample.Et = et.seconds;
+        state.CopyTo(Sample.State);
+
+        bool bHalfFull = false;
+        const bool bPushed = State->Ring.Push(Sample, bHalfFull);
+        if (bPushed)
+        {
+            ++State->Samples;
+        }
+        else
+        {
+            ++State->Dropped;
+        }
+
+        // Don't wait out the flush interval with the ring half full
+        if (bHalfFull)
+        {
+            Sealer->Wake();
+        }
+        return bPushed;
+    }
+
+
+    void FTrajectoryWriter::Flush()
+    {
+        if (IsOpen())
+        {
+            Sealer->Wake();
+        }
+    }
+
+
+    int32 FTrajectoryWriter::Write(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_SPICE_SCOPE(MaxQ::Recording::FTrajectoryWriter::Write);
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        check(IsInGameThread());
+
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+
+        FState& S = *State;
+        if (S.Sealed.IsEmpty())
+        {
+            return 0;
+        }
+
+        const FTrajectoryWriterSettings& Settings = S.Settings;
+
+        // A new recording replaces the file, unless appending.  After that,
+        // every batch appends.
+        if (!S.bCreated && !Settings.bAppend && FPaths::FileExists(S.Path))
+        {
+            IFileManager::Get().Delete(*S.Path);
+        }
+
+        auto _path = StringCast<ANSICHAR>(*S.Path);
+        SpiceInt _handle = 0;
+        if (FPaths::FileExists(S.Path))
+        {
+            spkopa_c(_path.Get(), &_handle);
+        }
+        else
+        {
+            spkopn_c(_path.Get(), "MAXQ TRAJECTORY RECORDING", 0, &_handle);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return 0;
+        }
+        S.bCreated = true;
+
+        auto _segid = StringCast<ANSICHAR>(*Settings.SegmentId);
+        const ANSICHAR* _frame = ToANSIString(Settings.Frame);
+
+        int32 Written = 0;
+        FSegment Segment;
+        while (!failed_c() && S.Sealed.Dequeue(Segment))
+        {
+            const int32 n = Segment.Epochs.Num();
+            const ConstSpiceDouble (*_states)[6] = reinterpret_cast<const SpiceDouble(*)[6]>(Segment.States.GetData());
+            const int32 Degree = FMath::Clamp(Settings.Degree, 1, MaxDegree);
+
+            if (Settings.SegmentType == ES_SPKRecordingType::Hermite13)
+            {
+                // Odd, with a window of (degree + 1) / 2 samples
+                const int32 _degree = FMath::Min((Degree - 1) | 1, 2 * n - 1);
+                spkw13_c(_handle, Settings.Body, Settings.Center, _frame, Segment.Epochs[0], Segment.Epochs.Last(), _segid.Get(), _degree, n, _states, Segment.Epochs.GetData());
+            }
+            else
+            {
+                // A window of degree + 1 samples
+                const int32 _degree = FMath::Min(Degree, n - 1);
+                spkw09_c(_handle, Settings.Body, Settings.Center, _frame, Segment.Epochs[0], Segment.Epochs.Last(), _segid.Get(), _degree, n, _states, Segment.Epochs.GetData());
+            }
+
+            Written += !failed_c();
+        }
+
+        // Close even after a failed write, so what was written stays readable
+        const bool bFailed = ErrorCheck(ResultCode, ErrorMessage) != 0;
+        spkcls_c(_handle);
+        if (bFailed)
+        {
+            ES_ResultCode IgnoredResultCode;
+            FString IgnoredErrorMessage;
+            ErrorCheck(IgnoredResultCode, IgnoredErrorMessage, true);
+        }
+        else
+        {
+            ErrorCheck(ResultCode, ErrorMessage);
+        }
+
+        S.Segments += Written;
+        return Written;
+    }
+
+
+    void FTrajectoryWriter::Close(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        StopThread();
+        Write(ResultCode, ErrorMessage);
+    }
+
+
+    bool FTrajectoryWriter::IsOpen() const
+    {
+        return Sealer && Sealer->IsRunning();
+    }
+
+
+    FTrajectoryWriterStats FTrajectoryWriter::GetStats() const
+    {
+        FTrajectoryWriterStats Stats;
+        Stats.Samples = State->Samples;
+        Stats.Dropped = State->Dropped;
+        Stats.Skipped = State->Skipped;
+        Stats.Segments = State->Segments;
+        return Stats;
+    }
+
+
+    const FString& FTrajectoryWriter::GetPath() const
+    {
+        return State->Path;
+    }
+}
+
+
+USpiceTrajectoryRecorder::USpiceTrajectoryRecorder()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = true;
+
+    // Sample where the owner ended up this frame
+    PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+
+void USpiceTrajectoryRecorder::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (bRecordOnBeginPlay)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        StartRecording(ResultCode, ErrorMessage);
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("USpiceTrajectoryRecorder (%s) could not start: %s"), *GetNameSafe(GetOwner()), *ErrorMessage);
+        }
+    }
+}
+
+
+void USpiceTrajectoryRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (IsRecording())
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        StopRecording(ResultCode, ErrorMessage);
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("USpiceTrajectoryRecorder (%s) failed writing %s: %s"), *GetNameSafe(GetOwner()), *File, *ErrorMessage);
+        }
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+void USpiceTrajectoryRecorder::StartRecording(ES_ResultCode& ResultCode, FString& ErrorMessage)
+{
+    if (IsRecording())
+    {
+        StopRecording(ResultCode, ErrorMessage);
+    }
+
+    SpiceInt _center = 0;
+    SpiceBoolean _found = SPICEFALSE;
+    bods2c_c(MaxQ::Core::ToANSIString(Center), &_center, &_found);
+    if (ErrorCheck(ResultCode, ErrorMessage))
+    {
+        return;
+    }
+    if (!_found)
+    {
+        ResultCode = ES_ResultCode::Error;
+        ErrorMessage = FString::Printf(TEXT("Unknown center %s"), *Center.ToString());
+        return;
+    }
+
+    MaxQ::Recording::FTrajectoryWriterSettings Settings;
+    Settings.File = File;
+    Settings.bAppend = bAppend;
+    Settings.Body = Body;
+    Settings.Center = _center;
+    Settings.Frame = Frame;
+    Settings.SegmentType = SegmentType;
+    Settings.Degree = Degree;
+    Settings.BufferCapacity = BufferCapacity;
+    Settings.FlushSeconds = FlushSeconds;
+    Settings.MaxGapSeconds = MaxGapSeconds;
+
+    Writer = MaxQ::Recording::FTrajectoryWriter::Open(Settings, &ResultCode, &ErrorMessage);
+
+    RecordingStartWorldSeconds = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.;
+    bSampled = false;
+}
+
+
+void USpiceTrajectoryRecorder::StopRecording(ES_ResultCode& ResultCode, FString& ErrorMessage)
+{
+    ResultCode = ES_ResultCode::Success;
+    ErrorMessage.Empty();
+
+    if (Writer)
+    {
+        Writer->Close(&ResultCode, &ErrorMessage);
+        LastStats = Writer->GetStats();
+        Writer.Reset();
+    }
+}
+
+
+void USpiceTrajectoryRecorder::Flush()
+{
+    if (Writer)
+    {
+        Writer->Flush();
+    }
+}
+
+
+void USpiceTrajectoryRecorder::GetRecordingStats(int64& Samples, int64& Dropped, int& Segments) const
+{
+    const MaxQ::Recording::FTrajectoryWriterStats Stats = Writer ? Writer->GetStats() : LastStats;
+    Samples = Stats.Samples;
+    Dropped = Stats.Dropped;
+    Segments = Stats.Segments;
+}
+
+
+FSStateVector USpiceTrajectoryRecorder::GetStateToRecord_Implementation(const FSEphemerisTime& et)
+{
+    const AActor* Owner = GetOwner();
+    if (!Owner)
+    {
+        return FSStateVector();
+    }
+
+    // World velocity is per world second, SPICE's per ET second
+    const UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this);
+    const double EtPerSecond = Clock && Clock->GetTimeScale() != 0. ? Clock->GetTimeScale() : 1.;
+
+    const FVector Position = Owner->GetActorLocation() * KilometersPerUnit;
+    const FVector Velocity = Owner->GetVelocity() * (KilometersPerUnit / EtPerSecond);
+    return FSStateVector(FSDistanceVector::Swizzle(Position), FSVelocityVector::Swizzle(Velocity));
+}
+
+
+void USpiceTrajectoryRecorder::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (!Writer)
+    {
+        return;
+    }
+
+    const FSEphemerisTime et = GetRecordingEt();
+    if (!bSampled || FMath::Abs(et.seconds - LastSampleEt) >= SampleInterval)
+    {
+        Writer->Push(et, GetStateToRecord(et));
+        LastSampleEt = et.seconds;
+        bSampled = true;
+    }
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    Writer->Write(&ResultCode, &ErrorMessage);
+    if (ResultCode != ES_ResultCode::Success)
+    {
+        UE_LOG(LogSpice, Warning, TEXT("USpiceTrajectoryRecorder (%s) failed writing %s: %s"), *GetNameSafe(GetOwner()), *File, *ErrorMessage);
+    }
+}
+
+
+FSEphemerisTime USpiceTrajectoryRecorder::GetRecordingEt() const
+{
+    if (const UMaxQClockSubsystem* Clock = UMaxQClockSubsystem::Get(this))
+    {
+        return Clock->GetEphemerisTime();
+    }
+
+    const double WorldSeconds = GetWorld() ? GetWorld()->GetTimeSeconds() : RecordingStartWorldSeconds;
+    return FSEphemerisTime(StartEt.seconds + WorldSeconds - RecordingStartWorldSeconds);
+}
@@ -536,6 +536,82 @@ FSDimensionlessStateVector USpiceTypes::Conv_FSPlanetographicStateVectorToSDimen
     return result;
 }
 
+FSStateVectorBuffer USpiceTypes::Conv_SStateVectorArrayToSStateVectorBuffer(
+    const TArray<FSStateVector>& value
+)
+{
+    return FSStateVectorBuffer(value);
+}
+
+TArray<FSStateVector> USpiceTypes::Conv_SStateVectorBufferToSStateVectorArray(
+    const FSStateVectorBuffer& value
+)
+{
+    TArray<FSStateVector> result;
+    value.CopyTo(result);
+    return result;
+}
+
+int USpiceTypes::StateVectorBuffer_Num(
+    const FSStateVectorBuffer& buffer
+)
+{
+    return buffer.Num();
+}
+
+void USpiceTypes::StateVectorBuffer_Get(
+    const FSStateVectorBuffer& buffer,
+    int index,
+    ES_FoundCode& found,
+    FSStateVector& state
+)
+{
+    if (buffer.IsValidIndex(index))
+    {
+        state = buffer.Get(index);
+        found = ES_FoundCode::Found;
+    }
+    else
+    {
+        state = FSStateVector();
+        found = ES_FoundCode::NotFound;
+    }
+}
+
+void USpiceTypes::StateVectorBuffer_Set(
+    FSStateVectorBuffer& buffer,
+    int index,
+    const FSStateVector& state,
+    ES_FoundCode& found
+)
+{
+    if (buffer.IsValidIndex(index))
+    {
+        buffer.Set(index, state);
+        found = ES_FoundCode::Found;
+    }
+    else
+    {
+        found = ES_FoundCode::NotFound;
+    }
+}
+
+int USpiceTypes::StateVectorBuffer_Add(
+    FSStateVectorBuffer& buffer,
+    const FSStateVector& state
+)
+{
+    return buffer.Add(state);
+}
+
+void USpiceTypes::StateVectorBuffer_SetNum(
+    FSStateVectorBuffer& buffer,
+    int count
+)
+{
+    buffer.SetNum(FMath::Max(count, 0));
+}
+
 
 void USpiceTypes::SingleEtWindow(
     const FSEphemerisTime& et0,
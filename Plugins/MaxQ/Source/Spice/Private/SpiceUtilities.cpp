@@ -41,6 +41,11 @@
 #include "CoreMinimal.h"
 #include "Misc/Paths.h"
 #include "SpicePlatformDefs.h"
+#include "SpiceConstantCache.h"
+#include "SpiceCore.h"
+#include "SpiceCoverage.h"
+#include "SpiceSegments.h"
+#include "SpiceTime.h"
 
 namespace MaxQ::Private
 {
@@ -136,11 +141,24 @@ namespace MaxQ::Private
     {
         uint8 failed = failed_c();
 
+#if MAXQ_SPICE_PROFILING
+        if (failed)
+        {
+            MaxQ::Profiling::FCallScope::NoteError();
+        }
+#endif
+
         if (!failed)
         {
             ResultCode = ES_ResultCode::Success;
             ErrorMessage.Empty();
         }
+        else if (MaxQ::Core::FDeferredErrorScope* DeferredErrors = MaxQ::Core::FDeferredErrorScope::Current())
+        {
+            // Hot loop... record it compactly, the scope reports on exit.
+            DeferredErrors->RecordFailure(ResultCode, ErrorMessage);
+            reset_c();
+        }
         else
         {
             ResultCode = ES_ResultCode::Error;
@@ -191,7 +209,25 @@ namespace MaxQ::Private
     {
         uint8 failed = failed_c();
 
+#if MAXQ_SPICE_PROFILING
         if (failed)
+        {
+            MaxQ::Profiling::FCallScope::NoteError();
+        }
+#endif
+
+        if (failed && MaxQ::Core::FDeferredErrorScope::Current())
+        {
+            ES_ResultCode DeferredResultCode;
+            FString DeferredErrorMessage;
+            MaxQ::Core::FDeferredErrorScope::Current()->RecordFailure(DeferredResultCode, DeferredErrorMessage);
+
+            if (bReset)
+            {
+                reset_c();
+            }
+        }
+        else if (failed)
         {
             char szBuffer[SpiceLongMessageMaxLength];
 
@@ -217,4 +253,100 @@ namespace MaxQ::Private
 
         return failed;
     }
+
+
+    namespace
+    {
+        int32 DeferKernelsChangedDepth = 0;
+        bool bKernelsChangedPending = false;
+    }
+
+    void OnKernelsChanged()
+    {
+        if (DeferKernelsChangedDepth > 0)
+        {
+            bKernelsChangedPending = true;
+            return;
+        }
+
+        // Leave a pending error (e.g. from furnsh_absolute) to its caller,
+        // the refreshes' error checks would reset it.  The next change
+        // refreshes.
+        if (failed_c())
+        {
+            return;
+        }
+
+        MaxQ::ConstantCache::Validate();
+        MaxQ::Time::RefreshConstants();
+        MaxQ::Coverage::Refresh();
+        MaxQ::Segments::Refresh();
+    }
+
+
+    void OnKernelsCleared()
+    {
+        ForgetLoadedManagedKernels();
+        OnKernelsChanged();
+    }
+
+
+    FDeferKernelsChanged::FDeferKernelsChanged()
+    {
+        check(IsInGameThread());
+        ++DeferKernelsChangedDepth;
+    }
+
+
+    FDeferKernelsChanged::~FDeferKernelsChanged()
+    {
+        if (--DeferKernelsChangedDepth == 0 && bKernelsChangedPending)
+        {
+            bKernelsChangedPending = false;
+            OnKernelsChanged();
+        }
+    }
+
+
+    bool GetLoadedKernels(const TCHAR* Types, TArray<FLoadedKernel>& Kernels)
+    {
+        TArray<FString> Wanted;
+        FString(Types).ParseIntoArrayWS(Wanted);
+
+        // kdata_c is a direct lookup for "ALL", but scans the kernel table
+        // for any other type list.
+        SpiceInt _count = 0;
+        ktotal_c("ALL", &_count);
+
+        Kernels.Reset();
+        for (SpiceInt i = 0; i < _count; ++i)
+        {
+            SpiceChar _file[SPICE_MAX_PATH];
+            SpiceChar _filtyp[32];
+            SpiceChar _source[SPICE_MAX_PATH];
+            SpiceInt _handle = 0;
+            SpiceBoolean _found = SPICEFALSE;
+
+            kdata_c(i, "ALL", sizeof(_file), sizeof(_filtyp), sizeof(_source), _file, _filtyp, _source, &_handle, &_found);
+
+            FString Type = ANSI_TO_TCHAR(_filtyp);
+            if (_found && Wanted.Contains(Type))
+            {
+                Kernels.Add(FLoadedKernel { ANSI_TO_TCHAR(_file), MoveTemp(Type), (int32)_handle });
+            }
+        }
+
+        return !UnexpectedErrorCheck();
+    }
+
+
+    bool KernelKindFromType(const FString& Type, MaxQ::Coverage::EKernelKind& Kind)
+    {
+        using MaxQ::Coverage::EKernelKind;
+
+        if (Type == TEXT("SPK")) { Kind = EKernelKind::SPK; return true; }
+        if (Type == TEXT("CK")) { Kind = EKernelKind::CK; return true; }
+        if (Type == TEXT("PCK")) { Kind = EKernelKind::PCK; return true; }
+        return false;
+    }
 }
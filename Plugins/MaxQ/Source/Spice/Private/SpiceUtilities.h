@@ -25,6 +25,8 @@
 
 #include "CoreMinimal.h"
 #include "SpiceTypes.h"
+#include "SpiceProfiling.h"
+#include "SpiceCoverage.h"
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 extern "C"
@@ -65,4 +67,69 @@ namespace MaxQ::Private
     uint8 ErrorCheck(ES_ResultCode& ResultCode, FString& ErrorMessage, bool BeQuiet = false);
     uint8 UnexpectedErrorCheck(bool bReset = true);
     void MakeErrorGutter(ES_ResultCode*& pResultCode, FString*& pErrorMessage);
+
+    // Kernels were loaded/unloaded/cleared, refresh what's derived from them
+    void OnKernelsChanged();
+
+    // Holds OnKernelsChanged until the outermost scope closes, so loading a
+    // list of kernels refreshes once.  Game thread only.
+    class FDeferKernelsChanged
+    {
+    public:
+        FDeferKernelsChanged();
+        ~FDeferKernelsChanged();
+
+        FDeferKernelsChanged(const FDeferKernelsChanged&) = delete;
+        FDeferKernelsChanged& operator=(const FDeferKernelsChanged&) = delete;
+    };
+
+    struct FLoadedKernel
+    {
+        FString File;
+        FString Type;       // "SPK", "CK", "PCK", "DSK", "EK", "TEXT", "META"
+        int32 Handle = 0;   // binary kernels only
+    };
+
+    // Loaded kernels of the given types (kdata_c types, space separated), in
+    // load order.  False on a CSPICE error.
+    bool GetLoadedKernels(const TCHAR* Types, TArray<FLoadedKernel>& Kernels);
+
+    // "SPK", "CK", "PCK" (binary) => kind
+    bool KernelKindFromType(const FString& Type, MaxQ::Coverage::EKernelKind& Kind);
+
+    // An SPK body, CK instrument, or PCK frame class
+    struct FKernelId
+    {
+        MaxQ::Coverage::EKernelKind Kind;
+        int32 Id;
+
+        bool operator==(const FKernelId& Other) const
+        {
+            return Kind == Other.Kind && Id == Other.Id;
+        }
+
+        friend uint32 GetTypeHash(const FKernelId& Key)
+        {
+            return HashCombine(GetTypeHash((uint8)Key.Kind), GetTypeHash(Key.Id));
+        }
+    };
+
+    // A loaded DSK type 2 segment
+    struct FDskSegment
+    {
+        FString File;
+        SpiceInt Handle = 0;
+        SpiceDLADescr Dla;
+        SpiceDSKDescr Dsk;
+    };
+
+    // Body's type 2 DSK segments, restricted to Surfaces unless it's empty,
+    // in load order.  False on a CSPICE error.  Defined with the plate model.
+    bool GetDskType2Segments(int32 Body, const TArray<int32>& Surfaces, TArray<FDskSegment>& Segments);
+
+    // kclear_c unloaded everything, including managed kernels
+    void OnKernelsCleared();
+
+    // Defined by the kernel manager
+    void ForgetLoadedManagedKernels();
 }
@@ -77,6 +77,9 @@
 #include "SpiceCore.h"
 #include "SpiceMath.h"
 #include "SpiceData.h"
+#include "SpiceTime.h"
+#include "SpiceEphemeris.h"
+#include "SpiceExpression.h"
 #include "SpiceOperators.h"
 #include "Spice.generated.h"
 
@@ -0,0 +1,219 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceAttitudeRecorder.h
+//
+// API Comments
+//
+// Purpose:  Recording live attitude to CK files, a segment at a time
+// (ckopn, ckw03, sce2c)
+//
+// USpiceAttitudeRecorder is USpiceTrajectoryRecorder's counterpart for
+// pointing.  It samples its owner's orientation & angular velocity every
+// tick (or every SampleInterval of ET) and streams them to a CK through an
+// FAttitudeWriter, the same way:  a fixed-size ring (full means dropped
+// samples, never growth), a background thread sealing what it drains every
+// FlushSeconds, and the game thread writing sealed segments, closing the
+// file after each batch.
+//
+// The sealer keeps each quaternion in the same hemisphere as the one before
+// it (q and -q are the same rotation), so interpolating between neighbors
+// never goes the long way around.  Sampling must still be fast enough that
+// the owner turns less than half a revolution between samples.
+//
+// CK type 3 segments are indexed by encoded spacecraft clock, so the SCLK
+// kernel for Spacecraft must be loaded.  ETs are encoded (sce2c) when
+// segments are written; samples closer together than a clock tick are
+// skipped.  ET gaps longer than MaxGapSeconds become a break between
+// interpolation intervals, so the gap reads as having no pointing rather
+// than an interpolated guess.  ET running backwards starts a new segment.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceAttitudeRecorder.h is part of the "refined Blueprints API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+#include "SpiceAttitudeRecorder.generated.h"
+
+namespace MaxQ::Recording
+{
+    class FRecordingThread;
+
+    struct FAttitudeWriterSettings
+    {
+        FString File;                           // Absolute, or relative to /Content
+        int32 Instrument = 0;                   // CK ID (instrument, spacecraft or structure)
+        int32 Spacecraft = 0;                   // Whose clock the CK is indexed by
+        FName Frame = TEXT("J2000");            // Reference frame
+        bool bAngularVelocity = true;
+        FString SegmentId = TEXT("MAXQ ATTITUDE RECORDER");
+        int32 BufferCapacity = 65536;           // Samples in the ring
+        int32 MaxSegmentSamples = 10000;        // Longer runs are split
+        double FlushSeconds = 10.;              // Real time between seals
+        double MaxGapSeconds = 0.;              // ET, zero for no limit
+        bool bAppend = false;                   // Add to an existing file, rather than replace it
+    };
+
+    struct FAttitudeWriterStats
+    {
+        int64 Samples = 0;                      // Pushed into the ring
+        int64 Dropped = 0;                      // Ring was full
+        int64 Skipped = 0;                      // Repeated ETs, or SCLK ticks
+        int32 Segments = 0;                     // Written to the file
+    };
+
+    class SPICE_API FAttitudeWriter
+    {
+    public:
+        // Game thread.  Starts the background thread; the file is created by
+        // the first Write() with anything to write.
+        static TSharedPtr<FAttitudeWriter> Open(const FAttitudeWriterSettings& Settings, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        // Stops the background thread.  Anything not yet written is lost,
+        // Close() first to keep it.
+        ~FAttitudeWriter();
+
+        // One producer thread at a time.  quat is the C-matrix's (Frame to
+        // instrument), av the instrument's angular velocity relative to
+        // Frame, in Frame.  False if the ring was full and the sample was
+        // dropped.
+        bool Push(const FSEphemerisTime& et, const FSQuaternion& quat, const FSAngularVelocity& av);
+
+        // Any thread.  Asks the background thread to seal what's been pushed
+        // so far, without waiting for FlushSeconds.
+        void Flush();
+
+        // Game thread.  Writes sealed segments, returns how many.
+        int32 Write(ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        // Game thread.  Seals and writes everything pushed, and stops the
+        // background thread.
+        void Close(ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        bool IsOpen() const;
+        FAttitudeWriterStats GetStats() const;
+        const FString& GetPath() const;
+
+        struct FState;
+
+    private:
+        FAttitudeWriter() = default;
+        void StopThread();
+
+        TSharedPtr<FState, ESPMode::ThreadSafe> State;
+        TUniquePtr<FRecordingThread> Sealer;
+    };
+}
+
+
+UCLASS(ClassGroup = "MaxQ", Category = "MaxQ", meta = (BlueprintSpawnableComponent))
+class SPICE_API USpiceAttitudeRecorder : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    USpiceAttitudeRecorder();
+
+    // Output file, absolute or relative to /Content
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    FString File = TEXT("recording.bc");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    bool bAppend = false;
+
+    // NAIF ID to record the owner's pointing as
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    int Instrument = -1000000;
+
+    // NAIF ID of the spacecraft whose clock (SCLK kernel) the CK is indexed by
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    int Spacecraft = -1000;
+
+    // The reference frame UE's world axes stand for
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    FName Frame = TEXT("J2000");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    bool bRecordAngularVelocity = true;
+
+    // ET seconds between samples, zero for every tick
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    double SampleInterval = 0.;
+
+    // Real seconds between segments
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder", meta = (ClampMin = "0.1"))
+    double FlushSeconds = 10.;
+
+    // Samples held between segments
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder", meta = (ClampMin = "16"))
+    int BufferCapacity = 65536;
+
+    // ET gaps longer than this aren't interpolated across, zero for no limit
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    double MaxGapSeconds = 0.;
+
+    // ET recording starts at when the world has no MaxQ clock
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    FSEphemerisTime StartEt;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    bool bRecordOnBeginPlay = true;
+
+    /// <summary>Starts sampling the owner, replacing (or appending to) File</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder", meta = (ExpandEnumAsExecs = "ResultCode"))
+    void StartRecording(ES_ResultCode& ResultCode, FString& ErrorMessage);
+
+    /// <summary>Writes everything sampled, and stops</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder", meta = (ExpandEnumAsExecs = "ResultCode"))
+    void StopRecording(ES_ResultCode& ResultCode, FString& ErrorMessage);
+
+    /// <summary>Seals a segment from what's been sampled, without waiting for FlushSeconds</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder")
+    void Flush();
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Recorder")
+    bool IsRecording() const { return Writer.IsValid(); }
+
+    /// <summary>Samples taken, dropped (the buffer was full), and segments written</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Recorder")
+    void GetRecordingStats(int64& Samples, int64& Dropped, int& Segments) const;
+
+    /// <summary>The attitude to record at et:  the C-matrix quaternion (Frame to instrument), and angular velocity relative to Frame.  By default, the owner's rotation, and its physics angular velocity or else the rotation's rate of change.</summary>
+    UFUNCTION(BlueprintNativeEvent, Category = "MaxQ|Recorder")
+    void GetAttitudeToRecord(const FSEphemerisTime& et, FSQuaternion& quat, FSAngularVelocity& av);
+
+    // UActorComponent interface
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    // end of UActorComponent interface
+
+private:
+    FSEphemerisTime GetRecordingEt() const;
+
+    TSharedPtr<MaxQ::Recording::FAttitudeWriter> Writer;
+    MaxQ::Recording::FAttitudeWriterStats LastStats;
+    double RecordingStartWorldSeconds = 0.;
+    double LastSampleEt = 0.;
+    bool bSampled = false;
+
+    // For the default angular velocity, without physics
+    FQuat PreviousRotation = FQuat::Identity;
+    double PreviousRotationEt = 0.;
+    bool bHasPreviousRotation = false;
+};
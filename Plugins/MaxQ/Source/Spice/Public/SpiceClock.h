@@ -0,0 +1,232 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceClock.h
+//
+// API Comments
+//
+// Purpose:  One authoritative simulation ET per frame
+//
+// UMaxQClockSubsystem advances ET once per frame, before any actor ticks, by
+// the frame's delta time * the time warp.  Every actor that reads the clock
+// during the frame sees the same ET.
+//
+// Fixed steps:  If a fixed step is set, the clock also schedules fixed-step
+// ETs, running them just far enough ahead that
+//
+//     PreviousFixedStepTime <= EphemerisTime < FixedStepTime
+//
+// A consumer that evaluates its state at fixed steps only (physics, or an
+// expensive ephemeris sample set) can lerp between its last two samples by
+// GetFixedStepAlpha() and land exactly on the frame's ET.  At high time warp
+// the oldest steps beyond MaxFixedStepsPerFrame are skipped, not queued.
+// After a jump (SetEphemerisTime, SetFixedStep, or running time backwards)
+// the grid restarts at the frame's ET, and both bracketing steps are
+// scheduled in the same frame.
+//
+// Frame states:  GetFrameState caches spkezr results for the frame's ET, so
+// any number of actors asking for the same target/observer/frame share one
+// CSPICE call.  Failures aren't cached.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceClock.h is part of the "refined Blueprints API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SpiceTypes.h"
+#include "SpiceClock.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMaxQClockAdvanced, const FSEphemerisTime&, EphemerisTime, const FSEphemerisPeriod&, Elapsed);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMaxQClockFixedStep, const FSEphemerisTime&, FixedStepTime, const FSEphemerisPeriod&, FixedStep);
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FMaxQClockAdvancedNative, const FSEphemerisTime& /* EphemerisTime */, const FSEphemerisPeriod& /* Elapsed */);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FMaxQClockFixedStepNative, const FSEphemerisTime& /* FixedStepTime */, const FSEphemerisPeriod& /* FixedStep */);
+
+
+UCLASS(Category = "MaxQ")
+class SPICE_API UMaxQClockSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // Time warp is clamped to +/- MaxTimeScale
+    static constexpr double MaxTimeScale = 1e7;
+
+    // Nullptr if the world doesn't have a clock (editor worlds, etc)
+    static UMaxQClockSubsystem* Get(const UObject* WorldContextObject);
+
+    // USubsystem interface
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    // end of USubsystem interface
+
+    /// <summary>The simulation ET for this frame</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock", meta = (Keywords = "TIME, NOW"))
+    FSEphemerisTime GetEphemerisTime() const { return EphemerisTime; }
+
+    /// <summary>ET elapsed since the previous frame</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock")
+    FSEphemerisPeriod GetElapsed() const { return Elapsed; }
+
+    /// <summary>Frames the clock has advanced</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock")
+    int64 GetFrameNumber() const { return FrameNumber; }
+
+    /// <summary>Jumps to an ET.  Fixed steps restart from it.</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Clock")
+    void SetEphemerisTime(const FSEphemerisTime& et);
+
+    /// <summary>Jumps to the current system time</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Clock")
+    void SetEphemerisTimeToNow();
+
+    /// <summary>Jumps to a time string (str2et)</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Clock", meta = (ExpandEnumAsExecs = "ResultCode"))
+    void SetEphemerisTimeFromString(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& TimeString);
+
+    /// <summary>ET seconds per real second</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock", meta = (Keywords = "WARP, SPEED"))
+    double GetTimeScale() const { return TimeScale; }
+
+    /// <summary>Sets the time warp, clamped to +/- 1e7</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Clock", meta = (Keywords = "WARP, SPEED"))
+    void SetTimeScale(double NewTimeScale);
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock")
+    bool IsPaused() const { return bPaused; }
+
+    /// <summary>Stops ET from advancing, without pausing the game</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Clock")
+    void SetPaused(bool bNewPaused) { bPaused = bNewPaused; }
+
+    /// <summary>Fixed step in ET seconds, zero if fixed steps are off</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock|Fixed Step")
+    FSEphemerisPeriod GetFixedStep() const { return FixedStep; }
+
+    /// <summary>Schedules fixed-step ETs.  Zero turns them off.</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Clock|Fixed Step")
+    void SetFixedStep(const FSEphemerisPeriod& NewFixedStep, int32 NewMaxFixedStepsPerFrame = 8);
+
+    /// <summary>The latest fixed-step ET, at or after this frame's ET</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock|Fixed Step")
+    FSEphemerisTime GetFixedStepTime() const { return FixedStepTime; }
+
+    /// <summary>The fixed-step ET before that, at or before this frame's ET</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock|Fixed Step")
+    FSEphemerisTime GetPreviousFixedStepTime() const { return FSEphemerisTime(FixedStepTime.seconds - FixedStep.seconds); }
+
+    /// <summary>Where this frame's ET falls between the previous and latest fixed steps, [0, 1]</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock|Fixed Step", meta = (Keywords = "INTERPOLATION, LERP"))
+    double GetFixedStepAlpha() const { return FixedStepAlpha; }
+
+    /// <summary>Fixed-step ETs scheduled this frame, oldest first</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock|Fixed Step")
+    TArray<FSEphemerisTime> GetFixedStepTimesThisFrame() const { return FixedStepTimesThisFrame; }
+
+    /// <summary>Fixed steps dropped this frame, over MaxFixedStepsPerFrame</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Clock|Fixed Step")
+    int64 GetSkippedFixedStepsThisFrame() const { return SkippedFixedStepsThisFrame; }
+
+    /// <summary>spkezr at this frame's ET, shared by every caller this frame</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Clock", meta = (DisplayName = "Get Frame State", ExpandEnumAsExecs = "ResultCode"))
+    void K2_GetFrameState(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        FName targ = TEXT("EARTH"),
+        FName obs = TEXT("SUN"),
+        FName ref = TEXT("ECLIPJ2000"),
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    );
+
+    // The same, for C++ callers
+    bool GetFrameState(
+        FSStateVector& state,
+        const FName& targ,
+        const FName& obs,
+        const FName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        FSEphemerisPeriod* lt = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Broadcast after ET advances each frame, before actors tick
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Clock")
+    FMaxQClockAdvanced OnClockAdvanced;
+
+    // Broadcast for each fixed step scheduled, oldest first, before OnClockAdvanced
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Clock|Fixed Step")
+    FMaxQClockFixedStep OnFixedStep;
+
+    FMaxQClockAdvancedNative OnClockAdvancedNative;
+    FMaxQClockFixedStepNative OnFixedStepNative;
+
+    // Advances the clock.  Called before actors tick; public for tests & tools
+    // that drive a world without ticking it.
+    void Advance(double RealDeltaSeconds);
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    void OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+    void ScheduleFixedSteps();
+    void AddFixedStep(const FSEphemerisTime& et);
+
+    FSEphemerisTime EphemerisTime;
+    FSEphemerisPeriod Elapsed;
+    double TimeScale = 1.;
+    bool bPaused = false;
+    int64 FrameNumber = 0;
+
+    FSEphemerisPeriod FixedStep;
+    int32 MaxFixedStepsPerFrame = 8;
+    FSEphemerisTime FixedStepTime;
+    double FixedStepAlpha = 0.;
+    bool bRestartFixedSteps = true;
+    TArray<FSEphemerisTime> FixedStepTimesThisFrame;
+    int64 SkippedFixedStepsThisFrame = 0;
+
+    struct FFrameStateKey
+    {
+        FName Target;
+        FName Observer;
+        FName Frame;
+        ES_AberrationCorrectionWithNewtonians Abcorr;
+
+        bool operator==(const FFrameStateKey& Other) const
+        {
+            return Target == Other.Target && Observer == Other.Observer && Frame == Other.Frame && Abcorr == Other.Abcorr;
+        }
+
+        friend uint32 GetTypeHash(const FFrameStateKey& Key)
+        {
+            return HashCombine(HashCombine(GetTypeHash(Key.Target), GetTypeHash(Key.Observer)), HashCombine(GetTypeHash(Key.Frame), (uint32)Key.Abcorr));
+        }
+    };
+
+    struct FFrameState
+    {
+        FSStateVector State;
+        FSEphemerisPeriod LightTime;
+    };
+
+    TMap<FFrameStateKey, FFrameState> FrameStates;
+
+    FDelegateHandle PreActorTickHandle;
+};
@@ -0,0 +1,143 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCompression.h
+//
+// API Comments
+//
+// Purpose:  Compressing dense trajectories to Chebyshev SPK segments
+// (spkw02, spkw03, spkpvn)
+//
+// Discrete-state SPKs (types 5, 9, 13), like the ones the trajectory recorder
+// and Sample06 write, store every sample.  A Chebyshev fit to a tolerance
+// stores far less and evaluates faster:  one polynomial per record, rather
+// than a search & an interpolation over a window of states.
+//
+// FitChebyshev fits records greedily, from the start:  it looks for the
+// longest record length (doubling from the last one, or halving) and the
+// lowest degree that hold the position (and velocity) error within
+// tolerance, then keeps emitting records of that length & degree until one
+// doesn't fit, or one twice as long would.  Type 2 and 3 segments have one
+// record length and degree each, so every change of length or degree starts
+// a new segment:  long records where the trajectory is smooth, short ones
+// around periapsis.
+//
+// Each record is fit at its Chebyshev nodes and checked at its end points
+// and between the nodes.  Type 2 records fit positions only, their velocity
+// is the polynomial's derivative; type 3 records fit velocities too.
+//
+// The trajectory comes from a sampler (any thread, if the sampler is), from
+// dense samples (cubic Hermite between them), or from an SPK file, segment
+// by segment (game thread).  See also USpiceCompressSPKCommandlet.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCompression.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+
+namespace MaxQ::Compression
+{
+    struct FChebyshevFitSettings
+    {
+        double PositionTolerance = 1e-3;        // km
+        double VelocityTolerance = 1e-6;        // km/s
+        bool bFitVelocity = false;              // Type 3, rather than type 2
+        int32 MinDegree = 3;
+        int32 MaxDegree = 15;                   // At most 25
+        double MinRecordSeconds = 1.;           // Below this, records are kept over tolerance
+        double MaxRecordSeconds = 32. * 86400.;
+    };
+
+    // Records for spkw02 (bVelocity false) or spkw03
+    struct FChebyshevSegment
+    {
+        double First = 0.;
+        double Last = 0.;
+        double IntervalLength = 0.;
+        int32 Degree = 0;
+        int32 Records = 0;
+        bool bVelocity = false;
+        TArray<double> Coefficients;            // Per record:  x, y, z (, vx, vy, vz) coefficients
+    };
+
+    struct FCompressionStats
+    {
+        int32 Segments = 0;
+        int32 Records = 0;
+        int32 RecordsOverTolerance = 0;
+        int64 Checks = 0;                       // States compared with the trajectory
+        double MaxPositionError = 0.;           // km
+        double RmsPositionError = 0.;
+        double MaxVelocityError = 0.;           // km/s
+        double RmsVelocityError = 0.;
+        int64 InputBytes = 0;
+        int64 OutputBytes = 0;
+
+        double Ratio() const { return OutputBytes > 0 ? (double)InputBytes / (double)OutputBytes : 0.; }
+    };
+
+    // et -> x, y, z, vx, vy, vz
+    using FStateSampler = TFunctionRef<void(double, double(&)[6])>;
+
+    // Any thread the sampler can run on.  Appends to Segments, accumulates
+    // into Stats.
+    SPICE_API void FitChebyshev(
+        FStateSampler Sampler,
+        double First,
+        double Last,
+        const FChebyshevFitSettings& Settings,
+        TArray<FChebyshevSegment>& Segments,
+        FCompressionStats& Stats
+    );
+
+    // Any thread.  States hold 6 doubles per epoch, epochs strictly
+    // increase.
+    SPICE_API void FitChebyshev(
+        const TArray<double>& Epochs,
+        const TArray<double>& States,
+        const FChebyshevFitSettings& Settings,
+        TArray<FChebyshevSegment>& Segments,
+        FCompressionStats& Stats,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Game thread.  Writes Segments to an SPK open for writing.  False if a
+    // segment couldn't be written.
+    SPICE_API bool WriteChebyshev(
+        int handle,
+        int body,
+        int center,
+        const FName& frame,
+        const FString& segid,
+        const TArray<FChebyshevSegment>& Segments,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Game thread.  Fits every segment of InputFile and writes the fits to
+    // OutputFile (replacing it), with the same body, center, frame and
+    // segment id.  Paths are absolute, or relative to /Content.
+    SPICE_API void CompressSpk(
+        const FString& InputFile,
+        const FString& OutputFile,
+        const FChebyshevFitSettings& Settings,
+        FCompressionStats& Stats,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,89 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceConstantCache.h
+//
+// API Comments
+//
+// Purpose:  Cache kernel pool constants (RADII, GM, ...) between pool updates
+//
+// MaxQ::Data::Bodvrd/Bodvcd/Gdpool and USpice::gdpool_* read through this
+// cache.  Entries are keyed by (body, item) for bodvrd and by pool variable
+// name for bodvcd/gdpool, and hold the whole variable (up to MaxValues
+// doubles).
+//
+// Each pool variable an entry depends on gets a CSPICE watcher (swpool_c).
+// Validate() checks the watchers (cvpool_c) and drops only the entries whose
+// variables were updated.  MaxQ validates whenever kernels are loaded,
+// unloaded or cleared, and after its own pool writers (pdpool, pipool,
+// pcpool); call Validate() after writing to the pool directly via CSPICE.
+// Boddef, which changes name/code mappings outside the pool, drops all
+// entries.
+//
+// Find() is lock-free and may be called from any thread.  Misses, Add and
+// Validate are game thread only; off the game thread, a miss reads the pool
+// without caching the result.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceConstantCache.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+
+namespace MaxQ::ConstantCache
+{
+    // Larger variables are always read from the pool
+    constexpr int32 MaxValues = 32;
+    constexpr int32 MaxKeyLength = 96;
+
+    struct FValues
+    {
+        int32 Num = 0;
+        double Values[MaxValues];
+    };
+
+    struct FStats
+    {
+        int32 Entries = 0;              // Valid entries
+        int32 WatchedVariables = 0;
+        int64 Hits = 0;
+        int64 Misses = 0;
+        int64 Invalidations = 0;
+
+        double HitRate() const { return Hits + Misses > 0 ? (double)Hits / (Hits + Misses) : 0.; }
+    };
+
+    // Lock-free, any thread
+    SPICE_API bool Find(const ANSICHAR* Key, FValues& Values);
+
+    // Caches Values under Key until any of the pool Variables is updated.
+    SPICE_API void Add(const ANSICHAR* Key, const FValues& Values, TArrayView<const ANSICHAR* const> Variables);
+
+    // Drops the entries whose pool variables have been updated since cached
+    SPICE_API void Validate();
+    SPICE_API void InvalidateAll();
+
+    // bodvrd_c, bodvcd_c, gdpool_c through the cache.  Room is the capacity
+    // of Values.  N is the variable's size, which may exceed Room, except for
+    // Gdpool where (as gdpool_c) it's the number of values returned.  Gdpool
+    // returns whether the variable was found, the others success.
+    SPICE_API bool Bodvrd(const ANSICHAR* bodynm, const ANSICHAR* item, double* Values, int32 Room, int32& N, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+    SPICE_API bool Bodvcd(int bodyid, const ANSICHAR* item, double* Values, int32 Room, int32& N, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+    SPICE_API bool Gdpool(const ANSICHAR* name, double* Values, int32 Room, int32& N, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+    SPICE_API FStats GetStats();
+    SPICE_API void ResetStats();
+}
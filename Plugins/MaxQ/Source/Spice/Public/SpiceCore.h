@@ -30,4 +30,89 @@ namespace MaxQ::Core
     SPICE_API void InitAll(bool bPrintCallstack = false);
     SPICE_API void Reset();
     SPICE_API void ClearAll();
+
+    // Interned ANSI strings for names (bodies, frames, kernel pool items...)
+    // CSPICE only accepts ANSI strings, so each FString/TCHAR argument is
+    // converted on every call.  For per-tick queries (500 bodies x spkezr)
+    // that's measurable.  An FName is converted once, the first time it's
+    // seen, and the ANSI copy is kept for the life of the process.  The
+    // returned pointer is stable and safe to share across threads.
+    //
+    // The key is the FName's display string, so it's exactly as
+    // case-sensitive as the FName itself.  Kernel pool variable names ARE
+    // case-sensitive in CSPICE, and non-editor builds don't preserve FName
+    // case... so mixed-case pool variables belong in the FString overloads.
+    SPICE_API const ANSICHAR* ToANSIString(const FName& Name);
+
+    // Number of distinct names interned so far (diagnostics)
+    SPICE_API int32 GetInternedANSIStringCount();
+
+    // Deferred error reporting, for hot loops.
+    // Normally every failed MaxQ call fetches the long & short CSPICE messages,
+    // logs a warning, and dumps the script callstack.  A batch of 10k calls
+    // over bad data (evsgp4 + BADMECCENTRICITY, etc) spends most of its time
+    // (and log) doing that.
+    // While a scope is active on the calling thread, failures are recorded as
+    // short error codes (SPICE(...)) with the item index that was current at
+    // the time, deduplicated, and reported once when the scope exits.
+    // ResultCode is still set per call, ErrorMessage receives the short code.
+    //
+    // Usage:
+    //    MaxQ::Core::FDeferredErrorScope Errors(TEXT("Propagate TLEs"));
+    //    for (int i = 0; i < N; ++i)
+    //    {
+    //        Errors.SetItemIndex(i);
+    //        USpice::evsgp4(ResultCode, ErrorMessage, ...);
+    //    }
+    //    // one summary logged here
+    class SPICE_API FDeferredErrorScope
+    {
+    public:
+        // Distinct error codes tracked individually, anything past that is
+        // only counted.
+        static constexpr int32 DefaultMaxDistinctErrors = 16;
+        // Item indices remembered per error code
+        static constexpr int32 MaxIndicesPerError = 8;
+
+        explicit FDeferredErrorScope(const TCHAR* ScopeName = TEXT("MaxQ"), int32 MaxDistinctErrors = DefaultMaxDistinctErrors, bool bLogOnExit = true);
+        ~FDeferredErrorScope();
+
+        FDeferredErrorScope(const FDeferredErrorScope&) = delete;
+        FDeferredErrorScope& operator=(const FDeferredErrorScope&) = delete;
+
+        // Tags subsequent failures with the index of the item being processed.
+        inline void SetItemIndex(int32 Index) { ItemIndex = Index; }
+
+        inline int32 GetFailureCount() const { return FailureCount; }
+        inline bool HasFailures() const { return FailureCount > 0; }
+
+        // Multi-line summary of the failures recorded so far.
+        FString GetSummary() const;
+
+        // The innermost active scope on this thread, if any.
+        static FDeferredErrorScope* Current();
+
+        // Called by MaxQ's error checks when a CSPICE call failed while a scope
+        // is active.  Reads the short message (and, once per distinct code, the
+        // long message) and leaves the CSPICE error state for the caller to reset.
+        void RecordFailure(ES_ResultCode& ResultCode, FString& ErrorMessage);
+
+    private:
+        struct FErrorRecord
+        {
+            ANSICHAR ShortMessage[26];
+            FString FirstLongMessage;
+            int32 Count = 0;
+            TArray<int32, TInlineAllocator<MaxIndicesPerError>> ItemIndices;
+        };
+
+        const TCHAR* ScopeName;
+        int32 MaxDistinctErrors;
+        bool bLogOnExit;
+        int32 ItemIndex;
+        int32 FailureCount;
+        int32 UntrackedFailureCount;
+        TArray<FErrorRecord> Records;
+        FDeferredErrorScope* OuterScope;
+    };
 };
\ No newline at end of file
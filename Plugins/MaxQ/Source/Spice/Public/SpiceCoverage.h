@@ -0,0 +1,76 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCoverage.h
+//
+// API Comments
+//
+// Purpose:  Is there data for this body/frame/instrument at this ET?
+//
+// USpice::spkcov/ckcov/pckcov open one file and scan its segment summaries,
+// every call.  The coverage index does that once per file, when the file is
+// loaded, and keeps one merged & sorted interval list per id across every
+// loaded kernel:
+// * SPK:  ephemeris object (body) ids
+// * CK:   instrument/structure ids (any pointing, with or without angular
+//         velocity, at segment-interval granularity)
+// * PCK:  binary PCK frame class ids
+//
+// Queries are O(log n) in the number of intervals for the id, and safe from
+// any thread.  The index follows furnsh/unload/clear through MaxQ's kernel
+// functions;  only the files loaded or unloaded since the last refresh are
+// (re)scanned.  Kernels loaded directly through CSPICE are picked up by the
+// next Refresh().
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCoverage.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+
+namespace MaxQ::Coverage
+{
+    enum class EKernelKind : uint8
+    {
+        SPK,
+        CK,
+        PCK
+    };
+
+    // Brings the index up to date with the kernels CSPICE has loaded.
+    // Calls CSPICE, so game thread only.  MaxQ's furnsh/unload/clear call it.
+    SPICE_API void Refresh();
+
+    // Does any loaded kernel cover the id at et?
+    SPICE_API bool IsCovered(EKernelKind Kind, int32 Id, const FSEphemerisTime& et);
+
+    // Merged coverage windows for the id, sorted.  False if there are none.
+    SPICE_API bool GetCoverage(EKernelKind Kind, int32 Id, TArray<FSWindowSegment>& Windows);
+
+    // et itself if it's covered, otherwise the closest covered ET (the start
+    // or stop of a window).  False if the id has no coverage.
+    SPICE_API bool NearestCovered(EKernelKind Kind, int32 Id, const FSEphemerisTime& et, FSEphemerisTime& Nearest);
+
+    // Every id with coverage, sorted
+    SPICE_API TArray<int32> GetIds(EKernelKind Kind);
+
+    // Kernel files currently indexed
+    SPICE_API TArray<FString> GetIndexedFiles();
+
+    // SPK conveniences, by body name (bods2c)
+    SPICE_API bool IsCovered(const FName& Body, const FSEphemerisTime& et);
+    SPICE_API bool GetCoverage(const FName& Body, TArray<FSWindowSegment>& Windows);
+}
@@ -35,6 +35,8 @@ namespace MaxQ::Data
         FString* ErrorMessage = nullptr
     );
 
+    // Loads the directory's kernels in load order, LSK, PCK, FK, SCLK, IK,
+    // SPK, CK... (see SpiceKernelCatalog.h).  Other files are skipped.
     SPICE_API bool FurnshDirectory(
         const FString& relativeDirectory = TEXT("NonAssetData/kernels"),
         bool ErrorIfNoFilesFound = true,
@@ -62,6 +64,11 @@ namespace MaxQ::Data
 
     SPICE_API FSEphemerisTime Now();
 
+    // FName overloads pass the name's interned ANSI string (see
+    // MaxQ::Core::ToANSIString(FName)) directly to CSPICE, with no per-call
+    // string conversion.  Prefer them (and the FNames in SpiceConstants.h) for
+    // anything queried every tick.  FString overloads convert on each call.
+    // Kernel pool items are case-sensitive, see the FName case note in SpiceCore.h.
     SPICE_API void Bodvrd(
         double& Value,
         const FString& bodynm,
@@ -70,6 +77,14 @@ namespace MaxQ::Data
         FString* ErrorMessage
     );
 
+    SPICE_API void Bodvrd(
+        double& Value,
+        const FName& bodynm,
+        const FName& item,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    );
+
     template<class ValueType>
     SPICE_API void Bodvrd(
         ValueType& Value,
@@ -80,20 +95,14 @@ namespace MaxQ::Data
     );
 
     template<class ValueType>
-    inline void Bodvrd(
+    SPICE_API void Bodvrd(
         ValueType& Value,
         const FName& bodynm,
         const FName& item,
         ES_ResultCode* ResultCode = nullptr,
         FString* ErrorMessage = nullptr
-    )
-    {
-        Bodvrd<ValueType>(Value, bodynm.ToString(), item.ToString(), ResultCode, ErrorMessage);
-    }
+    );
 
-    // Note that an ANSICHAR version could avoid a bunch of string conversions, but that's an optimization to use only if a
-    // proven problem exists.  The performance of Bodvrd is likely to be dominated by whatever's going on in bodvrd_c, not
-    // string conversions.
     template<class ValueType>
     inline void Bodvrd(
         ValueType& Value,
@@ -139,7 +148,22 @@ namespace MaxQ::Data
         FString* ErrorMessage = nullptr
     )
     {
-        return Bodvrd<ValueType>(bodynm.ToString(), item.ToString(), ResultCode, ErrorMessage);
+        ValueType ReturnValue;
+        Bodvrd<ValueType>(ReturnValue, bodynm, item, ResultCode, ErrorMessage);
+        return ReturnValue;
+    }
+
+    template<>
+    inline double Bodvrd(
+        const FName& bodynm,
+        const FName& item,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        double ReturnValue;
+        Bodvrd(ReturnValue, bodynm, item, ResultCode, ErrorMessage);
+        return ReturnValue;
     }
 
     // TCHAR prevents an ambiguous definition whenever the user uses them, since both
@@ -163,6 +187,14 @@ namespace MaxQ::Data
         FString* ErrorMessage
     );
 
+    SPICE_API void Bodvcd(
+        double& Value,
+        int bodyid,
+        const FName& item,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    );
+
     template<class ValueType>
     SPICE_API void Bodvcd(
         ValueType& Value,
@@ -173,16 +205,13 @@ namespace MaxQ::Data
     );
 
     template<class ValueType>
-    inline void Bodvcd(
+    SPICE_API void Bodvcd(
         ValueType& Value,
         int bodyid = 399,
         const FName& item = TEXT("RADII"),
         ES_ResultCode* ResultCode = nullptr,
         FString* ErrorMessage = nullptr
-    )
-    {
-        Bodvcd<ValueType>(Value, bodyid, item.ToString(), ResultCode, ErrorMessage);
-    }
+    );
 
     template<class ValueType>
     inline ValueType Bodvcd(
@@ -218,7 +247,22 @@ namespace MaxQ::Data
         FString* ErrorMessage = nullptr
     )
     {
-        return Bodvcd<ValueType>(bodyid, item.ToString(), ResultCode, ErrorMessage);
+        ValueType ReturnValue;
+        Bodvcd<ValueType>(ReturnValue, bodyid, item, ResultCode, ErrorMessage);
+        return ReturnValue;
+    }
+
+    template<>
+    inline double Bodvcd(
+        int bodyid,
+        const FName& item,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        double ReturnValue;
+        Bodvcd(ReturnValue, bodyid, item, ResultCode, ErrorMessage);
+        return ReturnValue;
     }
 
     SPICE_API void Gdpool(
@@ -228,6 +272,13 @@ namespace MaxQ::Data
         FString* ErrorMessage = nullptr
     );
 
+    SPICE_API void Gdpool(
+        double& Value,
+        const FName& item,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
     inline double Gdpool(
         const FString& item,
         ES_ResultCode* ResultCode = nullptr,
@@ -239,8 +290,28 @@ namespace MaxQ::Data
         return ReturnValue;
     }
 
+    inline double Gdpool(
+        const FName& item,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        double ReturnValue;
+        Gdpool(ReturnValue, item, ResultCode, ErrorMessage);
+        return ReturnValue;
+    }
+
+    inline double Gdpool(
+        const TCHAR* item,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        return Gdpool(FString(item), ResultCode, ErrorMessage);
+    }
+
     // Gdpool
-    // Only support FStrings, at least for now...
+    // Pool variable names are case-sensitive, see the note on FName case in SpiceCore.h
     template<class ValueType>
     SPICE_API void Gdpool(
         ValueType& Value,
@@ -249,6 +320,25 @@ namespace MaxQ::Data
         FString* ErrorMessage = nullptr
     );
 
+    template<class ValueType>
+    SPICE_API void Gdpool(
+        ValueType& Value,
+        const FName& item,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    template<class ValueType>
+    inline void Gdpool(
+        ValueType& Value,
+        const TCHAR* item,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        Gdpool(Value, FString(item), ResultCode, ErrorMessage);
+    }
+
     template<class ValueType>
     inline ValueType Gdpool(
         const FString& item,
@@ -257,7 +347,31 @@ namespace MaxQ::Data
     )
     {
         ValueType ReturnValue;
-        Gdpool<ValueType>(ReturnValue, item, ResultCode, ErrorMessage);
+        Gdpool(ReturnValue, item, ResultCode, ErrorMessage);
+        return ReturnValue;
+    }
+
+    template<class ValueType>
+    inline ValueType Gdpool(
+        const FName& item,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        ValueType ReturnValue;
+        Gdpool(ReturnValue, item, ResultCode, ErrorMessage);
+        return ReturnValue;
+    }
+
+    template<class ValueType>
+    inline ValueType Gdpool(
+        const TCHAR* item,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        ValueType ReturnValue;
+        Gdpool(ReturnValue, FString(item), ResultCode, ErrorMessage);
         return ReturnValue;
     }
 
@@ -266,7 +380,7 @@ namespace MaxQ::Data
         int& code,
         const FString& name = TEXT("EARTH")
     );
-    inline bool Bods2c(int& code, FName name) { return Bods2c(code, name.ToString());}
+    SPICE_API bool Bods2c(int& code, const FName& name);
     inline bool Bods2c(int& code, TCHAR* name) { return Bods2c(code, FString(name));}
 
     SPICE_API bool Bodc2n(
@@ -285,7 +399,7 @@ namespace MaxQ::Data
         int body,
         const FString& item
     );
-    inline bool Bodfnd(int body, FName item) { return Bodfnd(body, item.ToString()); }
+    SPICE_API bool Bodfnd(int body, const FName& item);
     inline bool Bodfnd(int body, TCHAR* item) { return Bodfnd(body, FString(item)); }
 
 
@@ -293,6 +407,6 @@ namespace MaxQ::Data
         const FString& name,
         int code = 3788040
     );
-    inline void Boddef(FName name = "OUMUAMUA", int code = 3788040) { return Boddef(name.ToString(), code); }
+    SPICE_API void Boddef(const FName& name = "OUMUAMUA", int code = 3788040);
     inline void Boddef(TCHAR* name, int code = 3788040) { return Boddef(FString(name), code); }
 };
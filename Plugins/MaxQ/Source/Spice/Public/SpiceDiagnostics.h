@@ -17,6 +17,12 @@
 // Dump kernel file coverages.
 // Dump info about kernel files currently in use.
 // Available to either Blueprints or C++.
+//
+// The coverage dumps read the file's summaries without loading it (see
+// SpiceKernelInspector.h), so they don't change the kernel pool.  TDB doesn't
+// need an LSK, and CK coverage is listed in SCLK ticks, plus TDB if the
+// clock's SCLK and an LSK are already loaded.  The Dump*Summary functions,
+// which took LSK & SCLK paths to load, are deprecated.
 //------------------------------------------------------------------------------
 
 #pragma once
@@ -41,7 +47,58 @@ public:
             Keywords = "UTILITY",
             ExpandEnumAsExecs = "ResultCode",
             ShortToolTip = "Summarize SPK file",
-            ToolTip = "Summarize an SPK file (coverages, etc)", 
+            ToolTip = "Summarize an SPK file (coverages, etc), without loading it",
+            DevelopmentOnly
+            ))
+    static void DumpSpkCoverage(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        FString& LogString,
+        const FString& relativeSpkPath = TEXT("NonAssetData/naif/kernels/Generic/SPK/planets/de440s.bsp")
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Diagnostics",
+        meta = (
+            Keywords = "UTILITY",
+            ExpandEnumAsExecs = "ResultCode",
+            ShortToolTip = "Summarize Binary PCK file",
+            ToolTip = "Summarize Binary PCK file (coverages, etc), without loading it",
+            DevelopmentOnly
+            ))
+    static void DumpPckCoverage(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        FString& LogString,
+        const FString& relativePckPath = TEXT("NonAssetData/naif/kernels/Generic/PCK/earth_200101_990628_predict.bpc")
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Diagnostics",
+        meta = (
+            Keywords = "UTILITY",
+            ExpandEnumAsExecs = "ResultCode",
+            ShortToolTip = "Summarize CK file",
+            ToolTip = "Summarize a CK Kernel file coverage (spacecraft & instrument rotation/orientation coverages, etc), without loading it.  Coverage is in SCLK ticks, and TDB if the SCLK and an LSK are loaded",
+            DevelopmentOnly
+            ))
+    static void DumpCkCoverage(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        FString& LogString,
+        const FString& relativeCkPath = TEXT("NonAssetData/naif/kernels/INSIGHT/CK/insight_ida_pot_210801_211218_v1.bc")
+    );
+
+    [[deprecated("Use DumpSpkCoverage(), which doesn't take the unused LSK path")]]
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Deprecated",
+        meta = (
+            DeprecatedFunction,
+            DeprecationMessage = "Use DumpSpkCoverage.  relativeLskPath is unused, the SPK is summarized without loading any kernels",
+            Keywords = "UTILITY",
+            ExpandEnumAsExecs = "ResultCode",
+            ShortToolTip = "Summarize SPK file",
+            ToolTip = "Summarize an SPK file (coverages, etc), without loading it.  relativeLskPath is unused",
             DevelopmentOnly
             ))
     static void DumpSpkSummary(
@@ -52,13 +109,16 @@ public:
         const FString& relativeSpkPath = TEXT("NonAssetData/naif/kernels/Generic/SPK/planets/de440s.bsp")
     );
 
+    [[deprecated("Use DumpPckCoverage(), which doesn't take the unused LSK path")]]
     UFUNCTION(BlueprintCallable,
-        Category = "MaxQ|Diagnostics",
+        Category = "MaxQ|Deprecated",
         meta = (
+            DeprecatedFunction,
+            DeprecationMessage = "Use DumpPckCoverage.  relativeLskPath is unused, the PCK is summarized without loading any kernels",
             Keywords = "UTILITY",
             ExpandEnumAsExecs = "ResultCode",
             ShortToolTip = "Summarize Binary PCK file",
-            ToolTip = "Summarize Binary PCK file (coverages, etc)", 
+            ToolTip = "Summarize Binary PCK file (coverages, etc), without loading it.  relativeLskPath is unused",
             DevelopmentOnly
             ))
     static void DumpPckSummary(
@@ -68,14 +128,17 @@ public:
         const FString& relativeLskPath = TEXT("NonAssetData/naif/kernels/Generic/LSK/naif0012.tls"),
         const FString& relativePckPath = TEXT("NonAssetData/naif/kernels/Generic/PCK/earth_200101_990628_predict.bpc")
     );
-    
+
+    [[deprecated("Use DumpCkCoverage(), which doesn't take the unused LSK & SCLK paths")]]
     UFUNCTION(BlueprintCallable,
-        Category = "MaxQ|Diagnostics",
+        Category = "MaxQ|Deprecated",
         meta = (
+            DeprecatedFunction,
+            DeprecationMessage = "Use DumpCkCoverage.  relativeLskPath & relativeSclkPath are unused:  furnsh them first for TDB times",
             Keywords = "UTILITY",
             ExpandEnumAsExecs = "ResultCode",
             ShortToolTip = "Summarize CK file",
-            ToolTip = "Summarize a CK Kernel file coverage (spacecraft & instrument rotation/orientation coverages, etc)", 
+            ToolTip = "Summarize a CK Kernel file coverage (spacecraft & instrument rotation/orientation coverages, etc), without loading it.  Coverage is in SCLK ticks, and TDB if the SCLK and an LSK are loaded.  relativeLskPath & relativeSclkPath are unused",
             DevelopmentOnly
             ))
     static void DumpCkSummary(
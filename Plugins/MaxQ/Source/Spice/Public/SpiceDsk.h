@@ -0,0 +1,114 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDsk.h
+//
+// API Comments
+//
+// Purpose:  Fast ray casting against DSK type 2 (triangular plate) shape
+// models
+//
+// CSPICE's dskxv_c searches a type 2 segment's coarse voxel grid, ray by
+// ray, on one thread.  Surface picks, line of sight and LIDAR simulation
+// against high resolution shape models cast far more rays than that keeps
+// up with.
+//
+// FPlateModel reads a body's plates and vertices out of the loaded DSK
+// segments once, and builds a bounding volume hierarchy over them (binned
+// surface area heuristic).  Intersect() then casts batches of rays in small
+// packets that traverse the hierarchy together, with the batch split across
+// the task graph.  Like dskxv_c it returns each ray's nearest intercept over
+// every segment, hitting plates from either side.
+//
+// A model is immutable once built, so any number of threads may cast rays
+// against it.  Building one from loaded kernels calls CSPICE (game thread
+// only).  Rays and intercepts are in the model's body-fixed frame (the
+// segments' frame, see GetFrameId()), in km.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDsk.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+
+namespace MaxQ::Dsk
+{
+    class FPlateModel;
+    using FPlateModelPtr = TSharedPtr<const FPlateModel, ESPMode::ThreadSafe>;
+
+    class SPICE_API FPlateModel
+    {
+    public:
+        // Vertices in km, plates as zero-based vertex indices
+        FPlateModel(TArray<FVector3d>&& InVertices, TArray<FIntVector3>&& InPlates, int32 InBody = 0, int32 InFrameId = 0);
+
+        // Every type 2 segment for Body in the loaded DSKs, restricted to
+        // Surfaces unless it's empty.  The segments must share a frame.
+        static FPlateModelPtr Load(int32 Body, const TArray<int32>& Surfaces, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+        static FPlateModelPtr Load(const FName& Body, const TArray<int32>& Surfaces, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        // Nearest intercept of each ray.  Points[i] is only meaningful where
+        // Found[i].  PlateIds (optional) receives the one-based plate numbers
+        // dskx02_c would report, counting across segments in load order.
+        void Intersect(TArrayView<const FSRay> Rays, TArray<FSDistanceVector>& Points, TArray<bool>& Found, TArray<int32>* PlateIds = nullptr) const;
+
+        // A single ray, on the calling thread
+        bool Intersect(const FSRay& Ray, FSDistanceVector& Point, int32* PlateId = nullptr) const;
+
+        int32 GetBody() const { return Body; }
+        int32 GetFrameId() const { return FrameId; }
+        int32 NumPlates() const { return Triangles.Num(); }
+        int32 NumVertices() const { return NumModelVertices; }
+        int32 NumNodes() const { return Nodes.Num(); }
+        const FBox3d& GetBounds() const { return Bounds; }
+
+        // Rays per packet, and packets per task-graph chunk
+        static constexpr int32 PacketSize = 8;
+        static constexpr int32 PacketsPerChunk = 32;
+
+    private:
+        struct FNode
+        {
+            FVector3d Min;
+            FVector3d Max;
+            int32 Offset = 0;   // Interior:  left child (right is next), leaf:  first triangle
+            int32 Count = 0;    // Triangles, 0 for interior nodes
+            int32 Axis = 0;     // Interior:  split axis, for front to back traversal
+        };
+
+        // Moller-Trumbore form, in hierarchy order
+        struct FTriangle
+        {
+            FVector3d Vertex;
+            FVector3d Edge1;
+            FVector3d Edge2;
+            int32 Plate = 0;    // One-based
+        };
+
+        struct FPacket;
+
+        void Build(const TArray<FVector3d>& Vertices, const TArray<FIntVector3>& Plates);
+        void IntersectPacket(FPacket& Packet) const;
+
+        TArray<FNode> Nodes;
+        TArray<FTriangle> Triangles;
+        FBox3d Bounds;
+        int32 NumModelVertices = 0;
+        int32 Body = 0;
+        int32 FrameId = 0;
+    };
+}
@@ -0,0 +1,147 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskMesh.h
+//
+// API Comments
+//
+// Purpose:  Renderable, tiled and LOD'd mesh data from DSK type 2 shape models
+//
+// FShapeMeshBuilder converts a body's loaded type 2 DSK segments without
+// blocking the game thread for more than a time budget per tick:  vertices
+// and plates are read in chunks (CSPICE is game thread only), then tiling,
+// normals and LODs are built on a worker thread.  In the editor, results are
+// stored in the derived data cache, keyed on the segments and settings, so
+// converting the same model again is a cache fetch.
+//
+// The surface is split into tiles by direction from the model's center
+// (6 cube faces x TilesPerFace^2).  Each tile has LOD 0 at full resolution,
+// then successively coarser LODs made by vertex clustering over a grid that
+// doubles each LOD.  Clusters are global, so neighboring tiles at the same
+// LOD share their border vertices.  Normals are area weighted vertex normals,
+// computed over the whole model before tiling.
+//
+// Positions are in km in the segments' body-fixed frame, stored as floats
+// relative to each tile's Origin.  Indices keep the plates' winding
+// (counterclockwise seen from outside, right handed).  Converting to UE's
+// frame and units is up to the consumer, as with other MaxQ geometry.
+//
+// SelectLods() picks a LOD per tile for a view point, for streaming tiles in
+// and out by camera distance.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskMesh.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "SpiceTypes.h"
+
+namespace MaxQ::Dsk
+{
+    struct FMeshSettings
+    {
+        int32 TilesPerFace = 4;             // 6 * TilesPerFace^2 tiles (empty ones are dropped)
+        int32 NumLods = 5;                  // Including LOD 0
+        int32 ChunkSize = 65536;            // Vertices or plates read per CSPICE call
+        double ReadBudgetSeconds = 0.004;   // Game thread time per tick, BuildAsync
+        bool bUseDerivedDataCache = true;   // Editor only
+    };
+
+    struct FMeshLod
+    {
+        TArray<FVector3f> Positions;        // km, relative to the tile's Origin
+        TArray<FVector3f> Normals;
+        TArray<uint32> Indices;
+        float GeometricError = 0.f;         // km, how far this LOD may stray from the model
+    };
+
+    struct FMeshTile
+    {
+        FVector3d Origin;
+        FBox3d Bounds;
+        TArray<FMeshLod> Lods;              // Finest first, at least one
+    };
+
+    struct FMeshStats
+    {
+        double ReadSeconds = 0.;            // Game thread, summed over ticks
+        double BuildSeconds = 0.;           // Worker thread
+        SIZE_T PeakBytes = 0;               // Plate data and intermediates held at once
+        bool bFromCache = false;
+        int32 Tiles = 0;
+        int32 Triangles = 0;                // All tiles, all LODs
+    };
+
+    class SPICE_API FShapeMesh
+    {
+    public:
+        // From plates (zero-based) and vertices in km already in memory.  No
+        // CSPICE calls, any thread.
+        static TSharedPtr<const FShapeMesh, ESPMode::ThreadSafe> Build(TArray<FVector3d>&& Vertices, TArray<FIntVector3>&& Plates, const FMeshSettings& Settings = FMeshSettings(), FMeshStats* Stats = nullptr);
+
+        // LOD per tile for a view point (body-fixed, km):  the coarsest whose
+        // GeometricError subtends at most MaxAngularError (radians).
+        void SelectLods(const FVector3d& ViewPoint, double MaxAngularError, TArray<int32>& TileLods) const;
+
+        SIZE_T GetAllocatedSize() const;
+
+        friend SPICE_API FArchive& operator<<(FArchive& Ar, FShapeMesh& Mesh);
+
+        TArray<FMeshTile> Tiles;
+        FBox3d Bounds = FBox3d(ForceInit);
+        int32 Body = 0;
+        int32 FrameId = 0;
+        int32 NumPlates = 0;
+        int32 NumVertices = 0;
+    };
+
+    using FShapeMeshPtr = TSharedPtr<const FShapeMesh, ESPMode::ThreadSafe>;
+
+    class SPICE_API FShapeMeshBuilder
+    {
+    public:
+        // Game thread.  Starts converting Body's loaded type 2 segments,
+        // restricted to Surfaces unless it's empty.  They must share a frame.
+        static TSharedPtr<FShapeMeshBuilder> Start(int32 Body, const TArray<int32>& Surfaces, const FMeshSettings& Settings = FMeshSettings(), ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        // Start(), ticked by the core ticker.  Completes on the game thread,
+        // with null if conversion failed.
+        static TFuture<FShapeMeshPtr> BuildAsync(int32 Body, const TArray<int32>& Surfaces, const FMeshSettings& Settings = FMeshSettings());
+
+        // Game thread.  Reads chunks until BudgetSeconds is spent, returns
+        // IsDone().  Kernels mustn't be unloaded while reading.
+        bool Tick(double BudgetSeconds);
+
+        bool IsDone() const;
+
+        // Null until done, or if conversion failed
+        FShapeMeshPtr GetResult() const;
+        const FString& GetError() const;
+
+        // 0..1, reading then building
+        float GetProgress() const;
+
+        // Valid once done
+        const FMeshStats& GetStats() const;
+
+        struct FState;
+
+    private:
+        FShapeMeshBuilder() = default;
+
+        TSharedPtr<FState, ESPMode::ThreadSafe> State;
+    };
+}
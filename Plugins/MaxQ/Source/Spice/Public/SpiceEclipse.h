@@ -0,0 +1,125 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEclipse.h
+//
+// API Comments
+//
+// Purpose:  Eclipse state & sunlight fraction for large batches of positions
+// (occult, gfoclt)
+//
+// Calling occult_c per spacecraft looks up the source and occulting bodies
+// again for every spacecraft.  FEclipseEngine looks them up once per ET
+// (Update), then Evaluate() classifies any number of positions against them
+// without CSPICE, in parallel:
+//
+//   NONE     the source's disk is clear
+//   PARTIAL  penumbra
+//   ANNULAR  an occulter is inside the source's disk (antumbra)
+//   FULL     umbra
+//
+// along with the fraction of the source's disk that's visible (the conical
+// shadow model: disks of the apparent angular radii, overlapping on the
+// sky).  With several occulters, the darkest one is reported.
+//
+// The source is a sphere of its mean radius.  Occulters are spheres of their
+// mean radius, or ellipsoids (bodvrd RADII, oriented by the body's frame).
+// An ellipsoid's apparent radius is its limb's exact angular distance from
+// its center in the direction of the source's center, so an ellipsoid's
+// outline is only compared with the source's disk along that direction.
+// Classifications match occult_c's except very near a shadow boundary.
+//
+// Positions are relative to the engine's center body, in its frame, and see
+// the bodies at the center's light time when aberration corrections are
+// used.  Positions inside an occulter are FULL.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEclipse.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+
+namespace MaxQ::Eclipse
+{
+    // Structure-of-arrays positions, km
+    struct FPositionBatch
+    {
+        TArray<double> X;
+        TArray<double> Y;
+        TArray<double> Z;
+
+        int32 Num() const { return X.Num(); }
+
+        void Reset(int32 Slack = 0) { X.Reset(Slack); Y.Reset(Slack); Z.Reset(Slack); }
+        void Add(const FVector3d& Position) { X.Add(Position.X); Y.Add(Position.Y); Z.Add(Position.Z); }
+        FVector3d Get(int32 i) const { return FVector3d(X[i], Y[i], Z[i]); }
+    };
+
+    class SPICE_API FEclipseEngine
+    {
+    public:
+        // Game thread.  Positions will be relative to center, in frame.
+        // Radii come from the kernel pool (RADII), body frames from cnmfrm.
+        static TSharedPtr<FEclipseEngine> Create(
+            const FName& source,
+            const TArray<FName>& occulters,
+            const FName& center,
+            const FName& frame,
+            bool bEllipsoids = true,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Game thread.  Looks up the bodies at et:  one spkpos per body, and
+        // one pxform per ellipsoidal occulter.
+        void Update(
+            const FSEphemerisTime& et,
+            ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Any thread, after Update.  Resizes the outputs to Positions.Num().
+        // Visible is the unobstructed fraction of the source's disk, 0..1.
+        void Evaluate(const FPositionBatch& Positions, TArray<float>& Visible, TArray<ES_OccultationType>& Shadow) const;
+
+        // Same, for one position
+        ES_OccultationType Evaluate(const FVector3d& Position, float* Visible = nullptr) const;
+
+        const FSEphemerisTime& GetEt() const { return Et; }
+
+        struct FBody
+        {
+            FName Name;
+            FName Frame;                    // Body-fixed, for ellipsoids
+            FVector3d Radii = FVector3d::ZeroVector;
+            double MeanRadius = 0.;
+            FVector3d Position = FVector3d::ZeroVector;
+            FVector3d ToBodyFixed[3];       // Rows of the frame to body-fixed rotation
+        };
+
+    private:
+        FEclipseEngine() = default;
+
+        FName Center;
+        FName Frame;
+        bool bEllipsoids = true;
+        FSEphemerisTime Et;
+        FBody Source;
+        TArray<FBody> Occulters;
+    };
+}
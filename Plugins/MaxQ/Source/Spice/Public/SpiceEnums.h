@@ -432,6 +432,14 @@ enum class ES_KernelType : uint8
 ENUM_CLASS_FLAGS(ES_KernelType);
 
 
+UENUM(BlueprintType)
+enum class ES_SPKRecordingType : uint8
+{
+    Hermite13   UMETA(DisplayName = "Type 13 (Hermite, unequal time steps)"),
+    Lagrange9   UMETA(DisplayName = "Type 9 (Lagrange, unequal time steps)")
+};
+
+
 namespace MaxQ::Core
 {
     // The problem with doing this by reflection, is that if the enum values are changed, then people's Blueprints will break with NO ERROR in the build nor for the user.
@@ -0,0 +1,173 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+//------------------------------------------------------------------------------
+// SpiceEphemeris.h
+// 
+// API Comments
+// 
+// Purpose:  Per-tick ephemeris & frame queries, by FName
+// (spkezr, spkpos, pxform, sxform, subpnt, sincpt)
+// 
+// Body & frame names are FNames, and are handed to CSPICE as interned ANSI
+// strings (MaxQ::Core::ToANSIString(FName)).  Nothing is converted or
+// allocated per call, which adds up when hundreds of bodies are updated
+// every tick.  The FString versions are in USpice (Spice.h).
+// 
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemeris.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Ephemeris
+{
+    // spkezr
+    SPICE_API void Spkezr(
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FSEphemerisTime& et,
+        const FName& targ,
+        const FName& obs,
+        const FName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    inline FSStateVector Spkezr(
+        const FSEphemerisTime& et,
+        const FName& targ,
+        const FName& obs,
+        const FName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        FSStateVector state;
+        FSEphemerisPeriod lt;
+        Spkezr(state, lt, et, targ, obs, ref, abcorr, ResultCode, ErrorMessage);
+        return state;
+    }
+
+    // spkpos
+    SPICE_API void Spkpos(
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt,
+        const FSEphemerisTime& et,
+        const FName& targ,
+        const FName& obs,
+        const FName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    inline FSDistanceVector Spkpos(
+        const FSEphemerisTime& et,
+        const FName& targ,
+        const FName& obs,
+        const FName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        FSDistanceVector ptarg;
+        FSEphemerisPeriod lt;
+        Spkpos(ptarg, lt, et, targ, obs, ref, abcorr, ResultCode, ErrorMessage);
+        return ptarg;
+    }
+
+    // pxform
+    SPICE_API void Pxform(
+        FSRotationMatrix& rotate,
+        const FSEphemerisTime& et,
+        const FName& from,
+        const FName& to,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    inline FSRotationMatrix Pxform(
+        const FSEphemerisTime& et,
+        const FName& from,
+        const FName& to,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        FSRotationMatrix rotate;
+        Pxform(rotate, et, from, to, ResultCode, ErrorMessage);
+        return rotate;
+    }
+
+    // sxform
+    SPICE_API void Sxform(
+        FSStateTransform& xform,
+        const FSEphemerisTime& et,
+        const FName& from,
+        const FName& to,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    inline FSStateTransform Sxform(
+        const FSEphemerisTime& et,
+        const FName& from,
+        const FName& to,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    )
+    {
+        FSStateTransform xform;
+        Sxform(xform, et, from, to, ResultCode, ErrorMessage);
+        return xform;
+    }
+
+    // subpnt
+    // DSK methods use all surfaces (DSK/UNPRIORITIZED).  To name surfaces, use USpice::subpnt.
+    SPICE_API void Subpnt(
+        FSDistanceVector& spoint,
+        FSEphemerisTime& trgepc,
+        FSDistanceVector& srfvec,
+        const FSEphemerisTime& et,
+        const FName& target,
+        const FName& fixref,
+        const FName& obsrvr,
+        ES_ComputationMethod method = ES_ComputationMethod::NEAR_POINT_ELLIPSOID,
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // sincpt
+    // DSK model uses all surfaces (DSK/UNPRIORITIZED).  To name surfaces, use USpice::sincpt.
+    SPICE_API bool Sincpt(
+        FSDistanceVector& spoint,
+        FSEphemerisTime& trgepc,
+        FSDistanceVector& srfvec,
+        const FSEphemerisTime& et,
+        const FName& target,
+        const FName& fixref,
+        const FName& obsrvr,
+        const FName& dref,
+        const FSDimensionlessVector& dvec,
+        ES_GeometricModel method = ES_GeometricModel::ELLIPSOID,
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+};
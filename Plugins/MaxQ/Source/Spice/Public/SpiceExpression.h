@@ -0,0 +1,119 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceExpression.h
+//
+// API Comments
+//
+// Purpose:  Compiled vector/matrix expressions, e.g. "unorm(m * r + dr)"
+//
+// An expression is parsed and type-checked once, against the MaxQ types of
+// its operands, including units (a distance plus a velocity is an error).
+// The result is a small stack program that reads the operands in place and
+// writes the result in place, so a chain of math operations costs one call
+// and no intermediate structs.  The "MaxQ Expression" K2 node compiles to
+// one of these.
+//
+// Syntax:
+//   operands:   names (r, dr, m_j2000...), case-insensitive
+//   constants:  1, 0.5, 1e-3 (dimensionless)
+//   operators:  + - * / and unary -, with parentheses
+//               scalar * x, x * scalar, x / scalar
+//               matrix * vector, matrix * matrix, transform * state...
+//   functions:  unorm(v), vhat(v), vnorm(v), vdot(a, b), vcrss(a, b),
+//               vsep(a, b), mxv(m, v), mtxv(m, v), mxm(m1, m2)
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceExpression.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Math
+{
+    // The MaxQ types an expression operand or result can have
+    enum class EExpressionType : uint8
+    {
+        Double,
+        SDistance,
+        SSpeed,
+        SAngularRate,
+        SAngle,
+        SMassConstant,
+        SDimensionlessVector,
+        SDistanceVector,
+        SVelocityVector,
+        SAngularVelocity,
+        SDimensionlessStateVector,
+        SStateVector,
+        SRotationMatrix,
+        SStateTransform,
+        Invalid
+    };
+
+    SPICE_API const TCHAR* ToString(EExpressionType Type);
+
+    class SPICE_API FExpression
+    {
+    public:
+        static constexpr int32 MaxOperands = 32;
+        static constexpr int32 MaxStackDepth = 16;
+
+        // Operand names in order of first appearance.  False on a syntax error.
+        static bool GetOperandNames(const FString& Source, TArray<FString>& OperandNames, FString& ErrorMessage);
+
+        // Parse & type-check.  OperandTypes are in GetOperandNames order.
+        // Returns nullptr, and the reason, if the expression doesn't compile.
+        static TSharedPtr<FExpression> Compile(const FString& Source, const TArray<EExpressionType>& OperandTypes, FString& ErrorMessage);
+
+        // A compiled "program string" (see GetProgramString), compiled once per
+        // distinct FName & cached.  Thread safe.  Never null: if the program
+        // doesn't compile (including one with more than MaxOperands operands)
+        // IsValid() is false, but NumOperands() is still correct.
+        static const FExpression* FindOrCompileProgram(FName Program);
+
+        bool IsValid() const { return bIsValid; }
+        int32 NumOperands() const { return OperandTypes.Num(); }
+        EExpressionType GetOperandType(int32 Index) const { return OperandTypes[Index]; }
+        EExpressionType GetResultType() const { return ResultType; }
+
+        // Operand-name-free form of the expression, with the operand types:
+        // "SRotationMatrix,SDistanceVector|unorm((($0*$1)+$2))".
+        // Compiling it again yields the same program.
+        const FString& GetProgramString() const { return ProgramString; }
+
+        // Operands[i] must point at a value of GetOperandType(i),
+        // Result at a value of GetResultType().
+        void Evaluate(const void* const* Operands, void* Result) const;
+
+        // Instructions are opaque outside SpiceExpression.cpp
+        struct FInstruction
+        {
+            uint8 Op;
+            uint8 Width;
+            int32 Index;
+        };
+
+    private:
+        bool bIsValid { false };
+        EExpressionType ResultType { EExpressionType::Invalid };
+        TArray<EExpressionType> OperandTypes;
+        TArray<FInstruction> Program;
+        TArray<double> Constants;
+        FString ProgramString;
+
+        friend class FExpressionCompiler;
+    };
+}
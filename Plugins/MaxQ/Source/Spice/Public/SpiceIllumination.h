@@ -0,0 +1,89 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceIllumination.h
+//
+// API Comments
+//
+// Purpose:  Batch illumination angles & shadowing over a body's surface
+// (illumf, ilumin) for baking into textures or vertex data
+//
+// Bake() evaluates a set of surface points (a lat/lon grid on the reference
+// ellipsoid, or a DSK mesh's vertices) at a list of ETs.  The observer and
+// illumination source positions are looked up once per ET, then every
+// point's incidence, emission and phase angles are computed in parallel.
+// With a DSK plate model, points facing the source are also tested for cast
+// shadows.
+//
+// The per-ET geometry is referred to the target's center:  light time is
+// the observer to center light time, rather than per point as in illumf_c.
+// With aberration corrections the angles differ from illumf_c's by the
+// body's rotation over the light time across its radius:  about 1.5e-6
+// radians for Earth or 8e-7 for Mars, but 4e-5 for Jupiter.  Without
+// corrections they're identical.
+//
+// Bake() calls CSPICE, game thread only.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceIllumination.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+
+namespace MaxQ::Dsk
+{
+    class FPlateModel;
+    class FShapeMesh;
+}
+
+namespace MaxQ::Illumination
+{
+    // Body-fixed, km, with outward unit normals
+    struct SPICE_API FSurfacePoints
+    {
+        TArray<FVector3d> Points;
+        TArray<FVector3d> Normals;
+
+        int32 Num() const { return Points.Num(); }
+
+        // Texel centers of a Width x Height planetocentric lat/lon grid on an
+        // ellipsoid.  Row 0 is the northernmost, column 0 is at -180 lon.
+        static FSurfacePoints EllipsoidGrid(const FSDistanceVector& Radii, int32 Width, int32 Height);
+
+        // A shape mesh LOD's vertices, tile by tile, in the tiles' order
+        static FSurfacePoints FromShapeMesh(const MaxQ::Dsk::FShapeMesh& Mesh, int32 Lod = 0);
+    };
+
+    // One texel per point per ET, ET major (Texels[et * Points.Num() + point]),
+    // so each ET of an EllipsoidGrid is a float RGBA image:
+    //   X: incidence, Y: emission, Z: phase (radians)
+    //   W: 1 if lit (source above the local horizon, and not shadowed by
+    //      Shadows), else 0
+    SPICE_API void Bake(
+        TArray<FVector4f>& Texels,
+        const FSurfacePoints& Points,
+        const TArray<FSEphemerisTime>& Ets,
+        const FName& target,
+        const FName& fixref,
+        const FName& obsrvr,
+        const FName& ilusrc,
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::None,
+        const MaxQ::Dsk::FPlateModel* Shadows = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
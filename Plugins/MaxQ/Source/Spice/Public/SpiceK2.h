@@ -222,6 +222,22 @@ public:
     );
     static constexpr TCHAR mxv_state_vector[] = TEXT("mxv_state_vector_K2");
 
+    // Array forms transform every vector by the same matrix in one native call,
+    // rather than a Blueprint ForEach loop around the scalar node.
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> mxv_vector_array_K2(
+        const FSRotationMatrix& m,
+        const TArray<FSDimensionlessVector>& v
+    );
+    static constexpr TCHAR mxv_vector_array[] = TEXT("mxv_vector_array_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessStateVector> mxv_state_vector_array_K2(
+        const FSStateTransform& m,
+        const TArray<FSDimensionlessStateVector>& v
+    );
+    static constexpr TCHAR mxv_state_vector_array[] = TEXT("mxv_state_vector_array_K2");
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static FSDimensionlessVector qderiv_vector_K2(
         const FSDimensionlessVector& f0,
@@ -264,6 +280,14 @@ public:
     static constexpr TCHAR unorm_vector_output_mag[] = TEXT("vmag");
     static constexpr TCHAR unorm_vector_output_direction[] = TEXT("vout");
 
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static void unorm_vector_array_K2(
+        const TArray<FSDimensionlessVector>& v,
+        TArray<FSDimensionlessVector>& vout,
+        TArray<double>& vmag
+    );
+    static constexpr TCHAR unorm_vector_array[] = TEXT("unorm_vector_array_K2");
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static FSDimensionlessVector vadd_vector_K2(
         const FSDimensionlessVector& v1,
@@ -282,6 +306,23 @@ public:
     );
     static constexpr TCHAR vadd_state_vector[] = TEXT("vadd_state_vector_K2");
 
+    // Element-wise array sums.  A single-element array is broadcast against
+    // the other operand; otherwise the lengths must match, and arrays of
+    // different lengths log a warning and sum to an empty array.
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> vadd_vector_array_K2(
+        const TArray<FSDimensionlessVector>& v1,
+        const TArray<FSDimensionlessVector>& v2
+    );
+    static constexpr TCHAR vadd_vector_array[] = TEXT("vadd_vector_array_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessStateVector> vadd_state_vector_array_K2(
+        const TArray<FSDimensionlessStateVector>& v1,
+        const TArray<FSDimensionlessStateVector>& v2
+    );
+    static constexpr TCHAR vadd_state_vector_array[] = TEXT("vadd_state_vector_array_K2");
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static FSDimensionlessVector vcrss_vector_K2(
         const FSDimensionlessVector& v1,
@@ -418,6 +459,21 @@ public:
     );
     static constexpr TCHAR vsub_state_vector[] = TEXT("vsub_state_vector_K2");
 
+    // Element-wise array differences, broadcasting the same way as vadd.
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> vsub_vector_array_K2(
+        const TArray<FSDimensionlessVector>& v1,
+        const TArray<FSDimensionlessVector>& v2
+    );
+    static constexpr TCHAR vsub_vector_array[] = TEXT("vsub_vector_array_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessStateVector> vsub_state_vector_array_K2(
+        const TArray<FSDimensionlessStateVector>& v1,
+        const TArray<FSDimensionlessStateVector>& v2
+    );
+    static constexpr TCHAR vsub_state_vector_array[] = TEXT("vsub_state_vector_array_K2");
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static void vupack_vector_K2(
         const FSDimensionlessVector& v,
@@ -561,5 +617,60 @@ public:
     static FSDistance Conv_SDimensionlessVector_Z_ToSDistance_K2(const FSDimensionlessVector& value);
     static constexpr ANSICHAR Conv_SDimensionlessVector_Z_ToSDistance[] = "Conv_SDimensionlessVector_Z_ToSDistance_K2";
 
+    // array converters
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDistanceVector> Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2(const TArray<FSDimensionlessVector>& value);
+    static constexpr ANSICHAR Conv_SDimensionlessVectorArrayToSDistanceVectorArray[] = "Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSVelocityVector> Conv_SDimensionlessVectorArrayToSVelocityVectorArray_K2(const TArray<FSDimensionlessVector>& value);
+    static constexpr ANSICHAR Conv_SDimensionlessVectorArrayToSVelocityVectorArray[] = "Conv_SDimensionlessVectorArrayToSVelocityVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSAngularVelocity> Conv_SDimensionlessVectorArrayToSAngularVelocityArray_K2(const TArray<FSDimensionlessVector>& value);
+    static constexpr ANSICHAR Conv_SDimensionlessVectorArrayToSAngularVelocityArray[] = "Conv_SDimensionlessVectorArrayToSAngularVelocityArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> Conv_SDistanceVectorArrayToSDimensionlessVectorArray_K2(const TArray<FSDistanceVector>& value);
+    static constexpr ANSICHAR Conv_SDistanceVectorArrayToSDimensionlessVectorArray[] = "Conv_SDistanceVectorArrayToSDimensionlessVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> Conv_SVelocityVectorArrayToSDimensionlessVectorArray_K2(const TArray<FSVelocityVector>& value);
+    static constexpr ANSICHAR Conv_SVelocityVectorArrayToSDimensionlessVectorArray[] = "Conv_SVelocityVectorArrayToSDimensionlessVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> Conv_SAngularVelocityArrayToSDimensionlessVectorArray_K2(const TArray<FSAngularVelocity>& value);
+    static constexpr ANSICHAR Conv_SAngularVelocityArrayToSDimensionlessVectorArray[] = "Conv_SAngularVelocityArrayToSDimensionlessVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSStateVector> Conv_SDimensionlessStateVectorArrayToSStateVectorArray_K2(const TArray<FSDimensionlessStateVector>& value);
+    static constexpr ANSICHAR Conv_SDimensionlessStateVectorArrayToSStateVectorArray[] = "Conv_SDimensionlessStateVectorArrayToSStateVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessStateVector> Conv_SStateVectorArrayToSDimensionlessStateVectorArray_K2(const TArray<FSStateVector>& value);
+    static constexpr ANSICHAR Conv_SStateVectorArrayToSDimensionlessStateVectorArray[] = "Conv_SStateVectorArrayToSDimensionlessStateVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDistance> Conv_DoubleArrayToSDistanceArray_K2(const TArray<double>& value);
+    static constexpr ANSICHAR Conv_DoubleArrayToSDistanceArray[] = "Conv_DoubleArrayToSDistanceArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSSpeed> Conv_DoubleArrayToSSpeedArray_K2(const TArray<double>& value);
+    static constexpr ANSICHAR Conv_DoubleArrayToSSpeedArray[] = "Conv_DoubleArrayToSSpeedArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSAngularRate> Conv_DoubleArrayToSAngularRateArray_K2(const TArray<double>& value);
+    static constexpr ANSICHAR Conv_DoubleArrayToSAngularRateArray[] = "Conv_DoubleArrayToSAngularRateArray_K2";
+
     static constexpr TCHAR conv_input[] = TEXT("value");
+
+    // MaxQ Expression support
+    // Program is a MaxQ::Math::FExpression program string.  The operands, then
+    // the result, are variadic pins, evaluated in place without conversions.
+    // Returns false if the program doesn't compile.
+    UFUNCTION(BlueprintPure, CustomThunk, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (Variadic))
+    static bool expression_K2(FName Program);
+    DECLARE_FUNCTION(execexpression_K2);
+    static constexpr TCHAR expression[] = TEXT("expression_K2");
+    static constexpr TCHAR expression_program[] = TEXT("Program");
 };
@@ -0,0 +1,109 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelCatalog.h
+//
+// API Comments
+//
+// Purpose:  What kernels a directory holds, and what order to load them in
+//
+// Scan() types every file in a directory from its header (see
+// SpiceKernelInspector.h), in parallel, and catalogs each kernel's size,
+// modification time, content hash and per-id coverage.  The catalog persists
+// in a cache file (Saved/MaxQ/KernelCatalog.bin by default), so on the next
+// launch, files with the same size & modification time aren't read again.
+//
+// Files are furnsh'd in the order the catalog returns them:  leapseconds,
+// then planetary constants (text & binary), frames, spacecraft clocks,
+// instrument kernels, text kernels without a KPL/ line, ephemerides,
+// pointing, shape models, events, and meta-kernels last.  Within a type, in
+// path order, so later files take precedence, as NAIF's versioned file names
+// intend.  MaxQ::Data's
+// FurnshDirectory loads in this order.
+//
+// Coverage is in TDB seconds past J2000, except CK, which is encoded SCLK.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelCatalog.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+
+namespace MaxQ::Catalog
+{
+    struct FCoverage
+    {
+        int32 Id = 0;                       // SPK target, CK instrument, PCK frame class id, DSK body
+        TArray<FSWindowSegment> Windows;
+    };
+
+    struct FCatalogEntry
+    {
+        FString Path;                       // Absolute
+        FString FileType;                   // LSK, PCK, FK, SCLK, IK, SPK, CK, DSK, EK, MK...
+        bool bBinary = false;
+        int64 FileSize = 0;
+        FDateTime Timestamp;                // Last modified
+        uint64 ContentHash = 0;             // xxHash64 of the whole file
+        TArray<FCoverage> Coverage;         // Binary kernels
+        FString Error;                      // If it looks like a kernel, but couldn't be decoded
+        bool bFromCache = false;            // Unchanged since it was last validated
+
+        bool IsValid() const { return Error.IsEmpty(); }
+    };
+
+    struct FCatalogSettings
+    {
+        bool bRecursive = true;
+        bool bPersistent = true;            // Read & update the cache file
+        FString CacheFile;                  // Empty => Saved/MaxQ/KernelCatalog.bin
+        bool bVerifyHashes = false;         // Re-hash unchanged files, rather than trusting size & time
+    };
+
+    struct FCatalogStats
+    {
+        int32 Files = 0;                    // In the directory
+        int32 Kernels = 0;                  // ...that are kernels
+        int32 Validated = 0;                // Read this scan
+        int32 CacheHits = 0;                // Not read again
+        int32 Failures = 0;
+        double Seconds = 0.;
+    };
+
+    // Where the file type goes in the load order, lowest first.  Unknown
+    // types go after EK, before MK.
+    SPICE_API int32 LoadRank(const FString& FileType);
+
+    // Any thread.  Catalogs the kernels in relativeDirectory (relative to
+    // /Content, or absolute), in load order.  Files that aren't kernels are
+    // left out, kernels that can't be decoded are returned with an Error.
+    // False if the directory doesn't exist.
+    SPICE_API bool Scan(
+        const FString& relativeDirectory,
+        TArray<FCatalogEntry>& Entries,
+        const FCatalogSettings& Settings = FCatalogSettings(),
+        FCatalogStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // The valid entries' paths, in load order
+    SPICE_API TArray<FString> LoadOrder(const TArray<FCatalogEntry>& Entries);
+
+    // Forgets every cataloged file, so the next scan reads them all again.
+    // bDeleteFile also deletes the settings' cache file.
+    SPICE_API void ClearCache(const FCatalogSettings& Settings = FCatalogSettings(), bool bDeleteFile = true);
+}
@@ -0,0 +1,141 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelInspector.h
+//
+// API Comments
+//
+// Purpose:  What's in a kernel file, without loading it
+//
+// spkobj/spkcov, ckobj/ckcov, pckfrm/pckcov and dskobj open the file through
+// CSPICE's DAF/DAS handle manager, so they're game thread only, and
+// timout/bodc2n need kernels in the pool.  The inspector reads the file
+// itself, memory-mapped:  the file record, the comment area and every
+// segment summary (DAF) or DSK segment descriptor (DAS/DLA).  It never calls
+// CSPICE, so it's safe from any thread, and InspectDirectory inspects a whole
+// directory tree in parallel.
+//
+// Binary kernels in either byte order (LTL-IEEE, BIG-IEEE) are decoded.  Text
+// kernels are recognized by their KPL/ line, and only typed.  Those without
+// one are recognized by a \begindata or \begintext line, and typed "TEXT".
+// Other files are left out of directory scans.
+//
+// Ids are NAIF integer codes.  Times are TDB seconds past J2000, except CK
+// times, which are encoded SCLK (ticks):  converting those needs the
+// spacecraft clock kernel.  FormatTdb formats an ET as a TDB calendar
+// string, which doesn't need a leapseconds kernel.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelInspector.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+
+namespace MaxQ::Inspector
+{
+    enum class EKernelArchitecture : uint8
+    {
+        Unknown,
+        DAF,
+        DAS,
+        Text
+    };
+
+    struct FSegmentSummary
+    {
+        FString Name;                   // DAF segment name (SPK/CK/PCK segment id)
+        int32 Id = 0;                   // SPK target, CK instrument, PCK frame class id, DSK body
+        int32 Center = 0;               // SPK center
+        int32 Surface = 0;              // DSK surface
+        int32 Frame = 0;                // Reference frame id (PCK:  the inertial frame)
+        int32 DataType = 0;             // SPK/CK/PCK/DSK data type
+        bool bAngularVelocity = false;  // CK
+        double Begin = 0.;              // ET, or encoded SCLK for CK
+        double End = 0.;
+        int32 BeginAddress = 0;         // DAF double precision addresses of the segment's data
+        int32 EndAddress = 0;
+
+        // The raw summary:  ND doubles & NI integers (DAF), or the DSK
+        // descriptor (DAS)
+        TArray<double> Doubles;
+        TArray<int32> Integers;
+    };
+
+    struct FKernelSummary
+    {
+        FString Path;
+        int64 FileSize = 0;
+        EKernelArchitecture Architecture = EKernelArchitecture::Unknown;
+        FString FileType;               // SPK, CK, PCK, DSK, EK, LSK, FK, IK, SCLK, MK, TEXT...
+        FString IdWord;                 // "DAF/SPK", "KPL/LSK"
+        FString InternalName;
+        FString BinaryFormat;           // "LTL-IEEE" or "BIG-IEEE"
+        bool bFtpValid = true;          // False if the FTP test string was mangled by an ASCII transfer
+        int32 ND = 0;                   // DAF summary format
+        int32 NI = 0;
+        uint64 ContentHash = 0;         // xxHash64 of the file, if requested
+        FString Comments;               // Lines separated by '\n'
+        TArray<FSegmentSummary> Segments;
+    };
+
+    struct FInspectSettings
+    {
+        bool bComments = true;
+        bool bSegments = true;
+        bool bContentHash = false;      // Hash every byte, not just the headers & summaries
+        int32 MaxSegments = 1 << 20;    // Per file, in case of a summary record loop
+    };
+
+    // Any thread.  Path is absolute, or relative to /Content.  On error,
+    // Summary.IdWord is empty if the file isn't a kernel at all.
+    SPICE_API void InspectKernel(
+        const FString& Path,
+        FKernelSummary& Summary,
+        const FInspectSettings& Settings = FInspectSettings(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Any thread.  Inspects every kernel file under Directory, in parallel,
+    // and returns them sorted by path.  Files that aren't kernels, or can't be
+    // decoded, are left out; Failures gets one "path: reason" per file that
+    // looked like a kernel but couldn't be decoded.
+    SPICE_API void InspectDirectory(
+        const FString& Directory,
+        TArray<FKernelSummary>& Summaries,
+        bool bRecursive = true,
+        const FInspectSettings& Settings = FInspectSettings(),
+        TArray<FString>* Failures = nullptr
+    );
+
+    // Every id with a segment (spkobj, ckobj, pckfrm, dskobj), sorted
+    SPICE_API TArray<int32> GetIds(const FKernelSummary& Summary);
+
+    // Merged, sorted coverage of the id's segments (spkcov, ckcov at segment
+    // granularity, pckcov)
+    SPICE_API TArray<FSWindowSegment> GetCoverage(const FKernelSummary& Summary, int32 Id);
+
+    // "YYYY MON DD HR:MN:SC.### (TDB)", like timout_c with a ::TDB picture:
+    // Gregorian calendar, seconds truncated to Decimals (at most 6)
+    SPICE_API FString FormatTdb(double et, int32 Decimals = 3);
+
+    // Names of the built-in inertial frames (J2000, ECLIPJ2000...), otherwise
+    // the id
+    SPICE_API FString FrameName(int32 FrameId);
+
+    // A human-readable listing:  the file record, then coverage per id
+    SPICE_API FString Report(const FKernelSummary& Summary, bool bComments = false, bool bSegments = false);
+}
@@ -0,0 +1,105 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelManager.h
+//
+// API Comments
+//
+// Purpose:  Load more binary kernels than CSPICE can hold open
+//
+// CSPICE loads at most 5,000 DAF/DAS files (zzddhman's FTSIZE) and 5,300
+// kernels in all (keeper), and every loaded file is searched.  Mission
+// archives, thousands of CK files of pointing history for instance, don't
+// fit.
+//
+// Managed kernels are registered rather than loaded.  Registering reads the
+// file's segment summaries once (id, time span) and keeps them resident, for
+// any number of files.  Require() then loads (furnsh) whichever registered
+// files cover an id at a time, evicting the least recently required ones
+// (unload) to keep at most MaxLoadedKernels loaded.  The budget defaults to
+// what's left of CSPICE's DAF table and the process's open file limit.
+//
+// Each Require() also prefetches the files covering the same id a horizon
+// further along in the direction time has been moving.
+//
+// Precedence among managed kernels follows registration order, as if they'd
+// all been loaded:  when a file is loaded, any loaded managed file registered
+// after it with an id in common is reloaded behind it.
+//
+// Only SPK, CK and binary PCK files can be managed.  Times are TDB seconds
+// past J2000 for SPK/PCK, and encoded SCLK for CK (see MaxQ::Segments).
+// Game thread only.  Console:  MaxQ.Spice.Kernels.Stats
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelManager.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceCoverage.h"
+
+namespace MaxQ::KernelManager
+{
+    using MaxQ::Coverage::EKernelKind;
+
+    struct FSettings
+    {
+        // 0 => the automatic budget (see above)
+        int32 MaxLoadedKernels = 0;
+
+        // How far ahead Require() prefetches, 0 to disable
+        double PrefetchSeconds = 86400.;    // SPK, PCK
+        double PrefetchTicks = 0.;          // CK (clock dependent)
+    };
+
+    struct FStats
+    {
+        int32 Registered = 0;
+        int32 Loaded = 0;
+        int32 MaxLoaded = 0;        // The budget in effect
+        int64 Requests = 0;
+        int64 Hits = 0;             // Requests needing no load
+        int64 Misses = 0;
+        int64 Loads = 0;
+        int64 Reloads = 0;          // To restore precedence
+        int64 Evictions = 0;
+        int64 Prefetches = 0;
+        int64 PrefetchHits = 0;     // Prefetched files later required
+
+        double HitRate() const { return Requests > 0 ? (double)Hits / Requests : 0.; }
+    };
+
+    SPICE_API void Configure(const FSettings& Settings);
+    SPICE_API FSettings GetSettings();
+
+    // Reads the kernel's segment summaries without loading it
+    SPICE_API bool Register(const FString& relativePath, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+    SPICE_API bool Register(const TArray<FString>& relativePaths, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+    SPICE_API bool RegisterDirectory(const FString& relativeDirectory, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+    // Unloads the kernel if it's loaded
+    SPICE_API void Unregister(const FString& relativePath);
+    SPICE_API void UnregisterAll();
+
+    // Loads every registered kernel covering the id at Time.  False if none do.
+    SPICE_API bool Require(EKernelKind Kind, int32 Id, double Time, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+    SPICE_API bool Require(const FName& Body, const FSEphemerisTime& et, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+    // Does any registered kernel cover the id at Time?  (Loaded or not.)
+    SPICE_API bool IsAvailable(EKernelKind Kind, int32 Id, double Time);
+
+    SPICE_API FStats GetStats();
+    SPICE_API void ResetStats();
+}
@@ -0,0 +1,150 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLambert.h
+//
+// API Comments
+//
+// Purpose:  Lambert's problem (Izzo's algorithm), and porkchop plots of
+// departure/arrival date grids
+//
+// Solve() finds the conics from r1 to r2 in a time of flight:  the direct
+// (zero revolution) transfer, and for each N up to MaxRevolutions that the
+// time of flight allows, N-revolution transfers on both branches.  It's pure
+// math, any thread.
+//
+// A porkchop is a Width x Height grid:  departure times across, arrival
+// times down.  SolveGrid() takes the departure & arrival bodies' states,
+// one per column & one per row, from any source (spkezr, the propagator's
+// dense output, a cache) and solves every cell in parallel.  MakePorkchop()
+// samples them with spkezr first, Width + Height calls in all, on the game
+// thread.
+//
+// Each cell keeps its lowest total v-infinity (departure + arrival) transfer.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLambert.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+
+namespace MaxQ::Lambert
+{
+    struct FLambertSolution
+    {
+        FVector3d V1 = FVector3d::ZeroVector;       // km/s, at r1
+        FVector3d V2 = FVector3d::ZeroVector;       // km/s, at r2
+        int32 Revolutions = 0;
+        bool bLeftBranch = false;                   // Multi-revolution:  Izzo's left branch (x below the minimum time's)
+        int32 Iterations = 0;
+    };
+
+    // Any thread.  Transfers from r1 to r2 (km) in tof seconds about a
+    // center of gm (km^3/s^2).  Prograde is counterclockwise about the
+    // frame's z axis (bRetrograde: clockwise).  Solutions are the direct
+    // transfer, then a pair (left, right) per revolution.  Fails if tof or
+    // gm isn't positive, or r1 & r2 are collinear with the center (the
+    // transfer plane is undefined).
+    SPICE_API bool Solve(
+        TArray<FLambertSolution>& Solutions,
+        const FVector3d& r1,
+        const FVector3d& r2,
+        double tof,
+        double gm,
+        bool bRetrograde = false,
+        int32 MaxRevolutions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    struct FPorkchopSettings
+    {
+        bool bRetrograde = false;
+        int32 MaxRevolutions = 0;
+        int32 RowsPerTask = 8;
+    };
+
+    struct FPorkchopStats
+    {
+        int64 Cells = 0;
+        int64 Solved = 0;                           // Cells with a transfer
+        int64 Iterations = 0;                       // Householder, summed over solutions
+        double Seconds = 0.;
+    };
+
+    // Row major:  Index(Departure, Arrival) = Arrival * Width + Departure.
+    // Unsolved cells (arrival before departure, collinear) are zero, with
+    // Solved 0.
+    struct SPICE_API FPorkchop
+    {
+        int32 Width = 0;
+        int32 Height = 0;
+        TArray<double> DepartureTimes;              // ET, per column
+        TArray<double> ArrivalTimes;                // ET, per row
+
+        TArray<double> C3;                          // km^2/s^2, departure v-infinity squared
+        TArray<double> ArrivalVInfinity;            // km/s
+        TArray<double> TimeOfFlight;                // s
+        TArray<uint8> Revolutions;
+        TArray<uint8> Solved;
+
+        int32 Num() const { return Width * Height; }
+        int32 Index(int32 Departure, int32 Arrival) const { return Arrival * Width + Departure; }
+
+        // A float RGBA image, for a data texture:
+        //   X: C3, Y: arrival v-infinity, Z: time of flight (days)
+        //   W: 1 if solved, else 0
+        void ToTexels(TArray<FVector4f>& Texels) const;
+    };
+
+    // Any thread.  States are relative to the center (of gm), in an inertial
+    // frame, one per departure & arrival time.
+    SPICE_API bool SolveGrid(
+        FPorkchop& Porkchop,
+        const TArray<double>& DepartureTimes,
+        const FSStateVectorBuffer& DepartureStates,
+        const TArray<double>& ArrivalTimes,
+        const FSStateVectorBuffer& ArrivalStates,
+        double gm,
+        const FPorkchopSettings& Settings = FPorkchopSettings(),
+        FPorkchopStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Game thread.  Width departure times evenly spaced from DepartureFirst
+    // to DepartureLast, Height arrival times likewise.  The bodies' states
+    // (spkezr, geometric) and the center's GM (bodvrd) come from the kernel
+    // pool.
+    SPICE_API bool MakePorkchop(
+        FPorkchop& Porkchop,
+        const FName& departure,
+        const FName& arrival,
+        const FName& center,
+        const FName& frame,
+        const FSEphemerisTime& DepartureFirst,
+        const FSEphemerisTime& DepartureLast,
+        int32 Width,
+        const FSEphemerisTime& ArrivalFirst,
+        const FSEphemerisTime& ArrivalLast,
+        int32 Height,
+        const FPorkchopSettings& Settings = FPorkchopSettings(),
+        FPorkchopStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -560,6 +560,36 @@ namespace MaxQ::Math
     SPICE_API double normalizeZeroToTwoPi(double radians);
     SPICE_API double normalizePiToPi(double radians);
 
+    /*
+    *
+    * Batch operations (FSStateVectorBuffer)
+    * One operation applied across every state in a structure-of-arrays buffer.
+    * The output buffer may be the same buffer as the input.
+    *
+    */
+
+    // m * state, for each state
+    SPICE_API void MxV(FSStateVectorBuffer& vout, const FSStateTransform& m, const FSStateVectorBuffer& vin);
+    // m * r, m * v, for each state (non-rotating frames)
+    SPICE_API void MxV(FSStateVectorBuffer& vout, const FSRotationMatrix& m, const FSStateVectorBuffer& vin);
+    // m_transpose * r, m_transpose * v, for each state
+    SPICE_API void MTxV(FSStateVectorBuffer& vout, const FSRotationMatrix& m, const FSStateVectorBuffer& vin);
+
+    // state + offset, for each state (e.g., re-centering on a new observer)
+    SPICE_API void Vadd(FSStateVectorBuffer& vsum, const FSStateVectorBuffer& v1, const FSStateVector& v2);
+    // state - offset, for each state
+    SPICE_API void Vsub(FSStateVectorBuffer& vdifference, const FSStateVectorBuffer& v1, const FSStateVector& v2);
+
+    // Two-body propagation of each state by dt.  On failure pvprop is zeroed.
+    SPICE_API void Prop2b(
+        FSStateVectorBuffer& pvprop,
+        const FSMassConstant& gm,
+        const FSStateVectorBuffer& pvinit,
+        const FSEphemerisPeriod& dt,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
     /*
     *
     * Swizzling Conversions
@@ -661,6 +691,12 @@ namespace MaxQ::Math
         return FSQuaternion::ENG(value.W, value.Y, value.X, value.Z);
     }
 
+    // Batch...
+    // --------------
+    // From SPICE to UE (positions and velocities of each state)
+    SPICE_API void SwizzlePositions(TArray<FVector>& positions, const FSStateVectorBuffer& states);
+    SPICE_API void SwizzleVelocities(TArray<FVector>& velocities, const FSStateVectorBuffer& states);
+
     SPICE_API double normalize0to360(double degrees);
     SPICE_API double normalize180to180(double degrees);
     SPICE_API double normalizeZeroToTwoPi(double radians);
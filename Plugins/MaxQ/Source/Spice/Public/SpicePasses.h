@@ -0,0 +1,191 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePasses.h
+//
+// API Comments
+//
+// Purpose:  Ground station pass prediction (rise, culmination & set) for
+// large satellite catalogs (gfposc)
+//
+// gfposc finds one satellite's passes over one station:  a search, with an
+// SPK lookup per step, per satellite, per station.  Predict() searches a
+// whole catalog over any number of stations, coarse to fine:
+//
+//   screen   every satellite's elevation & elevation rate at every sample
+//            of the catalog's time grid, from every station.  Loops over
+//            structure-of-arrays states, no CSPICE.
+//   refine   only the grid intervals where the elevation crosses the
+//            station's minimum, or peaks:  rises & sets are roots of the
+//            elevation, culminations roots of its rate (Brent's method),
+//            with the satellite's state interpolated between samples
+//            (cubic Hermite).
+//
+// Satellites are screened in blocks, one ParallelFor task per block, so
+// Predict() runs on any thread.
+//
+// The catalog holds the satellites' states relative to the body, in its
+// body-fixed frame, on a uniform time grid.  SampleCatalog() fills it from
+// the kernel pool (spkezr, game thread), SampleTrajectories() from the
+// propagator's dense output (one sxform per sample), or fill it from any
+// source.
+//
+// Elevation is above the plane normal to the station's local vertical (the
+// ellipsoid's normal, as in a NAIF topocentric frame), without refraction.
+// It's geometric:  no light time or aberration.
+//
+// The grid's step bounds what's found:  an interval is searched for at most
+// one culmination, so the step should be a fraction of the shortest pass.
+// Passes that cross the window's ends are clipped to them, as gfposc clips
+// to its confinement window.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePasses.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+#include "SpicePropagator.h"
+
+namespace MaxQ::Passes
+{
+    struct FGroundStation
+    {
+        FName Name;
+        FVector3d Position = FVector3d::ZeroVector; // km, body-fixed
+        FVector3d Up = FVector3d::ZAxisVector;      // Unit, the ellipsoid's normal
+        double MinElevation = 0.;                   // Radians
+    };
+
+    // Game thread.  A station at geodetic coordinates (georec) on body's
+    // reference ellipsoid (bodvrd RADII).
+    SPICE_API bool MakeStation(
+        FGroundStation& Station,
+        const FName& name,
+        const FName& body,
+        const FSGeodeticVector& location,
+        const FSAngle& MinElevation,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Same, at planetographic coordinates (pgrrec)
+    SPICE_API bool MakeStation(
+        FGroundStation& Station,
+        const FName& name,
+        const FName& body,
+        const FSPlanetographicVector& location,
+        const FSAngle& MinElevation,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Satellites' states relative to the body, in its body-fixed frame, at
+    // Start + k * Step (k < Samples.Num()).  Samples[k] holds every
+    // satellite at the k'th time.
+    struct SPICE_API FSatelliteCatalog
+    {
+        FName Body;
+        FName Frame;
+        TArray<FName> Names;                        // Optional
+        double Start = 0.;                          // ET
+        double Step = 0.;                           // s
+        TArray<FSStateVectorBuffer> Samples;
+
+        int32 Num() const { return Samples.Num() ? Samples[0].Num() : 0; }
+        int32 Times() const { return Samples.Num(); }
+        double First() const { return Start; }
+        double Last() const { return Start + Step * FMath::Max(Samples.Num() - 1, 0); }
+
+        // Sizes the grid for Satellites, from First, Times samples Step apart
+        void Init(int32 Satellites, double First, double Step, int32 Times);
+
+        // Any thread.  Cubic Hermite between the samples, et clamped to
+        // [First, Last].
+        void Evaluate(int32 Satellite, double et, double(&State)[6]) const;
+    };
+
+    // Game thread.  Samples satellites relative to body, in frame (NAME_None:
+    // the body's, from cnmfrm), every Step from First through Last, with
+    // spkezr (geometric).
+    SPICE_API bool SampleCatalog(
+        FSatelliteCatalog& Catalog,
+        const TArray<FName>& satellites,
+        const FName& body,
+        const FName& frame,
+        const FSEphemerisTime& First,
+        const FSEphemerisTime& Last,
+        const FSEphemerisPeriod& Step,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Game thread.  Same, from propagated trajectories (relative to body, in
+    // an inertial frame), rotated to the body-fixed frame.  The trajectories
+    // are evaluated in parallel.
+    SPICE_API bool SampleTrajectories(
+        FSatelliteCatalog& Catalog,
+        const TArray<MaxQ::Propagator::FTrajectory>& Trajectories,
+        const FName& body,
+        const FName& frame,
+        const FSEphemerisTime& First,
+        const FSEphemerisTime& Last,
+        const FSEphemerisPeriod& Step,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    struct FPass
+    {
+        int32 Satellite = INDEX_NONE;               // Catalog index
+        int32 Station = INDEX_NONE;                 // Stations index
+        double Rise = 0.;                           // ET
+        double Set = 0.;                            // ET
+        double Culmination = 0.;                    // ET of the maximum elevation
+        double MaxElevation = 0.;                   // Radians
+        bool bRise = true;                          // False:  already up at the catalog's first time
+        bool bSet = true;                           // False:  still up at its last
+    };
+
+    struct FPassSettings
+    {
+        double Tolerance = 1e-3;                    // s, for rise, set & culmination times
+        int32 MaxIterations = 100;                  // Per root
+        int32 SatellitesPerTask = 256;
+    };
+
+    struct FPassStats
+    {
+        int64 Screened = 0;                         // Samples x satellites x stations
+        int64 Refined = 0;                          // Grid intervals searched for roots
+        int64 Evaluations = 0;                      // Interpolated states, while refining
+        int32 Passes = 0;
+        double Seconds = 0.;
+    };
+
+    // Any thread.  Every pass of every satellite over every station, ordered
+    // by rise time.  The stations must be on the catalog's body, in its
+    // frame.
+    SPICE_API bool Predict(
+        TArray<FPass>& Passes,
+        const FSatelliteCatalog& Catalog,
+        const TArray<FGroundStation>& Stations,
+        const FPassSettings& Settings = FPassSettings(),
+        FPassStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
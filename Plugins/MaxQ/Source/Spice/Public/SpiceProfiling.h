@@ -0,0 +1,195 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceProfiling.h
+//
+// API Comments
+//
+// Purpose:  Where does SPICE time go?
+//
+// Every USpice/MaxQ call into CSPICE opens a MAXQ_SPICE_SCOPE, which feeds:
+// * Unreal Insights:  CPU events on the "MaxQSpice" trace channel
+//   (-trace=cpu,MaxQSpice).  Ephemeris & geometry calls are tagged with
+//   their target/observer/frame in the event name.
+// * Stats:  "stat MaxQSpice" shows per-function inclusive time & call
+//   counts, and per-function errors per frame.
+// * Captures:  while a capture window is open, calls are totaled per
+//   function + target/observer/frame, and can be dumped to CSV, hottest
+//   first.  Console:
+//      MaxQ.Spice.Capture.Start
+//      MaxQ.Spice.Capture.Stop
+//      MaxQ.Spice.Capture.Dump [MaxRows]
+//   Capturing takes a lock per call, so keep windows short.
+//
+// All of it compiles out of Shipping builds (MAXQ_SPICE_PROFILING=0), the
+// capture functions below remain but do nothing.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceProfiling.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+#ifndef MAXQ_SPICE_PROFILING
+#define MAXQ_SPICE_PROFILING !UE_BUILD_SHIPPING
+#endif
+
+#if MAXQ_SPICE_PROFILING
+#include "Trace/Trace.h"
+#include <atomic>
+
+UE_TRACE_CHANNEL_EXTERN(MaxQSpiceChannel, SPICE_API);
+
+DECLARE_STATS_GROUP(TEXT("MaxQ Spice"), STATGROUP_MaxQSpice, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Calls"), STAT_MaxQSpiceCalls, STATGROUP_MaxQSpice, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Errors"), STAT_MaxQSpiceErrors, STATGROUP_MaxQSpice, SPICE_API);
+#endif
+
+namespace MaxQ::Profiling
+{
+    // One row of a capture
+    struct FCallStats
+    {
+        FString Function;
+        FString Target;
+        FString Observer;
+        FString Frame;
+        int64 Calls = 0;
+        int64 Errors = 0;
+        double InclusiveSeconds = 0.;
+    };
+
+    // Opens a capture window, discarding anything captured before
+    SPICE_API void StartCapture();
+    SPICE_API void StopCapture();
+    SPICE_API bool IsCapturing();
+
+    // Rows captured so far, by inclusive time, hottest first
+    SPICE_API TArray<FCallStats> GetCapture();
+
+    // The same, as CSV.  MaxRows <= 0 for all rows.
+    SPICE_API FString GetCaptureCsv(int32 MaxRows = 0);
+
+    // Writes GetCaptureCsv to Saved/Profiling/MaxQ; Path receives the file name
+    SPICE_API bool DumpCaptureCsv(FString& Path, int32 MaxRows = 0);
+
+#if MAXQ_SPICE_PROFILING
+    // Used by the MAXQ_SPICE_SCOPE macros.  One static instance per function.
+    class SPICE_API FCallSite
+    {
+    public:
+        explicit FCallSite(const TCHAR* Name);
+
+        uint32 GetTraceSpecId();
+
+        const TCHAR* const Name;
+#if STATS
+        TStatId StatId;
+        FName ErrorsStatName;
+#endif
+
+    private:
+        std::atomic<uint32> TraceSpecId { 0 };
+    };
+
+    inline FString TagString(const FString& Tag) { return Tag; }
+    inline FString TagString(const FName& Tag) { return Tag.ToString(); }
+    inline FString TagString(const TCHAR* Tag) { return Tag ? FString(Tag) : FString(); }
+    inline FString TagString(const ANSICHAR* Tag) { return Tag ? FString(ANSI_TO_TCHAR(Tag)) : FString(); }
+    inline FString TagString(int32 Tag) { return FString::FromInt(Tag); }
+    inline FString TagString(std::nullptr_t) { return FString(); }
+
+    class SPICE_API FCallScope
+    {
+    public:
+        explicit FCallScope(FCallSite& InSite)
+            : Site(InSite)
+#if STATS
+            , CycleCounter(InSite.StatId)
+#endif
+        {
+            Begin();
+        }
+
+        template<typename TargetType, typename ObserverType, typename FrameType>
+        FCallScope(FCallSite& InSite, const TargetType& InTarget, const ObserverType& InObserver, const FrameType& InFrame)
+            : Site(InSite)
+#if STATS
+            , CycleCounter(InSite.StatId)
+#endif
+        {
+            // Tags cost a string conversion, only pay for it if someone's looking
+            if (WantsTags())
+            {
+                Target = TagString(InTarget);
+                Observer = TagString(InObserver);
+                Frame = TagString(InFrame);
+            }
+            Begin();
+        }
+
+        ~FCallScope()
+        {
+            End();
+        }
+
+        FCallScope(const FCallScope&) = delete;
+        FCallScope& operator=(const FCallScope&) = delete;
+
+        // Marks the innermost scope on this thread as failed (called by the
+        // error checks when CSPICE signals an error).
+        static void NoteError();
+
+    private:
+        static bool WantsTags();
+        void Begin();
+        void End();
+
+        FCallSite& Site;
+#if STATS
+        FScopeCycleCounter CycleCounter;
+#endif
+        FString Target;
+        FString Observer;
+        FString Frame;
+        FCallScope* OuterScope = nullptr;
+        uint64 StartCycles = 0;
+        bool bTraced = false;
+        bool bFailed = false;
+    };
+#endif
+}
+
+#if MAXQ_SPICE_PROFILING
+
+// Usage, first line of a function body:
+//    MAXQ_SPICE_SCOPE(USpice::pxform);
+//    MAXQ_SPICE_SCOPE_TAGGED(USpice::spkezr, targ, obs, ref);
+// Tags may be FString, FName, TCHAR*, ANSICHAR*, int32, or nullptr if not applicable.
+#define MAXQ_SPICE_SCOPE(Name) \
+    static MaxQ::Profiling::FCallSite PREPROCESSOR_JOIN(MaxQSpiceCallSite_, __LINE__)(TEXT(#Name)); \
+    MaxQ::Profiling::FCallScope PREPROCESSOR_JOIN(MaxQSpiceCallScope_, __LINE__)(PREPROCESSOR_JOIN(MaxQSpiceCallSite_, __LINE__))
+
+#define MAXQ_SPICE_SCOPE_TAGGED(Name, Target, Observer, Frame) \
+    static MaxQ::Profiling::FCallSite PREPROCESSOR_JOIN(MaxQSpiceCallSite_, __LINE__)(TEXT(#Name)); \
+    MaxQ::Profiling::FCallScope PREPROCESSOR_JOIN(MaxQSpiceCallScope_, __LINE__)(PREPROCESSOR_JOIN(MaxQSpiceCallSite_, __LINE__), Target, Observer, Frame)
+
+#else
+
+#define MAXQ_SPICE_SCOPE(Name)
+#define MAXQ_SPICE_SCOPE_TAGGED(Name, Target, Observer, Frame)
+
+#endif
@@ -0,0 +1,270 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePropagator.h
+//
+// API Comments
+//
+// Purpose:  Numerical propagation of spacecraft under perturbations
+// (beyond prop2b, evsgp4)
+//
+// prop2b and USpiceOrbits propagate conics:  the center's point mass, and
+// nothing else.  FPropagator integrates
+//
+//   central gravity     the center's GM
+//   zonal harmonics     J2, J3, J4 (the center's bodvrd J2..J4), about the
+//                       pole of its body-fixed frame
+//   third bodies        point masses, e.g. the moon & sun
+//   drag                exponential atmosphere, co-rotating with the center
+//   solar pressure      cannonball, in the center's cylindrical shadow
+//                       (with a penumbra)
+//
+// State vectors are relative to the model's center, in its (inertial)
+// frame.  Create() caches what CSPICE knows, on the game thread:  GMs and
+// harmonics, the third bodies' states on a grid across the propagation
+// window, and the center's pole & spin.  Propagate() uses only the cache
+// (cubic Hermite between the grid's states), so it runs on any thread.
+//
+// Integrators:
+//   DOP853      Dormand & Prince's adaptive RK8(7), with its 7th order dense
+//               output.  The default.
+//   Symplectic  Fixed-step 4th order Forest-Ruth (drift-kick), quintic
+//               Hermite dense output.  Conserves energy over long, two-body
+//               and zonal arcs.  Drag depends on velocity, so with drag it's
+//               neither symplectic nor 4th order.
+//
+// Shadow crossings (solar pressure) aren't located, so near them DOP853's
+// accuracy depends on MaxStep.
+//
+// Batches of spacecraft are propagated in blocks of BlockSize, one
+// ParallelFor task per block.  A block's spacecraft share steps (DOP853's
+// step follows its least accurate spacecraft), so the third bodies are
+// evaluated once per stage per block and the per-spacecraft work is loops
+// over structure-of-arrays states.  Similar orbits should share blocks.
+//
+// Propagating with Trajectories returns each spacecraft's dense output,
+// which evaluates at any time in the arc, and WriteSpk fits it to Chebyshev
+// SPK segments (SpiceCompression.h).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePropagator.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+#include "SpiceCompression.h"
+
+namespace MaxQ::Propagator
+{
+    enum class EIntegrator : uint8
+    {
+        DOP853,
+        Symplectic
+    };
+
+    // Density = Density * exp(-(altitude - Altitude) / ScaleHeight), from
+    // Altitude up to the next band
+    struct FDensityBand
+    {
+        double Altitude = 0.;                       // km
+        double Density = 0.;                        // kg/m^3
+        double ScaleHeight = 1.;                    // km
+    };
+
+    // Earth's exponential atmosphere, 0 to 1000 km (Vallado, Fundamentals of
+    // Astrodynamics and Applications, table 8-4)
+    SPICE_API TArray<FDensityBand> EarthAtmosphere();
+
+    struct FForceModel
+    {
+        FName Center = FName(TEXT("EARTH"));
+        FName Frame = FName(TEXT("J2000"));         // Inertial
+        TArray<FName> Perturbers;                   // Third-body point masses
+        int32 MaxZonalDegree = 0;                   // 0 (none), or 2..4
+
+        bool bDrag = false;
+        TArray<FDensityBand> Atmosphere;            // Ascending altitudes.  Empty => EarthAtmosphere()
+
+        bool bSolarRadiationPressure = false;
+        FName Sun = FName(TEXT("SUN"));
+        double SolarPressure = 4.56e-6;             // N/m^2 at 1 AU
+        bool bShadow = true;                        // The center's cylindrical shadow
+
+        double EphemerisStep = 3600.;               // s, between cached third-body states
+    };
+
+    // Structure-of-arrays spacecraft, relative to the model's center, in its
+    // frame
+    struct FSpacecraftBatch
+    {
+        FSStateVectorBuffer States;
+        TArray<double> DragCoefficient;             // Cd * A / m, m^2/kg
+        TArray<double> SolarCoefficient;            // Cr * A / m, m^2/kg
+
+        int32 Num() const { return States.Num(); }
+
+        int32 Add(const FSStateVector& State, double Drag = 0., double Solar = 0.)
+        {
+            DragCoefficient.Add(Drag);
+            SolarCoefficient.Add(Solar);
+            return States.Add(State);
+        }
+    };
+
+    struct FIntegratorSettings
+    {
+        EIntegrator Integrator = EIntegrator::DOP853;
+        double RelativeTolerance = 1e-10;           // DOP853
+        double PositionTolerance = 1e-6;            // km, absolute
+        double VelocityTolerance = 1e-9;            // km/s, absolute
+        double InitialStep = 0.;                    // s, 0 => estimated
+        double MaxStep = 0.;                        // s, 0 => unlimited
+        double FixedStep = 30.;                     // s, Symplectic (shortened to end on time)
+        int32 MaxSteps = 1000000;                   // Per block
+        int32 BlockSize = 16;                       // Spacecraft sharing steps
+    };
+
+    struct FPropagationStats
+    {
+        int64 Steps = 0;                            // Accepted, summed over blocks
+        int64 RejectedSteps = 0;
+        int64 Evaluations = 0;                      // Accelerations, summed over spacecraft
+        int32 Failures = 0;                         // Spacecraft that didn't reach the end
+        double Seconds = 0.;
+    };
+
+    // One spacecraft's dense output
+    struct SPICE_API FTrajectory
+    {
+        EIntegrator Integrator = EIntegrator::DOP853;
+        FName Center;
+        FName Frame;
+        TArray<double> Times;                       // Step boundaries, in the direction of propagation
+        TArray<double> Coefficients;                // Per step (DOP853), or per time (Symplectic)
+
+        double First() const { return Times.Num() ? FMath::Min(Times[0], Times.Last()) : 0.; }
+        double Last() const { return Times.Num() ? FMath::Max(Times[0], Times.Last()) : 0.; }
+
+        // Any thread.  et is clamped to [First, Last].
+        void Evaluate(double et, double(&State)[6]) const;
+        FSStateVector Evaluate(const FSEphemerisTime& et) const;
+    };
+
+    class SPICE_API FPropagator
+    {
+    public:
+        // Game thread.  Caches the model for propagation within [First, Last]
+        // (GM, RADII & J2..J4 from bodvrd, the center's body-fixed frame from
+        // cnmfrm).
+        static TSharedPtr<FPropagator> Create(
+            const FForceModel& Model,
+            const FSEphemerisTime& First,
+            const FSEphemerisTime& Last,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Any thread.  Propagates every spacecraft in Batch from et0 to et1
+        // (either direction), in place.  Trajectories, if given, get each
+        // spacecraft's dense output.  A spacecraft that can't reach et1
+        // (step too small, too many steps, non-finite state) is left where
+        // it stopped, and the result is an error.
+        bool Propagate(
+            FSpacecraftBatch& Batch,
+            const FSEphemerisTime& et0,
+            const FSEphemerisTime& et1,
+            const FIntegratorSettings& Settings = FIntegratorSettings(),
+            FPropagationStats* Stats = nullptr,
+            TArray<FTrajectory>* Trajectories = nullptr,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        ) const;
+
+        // Same, for one spacecraft
+        bool Propagate(
+            FSStateVector& State,
+            const FSEphemerisTime& et0,
+            const FSEphemerisTime& et1,
+            const FIntegratorSettings& Settings = FIntegratorSettings(),
+            double Drag = 0.,
+            double Solar = 0.,
+            FTrajectory* Trajectory = nullptr,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        ) const;
+
+        // Any thread.  The modeled acceleration, km/s^2.
+        FVector3d Acceleration(const FSEphemerisTime& et, const FSStateVector& State, double Drag = 0., double Solar = 0.) const;
+
+        const FForceModel& GetModel() const { return Model; }
+        double GetFirst() const { return First; }
+        double GetLast() const { return Last; }
+
+        struct FBody
+        {
+            FName Name;
+            double GM = 0.;
+            bool bGravity = true;                   // A perturber, not just the sun for solar pressure
+            TArray<double> States;                  // 6 per grid time
+        };
+
+        // Ephemeris, at one time
+        struct FEnvironment;
+
+    private:
+        FPropagator() = default;
+
+        friend struct FBlock;
+
+        void Sample(double et, FEnvironment& Environment) const;
+
+        // N spacecraft's derivatives:  Y & F hold x, y, z, dx, dy, dz arrays
+        // of N
+        void Derivatives(const FEnvironment& Environment, int32 N, const double* Y, const double* Drag, const double* Solar, double* F) const;
+
+        FForceModel Model;
+        double First = 0.;
+        double Last = 0.;
+
+        double GM = 0.;
+        double J[5] = {};                           // J[2]..J[4]
+        double ReferenceRadius = 0.;                // km, for the harmonics
+        double EquatorialRadius = 0.;               // km, for altitude & shadow
+        double SunRadius = 0.;                      // km, for the penumbra
+
+        // Grid, from GridStart every GridStep, GridTimes of them
+        double GridStart = 0.;
+        double GridStep = 0.;
+        int32 GridTimes = 0;
+        TArray<FBody> Bodies;
+        int32 SunIndex = INDEX_NONE;
+        TArray<double> Spin;                        // Pole & angular velocity, 6 per grid time
+    };
+
+    // Game thread.  Fits Trajectory to Chebyshev segments and writes them to
+    // an SPK open for writing, relative to the trajectory's center, in its
+    // frame.
+    SPICE_API void WriteSpk(
+        const FTrajectory& Trajectory,
+        int handle,
+        int body,
+        const FString& segid,
+        const MaxQ::Compression::FChebyshevFitSettings& Settings,
+        MaxQ::Compression::FCompressionStats& Stats,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,143 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSegments.h
+//
+// API Comments
+//
+// Purpose:  Which segment of which loaded kernel applies to this id, at this
+// time?
+//
+// CSPICE's segment buffering (spkbsr/ckbsr/pckbsr) keeps fixed size tables
+// (10,000 ids, 100,000 segment descriptors) and linear per-id segment lists
+// that are re-searched file by file when they overflow.  With thousands of
+// small kernels loaded (one SPK per spacecraft, etc) selection degrades
+// badly.
+//
+// The segment index reads each DAF's summaries once, when the file is loaded,
+// into dynamically sized per-id interval trees.  Selection follows CSPICE's
+// precedence:  the last loaded file wins, and within a file the last segment
+// wins.  A query visits O(log n + k) segments (k = segments containing the
+// time), and is safe from any thread.
+//
+// Spkgeo evaluates geometric states by chaining the selected segments
+// (spkpvn_c), bypassing CSPICE's selection entirely.  It calls CSPICE to
+// evaluate segments and rotate frames, so it's game thread only.
+//
+// The index follows furnsh/unload/clear through MaxQ's kernel functions,
+// kernels loaded directly through CSPICE are picked up by the next Refresh().
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSegments.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceCoverage.h"
+
+namespace MaxQ::Segments
+{
+    using MaxQ::Coverage::EKernelKind;
+
+    // One segment of a loaded SPK, CK, or binary PCK
+    struct FSegment
+    {
+        int32 Id = 0;               // SPK: body, CK: instrument, PCK: frame class id
+        int32 Center = 0;           // SPK: center of motion
+        int32 Frame = 0;            // Reference frame id
+        int32 Type = 0;             // Segment data type
+        bool bHasAngularVelocity = false;   // CK only
+        double Start = 0.;          // SPK/PCK: TDB seconds past J2000, CK: encoded SCLK
+        double Stop = 0.;
+        int32 Handle = 0;           // DAF handle
+        double Descriptor[5] = {};  // Packed DAF descriptor (spkpvn_c, ckpfs_c, etc)
+    };
+
+    // Static interval tree over a sorted array (the midpoint of each range is
+    // the root of its subtree), augmented with each subtree's latest stop and
+    // highest priority.
+    class SPICE_API FIntervalTree
+    {
+    public:
+        struct FEntry
+        {
+            double Start = 0.;
+            double Stop = 0.;
+            int64 Priority = 0;
+            int32 Index = 0;        // The caller's payload index
+        };
+
+        FIntervalTree() = default;
+        explicit FIntervalTree(TArray<FEntry>&& InEntries);
+
+        // Index of the highest priority entry containing Time, or INDEX_NONE
+        int32 FindHighestPriority(double Time) const;
+
+        // Indices of every entry containing Time
+        void FindAll(double Time, TArray<int32>& Indices) const;
+
+        int32 Num() const { return Entries.Num(); }
+
+    private:
+        void Build(int32 Lo, int32 Hi);
+        void FindHighestPriority(double Time, int32 Lo, int32 Hi, int32& Best) const;
+        void FindAll(double Time, int32 Lo, int32 Hi, TArray<int32>& Indices) const;
+
+        TArray<FEntry> Entries;
+        TArray<double> MaxStop;
+        TArray<int64> MaxPriority;
+    };
+
+    // Brings the index up to date with the kernels CSPICE has loaded.
+    // Calls CSPICE, so game thread only.  MaxQ's furnsh/unload/clear call it.
+    SPICE_API void Refresh();
+
+    // The segment CSPICE would select for the id at Time (ET for SPK/PCK,
+    // encoded SCLK for CK).  False if no loaded segment contains Time.
+    SPICE_API bool Select(EKernelKind Kind, int32 Id, double Time, FSegment& Segment);
+
+    // Every segment containing Time, highest precedence first
+    SPICE_API bool SelectAll(EKernelKind Kind, int32 Id, double Time, TArray<FSegment>& Segments);
+
+    // Every segment for the id, highest precedence first
+    SPICE_API bool GetSegments(EKernelKind Kind, int32 Id, TArray<FSegment>& Segments);
+
+    // Total segments indexed
+    SPICE_API int32 GetSegmentCount();
+
+    // Geometric state of targ relative to obs (spkgeo_c), chained through the
+    // index's segment selection.  Game thread only.
+    SPICE_API bool Spkgeo(
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        int32 targ,
+        const FSEphemerisTime& et,
+        const FName& ref,
+        int32 obs,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API bool Spkgeo(
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FName& targ,
+        const FSEphemerisTime& et,
+        const FName& ref,
+        const FName& obs,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
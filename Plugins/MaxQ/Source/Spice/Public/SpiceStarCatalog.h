@@ -0,0 +1,200 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStarCatalog.h
+//
+// API Comments
+//
+// Purpose:  Star fields from SPICE type 1 star catalogs (stcl01, stcf01,
+// stcg01), for sky rendering
+//
+// stcf01 is an EK query:  fine for a star tracker's field now & then, far too
+// slow for a sky every frame.  LoadCatalog() reads a whole catalog once (then
+// unloads it), and FStarCatalog indexes it in memory:
+//
+//   cells    an equi-angular cube map, Resolution x Resolution cells per
+//            face.  A cell's edges are great circles, so its extent is the
+//            angle from its center to its farthest corner.
+//   stars    stored cell by cell, brightest first within a cell, so a
+//            magnitude limit ends each cell's scan early.  Directions,
+//            proper motions & magnitudes are structure-of-arrays.
+//
+// Cone() & Frustum() test each cell's bounds, then each bright enough star
+// of each cell that overlaps the query, and return the stars' apparent
+// directions:  proper motion to the query's epoch, then stellar aberration
+// for the observer's velocity (as stelab, in a cell's batch of stars at a
+// time).  Queries are const, and run on any thread.
+//
+// Directions are J2000 (the catalog's frame).  Light time doesn't apply:
+// the stars are at infinity, so there's no parallax either.
+//
+// Type 1 catalogs have no proper motion columns.  If a catalog's table also
+// has RA_PM & DEC_PM (degrees per Julian year, of RA & Dec themselves) and
+// RA_EPOCH & DEC_EPOCH (Julian years), LoadCatalog() reads them too;
+// otherwise the stars are fixed, at J2000.  WriteCatalog() writes stars to a
+// new type 1 catalog, with those columns.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStarCatalog.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+
+namespace MaxQ::Stars
+{
+    // A type 1 catalog's star, at its catalog epochs
+    struct FStar
+    {
+        int32 CatalogNumber = 0;
+        double RA = 0.;                             // Radians, J2000
+        double Dec = 0.;                            // Radians
+        double RaSigma = 0.;                        // Radians
+        double DecSigma = 0.;                       // Radians
+        double RaProperMotion = 0.;                 // Radians per Julian year, of RA (not scaled by cos(Dec))
+        double DecProperMotion = 0.;                // Radians per Julian year
+        double RaEpoch = 0.;                        // ET of RA
+        double DecEpoch = 0.;                       // ET of Dec
+        double Magnitude = 0.;                      // Visual
+        ANSICHAR SpectralType[5] = {};              // e.g. "G2V", blank padded
+
+        FString GetSpectralType() const { return FString(ANSI_TO_TCHAR(SpectralType)).TrimEnd(); }
+    };
+
+    struct FStarCatalogSettings
+    {
+        int32 Resolution = 32;                      // Cells along a cube face's edge
+        double MaxMagnitude = 99.;                  // Fainter stars aren't indexed
+    };
+
+    // What the observer sees:  when, how fast, and how faint
+    struct FStarQuery
+    {
+        double et = 0.;                             // ET, for proper motion
+        FVector3d Velocity = FVector3d::ZeroVector; // km/s, J2000, relative to the solar system barycenter:  stellar aberration
+        double MaxMagnitude = 6.5;
+    };
+
+    struct FStarQueryStats
+    {
+        int32 Cells = 0;                            // Cells overlapping the query
+        int32 Tested = 0;                           // Stars bright enough, in those cells
+        int32 Selected = 0;
+        double Seconds = 0.;
+    };
+
+    // A query's stars, cell by cell, brightest first within a cell
+    struct SPICE_API FStarSelection
+    {
+        typedef TArray<double, TAlignedHeapAllocator<64>> FComponentArray;
+
+        TArray<int32> Stars;                        // FStarCatalog indices
+        FComponentArray X;                          // Apparent direction, J2000 unit vector
+        FComponentArray Y;
+        FComponentArray Z;
+        TArray<float> Magnitude;
+
+        int32 Num() const { return Stars.Num(); }
+        void Reset();
+        void SetNum(int32 Count);
+        FVector3d Direction(int32 Index) const { return FVector3d(X[Index], Y[Index], Z[Index]); }
+    };
+
+    struct SPICE_API FStarCatalog
+    {
+        // Stars in index order:  cell by cell, brightest first within a cell
+        TArray<FStar> Stars;
+
+        int32 Num() const { return Stars.Num(); }
+        int32 GetResolution() const { return Resolution; }
+        int32 Cells() const { return 6 * Resolution * Resolution; }
+
+        // Any thread.  Indexes stars (from LoadCatalog(), or any source)
+        void Build(const TArray<FStar>& stars, const FStarCatalogSettings& Settings = FStarCatalogSettings());
+
+        // Any thread.  Stars within Radius (radians) of Axis (J2000), as
+        // seen by Query's observer.
+        void Cone(FStarSelection& Selection, const FVector3d& Axis, double Radius, const FStarQuery& Query = FStarQuery(), FStarQueryStats* Stats = nullptr) const;
+
+        // Same, centered on RA & Dec (radians, J2000)
+        void Cone(FStarSelection& Selection, double RA, double Dec, double Radius, const FStarQuery& Query = FStarQuery(), FStarQueryStats* Stats = nullptr) const;
+
+        // Any thread.  Stars on the inner side of every plane through the
+        // observer (unit normals, J2000), e.g. a view frustum's four sides
+        // (MakeFrustum()).
+        void Frustum(FStarSelection& Selection, const TArray<FVector3d>& Planes, const FStarQuery& Query = FStarQuery(), FStarQueryStats* Stats = nullptr) const;
+
+        // Any thread.  Apparent directions of the given stars, regardless of
+        // magnitude, in parallel.
+        void Apparent(FStarSelection& Selection, const TArray<int32>& stars, const FStarQuery& Query = FStarQuery()) const;
+
+        // Instance data for a selection:  XYZ the apparent direction, W the
+        // magnitude.  Colors, if given, are the blackbody color of each star's
+        // spectral class (white if it has none).
+        void ToInstances(const FStarSelection& Selection, TArray<FVector4f>& Instances, TArray<FLinearColor>* Colors = nullptr) const;
+
+    private:
+        int32 Resolution = 0;
+        TArray<int32> CellStart;                    // Cells() + 1 offsets into Stars
+        TArray<FVector3d> CellCenter;
+        TArray<double> CellCos;                     // Of the cell's extent
+        TArray<double> CellSin;
+        double MaxCellExtent = 0.;
+
+        // At J2000
+        FStarSelection::FComponentArray X, Y, Z;
+        // Radians per Julian year, tangent to the sky
+        FStarSelection::FComponentArray PX, PY, PZ;
+        TArray<float> Magnitude;
+        TArray<float> Temperature;                  // K, 0 if unknown
+        double MaxProperMotion = 0.;                // Radians per Julian year
+
+        template<class FCellTest, class FStarTest>
+        void Select(FStarSelection& Selection, const FStarQuery& Query, FStarQueryStats* Stats, FCellTest CellTest, FStarTest StarTest) const;
+    };
+
+    // Any thread.  The four side planes of a view frustum looking along
+    // Forward, Up-ish, with half-angles (radians) across & up.
+    SPICE_API void MakeFrustum(TArray<FVector3d>& Planes, const FVector3d& Forward, const FVector3d& Up, double HalfWidth, double HalfHeight);
+
+    // Game thread.  Every star of a type 1 star catalog (stcl01, stcf01 over
+    // the whole sky, stcg01), with proper motions if the table has them.
+    // The catalog is unloaded afterwards.
+    SPICE_API bool LoadCatalog(
+        TArray<FStar>& Stars,
+        const FString& relativePath,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Same, indexed
+    SPICE_API bool LoadCatalog(
+        FStarCatalog& Catalog,
+        const FString& relativePath,
+        const FStarCatalogSettings& Settings = FStarCatalogSettings(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Game thread.  Writes stars to a new type 1 star catalog (replacing
+    // the file, if any), one table, with proper motion columns.
+    SPICE_API bool WriteCatalog(
+        const FString& relativePath,
+        const FString& Table,
+        const TArray<FStar>& Stars,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
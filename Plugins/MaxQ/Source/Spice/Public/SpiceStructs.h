@@ -1124,6 +1124,149 @@ struct SPICE_API FSStateVector
 };
 
 
+// Structure-of-arrays storage for many state vectors.
+// TArray<FSStateVector> is an array of nested structs (FSDistanceVector ->
+// FSDistance{km}), which is fine for a handful of states but awkward for
+// batch math over hundreds/thousands of them.  Here each component is its
+// own contiguous, aligned double array (km, km/sec).
+// The arrays aren't UPROPERTYs (UHT only reflects the default allocator), so
+// Blueprints access the buffer via the USpiceTypes StateVectorBuffer_* nodes.
+USTRUCT(BlueprintType, Category = "MaxQ|StateVectorBuffer", Meta = (ToolTip = "Buffer of rectangular state vectors (X, Y, Z, DX, DY, DZ), stored as structure-of-arrays"))
+struct SPICE_API FSStateVectorBuffer
+{
+    GENERATED_BODY()
+
+    // Cache-line alignment, so batch loops can use aligned vector loads.
+    typedef TArray<double, TAlignedHeapAllocator<64>> FComponentArray;
+
+    FComponentArray x;
+    FComponentArray y;
+    FComponentArray z;
+    FComponentArray dx;
+    FComponentArray dy;
+    FComponentArray dz;
+
+    FSStateVectorBuffer()
+    {
+    }
+
+    explicit FSStateVectorBuffer(int32 Count)
+    {
+        SetNum(Count);
+    }
+
+    explicit FSStateVectorBuffer(const TArray<FSStateVector>& States)
+    {
+        CopyFrom(States);
+    }
+
+    inline int32 Num() const { return x.Num(); }
+    inline bool IsValidIndex(int32 Index) const { return x.IsValidIndex(Index); }
+
+    void SetNum(int32 Count)
+    {
+        x.SetNumZeroed(Count);
+        y.SetNumZeroed(Count);
+        z.SetNumZeroed(Count);
+        dx.SetNumZeroed(Count);
+        dy.SetNumZeroed(Count);
+        dz.SetNumZeroed(Count);
+    }
+
+    void Reserve(int32 Count)
+    {
+        x.Reserve(Count);
+        y.Reserve(Count);
+        z.Reserve(Count);
+        dx.Reserve(Count);
+        dy.Reserve(Count);
+        dz.Reserve(Count);
+    }
+
+    void Empty()
+    {
+        x.Empty();
+        y.Empty();
+        z.Empty();
+        dx.Empty();
+        dy.Empty();
+        dz.Empty();
+    }
+
+    int32 Add(const FSStateVector& State)
+    {
+        x.Add(State.r.x.km);
+        y.Add(State.r.y.km);
+        z.Add(State.r.z.km);
+        dx.Add(State.v.dx.kmps);
+        dy.Add(State.v.dy.kmps);
+        return dz.Add(State.v.dz.kmps);
+    }
+
+    inline FSStateVector Get(int32 Index) const
+    {
+        return FSStateVector(FSDistanceVector(x[Index], y[Index], z[Index]), FSVelocityVector(dx[Index], dy[Index], dz[Index]));
+    }
+
+    inline void Set(int32 Index, const FSStateVector& State)
+    {
+        x[Index] = State.r.x.km;
+        y[Index] = State.r.y.km;
+        z[Index] = State.r.z.km;
+        dx[Index] = State.v.dx.kmps;
+        dy[Index] = State.v.dy.kmps;
+        dz[Index] = State.v.dz.kmps;
+    }
+
+    // CSPICE's state vector layout (double[6])
+    inline void CopyTo(int32 Index, double(&state)[6]) const
+    {
+        state[0] = x[Index];
+        state[1] = y[Index];
+        state[2] = z[Index];
+        state[3] = dx[Index];
+        state[4] = dy[Index];
+        state[5] = dz[Index];
+    }
+
+    inline void CopyFrom(int32 Index, const double(&state)[6])
+    {
+        x[Index] = state[0];
+        y[Index] = state[1];
+        z[Index] = state[2];
+        dx[Index] = state[3];
+        dy[Index] = state[4];
+        dz[Index] = state[5];
+    }
+
+    void CopyFrom(const TArray<FSStateVector>& States);
+    void CopyTo(TArray<FSStateVector>& States) const;
+
+    // CSPICE batch routines take interleaved double[n][6] (or [n][3]) arrays.
+    // Gather/Scatter move one chunk between the buffer and caller-owned scratch
+    // space, so a large batch can go through CSPICE without a full AoS copy.
+    void Gather(int32 Start, int32 Count, double(*states)[6]) const;
+    void Scatter(int32 Start, int32 Count, const double(*states)[6]);
+    void GatherPositions(int32 Start, int32 Count, double(*positions)[3]) const;
+
+    // Zero-copy component views (km, km/sec)
+    inline TArrayView<double> X() { return TArrayView<double>(x.GetData(), x.Num()); }
+    inline TArrayView<double> Y() { return TArrayView<double>(y.GetData(), y.Num()); }
+    inline TArrayView<double> Z() { return TArrayView<double>(z.GetData(), z.Num()); }
+    inline TArrayView<double> DX() { return TArrayView<double>(dx.GetData(), dx.Num()); }
+    inline TArrayView<double> DY() { return TArrayView<double>(dy.GetData(), dy.Num()); }
+    inline TArrayView<double> DZ() { return TArrayView<double>(dz.GetData(), dz.Num()); }
+    inline TArrayView<const double> X() const { return TArrayView<const double>(x.GetData(), x.Num()); }
+    inline TArrayView<const double> Y() const { return TArrayView<const double>(y.GetData(), y.Num()); }
+    inline TArrayView<const double> Z() const { return TArrayView<const double>(z.GetData(), z.Num()); }
+    inline TArrayView<const double> DX() const { return TArrayView<const double>(dx.GetData(), dx.Num()); }
+    inline TArrayView<const double> DY() const { return TArrayView<const double>(dy.GetData(), dy.Num()); }
+    inline TArrayView<const double> DZ() const { return TArrayView<const double>(dz.GetData(), dz.Num()); }
+
+    FString ToString() const;
+};
+
+
 USTRUCT(BlueprintType, Meta = (ToolTip = "Cylindrical coordinates (R, LONG, Z)"))
 struct SPICE_API FSCylindricalVector
 {
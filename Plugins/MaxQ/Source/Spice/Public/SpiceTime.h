@@ -0,0 +1,87 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTime.h
+//
+// API Comments
+//
+// Purpose:  Native, thread-safe UTC <-> ET (TDB) conversion
+//
+// The leapseconds table and TDB constants (DELTET/*) are read from the kernel
+// pool once, into an immutable table, whenever MaxQ loads or unloads kernels.
+// Conversions then run without CSPICE, from any thread.  The arithmetic
+// follows CSPICE's (ttrans/unitim/et2utc) step for step, so results match
+// str2et_c & et2utc_c exactly for the formats handled natively:
+//
+//   Parsing:   ISO-8601 calendar & day-of-year UTC, 1583 through 9999:
+//              "2021-06-01T12:34:56.789", "2021-152T12:34:56", "2021-06-01",
+//              "2021-06-01 12:34", with an optional trailing "Z".
+//              Leap seconds (23:59:60.x) are accepted on leap second days.
+//   Formatting: ES_UTCTimeFormat Calendar, DayOfYear, ISOCalendar and
+//              ISODayOfYear, precision 0 through 13.
+//
+// Str2Et and Et2Utc fall back to CSPICE (str2et_c, et2utc_c) for anything
+// else; the fallback must run on the game thread.  The Try* versions never
+// touch CSPICE.  Like CSPICE, UTC before 1972 is offset from TAI by a
+// constant (no rubber seconds).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTime.h is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Time
+{
+    // Re-read DELTET/* from the kernel pool (CSPICE, game thread only).
+    // MaxQ's furnsh/unload/clear functions call this; call it after changing
+    // the pool any other way (ldpool, pdpool...).
+    // Returns false, & disables the native path, if no leapseconds kernel is loaded.
+    SPICE_API bool RefreshConstants();
+
+    // True if a leapseconds kernel was loaded at the last refresh
+    SPICE_API bool HasConstants();
+
+    // Native only, any thread.  False if the string isn't one of the
+    // supported ISO-8601 forms, or no leapseconds kernel is loaded.
+    SPICE_API bool TryStr2Et(const FString& str, FSEphemerisTime& et);
+
+    // Native only, any thread.  False if the format/precision/year isn't
+    // supported natively, or no leapseconds kernel is loaded.
+    SPICE_API bool TryEt2Utc(const FSEphemerisTime& et, ES_UTCTimeFormat format, int prec, FString& utcstr);
+
+    // UTC (calendar fields) to ET, native only, any thread
+    SPICE_API bool TryUtc2Et(const FDateTime& utc, FSEphemerisTime& et);
+
+    // str2et, natively when possible, else str2et_c (game thread only)
+    SPICE_API FSEphemerisTime Str2Et(
+        const FString& str,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // et2utc, natively when possible, else et2utc_c (game thread only)
+    SPICE_API FString Et2Utc(
+        const FSEphemerisTime& et,
+        ES_UTCTimeFormat format = ES_UTCTimeFormat::ISOCalendar,
+        int prec = 3,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // The current ET, from the system clock, with leap seconds & TDB-TT applied.
+    // Without a leapseconds kernel UTC is used as-is (about 69 seconds off).
+    SPICE_API FSEphemerisTime Now();
+}
@@ -0,0 +1,222 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTrajectoryRecorder.h
+//
+// API Comments
+//
+// Purpose:  Recording live trajectories to SPK files, a segment at a time
+// (spkopn, spkopa, spkw09, spkw13)
+//
+// USpiceTrajectoryRecorder samples its owner's state every tick (or every
+// SampleInterval of ET) and streams it to an SPK file through an
+// FTrajectoryWriter:
+//
+// * Samples go into a fixed-size ring buffer, so memory stays bounded
+//   however long the session runs.  If the ring fills, new samples are
+//   dropped (and counted) rather than growing it.
+// * A background thread drains the ring every FlushSeconds, and seals what
+//   it drained into segment data:  epochs must strictly increase, so
+//   repeated ETs (a paused clock) are skipped, and time running backwards
+//   or jumping ahead by more than MaxGapSeconds starts a new segment.
+//   Consecutive segments share their boundary sample, so coverage has no
+//   gaps.
+// * Sealed segments are written on the game thread (CSPICE isn't thread
+//   safe), each batch by opening the file, writing type 13 or type 9
+//   segments and closing it again.  Between batches the file is closed and
+//   complete, so a crash loses at most the last FlushSeconds of samples.
+//
+// The recorder's ET is the world's UMaxQClockSubsystem's, or, without a
+// clock, StartEt plus the world time elapsed since recording started.
+// Override GetStateToRecord to record something other than the owner's
+// world position (taken as relative to Center, in Frame).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTrajectoryRecorder.h is part of the "refined Blueprints API".
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+#include "SpiceTrajectoryRecorder.generated.h"
+
+namespace MaxQ::Recording
+{
+    class FRecordingThread;
+
+    struct FTrajectoryWriterSettings
+    {
+        FString File;                           // Absolute, or relative to /Content
+        int32 Body = 0;
+        int32 Center = 0;
+        FName Frame = TEXT("J2000");
+        ES_SPKRecordingType SegmentType = ES_SPKRecordingType::Hermite13;
+        int32 Degree = 7;                       // Lowered for short segments
+        FString SegmentId = TEXT("MAXQ TRAJECTORY RECORDER");
+        int32 BufferCapacity = 65536;           // Samples in the ring
+        int32 MaxSegmentSamples = 10000;        // Longer runs are split
+        double FlushSeconds = 10.;              // Real time between seals
+        double MaxGapSeconds = 0.;              // ET, zero for no limit
+        bool bAppend = false;                   // Add to an existing file, rather than replace it
+    };
+
+    struct FTrajectoryWriterStats
+    {
+        int64 Samples = 0;                      // Pushed into the ring
+        int64 Dropped = 0;                      // Ring was full
+        int64 Skipped = 0;                      // Repeated ETs
+        int32 Segments = 0;                     // Written to the file
+    };
+
+    class SPICE_API FTrajectoryWriter
+    {
+    public:
+        // Game thread.  Starts the background thread; the file is created by
+        // the first Write() with anything to write.
+        static TSharedPtr<FTrajectoryWriter> Open(const FTrajectoryWriterSettings& Settings, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        // Stops the background thread.  Anything not yet written is lost,
+        // Close() first to keep it.
+        ~FTrajectoryWriter();
+
+        // One producer thread at a time.  False if the ring was full and the
+        // sample was dropped.
+        bool Push(const FSEphemerisTime& et, const FSStateVector& state);
+
+        // Any thread.  Asks the background thread to seal what's been pushed
+        // so far, without waiting for FlushSeconds.
+        void Flush();
+
+        // Game thread.  Writes sealed segments, returns how many.
+        int32 Write(ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        // Game thread.  Seals and writes everything pushed, and stops the
+        // background thread.
+        void Close(ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        bool IsOpen() const;
+        FTrajectoryWriterStats GetStats() const;
+        const FString& GetPath() const;
+
+        struct FState;
+
+    private:
+        FTrajectoryWriter() = default;
+        void StopThread();
+
+        TSharedPtr<FState, ESPMode::ThreadSafe> State;
+        TUniquePtr<FRecordingThread> Sealer;
+    };
+}
+
+
+UCLASS(ClassGroup = "MaxQ", Category = "MaxQ", meta = (BlueprintSpawnableComponent))
+class SPICE_API USpiceTrajectoryRecorder : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    USpiceTrajectoryRecorder();
+
+    // Output file, absolute or relative to /Content
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    FString File = TEXT("recording.bsp");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    bool bAppend = false;
+
+    // NAIF ID to record the owner as
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    int Body = -1000;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    FName Center = TEXT("EARTH");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    FName Frame = TEXT("J2000");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    ES_SPKRecordingType SegmentType = ES_SPKRecordingType::Hermite13;
+
+    // Interpolation degree.  Type 13 degrees are odd.  1 - 27.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder", meta = (ClampMin = "1", ClampMax = "27"))
+    int Degree = 7;
+
+    // ET seconds between samples, zero for every tick
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    double SampleInterval = 0.;
+
+    // Real seconds between segments
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder", meta = (ClampMin = "0.1"))
+    double FlushSeconds = 10.;
+
+    // Samples held between segments
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder", meta = (ClampMin = "16"))
+    int BufferCapacity = 65536;
+
+    // ET jumps longer than this start a new segment, zero for no limit
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    double MaxGapSeconds = 0.;
+
+    // For the default GetStateToRecord, kilometers per UE unit
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    double KilometersPerUnit = 1.;
+
+    // ET recording starts at when the world has no MaxQ clock
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    FSEphemerisTime StartEt;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder")
+    bool bRecordOnBeginPlay = true;
+
+    /// <summary>Starts sampling the owner, replacing (or appending to) File</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder", meta = (ExpandEnumAsExecs = "ResultCode"))
+    void StartRecording(ES_ResultCode& ResultCode, FString& ErrorMessage);
+
+    /// <summary>Writes everything sampled, and stops</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder", meta = (ExpandEnumAsExecs = "ResultCode"))
+    void StopRecording(ES_ResultCode& ResultCode, FString& ErrorMessage);
+
+    /// <summary>Seals a segment from what's been sampled, without waiting for FlushSeconds</summary>
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder")
+    void Flush();
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Recorder")
+    bool IsRecording() const { return Writer.IsValid(); }
+
+    /// <summary>Samples taken, dropped (the buffer was full), and segments written</summary>
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Recorder")
+    void GetRecordingStats(int64& Samples, int64& Dropped, int& Segments) const;
+
+    /// <summary>The state to record at et, relative to Center in Frame.  By default, the owner's location & velocity.</summary>
+    UFUNCTION(BlueprintNativeEvent, Category = "MaxQ|Recorder")
+    FSStateVector GetStateToRecord(const FSEphemerisTime& et);
+
+    // UActorComponent interface
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    // end of UActorComponent interface
+
+private:
+    FSEphemerisTime GetRecordingEt() const;
+
+    TSharedPtr<MaxQ::Recording::FTrajectoryWriter> Writer;
+    MaxQ::Recording::FTrajectoryWriterStats LastStats;
+    double RecordingStartWorldSeconds = 0.;
+    double LastSampleEt = 0.;
+    bool bSampled = false;
+};
@@ -704,6 +704,87 @@ public:
         const FSPlanetographicStateVector& value
     );
 
+    UFUNCTION(BlueprintPure,
+        Category = "MaxQ|Types|StateVectorBuffer",
+        meta = (
+            Keywords = "CONVERSION, BATCH",
+            ToolTip = "Converts an array of state vectors to a state vector buffer (structure-of-arrays)"
+            ))
+    static FSStateVectorBuffer Conv_SStateVectorArrayToSStateVectorBuffer(
+        const TArray<FSStateVector>& value
+    );
+
+    UFUNCTION(BlueprintPure,
+        Category = "MaxQ|Types|StateVectorBuffer",
+        meta = (
+            Keywords = "CONVERSION, BATCH",
+            ToolTip = "Converts a state vector buffer (structure-of-arrays) to an array of state vectors"
+            ))
+    static TArray<FSStateVector> Conv_SStateVectorBufferToSStateVectorArray(
+        const FSStateVectorBuffer& value
+    );
+
+    UFUNCTION(BlueprintPure,
+        Category = "MaxQ|Types|StateVectorBuffer",
+        meta = (
+            CompactNodeTitle = "LENGTH",
+            Keywords = "BATCH, COUNT, NUM",
+            ToolTip = "Number of state vectors in the buffer"
+            ))
+    static int StateVectorBuffer_Num(
+        const FSStateVectorBuffer& buffer
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Types|StateVectorBuffer",
+        meta = (
+            ExpandEnumAsExecs = "found",
+            Keywords = "BATCH",
+            ToolTip = "Gets the state vector at index"
+            ))
+    static void StateVectorBuffer_Get(
+        const FSStateVectorBuffer& buffer,
+        int index,
+        ES_FoundCode& found,
+        FSStateVector& state
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Types|StateVectorBuffer",
+        meta = (
+            ExpandEnumAsExecs = "found",
+            Keywords = "BATCH",
+            ToolTip = "Sets the state vector at index"
+            ))
+    static void StateVectorBuffer_Set(
+        UPARAM(ref) FSStateVectorBuffer& buffer,
+        int index,
+        const FSStateVector& state,
+        ES_FoundCode& found
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Types|StateVectorBuffer",
+        meta = (
+            Keywords = "BATCH",
+            ToolTip = "Appends a state vector to the buffer, returning its index"
+            ))
+    static int StateVectorBuffer_Add(
+        UPARAM(ref) FSStateVectorBuffer& buffer,
+        const FSStateVector& state
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Types|StateVectorBuffer",
+        meta = (
+            Keywords = "BATCH",
+            ToolTip = "Resizes the buffer, new state vectors are zeroed"
+            ))
+    static void StateVectorBuffer_SetNum(
+        UPARAM(ref) FSStateVectorBuffer& buffer,
+        int count
+    );
+
     UFUNCTION(BlueprintPure,
         Category = "MaxQ|Stringifier",
         meta = (
@@ -17,6 +17,12 @@ public class Spice : ModuleRules
         PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine" });
         PrivateDependencyModuleNames.AddRange(new string[] { "CSpice_Library"});
 
+        if (Target.bBuildEditor)
+        {
+            // DSK mesh conversions are cached as derived data
+            PrivateDependencyModuleNames.Add("DerivedDataCache");
+        }
+
         PublicDefinitions.Add("MAXQ_SPICE_MODULE=1");
     }
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+
+#include "SpiceCompressSPKCommandlet.h"
+#include "Spice.h"
+#include "SpiceCompression.h"
+#include "SpiceLog.h"
+
+USpiceCompressSPKCommandlet::USpiceCompressSPKCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+
+int32 USpiceCompressSPKCommandlet::Main(const FString& Params)
+{
+    TArray<FString> Tokens, Switches;
+    TMap<FString, FString> Values;
+    ParseCommandLine(*Params, Tokens, Switches, Values);
+
+    const FString* In = Values.Find(TEXT("In"));
+    const FString* Out = Values.Find(TEXT("Out"));
+    if (!In || !Out)
+    {
+        UE_LOG(LogSpice, Error, TEXT("SpiceCompressSPK:  -In=<spk> -Out=<spk> [-Kernels=<kernel>,...] [-PosTol=<km>] [-VelTol=<km/s>] [-Type=2|3] [-MinDegree=<n>] [-MaxDegree=<n>] [-MaxRecordDays=<days>]"));
+        return 1;
+    }
+
+    MaxQ::Compression::FChebyshevFitSettings Settings;
+    auto Number = [&Values](const TCHAR* Key, double Default)
+    {
+        const FString* Value = Values.Find(Key);
+        return Value ? FCString::Atod(**Value) : Default;
+    };
+    Settings.PositionTolerance = Number(TEXT("PosTol"), Settings.PositionTolerance);
+    Settings.VelocityTolerance = Number(TEXT("VelTol"), Settings.VelocityTolerance);
+    Settings.bFitVelocity = Number(TEXT("Type"), 2.) == 3.;
+    Settings.MinDegree = (int32)Number(TEXT("MinDegree"), Settings.MinDegree);
+    Settings.MaxDegree = (int32)Number(TEXT("MaxDegree"), Settings.MaxDegree);
+    Settings.MaxRecordSeconds = 86400. * Number(TEXT("MaxRecordDays"), Settings.MaxRecordSeconds / 86400.);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    USpice::init_all();
+
+    if (const FString* Kernels = Values.Find(TEXT("Kernels")))
+    {
+        TArray<FString> Paths;
+        Kernels->ParseIntoArray(Paths, TEXT(","));
+        for (const FString& Path : Paths)
+        {
+            USpice::furnsh(ResultCode, ErrorMessage, Path);
+            if (ResultCode != ES_ResultCode::Success)
+            {
+                UE_LOG(LogSpice, Error, TEXT("SpiceCompressSPK:  couldn't load %s: %s"), *Path, *ErrorMessage);
+                return 1;
+            }
+        }
+    }
+
+    const double StartSeconds = FPlatformTime::Seconds();
+
+    MaxQ::Compression::FCompressionStats Stats;
+    MaxQ::Compression::CompressSpk(*In, *Out, Settings, Stats, &ResultCode, &ErrorMessage);
+    if (ResultCode != ES_ResultCode::Success)
+    {
+        UE_LOG(LogSpice, Error, TEXT("SpiceCompressSPK:  %s"), *ErrorMessage);
+        return 1;
+    }
+
+    UE_LOG(LogSpice, Display, TEXT("SpiceCompressSPK:  %s -> %s (type %d) in %.1fs"), **In, **Out, Settings.bFitVelocity ? 3 : 2, FPlatformTime::Seconds() - StartSeconds);
+    UE_LOG(LogSpice, Display, TEXT("  %lld bytes -> %lld bytes, %.1f:1"), Stats.InputBytes, Stats.OutputBytes, Stats.Ratio());
+    UE_LOG(LogSpice, Display, TEXT("  %d segments, %d records (%d over tolerance)"), Stats.Segments, Stats.Records, Stats.RecordsOverTolerance);
+    UE_LOG(LogSpice, Display, TEXT("  position error:  max %g km, rms %g km"), Stats.MaxPositionError, Stats.RmsPositionError);
+    UE_LOG(LogSpice, Display, TEXT("  velocity error:  max %g km/s, rms %g km/s (%lld checks)"), Stats.MaxVelocityError, Stats.RmsVelocityError, Stats.Checks);
+
+    return Stats.RecordsOverTolerance > 0 ? 2 : 0;
+}
@@ -0,0 +1,34 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SpiceCompressSPKCommandlet.generated.h"
+
+// Rewrites an SPK's segments as Chebyshev fits (types 2/3), see SpiceCompression.h
+//
+// UnrealEditor-Cmd.exe <Project>.uproject -run=SpiceCompressSPK -In=<spk> -Out=<spk>
+//      [-Kernels=<kernel>,<kernel>...]     FKs for non-built-in frames
+//      [-PosTol=<km>] [-VelTol=<km/s>]     Default 0.001, 0.000001
+//      [-Type=2|3]                         Default 2
+//      [-MinDegree=<n>] [-MaxDegree=<n>]   Default 3, 15
+//      [-MaxRecordDays=<days>]             Default 32
+//
+// Paths are absolute, or relative to /Content.
+UCLASS()
+class USpiceCompressSPKCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    USpiceCompressSPKCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -22,6 +22,6 @@ public class SpiceEditor : ModuleRules
                     "UnrealEd"
         });
 
-        PrivateDependencyModuleNames.AddRange(new string[] { "CSpice_Library"});
+        PrivateDependencyModuleNames.AddRange(new string[] { "CSpice_Library", "Spice" });
     }
 }
\ No newline at end of file
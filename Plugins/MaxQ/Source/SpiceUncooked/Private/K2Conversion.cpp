@@ -106,3 +106,68 @@ SPICEUNCOOKED_API FK2Conversion FK2Conversion::SDimensionlessVectorZToSDistance(
     return sdimensionlessvectorztodistance;
 }
 
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::DoubleArrayToSDistanceArray()
+{
+    FK2Conversion doublearraytosdistancearray = FK2Conversion(USpiceK2::Conv_DoubleArrayToSDistanceArray, FK2Type::DoubleArray(), FK2Type::SDistanceArray());
+    return doublearraytosdistancearray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::DoubleArrayToSSpeedArray()
+{
+    FK2Conversion doublearraytosspeedarray = FK2Conversion(USpiceK2::Conv_DoubleArrayToSSpeedArray, FK2Type::DoubleArray(), FK2Type::SSpeedArray());
+    return doublearraytosspeedarray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::DoubleArrayToSAngularRateArray()
+{
+    FK2Conversion doublearraytosangularratearray = FK2Conversion(USpiceK2::Conv_DoubleArrayToSAngularRateArray, FK2Type::DoubleArray(), FK2Type::SAngularRateArray());
+    return doublearraytosangularratearray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::SDimensionlessVectorArrayToSDistanceVectorArray()
+{
+    FK2Conversion sdimensionlessvectorarraytosdistancevectorarray = FK2Conversion(USpiceK2::Conv_SDimensionlessVectorArrayToSDistanceVectorArray, FK2Type::SDimensionlessVectorArray(), FK2Type::SDistanceVectorArray());
+    return sdimensionlessvectorarraytosdistancevectorarray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::SDimensionlessVectorArrayToSVelocityVectorArray()
+{
+    FK2Conversion sdimensionlessvectorarraytosvelocityvectorarray = FK2Conversion(USpiceK2::Conv_SDimensionlessVectorArrayToSVelocityVectorArray, FK2Type::SDimensionlessVectorArray(), FK2Type::SVelocityVectorArray());
+    return sdimensionlessvectorarraytosvelocityvectorarray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::SDimensionlessVectorArrayToSAngularVelocityArray()
+{
+    FK2Conversion sdimensionlessvectorarraytosangularvelocityarray = FK2Conversion(USpiceK2::Conv_SDimensionlessVectorArrayToSAngularVelocityArray, FK2Type::SDimensionlessVectorArray(), FK2Type::SAngularVelocityArray());
+    return sdimensionlessvectorarraytosangularvelocityarray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::SDistanceVectorArrayToSDimensionlessVectorArray()
+{
+    FK2Conversion sdistancevectorarraytosdimensionlessvectorarray = FK2Conversion(USpiceK2::Conv_SDistanceVectorArrayToSDimensionlessVectorArray, FK2Type::SDistanceVectorArray(), FK2Type::SDimensionlessVectorArray());
+    return sdistancevectorarraytosdimensionlessvectorarray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::SVelocityVectorArrayToSDimensionlessVectorArray()
+{
+    FK2Conversion svelocityvectorarraytosdimensionlessvectorarray = FK2Conversion(USpiceK2::Conv_SVelocityVectorArrayToSDimensionlessVectorArray, FK2Type::SVelocityVectorArray(), FK2Type::SDimensionlessVectorArray());
+    return svelocityvectorarraytosdimensionlessvectorarray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::SAngularVelocityArrayToSDimensionlessVectorArray()
+{
+    FK2Conversion sangularvelocityarraytosdimensionlessvectorarray = FK2Conversion(USpiceK2::Conv_SAngularVelocityArrayToSDimensionlessVectorArray, FK2Type::SAngularVelocityArray(), FK2Type::SDimensionlessVectorArray());
+    return sangularvelocityarraytosdimensionlessvectorarray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::SDimensionlessStateVectorArrayToSStateVectorArray()
+{
+    FK2Conversion sdimensionlessstatevectorarraytosstatevectorarray = FK2Conversion(USpiceK2::Conv_SDimensionlessStateVectorArrayToSStateVectorArray, FK2Type::SDimensionlessStateVectorArray(), FK2Type::SStateVectorArray());
+    return sdimensionlessstatevectorarraytosstatevectorarray;
+}
+
+SPICEUNCOOKED_API FK2Conversion FK2Conversion::SStateVectorArrayToSDimensionlessStateVectorArray()
+{
+    FK2Conversion sstatevectorarraytosdimensionlessstatevectorarray = FK2Conversion(USpiceK2::Conv_SStateVectorArrayToSDimensionlessStateVectorArray, FK2Type::SStateVectorArray(), FK2Type::SDimensionlessStateVectorArray());
+    return sstatevectorarraytosdimensionlessstatevectorarray;
+}
@@ -117,4 +117,17 @@ struct FK2Conversion
     static SPICEUNCOOKED_API FK2Conversion SAngularVelocityToSDimensionlessVector();
     static SPICEUNCOOKED_API FK2Conversion SDimensionlessStateVectorToSStateVector();
     static SPICEUNCOOKED_API FK2Conversion SStateVectorToSDimensionlessStateVector();
+
+    // Array conversions
+    static SPICEUNCOOKED_API FK2Conversion DoubleArrayToSDistanceArray();
+    static SPICEUNCOOKED_API FK2Conversion DoubleArrayToSSpeedArray();
+    static SPICEUNCOOKED_API FK2Conversion DoubleArrayToSAngularRateArray();
+    static SPICEUNCOOKED_API FK2Conversion SDimensionlessVectorArrayToSDistanceVectorArray();
+    static SPICEUNCOOKED_API FK2Conversion SDimensionlessVectorArrayToSVelocityVectorArray();
+    static SPICEUNCOOKED_API FK2Conversion SDimensionlessVectorArrayToSAngularVelocityArray();
+    static SPICEUNCOOKED_API FK2Conversion SDistanceVectorArrayToSDimensionlessVectorArray();
+    static SPICEUNCOOKED_API FK2Conversion SVelocityVectorArrayToSDimensionlessVectorArray();
+    static SPICEUNCOOKED_API FK2Conversion SAngularVelocityArrayToSDimensionlessVectorArray();
+    static SPICEUNCOOKED_API FK2Conversion SDimensionlessStateVectorArrayToSStateVectorArray();
+    static SPICEUNCOOKED_API FK2Conversion SStateVectorArrayToSDimensionlessStateVectorArray();
 };
@@ -0,0 +1,354 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceUncooked
+// K2 Node Compilation
+// See comments in Spice/SpiceK2.h.
+//------------------------------------------------------------------------------
+
+
+#include "K2Node_expression.h"
+#include "K2Utilities.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "KismetCompiler.h"
+#include "K2Node_CallFunction.h"
+#include "SpiceK2.h"
+
+
+#define LOCTEXT_NAMESPACE "K2Node_expression"
+
+using MaxQ::Math::EExpressionType;
+using MaxQ::Math::FExpression;
+
+namespace
+{
+    const FName ResultPinName { "result" };
+
+    struct FExpressionPinType
+    {
+        const FK2Type& K2Type;
+        EExpressionType Type;
+    };
+
+    const TArray<FExpressionPinType>& ExpressionPinTypes()
+    {
+        static const TArray<FExpressionPinType> PinTypes
+        {
+            { FK2Type::Double(), EExpressionType::Double },
+            { FK2Type::Real(), EExpressionType::Double },
+            { FK2Type::SDistance(), EExpressionType::SDistance },
+            { FK2Type::SSpeed(), EExpressionType::SSpeed },
+            { FK2Type::SAngularRate(), EExpressionType::SAngularRate },
+            { FK2Type::SAngle(), EExpressionType::SAngle },
+            { FK2Type::SMassConstant(), EExpressionType::SMassConstant },
+            { FK2Type::SDimensionlessVector(), EExpressionType::SDimensionlessVector },
+            { FK2Type::SDistanceVector(), EExpressionType::SDistanceVector },
+            { FK2Type::SVelocityVector(), EExpressionType::SVelocityVector },
+            { FK2Type::SAngularVelocity(), EExpressionType::SAngularVelocity },
+            { FK2Type::SDimensionlessStateVector(), EExpressionType::SDimensionlessStateVector },
+            { FK2Type::SStateVector(), EExpressionType::SStateVector },
+            { FK2Type::SRotationMatrix(), EExpressionType::SRotationMatrix },
+            { FK2Type::SStateTransform(), EExpressionType::SStateTransform }
+        };
+
+        return PinTypes;
+    }
+
+    EExpressionType ToExpressionType(const FEdGraphPinType& PinType)
+    {
+        for (const auto& PinTypeEntry : ExpressionPinTypes())
+        {
+            if (PinTypeEntry.K2Type.Is(PinType)) return PinTypeEntry.Type;
+        }
+        return EExpressionType::Invalid;
+    }
+
+    const FK2Type* ToK2Type(EExpressionType Type)
+    {
+        for (const auto& PinTypeEntry : ExpressionPinTypes())
+        {
+            if (PinTypeEntry.Type == Type) return &PinTypeEntry.K2Type;
+        }
+        return nullptr;
+    }
+}
+
+
+UK2Node_expression::UK2Node_expression(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    Expression = TEXT("unorm(m * r + dr)");
+}
+
+
+void UK2Node_expression::AllocateDefaultPins()
+{
+    Super::AllocateDefaultPins();
+
+    TArray<FString> OperandNames;
+    FString ErrorMessage;
+    FExpression::GetOperandNames(Expression, OperandNames, ErrorMessage);
+
+    for (const FString& OperandName : OperandNames)
+    {
+        // Reported by ExpandNode
+        if (ResultPinName.IsEqual(FName(OperandName))) continue;
+
+        auto InputPin{ CreatePin(EGPD_Input, UEdGraphSchema_K2::PC_Wildcard, FName(OperandName)) };
+        InputPin->PinToolTip = FString::Printf(TEXT("Operand %s"), *OperandName);
+    }
+
+    auto OutputPin{ CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Wildcard, ResultPinName) };
+    OutputPin->PinToolTip = TEXT("Expression result");
+}
+
+
+void UK2Node_expression::PostReconstructNode()
+{
+    Super::PostReconstructNode();
+
+    RefreshPinTypes();
+}
+
+
+void UK2Node_expression::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UK2Node_expression, Expression))
+    {
+        // Pins for operands that are still named keep their links
+        ReconstructNode();
+        FBlueprintEditorUtils::MarkBlueprintAsModified(GetBlueprint());
+    }
+}
+
+
+bool UK2Node_expression::IsConnectionDisallowed(const UEdGraphPin* MyPin, const UEdGraphPin* OtherPin, FString& OutReason) const
+{
+    const auto& OtherPinType{ OtherPin->PinType };
+
+    if (OtherPinType.PinCategory == UEdGraphSchema_K2::PC_Wildcard)
+    {
+        return false;
+    }
+
+    if (MyPin->Direction == EEdGraphPinDirection::EGPD_Output)
+    {
+        // The result type is whatever the expression type-checks to
+        const EExpressionType ResultType = ToExpressionType(MyPin->PinType);
+        if (ResultType != EExpressionType::Invalid && ResultType != ToExpressionType(OtherPinType))
+        {
+            OutReason = FString::Printf(TEXT("Expression result is %s"), MaxQ::Math::ToString(ResultType));
+            return true;
+        }
+    }
+
+    if (ToExpressionType(OtherPinType) == EExpressionType::Invalid)
+    {
+        OutReason = TEXT("Pin connection type not supported");
+        return true;
+    }
+
+    return false;
+}
+
+
+void UK2Node_expression::NodeConnectionListChanged()
+{
+    Super::NodeConnectionListChanged();
+
+    RefreshPinTypes();
+}
+
+
+void UK2Node_expression::RefreshPinTypes()
+{
+    TArray<UEdGraphPin*> OperandPins;
+    GetOperandPins(OperandPins);
+
+    for (UEdGraphPin* Pin : OperandPins)
+    {
+        const FK2Type* K2Type = Pin->LinkedTo.Num() > 0 ? ToK2Type(ToExpressionType(Pin->LinkedTo[0]->PinType)) : nullptr;
+
+        if (K2Type)
+        {
+            SetPinType(this, Pin, *K2Type, FString::Printf(TEXT("Operand %s (%s)"), *Pin->PinName.ToString(), *K2Type->GetDisplayNameString()));
+        }
+        else
+        {
+            SetPinTypeToWildcard(this, Pin, FString::Printf(TEXT("Operand %s"), *Pin->PinName.ToString()));
+        }
+    }
+
+    auto OutputPin = FindPinChecked(ResultPinName, EEdGraphPinDirection::EGPD_Output);
+
+    FString ErrorMessage;
+    TSharedPtr<FExpression> Compiled = CompileExpression(ErrorMessage);
+    const FK2Type* ResultType = Compiled.IsValid() ? ToK2Type(Compiled->GetResultType()) : nullptr;
+
+    if (ResultType)
+    {
+        SetPinType(this, OutputPin, *ResultType, FString::Printf(TEXT("Expression result (%s)"), *ResultType->GetDisplayNameString()));
+    }
+    else if (OutputPin->LinkedTo.Num() == 0)
+    {
+        SetPinTypeToWildcard(this, OutputPin, ErrorMessage.IsEmpty() ? TEXT("Expression result") : FString::Printf(TEXT("Expression result (%s)"), *ErrorMessage));
+    }
+}
+
+
+void UK2Node_expression::GetOperandPins(TArray<UEdGraphPin*>& OperandPins) const
+{
+    for (UEdGraphPin* Pin : Pins)
+    {
+        if (Pin->Direction == EEdGraphPinDirection::EGPD_Input) OperandPins.Add(Pin);
+    }
+}
+
+
+TSharedPtr<FExpression> UK2Node_expression::CompileExpression(FString& ErrorMessage) const
+{
+    TArray<FString> OperandNames;
+    if (!FExpression::GetOperandNames(Expression, OperandNames, ErrorMessage))
+    {
+        return nullptr;
+    }
+
+    // execexpression_K2 reads at most MaxOperands
+    if (OperandNames.Num() > FExpression::MaxOperands)
+    {
+        ErrorMessage = FString::Printf(TEXT("More than %d operands"), FExpression::MaxOperands);
+        return nullptr;
+    }
+
+    TArray<EExpressionType> OperandTypes;
+    for (const FString& OperandName : OperandNames)
+    {
+        if (ResultPinName.IsEqual(FName(OperandName)))
+        {
+            ErrorMessage = FString::Printf(TEXT("'%s' can't be used as an operand name"), *OperandName);
+            return nullptr;
+        }
+
+        const UEdGraphPin* Pin = FindPin(FName(OperandName), EEdGraphPinDirection::EGPD_Input);
+        if (!Pin || Pin->LinkedTo.Num() == 0)
+        {
+            ErrorMessage = FString::Printf(TEXT("Operand %s is not connected"), *OperandName);
+            return nullptr;
+        }
+
+        OperandTypes.Add(ToExpressionType(Pin->LinkedTo[0]->PinType));
+    }
+
+    return FExpression::Compile(Expression, OperandTypes, ErrorMessage);
+}
+
+
+FSlateIcon UK2Node_expression::GetIconAndTint(FLinearColor& OutColor) const
+{
+    OutColor = FColor::Emerald;
+    return FSlateIcon("EditorStyle", "Kismet.AllClasses.FunctionIcon");
+}
+
+FLinearColor UK2Node_expression::GetNodeTitleColor() const
+{
+    return NodeBackgroundColor;
+}
+
+
+void UK2Node_expression::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
+{
+    Super::ExpandNode(CompilerContext, SourceGraph);
+
+    FString ErrorMessage;
+    TSharedPtr<FExpression> Compiled = CompileExpression(ErrorMessage);
+    if (!Compiled.IsValid())
+    {
+        CompilerContext.MessageLog.Error(*FString::Printf(TEXT("@@: %s"), *ErrorMessage), this);
+        BreakAllNodeLinks();
+        return;
+    }
+
+    // The program travels as an FName pin default
+    const FString& Program = Compiled->GetProgramString();
+    if (Program.Len() >= NAME_SIZE)
+    {
+        CompilerContext.MessageLog.Error(*LOCTEXT("TooLong", "@@: Expression is too long").ToString(), this);
+        BreakAllNodeLinks();
+        return;
+    }
+
+    auto InternalNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+    InternalNode->FunctionReference.SetExternalMember(USpiceK2::expression, USpiceK2::StaticClass());
+    InternalNode->AllocateDefaultPins();
+    CompilerContext.MessageLog.NotifyIntermediateObjectCreation(InternalNode, this);
+
+    InternalNode->FindPinChecked(FName(USpiceK2::expression_program), EEdGraphPinDirection::EGPD_Input)->DefaultValue = Program;
+
+    // Variadic pins, in the order execexpression_K2 reads them: operands, then the result
+    TArray<FString> OperandNames;
+    FExpression::GetOperandNames(Expression, OperandNames, ErrorMessage);
+
+    for (int32 i = 0; i < OperandNames.Num(); ++i)
+    {
+        UEdGraphPin* OperandPin = FindPinChecked(FName(OperandNames[i]), EEdGraphPinDirection::EGPD_Input);
+        UEdGraphPin* InternalIn = InternalNode->CreatePin(EGPD_Input, OperandPin->PinType, *FString::Printf(TEXT("Operand%d"), i));
+        MovePinLinksOrCopyDefaults(CompilerContext, OperandPin, InternalIn);
+    }
+
+    UEdGraphPin* ResultPin = FindPinChecked(ResultPinName, EEdGraphPinDirection::EGPD_Output);
+    UEdGraphPin* InternalOut = InternalNode->CreatePin(EGPD_Output, ResultPin->PinType, FName("Result"));
+    MovePinLinksOrCopyDefaults(CompilerContext, ResultPin, InternalOut);
+
+    BreakAllNodeLinks();
+}
+
+void UK2Node_expression::GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const
+{
+    RegisterAction(ActionRegistrar, GetClass());
+}
+
+FText UK2Node_expression::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+    switch (TitleType)
+    {
+    case ENodeTitleType::FullTitle:
+        /** The full title, may be multiple lines. */
+        return FText::Format(LOCTEXT("FullTitle", "MaxQ Expression\n{0}"), FText::FromString(Expression));
+    case ENodeTitleType::MenuTitle:
+        /** Menu Title for context menus to be displayed in context menus referencing the node. */
+        return LOCTEXT("MenuTitle", "MaxQ Expression - Fused vector & matrix math");
+    case ENodeTitleType::ListView:
+        /** More concise, single line title. */
+        return LOCTEXT("ListViewTitle", "MaxQ Expression - Fused vector & matrix math");
+    }
+
+    return LOCTEXT("ShortTitle", "MaxQ Expression");
+}
+
+FText UK2Node_expression::GetMenuCategory() const
+{
+    return LOCTEXT("Category", "MaxQ|Math");
+}
+
+
+FText UK2Node_expression::GetKeywords() const
+{
+    return LOCTEXT("Keywords", "EXPRESSION, FORMULA, VECTOR, MATRIX, FUSED");
+}
+
+
+FText UK2Node_expression::GetTooltipText() const
+{
+    return LOCTEXT("Tooltip", "Evaluate a vector/matrix expression, e.g. unorm(m * r + dr), in a single native call.\n"
+        "Operand names become input pins; units are checked when the Blueprint compiles.\n"
+        "Operators: + - * /.  Functions: unorm, vhat, vnorm, vdot, vcrss, vsep, mxv, mtxv, mxm.");
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,78 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceUncooked
+// K2 Node Compilation
+// See comments in Spice/SpiceK2.h.
+//------------------------------------------------------------------------------
+//
+// MaxQ Expression
+//
+// One input pin per operand named in Expression, one "result" output pin.
+// Input pin types come from their links, the result type is inferred by
+// type-checking the expression (MaxQ::Math::FExpression).  The whole
+// expression compiles to a single USpiceK2::expression_K2 call, instead of a
+// chain of micro-op nodes with conversions between each one.
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "K2Node.h"
+#include "K2Type.h"
+#include "SpiceTypes.h"
+#include "SpiceExpression.h"
+#include "K2Node_expression.generated.h"
+
+#define LOCTEXT_NAMESPACE "K2Node_expression"
+
+
+UCLASS(BlueprintType, Blueprintable)
+class SPICEUNCOOKED_API UK2Node_expression : public UK2Node
+{
+    GENERATED_UCLASS_BODY()
+
+public:
+    // e.g. "unorm(m * r + dr)".  Operand names become input pins.
+    UPROPERTY(EditAnywhere, Category = "MaxQ")
+    FString Expression;
+
+public:
+    // UEdGraphNode interface
+    virtual void AllocateDefaultPins() override;
+    virtual FSlateIcon GetIconAndTint(FLinearColor& OutColor) const override;
+    virtual FLinearColor GetNodeTitleColor() const override;
+    virtual void PostReconstructNode() override;
+    virtual bool IsConnectionDisallowed(const UEdGraphPin* MyPin, const UEdGraphPin* OtherPin, FString& OutReason) const  override;
+    virtual void NodeConnectionListChanged() override;
+    virtual bool IsNodePure() const override { return true; }
+    virtual void ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph);
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+    // End of UEdGraphNode interface
+
+    // UK2Node interface
+    virtual void GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const override;
+    virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+    virtual FText GetMenuCategory() const override;
+    virtual FText GetKeywords() const override;
+    virtual FText GetTooltipText() const override;
+    // end of UK2Node interface
+
+    void RefreshPinTypes();
+
+protected:
+    // Compiles Expression against the types linked to the input pins.
+    // Nullptr, and the reason, if any input is unlinked or it doesn't compile.
+    TSharedPtr<MaxQ::Math::FExpression> CompileExpression(FString& ErrorMessage) const;
+
+    void GetOperandPins(TArray<UEdGraphPin*>& OperandPins) const;
+};
+
+
+#undef LOCTEXT_NAMESPACE
@@ -321,7 +321,13 @@ const TArray<UK2Node_mxv::OperationType>& UK2Node_mxv::GetSupportedOperations()
         OperationType{ "mxv velocity vector",  USpiceK2::mxv_vector, FK2Type::SRotationMatrix(), FK2Conversion::SVelocityVectorToSDimensionlessVector(), FK2Conversion::SDimensionlessVectorToSVelocityVector() },
         OperationType{ "mxv angular velocity",  USpiceK2::mxv_vector, FK2Type::SRotationMatrix(), FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::SDimensionlessVectorToSAngularVelocity() },
         OperationType{ "mxv dimensionless state",  USpiceK2::mxv_state_vector, FK2Type::SStateTransform(), FK2Type::SDimensionlessStateVector() },
-        OperationType{ "mxv state vector",  USpiceK2::mxv_state_vector, FK2Type::SStateTransform(), FK2Conversion::SStateVectorToSDimensionlessStateVector(), FK2Conversion::SDimensionlessStateVectorToSStateVector() }
+        OperationType{ "mxv state vector",  USpiceK2::mxv_state_vector, FK2Type::SStateTransform(), FK2Conversion::SStateVectorToSDimensionlessStateVector(), FK2Conversion::SDimensionlessStateVectorToSStateVector() },
+        OperationType{ "mxv dimensionless vector array", USpiceK2::mxv_vector_array, FK2Type::SRotationMatrix(), FK2Type::SDimensionlessVectorArray() },
+        OperationType{ "mxv distance vector array",  USpiceK2::mxv_vector_array, FK2Type::SRotationMatrix(), FK2Conversion::SDistanceVectorArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSDistanceVectorArray() },
+        OperationType{ "mxv velocity vector array",  USpiceK2::mxv_vector_array, FK2Type::SRotationMatrix(), FK2Conversion::SVelocityVectorArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSVelocityVectorArray() },
+        OperationType{ "mxv angular velocity array",  USpiceK2::mxv_vector_array, FK2Type::SRotationMatrix(), FK2Conversion::SAngularVelocityArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSAngularVelocityArray() },
+        OperationType{ "mxv dimensionless state array",  USpiceK2::mxv_state_vector_array, FK2Type::SStateTransform(), FK2Type::SDimensionlessStateVectorArray() },
+        OperationType{ "mxv state vector array",  USpiceK2::mxv_state_vector_array, FK2Type::SStateTransform(), FK2Conversion::SStateVectorArrayToSDimensionlessStateVectorArray(), FK2Conversion::SDimensionlessStateVectorArrayToSStateVectorArray() }
     };
 
     return SupportedOperations;
@@ -68,6 +68,7 @@ void UK2Node_unorm::AllocateDefaultPins()
     {
         SetPinType(this, InputPin, CurrentOperation.InputVectorType, FString::Printf(TEXT("Input vector (%s)"), *CurrentOperation.InputVectorType.TypeName.ToString()));
         SetPinType(this, OutputPin, CurrentOperation.OutputScalarType, FString::Printf(TEXT("Magnitude (%s)"), *CurrentOperation.OutputScalarType.TypeName.ToString()));
+        UnitVectorOutputPin->PinType.ContainerType = GetDirectionType(CurrentOperation).Container;
     }
 }
 
@@ -88,10 +89,12 @@ bool UK2Node_unorm::IsConnectionDisallowed(const UEdGraphPin* MyPin, const UEdGr
     const auto& OtherPinType { OtherPin->PinType };
     const bool bIsOutput { MyPin->Direction == EEdGraphPinDirection::EGPD_Output };
 
-    if (bIsOutput && MyPin == FindPinChecked(FName("vout")))
+    const UEdGraphPin* DirectionPin { FindPinChecked(FName("vout")) };
+
+    if (bIsOutput && MyPin == DirectionPin)
     {
         bool isokay = OtherPinType.PinCategory == UEdGraphSchema_K2::PC_Wildcard;
-        isokay |= OtherPinType.PinCategory == UEdGraphSchema_K2::PC_Struct &&  OtherPinType.PinSubCategoryObject == FSDimensionlessVector::StaticStruct() && OtherPinType.ContainerType == EPinContainerType::None;
+        isokay |= OtherPinType.PinCategory == UEdGraphSchema_K2::PC_Struct &&  OtherPinType.PinSubCategoryObject == FSDimensionlessVector::StaticStruct() && OtherPinType.ContainerType == GetDirectionType(CurrentOperation).Container;
         return !isokay;
     }
 
@@ -110,6 +113,9 @@ bool UK2Node_unorm::IsConnectionDisallowed(const UEdGraphPin* MyPin, const UEdGr
 
     for (const auto& Op : GetSupportedOperations())
     {
+        // An existing vout link rules out operations of the other container type
+        if (DirectionPin->LinkedTo.Num() > 0 && !GetDirectionType(Op).Matches(DirectionPin->LinkedTo[0]->PinType)) continue;
+
         const FK2Type& MatchingType = MyPin->Direction == EEdGraphPinDirection::EGPD_Input ? Op.InputVectorType : Op.OutputScalarType;
         
         if(MatchingType.Matches(OtherPinType)) return false;
@@ -131,10 +137,13 @@ void UK2Node_unorm::NodeConnectionListChanged()
 
     auto InputPin = FindPinChecked(FName("v"));
     auto OutputPin = FindPinChecked(FName("vmag"));
+    auto UnitVectorOutputPin = FindPinChecked(FName("vout"));
 
     CurrentOperation = OperationType();
     for (const auto& Op : GetSupportedOperations())
     {
+        if (UnitVectorOutputPin->LinkedTo.Num() > 0 && !GetDirectionType(Op).Matches(UnitVectorOutputPin->LinkedTo[0]->PinType)) continue;
+
         if ((InputPin->LinkedTo.Num() > 0 && Op.InputVectorType.Is(InputPin->LinkedTo[0]->PinType)) || (OutputPin->LinkedTo.Num() > 0 && Op.OutputScalarType.Is(OutputPin->LinkedTo[0]->PinType)))
         {
             CurrentOperation = Op;
@@ -154,6 +163,12 @@ void UK2Node_unorm::NodeConnectionListChanged()
         SetPinType(this, InputPin, CurrentOperation.InputVectorType, FString::Printf(TEXT("Input vector (%s)"), *CurrentOperation.InputVectorType.TypeName.ToString()));
         SetPinType(this, OutputPin, CurrentOperation.OutputScalarType, FString::Printf(TEXT("Magnitude (%s)"), *CurrentOperation.OutputScalarType.TypeName.ToString()));
     }
+
+    // Generic nodes keep whatever vout is already linked to (or a single vector)
+    if (!NodeIsGeneric || UnitVectorOutputPin->LinkedTo.Num() == 0)
+    {
+        SetPinType(this, UnitVectorOutputPin, GetDirectionType(CurrentOperation), TEXT("Vector unit normal"));
+    }
 }
 
 void UK2Node_unorm::PinTypeChanged(UEdGraphPin* Pin)
@@ -326,10 +341,19 @@ const TArray<UK2Node_unorm::OperationType>& UK2Node_unorm::GetSupportedOperation
         OperationType{ "unorm dimensionless vector", FName(USpiceK2::unorm_vector), FK2Type::SDimensionlessVector(), FK2Type::Double() },
         OperationType{ "unorm distance vector",  USpiceK2::unorm_vector, FK2Conversion::SDistanceVectorToSDimensionlessVector(), FK2Conversion::DoubleToSDistance() },
         OperationType{ "unorm velocity vector",  USpiceK2::unorm_vector, FK2Conversion::SVelocityVectorToSDimensionlessVector(), FK2Conversion::DoubleToSSpeed() },
-        OperationType{ "unorm angular velocity",  USpiceK2::unorm_vector, FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::DoubleToSAngularRate() }
+        OperationType{ "unorm angular velocity",  USpiceK2::unorm_vector, FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::DoubleToSAngularRate() },
+        OperationType{ "unorm dimensionless vector array", USpiceK2::unorm_vector_array, FK2Type::SDimensionlessVectorArray(), FK2Type::DoubleArray() },
+        OperationType{ "unorm distance vector array",  USpiceK2::unorm_vector_array, FK2Conversion::SDistanceVectorArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSDistanceArray() },
+        OperationType{ "unorm velocity vector array",  USpiceK2::unorm_vector_array, FK2Conversion::SVelocityVectorArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSSpeedArray() },
+        OperationType{ "unorm angular velocity array",  USpiceK2::unorm_vector_array, FK2Conversion::SAngularVelocityArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSAngularRateArray() }
     };
 
     return SupportedOperations;
 }
 
+const FK2Type& UK2Node_unorm::GetDirectionType(const OperationType& Operation)
+{
+    return Operation.InputVectorType.Container == EPinContainerType::Array ? FK2Type::SDimensionlessVectorArray() : FK2Type::SDimensionlessVector();
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
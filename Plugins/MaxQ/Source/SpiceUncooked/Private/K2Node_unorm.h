@@ -73,6 +73,9 @@ public:
 
 protected:
     virtual const TArray<OperationType>& GetSupportedOperations() const;
+
+    // vout is always dimensionless, but is an array when the operation is
+    static const FK2Type& GetDirectionType(const OperationType& Operation);
 };
 
 
@@ -98,7 +98,13 @@ const TArray<UK2Node_vadd::OperationType>& UK2Node_vadd::GetSupportedOperations(
         OperationType {"vadd velocity vector", USpiceK2::vadd_vector, FK2Conversion::SVelocityVectorToSDimensionlessVector(), FK2Conversion::SDimensionlessVectorToSVelocityVector() },
         OperationType {"vadd angular velocity", USpiceK2::vadd_vector, FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::SDimensionlessVectorToSAngularVelocity() },
         OperationType { "vadd dimensionless state vector", USpiceK2::vadd_state_vector, FK2Type::SDimensionlessStateVector() },
-        OperationType { "vadd state vector", USpiceK2::vadd_state_vector, FK2Conversion::SStateVectorToSDimensionlessStateVector(), FK2Conversion::SDimensionlessStateVectorToSStateVector() }
+        OperationType { "vadd state vector", USpiceK2::vadd_state_vector, FK2Conversion::SStateVectorToSDimensionlessStateVector(), FK2Conversion::SDimensionlessStateVectorToSStateVector() },
+        OperationType{ "vadd dimensionless vector array", USpiceK2::vadd_vector_array, FK2Type::SDimensionlessVectorArray() },
+        OperationType{ "vadd distance vector array", USpiceK2::vadd_vector_array, FK2Conversion::SDistanceVectorArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSDistanceVectorArray() },
+        OperationType{ "vadd velocity vector array", USpiceK2::vadd_vector_array, FK2Conversion::SVelocityVectorArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSVelocityVectorArray() },
+        OperationType{ "vadd angular velocity array", USpiceK2::vadd_vector_array, FK2Conversion::SAngularVelocityArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSAngularVelocityArray() },
+        OperationType{ "vadd dimensionless state vector array", USpiceK2::vadd_state_vector_array, FK2Type::SDimensionlessStateVectorArray() },
+        OperationType{ "vadd state vector array", USpiceK2::vadd_state_vector_array, FK2Conversion::SStateVectorArrayToSDimensionlessStateVectorArray(), FK2Conversion::SDimensionlessStateVectorArrayToSStateVectorArray() }
     };
 
     return SupportedOperations;
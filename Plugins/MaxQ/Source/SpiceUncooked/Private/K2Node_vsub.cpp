@@ -102,7 +102,13 @@ const TArray<UK2Node_vsub::OperationType>& UK2Node_vsub::GetSupportedOperations(
         OperationType{ "vsub velocity vector", USpiceK2::vsub_vector, FK2Conversion::SVelocityVectorToSDimensionlessVector(), FK2Conversion::SDimensionlessVectorToSVelocityVector() },
         OperationType{ "vsub angular velocity", USpiceK2::vsub_vector, FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::SDimensionlessVectorToSAngularVelocity() },
         OperationType{ "vsub dimensionless state vector", USpiceK2::vsub_state_vector, FK2Type::SDimensionlessStateVector() },
-        OperationType{ "vsub state vector", USpiceK2::vsub_state_vector, FK2Conversion::SStateVectorToSDimensionlessStateVector(), FK2Conversion::SDimensionlessStateVectorToSStateVector() }
+        OperationType{ "vsub state vector", USpiceK2::vsub_state_vector, FK2Conversion::SStateVectorToSDimensionlessStateVector(), FK2Conversion::SDimensionlessStateVectorToSStateVector() },
+        OperationType{ "vsub dimensionless vector array", USpiceK2::vsub_vector_array, FK2Type::SDimensionlessVectorArray() },
+        OperationType{ "vsub distance vector array", USpiceK2::vsub_vector_array, FK2Conversion::SDistanceVectorArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSDistanceVectorArray() },
+        OperationType{ "vsub velocity vector array", USpiceK2::vsub_vector_array, FK2Conversion::SVelocityVectorArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSVelocityVectorArray() },
+        OperationType{ "vsub angular velocity array", USpiceK2::vsub_vector_array, FK2Conversion::SAngularVelocityArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSAngularVelocityArray() },
+        OperationType{ "vsub dimensionless state vector array", USpiceK2::vsub_state_vector_array, FK2Type::SDimensionlessStateVectorArray() },
+        OperationType{ "vsub state vector array", USpiceK2::vsub_state_vector_array, FK2Conversion::SStateVectorArrayToSDimensionlessStateVectorArray(), FK2Conversion::SDimensionlessStateVectorArrayToSStateVectorArray() }
     };
 
     return SupportedOperations;
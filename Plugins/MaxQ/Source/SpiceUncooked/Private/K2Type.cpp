@@ -124,6 +124,60 @@ const FK2Type& FK2Type::SRotationMatrix()
     return RotationMatrix;
 }
 
+const FK2Type& FK2Type::SDistanceArray()
+{
+    static FK2Type DistanceArray = FK2Type(FSDistance::StaticStruct(), EPinContainerType::Array);
+    return DistanceArray;
+}
+
+const FK2Type& FK2Type::SSpeedArray()
+{
+    static FK2Type SpeedArray = FK2Type(FSSpeed::StaticStruct(), EPinContainerType::Array);
+    return SpeedArray;
+}
+
+const FK2Type& FK2Type::SAngularRateArray()
+{
+    static FK2Type AngularRateArray = FK2Type(FSAngularRate::StaticStruct(), EPinContainerType::Array);
+    return AngularRateArray;
+}
+
+const FK2Type& FK2Type::SDimensionlessVectorArray()
+{
+    static FK2Type DimensionlessVectorArray = FK2Type(FSDimensionlessVector::StaticStruct(), EPinContainerType::Array);
+    return DimensionlessVectorArray;
+}
+
+const FK2Type& FK2Type::SDistanceVectorArray()
+{
+    static FK2Type DistanceVectorArray = FK2Type(FSDistanceVector::StaticStruct(), EPinContainerType::Array);
+    return DistanceVectorArray;
+}
+
+const FK2Type& FK2Type::SVelocityVectorArray()
+{
+    static FK2Type VelocityVectorArray = FK2Type(FSVelocityVector::StaticStruct(), EPinContainerType::Array);
+    return VelocityVectorArray;
+}
+
+const FK2Type& FK2Type::SAngularVelocityArray()
+{
+    static FK2Type AngularVelocityArray = FK2Type(FSAngularVelocity::StaticStruct(), EPinContainerType::Array);
+    return AngularVelocityArray;
+}
+
+const FK2Type& FK2Type::SStateVectorArray()
+{
+    static FK2Type StateVectorArray = FK2Type(FSStateVector::StaticStruct(), EPinContainerType::Array);
+    return StateVectorArray;
+}
+
+const FK2Type& FK2Type::SDimensionlessStateVectorArray()
+{
+    static FK2Type DimensionlessStateVectorArray = FK2Type(FSDimensionlessStateVector::StaticStruct(), EPinContainerType::Array);
+    return DimensionlessStateVectorArray;
+}
+
 
 
 TArray<FString> FK2Type::GetTypePinLabels(const UScriptStruct* WhatType)
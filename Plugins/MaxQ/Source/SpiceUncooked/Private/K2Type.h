@@ -49,6 +49,19 @@ struct SPICEUNCOOKED_API FK2Type
         Container = { EPinContainerType::None };
     }
 
+    // Containers get their own TypeName ("Array(SDistanceVector)"), so equality
+    // by name still distinguishes a struct from an array of the struct.
+    FK2Type(
+        UScriptStruct* _type,
+        EPinContainerType _container
+    )
+    {
+        TypeName = { _container == EPinContainerType::Array ? FName(*FString::Printf(TEXT("Array(%s)"), *_type->GetName())) : _type->GetFName() };
+        Category = { UEdGraphSchema_K2::PC_Struct };
+        SubCategoryObject = { _type };
+        Container = { _container };
+    }
+
     FK2Type(
         FName _typename,
         FName _category,
@@ -154,6 +167,7 @@ struct SPICEUNCOOKED_API FK2Type
 
     FString GetDisplayNameString() const
     {
+        if (SubCategoryObject.Get() && Container == EPinContainerType::Array) return TypeName.ToString();
         if(SubCategoryObject.Get()) return SubCategoryObject->GetName();
         if (TypeName.IsNone()) return TEXT("Wildcard");
         return TypeName.ToString();
@@ -161,6 +175,7 @@ struct SPICEUNCOOKED_API FK2Type
 
     FText GetDisplayNameText() const
     {
+        if (SubCategoryObject.Get() && Container == EPinContainerType::Array) return FText::Format(LOCTEXT("ArrayOf", "Array of {0}"), SubCategoryObject->GetDisplayNameText());
         if (SubCategoryObject.Get()) return SubCategoryObject->GetDisplayNameText();
         if (TypeName.IsNone()) return LOCTEXT("Wildcard", "Wildcard");
         return FText::FromName(TypeName);
@@ -185,6 +200,16 @@ struct SPICEUNCOOKED_API FK2Type
     static const FK2Type& SRotationMatrix();
     static const FK2Type& SStateTransform();
 
+    static const FK2Type& SDistanceArray();
+    static const FK2Type& SSpeedArray();
+    static const FK2Type& SAngularRateArray();
+    static const FK2Type& SDimensionlessVectorArray();
+    static const FK2Type& SDistanceVectorArray();
+    static const FK2Type& SVelocityVectorArray();
+    static const FK2Type& SAngularVelocityArray();
+    static const FK2Type& SStateVectorArray();
+    static const FK2Type& SDimensionlessStateVectorArray();
+
     static TArray<FString> GetTypePinLabels(const UScriptStruct* WhatType);
 
 private: